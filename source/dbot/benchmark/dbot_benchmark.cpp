@@ -0,0 +1,614 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file dbot_benchmark.cpp
+ * \date October 2026
+ *
+ * End to end benchmark of the trackers on synthetic scenes
+ *
+ * Every configuration of the sweep tracks an object through a SyntheticScene
+ * and reports the frame rate, the particle likelihood evaluations per second,
+ * the percentiles of the filter stages and the tracking error against the
+ * ground truth. The first frames of every run warm up the caches and are not
+ * measured. Usage:
+ *
+ *   dbot_benchmark [--trackers particle_cpu,particle_gpu,gaussian]
+ *                  [--particles 100,400,1600] [--downsampling 4,2]
+ *                  [--parts 1,2] [--frames 150] [--warmup 15]
+ *                  [--threads 0] [--coarse-to-fine 1] [--csv]
+ *
+ * A coarse to fine factor above 1 screens the particles of the particle
+ * trackers at the working resolution downsampled by that factor.
+ *
+ * With --calibrate <ms>, the particle trackers are calibrated against the
+ * latency target instead:
+ *
+ *   dbot_benchmark --calibrate 33 [--max-error 5] [--trackers particle_gpu]
+ *                  [--downsampling 4,2] [--parts 1,2]
+ *                  [--calibration-file path]
+ *
+ * For every resolution and block schedule, the particle count doubles from
+ * 25 until the 90th percentile of the filter step exceeds the target. Of
+ * the configurations within the target whose translation error stays below
+ * the floor in mm, the one evaluating the most pixels of particles is
+ * stored in the LatencyConfigurationCache, from which applications apply it
+ * to their builder parameters.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dbot/benchmark/synthetic_scene.h>
+#include <dbot/builder/gaussian_tracker_builder.h>
+#include <dbot/builder/latency_configuration.h>
+#include <dbot/builder/object_transition_builder.h>
+#include <dbot/builder/particle_tracker_builder.h>
+#include <dbot/builder/rb_sensor_builder.h>
+#include <dbot/latency_metrics.h>
+#include <dbot/tracker/gaussian_tracker.h>
+#include <dbot/tracker/particle_tracker.h>
+
+namespace
+{
+typedef dbot::SyntheticScene::State State;
+
+struct Options
+{
+    std::vector<std::string> trackers = {"particle_cpu",
+                                         "particle_gpu",
+                                         "gaussian"};
+    std::vector<int> particle_counts = {100, 400, 1600};
+    std::vector<int> downsampling_factors = {4, 2};
+    std::vector<int> part_counts = {1, 2};
+    int frame_count = 150;
+    int warmup_frame_count = 15;
+    int thread_count = 0;
+    int coarse_downsampling_factor = 1;
+    bool csv = false;
+    /* latency target of the calibration in seconds, 0 runs the sweep */
+    double calibration_target = 0;
+    double max_translation_error = 0.005;
+    std::string calibration_file =
+        dbot::LatencyConfigurationCache::default_path();
+};
+
+struct Configuration
+{
+    std::string tracker;
+    int particle_count;
+    int downsampling_factor;
+    int part_count;
+    bool order_by_uncertainty = false;
+};
+
+struct Result
+{
+    double frames_per_second;
+    /* 90th percentile of the filter step in seconds */
+    double latency_p90;
+    double evaluations_per_second;
+    double translation_error;
+    double rotation_error;
+    std::shared_ptr<dbot::LatencyMetrics> latency_metrics;
+};
+
+/**
+ * \brief Builds the Gaussian tracker for an object model which is given
+ *        instead of being loaded from a resource
+ */
+class SyntheticGaussianTrackerBuilder : public dbot::GaussianTrackerBuilder
+{
+public:
+    SyntheticGaussianTrackerBuilder(
+        const Parameters& param,
+        const std::shared_ptr<dbot::CameraData>& camera_data)
+        : dbot::GaussianTrackerBuilder(param, camera_data)
+    {
+    }
+
+    std::shared_ptr<dbot::GaussianTracker> build(
+        const std::shared_ptr<dbot::ObjectModel>& object_model)
+    {
+        return std::make_shared<dbot::GaussianTracker>(
+            create_filter(object_model),
+            object_model,
+            param_.moving_average_update_rate,
+            param_.center_object_frame,
+            param_.observation.pixel_region_margin);
+    }
+};
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<int> split_ints(const std::string& list)
+{
+    std::vector<int> values;
+    for (auto& item : split(list)) values.push_back(std::atoi(item.c_str()));
+    return values;
+}
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string option = argv[i];
+        if (option == "--csv")
+        {
+            options.csv = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cout << "ERROR: option " << option << " needs a value"
+                      << std::endl;
+            exit(-1);
+        }
+
+        const std::string value = argv[++i];
+        if (option == "--trackers")
+            options.trackers = split(value);
+        else if (option == "--particles")
+            options.particle_counts = split_ints(value);
+        else if (option == "--downsampling")
+            options.downsampling_factors = split_ints(value);
+        else if (option == "--parts")
+            options.part_counts = split_ints(value);
+        else if (option == "--frames")
+            options.frame_count = std::atoi(value.c_str());
+        else if (option == "--warmup")
+            options.warmup_frame_count = std::atoi(value.c_str());
+        else if (option == "--threads")
+            options.thread_count = std::atoi(value.c_str());
+        else if (option == "--coarse-to-fine")
+            options.coarse_downsampling_factor = std::atoi(value.c_str());
+        else if (option == "--calibrate")
+            options.calibration_target = std::atof(value.c_str()) / 1e3;
+        else if (option == "--max-error")
+            options.max_translation_error = std::atof(value.c_str()) / 1e3;
+        else if (option == "--calibration-file")
+            options.calibration_file = value;
+        else
+        {
+            std::cout << "ERROR: unknown option " << option << std::endl;
+            exit(-1);
+        }
+    }
+    return options;
+}
+
+dbot::ObjectTransitionBuilder<State>::Parameters transition_parameters(
+    const dbot::SyntheticScene& scene)
+{
+    dbot::ObjectTransitionBuilder<State>::Parameters params;
+    params.linear_sigma_x = 0.002;
+    params.linear_sigma_y = 0.002;
+    params.linear_sigma_z = 0.002;
+    params.angular_sigma_x = 0.01;
+    params.angular_sigma_y = 0.01;
+    params.angular_sigma_z = 0.01;
+    params.velocity_factor = 0.8;
+    params.part_count = scene.object_model()->count_parts();
+    return params;
+}
+
+std::shared_ptr<dbot::Tracker> build_particle_tracker(
+    const Configuration& configuration,
+    const Options& options,
+    const dbot::SyntheticScene& scene)
+{
+    typedef dbot::ParticleTrackerBuilder<dbot::ParticleTracker> Builder;
+
+    auto transition_builder =
+        std::make_shared<dbot::ObjectTransitionBuilder<State>>(
+            transition_parameters(scene));
+
+    Builder::SensorBuilder::Parameters sensor_params;
+    sensor_params.use_gpu = configuration.tracker == "particle_gpu";
+    sensor_params.occlusion.p_occluded_visible = 0.1;
+    sensor_params.occlusion.p_occluded_occluded = 0.7;
+    sensor_params.occlusion.initial_occlusion_prob = 0.1;
+    sensor_params.kinect.tail_weight = 0.01;
+    sensor_params.kinect.model_sigma = 0.005;
+    sensor_params.kinect.sigma_factor = 0.00625;
+    sensor_params.delta_time = scene.delta_time();
+    sensor_params.sample_count = configuration.particle_count;
+    sensor_params.thread_count = options.thread_count;
+    sensor_params.use_custom_shaders = false;
+    sensor_params.coarse_downsampling_factor =
+        options.coarse_downsampling_factor;
+
+    auto sensor_builder = std::make_shared<Builder::SensorBuilder>(
+        scene.object_model(), scene.camera_data(), sensor_params);
+
+    // every particle is evaluated once per sampling block, i.e. per part
+    Builder::Parameters tracker_params;
+    tracker_params.evaluation_count =
+        configuration.particle_count * configuration.part_count;
+    tracker_params.moving_average_update_rate = 1.0;
+    tracker_params.max_kl_divergence = 2.0;
+    tracker_params.center_object_frame = false;
+    tracker_params.coarse_to_fine.enabled =
+        options.coarse_downsampling_factor > 1;
+    tracker_params.sampling_schedule.order_by_uncertainty =
+        configuration.order_by_uncertainty;
+
+    return Builder(transition_builder,
+                   sensor_builder,
+                   scene.object_model(),
+                   tracker_params)
+        .build();
+}
+
+std::shared_ptr<dbot::Tracker> build_gaussian_tracker(
+    const dbot::SyntheticScene& scene)
+{
+    SyntheticGaussianTrackerBuilder::Parameters params;
+    params.ut_alpha = 1.0;
+    params.moving_average_update_rate = 1.0;
+    params.center_object_frame = false;
+    params.observation.bg_depth = 7.0;
+    params.observation.fg_noise_std = 0.001;
+    params.observation.bg_noise_std = 0.001;
+    params.observation.tail_weight = 0.01;
+    params.observation.uniform_tail_min = 0.0;
+    params.observation.uniform_tail_max = 6.0;
+    params.observation.sensors = scene.camera_data()->pixels();
+    params.object_transition = transition_parameters(scene);
+
+    return SyntheticGaussianTrackerBuilder(params, scene.camera_data())
+        .build(scene.object_model());
+}
+
+bool run(const Configuration& configuration,
+         const Options& options,
+         Result& result)
+{
+    dbot::SyntheticSceneParameters scene_params;
+    scene_params.part_count = configuration.part_count;
+    scene_params.downsampling_factor = configuration.downsampling_factor;
+    dbot::SyntheticScene scene(scene_params);
+
+    std::shared_ptr<dbot::Tracker> tracker;
+    try
+    {
+        tracker = configuration.tracker == "gaussian"
+                      ? build_gaussian_tracker(scene)
+                      : build_particle_tracker(configuration, options, scene);
+    }
+    catch (const dbot::NoGpuSupportException&)
+    {
+        return false;
+    }
+    tracker->initialize({scene.state(0)});
+
+    double seconds = 0;
+    std::vector<double> step_seconds;
+    double translation_error = 0;
+    double rotation_error = 0;
+    int measured_frame_count = 0;
+    for (int i = 1; i <= options.frame_count; i++)
+    {
+        // the observations are generated outside of the measurement
+        const dbot::DepthFrame::ConstPtr frame = scene.frame(i);
+        if (i == options.warmup_frame_count + 1)
+        {
+            tracker->latency_metrics()->clear();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const State estimate = tracker->track(frame);
+        const auto end = std::chrono::steady_clock::now();
+
+        if (i <= options.warmup_frame_count) continue;
+        step_seconds.push_back(
+            std::chrono::duration<double>(end - start).count());
+        seconds += step_seconds.back();
+        translation_error +=
+            dbot::SyntheticScene::translation_error(estimate, scene.state(i));
+        rotation_error +=
+            dbot::SyntheticScene::rotation_error(estimate, scene.state(i));
+        measured_frame_count++;
+    }
+
+    const int count = std::max(measured_frame_count, 1);
+    result.frames_per_second = seconds > 0 ? measured_frame_count / seconds : 0;
+    result.latency_p90 = 0;
+    if (!step_seconds.empty())
+    {
+        auto p90 = step_seconds.begin() + (step_seconds.size() * 9) / 10;
+        if (p90 == step_seconds.end()) --p90;
+        std::nth_element(step_seconds.begin(), p90, step_seconds.end());
+        result.latency_p90 = *p90;
+    }
+    result.evaluations_per_second =
+        configuration.tracker == "gaussian"
+            ? 0
+            : result.frames_per_second * configuration.particle_count *
+                  configuration.part_count;
+    result.translation_error = translation_error / count;
+    result.rotation_error = rotation_error / count;
+    result.latency_metrics = tracker->latency_metrics();
+    return true;
+}
+
+void print_csv_header()
+{
+    std::printf("tracker,parts,width,height,particles,frames_per_second,"
+                "particles_per_second,translation_error_mm,"
+                "rotation_error_deg");
+    for (int stage = 0; stage < dbot::LatencyMetrics::STAGE_COUNT; stage++)
+    {
+        const char* name = dbot::LatencyMetrics::stage_name(
+            dbot::LatencyMetrics::Stage(stage));
+        std::printf(",%s_p50_ms,%s_p90_ms,%s_p99_ms", name, name, name);
+    }
+    std::printf("\n");
+}
+
+void print(const Configuration& configuration,
+           const Result& result,
+           const dbot::CameraData::Resolution& resolution,
+           bool csv)
+{
+    const double mm = 1e3;
+    const double deg = 180. / M_PI;
+
+    if (csv)
+    {
+        std::printf("%s,%d,%d,%d,%d,%.2f,%.0f,%.3f,%.3f",
+                    configuration.tracker.c_str(),
+                    configuration.part_count,
+                    resolution.width,
+                    resolution.height,
+                    configuration.particle_count,
+                    result.frames_per_second,
+                    result.evaluations_per_second,
+                    result.translation_error * mm,
+                    result.rotation_error * deg);
+        for (int stage = 0; stage < dbot::LatencyMetrics::STAGE_COUNT; stage++)
+        {
+            const auto summary = result.latency_metrics->summary(
+                dbot::LatencyMetrics::Stage(stage));
+            std::printf(",%.4f,%.4f,%.4f",
+                        summary.p50 * mm,
+                        summary.p90 * mm,
+                        summary.p99 * mm);
+        }
+        std::printf("\n");
+        return;
+    }
+
+    std::printf("%s, %d parts, %d x %d pixels, %d particles: %.1f frames/s, "
+                "%.0f particles/s, error %.2f mm / %.2f deg\n",
+                configuration.tracker.c_str(),
+                configuration.part_count,
+                resolution.width,
+                resolution.height,
+                configuration.particle_count,
+                result.frames_per_second,
+                result.evaluations_per_second,
+                result.translation_error * mm,
+                result.rotation_error * deg);
+    for (int stage = 0; stage < dbot::LatencyMetrics::STAGE_COUNT; stage++)
+    {
+        const auto summary = result.latency_metrics->summary(
+            dbot::LatencyMetrics::Stage(stage));
+        if (summary.count == 0) continue;
+        std::printf("    %-18s p50 %8.3f ms   p90 %8.3f ms   p99 %8.3f ms\n",
+                    dbot::LatencyMetrics::stage_name(
+                        dbot::LatencyMetrics::Stage(stage)),
+                    summary.p50 * mm,
+                    summary.p90 * mm,
+                    summary.p99 * mm);
+    }
+}
+
+/**
+ * \brief Calibrates the particle count, resolution and block schedule of
+ *        the particle trackers against the latency target and stores the
+ *        results in the calibration file
+ */
+void calibrate(const Options& options)
+{
+    const int min_particle_count = 25;
+    const int max_particle_count = 25600;
+    dbot::LatencyConfigurationCache cache(options.calibration_file);
+
+    for (auto& tracker : options.trackers)
+    {
+        if (tracker == "gaussian") continue;
+
+        for (int part_count : options.part_counts)
+        {
+            // the schedule only matters for several sampling blocks
+            const std::vector<bool> schedules =
+                part_count > 1 ? std::vector<bool>{false, true}
+                               : std::vector<bool>{false};
+
+            bool found = false;
+            bool supported = true;
+            double best_work = 0;
+            double best_error = 0;
+            dbot::LatencyConfiguration best;
+            for (int factor : options.downsampling_factors)
+            {
+                const double pixels = (640. / factor) * (480. / factor);
+                for (bool order_by_uncertainty : schedules)
+                {
+                    for (int particle_count = min_particle_count;
+                         particle_count <= max_particle_count;
+                         particle_count *= 2)
+                    {
+                        Configuration configuration;
+                        configuration.tracker = tracker;
+                        configuration.particle_count = particle_count;
+                        configuration.downsampling_factor = factor;
+                        configuration.part_count = part_count;
+                        configuration.order_by_uncertainty =
+                            order_by_uncertainty;
+
+                        Result result;
+                        supported = run(configuration, options, result);
+                        if (!supported) break;
+
+                        // more particles do not get faster
+                        if (result.latency_p90 > options.calibration_target)
+                        {
+                            break;
+                        }
+                        if (result.translation_error >
+                            options.max_translation_error)
+                        {
+                            continue;
+                        }
+
+                        const double work = particle_count * pixels;
+                        if (!found || work > best_work ||
+                            (work == best_work &&
+                             result.translation_error < best_error))
+                        {
+                            found = true;
+                            best_work = work;
+                            best_error = result.translation_error;
+                            best.particle_count = particle_count;
+                            best.downsampling_factor = factor;
+                            best.order_by_uncertainty = order_by_uncertainty;
+                            best.latency = result.latency_p90;
+                        }
+                    }
+                    if (!supported) break;
+                }
+                if (!supported) break;
+            }
+
+            if (!supported)
+            {
+                std::printf("%s: skipped, dbot was built without GPU support\n",
+                            tracker.c_str());
+                break;
+            }
+            if (!found)
+            {
+                std::printf("%s, %d parts: no configuration meets %.1f ms "
+                            "and %.2f mm\n",
+                            tracker.c_str(),
+                            part_count,
+                            options.calibration_target * 1e3,
+                            options.max_translation_error * 1e3);
+                continue;
+            }
+
+            const std::string key = dbot::LatencyConfigurationCache::make_key(
+                tracker, part_count, options.calibration_target);
+            if (!cache.store(key, best))
+            {
+                std::cout << "ERROR: cannot write " << cache.path()
+                          << std::endl;
+                exit(-1);
+            }
+            std::printf("%s, %d parts: %d particles at 1/%d resolution, "
+                        "%s blocks, p90 %.2f ms, error %.2f mm -> %s\n",
+                        tracker.c_str(),
+                        part_count,
+                        best.particle_count,
+                        best.downsampling_factor,
+                        best.order_by_uncertainty ? "uncertainty ordered"
+                                                  : "fixed order",
+                        best.latency * 1e3,
+                        best_error * 1e3,
+                        key.c_str());
+        }
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    const Options options = parse_options(argc, argv);
+    if (options.calibration_target > 0)
+    {
+        calibrate(options);
+        return 0;
+    }
+    if (options.csv) print_csv_header();
+
+    for (auto& tracker : options.trackers)
+    {
+        if (tracker != "particle_cpu" && tracker != "particle_gpu" &&
+            tracker != "gaussian")
+        {
+            std::cout << "ERROR: unknown tracker " << tracker << std::endl;
+            exit(-1);
+        }
+
+        // the particle count does not apply to the Gaussian tracker
+        const std::vector<int> particle_counts =
+            tracker == "gaussian" ? std::vector<int>(1, 0)
+                                  : options.particle_counts;
+
+        bool supported = true;
+        for (int part_count : options.part_counts)
+        {
+            for (int factor : options.downsampling_factors)
+            {
+                for (int particle_count : particle_counts)
+                {
+                    Configuration configuration;
+                    configuration.tracker = tracker;
+                    configuration.particle_count = particle_count;
+                    configuration.downsampling_factor = factor;
+                    configuration.part_count = part_count;
+
+                    Result result;
+                    supported = run(configuration, options, result);
+                    if (!supported) break;
+
+                    dbot::CameraData::Resolution resolution;
+                    resolution.width = 640 / factor;
+                    resolution.height = 480 / factor;
+                    print(configuration, result, resolution, options.csv);
+                }
+                if (!supported) break;
+            }
+            if (!supported) break;
+        }
+
+        if (!supported && !options.csv)
+        {
+            std::printf("%s: skipped, dbot was built without GPU support\n",
+                        tracker.c_str());
+        }
+    }
+
+    return 0;
+}
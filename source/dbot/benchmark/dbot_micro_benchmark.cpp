@@ -0,0 +1,451 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+
+/**
+ * \file dbot_micro_benchmark.cpp
+ * \date October 2026
+ *
+ * Google Benchmark micro-benchmarks of the per pixel models, the renderer
+ * and the pose utilities, isolated from the tracker
+ *
+ * Each benchmark reports its throughput in pixels, triangles or poses per
+ * second, such that optimizations of a kernel can be validated without the
+ * noise of a tracking run. Usage:
+ *
+ *   dbot_micro_benchmark [--benchmark_filter=<regex>]
+ *
+ * and the other options of Google Benchmark.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <dbot/benchmark/synthetic_scene.h>
+#include <dbot/model/kinect_pixel_model.h>
+#include <dbot/model/occlusion_model.h>
+#include <dbot/object_file_reader.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+#include <dbot/pose/pose_hashing.h>
+#include <dbot/pose/pose_vector.h>
+#include <dbot/rigid_body_renderer.h>
+
+#ifdef DBOT_BUILD_GPU
+#include <cuda_runtime.h>
+#include <dbot/default_shader_provider.h>
+#include <dbot/gpu/cuda_likelihood_evaluator.h>
+#include <dbot/gpu/kinect_image_model_gpu.h>
+#endif
+
+namespace
+{
+const int pixel_count = 4096;
+
+/**
+ * \brief Reports the items processed by all iterations as a rate under the
+ *        given unit, e.g. pixels/s
+ */
+void report_rate(benchmark::State& state, const char* unit, double items)
+{
+    state.counters[unit] = benchmark::Counter(
+        items * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+std::vector<float> random_depths(int count, float min, float max)
+{
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> depth(min, max);
+    std::vector<float> depths(count);
+    for (auto& value : depths) value = depth(generator);
+    return depths;
+}
+
+/**
+ * \brief Mesh of ellipsoids in front of the camera
+ */
+std::shared_ptr<dbot::ObjectModel> synthetic_object(int segments)
+{
+    return std::make_shared<dbot::ObjectModel>(
+        std::make_shared<dbot::SyntheticObjectLoader>(1, segments), false);
+}
+
+Eigen::Matrix3d camera_matrix(int rows, int cols)
+{
+    Eigen::Matrix3d matrix = Eigen::Matrix3d::Identity();
+    matrix(0, 0) = matrix(1, 1) = 525. * cols / 640.;
+    matrix(0, 2) = 0.5 * cols;
+    matrix(1, 2) = 0.5 * rows;
+    return matrix;
+}
+
+dbot::RigidBodyRenderer::Affine object_pose()
+{
+    return dbot::RigidBodyRenderer::Affine(
+        Eigen::Translation3d(0, 0, 0.3) *
+        Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitY()));
+}
+}
+
+/**
+ * Pixel probability of the branch selected by the argument: visible,
+ * occluded, visible with an infinite prediction, occluded with an infinite
+ * prediction
+ */
+static void BM_KinectPixelProbability(benchmark::State& state)
+{
+    const bool occluded = state.range(0) % 2 == 1;
+    const bool infinite = state.range(0) >= 2;
+
+    dbot::KinectPixelModel model;
+    const std::vector<float> observations =
+        random_depths(pixel_count, 0.5f, 1.5f);
+    const std::vector<float> predictions =
+        infinite ? std::vector<float>(pixel_count,
+                                      std::numeric_limits<float>::infinity())
+                 : random_depths(pixel_count, 0.5f, 1.5f);
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (int i = 0; i < pixel_count; i++)
+        {
+            model.Condition(predictions[i], occluded);
+            sum += model.Probability(observations[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report_rate(state, "pixels/s", pixel_count);
+}
+BENCHMARK(BM_KinectPixelProbability)->DenseRange(0, 3);
+
+/**
+ * Batched log likelihood ratio of the CPU sensor, which also updates the
+ * occlusions
+ */
+static void BM_KinectPixelLogLikelihoodRatio(benchmark::State& state)
+{
+    dbot::KinectPixelModel model;
+    const std::vector<float> observations =
+        random_depths(pixel_count, 0.5f, 1.5f);
+    const std::vector<float> predictions =
+        random_depths(pixel_count, 0.5f, 1.5f);
+    std::vector<float> occlusions(pixel_count);
+
+    for (auto _ : state)
+    {
+        std::fill(occlusions.begin(), occlusions.end(), 0.1f);
+        benchmark::DoNotOptimize(model.LogLikelihoodRatio(predictions.data(),
+                                                          observations.data(),
+                                                          occlusions.data(),
+                                                          pixel_count));
+    }
+    report_rate(state, "pixels/s", pixel_count);
+}
+BENCHMARK(BM_KinectPixelLogLikelihoodRatio);
+
+/**
+ * Occlusion propagation of pixels which were all updated in the same frame
+ * (argument 1) or at distinct times (argument 0)
+ */
+static void BM_OcclusionPropagate(benchmark::State& state)
+{
+    dbot::OcclusionModel model(0.1, 0.7);
+    std::vector<double> times(pixel_count, 1.);
+    if (state.range(0) == 0)
+    {
+        for (int i = 0; i < pixel_count; i++) times[i] = 0.001 * i;
+    }
+    std::vector<float> occlusions(pixel_count);
+
+    for (auto _ : state)
+    {
+        std::fill(occlusions.begin(), occlusions.end(), 0.1f);
+        model.Propagate(occlusions.data(), times.data(), pixel_count, 5.);
+        benchmark::DoNotOptimize(occlusions.data());
+    }
+    report_rate(state, "pixels/s", pixel_count);
+}
+BENCHMARK(BM_OcclusionPropagate)->Arg(0)->Arg(1);
+
+/**
+ * Rendering of an ellipsoid with the given latitude rings at the 640 x 480
+ * camera resolution divided by the second argument
+ */
+static void BM_RigidBodyRendererRender(benchmark::State& state)
+{
+    const int segments = state.range(0);
+    const int rows = 480 / state.range(1);
+    const int cols = 640 / state.range(1);
+
+    auto object = synthetic_object(segments);
+    dbot::RigidBodyRenderer renderer(object->mesh());
+    renderer.set_poses({object_pose()});
+
+    std::vector<int> indices;
+    std::vector<float> depths;
+    for (auto _ : state)
+    {
+        renderer.Render(camera_matrix(rows, cols), rows, cols, indices, depths);
+        benchmark::DoNotOptimize(depths.data());
+    }
+    report_rate(state, "triangles/s", object->mesh()->count_triangles());
+    report_rate(state, "pixels/s", double(rows) * cols);
+}
+BENCHMARK(BM_RigidBodyRendererRender)
+    ->Args({8, 4})
+    ->Args({8, 1})
+    ->Args({32, 4})
+    ->Args({32, 1})
+    ->Args({128, 4})
+    ->Args({128, 1});
+
+/**
+ * Parsing of a Wavefront file of an ellipsoid with the given latitude rings
+ */
+static void BM_ObjectFileReaderRead(benchmark::State& state)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices;
+    std::vector<std::vector<std::vector<int>>> triangles;
+    dbot::SyntheticObjectLoader(1, state.range(0)).load(vertices, triangles);
+
+    const std::string filename = "/tmp/dbot_micro_benchmark.obj";
+    {
+        std::ofstream file(filename.c_str());
+        for (const auto& vertex : vertices[0])
+        {
+            file << "v " << vertex(0) << " " << vertex(1) << " " << vertex(2)
+                 << "\n";
+        }
+        for (const auto& triangle : triangles[0])
+        {
+            file << "f " << triangle[0] + 1 << " " << triangle[1] + 1 << " "
+                 << triangle[2] + 1 << "\n";
+        }
+    }
+
+    for (auto _ : state)
+    {
+        dbot::ObjectFileReader reader;
+        reader.set_filename(filename);
+        reader.Read();
+        benchmark::DoNotOptimize(reader.get_indices()->data());
+    }
+    std::remove(filename.c_str());
+    report_rate(state, "triangles/s", triangles[0].size());
+}
+BENCHMARK(BM_ObjectFileReaderRead)->Arg(16)->Arg(128);
+
+/**
+ * Hash of a state of the given number of parts
+ */
+static void BM_PoseHash(benchmark::State& state)
+{
+    typedef dbot::FreeFloatingRigidBodiesState<> State;
+
+    State pose(state.range(0));
+    pose.setRandom();
+    dbot::PoseHash<State> hash;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hash(pose));
+    }
+    report_rate(state, "poses/s", 1);
+}
+BENCHMARK(BM_PoseHash)->Arg(1)->Arg(4);
+
+/**
+ * Application of a delta to a pose and its conversion to an affine
+ * transform, as for every part of every particle
+ */
+static void BM_PoseComposition(benchmark::State& state)
+{
+    dbot::PoseVector pose;
+    pose.position() = Eigen::Vector3d(0.1, 0.2, 0.8);
+    pose.orientation() = Eigen::Vector3d(0.1, 0.2, 0.3);
+    dbot::PoseVector delta;
+    delta.position() = Eigen::Vector3d(0.001, 0.002, 0.003);
+    delta.orientation() = Eigen::Vector3d(0.01, 0.02, 0.03);
+
+    for (auto _ : state)
+    {
+        dbot::PoseVector composed = pose;
+        composed.apply_delta(delta);
+        benchmark::DoNotOptimize(composed.affine().matrix().data());
+    }
+    report_rate(state, "poses/s", 1);
+}
+BENCHMARK(BM_PoseComposition);
+
+#ifdef DBOT_BUILD_GPU
+/**
+ * Weighting of the given number of poses at 320 x 240 by the CUDA
+ * evaluator, on a synthetic texture with an ellipse in every tile instead of
+ * rendered poses
+ */
+static void BM_CudaEvaluatorWeighPoses(benchmark::State& state)
+{
+    const int rows = 240;
+    const int cols = 320;
+    const int nr_poses = state.range(0);
+    const int nr_poses_per_row = std::min(nr_poses, 16);
+    const int nr_poses_per_col =
+        (nr_poses + nr_poses_per_row - 1) / nr_poses_per_row;
+
+    CudaEvaluator evaluator(rows, cols);
+    evaluator.init(
+        0.1f, 0.7f, 0.1f, 0.01f, 0.003f, 0.0014247f, 6.0f, -std::log(0.5f));
+    evaluator.allocate_memory_for_max_poses(
+        nr_poses, nr_poses_per_row, nr_poses_per_col);
+    evaluator.set_number_of_poses(nr_poses);
+
+    const int width = nr_poses_per_row * cols;
+    const int height = nr_poses_per_col * rows;
+    std::vector<float> texture(size_t(width) * height, 0.f);
+    for (int row = 0; row < height; row++)
+    {
+        for (int col = 0; col < width; col++)
+        {
+            const double x = double(col % cols) / cols - 0.5;
+            const double y = double(row % rows) / rows - 0.5;
+            if (x * x + y * y < 0.1)
+            {
+                texture[size_t(row) * width + col] = 0.8f + 0.1f * x;
+            }
+        }
+    }
+    cudaChannelFormatDesc format = cudaCreateChannelDesc<float>();
+    cudaArray_t texture_array;
+    cudaMallocArray(&texture_array, &format, width, height);
+    cudaMemcpy2DToArray(texture_array,
+                        0,
+                        0,
+                        texture.data(),
+                        width * sizeof(float),
+                        width * sizeof(float),
+                        height,
+                        cudaMemcpyHostToDevice);
+    evaluator.map_texture_to_texture_array(texture_array);
+
+    const std::vector<float> observations =
+        random_depths(rows * cols, 0.75f, 0.85f);
+    std::vector<int> indices(nr_poses, 0);
+    std::vector<float> log_likelihoods;
+    for (auto _ : state)
+    {
+        evaluator.set_observations(observations.data(), rows * cols);
+        evaluator.set_occlusion_indices(indices.data(), nr_poses);
+        evaluator.weigh_poses(false, log_likelihoods);
+        benchmark::DoNotOptimize(log_likelihoods.data());
+    }
+    cudaFreeArray(texture_array);
+    report_rate(state, "pixels/s", double(nr_poses) * rows * cols);
+}
+BENCHMARK(BM_CudaEvaluatorWeighPoses)->Arg(100)->Arg(400)->Arg(1600);
+
+/**
+ * Evaluation of the given number of identical poses of an ellipsoid at
+ * 320 x 240 by the GPU model, rendering into a single texture or into
+ * layered textures if the second argument is 1. Fails if the render target
+ * does not fit the poses, as the single texture does beyond its grid of
+ * poses, or if any pose is weighted differently from the first, e.g.
+ * because a layer was not rendered or read back.
+ */
+static void BM_KinectImageModelGpuLoglikes(benchmark::State& state)
+{
+    typedef dbot::FreeFloatingRigidBodiesState<> State;
+    typedef dbot::KinectImageModelGPU<State> Model;
+
+    const int rows = 240;
+    const int cols = 320;
+    const int nr_poses = state.range(0);
+    const bool layered = state.range(1) != 0;
+
+    auto object = synthetic_object(16);
+    Model model(camera_matrix(rows, cols),
+                rows,
+                cols,
+                nr_poses,
+                object->mesh(),
+                std::make_shared<dbot::DefaultShaderProvider>(),
+                false,
+                false,
+                0.1,
+                0.033,
+                0.1f,
+                0.7f,
+                0.01f,
+                0.003f,
+                0.0014247f,
+                6.0f,
+                -std::log(0.5f),
+                true,
+                2,
+                false,
+                "",
+                "",
+                0,
+                0,
+                8,
+                0,
+                layered);
+    if (model.max_sample_count() < nr_poses)
+    {
+        state.SkipWithError("the render target does not fit the poses");
+        return;
+    }
+
+    Model::StateArray deltas(nr_poses);
+    for (int i = 0; i < nr_poses; i++)
+    {
+        deltas(i) = State(1);
+        deltas(i).setZero();
+        deltas(i).component(0).position() = Eigen::Vector3d(0, 0, 0.3);
+    }
+    model.set_observation(Model::Observation::Constant(rows, cols, 1.));
+
+    Model::IntArray indices = Model::IntArray::Zero(nr_poses);
+    Model::RealArray log_likelihoods;
+    for (auto _ : state)
+    {
+        log_likelihoods = model.loglikes(deltas, indices, false);
+        benchmark::DoNotOptimize(log_likelihoods.data());
+    }
+
+    for (int i = 1; i < nr_poses; i++)
+    {
+        if (!(std::fabs(log_likelihoods(i) - log_likelihoods(0)) <=
+              1e-6 * std::fabs(log_likelihoods(0))))
+        {
+            state.SkipWithError("identical poses are weighted differently");
+            return;
+        }
+    }
+    report_rate(state, "poses/s", nr_poses);
+}
+BENCHMARK(BM_KinectImageModelGpuLoglikes)
+    ->Args({1000, 0})
+    ->Args({1000, 1})
+    ->Args({10000, 0})
+    ->Args({10000, 1});
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,211 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file synthetic_scene.cpp
+ * \date October 2026
+ */
+
+#include <dbot/benchmark/synthetic_scene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <dbot/virtual_camera_data_provider.h>
+
+namespace dbot
+{
+namespace
+{
+const double part_spacing = 0.07;
+const Eigen::Vector3d part_radii(0.03, 0.02, 0.045);
+
+/**
+ * \brief Standard deviation of Kinect depth measurements at the given depth
+ *        in meters, after Nguyen et al., 3DIMPVT 2012
+ */
+double depth_noise_std(double depth)
+{
+    return 0.0012 + 0.0019 * (depth - 0.4) * (depth - 0.4);
+}
+}
+
+SyntheticObjectLoader::SyntheticObjectLoader(int part_count, int segments)
+    : part_count_(part_count), segments_(std::max(segments, 2))
+{
+}
+
+void SyntheticObjectLoader::load(
+    std::vector<std::vector<Eigen::Vector3d>>& vertices,
+    std::vector<std::vector<std::vector<int>>>& triangle_indices) const
+{
+    const int rings = segments_ - 1;
+    const int ring_size = 2 * segments_;
+    const int south_pole = 1 + rings * ring_size;
+    auto ring_vertex = [ring_size](int ring, int j)
+    {
+        return 1 + ring * ring_size + j % ring_size;
+    };
+
+    vertices.assign(part_count_, std::vector<Eigen::Vector3d>());
+    triangle_indices.assign(part_count_, std::vector<std::vector<int>>());
+    for (int part = 0; part < part_count_; part++)
+    {
+        const Eigen::Vector3d center(
+            (part - 0.5 * (part_count_ - 1)) * part_spacing, 0, 0);
+
+        std::vector<Eigen::Vector3d>& part_vertices = vertices[part];
+        part_vertices.push_back(center + Eigen::Vector3d(0, 0, part_radii.z()));
+        for (int ring = 0; ring < rings; ring++)
+        {
+            const double theta = M_PI * (ring + 1) / segments_;
+            for (int j = 0; j < ring_size; j++)
+            {
+                const double phi = 2 * M_PI * j / ring_size;
+                part_vertices.push_back(
+                    center + Eigen::Vector3d(
+                                 part_radii.x() * std::sin(theta) *
+                                     std::cos(phi),
+                                 part_radii.y() * std::sin(theta) *
+                                     std::sin(phi),
+                                 part_radii.z() * std::cos(theta)));
+            }
+        }
+        part_vertices.push_back(center -
+                                Eigen::Vector3d(0, 0, part_radii.z()));
+
+        // counter clockwise seen from the outside
+        std::vector<std::vector<int>>& part_triangles = triangle_indices[part];
+        for (int j = 0; j < ring_size; j++)
+        {
+            part_triangles.push_back(
+                {0, ring_vertex(0, j), ring_vertex(0, j + 1)});
+            for (int ring = 0; ring + 1 < rings; ring++)
+            {
+                part_triangles.push_back({ring_vertex(ring, j),
+                                          ring_vertex(ring + 1, j),
+                                          ring_vertex(ring + 1, j + 1)});
+                part_triangles.push_back({ring_vertex(ring, j),
+                                          ring_vertex(ring + 1, j + 1),
+                                          ring_vertex(ring, j + 1)});
+            }
+            part_triangles.push_back({south_pole,
+                                      ring_vertex(rings - 1, j + 1),
+                                      ring_vertex(rings - 1, j)});
+        }
+    }
+}
+
+SyntheticScene::SyntheticScene(const SyntheticSceneParameters& params)
+    : params_(params), generator_(params.seed)
+{
+    object_model_ = std::make_shared<ObjectModel>(
+        std::make_shared<SyntheticObjectLoader>(params_.part_count,
+                                                params_.segments),
+        false);
+
+    camera_data_ = std::make_shared<CameraData>(
+        std::make_shared<VirtualCameraDataProvider>(
+            params_.downsampling_factor, "/synthetic_camera"));
+
+    renderer_ = std::make_shared<RigidBodyRenderer>(
+        object_model_->mesh(),
+        camera_data_->camera_matrix(),
+        camera_data_->resolution().height,
+        camera_data_->resolution().width);
+    poses_.resize(params_.part_count);
+}
+
+auto SyntheticScene::state(int frame) const -> State
+{
+    const double t = frame * delta_time();
+
+    // a slow Lissajous figure at 0.8 m in front of the camera
+    RigidBodyRenderer::Affine pose =
+        Eigen::Translation3d(0.06 * std::sin(0.9 * t),
+                             0.04 * std::sin(1.3 * t),
+                             0.8 + 0.05 * std::sin(0.7 * t)) *
+        Eigen::AngleAxisd(0.4 * std::sin(0.5 * t), Eigen::Vector3d::UnitX()) *
+        Eigen::AngleAxisd(0.5 * std::sin(0.8 * t), Eigen::Vector3d::UnitY()) *
+        Eigen::AngleAxisd(0.6 * std::sin(0.6 * t), Eigen::Vector3d::UnitZ());
+
+    State state(params_.part_count);
+    for (int part = 0; part < params_.part_count; part++)
+    {
+        state.component(part).affine(pose);
+    }
+    return state;
+}
+
+DepthFrame::ConstPtr SyntheticScene::frame(int frame)
+{
+    const State truth = state(frame);
+    for (int part = 0; part < params_.part_count; part++)
+    {
+        poses_[part] = truth.component(part).affine();
+    }
+    renderer_->set_poses(poses_);
+    renderer_->Render(depth_);
+
+    std::normal_distribution<float> noise(0, 1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    auto observation = std::make_shared<DepthFrame>(
+        camera_data_->resolution().height, camera_data_->resolution().width);
+    float* data = observation->data();
+    for (int i = 0; i < observation->size(); i++)
+    {
+        const double depth = std::isinf(depth_[i]) ? params_.background_depth
+                                                   : double(depth_[i]);
+        if (uniform(generator_) < params_.dropout_probability)
+        {
+            data[i] = std::numeric_limits<float>::quiet_NaN();
+        }
+        else
+        {
+            data[i] = depth + depth_noise_std(depth) * noise(generator_);
+        }
+    }
+
+    // 0 marks an unknown timestamp
+    observation->timestamp((frame + 1) * delta_time());
+    return observation;
+}
+
+double SyntheticScene::translation_error(const State& estimate,
+                                         const State& truth)
+{
+    double error = 0;
+    for (int part = 0; part < truth.count(); part++)
+    {
+        error += (estimate.component(part).position() -
+                  truth.component(part).position()).norm();
+    }
+    return error / truth.count();
+}
+
+double SyntheticScene::rotation_error(const State& estimate,
+                                      const State& truth)
+{
+    double error = 0;
+    for (int part = 0; part < truth.count(); part++)
+    {
+        const double dot = std::abs(
+            estimate.component(part).orientation().quaternion().dot(
+                truth.component(part).orientation().quaternion()));
+        error += 2 * std::acos(std::min(dot, 1.));
+    }
+    return error / truth.count();
+}
+}
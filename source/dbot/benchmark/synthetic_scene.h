@@ -0,0 +1,133 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file synthetic_scene.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/camera_data.h>
+#include <dbot/depth_frame.h>
+#include <dbot/object_model.h>
+#include <dbot/object_model_loader.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+#include <dbot/rigid_body_renderer.h>
+
+namespace dbot
+{
+/**
+ * \brief Object of ellipsoid parts lined up along the x axis of the object
+ *        frame, such that the orientation of every part is observable
+ */
+class SyntheticObjectLoader : public ObjectModelLoader
+{
+public:
+    /**
+     * \param segments  latitude rings per part, every part has about
+     *                  4 * segments^2 triangles
+     */
+    explicit SyntheticObjectLoader(int part_count, int segments = 16);
+
+    void load(std::vector<std::vector<Eigen::Vector3d>>& vertices,
+              std::vector<std::vector<std::vector<int>>>& triangle_indices)
+        const;
+
+private:
+    int part_count_;
+    int segments_;
+};
+
+struct SyntheticSceneParameters
+{
+    int part_count = 1;
+    /* latitude rings of every ellipsoid part */
+    int segments = 16;
+    /* resolution of the 640 x 480 virtual camera is divided by this */
+    int downsampling_factor = 2;
+    double frame_rate = 30.;
+    /* depth of the wall behind the object */
+    double background_depth = 1.5;
+    /* fraction of the pixels without a depth measurement */
+    double dropout_probability = 0.02;
+    unsigned int seed = 1;
+};
+
+/**
+ * \brief Object moving in front of a depth camera along a smooth ground
+ *        truth trajectory
+ *
+ * The observations are rendered with a RigidBodyRenderer in front of a wall
+ * and distorted like Kinect depth images: zero mean Gaussian noise whose
+ * standard deviation grows quadratically with the depth, and pixels without
+ * a measurement. All parts of the object follow the same trajectory. The
+ * object model is not centered, the poses of the parts are the pose of the
+ * object.
+ */
+class SyntheticScene
+{
+public:
+    typedef FreeFloatingRigidBodiesState<> State;
+
+public:
+    explicit SyntheticScene(const SyntheticSceneParameters& params);
+
+    const std::shared_ptr<ObjectModel>& object_model() const
+    {
+        return object_model_;
+    }
+
+    const std::shared_ptr<CameraData>& camera_data() const
+    {
+        return camera_data_;
+    }
+
+    double delta_time() const { return 1. / params_.frame_rate; }
+    /**
+     * \brief Ground truth state of the object at the given frame
+     */
+    State state(int frame) const;
+
+    /**
+     * \brief Noisy observation of the given frame, stamped with its time
+     */
+    DepthFrame::ConstPtr frame(int frame);
+
+    /**
+     * \brief Mean distance of the parts of the estimate to the ground truth
+     */
+    static double translation_error(const State& estimate, const State& truth);
+
+    /**
+     * \brief Mean rotation angle between the parts of the estimate and the
+     *        ground truth in radian
+     */
+    static double rotation_error(const State& estimate, const State& truth);
+
+private:
+    SyntheticSceneParameters params_;
+    std::shared_ptr<ObjectModel> object_model_;
+    std::shared_ptr<CameraData> camera_data_;
+    std::shared_ptr<RigidBodyRenderer> renderer_;
+    std::mt19937 generator_;
+    std::vector<float> depth_;
+    std::vector<RigidBodyRenderer::Affine> poses_;
+};
+}
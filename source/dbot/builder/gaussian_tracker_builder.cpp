@@ -23,6 +23,7 @@
 
 #include <dbot/builder/gaussian_tracker_builder.h>
 #include <dbot/simple_wavefront_object_loader.h>
+#include <thread>
 
 namespace dbot
 {
@@ -39,11 +40,21 @@ std::shared_ptr<GaussianTracker> GaussianTrackerBuilder::build()
 
     auto filter = create_filter(object_model);
 
-    auto tracker =
-        std::make_shared<GaussianTracker>(filter,
-                                          object_model,
-                                          param_.moving_average_update_rate,
-                                          param_.center_object_frame);
+    auto tracker = std::make_shared<GaussianTracker>(
+        filter,
+        object_model,
+        param_.moving_average_update_rate,
+        param_.center_object_frame,
+        param_.observation.pixel_region_margin);
+    tracker->worker_pool(param_.worker_pool);
+    if (!param_.filter_thread_affinity.empty() || !param_.worker_pool)
+    {
+        tracker->filter_thread_affinity(param_.filter_thread_affinity);
+    }
+    else
+    {
+        tracker->filter_thread_affinity(param_.worker_pool->caller_affinity());
+    }
 
     return tracker;
 }
@@ -86,8 +97,18 @@ auto GaussianTrackerBuilder::create_sensor(
 
     auto renderer = create_renderer(object_model);
 
-    auto pixel_sensor = PixelModel(
-        renderer, param.bg_depth, param.fg_noise_std, param.bg_noise_std);
+    auto pixel_sensor = PixelModel(renderer,
+                                   param.bg_depth,
+                                   param.fg_noise_std,
+                                   param.bg_noise_std,
+                                   fl::DimensionOf<State>::Value,
+                                   param.render_cache_capacity,
+                                   param.render_cache_shard_count);
+    pixel_sensor.render_thread_count(
+        param.render_thread_count > 0
+            ? param.render_thread_count
+            : int(std::thread::hardware_concurrency()));
+    pixel_sensor.worker_pool(param_.worker_pool);
 
     auto tail_sensor =
         TailModel(param.uniform_tail_min, param.uniform_tail_max);
@@ -103,8 +124,15 @@ std::shared_ptr<ObjectModel> GaussianTrackerBuilder::create_object_model(
 {
     auto object_model = std::make_shared<ObjectModel>(
         std::shared_ptr<ObjectModelLoader>(
-            new SimpleWavefrontObjectModelLoader(ori)),
+            new SimpleWavefrontObjectModelLoader(
+                ori, param_.mesh_cache_directory, param_.worker_pool)),
         param_.center_object_frame);
+    object_model->worker_pool(param_.worker_pool);
+
+    if (param_.level_of_detail_count > 1)
+    {
+        object_model->build_levels_of_detail(param_.level_of_detail_count);
+    }
 
     return object_model;
 }
@@ -123,12 +151,18 @@ std::shared_ptr<RigidBodyRenderer> GaussianTrackerBuilder::create_renderer(
     const std::shared_ptr<ObjectModel>& object_model) const
 {
     std::shared_ptr<RigidBodyRenderer> renderer(
-        new RigidBodyRenderer(object_model->vertices(),
-                              object_model->triangle_indices(),
+        new RigidBodyRenderer(object_model->mesh(),
                               camera_data_->camera_matrix(),
                               camera_data_->resolution().height,
                               camera_data_->resolution().width));
 
+    for (int level = 1; level < object_model->count_levels(); level++)
+    {
+        renderer->add_level_of_detail(object_model->mesh(level));
+    }
+    renderer->level_of_detail_budget(
+        param_.level_of_detail_pixels_per_triangle);
+
     return renderer;
 }
 }
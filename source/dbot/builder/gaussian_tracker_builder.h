@@ -33,6 +33,7 @@
 #include <dbot/camera_data.h>
 #include <dbot/object_resource_identifier.h>
 #include <dbot/tracker/gaussian_tracker.h>
+#include <dbot/worker_pool.h>
 #include <exception>
 
 namespace dbot
@@ -57,6 +58,20 @@ public:
         double ut_alpha;
         double moving_average_update_rate;
         bool center_object_frame;
+        /* directory of the binary copies of the parsed meshes, disabled if
+         * empty, see MeshCache::default_directory() */
+        std::string mesh_cache_directory;
+        /* simplified meshes the renderer chooses from by the projected
+         * object size, 1 renders the loaded mesh only */
+        int level_of_detail_count = 1;
+        /* projected pixels per triangle below which a finer level is used */
+        double level_of_detail_pixels_per_triangle = 4.;
+        /* pool the meshes are loaded and the sigma points are rendered on
+         * instead of render_thread_count threads, kept alive by the tracker */
+        std::shared_ptr<WorkerPool> worker_pool;
+        /* cores the threads running the filter steps are pinned to, the
+         * core the worker pool leaves to its caller if empty */
+        CpuAffinity filter_thread_affinity;
 
         struct Observation
         {
@@ -67,6 +82,16 @@ public:
             double uniform_tail_min;
             double uniform_tail_max;
             int sensors;
+            /* rendered states kept by the pixel models between two frames */
+            int render_cache_capacity = 1024;
+            /* independently locked parts of the render cache */
+            int render_cache_shard_count = 16;
+            /* threads rendering the sigma points of an update, one per
+             * hardware thread if 0 */
+            int render_thread_count = 0;
+            /* evaluate only the pixels around the projected object plus
+             * this margin, the whole image if negative */
+            int pixel_region_margin = -1;
         };
 
         ObjectResourceIdentifier ori;
@@ -0,0 +1,173 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file latency_configuration.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace dbot
+{
+/**
+ * \brief Particle count, resolution and block schedule which keep the
+ *        latency of a filter step below a target, as calibrated by
+ *        dbot_benchmark --calibrate
+ */
+struct LatencyConfiguration
+{
+    int particle_count = 0;
+    /// of the camera resolution, which the camera data provider applies
+    int downsampling_factor = 1;
+    bool order_by_uncertainty = false;
+    /// measured 90th percentile of the filter step in seconds
+    double latency = 0;
+
+    /**
+     * \brief Writes the particle count and the block schedule into the
+     *        parameters of ParticleTrackerBuilder and RbSensorBuilder. Every
+     *        particle is evaluated once per sampling block.
+     */
+    template <typename TrackerParameters, typename SensorParameters>
+    void apply(int sampling_block_count,
+               TrackerParameters& tracker_params,
+               SensorParameters& sensor_params) const
+    {
+        tracker_params.evaluation_count = particle_count * sampling_block_count;
+        tracker_params.sampling_schedule.order_by_uncertainty =
+            order_by_uncertainty;
+        sensor_params.sample_count = particle_count;
+    }
+};
+
+/**
+ * \brief On-disk cache of calibrated latency configurations
+ *
+ * The file holds one line "key particle_count downsampling_factor
+ * order_by_uncertainty latency" per setup. The key describes the tracker
+ * and the target, see make_key(), the configurations hold for the machine
+ * they were calibrated on. Entries of other setups are kept when the file
+ * is rewritten.
+ */
+class LatencyConfigurationCache
+{
+public:
+    explicit LatencyConfigurationCache(const std::string& path) : path_(path)
+    {
+        load();
+    }
+
+    /**
+     * \brief Default cache file, $DBOT_LATENCY_CONFIGURATION if set,
+     *        otherwise $HOME/.dbot_latency_configuration
+     */
+    static std::string default_path()
+    {
+        const char* path = std::getenv("DBOT_LATENCY_CONFIGURATION");
+        if (path && *path) return path;
+
+        const char* home = std::getenv("HOME");
+        return std::string(home ? home : ".") + "/.dbot_latency_configuration";
+    }
+
+    /**
+     * \brief Key of a tracker with the given number of parts and a latency
+     *        target in seconds, e.g. "particle_gpu/2/0.033"
+     */
+    static std::string make_key(const std::string& tracker,
+                                int part_count,
+                                double target_latency)
+    {
+        std::ostringstream stream;
+        stream << tracker << "/" << part_count << "/" << target_latency;
+
+        std::string key = stream.str();
+        for (auto& c : key)
+        {
+            if (c == ' ' || c == '\t' || c == '\n') c = '_';
+        }
+        return key;
+    }
+
+    bool find(const std::string& key, LatencyConfiguration& configuration) const
+    {
+        auto entry = entries_.find(key);
+        if (entry == entries_.end()) return false;
+
+        configuration = entry->second;
+        return true;
+    }
+
+    /**
+     * \brief Stores the configuration and rewrites the file
+     *
+     * \return false if the file could not be written
+     */
+    bool store(const std::string& key,
+               const LatencyConfiguration& configuration)
+    {
+        // merge with entries written by other processes in the meantime
+        load();
+        entries_[key] = configuration;
+
+        const std::string temporary_path = path_ + ".tmp";
+        {
+            std::ofstream file(temporary_path.c_str());
+            if (!file) return false;
+
+            for (auto& entry : entries_)
+            {
+                const LatencyConfiguration& value = entry.second;
+                file << entry.first << " " << value.particle_count << " "
+                     << value.downsampling_factor << " "
+                     << value.order_by_uncertainty << " " << value.latency
+                     << "\n";
+            }
+            if (!file) return false;
+        }
+        return std::rename(temporary_path.c_str(), path_.c_str()) == 0;
+    }
+
+    const std::string& path() const { return path_; }
+private:
+    void load()
+    {
+        std::ifstream file(path_.c_str());
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream stream(line);
+            std::string key;
+            LatencyConfiguration value;
+            if (stream >> key >> value.particle_count >>
+                    value.downsampling_factor >> value.order_by_uncertainty >>
+                    value.latency &&
+                value.particle_count > 0 && value.downsampling_factor > 0)
+            {
+                entries_[key] = value;
+            }
+        }
+    }
+
+    std::string path_;
+    std::map<std::string, LatencyConfiguration> entries_;
+};
+}
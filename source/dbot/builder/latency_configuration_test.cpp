@@ -0,0 +1,94 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file latency_configuration_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include <dbot/builder/latency_configuration.h>
+
+namespace
+{
+std::string temporary_cache_path()
+{
+    return testing::TempDir() + "dbot_latency_configuration_test";
+}
+
+struct TrackerParameters
+{
+    int evaluation_count = 0;
+    struct
+    {
+        bool order_by_uncertainty = false;
+    } sampling_schedule;
+};
+
+struct SensorParameters
+{
+    int sample_count = 0;
+};
+}
+
+TEST(LatencyConfigurationTests, make_key_is_single_token)
+{
+    EXPECT_EQ("particle_gpu/2/0.033",
+              dbot::LatencyConfigurationCache::make_key(
+                  "particle_gpu", 2, 0.033));
+    EXPECT_EQ("my_tracker/1/0.1",
+              dbot::LatencyConfigurationCache::make_key("my tracker", 1, 0.1));
+}
+
+TEST(LatencyConfigurationTests, stored_configuration_persists)
+{
+    std::remove(temporary_cache_path().c_str());
+    {
+        dbot::LatencyConfigurationCache cache(temporary_cache_path());
+        dbot::LatencyConfiguration configuration;
+        configuration.particle_count = 400;
+        configuration.downsampling_factor = 4;
+        configuration.order_by_uncertainty = true;
+        configuration.latency = 0.021;
+        ASSERT_TRUE(cache.store("a", configuration));
+    }
+
+    dbot::LatencyConfigurationCache cache(temporary_cache_path());
+    dbot::LatencyConfiguration configuration;
+    EXPECT_FALSE(cache.find("b", configuration));
+    ASSERT_TRUE(cache.find("a", configuration));
+    EXPECT_EQ(400, configuration.particle_count);
+    EXPECT_EQ(4, configuration.downsampling_factor);
+    EXPECT_TRUE(configuration.order_by_uncertainty);
+    EXPECT_DOUBLE_EQ(0.021, configuration.latency);
+
+    std::remove(temporary_cache_path().c_str());
+}
+
+TEST(LatencyConfigurationTests, apply_evaluates_every_particle_per_block)
+{
+    dbot::LatencyConfiguration configuration;
+    configuration.particle_count = 200;
+    configuration.order_by_uncertainty = true;
+
+    TrackerParameters tracker_params;
+    SensorParameters sensor_params;
+    configuration.apply(3, tracker_params, sensor_params);
+
+    EXPECT_EQ(600, tracker_params.evaluation_count);
+    EXPECT_TRUE(tracker_params.sampling_schedule.order_by_uncertainty);
+    EXPECT_EQ(200, sensor_params.sample_count);
+}
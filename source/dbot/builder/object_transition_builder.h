@@ -31,6 +31,8 @@
 
 #include <Eigen/Dense>
 #include <dbot/builder/transition_function_builder.h>
+#include <dbot/model/object_transition.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
 #include <fl/model/transition/linear_transition.hpp>
 #include <fl/util/meta.hpp>
 #include <fl/util/profiling.hpp>
@@ -38,20 +40,6 @@
 
 namespace dbot
 {
-template <typename State>
-struct ObjectStateTrait
-{
-    enum
-    {
-        NoiseDim = State::SizeAtCompileTime != -1 ? State::SizeAtCompileTime / 2
-                                                  : Eigen::Dynamic,
-        InputDim = Eigen::Dynamic
-    };
-
-    typedef Eigen::Matrix<typename State::Scalar, NoiseDim, 1> Noise;
-    typedef Eigen::Matrix<typename State::Scalar, InputDim, 1> Input;
-};
-
 template <typename State>
 class ObjectTransitionBuilder
     : public TransitionFunctionBuilder<State,
@@ -81,14 +69,25 @@ public:
     };
 
     ObjectTransitionBuilder(const Parameters& param) : param_(param) {}
+    /**
+     * \brief Builds the transition which updates each part on its own, see
+     *        ObjectTransition
+     */
     virtual std::shared_ptr<Model> build() const
     {
-        auto model =
-            std::shared_ptr<DerivedModel>(new DerivedModel(build_model()));
+        typename ObjectTransition<State>::Sigma sigma;
+        sigma << param_.linear_sigma_x, param_.linear_sigma_y,
+            param_.linear_sigma_z, param_.angular_sigma_x,
+            param_.angular_sigma_y, param_.angular_sigma_z;
 
-        return std::static_pointer_cast<Model>(model);
+        return std::make_shared<ObjectTransition<State>>(
+            param_.part_count, sigma, param_.velocity_factor);
     }
 
+    /**
+     * \brief Builds the same transition as a linear model with dense matrices
+     *        over all parts, as required by the Gaussian filter
+     */
     virtual DerivedModel build_model() const
     {
         int total_state_dim = param_.part_count * 12;
@@ -34,7 +34,9 @@
 #include <dbot/object_model_loader.h>
 #include <dbot/object_resource_identifier.h>
 #include <dbot/tracker/particle_tracker.h>
+#include <dbot/worker_pool.h>
 #include <exception>
+#include <iostream>
 
 namespace dbot
 {
@@ -45,8 +47,8 @@ template <typename Tracker>
 class ParticleTrackerBuilder
 {
 public:
-    typedef typename Tracker::State State;
-    typedef typename Tracker::Noise Noise;
+    typedef typename Tracker::FilterState State;
+    typedef typename Tracker::FilterNoise Noise;
     typedef typename Tracker::Input Input;
 
     /* == Model Builder Interfaces ========================================== */
@@ -68,6 +70,31 @@ public:
         double moving_average_update_rate;
         double max_kl_divergence;
         bool center_object_frame;
+        ResamplingScheme resampling_scheme = MULTINOMIAL_RESAMPLING;
+        int resampling_thread_count = 1;
+        AdaptiveSamplingParameters adaptive_sampling;
+        /* requires a sensor with a coarse level, see
+         * RbSensorBuilder::Parameters::coarse_downsampling_factor */
+        CoarseToFineParameters coarse_to_fine;
+        /* used by ParticleTracker::reacquire() */
+        ReacquisitionParameters reacquisition;
+        /* groups of parts which are sampled in one block, e.g. rigidly
+         * coupled ones. Every other part is sampled in a block of its own */
+        std::vector<std::vector<int>> coupled_parts;
+        /* sample the translation and the rotation of the parts in separate
+         * blocks, for transitions with 6 noise dimensions per part */
+        bool split_translation_rotation = false;
+        SamplingScheduleParameters sampling_schedule;
+        /* skips the frames in which nothing changed around the object, see
+         * FrameChangeDetector */
+        FrameSkippingParameters frame_skipping;
+        /* pool the resampling runs on instead of resampling_thread_count
+         * threads, kept alive by the tracker. Usually the pool of the
+         * sensor parameters */
+        std::shared_ptr<WorkerPool> worker_pool;
+        /* cores the threads running the filter steps are pinned to, the
+         * core the worker pool leaves to its caller if empty */
+        CpuAffinity filter_thread_affinity;
     };
 
 public:
@@ -90,20 +117,52 @@ public:
     /**
      * \brief Builds the Rbc PF tracker
      */
-    std::shared_ptr<ParticleTracker> build()
+    std::shared_ptr<Tracker> build()
     {
         auto filter = create_filter(object_model_, params_.max_kl_divergence);
 
-        auto tracker = std::make_shared<ParticleTracker>(
+        auto tracker = std::make_shared<Tracker>(
             filter,
             object_model_,
             params_.evaluation_count,
             params_.moving_average_update_rate,
             params_.center_object_frame);
+        tracker->reacquisition(params_.reacquisition);
+        tracker->worker_pool(params_.worker_pool);
+        if (!params_.filter_thread_affinity.empty() || !params_.worker_pool)
+        {
+            tracker->filter_thread_affinity(params_.filter_thread_affinity);
+        }
+        else
+        {
+            tracker->filter_thread_affinity(
+                params_.worker_pool->caller_affinity());
+        }
+        if (params_.frame_skipping.enabled)
+        {
+            tracker->frame_change_detector(create_frame_change_detector());
+        }
 
         return tracker;
     }
 
+    /**
+     * \brief Creates the detector of the frames the tracker skips, at the
+     *        resolution of the camera of the sensor
+     */
+    virtual std::shared_ptr<FrameChangeDetector> create_frame_change_detector()
+        const
+    {
+        const auto& camera_data = sensor_builder_->camera_data();
+        const CameraData::Resolution resolution = camera_data->resolution();
+        return std::make_shared<FrameChangeDetector>(
+            camera_data->camera_matrix(),
+            resolution.height,
+            resolution.width,
+            RegionOfInterest::part_boxes(*object_model_->mesh()),
+            params_.frame_skipping);
+    }
+
     /**
      * \brief Creates an instance of the Rbc particle filter
      *
@@ -117,12 +176,27 @@ public:
         auto transition = transition_builder_->build();
         auto sensor = sensor_builder_->build();
 
+        const int part_count = object_model->count_parts();
         auto sampling_blocks = create_sampling_blocks(
-            object_model->count_parts(),
-            transition->noise_dimension() / object_model->count_parts());
+            part_count, transition->noise_dimension() / part_count);
 
-        auto filter = std::shared_ptr<Filter>(
-            new Filter(transition, sensor, sampling_blocks, max_kl_divergence));
+        Resampler resampler(params_.resampling_scheme,
+                            params_.resampling_thread_count);
+        resampler.worker_pool(params_.worker_pool);
+
+        auto filter = std::shared_ptr<Filter>(new Filter(transition,
+                                                         sensor,
+                                                         sampling_blocks,
+                                                         max_kl_divergence,
+                                                         resampler));
+        filter->worker_pool(params_.worker_pool);
+        filter->adaptive_sampling(params_.adaptive_sampling);
+        filter->coarse_to_fine(params_.coarse_to_fine);
+        filter->sampling_schedule(params_.sampling_schedule);
+        filter->sampling_block_states(create_sampling_block_states(
+            sampling_blocks,
+            transition->noise_dimension() / part_count,
+            transition->state_dimension() / part_count));
         return filter;
     }
 
@@ -130,25 +204,104 @@ public:
      * \brief Creates a sampling block definition used by the coordinate
      *        particle filter
      *
+     * Each group of coupled parts forms one block, ordered by its first part,
+     * every other part a block of its own. The blocks are split into their
+     * translation and rotation noise if requested.
+     *
      * \param blocks		Number of objects or object parts
-     * \param block_size	State dimension of each part
+     * \param block_size	Noise dimension of each part
      */
     virtual std::vector<std::vector<int>> create_sampling_blocks(
         int blocks,
         int block_size) const
     {
-        std::vector<std::vector<int>> sampling_blocks(blocks);
+        // the coupled group of each part, -1 if it is not coupled
+        std::vector<int> coupled_groups(blocks, -1);
+        for (size_t g = 0; g < params_.coupled_parts.size(); ++g)
+        {
+            for (const int part : params_.coupled_parts[g])
+            {
+                if (part < 0 || part >= blocks || coupled_groups[part] != -1)
+                {
+                    std::cout << "ERROR: part " << part << " of " << blocks
+                              << " parts is not in exactly one coupled group"
+                              << std::endl;
+                    exit(-1);
+                }
+                coupled_groups[part] = g;
+            }
+        }
+
+        // the parts sampled together, the uncoupled ones alone
+        std::vector<std::vector<int>> groups;
+        std::vector<bool> grouped(blocks, false);
         for (int i = 0; i < blocks; ++i)
         {
-            for (int k = 0; k < block_size; ++k)
+            if (grouped[i]) continue;
+            groups.push_back(std::vector<int>());
+            for (int j = i; j < blocks; ++j)
             {
-                sampling_blocks[i].push_back(i * block_size + k);
+                if (j == i ||
+                    (coupled_groups[i] != -1 &&
+                     coupled_groups[j] == coupled_groups[i]))
+                {
+                    groups.back().push_back(j);
+                    grouped[j] = true;
+                }
+            }
+        }
+
+        // translation and rotation noise of a part are its first and its
+        // last three dimensions
+        const bool split =
+            params_.split_translation_rotation && block_size == 6;
+        std::vector<std::vector<int>> sampling_blocks;
+        for (const auto& group : groups)
+        {
+            for (int half = 0; half < (split ? 2 : 1); ++half)
+            {
+                sampling_blocks.push_back(std::vector<int>());
+                for (const int part : group)
+                {
+                    const int begin = split ? 3 * half : 0;
+                    const int end = split ? begin + 3 : block_size;
+                    for (int k = begin; k < end; ++k)
+                    {
+                        sampling_blocks.back().push_back(part * block_size + k);
+                    }
+                }
             }
         }
 
         return sampling_blocks;
     }
 
+    /**
+     * \brief State coordinates whose variance is the uncertainty of each
+     *        sampling block, those of the pose coordinates its noise drives
+     *
+     * \param block_size	Noise dimension of each part
+     * \param state_size	State dimension of each part, which starts with
+     *                   the coordinates driven by its noise
+     */
+    virtual std::vector<std::vector<int>> create_sampling_block_states(
+        const std::vector<std::vector<int>>& sampling_blocks,
+        int block_size,
+        int state_size) const
+    {
+        std::vector<std::vector<int>> states(sampling_blocks.size());
+        for (size_t i = 0; i < sampling_blocks.size(); ++i)
+        {
+            for (const int k : sampling_blocks[i])
+            {
+                states[i].push_back(k / block_size * state_size +
+                                    k % block_size);
+            }
+        }
+
+        return states;
+    }
+
 protected:
     std::shared_ptr<TransitionBuilder> transition_builder_;
     std::shared_ptr<SensorBuilder> sensor_builder_;
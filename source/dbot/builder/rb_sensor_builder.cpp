@@ -34,4 +34,5 @@
 namespace dbot
 {
 template class RbSensorBuilder<dbot::FreeFloatingRigidBodiesState<>>;
+template class RbSensorBuilder<dbot::FreeFloatingRigidBodiesState<1>>;
 }
@@ -40,10 +40,16 @@
 #include <dbot/object_model.h>
 #include <dbot/pose/euler_vector.h>
 #include <dbot/rigid_body_renderer.h>
+#include <dbot/worker_pool.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace dbot
 {
+template <typename State>
+class KinectImageModelGPU;
+
 /**
  * \brief The NoGpuSupportException class
  */
@@ -84,6 +90,70 @@ public:
         Kinect kinect;
         double delta_time;
         int sample_count;
+        /* number of CPU threads evaluating the particles, 0 for all cores */
+        int thread_count = 1;
+        /* pool the CPU sensor evaluates the particles and builds the levels
+         * of detail on instead of thread_count threads of its own */
+        std::shared_ptr<WorkerPool> worker_pool;
+        /* store the CPU occlusions quantized to 16 bits, in a third of the
+         * memory */
+        bool use_compact_occlusions = false;
+        /* fill triangles by tiles instead of scanlines on the CPU */
+        bool use_tiled_rasterization = false;
+        /* ray cast the parts with many triangles for the pixels they cover
+         * instead of filling them, and fill the others by tiles */
+        bool use_ray_casting = false;
+        /* project and rasterize in single precision on the CPU like on the
+         * GPU, the pixel likelihoods are single precision either way */
+        bool use_single_precision_rendering = false;
+        /* skip the triangles facing away from the camera when rendering,
+         * for closed meshes wound counter clockwise seen from outside */
+        bool use_back_face_culling = false;
+        /* simplified meshes the renderers choose from by the projected
+         * object size, 1 renders the loaded mesh only */
+        int level_of_detail_count = 1;
+        /* projected pixels per triangle below which a finer level is used */
+        double level_of_detail_pixels_per_triangle = 4.;
+        /* draw all poses of an object with one instanced call on the GPU */
+        bool use_instanced_rendering = false;
+        /* batches rendered and evaluated in a pipeline on the GPU */
+        int nr_pipeline_batches = 2;
+        /* poses the GPU memory is allocated for at first, it grows up to
+         * the sample count on demand. 0 allocates all of it at once */
+        int initial_gpu_sample_count = 0;
+        /* render the GPU poses into layered textures, such that their
+         * number is bounded by the GPU memory instead of the texture size */
+        bool use_layered_render_target = false;
+        /* store the GPU occlusion probabilities as 16 bit floats */
+        bool use_half_precision_occlusions = false;
+        /* render only the objects which moved since the last evaluation
+         * on the GPU and keep the depth of each object per particle */
+        bool use_incremental_rendering = false;
+        /* launch the CUDA work of each GPU evaluation as CUDA graphs,
+         * which saves launch overhead at small resolutions */
+        bool use_cuda_graphs = false;
+        /* render with CUDA instead of OpenGL, which needs no X display.
+         * Levels of detail, displays and regions of interest are not
+         * supported then */
+        bool use_cuda_rasterizer = false;
+        /* X displays of the GPUs the particles are split across, e.g.
+         * ":0.0", ":0.1". The default display is used if empty */
+        std::vector<std::string> gpu_displays;
+        /* benchmark the GPU thread count and render texture layout on first
+         * use and cache the fastest for later runs */
+        bool use_gpu_autotuning = false;
+        /* GPU tuning cache, GpuTuningCache::default_path() if empty */
+        std::string gpu_tuning_cache_file;
+        /* size of the window following the object which the GPU renders
+         * and evaluates, the whole image if either is 0 */
+        int region_of_interest_rows = 0;
+        int region_of_interest_cols = 0;
+        /* pixels around the projected object which stay in the window */
+        int region_of_interest_margin = 8;
+        /* downsampling of the coarse level which screens the particles
+         * before the full evaluation, relative to the camera resolution.
+         * 1 builds no coarse level */
+        int coarse_downsampling_factor = 1;
         bool use_custom_shaders;
         std::string vertex_shader_file;
         std::string fragment_shader_file;
@@ -99,10 +169,34 @@ public:
 
     virtual std::shared_ptr<Model> build() const;
 
+    const std::shared_ptr<CameraData>& camera_data() const
+    {
+        return camera_data_;
+    }
+
 public:
     /* GPU model factor functions */
     virtual std::shared_ptr<Model> create_gpu_based_model() const;
 
+    /**
+     * \brief Creates a GPU model rendering the given levels of detail, the
+     *        finest first, on the given X display at the camera resolution
+     *        downsampled by downsampling_factor
+     */
+    std::shared_ptr<KinectImageModelGPU<State>> create_gpu_model(
+        const std::vector<TriangleMesh::ConstPtr>& meshes,
+        int sample_count,
+        const std::string& display_name,
+        int downsampling_factor = 1) const;
+
+    /**
+     * \brief Creates a GPU model which renders with CUDA, see
+     *        KinectImageModelCuda
+     */
+    std::shared_ptr<Model> create_cuda_model(
+        int sample_count,
+        int downsampling_factor = 1) const;
+
     std::shared_ptr<ShaderProvider> create_shader_provider() const;
 
 public:
@@ -114,6 +208,22 @@ public:
 
     virtual std::shared_ptr<RigidBodyRenderer> create_renderer() const;
 
+    /**
+     * \brief Creates the coarse level of the sensor at the camera resolution
+     *        downsampled by the coarse downsampling factor
+     */
+    virtual std::shared_ptr<Model> create_coarse_model() const;
+
+protected:
+    std::shared_ptr<Model> create_cpu_model(int downsampling_factor) const;
+
+    /**
+     * \brief Camera matrix and resolution of the camera downsampled by
+     *        downsampling_factor
+     */
+    Eigen::Matrix3d camera_matrix(int downsampling_factor) const;
+    CameraData::Resolution resolution(int downsampling_factor) const;
+
 protected:
     std::shared_ptr<ObjectModel> object_model_;
     std::shared_ptr<CameraData> camera_data_;
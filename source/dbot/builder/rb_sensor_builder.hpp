@@ -30,10 +30,13 @@
 #pragma once
 
 #include <dbot/builder/rb_sensor_builder.h>
+#include <dbot/model/coarse_to_fine_sensor.h>
 #include <dbot/model/kinect_image_model.h>
 
 #ifdef DBOT_BUILD_GPU
+#include <dbot/gpu/kinect_image_model_cuda.h>
 #include <dbot/gpu/kinect_image_model_gpu.h>
+#include <dbot/gpu/sharded_kinect_image_model_gpu.h>
 #endif
 
 namespace dbot
@@ -52,6 +55,16 @@ auto RbSensorBuilder<State>::build() const -> std::shared_ptr<Model>
 {
     std::shared_ptr<Model> sensor;
 
+    if (params_.level_of_detail_count > 1 &&
+        object_model_->count_levels() != params_.level_of_detail_count)
+    {
+        if (params_.worker_pool)
+        {
+            object_model_->worker_pool(params_.worker_pool);
+        }
+        object_model_->build_levels_of_detail(params_.level_of_detail_count);
+    }
+
     if (params_.use_gpu)
     {
         sensor = create_gpu_based_model();
@@ -61,21 +74,181 @@ auto RbSensorBuilder<State>::build() const -> std::shared_ptr<Model>
         sensor = create_cpu_based_model();
     }
 
+    if (params_.coarse_downsampling_factor > 1)
+    {
+        sensor = std::shared_ptr<Model>(
+            new CoarseToFineSensor<State>(sensor,
+                                          create_coarse_model(),
+                                          camera_data_->resolution().height,
+                                          camera_data_->resolution().width,
+                                          params_.delta_time));
+    }
+
     return sensor;
 }
 
 template <typename State>
-auto RbSensorBuilder<State>::create_gpu_based_model() const
+auto RbSensorBuilder<State>::create_coarse_model() const
     -> std::shared_ptr<Model>
 {
+    const int factor = params_.coarse_downsampling_factor;
+    const CameraData::Resolution resolution = camera_data_->resolution();
+    if (resolution.height % factor != 0 || resolution.width % factor != 0)
+    {
+        std::cout << "ERROR: coarse downsampling factor " << factor
+                  << " does not divide the resolution of " << resolution.height
+                  << " x " << resolution.width << " pixels" << std::endl;
+        exit(-1);
+    }
+
+    if (!params_.use_gpu) return create_cpu_model(factor);
+    if (params_.use_cuda_rasterizer)
+    {
+        return create_cuda_model(params_.sample_count, factor);
+    }
+
 #ifdef DBOT_BUILD_GPU
-    auto sensor = std::shared_ptr<Model>(new dbot::KinectImageModelGPU<State>(
-        camera_data_->camera_matrix(),
-        camera_data_->resolution().height,
-        camera_data_->resolution().width,
+    std::vector<TriangleMesh::ConstPtr> meshes;
+    for (int level = 0; level < object_model_->count_levels(); level++)
+    {
+        meshes.push_back(object_model_->mesh(level));
+    }
+
+    // a single GPU screens all particles, they are few pixels each
+    return create_gpu_model(
+        meshes,
         params_.sample_count,
-        object_model_->vertices(),
-        object_model_->triangle_indices(),
+        params_.gpu_displays.empty() ? "" : params_.gpu_displays[0],
+        factor);
+#else
+    throw NoGpuSupportException();
+#endif
+}
+
+template <typename State>
+Eigen::Matrix3d RbSensorBuilder<State>::camera_matrix(
+    int downsampling_factor) const
+{
+    Eigen::Matrix3d camera_matrix = camera_data_->camera_matrix();
+    camera_matrix.topRows(2) /= double(downsampling_factor);
+    return camera_matrix;
+}
+
+template <typename State>
+CameraData::Resolution RbSensorBuilder<State>::resolution(
+    int downsampling_factor) const
+{
+    CameraData::Resolution resolution = camera_data_->resolution();
+    resolution.height /= downsampling_factor;
+    resolution.width /= downsampling_factor;
+    return resolution;
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_gpu_based_model() const
+    -> std::shared_ptr<Model>
+{
+#ifdef DBOT_BUILD_GPU
+    if (params_.use_cuda_rasterizer)
+    {
+        return create_cuda_model(params_.sample_count);
+    }
+
+    const int nr_shards = std::max<int>(params_.gpu_displays.size(), 1);
+    const int shard_sample_count =
+        (params_.sample_count + nr_shards - 1) / nr_shards;
+
+    std::vector<TriangleMesh::ConstPtr> meshes;
+    for (int level = 0; level < object_model_->count_levels(); level++)
+    {
+        meshes.push_back(object_model_->mesh(level));
+    }
+
+    auto create_shard = [this, meshes, shard_sample_count](
+        const std::string& display_name)
+    {
+        return create_gpu_model(meshes, shard_sample_count, display_name);
+    };
+
+    std::shared_ptr<Model> sensor;
+    if (params_.gpu_displays.size() > 1)
+    {
+        sensor = std::shared_ptr<Model>(
+            new dbot::ShardedKinectImageModelGPU<State>(
+                params_.gpu_displays, create_shard, params_.delta_time));
+    }
+    else
+    {
+        sensor = create_shard(
+            params_.gpu_displays.empty() ? "" : params_.gpu_displays[0]);
+    }
+
+    return sensor;
+#else
+    throw NoGpuSupportException();
+#endif
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_cuda_model(int sample_count,
+                                                int downsampling_factor) const
+    -> std::shared_ptr<Model>
+{
+#ifdef DBOT_BUILD_GPU
+    typedef dbot::KinectImageModelCuda<State> CudaModel;
+
+    const int factor = downsampling_factor;
+    auto model = std::shared_ptr<CudaModel>(
+        new CudaModel(camera_matrix(factor),
+                      resolution(factor).height,
+                      resolution(factor).width,
+                      sample_count,
+                      object_model_->mesh(0),
+                      params_.occlusion.initial_occlusion_prob,
+                      params_.delta_time,
+                      params_.occlusion.p_occluded_visible,
+                      params_.occlusion.p_occluded_occluded,
+                      params_.kinect.tail_weight,
+                      params_.kinect.model_sigma,
+                      params_.kinect.sigma_factor,
+                      6.0f,        // max_depth
+                      -log(0.5f),  // exponential_rate
+                      params_.use_half_precision_occlusions));
+    model->set_graph_capture(params_.use_cuda_graphs);
+    model->set_back_face_culling(params_.use_back_face_culling);
+
+    return model;
+#else
+    throw NoGpuSupportException();
+#endif
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_gpu_model(
+    const std::vector<TriangleMesh::ConstPtr>& meshes,
+    int sample_count,
+    const std::string& display_name,
+    int downsampling_factor) const
+    -> std::shared_ptr<KinectImageModelGPU<State>>
+{
+#ifdef DBOT_BUILD_GPU
+    typedef dbot::KinectImageModelGPU<State> GpuModel;
+
+    std::string tuning_cache_path;
+    if (params_.use_gpu_autotuning)
+    {
+        tuning_cache_path = params_.gpu_tuning_cache_file.empty()
+                                ? dbot::GpuTuningCache::default_path()
+                                : params_.gpu_tuning_cache_file;
+    }
+
+    const int factor = downsampling_factor;
+    auto model = std::shared_ptr<GpuModel>(new GpuModel(
+        camera_matrix(factor),
+        resolution(factor).height,
+        resolution(factor).width,
+        sample_count,
+        meshes[0],
         create_shader_provider(),
         false,  // TODO should be a parameter from the config file
         false,  // TODO should be a parameter from the config file
@@ -85,9 +258,31 @@ auto RbSensorBuilder<State>::create_gpu_based_model() const
         params_.occlusion.p_occluded_occluded,
         params_.kinect.tail_weight,
         params_.kinect.model_sigma,
-        params_.kinect.sigma_factor));
+        params_.kinect.sigma_factor,
+        6.0f,        // max_depth
+        -log(0.5f),  // exponential_rate
+        params_.use_instanced_rendering,
+        params_.nr_pipeline_batches,
+        params_.use_half_precision_occlusions,
+        display_name,
+        tuning_cache_path,
+        params_.region_of_interest_rows / factor,
+        params_.region_of_interest_cols / factor,
+        params_.region_of_interest_margin / factor,
+        params_.initial_gpu_sample_count,
+        params_.use_layered_render_target));
 
-    return sensor;
+    for (size_t level = 1; level < meshes.size(); level++)
+    {
+        model->add_level_of_detail(meshes[level]);
+    }
+    model->set_level_of_detail_budget(
+        params_.level_of_detail_pixels_per_triangle);
+    model->set_incremental_rendering(params_.use_incremental_rendering);
+    model->set_graph_capture(params_.use_cuda_graphs);
+    model->set_back_face_culling(params_.use_back_face_culling);
+
+    return model;
 #else
     throw NoGpuSupportException();
 #endif
@@ -111,21 +306,31 @@ auto RbSensorBuilder<State>::create_shader_provider() const
 template <typename State>
 auto RbSensorBuilder<State>::create_cpu_based_model() const
     -> std::shared_ptr<Model>
+{
+    return create_cpu_model(1);
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_cpu_model(int downsampling_factor) const
+    -> std::shared_ptr<Model>
 {
     auto pixel_model = create_pixel_model();
     auto occlusion_process = create_occlusion_process();
     auto renderer = create_renderer();
 
-    auto sensor =
-        std::shared_ptr<Model>(new dbot::KinectImageModel<fl::Real, State>(
-            camera_data_->camera_matrix(),
-            camera_data_->resolution().height,
-            camera_data_->resolution().width,
-            renderer,
-            pixel_model,
-            occlusion_process,
-            params_.occlusion.initial_occlusion_prob,
-            params_.delta_time));
+    typedef dbot::KinectImageModel<fl::Real, State> CpuModel;
+    auto sensor = std::shared_ptr<CpuModel>(
+        new CpuModel(camera_matrix(downsampling_factor),
+                     resolution(downsampling_factor).height,
+                     resolution(downsampling_factor).width,
+                     renderer,
+                     pixel_model,
+                     occlusion_process,
+                     params_.occlusion.initial_occlusion_prob,
+                     params_.delta_time,
+                     params_.thread_count));
+    sensor->compact_occlusions(params_.use_compact_occlusions);
+    if (params_.worker_pool) sensor->worker_pool(params_.worker_pool);
 
     return sensor;
 }
@@ -156,8 +361,28 @@ template <typename State>
 auto RbSensorBuilder<State>::create_renderer() const
     -> std::shared_ptr<RigidBodyRenderer>
 {
-    std::shared_ptr<RigidBodyRenderer> renderer(new RigidBodyRenderer(
-        object_model_->vertices(), object_model_->triangle_indices()));
+    RigidBodyRenderer::RasterizationMode mode =
+        RigidBodyRenderer::SCANLINE_RASTERIZATION;
+    if (params_.use_ray_casting)
+    {
+        mode = RigidBodyRenderer::AUTOMATIC_RENDERING;
+    }
+    else if (params_.use_tiled_rasterization)
+    {
+        mode = RigidBodyRenderer::TILED_RASTERIZATION;
+    }
+
+    std::shared_ptr<RigidBodyRenderer> renderer(
+        new RigidBodyRenderer(object_model_->mesh(), mode));
+
+    for (int level = 1; level < object_model_->count_levels(); level++)
+    {
+        renderer->add_level_of_detail(object_model_->mesh(level));
+    }
+    renderer->level_of_detail_budget(
+        params_.level_of_detail_pixels_per_triangle);
+    renderer->single_precision(params_.use_single_precision_rendering);
+    renderer->back_face_culling(params_.use_back_face_culling);
 
     return renderer;
 }
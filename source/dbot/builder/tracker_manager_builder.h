@@ -0,0 +1,226 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_manager_builder.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <dbot/builder/particle_tracker_builder.h>
+#include <dbot/builder/rb_sensor_builder.h>
+#include <dbot/camera_data.h>
+#include <dbot/model/sensor_batch.h>
+#include <dbot/object_model.h>
+#include <dbot/tracker/tracker_manager.h>
+#include <dbot/triangle_mesh.h>
+
+#ifdef DBOT_BUILD_GPU
+#include <dbot/gpu/batched_kinect_image_model_gpu.h>
+#endif
+
+namespace dbot
+{
+/**
+ * \brief Builds a TrackerManager with one particle tracker per object
+ *
+ * On the GPU, all trackers evaluate through one
+ * BatchedKinectImageModelGPU, which renders the meshes of all objects with
+ * one rasterizer and allocates room for sample_count particles of every
+ * tracker. Its levels of detail combine the levels of the objects, objects
+ * with fewer levels keep their coarsest one. The particles are evaluated on
+ * the first of the GPU displays, batches are not sharded.
+ *
+ * On the CPU, each tracker gets its own sensor and the trackers run one
+ * after the other. A worker pool in the parameters is shared by all of them.
+ */
+template <typename Tracker>
+class TrackerManagerBuilder
+{
+public:
+    typedef ParticleTrackerBuilder<Tracker> TrackerBuilder;
+    typedef typename TrackerBuilder::State State;
+    typedef typename TrackerBuilder::TransitionBuilder TransitionBuilder;
+    typedef typename TrackerBuilder::SensorBuilder SensorBuilder;
+    typedef typename TrackerBuilder::Sensor Sensor;
+
+public:
+    /**
+     * \param transition_builders  one transition builder per object
+     * \param object_models        one object model per object
+     */
+    TrackerManagerBuilder(
+        const std::vector<std::shared_ptr<TransitionBuilder>>&
+            transition_builders,
+        const std::vector<std::shared_ptr<ObjectModel>>& object_models,
+        const std::shared_ptr<CameraData>& camera_data,
+        const typename SensorBuilder::Parameters& sensor_params,
+        const typename TrackerBuilder::Parameters& tracker_params)
+        : transition_builders_(transition_builders),
+          object_models_(object_models),
+          camera_data_(camera_data),
+          sensor_params_(sensor_params),
+          tracker_params_(tracker_params)
+    {
+        if (transition_builders_.size() != object_models_.size())
+        {
+            std::cout << "ERROR: " << transition_builders_.size()
+                      << " transition builders for " << object_models_.size()
+                      << " objects" << std::endl;
+            exit(-1);
+        }
+    }
+
+    /**
+     * \brief Builds the trackers and the sensor they share
+     *
+     * \throws NoGpuSupportException if compile with DBOT_BUILD_GPU=OFF and
+     *         attempting to build trackers with GPU support
+     */
+    std::shared_ptr<TrackerManager> build()
+    {
+        std::shared_ptr<SensorBatch> sensor_batch;
+        std::vector<std::shared_ptr<dbot::Tracker>> trackers;
+
+        if (!sensor_params_.use_gpu)
+        {
+            for (size_t i = 0; i < object_models_.size(); i++)
+            {
+                auto sensor_builder = std::make_shared<SensorBuilder>(
+                    object_models_[i], camera_data_, sensor_params_);
+                trackers.push_back(build_tracker(i, sensor_builder));
+            }
+            return std::make_shared<TrackerManager>(trackers);
+        }
+
+#ifdef DBOT_BUILD_GPU
+        typedef BatchedKinectImageModelGPU<State> Batch;
+
+        std::vector<int> part_counts;
+        for (auto& object_model : object_models_)
+        {
+            if (sensor_params_.level_of_detail_count > 1 &&
+                object_model->count_levels() !=
+                    sensor_params_.level_of_detail_count)
+            {
+                if (sensor_params_.worker_pool)
+                {
+                    object_model->worker_pool(sensor_params_.worker_pool);
+                }
+                object_model->build_levels_of_detail(
+                    sensor_params_.level_of_detail_count);
+            }
+            part_counts.push_back(object_model->count_parts());
+        }
+
+        const int nr_trackers = object_models_.size();
+        SensorBuilder sensor_builder(
+            object_models_[0], camera_data_, sensor_params_);
+        auto model = sensor_builder.create_gpu_model(
+            create_meshes(),
+            sensor_params_.sample_count * nr_trackers,
+            sensor_params_.gpu_displays.empty()
+                ? ""
+                : sensor_params_.gpu_displays[0]);
+
+        auto batch = std::make_shared<Batch>(model,
+                                             part_counts,
+                                             sensor_params_.sample_count,
+                                             sensor_params_.delta_time);
+        sensor_batch = batch;
+
+        for (int i = 0; i < nr_trackers; i++)
+        {
+            auto slot_builder =
+                std::make_shared<SlotBuilder>(object_models_[i],
+                                              camera_data_,
+                                              sensor_params_,
+                                              batch->slot(i));
+            trackers.push_back(build_tracker(i, slot_builder));
+        }
+
+        return std::make_shared<TrackerManager>(trackers, sensor_batch);
+#else
+        throw NoGpuSupportException();
+#endif
+    }
+
+private:
+    /**
+     * \brief Sensor builder which hands out a sensor of the batch
+     */
+    class SlotBuilder : public SensorBuilder
+    {
+    public:
+        SlotBuilder(const std::shared_ptr<ObjectModel>& object_model,
+                    const std::shared_ptr<CameraData>& camera_data,
+                    const typename SensorBuilder::Parameters& params,
+                    const std::shared_ptr<Sensor>& sensor)
+            : SensorBuilder(object_model, camera_data, params), sensor_(sensor)
+        {
+        }
+
+        std::shared_ptr<Sensor> build() const { return sensor_; }
+    private:
+        std::shared_ptr<Sensor> sensor_;
+    };
+
+    std::shared_ptr<dbot::Tracker> build_tracker(
+        int index,
+        const std::shared_ptr<SensorBuilder>& sensor_builder)
+    {
+        TrackerBuilder tracker_builder(transition_builders_[index],
+                                       sensor_builder,
+                                       object_models_[index],
+                                       tracker_params_);
+        return tracker_builder.build();
+    }
+
+    /**
+     * \brief Meshes with the parts of all objects, one per level of detail
+     */
+    std::vector<TriangleMesh::ConstPtr> create_meshes() const
+    {
+        int nr_levels = 1;
+        for (auto& object_model : object_models_)
+        {
+            nr_levels = std::max(nr_levels, object_model->count_levels());
+        }
+
+        std::vector<TriangleMesh::ConstPtr> meshes;
+        for (int level = 0; level < nr_levels; level++)
+        {
+            auto mesh = std::make_shared<TriangleMesh>();
+            for (auto& object_model : object_models_)
+            {
+                mesh->append(*object_model->mesh(
+                    std::min(level, object_model->count_levels() - 1)));
+            }
+            meshes.push_back(mesh);
+        }
+        return meshes;
+    }
+
+    std::vector<std::shared_ptr<TransitionBuilder>> transition_builders_;
+    std::vector<std::shared_ptr<ObjectModel>> object_models_;
+    std::shared_ptr<CameraData> camera_data_;
+    typename SensorBuilder::Parameters sensor_params_;
+    typename TrackerBuilder::Parameters tracker_params_;
+};
+}
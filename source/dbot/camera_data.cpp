@@ -41,6 +41,62 @@ Eigen::VectorXd CameraData::depth_image_vector() const
    return data_provider_->depth_image_vector();
 }
 
+DepthFrame::ConstPtr CameraData::depth_frame() const
+{
+    DepthFrame::ConstPtr frame = data_provider_->depth_frame();
+    if (frame) return frame;
+
+    DepthFrame::ConstPtr native = data_provider_->native_depth_frame();
+    if (native)
+    {
+        std::lock_guard<std::mutex> lock(downsampler_mutex_);
+        return downsampler_.downsample(*native, downsampling_factor());
+    }
+
+    const Eigen::VectorXd image = data_provider_->depth_image_vector();
+
+    // images which do not match the resolution are kept as a column
+    int rows = resolution().height;
+    int cols = resolution().width;
+    if (rows * cols != image.size())
+    {
+        rows = image.size();
+        cols = 1;
+    }
+
+    DepthFrame::Ptr converted = frame_pool_.acquire(rows, cols);
+    Eigen::Map<Eigen::VectorXf>(converted->data(), image.size()) =
+        image.cast<float>();
+    return converted;
+}
+
+DepthFrame::ConstPtr CameraData::native_depth_frame() const
+{
+    return data_provider_->native_depth_frame();
+}
+
+DepthDownsampler::Pooling CameraData::depth_pooling() const
+{
+    std::lock_guard<std::mutex> lock(downsampler_mutex_);
+    return downsampler_.pooling();
+}
+
+void CameraData::depth_pooling(DepthDownsampler::Pooling pooling)
+{
+    std::lock_guard<std::mutex> lock(downsampler_mutex_);
+    downsampler_.pooling(pooling);
+}
+
+void CameraData::frame_allocator(const DepthFramePool::Allocator& allocator)
+{
+    frame_pool_.allocator(allocator);
+    {
+        std::lock_guard<std::mutex> lock(downsampler_mutex_);
+        downsampler_.frame_allocator(allocator);
+    }
+    data_provider_->frame_allocator(allocator);
+}
+
 std::string CameraData::frame_id() const
 {
     return data_provider_->frame_id();
@@ -20,9 +20,13 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <Eigen/Dense>
 
+#include <dbot/depth_downsampling.h>
+#include <dbot/depth_frame.h>
+
 namespace dbot
 {
 
@@ -65,6 +69,32 @@ public:
      */
     Eigen::VectorXd depth_image_vector() const;
 
+    /**
+     * \brief returns the current depth image as a shared single precision
+     *        frame, row by row like depth_image_vector()
+     */
+    DepthFrame::ConstPtr depth_frame() const;
+
+    /**
+     * \brief returns the current depth image at the native resolution if the
+     *        provider supports it, an empty pointer otherwise. The sensors
+     *        downsample such frames to their own resolution.
+     */
+    DepthFrame::ConstPtr native_depth_frame() const;
+
+    /**
+     * \brief Pooling of the native frames which are downsampled by
+     *        depth_frame()
+     */
+    DepthDownsampler::Pooling depth_pooling() const;
+    void depth_pooling(DepthDownsampler::Pooling pooling);
+
+    /**
+     * \brief Sets the allocator of the frames filled by the provider and of
+     *        the frames converted or downsampled here
+     */
+    void frame_allocator(const DepthFramePool::Allocator& allocator);
+
     /**
      * \brief Returns the frame_id name of the camera
      */
@@ -103,6 +133,18 @@ protected:
      *        \c CameraDataProvider
      */
     std::shared_ptr<CameraDataProvider> data_provider_;
+
+    /**
+     * \brief Buffers of the frames converted for providers without
+     *        depth_frame() support
+     */
+    mutable DepthFramePool frame_pool_;
+
+    /**
+     * \brief Downsamples native frames for depth_frame()
+     */
+    mutable DepthDownsampler downsampler_;
+    mutable std::mutex downsampler_mutex_;
 };
 
 }
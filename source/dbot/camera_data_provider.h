@@ -48,6 +48,37 @@ public:
      */
     virtual Eigen::VectorXd depth_image_vector() const = 0;
 
+    /**
+     * \brief returns the current depth image as a single precision frame
+     *        which is shared instead of copied. Providers which do not
+     *        override this return an empty pointer, CameraData converts
+     *        depth_image_vector() for them.
+     */
+    virtual DepthFrame::ConstPtr depth_frame() const
+    {
+        return DepthFrame::ConstPtr();
+    }
+
+    /**
+     * \brief returns the current depth image at the native resolution,
+     *        which CameraData downsamples itself if depth_frame() is not
+     *        provided. Providers which do not override this return an empty
+     *        pointer.
+     */
+    virtual DepthFrame::ConstPtr native_depth_frame() const
+    {
+        return DepthFrame::ConstPtr();
+    }
+
+    /**
+     * \brief Sets the allocator of the frames the provider fills itself, e.g.
+     *        of page locked buffers which the GPU sensors upload without a
+     *        copy. Providers which do not fill frames ignore it.
+     */
+    virtual void frame_allocator(const DepthFramePool::Allocator& allocator)
+    {
+    }
+
     /**
      * \brief Obtains the camera matrix
      */
@@ -0,0 +1,272 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_downsampling.cpp
+ * \date October 2026
+ */
+
+#include <dbot/depth_downsampling.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace dbot
+{
+namespace
+{
+inline bool is_valid(float depth)
+{
+    return depth > 0.f && depth <= std::numeric_limits<float>::max();
+}
+
+/**
+ * \brief Upper median of the count values, which are reordered
+ */
+float median(float* values, int count)
+{
+    // the blocks of small factors are sorted faster by insertion
+    if (count <= 16)
+    {
+        for (int i = 1; i < count; i++)
+        {
+            const float value = values[i];
+            int j = i;
+            for (; j > 0 && values[j - 1] > value; j--)
+            {
+                values[j] = values[j - 1];
+            }
+            values[j] = value;
+        }
+        return values[count / 2];
+    }
+
+    std::nth_element(values, values + count / 2, values + count);
+    return values[count / 2];
+}
+
+/**
+ * \brief values[i] = min(values[i], line[i]) for the valid line[i]
+ */
+void min_valid(const float* line, int width, float* values)
+{
+    int i = 0;
+#ifdef __SSE2__
+    // the comparisons are false for NaN, such that it is masked as well
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 max_depth = _mm_set1_ps(std::numeric_limits<float>::max());
+    const __m128 infinity =
+        _mm_set1_ps(std::numeric_limits<float>::infinity());
+    for (; i + 4 <= width; i += 4)
+    {
+        const __m128 depth = _mm_loadu_ps(line + i);
+        const __m128 mask = _mm_and_ps(_mm_cmpgt_ps(depth, zero),
+                                       _mm_cmple_ps(depth, max_depth));
+        const __m128 masked = _mm_or_ps(_mm_and_ps(mask, depth),
+                                        _mm_andnot_ps(mask, infinity));
+        _mm_storeu_ps(values + i,
+                      _mm_min_ps(_mm_loadu_ps(values + i), masked));
+    }
+#endif
+    for (; i < width; i++)
+    {
+        if (is_valid(line[i])) values[i] = std::min(values[i], line[i]);
+    }
+}
+
+/**
+ * \brief Adds the valid line[i] to sums[i] and counts them in counts[i]
+ */
+void sum_valid(const float* line, int width, float* sums, float* counts)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 max_depth = _mm_set1_ps(std::numeric_limits<float>::max());
+    for (; i + 4 <= width; i += 4)
+    {
+        const __m128 depth = _mm_loadu_ps(line + i);
+        const __m128 mask = _mm_and_ps(_mm_cmpgt_ps(depth, zero),
+                                       _mm_cmple_ps(depth, max_depth));
+        _mm_storeu_ps(sums + i,
+                      _mm_add_ps(_mm_loadu_ps(sums + i),
+                                 _mm_and_ps(mask, depth)));
+        _mm_storeu_ps(counts + i,
+                      _mm_add_ps(_mm_loadu_ps(counts + i),
+                                 _mm_and_ps(mask, one)));
+    }
+#endif
+    for (; i < width; i++)
+    {
+        if (is_valid(line[i]))
+        {
+            sums[i] += line[i];
+            counts[i] += 1;
+        }
+    }
+}
+}
+
+DepthDownsampler::DepthDownsampler(Pooling pooling) : pooling_(pooling) {}
+
+DepthFrame::Ptr DepthDownsampler::downsample(const DepthFrame& native,
+                                             int factor,
+                                             std::vector<uint8_t>* valid)
+{
+    if (factor < 1)
+    {
+        std::cout << "ERROR: depth downsampling factor " << factor
+                  << " is not positive" << std::endl;
+        exit(-1);
+    }
+
+    const int rows = native.rows() / factor;
+    const int cols = native.cols() / factor;
+    DepthFrame::Ptr frame = frame_pool_.acquire(rows, cols);
+    frame->timestamp(native.timestamp());
+
+    uint8_t* valid_data = NULL;
+    if (valid)
+    {
+        valid->resize(rows * cols);
+        valid_data = valid->data();
+    }
+    downsample(native.data(),
+               native.rows(),
+               native.cols(),
+               factor,
+               frame->data(),
+               valid_data);
+
+    return frame;
+}
+
+void DepthDownsampler::downsample(const float* native,
+                                  int native_rows,
+                                  int native_cols,
+                                  int factor,
+                                  float* downsampled,
+                                  uint8_t* valid)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    const int rows = native_rows / factor;
+    const int cols = native_cols / factor;
+    const int width = cols * factor;
+
+    row_values_.resize(width);
+    row_counts_.resize(width);
+    block_.resize(factor * factor);
+
+    for (int row = 0; row < rows; row++)
+    {
+        const float* lines = native + row * factor * native_cols;
+        float* output = downsampled + row * cols;
+
+        switch (pooling_)
+        {
+            case MIN_POOLING:
+            {
+                // the rows of the blocks are reduced first, such that the
+                // blocks are reduced from one contiguous row
+                std::fill(row_values_.begin(),
+                          row_values_.end(),
+                          std::numeric_limits<float>::infinity());
+                for (int i = 0; i < factor; i++)
+                {
+                    min_valid(lines + i * native_cols, width, &row_values_[0]);
+                }
+                for (int col = 0; col < cols; col++)
+                {
+                    const float* block = &row_values_[col * factor];
+                    float depth = block[0];
+                    for (int j = 1; j < factor; j++)
+                    {
+                        depth = std::min(depth, block[j]);
+                    }
+                    output[col] = depth <= std::numeric_limits<float>::max()
+                                      ? depth
+                                      : nan;
+                }
+                break;
+            }
+            case MEAN_POOLING:
+            {
+                std::fill(row_values_.begin(), row_values_.end(), 0.f);
+                std::fill(row_counts_.begin(), row_counts_.end(), 0.f);
+                for (int i = 0; i < factor; i++)
+                {
+                    sum_valid(lines + i * native_cols,
+                              width,
+                              &row_values_[0],
+                              &row_counts_[0]);
+                }
+                for (int col = 0; col < cols; col++)
+                {
+                    float depth = 0;
+                    float count = 0;
+                    for (int j = 0; j < factor; j++)
+                    {
+                        depth += row_values_[col * factor + j];
+                        count += row_counts_[col * factor + j];
+                    }
+                    output[col] = count > 0 ? depth / count : nan;
+                }
+                break;
+            }
+            case MEDIAN_POOLING:
+            {
+                for (int col = 0; col < cols; col++)
+                {
+                    int count = 0;
+                    for (int i = 0; i < factor; i++)
+                    {
+                        const float* line =
+                            lines + i * native_cols + col * factor;
+                        for (int j = 0; j < factor; j++)
+                        {
+                            if (is_valid(line[j])) block_[count++] = line[j];
+                        }
+                    }
+
+                    if (count == 0)
+                    {
+                        output[col] = nan;
+                        continue;
+                    }
+                    output[col] = median(&block_[0], count);
+                }
+                break;
+            }
+        }
+
+        if (valid)
+        {
+            uint8_t* valid_row = valid + row * cols;
+            for (int col = 0; col < cols; col++)
+            {
+                const float depth = output[col];
+                valid_row[col] = depth == depth;
+            }
+        }
+    }
+}
+}
@@ -0,0 +1,104 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_downsampling.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <dbot/depth_frame.h>
+
+namespace dbot
+{
+/**
+ * \brief Reduces depth images by an integer factor
+ *
+ * Every factor x factor block of the native image becomes one pixel. Depth
+ * values which are NaN, infinite or not positive are invalid, they are
+ * ignored by the pooling and blocks without any valid value become NaN,
+ * which the sensors treat as a missing measurement. The validity mask is
+ * written in the same pass. Rows and columns beyond the last full block are
+ * dropped.
+ *
+ * For the minimum and the mean, the rows of the blocks are reduced first on
+ * whole image rows, with SSE2 where it is available. A downsampler keeps
+ * scratch buffers and must not be used from several threads at once.
+ */
+class DepthDownsampler
+{
+public:
+    /// the values are shared with the CUDA downsampling kernel
+    enum Pooling
+    {
+        /// closest valid depth, keeps the silhouettes of near objects
+        MIN_POOLING,
+        /// median of the valid depths, robust to flying pixels
+        MEDIAN_POOLING,
+        /// mean of the valid depths
+        MEAN_POOLING
+    };
+
+public:
+    explicit DepthDownsampler(Pooling pooling = MEAN_POOLING);
+
+    Pooling pooling() const { return pooling_; }
+    void pooling(Pooling pooling) { pooling_ = pooling; }
+
+    /**
+     * \brief Sets the allocator of the downsampled frames
+     */
+    void frame_allocator(const DepthFramePool::Allocator& allocator)
+    {
+        frame_pool_.allocator(allocator);
+    }
+
+    /**
+     * \brief Returns the downsampled frame in a buffer of the downsampler's
+     *        frame pool
+     *
+     * \param valid if not NULL, resized to the downsampled image and set to
+     *        1 for the pixels with a valid depth and to 0 otherwise
+     */
+    DepthFrame::Ptr downsample(const DepthFrame& native,
+                               int factor,
+                               std::vector<uint8_t>* valid = NULL);
+
+    /**
+     * \brief Downsamples the row major native image into downsampled, which
+     *        has native_rows / factor rows and native_cols / factor columns
+     *
+     * \param valid if not NULL, receives the validity mask of the
+     *        downsampled image
+     */
+    void downsample(const float* native,
+                    int native_rows,
+                    int native_cols,
+                    int factor,
+                    float* downsampled,
+                    uint8_t* valid = NULL);
+
+private:
+    Pooling pooling_;
+    DepthFramePool frame_pool_;
+
+    // one row of block values and valid counts
+    std::vector<float> row_values_;
+    std::vector<float> row_counts_;
+    std::vector<float> block_;
+};
+}
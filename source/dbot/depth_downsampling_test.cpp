@@ -0,0 +1,93 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_downsampling_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include <dbot/depth_downsampling.h>
+
+namespace
+{
+/**
+ * \brief 4 x 6 image of three 2 x 2 blocks per block row, with an invalid
+ *        value in the first block and only invalid values in the last one
+ */
+dbot::DepthFrame make_frame()
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float values[] = {1.0f, nan,  2.0f, 2.0f, 0.f,  nan,
+                            3.0f, 4.0f, 2.0f, 6.0f, nan,  0.f,
+                            1.0f, 1.0f, 5.0f, 5.0f, 7.0f, 1.0f,
+                            1.0f, 1.0f, 5.0f, 5.0f, 3.0f, 2.0f};
+
+    dbot::DepthFrame frame(4, 6);
+    std::copy(values, values + 24, frame.data());
+    return frame;
+}
+}
+
+TEST(DepthDownsamplingTests, min_pooling_ignores_invalid_values)
+{
+    dbot::DepthDownsampler downsampler(dbot::DepthDownsampler::MIN_POOLING);
+    std::vector<uint8_t> valid;
+    auto frame = downsampler.downsample(make_frame(), 2, &valid);
+
+    ASSERT_EQ(frame->rows(), 2);
+    ASSERT_EQ(frame->cols(), 3);
+    EXPECT_EQ(frame->image()(0, 0), 1.f);
+    EXPECT_EQ(frame->image()(0, 1), 2.f);
+    EXPECT_TRUE(std::isnan(frame->image()(0, 2)));
+    EXPECT_EQ(frame->image()(1, 2), 1.f);
+    EXPECT_EQ(valid, (std::vector<uint8_t>{1, 1, 0, 1, 1, 1}));
+}
+
+TEST(DepthDownsamplingTests, mean_pooling_averages_valid_values)
+{
+    dbot::DepthDownsampler downsampler(dbot::DepthDownsampler::MEAN_POOLING);
+    auto frame = downsampler.downsample(make_frame(), 2);
+
+    EXPECT_FLOAT_EQ(frame->image()(0, 0), 8.f / 3.f);
+    EXPECT_FLOAT_EQ(frame->image()(0, 1), 3.f);
+    EXPECT_TRUE(std::isnan(frame->image()(0, 2)));
+    EXPECT_FLOAT_EQ(frame->image()(1, 1), 5.f);
+    EXPECT_FLOAT_EQ(frame->image()(1, 2), 3.25f);
+}
+
+TEST(DepthDownsamplingTests, median_pooling_takes_the_middle_value)
+{
+    dbot::DepthDownsampler downsampler(
+        dbot::DepthDownsampler::MEDIAN_POOLING);
+    auto frame = downsampler.downsample(make_frame(), 2);
+
+    EXPECT_EQ(frame->image()(0, 0), 3.f);
+    EXPECT_EQ(frame->image()(0, 1), 2.f);
+    EXPECT_TRUE(std::isnan(frame->image()(0, 2)));
+    EXPECT_EQ(frame->image()(1, 2), 3.f);
+}
+
+TEST(DepthDownsamplingTests, factor_one_only_marks_invalid_values)
+{
+    dbot::DepthDownsampler downsampler(dbot::DepthDownsampler::MIN_POOLING);
+    auto frame = downsampler.downsample(make_frame(), 1);
+
+    ASSERT_EQ(frame->size(), 24);
+    EXPECT_EQ(frame->image()(1, 3), 6.f);
+    EXPECT_TRUE(std::isnan(frame->image()(0, 4)));
+}
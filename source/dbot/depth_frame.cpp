@@ -0,0 +1,94 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_frame.cpp
+ * \date October 2026
+ */
+
+#include <dbot/depth_frame.h>
+
+namespace dbot
+{
+DepthFramePool::DepthFramePool(size_t max_idle_count,
+                               const Allocator& allocator)
+    : storage_(std::make_shared<Storage>())
+{
+    storage_->max_idle_count = max_idle_count;
+    storage_->allocator = allocator;
+}
+
+void DepthFramePool::allocator(const Allocator& allocator)
+{
+    std::lock_guard<std::mutex> lock(storage_->mutex);
+    storage_->allocator = allocator;
+    storage_->idle.clear();
+}
+
+DepthFrame::Ptr DepthFramePool::acquire(int rows, int cols)
+{
+    std::unique_ptr<DepthFrame> frame;
+    Allocator allocator;
+    {
+        std::lock_guard<std::mutex> lock(storage_->mutex);
+        auto& idle = storage_->idle;
+        for (size_t i = 0; i < idle.size(); i++)
+        {
+            if (idle[i]->rows() == rows && idle[i]->cols() == cols)
+            {
+                frame = std::move(idle[i]);
+                idle.erase(idle.begin() + i);
+                break;
+            }
+        }
+        if (!frame)
+        {
+            storage_->allocation_count++;
+            allocator = storage_->allocator;
+        }
+    }
+    if (!frame)
+    {
+        frame = allocator ? allocator(rows, cols)
+                          : std::unique_ptr<DepthFrame>(
+                                new DepthFrame(rows, cols));
+    }
+    frame->timestamp(0);
+
+    std::weak_ptr<Storage> storage = storage_;
+    return DepthFrame::Ptr(frame.release(), [storage](DepthFrame* released) {
+        release(storage, released);
+    });
+}
+
+size_t DepthFramePool::allocation_count() const
+{
+    std::lock_guard<std::mutex> lock(storage_->mutex);
+    return storage_->allocation_count;
+}
+
+void DepthFramePool::release(const std::weak_ptr<Storage>& storage,
+                             DepthFrame* frame)
+{
+    std::unique_ptr<DepthFrame> released(frame);
+
+    auto pool = storage.lock();
+    if (!pool) return;
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    if (pool->idle.size() < pool->max_idle_count)
+    {
+        pool->idle.push_back(std::move(released));
+    }
+}
+}
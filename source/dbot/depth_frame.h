@@ -0,0 +1,217 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_frame.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Single precision depth image in row major order
+ *
+ * Frames are handed from the camera data provider through the tracker to the
+ * sensors by reference counted pointers, such that every stage reads the same
+ * buffer instead of a copy.
+ */
+class DepthFrame
+{
+public:
+    typedef std::shared_ptr<DepthFrame> Ptr;
+    typedef std::shared_ptr<const DepthFrame> ConstPtr;
+
+    typedef Eigen::
+        Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+            ImageMatrix;
+    typedef Eigen::Map<ImageMatrix> Image;
+    typedef Eigen::Map<const ImageMatrix> ConstImage;
+    typedef Eigen::Map<const Eigen::VectorXf> ConstVector;
+
+public:
+    DepthFrame(int rows, int cols)
+        : rows_(rows),
+          cols_(cols),
+          timestamp_(0),
+          depth_(rows * cols),
+          data_(depth_.data()),
+          writable_(true)
+    {
+    }
+
+    /**
+     * \brief Creates a read only frame which views the depth values of an
+     *        external buffer, e.g. a memory mapped file, instead of copying
+     *        them
+     *
+     * \param owner keeps the buffer alive as long as the frame exists
+     */
+    DepthFrame(int rows,
+               int cols,
+               const float* data,
+               const std::shared_ptr<const void>& owner)
+        : rows_(rows),
+          cols_(cols),
+          timestamp_(0),
+          data_(const_cast<float*>(data)),
+          owner_(owner),
+          writable_(false)
+    {
+    }
+
+    /**
+     * \brief Creates a writable frame in an external buffer, e.g. page locked
+     *        memory which the GPU sensors upload without a copy
+     *
+     * \param owner keeps the buffer alive as long as the frame exists
+     */
+    DepthFrame(int rows,
+               int cols,
+               float* data,
+               const std::shared_ptr<void>& owner)
+        : rows_(rows),
+          cols_(cols),
+          timestamp_(0),
+          data_(data),
+          owner_(owner),
+          writable_(true)
+    {
+    }
+
+    /**
+     * \brief Copies the depth values into a writable frame
+     */
+    DepthFrame(const DepthFrame& other)
+        : rows_(other.rows_),
+          cols_(other.cols_),
+          timestamp_(other.timestamp_),
+          depth_(other.data_, other.data_ + other.size()),
+          data_(depth_.data()),
+          writable_(true)
+    {
+    }
+
+    DepthFrame& operator=(const DepthFrame& other)
+    {
+        if (this == &other) return *this;
+        rows_ = other.rows_;
+        cols_ = other.cols_;
+        timestamp_ = other.timestamp_;
+        depth_.assign(other.data_, other.data_ + other.size());
+        data_ = depth_.data();
+        owner_.reset();
+        writable_ = true;
+        return *this;
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int size() const { return rows_ * cols_; }
+
+    /// capture time in seconds, 0 if unknown
+    double timestamp() const { return timestamp_; }
+    void timestamp(double timestamp) { timestamp_ = timestamp; }
+
+    /// false for frames which view an external read only buffer
+    bool writable() const { return writable_; }
+
+    float* data() { return data_; }
+    const float* data() const { return data_; }
+
+    /// depth values as a rows x cols matrix
+    Image image() { return Image(data_, rows_, cols_); }
+    ConstImage image() const { return ConstImage(data_, rows_, cols_); }
+
+    /// depth values row by row, the layout of the observation vectors
+    ConstVector vector() const { return ConstVector(data_, size()); }
+
+private:
+    int rows_;
+    int cols_;
+    double timestamp_;
+    std::vector<float> depth_;
+    float* data_;
+    std::shared_ptr<const void> owner_;
+    bool writable_;
+};
+
+/**
+ * \brief Recycles the buffers of released depth frames
+ *
+ * A frame returns to the pool when its last reference is dropped, such that
+ * a stream of frames of the same resolution stops allocating after the first
+ * few frames. Frames may outlive the pool, they are freed in that case. The
+ * pool can be used from several threads.
+ */
+class DepthFramePool
+{
+public:
+    /**
+     * \brief Creates a writable frame of the given resolution
+     */
+    typedef std::function<std::unique_ptr<DepthFrame>(int rows, int cols)>
+        Allocator;
+
+    /**
+     * \param max_idle_count maximum number of released frames which are kept
+     * \param allocator      creates new frames, by default in their own
+     *                       vector
+     */
+    explicit DepthFramePool(size_t max_idle_count = 4,
+                            const Allocator& allocator = Allocator());
+
+    /**
+     * \brief Sets the allocator of the frames allocated from now on. The
+     *        idle frames are dropped, frames released later are reused
+     *        regardless of their allocator.
+     */
+    void allocator(const Allocator& allocator);
+
+    /**
+     * \brief Returns a frame of the given resolution with undefined depth
+     *        values and an unknown timestamp
+     */
+    DepthFrame::Ptr acquire(int rows, int cols);
+
+    /**
+     * \brief Number of frames which were allocated because no released frame
+     *        of the requested resolution was available
+     */
+    size_t allocation_count() const;
+
+private:
+    struct Storage
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<DepthFrame>> idle;
+        size_t max_idle_count;
+        size_t allocation_count = 0;
+        Allocator allocator;
+    };
+
+    static void release(const std::weak_ptr<Storage>& storage,
+                        DepthFrame* frame);
+
+    std::shared_ptr<Storage> storage_;
+};
+}
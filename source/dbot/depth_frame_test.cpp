@@ -0,0 +1,88 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_frame_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/depth_frame.h>
+
+TEST(DepthFrameTests, image_is_row_major)
+{
+    dbot::DepthFrame frame(2, 3);
+    for (int i = 0; i < frame.size(); i++) frame.data()[i] = i;
+
+    EXPECT_EQ(frame.image()(1, 0), 3.f);
+    EXPECT_EQ(frame.vector()(5), 5.f);
+}
+
+TEST(DepthFrameTests, released_frames_are_reused)
+{
+    dbot::DepthFramePool pool(2);
+
+    const float* first_data;
+    {
+        auto first = pool.acquire(480, 640);
+        first_data = first->data();
+    }
+    auto second = pool.acquire(480, 640);
+    EXPECT_EQ(second->data(), first_data);
+    EXPECT_EQ(pool.allocation_count(), 1u);
+
+    // frames in use and frames of other resolutions are not handed out
+    auto third = pool.acquire(480, 640);
+    auto fourth = pool.acquire(240, 320);
+    EXPECT_NE(third->data(), second->data());
+    EXPECT_EQ(fourth->rows(), 240);
+    EXPECT_EQ(pool.allocation_count(), 3u);
+}
+
+TEST(DepthFrameTests, frames_outlive_the_pool)
+{
+    dbot::DepthFrame::ConstPtr frame;
+    {
+        dbot::DepthFramePool pool;
+        frame = pool.acquire(4, 4);
+    }
+    EXPECT_EQ(frame->size(), 16);
+}
+
+TEST(DepthFrameTests, pool_allocates_frames_with_its_allocator)
+{
+    int allocated = 0;
+    std::shared_ptr<float> buffer(new float[16],
+                                  std::default_delete<float[]>());
+    dbot::DepthFramePool pool(2);
+    pool.allocator([&](int rows, int cols) {
+        allocated++;
+        return std::unique_ptr<dbot::DepthFrame>(
+            new dbot::DepthFrame(rows, cols, buffer.get(), buffer));
+    });
+
+    {
+        auto frame = pool.acquire(4, 4);
+        EXPECT_EQ(frame->data(), buffer.get());
+        EXPECT_TRUE(frame->writable());
+    }
+    auto frame = pool.acquire(4, 4);
+    EXPECT_EQ(frame->data(), buffer.get());
+    EXPECT_EQ(allocated, 1);
+
+    // copies own their values
+    dbot::DepthFrame copy(*frame);
+    EXPECT_NE(copy.data(), buffer.get());
+    EXPECT_TRUE(copy.writable());
+}
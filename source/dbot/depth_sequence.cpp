@@ -0,0 +1,341 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_sequence.cpp
+ * \date October 2026
+ */
+
+#include <dbot/depth_sequence.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef DBOT_HAS_LZ4
+#include <lz4.h>
+#endif
+
+namespace dbot
+{
+namespace
+{
+const char file_magic[8] = {'D', 'B', 'O', 'T', 'D', 'S', 'Q', '\0'};
+const uint32_t file_version = 1;
+const uint32_t chunk_magic = 0x4d415246;  // "FRAM"
+const size_t alignment = 64;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t frame_id_length;
+    int32_t native_width;
+    int32_t native_height;
+    int32_t downsampling_factor;
+    int32_t reserved;
+    double camera_matrix[9];
+};
+
+struct ChunkHeader
+{
+    uint32_t magic;
+    uint32_t compression;
+    int32_t rows;
+    int32_t cols;
+    double timestamp;
+    uint64_t payload_size;
+};
+
+size_t aligned(size_t size)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+#ifdef DBOT_HAS_LZ4
+/**
+ * \brief Groups the bytes of the float values by significance
+ */
+void shuffle(const float* values, size_t count, char* bytes)
+{
+    const char* source = reinterpret_cast<const char*>(values);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t k = 0; k < sizeof(float); k++)
+        {
+            bytes[k * count + i] = source[i * sizeof(float) + k];
+        }
+    }
+}
+
+void unshuffle(const char* bytes, size_t count, float* values)
+{
+    char* target = reinterpret_cast<char*>(values);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t k = 0; k < sizeof(float); k++)
+        {
+            target[i * sizeof(float) + k] = bytes[k * count + i];
+        }
+    }
+}
+#endif
+}
+
+DepthSequenceWriter::DepthSequenceWriter(const std::string& path,
+                                         const DepthSequenceInfo& info,
+                                         Compression compression)
+    : file_(NULL), compression_(compression), frame_count_(0)
+{
+#ifndef DBOT_HAS_LZ4
+    if (compression_ == LZ4_COMPRESSION)
+    {
+        std::cout << "ERROR: dbot was built without LZ4, cannot compress "
+                  << path << std::endl;
+        exit(-1);
+    }
+#endif
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+    {
+        std::cout << "ERROR: could not open depth sequence " << path
+                  << " for writing" << std::endl;
+        exit(-1);
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.frame_id_length = info.frame_id.size();
+    header.native_width = info.native_resolution.width;
+    header.native_height = info.native_resolution.height;
+    header.downsampling_factor = info.downsampling_factor;
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            header.camera_matrix[3 * row + col] = info.camera_matrix(row, col);
+        }
+    }
+
+    std::vector<char> block(sizeof(header) + info.frame_id.size());
+    std::memcpy(block.data(), &header, sizeof(header));
+    std::memcpy(block.data() + sizeof(header),
+                info.frame_id.data(),
+                info.frame_id.size());
+    write_padded(block.data(), block.size());
+}
+
+DepthSequenceWriter::~DepthSequenceWriter()
+{
+    if (file_) std::fclose(file_);
+}
+
+void DepthSequenceWriter::write(const DepthFrame& frame, double timestamp)
+{
+    const size_t raw_size = frame.size() * sizeof(float);
+    const void* payload = frame.data();
+    size_t payload_size = raw_size;
+
+#ifdef DBOT_HAS_LZ4
+    if (compression_ == LZ4_COMPRESSION)
+    {
+        shuffled_.resize(raw_size);
+        shuffle(frame.data(), frame.size(), shuffled_.data());
+
+        compressed_.resize(LZ4_compressBound(raw_size));
+        const int size = LZ4_compress_default(shuffled_.data(),
+                                              compressed_.data(),
+                                              raw_size,
+                                              compressed_.size());
+        if (size <= 0)
+        {
+            std::cout << "ERROR: LZ4 compression of a depth frame failed"
+                      << std::endl;
+            exit(-1);
+        }
+        payload = compressed_.data();
+        payload_size = size;
+    }
+#endif
+
+    ChunkHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = chunk_magic;
+    header.compression = compression_;
+    header.rows = frame.rows();
+    header.cols = frame.cols();
+    header.timestamp = timestamp;
+    header.payload_size = payload_size;
+
+    write_padded(&header, sizeof(header));
+    write_padded(payload, payload_size);
+    frame_count_++;
+}
+
+void DepthSequenceWriter::flush()
+{
+    std::fflush(file_);
+}
+
+void DepthSequenceWriter::write_padded(const void* data, size_t size)
+{
+    static const char padding[alignment] = {0};
+
+    if (std::fwrite(data, 1, size, file_) != size ||
+        std::fwrite(padding, 1, aligned(size) - size, file_) !=
+            aligned(size) - size)
+    {
+        std::cout << "ERROR: could not write depth sequence" << std::endl;
+        exit(-1);
+    }
+}
+
+struct DepthSequenceReader::Mapping
+{
+    Mapping(void* data, size_t size) : data(data), size(size) {}
+    ~Mapping() { munmap(data, size); }
+
+    void* data;
+    size_t size;
+};
+
+DepthSequenceReader::DepthSequenceReader(const std::string& path)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) != 0)
+    {
+        if (fd >= 0) close(fd);
+        throw DepthSequenceException("could not open depth sequence " + path);
+    }
+
+    const size_t size = status.st_size;
+    void* data = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0)
+                          : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        throw DepthSequenceException("could not map depth sequence " + path);
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+    mapping_ = std::make_shared<const Mapping>(data, size);
+
+    const char* bytes = static_cast<const char*>(data);
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    if (size >= sizeof(header)) std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0 ||
+        header.version != file_version ||
+        sizeof(header) + header.frame_id_length > size)
+    {
+        throw DepthSequenceException(path + " is not a depth sequence");
+    }
+
+    info_.frame_id.assign(bytes + sizeof(header), header.frame_id_length);
+    info_.native_resolution.width = header.native_width;
+    info_.native_resolution.height = header.native_height;
+    info_.downsampling_factor = header.downsampling_factor;
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            info_.camera_matrix(row, col) = header.camera_matrix[3 * row + col];
+        }
+    }
+
+    // an interrupted recording ends with an incomplete chunk which is ignored
+    size_t offset = aligned(sizeof(header) + header.frame_id_length);
+    while (offset + aligned(sizeof(ChunkHeader)) <= size)
+    {
+        ChunkHeader chunk_header;
+        std::memcpy(&chunk_header, bytes + offset, sizeof(chunk_header));
+        offset += aligned(sizeof(chunk_header));
+
+        const size_t raw_size =
+            size_t(chunk_header.rows) * chunk_header.cols * sizeof(float);
+        if (chunk_header.magic != chunk_magic || chunk_header.rows < 0 ||
+            chunk_header.cols < 0 || chunk_header.payload_size > size - offset)
+        {
+            break;
+        }
+        if ((chunk_header.compression == DepthSequenceWriter::NO_COMPRESSION &&
+             chunk_header.payload_size != raw_size) ||
+            chunk_header.compression > DepthSequenceWriter::LZ4_COMPRESSION)
+        {
+            throw DepthSequenceException("corrupt frame " +
+                                         std::to_string(chunks_.size()) +
+                                         " in depth sequence " + path);
+        }
+
+        Chunk chunk;
+        chunk.rows = chunk_header.rows;
+        chunk.cols = chunk_header.cols;
+        chunk.timestamp = chunk_header.timestamp;
+        chunk.compression = chunk_header.compression;
+        chunk.offset = offset;
+        chunk.size = chunk_header.payload_size;
+        chunks_.push_back(chunk);
+
+        offset += aligned(chunk_header.payload_size);
+    }
+}
+
+DepthFrame::ConstPtr DepthSequenceReader::frame(size_t index) const
+{
+    const Chunk& chunk = chunks_[index];
+    const char* payload =
+        static_cast<const char*>(mapping_->data) + chunk.offset;
+
+    if (chunk.compression == DepthSequenceWriter::NO_COMPRESSION)
+    {
+        auto frame = std::make_shared<DepthFrame>(
+            chunk.rows,
+            chunk.cols,
+            reinterpret_cast<const float*>(payload),
+            mapping_);
+        frame->timestamp(chunk.timestamp);
+        return frame;
+    }
+
+#ifdef DBOT_HAS_LZ4
+    DepthFrame::Ptr frame = frame_pool_.acquire(chunk.rows, chunk.cols);
+    const int raw_size = frame->size() * sizeof(float);
+
+    thread_local std::vector<char> shuffled;
+    shuffled.resize(raw_size);
+    if (LZ4_decompress_safe(payload, shuffled.data(), chunk.size, raw_size) !=
+        raw_size)
+    {
+        throw DepthSequenceException("could not decompress frame " +
+                                     std::to_string(index) +
+                                     " of a depth sequence");
+    }
+    unshuffle(shuffled.data(), frame->size(), frame->data());
+    frame->timestamp(chunk.timestamp);
+    return frame;
+#else
+    throw DepthSequenceException(
+        "dbot was built without LZ4, cannot decompress frame " +
+        std::to_string(index) + " of a depth sequence");
+#endif
+}
+}
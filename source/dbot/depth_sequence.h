@@ -0,0 +1,173 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_sequence.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/camera_data.h>
+#include <dbot/depth_frame.h>
+
+namespace dbot
+{
+/**
+ * \brief Camera parameters which are stored along a depth sequence
+ */
+struct DepthSequenceInfo
+{
+    std::string frame_id;
+    Eigen::Matrix3d camera_matrix;
+    CameraData::Resolution native_resolution;
+    int downsampling_factor;
+};
+
+/**
+ * \brief Writes depth frames into a sequence file
+ *
+ * The file starts with a header holding the camera parameters, followed by
+ * one chunk per frame with its resolution, timestamp and depth values. All
+ * values are stored in host byte order and the depth values of every chunk
+ * start at a 64 byte boundary, such that DepthSequenceReader can hand them
+ * out of a memory mapping without copying.
+ *
+ * With LZ4_COMPRESSION the bytes of the depth values are regrouped by
+ * significance before compression, which lets LZ4 find the long runs of
+ * equal exponents of a depth image. Compressed frames have to be
+ * decompressed on replay and are therefore not zero copy. LZ4 is only
+ * available if dbot was built with DBOT_HAS_LZ4.
+ *
+ * Frames are written as they come, a recording which was interrupted can be
+ * read up to its last complete frame.
+ */
+class DepthSequenceWriter
+{
+public:
+    enum Compression
+    {
+        NO_COMPRESSION = 0,
+        LZ4_COMPRESSION = 1
+    };
+
+public:
+    DepthSequenceWriter(const std::string& path,
+                        const DepthSequenceInfo& info,
+                        Compression compression = NO_COMPRESSION);
+
+    /**
+     * \brief Closes the file
+     */
+    ~DepthSequenceWriter();
+
+    /**
+     * \brief Appends a frame
+     *
+     * \param timestamp capture time in seconds which is stored instead of the
+     *        timestamp of the frame
+     */
+    void write(const DepthFrame& frame, double timestamp);
+
+    /**
+     * \brief Appends a frame with its own timestamp
+     */
+    void write(const DepthFrame& frame) { write(frame, frame.timestamp()); }
+
+    /**
+     * \brief Flushes the written frames to the file
+     */
+    void flush();
+
+    size_t frame_count() const { return frame_count_; }
+
+private:
+    void write_padded(const void* data, size_t size);
+
+    std::FILE* file_;
+    Compression compression_;
+    size_t frame_count_;
+    std::vector<char> shuffled_;
+    std::vector<char> compressed_;
+};
+
+/**
+ * \brief Represents an exception thrown if a depth sequence cannot be read,
+ *        e.g. because it is no sequence or one of its frames is corrupt
+ */
+class DepthSequenceException : public std::runtime_error
+{
+public:
+    explicit DepthSequenceException(const std::string& message)
+        : std::runtime_error(message)
+    {
+    }
+};
+
+/**
+ * \brief Reads a sequence file written by DepthSequenceWriter through a read
+ *        only memory mapping
+ *
+ * Uncompressed frames view the mapping directly, they remain valid after the
+ * reader is destroyed. A file which cannot be opened or mapped, is no depth
+ * sequence or contains a corrupt chunk throws a DepthSequenceException from
+ * the constructor, a frame which cannot be decompressed throws one from
+ * frame(). An incomplete last chunk is no error.
+ */
+class DepthSequenceReader
+{
+public:
+    explicit DepthSequenceReader(const std::string& path);
+
+    const DepthSequenceInfo& info() const { return info_; }
+
+    size_t frame_count() const { return chunks_.size(); }
+
+    double timestamp(size_t index) const { return chunks_[index].timestamp; }
+
+    /**
+     * \brief Returns the frame at the given index with its recorded
+     *        timestamp
+     *
+     * \throws DepthSequenceException if the frame cannot be decompressed
+     */
+    DepthFrame::ConstPtr frame(size_t index) const;
+
+private:
+    struct Mapping;
+
+    struct Chunk
+    {
+        int rows;
+        int cols;
+        double timestamp;
+        int compression;
+        size_t offset;
+        size_t size;
+    };
+
+    std::shared_ptr<const Mapping> mapping_;
+    DepthSequenceInfo info_;
+    std::vector<Chunk> chunks_;
+    mutable DepthFramePool frame_pool_;
+};
+}
@@ -0,0 +1,206 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_sequence_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <unistd.h>
+
+#include <dbot/depth_sequence.h>
+#include <dbot/replay_camera_data_provider.h>
+
+namespace
+{
+std::string sequence_path()
+{
+    return "/tmp/dbot_depth_sequence_test_" + std::to_string(getpid()) +
+           ".dseq";
+}
+
+dbot::DepthSequenceInfo make_info()
+{
+    dbot::DepthSequenceInfo info;
+    info.frame_id = "/camera_depth_optical_frame";
+    info.camera_matrix << 290, 0, 160, 0, 290, 120, 0, 0, 1;
+    info.native_resolution.width = 8;
+    info.native_resolution.height = 6;
+    info.downsampling_factor = 2;
+    return info;
+}
+
+void fill(dbot::DepthFrame& frame, float offset)
+{
+    for (int i = 0; i < frame.size(); i++) frame.data()[i] = offset + 0.01f * i;
+}
+
+/**
+ * \brief Sets an unknown compression in the header of the given chunk
+ */
+void corrupt_chunk(const std::string& path, int chunk)
+{
+    std::ifstream input(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(input)),
+                        std::istreambuf_iterator<char>());
+    input.close();
+
+    size_t offset = content.find("FRAM");
+    for (int i = 0; i < chunk; i++) offset = content.find("FRAM", offset + 1);
+    ASSERT_NE(offset, std::string::npos);
+    content[offset + 4] = 7;
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(content.data(), content.size());
+}
+}
+
+TEST(DepthSequenceTests, frames_and_camera_survive_the_round_trip)
+{
+    const std::string path = sequence_path();
+    {
+        dbot::DepthSequenceWriter writer(path, make_info());
+        for (int i = 0; i < 3; i++)
+        {
+            dbot::DepthFrame frame(3, 4);
+            fill(frame, i);
+            writer.write(frame, 0.5 + i / 30.);
+        }
+        EXPECT_EQ(writer.frame_count(), 3u);
+    }
+
+    dbot::DepthFrame::ConstPtr first;
+    {
+        dbot::DepthSequenceReader reader(path);
+        EXPECT_EQ(reader.info().frame_id, make_info().frame_id);
+        EXPECT_EQ(reader.info().camera_matrix, make_info().camera_matrix);
+        EXPECT_EQ(reader.info().native_resolution.width, 8);
+        EXPECT_EQ(reader.info().native_resolution.height, 6);
+        EXPECT_EQ(reader.info().downsampling_factor, 2);
+        ASSERT_EQ(reader.frame_count(), 3u);
+
+        for (int i = 0; i < 3; i++)
+        {
+            dbot::DepthFrame expected(3, 4);
+            fill(expected, i);
+
+            dbot::DepthFrame::ConstPtr frame = reader.frame(i);
+            ASSERT_EQ(frame->rows(), 3);
+            ASSERT_EQ(frame->cols(), 4);
+            EXPECT_FALSE(frame->writable());
+            EXPECT_EQ(frame->timestamp(), 0.5 + i / 30.);
+            EXPECT_EQ(frame->image(), expected.image());
+            EXPECT_EQ(std::uintptr_t(frame->data()) % 64, 0u);
+        }
+        first = reader.frame(0);
+    }
+
+    // frames keep the mapping alive
+    EXPECT_FLOAT_EQ(first->data()[1], 0.01f);
+    std::remove(path.c_str());
+}
+
+TEST(DepthSequenceTests, truncated_recording_ends_at_last_complete_frame)
+{
+    const std::string path = sequence_path();
+    {
+        dbot::DepthSequenceWriter writer(path, make_info());
+        dbot::DepthFrame frame(3, 4);
+        fill(frame, 1);
+        writer.write(frame, 1);
+        writer.write(frame, 2);
+    }
+
+    std::ifstream input(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(input)),
+                        std::istreambuf_iterator<char>());
+    input.close();
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(content.data(), content.size() - 20);
+    output.close();
+
+    dbot::DepthSequenceReader reader(path);
+    EXPECT_EQ(reader.frame_count(), 1u);
+    std::remove(path.c_str());
+}
+
+TEST(DepthSequenceTests, unreadable_sequences_throw)
+{
+    const std::string path = sequence_path();
+    EXPECT_THROW(dbot::DepthSequenceReader reader(path),
+                 dbot::DepthSequenceException);
+
+    std::ofstream(path) << "no depth sequence";
+    EXPECT_THROW(dbot::DepthSequenceReader reader(path),
+                 dbot::DepthSequenceException);
+
+    {
+        dbot::DepthSequenceWriter writer(path, make_info());
+        dbot::DepthFrame frame(3, 4);
+        fill(frame, 1);
+        writer.write(frame, 1);
+        writer.write(frame, 2);
+    }
+    corrupt_chunk(path, 1);
+    EXPECT_THROW(dbot::DepthSequenceReader reader(path),
+                 dbot::DepthSequenceException);
+    std::remove(path.c_str());
+}
+
+TEST(DepthSequenceTests, replay_provides_frames_by_resolution)
+{
+    const std::string path = sequence_path();
+    {
+        dbot::DepthSequenceWriter writer(path, make_info());
+        dbot::DepthFrame downsampled(3, 4);
+        fill(downsampled, 0);
+        writer.write(downsampled, 1);
+
+        dbot::DepthFrame native(6, 8);
+        fill(native, 1);
+        writer.write(native, 2);
+    }
+
+    dbot::ReplayCameraDataProvider provider(path);
+    EXPECT_EQ(provider.frame_count(), 2u);
+    EXPECT_EQ(provider.frame_index(), 2u);
+    EXPECT_FALSE(provider.depth_frame());
+    EXPECT_EQ(provider.depth_image_vector().size(), 0);
+
+    ASSERT_TRUE(provider.next());
+    EXPECT_EQ(provider.frame_index(), 0u);
+    ASSERT_TRUE(provider.depth_frame());
+    EXPECT_FALSE(provider.native_depth_frame());
+    EXPECT_EQ(provider.depth_frame()->timestamp(), 1);
+    EXPECT_EQ(provider.depth_image().rows(), 3);
+    EXPECT_FLOAT_EQ(provider.depth_image_vector()(5), 0.05f);
+
+    ASSERT_TRUE(provider.next());
+    EXPECT_FALSE(provider.depth_frame());
+    ASSERT_TRUE(provider.native_depth_frame());
+    EXPECT_EQ(provider.native_depth_frame()->rows(), 6);
+
+    EXPECT_FALSE(provider.next());
+    EXPECT_FALSE(provider.next());
+    EXPECT_FALSE(provider.native_depth_frame());
+
+    provider.rewind();
+    EXPECT_TRUE(provider.next());
+    EXPECT_EQ(provider.frame_index(), 0u);
+    std::remove(path.c_str());
+}
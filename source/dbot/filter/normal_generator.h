@@ -0,0 +1,157 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file normal_generator.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <fl/util/random.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Counter-based generator of standard normal and uniform samples
+ *
+ * The samples are a pure function of (seed, stream, index): the Philox4x32-10
+ * block cipher maps the counter (index / 4, stream) to four random words
+ * which are transformed into normal samples by the Box-Muller transform.
+ * Any range of any stream can therefore be generated independently and in
+ * any order, e.g. by different threads, without changing the result.
+ */
+class NormalGenerator
+{
+public:
+    explicit NormalGenerator(uint64_t seed = RANDOM_SEED) : seed_(seed) {}
+    uint64_t seed() const { return seed_; }
+    void seed(uint64_t seed) { seed_ = seed; }
+    /**
+     * \brief Writes the standard normal samples [offset, offset + count) of
+     *        the given stream
+     */
+    template <typename Scalar>
+    void normal(uint64_t stream,
+                uint64_t offset,
+                size_t count,
+                Scalar* samples) const
+    {
+        uint32_t words[batch_size * 4];
+        double values[batch_size * 4];
+
+        uint64_t counter = offset / 4;
+        size_t skip = size_t(offset % 4);
+        size_t written = 0;
+        while (written < count)
+        {
+            generate(stream, counter, words);
+            box_muller(words, values);
+
+            const size_t available = batch_size * 4 - skip;
+            const size_t n = count - written < available ? count - written
+                                                         : available;
+            for (size_t i = 0; i < n; ++i)
+            {
+                samples[written + i] = Scalar(values[skip + i]);
+            }
+
+            written += n;
+            counter += batch_size;
+            skip = 0;
+        }
+    }
+
+    /**
+     * \return The uniform sample in [0, 1) at the given index of the stream
+     */
+    double uniform(uint64_t stream, uint64_t index) const
+    {
+        uint32_t counter[4] = {uint32_t(index / 4),
+                               uint32_t((index / 4) >> 32),
+                               uint32_t(stream),
+                               uint32_t(stream >> 32)};
+        philox(counter);
+        return counter[index % 4] * (1.0 / 4294967296.0);
+    }
+
+    /**
+     * \brief Applies the Philox4x32-10 bijection to the counter in place
+     */
+    void philox(uint32_t counter[4]) const
+    {
+        uint32_t key[2] = {uint32_t(seed_), uint32_t(seed_ >> 32)};
+        for (int round = 0; round < 10; ++round)
+        {
+            if (round > 0)
+            {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+
+            const uint64_t product0 = uint64_t(0xD2511F53u) * counter[0];
+            const uint64_t product1 = uint64_t(0xCD9E8D57u) * counter[2];
+
+            const uint32_t c1 = counter[1];
+            const uint32_t c3 = counter[3];
+            counter[0] = uint32_t(product1 >> 32) ^ c1 ^ key[0];
+            counter[1] = uint32_t(product1);
+            counter[2] = uint32_t(product0 >> 32) ^ c3 ^ key[1];
+            counter[3] = uint32_t(product0);
+        }
+    }
+
+private:
+    /**
+     * \brief Number of counters enciphered at once, which lets the compiler
+     *        vectorize the rounds across counters
+     */
+    enum : size_t { batch_size = 16 };
+
+    void generate(uint64_t stream, uint64_t counter, uint32_t* words) const
+    {
+        for (size_t i = 0; i < batch_size; ++i)
+        {
+            uint32_t* block = words + 4 * i;
+            block[0] = uint32_t(counter + i);
+            block[1] = uint32_t((counter + i) >> 32);
+            block[2] = uint32_t(stream);
+            block[3] = uint32_t(stream >> 32);
+            philox(block);
+        }
+    }
+
+    static void box_muller(const uint32_t* words, double* values)
+    {
+        const double scale = 1.0 / 4294967296.0;
+        const double two_pi = 6.283185307179586476925286766559;
+
+        for (size_t i = 0; i < batch_size * 4; i += 2)
+        {
+            // map to (0, 1] for the log and [0, 1) for the angle
+            const double u0 = (double(words[i]) + 1.0) * scale;
+            const double u1 = double(words[i + 1]) * scale;
+
+            const double radius = std::sqrt(-2.0 * std::log(u0));
+            values[i] = radius * std::cos(two_pi * u1);
+            values[i + 1] = radius * std::sin(two_pi * u1);
+        }
+    }
+
+    uint64_t seed_;
+};
+}
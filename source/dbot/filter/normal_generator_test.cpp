@@ -0,0 +1,80 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file normal_generator_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <dbot/filter/normal_generator.h>
+
+TEST(NormalGeneratorTests, philox_known_answer)
+{
+    // Random123 known answer test for a zero counter and key
+    dbot::NormalGenerator generator(0);
+    uint32_t counter[4] = {0, 0, 0, 0};
+    generator.philox(counter);
+
+    EXPECT_EQ(counter[0], 0x6627e8d5u);
+    EXPECT_EQ(counter[1], 0xe169c58du);
+    EXPECT_EQ(counter[2], 0xbc57ac4cu);
+    EXPECT_EQ(counter[3], 0x9b00dbd8u);
+}
+
+TEST(NormalGeneratorTests, ranges_are_independent_of_partitioning)
+{
+    dbot::NormalGenerator generator(3);
+
+    std::vector<double> whole(203);
+    generator.normal(5, 0, whole.size(), whole.data());
+
+    std::vector<double> parts(whole.size());
+    generator.normal(5, 0, 7, parts.data());
+    generator.normal(5, 7, 130, parts.data() + 7);
+    generator.normal(5, 137, 66, parts.data() + 137);
+
+    for (size_t i = 0; i < whole.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(whole[i], parts[i]);
+    }
+
+    std::vector<double> other(whole.size());
+    generator.normal(6, 0, other.size(), other.data());
+    EXPECT_NE(whole[0], other[0]);
+}
+
+TEST(NormalGeneratorTests, standard_normal_moments)
+{
+    dbot::NormalGenerator generator(11);
+
+    std::vector<float> samples(100000);
+    generator.normal(0, 0, samples.size(), samples.data());
+
+    double mean = 0;
+    double second_moment = 0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        mean += samples[i];
+        second_moment += samples[i] * samples[i];
+    }
+    mean /= samples.size();
+    second_moment /= samples.size();
+
+    EXPECT_NEAR(mean, 0., 0.02);
+    EXPECT_NEAR(second_moment, 1., 0.02);
+}
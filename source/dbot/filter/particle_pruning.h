@@ -0,0 +1,99 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file particle_pruning.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Parameters of the coarse to fine evaluation
+ *
+ * Every sampling block first scores all particles with the coarse level of
+ * the sensor. The particles whose coarse score, i.e. their log weight plus
+ * their coarse log likelihood, lies more than log_likelihood_margin below
+ * the best one are pruned, only the survivors are evaluated at the full
+ * resolution. The margin is in units of the coarse log likelihoods, which
+ * sum over fewer pixels than the full ones.
+ */
+struct CoarseToFineParameters
+{
+    bool enabled = false;
+    double log_likelihood_margin = 10.;
+    /// fraction of the particles which survives regardless of the margin
+    double min_survivor_fraction = 0.1;
+};
+
+/**
+ * \brief Selects the particles which survive the coarse screening
+ *
+ * Particles within margin of the best score survive, at least min_count of
+ * the best ones survive in any case. Particles with scores which are not
+ * finite are pruned unless they are needed for min_count.
+ *
+ * \param survivors  indices of the surviving particles in ascending order
+ */
+template <typename Scores>
+void select_survivors(const Scores& scores,
+                      double margin,
+                      size_t min_count,
+                      std::vector<int>& survivors)
+{
+    const size_t count = scores.size();
+    survivors.clear();
+    if (count == 0) return;
+
+    auto score = [&scores](int i)
+    {
+        const double s = scores[i];
+        return std::isfinite(s) ? s : -HUGE_VAL;
+    };
+
+    double best = -HUGE_VAL;
+    for (size_t i = 0; i < count; i++) best = std::max(best, score(i));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (score(i) > -HUGE_VAL && score(i) >= best - margin)
+        {
+            survivors.push_back(i);
+        }
+    }
+
+    min_count = std::min(min_count, count);
+    if (survivors.size() >= min_count) return;
+
+    // keep the min_count best ones, the order among equal scores is by index
+    survivors.resize(count);
+    for (size_t i = 0; i < count; i++) survivors[i] = i;
+    std::nth_element(survivors.begin(),
+                     survivors.begin() + (min_count - 1),
+                     survivors.end(),
+                     [&score](int a, int b)
+                     {
+                         return score(a) > score(b) ||
+                                (score(a) == score(b) && a < b);
+                     });
+    survivors.resize(min_count);
+    std::sort(survivors.begin(), survivors.end());
+}
+}
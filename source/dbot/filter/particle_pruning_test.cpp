@@ -0,0 +1,63 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file particle_pruning_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include <dbot/filter/particle_pruning.h>
+
+TEST(ParticlePruningTests, keeps_the_particles_within_the_margin)
+{
+    const std::vector<double> scores = {-3, -20, 0, -9.5, -11};
+    std::vector<int> survivors;
+
+    dbot::select_survivors(scores, 10., 1, survivors);
+    EXPECT_EQ((std::vector<int>{0, 2, 3}), survivors);
+
+    dbot::select_survivors(scores, 100., 1, survivors);
+    EXPECT_EQ(5u, survivors.size());
+}
+
+TEST(ParticlePruningTests, keeps_at_least_the_best_min_count)
+{
+    const std::vector<double> scores = {-30, -20, 0, -50, -20};
+    std::vector<int> survivors;
+
+    dbot::select_survivors(scores, 1., 3, survivors);
+    EXPECT_EQ((std::vector<int>{1, 2, 4}), survivors);
+
+    dbot::select_survivors(scores, 1., 10, survivors);
+    EXPECT_EQ(5u, survivors.size());
+}
+
+TEST(ParticlePruningTests, prunes_scores_which_are_not_finite)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    const std::vector<double> scores = {nan, -1, -inf, 0};
+    std::vector<int> survivors;
+
+    dbot::select_survivors(scores, 10., 1, survivors);
+    EXPECT_EQ((std::vector<int>{1, 3}), survivors);
+
+    dbot::select_survivors(scores, 0., 3, survivors);
+    EXPECT_EQ(3u, survivors.size());
+    EXPECT_EQ(1, survivors[1]);
+    EXPECT_EQ(3, survivors[2]);
+}
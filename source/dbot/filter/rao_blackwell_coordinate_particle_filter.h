@@ -24,6 +24,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <vector>
 #include <limits>
 #include <string>
@@ -32,15 +36,45 @@
 #include <Eigen/Core>
 
 #include <fl/util/types.hpp>
-#include <fl/distribution/gaussian.hpp>
 #include <fl/distribution/discrete_distribution.hpp>
 #include <fl/util/profiling.hpp>
 
 #include <dbot/traits.h>
+#include <dbot/filter/normal_generator.h>
+#include <dbot/filter/particle_pruning.h>
+#include <dbot/filter/resampler.h>
+#include <dbot/filter/sampling_schedule.h>
+#include <dbot/latency_metrics.h>
+#include <dbot/model/batch_transition.h>
 #include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/pose/rigid_bodies_state_array.h>
+#include <dbot/worker_pool.h>
 
 namespace dbot
 {
+/**
+ * \brief Parameters of the adaptive particle count
+ *
+ * The particle count of each filter step is chosen by the KLD-sampling bound
+ * (Fox, 2003) on the number of histogram bins the belief occupies, clamped to
+ * [min_sample_count, max_sample_count], to the number of states the sensor
+ * can evaluate at once and to the count which fits into the time budget.
+ */
+struct AdaptiveSamplingParameters
+{
+    bool enabled = false;
+    int min_sample_count = 100;
+    int max_sample_count = 10000;
+    /// bound on the KL divergence between the sample and the true belief
+    double kld_error = 0.05;
+    /// standard normal upper quantile of the confidence in the bound
+    double kld_quantile = 2.33;
+    /// edge length of the histogram bins in every state coordinate
+    double bin_size = 0.01;
+    /// wall time available for one filter step in seconds, 0 disables it
+    double time_budget = 0;
+};
+
 template <typename Transition, typename Sensor>
 class RaoBlackwellCoordinateParticleFilter
 {
@@ -57,16 +91,28 @@ public:
 
     typedef fl::DiscreteDistribution<State> Belief;
 
+    // fixed-size noises of states with a fixed body count need aligned
+    // storage
+    typedef std::vector<Noise, Eigen::aligned_allocator<Noise>> Noises;
+
+    typedef dbot::BatchTransition<State, Noise, Input> BatchTransition;
+
 public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
     /// constructor and destructor *********************************************
     RaoBlackwellCoordinateParticleFilter(
         const std::shared_ptr<Transition> transition,
         const std::shared_ptr<Sensor> sensor,
         const std::vector<std::vector<int>>& sampling_blocks,
-        const fl::Real& max_kl_divergence = 0)
+        const fl::Real& max_kl_divergence = 0,
+        const Resampler& resampler = Resampler())
         : sensor_(sensor),
           transition_(transition),
-          max_kl_divergence_(max_kl_divergence)
+          batch_transition_(
+              std::dynamic_pointer_cast<BatchTransition>(transition)),
+          max_kl_divergence_(max_kl_divergence),
+          resampler_(resampler)
     {
         sampling_blocks_ = sampling_blocks;
 
@@ -88,92 +134,311 @@ public:
     /// the filter functions ***************************************************
     void filter(const Observation& observation, const Input& input)
     {
+        const auto start_time = std::chrono::steady_clock::now();
+
         sensor_->set_observation(observation);
+        update(input, start_time);
+    }
 
-        loglikes_ = RealArray::Zero(belief_.size());
-        noises_ = std::vector<Noise>(
-            belief_.size(), Noise::Zero(transition_->noise_dimension()));
-        old_particles_ = belief_.locations();
-        for (size_t i_block = 0; i_block < sampling_blocks_.size(); i_block++)
-        {
-            // add noise of this block -----------------------------------------
-            for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
-            {
-                for (size_t i = 0; i < sampling_blocks_[i_block].size(); i++)
-                {
-                    noises_[i_sampl](sampling_blocks_[i_block][i]) =
-                        unit_gaussian_.sample()(0);
-                }
-            }
+    /**
+     * \brief Filter step on a depth frame, which the sensor reads without
+     *        converting it to an Observation
+     */
+    void filter(const DepthFrame::ConstPtr& frame, const Input& input)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
 
-            // propagate using partial noise -----------------------------------
-            for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
-            {
-                belief_.location(i_sampl) = transition_->state(
-                    old_particles_[i_sampl], noises_[i_sampl], input);
-            }
+        sensor_->set_depth_frame(frame);
+        update(input, start_time);
+    }
 
-            // compute likelihood ----------------------------------------------
-            bool update = (i_block == sampling_blocks_.size() - 1);
-            RealArray new_loglikes = sensor_->loglikes(
-                belief_.locations(), indices_, update);
+    /**
+     * \brief Filter step on one depth frame per camera view of the sensor,
+     *        the particles are weighted by the likelihoods of all views
+     */
+    void filter(const std::vector<DepthFrame::ConstPtr>& frames,
+                const Input& input)
+    {
+        const auto start_time = std::chrono::steady_clock::now();
 
-            // update the weights and resample if necessary --------------------
-            belief_.delta_log_prob_mass(new_loglikes - loglikes_);
-            loglikes_ = new_loglikes;
+        sensor_->set_depth_frames(frames);
+        update(input, start_time);
+    }
 
-            if (belief_.kl_given_uniform() > max_kl_divergence_)
+    /**
+     * \brief Prediction step on a frame which is not weighted, e.g. one in
+     *        which nothing changed
+     *
+     * The frame is set in the sensor, which advances the observation time
+     * the occlusions are propagated to at the next evaluation. The particles
+     * are moved by the transition without noise and keep their weights,
+     * nothing is rendered or weighted.
+     */
+    void predict(const DepthFrame::ConstPtr& frame, const Input& input)
+    {
+        LatencyMetrics::Clock::time_point stage_start =
+            LatencyMetrics::Clock::now();
+
+        sensor_->set_depth_frame(frame);
+
+        allocate_workspace(belief_.size());
+        for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
+        {
+            noises_[i_sampl].setZero();
+            old_particles_[i_sampl] = belief_.location(i_sampl);
+        }
+        propagate(input);
+        lap(LatencyMetrics::PROPAGATION, stage_start);
+
+        step_++;
+    }
+
+    /**
+     * \brief Number of particles required by the KLD-sampling bound for the
+     *        current belief, clamped by the adaptive sampling limits
+     */
+    size_t adaptive_sample_count()
+    {
+        const AdaptiveSamplingParameters& params = adaptive_sampling_;
+
+        // count the occupied histogram bins
+        bin_keys_.resize(belief_.size());
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            const State& state = belief_.location(i);
+            uint64_t key = 14695981039346656037ull;
+            for (int k = 0; k < state.size(); k++)
             {
-                resample(belief_.size());
+                const int64_t bin =
+                    int64_t(std::floor(state(k) / params.bin_size));
+                key = (key ^ uint64_t(bin)) * 1099511628211ull;
             }
+            bin_keys_[i] = key;
+        }
+        std::sort(bin_keys_.begin(), bin_keys_.end());
+        const size_t bins =
+            std::unique(bin_keys_.begin(), bin_keys_.end()) - bin_keys_.begin();
+
+        double count = params.min_sample_count;
+        if (bins > 1)
+        {
+            const double a = 2.0 / (9.0 * double(bins - 1));
+            const double b = 1.0 - a + std::sqrt(a) * params.kld_quantile;
+            count = double(bins - 1) / (2.0 * params.kld_error) * b * b * b;
+        }
+
+        double max_count = std::min(params.max_sample_count,
+                                    sensor_->max_sample_count());
+        if (params.time_budget > 0 && time_per_sample_ > 0)
+        {
+            max_count = std::min(max_count,
+                                 params.time_budget / time_per_sample_);
         }
+
+        count = std::min(count, max_count);
+        count = std::max(count, double(params.min_sample_count));
+        count = std::min(count, double(sensor_->max_sample_count()));
+        return std::max(size_t(count), size_t(1));
     }
 
+    /**
+     * \brief Draws sample_count particles from the current belief and resets
+     *        the weights to uniform
+     *
+     * The ancestors are drawn first, the particle state is then permuted into
+     * the second half of the double buffered workspace which is swapped in
+     * afterwards. No memory is allocated unless sample_count differs from the
+     * current particle count.
+     */
     void resample(const size_t& sample_count)
     {
-        IntArray indices(sample_count);
-        std::vector<Noise> noises(sample_count);
-        StateArray next_samples(sample_count);
-        RealArray loglikes(sample_count);
+        allocate_workspace(belief_.size());
+        draw_ancestors(sample_count);
 
-        Belief new_belief(sample_count);
+        if (resampled_noises_.size() != sample_count)
+        {
+            resampled_indices_.resize(sample_count);
+            resampled_noises_.resize(sample_count);
+            resampled_old_particles_.resize(sample_count);
+            resampled_locations_.resize(sample_count);
+            resampled_loglikes_.resize(sample_count);
+        }
 
         for (size_t i = 0; i < sample_count; i++)
         {
-            int index;
-            new_belief.location(i) = belief_.sample(index);
+            const int index = ancestors_[i];
+
+            resampled_locations_[i] = belief_.location(index);
+            resampled_indices_[i] = indices_[index];
+            resampled_noises_[i] = noises_[index];
+            resampled_old_particles_[i] = old_particles_[index];
+            resampled_loglikes_[i] = loglikes_[index];
+        }
 
-            indices[i] = indices_[index];
-            noises[i] = noises_[index];
-            next_samples[i] = old_particles_[index];
-            loglikes[i] = loglikes_[index];
+        belief_.set_uniform(sample_count);
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            belief_.location(i).swap(resampled_locations_[i]);
         }
-        belief_ = new_belief;
-        indices_ = indices;
-        noises_ = noises;
-        old_particles_ = next_samples;
-        loglikes_ = loglikes;
+
+        indices_.swap(resampled_indices_);
+        noises_.swap(resampled_noises_);
+        old_particles_.swap(resampled_old_particles_);
+        loglikes_.swap(resampled_loglikes_);
+    }
+
+    /**
+     * \brief Expresses the particles relative to their weighted mean and
+     *        returns the mean
+     *
+     * The particles are copied into the columns of a RigidBodiesStateArray,
+     * the mean and the relative poses are computed there for all particles
+     * at once and the result is copied back.
+     */
+    State center_belief()
+    {
+        mean_weights_.resize(belief_.size());
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            mean_weights_[i] = belief_.prob_mass(i);
+        }
+
+        particle_columns_.gather(belief_.locations());
+        const State mean = particle_columns_.mean(mean_weights_);
+        particle_columns_.subtract(mean);
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            particle_columns_.get(i, belief_.location(i));
+        }
+
+        return mean;
     }
 
     /// accessors **************************************************************
+    /**
+     * \brief Sets the metrics the filter and its sensor add the time of their
+     *        stages to, none disables the measurements
+     */
+    void latency_metrics(const std::shared_ptr<LatencyMetrics>& metrics)
+    {
+        latency_metrics_ = metrics;
+        sensor_->latency_metrics(metrics);
+    }
+
+    const std::shared_ptr<LatencyMetrics>& latency_metrics() const
+    {
+        return latency_metrics_;
+    }
+
     std::vector<std::vector<int>> sampling_blocks() const
     {
         return sampling_blocks_;
     }
 
+    /**
+     * \brief Sampling blocks evaluated in the last filter step, in the order
+     *        they were sampled
+     */
+    const std::vector<int>& sampling_block_order() const
+    {
+        return block_order_;
+    }
+
     /// mutators ***************************************************************
     Belief& belief() { return belief_; }
-    void set_particles(const std::vector<State>& samples)
+    const AdaptiveSamplingParameters& adaptive_sampling() const
+    {
+        return adaptive_sampling_;
+    }
+    void adaptive_sampling(const AdaptiveSamplingParameters& params)
+    {
+        adaptive_sampling_ = params;
+    }
+    /**
+     * \brief Coarse to fine evaluation, which requires a sensor with a
+     *        coarse level, the particles are evaluated at full resolution
+     *        only otherwise
+     */
+    const CoarseToFineParameters& coarse_to_fine() const
+    {
+        return coarse_to_fine_;
+    }
+    void coarse_to_fine(const CoarseToFineParameters& params)
+    {
+        coarse_to_fine_ = params;
+    }
+    /**
+     * \brief Ordering and skipping of the sampling blocks, which requires the
+     *        state coordinates of the blocks, all blocks are sampled in the
+     *        given order otherwise
+     */
+    const SamplingScheduleParameters& sampling_schedule() const
+    {
+        return sampling_schedule_;
+    }
+    void sampling_schedule(const SamplingScheduleParameters& params)
+    {
+        sampling_schedule_ = params;
+    }
+    /**
+     * \brief Generates the noise and propagates the particles in ranges on
+     *        the shared pool, which requires a transition whose state()
+     *        and states() may be called concurrently. The particles are the
+     *        same with and without a pool.
+     */
+    const std::shared_ptr<WorkerPool>& worker_pool() const
+    {
+        return worker_pool_;
+    }
+    void worker_pool(const std::shared_ptr<WorkerPool>& pool)
+    {
+        worker_pool_ = pool;
+    }
+    /**
+     * \brief Sets the state coordinates whose variance measures the
+     *        uncertainty of each sampling block, e.g. the pose coordinates
+     *        its noise drives
+     */
+    void sampling_block_states(const std::vector<std::vector<int>>& states)
+    {
+        if (states.size() != sampling_blocks_.size())
+        {
+            std::cout << "ERROR: state coordinates of " << states.size()
+                      << " sampling blocks for " << sampling_blocks_.size()
+                      << " blocks" << std::endl;
+            exit(-1);
+        }
+        block_states_ = states;
+    }
+    /**
+     * \brief Exponent the likelihoods are raised to, below 1 it flattens
+     *        them for annealing, e.g. while reacquiring a lost object
+     */
+    fl::Real likelihood_exponent() const { return likelihood_exponent_; }
+    void likelihood_exponent(fl::Real exponent)
+    {
+        likelihood_exponent_ = exponent;
+    }
+    /**
+     * \brief Sets the particles to the given states with uniform weights,
+     *        any container of States with size() and operator[]
+     */
+    template <typename States>
+    void set_particles(const States& samples)
     {
         belief_.set_uniform(samples.size());
         for (int i = 0; i < belief_.size(); i++)
             belief_.location(i) = samples[i];
 
-        indices_ = IntArray::Zero(belief_.size());
-        loglikes_ = RealArray::Zero(belief_.size());
-        noises_ = std::vector<Noise>(
-            belief_.size(), Noise::Zero(transition_->noise_dimension()));
-        old_particles_ = belief_.locations();
+        allocate_workspace(belief_.size());
+        indices_.setZero();
+        loglikes_.setZero();
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            noises_[i].setZero();
+            old_particles_[i] = belief_.location(i);
+        }
+        block_skipped_steps_.clear();
 
         sensor_->reset();
     }
@@ -189,23 +454,432 @@ public:
     }
 
 private:
+    /**
+     * \brief Propagates and weights the particles given the observation which
+     *        was set in the sensor
+     */
+    void update(const Input& input,
+                const std::chrono::steady_clock::time_point& start_time)
+    {
+        LatencyMetrics::Clock::time_point stage_start =
+            LatencyMetrics::Clock::now();
+
+        if (adaptive_sampling_.enabled && belief_.size() > 0)
+        {
+            const size_t sample_count = adaptive_sample_count();
+            if (sample_count != size_t(belief_.size()))
+            {
+                resample(sample_count);
+                lap(LatencyMetrics::RESAMPLING, stage_start);
+            }
+        }
+
+        allocate_workspace(belief_.size());
+        loglikes_.setZero();
+        for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
+        {
+            noises_[i_sampl].setZero();
+            old_particles_[i_sampl] = belief_.location(i_sampl);
+        }
+
+        schedule_blocks();
+        for (size_t i_order = 0; i_order < block_order_.size(); i_order++)
+        {
+            const size_t i_block = block_order_[i_order];
+
+            // add noise of this block -----------------------------------------
+            stage_start = LatencyMetrics::Clock::now();
+            const std::vector<int>& block = sampling_blocks_[i_block];
+            const size_t block_size = block.size();
+            const uint64_t stream = step_ * sampling_blocks_.size() + i_block;
+            block_noise_.resize(belief_.size() * block_size);
+            for_particle_ranges(
+                belief_.size(),
+                [&](int i_range, int begin, int end)
+                {
+                    // the samples of a particle only depend on its index
+                    fl::Real* noise = block_noise_.data() + begin * block_size;
+                    normal_generator_.normal(stream,
+                                             begin * block_size,
+                                             (end - begin) * block_size,
+                                             noise);
+                    for (int i_sampl = begin; i_sampl < end; i_sampl++)
+                    {
+                        for (size_t i = 0; i < block_size; i++)
+                        {
+                            noises_[i_sampl](block[i]) =
+                                block_noise_[i_sampl * block_size + i];
+                        }
+                    }
+                });
+            lap(LatencyMetrics::NOISE_GENERATION, stage_start);
+
+            // propagate using partial noise -----------------------------------
+            propagate(input);
+            lap(LatencyMetrics::PROPAGATION, stage_start);
+
+            // compute likelihood, the sensor adds the time of its stages ------
+            bool update = (i_order == block_order_.size() - 1);
+            const bool pruned = evaluate(update);
+            if (likelihood_exponent_ != 1)
+            {
+                new_loglikes_ *= likelihood_exponent_;
+            }
+
+            // update the weights and resample if necessary, pruned particles
+            // have no weight left and are always resampled away ------------
+            delta_loglikes_ = new_loglikes_ - loglikes_;
+            belief_.delta_log_prob_mass(delta_loglikes_);
+            loglikes_.swap(new_loglikes_);
+
+            if (pruned || belief_.kl_given_uniform() > max_kl_divergence_)
+            {
+                stage_start = LatencyMetrics::Clock::now();
+                resample(belief_.size());
+                lap(LatencyMetrics::RESAMPLING, stage_start);
+            }
+        }
+
+        step_++;
+
+        // running average of the time per particle for the time budget
+        const double elapsed = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() -
+                                   start_time).count();
+        const double time_per_sample = elapsed / double(belief_.size());
+        time_per_sample_ = time_per_sample_ > 0
+                               ? 0.8 * time_per_sample_ + 0.2 * time_per_sample
+                               : time_per_sample;
+    }
+
+    /**
+     * \brief Selects the sampling blocks of the next filter step and their
+     *        order into block_order_ according to the sampling schedule
+     */
+    void schedule_blocks()
+    {
+        const size_t block_count = sampling_blocks_.size();
+        block_order_.resize(block_count);
+        for (size_t i = 0; i < block_count; i++)
+        {
+            block_order_[i] = i;
+        }
+
+        const SamplingScheduleParameters& params = sampling_schedule_;
+        if (block_states_.empty() || belief_.size() == 0 ||
+            (!params.order_by_uncertainty && !(params.collapsed_variance > 0)))
+        {
+            return;
+        }
+
+        // summed weighted variance of the state coordinates of each block
+        block_variances_.assign(block_count, 0);
+        for (size_t i_block = 0; i_block < block_count; i_block++)
+        {
+            for (const int k : block_states_[i_block])
+            {
+                fl::Real mean = 0;
+                fl::Real square = 0;
+                for (size_t i = 0; i < belief_.size(); i++)
+                {
+                    const fl::Real x = belief_.location(i)(k);
+                    mean += belief_.prob_mass(i) * x;
+                    square += belief_.prob_mass(i) * x * x;
+                }
+                block_variances_[i_block] +=
+                    std::max(square - mean * mean, fl::Real(0));
+            }
+        }
+
+        schedule_sampling_blocks(
+            block_variances_, params, block_skipped_steps_, block_order_);
+    }
+
+    /**
+     * \brief Computes the log likelihoods of the propagated particles into
+     *        new_loglikes_
+     *
+     * If the coarse to fine evaluation is enabled, the particles are scored
+     * at the coarse level of the sensor first. Only the survivors are copied
+     * into a compact array and evaluated at full resolution, the pruned ones
+     * keep their previous likelihood minus a penalty which leaves them no
+     * weight. The occlusion indices the sensor assigns to the survivors are
+     * copied back to their particles.
+     *
+     * \return whether particles were pruned
+     */
+    bool evaluate(bool update)
+    {
+        const size_t particle_count = belief_.size();
+        if (!coarse_to_fine_.enabled ||
+            !sensor_->coarse_loglikes(belief_.locations(), coarse_loglikes_))
+        {
+            new_loglikes_ =
+                sensor_->loglikes(belief_.locations(), indices_, update);
+            return false;
+        }
+
+        coarse_scores_.resize(particle_count);
+        for (size_t i = 0; i < particle_count; i++)
+        {
+            coarse_scores_[i] = belief_.log_prob_mass(i) + coarse_loglikes_[i];
+        }
+        const size_t min_count = std::max<size_t>(
+            std::ceil(coarse_to_fine_.min_survivor_fraction * particle_count),
+            1);
+        select_survivors(coarse_scores_,
+                         coarse_to_fine_.log_likelihood_margin,
+                         min_count,
+                         survivors_);
+
+        if (survivors_.size() == particle_count)
+        {
+            new_loglikes_ =
+                sensor_->loglikes(belief_.locations(), indices_, update);
+            return false;
+        }
+
+        const size_t survivor_count = survivors_.size();
+        survivor_locations_.resize(survivor_count);
+        survivor_indices_.resize(survivor_count);
+        for (size_t i = 0; i < survivor_count; i++)
+        {
+            survivor_locations_[i] = belief_.location(survivors_[i]);
+            survivor_indices_[i] = indices_[survivors_[i]];
+        }
+        survivor_loglikes_ =
+            sensor_->loglikes(survivor_locations_, survivor_indices_, update);
+
+        // exp() of the penalty is 0 while the log weights stay finite
+        const fl::Real pruned_penalty = 1e10;
+        new_loglikes_ = loglikes_ - pruned_penalty;
+        for (size_t i = 0; i < survivor_count; i++)
+        {
+            new_loglikes_[survivors_[i]] = survivor_loglikes_[i];
+            indices_[survivors_[i]] = survivor_indices_[i];
+        }
+        return true;
+    }
+
+    void lap(LatencyMetrics::Stage stage,
+             LatencyMetrics::Clock::time_point& since)
+    {
+        if (latency_metrics_) latency_metrics_->lap(stage, since);
+    }
+
+    /**
+     * \brief Resizes the workspace to particle_count particles
+     *
+     * This only allocates if the particle count has changed, such that a
+     * filter step with a constant particle count is free of allocations.
+     */
+    void allocate_workspace(size_t particle_count)
+    {
+        if (noises_.size() == particle_count) return;
+
+        indices_.resize(particle_count);
+        indices_.setZero();
+        loglikes_ = RealArray::Zero(particle_count);
+        new_loglikes_.resize(particle_count);
+        delta_loglikes_.resize(particle_count);
+        noises_.assign(particle_count,
+                       Noise::Zero(transition_->noise_dimension()));
+        old_particles_ = belief_.locations();
+    }
+
+    /**
+     * \brief Propagates the old particles given their noises into the belief
+     *        with a single call of the batch transition
+     */
+    void propagate(const Input& input)
+    {
+        if (batch_transition_)
+        {
+            propagate_batch(input);
+            return;
+        }
+
+        for_particle_ranges(belief_.size(),
+                            [&](int i_range, int begin, int end)
+                            {
+                                for (int i = begin; i < end; i++)
+                                {
+                                    belief_.location(i) = transition_->state(
+                                        old_particles_[i], noises_[i], input);
+                                }
+                            });
+    }
+
+    /**
+     * \brief Propagates each range of the particles with one call to the
+     *        batch transition, in buffers of that range
+     */
+    void propagate_batch(const Input& input)
+    {
+        batch_buffers_.resize(
+            worker_pool_ ? worker_pool_->concurrency() : 1);
+        for_particle_ranges(
+            belief_.size(),
+            [&](int i_range, int begin, int end)
+            {
+                BatchBuffers& buffers = batch_buffers_[i_range];
+                buffers.prev_states.resize(end - begin,
+                                           old_particles_[0].size());
+                buffers.noises.resize(end - begin,
+                                      transition_->noise_dimension());
+                for (int i = begin; i < end; i++)
+                {
+                    buffers.prev_states.row(i - begin) =
+                        old_particles_[i].transpose();
+                    buffers.noises.row(i - begin) = noises_[i].transpose();
+                }
+
+                batch_transition_->states(buffers.prev_states,
+                                          buffers.noises,
+                                          input,
+                                          buffers.states);
+
+                for (int i = begin; i < end; i++)
+                {
+                    belief_.location(i) =
+                        buffers.states.row(i - begin).transpose();
+                }
+            });
+    }
+
+    /**
+     * \brief Calls function(i_range, begin, end) for contiguous ranges
+     *        [begin, end) of the count particles, in parallel on the shared
+     *        pool if there is one, with at most one range per thread of
+     *        the pool
+     */
+    template <typename Function>
+    void for_particle_ranges(int count, const Function& function)
+    {
+        const int range_count =
+            worker_pool_
+                ? std::max(1,
+                           std::min(worker_pool_->concurrency(),
+                                    count / particle_range_min))
+                : 1;
+        if (range_count == 1)
+        {
+            function(0, 0, count);
+            return;
+        }
+
+        const int range = (count + range_count - 1) / range_count;
+        worker_pool_->parallel_for(range_count,
+                                   [&](int i_range)
+                                   {
+                                       const int begin =
+                                           std::min(i_range * range, count);
+                                       function(i_range,
+                                                begin,
+                                                std::min(begin + range, count));
+                                   });
+    }
+
+    /**
+     * \brief Draws sample_count ancestor indices from the belief
+     */
+    void draw_ancestors(size_t sample_count)
+    {
+        weights_.resize(belief_.size());
+        for (size_t i = 0; i < belief_.size(); i++)
+        {
+            weights_[i] = belief_.prob_mass(i);
+        }
+
+        // every resampling step draws from its own uniform stream
+        const uint64_t stream = resampling_stream_bit | resampling_count_++;
+        uint64_t index = 0;
+        auto uniform = [this, stream, &index]()
+        {
+            return normal_generator_.uniform(stream, index++);
+        };
+
+        resampler_.resample(weights_.data(),
+                            weights_.size(),
+                            sample_count,
+                            uniform,
+                            ancestors_);
+    }
+
     /// member variables *******************************************************
     Belief belief_;
     IntArray indices_;
 
-    std::vector<Noise> noises_;
+    Noises noises_;
     StateArray old_particles_;
     RealArray loglikes_;
 
+    // workspace reused across filter steps
+    RealArray new_loglikes_;
+    RealArray delta_loglikes_;
+    std::vector<fl::Real> weights_;
+    std::vector<int> ancestors_;
+    RigidBodiesStateArray<State> particle_columns_;
+    struct BatchBuffers
+    {
+        typename BatchTransition::Matrix prev_states;
+        typename BatchTransition::Matrix noises;
+        typename BatchTransition::Matrix states;
+    };
+    std::vector<BatchBuffers> batch_buffers_;
+    RealArray mean_weights_;
+
+    // second buffers of the state permuted by resample()
+    IntArray resampled_indices_;
+    Noises resampled_noises_;
+    StateArray resampled_old_particles_;
+    StateArray resampled_locations_;
+    RealArray resampled_loglikes_;
+
     // models
     std::shared_ptr<Sensor> sensor_;
     std::shared_ptr<Transition> transition_;
+    // the transition if it propagates whole populations, otherwise none
+    std::shared_ptr<BatchTransition> batch_transition_;
+    std::shared_ptr<LatencyMetrics> latency_metrics_;
+    // runs the noise generation and propagation of particle ranges
+    std::shared_ptr<WorkerPool> worker_pool_;
 
     // parameters
     std::vector<std::vector<int>> sampling_blocks_;
+    // state coordinates of the blocks and the blocks of the current step
+    std::vector<std::vector<int>> block_states_;
+    SamplingScheduleParameters sampling_schedule_;
+    std::vector<int> block_order_;
+    std::vector<fl::Real> block_variances_;
+    std::vector<int> block_skipped_steps_;
     fl::Real max_kl_divergence_;
-
-    // distribution for sampling
-    fl::Gaussian<Eigen::Matrix<fl::Real, 1, 1>> unit_gaussian_;
+    Resampler resampler_;
+    fl::Real likelihood_exponent_ = 1;
+
+    // noise and resampling streams, the noise of sampling block b in filter
+    // step t is stream t * B + b, the uniforms of the k-th resampling are
+    // stream resampling_stream_bit | k
+    static constexpr uint64_t resampling_stream_bit = uint64_t(1) << 63;
+    // particles per range below which noise and propagation are not split
+    static constexpr int particle_range_min = 64;
+    NormalGenerator normal_generator_;
+    uint64_t step_ = 0;
+    uint64_t resampling_count_ = 0;
+    std::vector<fl::Real> block_noise_;
+
+    // coarse to fine evaluation
+    CoarseToFineParameters coarse_to_fine_;
+    RealArray coarse_loglikes_;
+    std::vector<fl::Real> coarse_scores_;
+    std::vector<int> survivors_;
+    StateArray survivor_locations_;
+    IntArray survivor_indices_;
+    RealArray survivor_loglikes_;
+
+    // adaptive particle count
+    AdaptiveSamplingParameters adaptive_sampling_;
+    std::vector<uint64_t> bin_keys_;
+    double time_per_sample_ = 0;
 };
 }
@@ -0,0 +1,316 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file resampler.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <dbot/worker_pool.h>
+
+namespace dbot
+{
+enum ResamplingScheme
+{
+    /// every ancestor is drawn independently, O(M log N)
+    MULTINOMIAL_RESAMPLING,
+    /// a single uniform offset shared by M equally spaced points, O(N + M)
+    SYSTEMATIC_RESAMPLING,
+    /// one uniform draw in each of M equally sized strata, O(N + M)
+    STRATIFIED_RESAMPLING,
+    /// deterministic copies of floor(M w_i) followed by a systematic draw
+    /// of the remainder, O(N + M)
+    RESIDUAL_RESAMPLING
+};
+
+/**
+ * \brief Draws the ancestor indices of a resampling step from a set of
+ *        (unnormalized) weights
+ *
+ * All schemes except the multinomial one produce the ancestors in a single
+ * merge pass over the cumulative weights and return them in ascending order.
+ * The cumulative weights are computed by a blocked parallel prefix sum once
+ * the particle count exceeds parallel_threshold and more than one thread is
+ * requested.
+ */
+class Resampler
+{
+public:
+    /**
+     * \param thread_count  Number of threads used for the prefix sum of large
+     *                      particle sets
+     */
+    explicit Resampler(ResamplingScheme scheme = MULTINOMIAL_RESAMPLING,
+                       int thread_count = 1)
+        : scheme_(scheme), thread_count_(std::max(thread_count, 1))
+    {
+    }
+
+    ResamplingScheme scheme() const { return scheme_; }
+    /**
+     * \brief Runs the blocks of the prefix sum on the shared pool instead of
+     *        threads of its own, one block per thread of the pool
+     */
+    const std::shared_ptr<WorkerPool>& worker_pool() const
+    {
+        return worker_pool_;
+    }
+    void worker_pool(const std::shared_ptr<WorkerPool>& pool)
+    {
+        worker_pool_ = pool;
+    }
+
+    /**
+     * \brief Writes sample_count ancestor indices drawn from the weights
+     *
+     * \param weights       Non-negative weights of weight_count particles
+     * \param uniform       Callable returning samples uniform in [0, 1)
+     * \param ancestors     Resized to sample_count and filled with indices in
+     *                      [0, weight_count)
+     */
+    template <typename Uniform>
+    void resample(const double* weights,
+                  size_t weight_count,
+                  size_t sample_count,
+                  Uniform& uniform,
+                  std::vector<int>& ancestors)
+    {
+        ancestors.resize(sample_count);
+        if (sample_count == 0 || weight_count == 0) return;
+
+        switch (scheme_)
+        {
+            case MULTINOMIAL_RESAMPLING:
+                prefix_sum(weights, weight_count, cumulative_);
+                multinomial(cumulative_, uniform, ancestors);
+                break;
+            case SYSTEMATIC_RESAMPLING:
+            {
+                prefix_sum(weights, weight_count, cumulative_);
+                const double offset = uniform();
+                merge(cumulative_,
+                      [offset](size_t i) { return i + offset; },
+                      ancestors);
+                break;
+            }
+            case STRATIFIED_RESAMPLING:
+                prefix_sum(weights, weight_count, cumulative_);
+                merge(cumulative_,
+                      [&uniform](size_t i) { return i + uniform(); },
+                      ancestors);
+                break;
+            case RESIDUAL_RESAMPLING:
+                residual(weights, weight_count, uniform, ancestors);
+                break;
+        }
+    }
+
+    /**
+     * \brief Inclusive prefix sum of the given values
+     */
+    void prefix_sum(const double* values,
+                    size_t count,
+                    std::vector<double>& sums) const
+    {
+        sums.resize(count);
+
+        const size_t thread_count =
+            worker_pool_ ? worker_pool_->concurrency() : thread_count_;
+        const size_t block_count =
+            count < parallel_threshold
+                ? 1
+                : std::min<size_t>(thread_count, count / block_size_min);
+
+        if (block_count <= 1)
+        {
+            double sum = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                sum += values[i];
+                sums[i] = sum;
+            }
+            return;
+        }
+
+        // scan each block independently, then add the sum of all preceding
+        // blocks in a second pass
+        std::vector<double> block_sums(block_count);
+        auto scan_block = [&](size_t block)
+        {
+            const size_t begin = count * block / block_count;
+            const size_t end = count * (block + 1) / block_count;
+            double sum = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                sum += values[i];
+                sums[i] = sum;
+            }
+            block_sums[block] = sum;
+        };
+        auto offset_block = [&](size_t block)
+        {
+            const size_t begin = count * block / block_count;
+            const size_t end = count * (block + 1) / block_count;
+            const double offset = block_sums[block - 1];
+            for (size_t i = begin; i < end; ++i) sums[i] += offset;
+        };
+
+        run_parallel(block_count, scan_block, 0);
+        for (size_t i = 1; i < block_count; ++i)
+        {
+            block_sums[i] += block_sums[i - 1];
+        }
+        run_parallel(block_count, offset_block, 1);
+    }
+
+private:
+    template <typename Uniform>
+    void multinomial(const std::vector<double>& cumulative,
+                     Uniform& uniform,
+                     std::vector<int>& ancestors) const
+    {
+        const double total = cumulative.back();
+        for (size_t i = 0; i < ancestors.size(); ++i)
+        {
+            const size_t index = std::upper_bound(cumulative.begin(),
+                                                  cumulative.end(),
+                                                  uniform() * total) -
+                                 cumulative.begin();
+            ancestors[i] = int(std::min(index, cumulative.size() - 1));
+        }
+    }
+
+    /**
+     * \brief Maps the ascending points point(i) * total / M, i = 0..M-1, to
+     *        their ancestors in a single pass
+     *
+     * \param point  Returns the i-th point in units of one stratum, i.e. a
+     *               value in [i, i + 1)
+     */
+    template <typename Point>
+    void merge(const std::vector<double>& cumulative,
+               Point point,
+               std::vector<int>& ancestors) const
+    {
+        const double stratum = cumulative.back() / double(ancestors.size());
+        const size_t last = cumulative.size() - 1;
+
+        size_t index = 0;
+        for (size_t i = 0; i < ancestors.size(); ++i)
+        {
+            const double u = point(i) * stratum;
+            while (index < last && cumulative[index] <= u) ++index;
+            ancestors[i] = int(index);
+        }
+    }
+
+    template <typename Uniform>
+    void residual(const double* weights,
+                  size_t weight_count,
+                  Uniform& uniform,
+                  std::vector<int>& ancestors)
+    {
+        const size_t sample_count = ancestors.size();
+
+        double total = 0;
+        for (size_t i = 0; i < weight_count; ++i) total += weights[i];
+        const double scale = double(sample_count) / total;
+
+        // the fractional parts of the expected copies are the residual weights
+        residuals_.resize(weight_count);
+        size_t copies = 0;
+        for (size_t i = 0; i < weight_count; ++i)
+        {
+            const double expected = weights[i] * scale;
+            residuals_[i] = expected - std::floor(expected);
+            copies += size_t(std::floor(expected));
+        }
+        const size_t remainder = sample_count - std::min(copies, sample_count);
+
+        prefix_sum(residuals_.data(), weight_count, cumulative_);
+        const double stratum = cumulative_.back() / double(remainder);
+        const double offset = uniform();
+
+        // emit the deterministic copies of each particle followed by the
+        // systematically drawn remainder which falls into its interval
+        size_t count = 0;
+        size_t j = 0;
+        for (size_t i = 0; i < weight_count && count < sample_count; ++i)
+        {
+            size_t n = size_t(std::floor(weights[i] * scale));
+            while (j < remainder &&
+                   ((j + offset) * stratum < cumulative_[i] ||
+                    i == weight_count - 1))
+            {
+                ++n;
+                ++j;
+            }
+
+            n = std::min(n, sample_count - count);
+            std::fill(ancestors.begin() + count,
+                      ancestors.begin() + count + n,
+                      int(i));
+            count += n;
+        }
+
+        // guard against rounding in the copy counts
+        std::fill(
+            ancestors.begin() + count, ancestors.end(), int(weight_count) - 1);
+    }
+
+    template <typename Function>
+    void run_parallel(size_t block_count, Function& function, size_t first)
+        const
+    {
+        if (worker_pool_)
+        {
+            worker_pool_->parallel_for(
+                int(block_count - first),
+                [&function, first](int i) { function(first + i); });
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(block_count - first);
+        for (size_t block = first + 1; block < block_count; ++block)
+        {
+            threads.emplace_back([&function, block]() { function(block); });
+        }
+        if (first < block_count) function(first);
+        for (auto& thread : threads) thread.join();
+    }
+
+    /**
+     * Particle sets below this size are scanned sequentially since spawning
+     * threads costs more than the scan itself
+     */
+    static constexpr size_t parallel_threshold = 1 << 16;
+    static constexpr size_t block_size_min = 1 << 14;
+
+    ResamplingScheme scheme_;
+    int thread_count_;
+    std::shared_ptr<WorkerPool> worker_pool_;
+
+    std::vector<double> cumulative_;
+    std::vector<double> residuals_;
+};
+}
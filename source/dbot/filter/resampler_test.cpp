@@ -0,0 +1,111 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file resampler_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <dbot/filter/resampler.h>
+
+namespace
+{
+std::vector<int> count_ancestors(const std::vector<int>& ancestors,
+                                 size_t particle_count)
+{
+    std::vector<int> counts(particle_count, 0);
+    for (size_t i = 0; i < ancestors.size(); ++i) counts[ancestors[i]]++;
+    return counts;
+}
+}
+
+TEST(ResamplerTests, low_variance_schemes_match_expected_counts)
+{
+    const std::vector<double> weights = {0.5, 2.0, 0.0, 1.25, 0.25};
+    const size_t sample_count = 40;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(0., 1.);
+    auto uniform = [&]() { return distribution(generator); };
+
+    for (auto scheme : {dbot::SYSTEMATIC_RESAMPLING,
+                        dbot::STRATIFIED_RESAMPLING,
+                        dbot::RESIDUAL_RESAMPLING})
+    {
+        dbot::Resampler resampler(scheme);
+        std::vector<int> ancestors;
+        resampler.resample(
+            weights.data(), weights.size(), sample_count, uniform, ancestors);
+
+        ASSERT_EQ(ancestors.size(), sample_count);
+        for (size_t i = 1; i < ancestors.size(); ++i)
+        {
+            EXPECT_LE(ancestors[i - 1], ancestors[i]);
+        }
+
+        // the total weight is 4, so each particle is expected 10 w_i times
+        auto counts = count_ancestors(ancestors, weights.size());
+        EXPECT_EQ(counts[2], 0);
+        if (scheme != dbot::STRATIFIED_RESAMPLING)
+        {
+            for (size_t i = 0; i < weights.size(); ++i)
+            {
+                EXPECT_LE(std::abs(counts[i] - 10. * weights[i]), 1.);
+            }
+        }
+    }
+}
+
+TEST(ResamplerTests, multinomial_never_draws_zero_weights)
+{
+    const std::vector<double> weights = {0.0, 1.0, 0.0, 3.0};
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> distribution(0., 1.);
+    auto uniform = [&]() { return distribution(generator); };
+
+    dbot::Resampler resampler(dbot::MULTINOMIAL_RESAMPLING);
+    std::vector<int> ancestors;
+    resampler.resample(
+        weights.data(), weights.size(), 1000, uniform, ancestors);
+
+    auto counts = count_ancestors(ancestors, weights.size());
+    EXPECT_EQ(counts[0], 0);
+    EXPECT_EQ(counts[2], 0);
+    EXPECT_GT(counts[3], counts[1]);
+}
+
+TEST(ResamplerTests, parallel_prefix_sum_matches_sequential)
+{
+    std::vector<double> values(200000);
+    for (size_t i = 0; i < values.size(); ++i) values[i] = double(i % 7);
+
+    std::vector<double> sequential;
+    std::vector<double> parallel;
+    dbot::Resampler(dbot::SYSTEMATIC_RESAMPLING, 1)
+        .prefix_sum(values.data(), values.size(), sequential);
+    dbot::Resampler(dbot::SYSTEMATIC_RESAMPLING, 4)
+        .prefix_sum(values.data(), values.size(), parallel);
+
+    ASSERT_EQ(sequential.size(), parallel.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(sequential[i], parallel[i]);
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sampling_schedule.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Order in which the sampling blocks are sampled and evaluated
+ *
+ * The uncertainty of a block is the summed variance of its state coordinates
+ * in the belief, see sampling_block_states(). Blocks whose uncertainty is
+ * below collapsed_variance are skipped, i.e. sampled without noise, which
+ * saves their sensor evaluation. The most uncertain block is evaluated in
+ * any case. A skipped block receives no noise, so its uncertainty cannot
+ * rise by itself. It is therefore sampled again after revisit_interval
+ * skipped steps, which spreads its particles such that the likelihood can
+ * pick up a part which started moving. A revisited block whose uncertainty
+ * stays above collapsed_variance is sampled in every step until it
+ * collapses again. A revisit_interval of 0 skips a collapsed block until
+ * the particles are set anew, which only suits static fixtures.
+ */
+struct SamplingScheduleParameters
+{
+    /// sample the most uncertain block first, otherwise in the given order
+    bool order_by_uncertainty = false;
+    /// uncertainty below which a block is skipped, 0 samples all of them
+    double collapsed_variance = 0;
+    /// skipped steps after which a collapsed block is sampled again
+    int revisit_interval = 10;
+};
+
+/**
+ * \brief Selects the sampling blocks of one filter step and their order
+ *
+ * \param variances      uncertainty of each block
+ * \param skipped_steps  consecutive steps each block has been skipped,
+ *                       updated for this step, resized and zeroed if it
+ *                       does not match the block count
+ * \param order          indices of the blocks to sample in this step
+ */
+template <typename Variances>
+void schedule_sampling_blocks(const Variances& variances,
+                              const SamplingScheduleParameters& params,
+                              std::vector<int>& skipped_steps,
+                              std::vector<int>& order)
+{
+    const size_t block_count = variances.size();
+    order.resize(block_count);
+    for (size_t i = 0; i < block_count; i++) order[i] = i;
+    if (skipped_steps.size() != block_count)
+    {
+        skipped_steps.assign(block_count, 0);
+    }
+    if (block_count == 0) return;
+
+    if (params.order_by_uncertainty)
+    {
+        std::stable_sort(order.begin(),
+                         order.end(),
+                         [&variances](int a, int b)
+                         {
+                             return variances[a] > variances[b];
+                         });
+    }
+
+    if (!(params.collapsed_variance > 0)) return;
+
+    int most_uncertain = 0;
+    for (size_t i = 1; i < block_count; i++)
+    {
+        if (variances[i] > variances[most_uncertain]) most_uncertain = i;
+    }
+
+    for (size_t i_block = 0; i_block < block_count; i_block++)
+    {
+        const bool skipped =
+            int(i_block) != most_uncertain &&
+            variances[i_block] < params.collapsed_variance &&
+            (params.revisit_interval <= 0 ||
+             skipped_steps[i_block] < params.revisit_interval);
+        skipped_steps[i_block] = skipped ? skipped_steps[i_block] + 1 : 0;
+    }
+    order.erase(std::remove_if(order.begin(),
+                               order.end(),
+                               [&skipped_steps](int i_block)
+                               {
+                                   return skipped_steps[i_block] > 0;
+                               }),
+                order.end());
+}
+}
@@ -0,0 +1,124 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sampling_schedule_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/filter/sampling_schedule.h>
+
+TEST(SamplingScheduleTests, samples_all_blocks_by_default)
+{
+    const std::vector<double> variances = {0.5, 0., 2.};
+    std::vector<int> skipped_steps;
+    std::vector<int> order;
+
+    dbot::schedule_sampling_blocks(
+        variances, dbot::SamplingScheduleParameters(), skipped_steps, order);
+    EXPECT_EQ((std::vector<int>{0, 1, 2}), order);
+}
+
+TEST(SamplingScheduleTests, orders_by_uncertainty)
+{
+    const std::vector<double> variances = {0.5, 0., 2.};
+    std::vector<int> skipped_steps;
+    std::vector<int> order;
+
+    dbot::SamplingScheduleParameters params;
+    params.order_by_uncertainty = true;
+    dbot::schedule_sampling_blocks(variances, params, skipped_steps, order);
+    EXPECT_EQ((std::vector<int>{2, 0, 1}), order);
+}
+
+TEST(SamplingScheduleTests, skips_collapsed_blocks_but_the_most_uncertain)
+{
+    const std::vector<double> variances = {1e-4, 1e-5, 1e-6};
+    std::vector<int> skipped_steps;
+    std::vector<int> order;
+
+    dbot::SamplingScheduleParameters params;
+    params.collapsed_variance = 1e-3;
+    dbot::schedule_sampling_blocks(variances, params, skipped_steps, order);
+    EXPECT_EQ((std::vector<int>{0}), order);
+    EXPECT_EQ((std::vector<int>{0, 1, 1}), skipped_steps);
+}
+
+TEST(SamplingScheduleTests, revisits_a_collapsed_block_which_starts_moving)
+{
+    std::vector<double> variances = {1., 1e-6};
+    std::vector<int> skipped_steps;
+    std::vector<int> order;
+
+    dbot::SamplingScheduleParameters params;
+    params.collapsed_variance = 1e-3;
+    params.revisit_interval = 3;
+
+    // the collapsed block is skipped for revisit_interval steps
+    for (int step = 0; step < 3; step++)
+    {
+        dbot::schedule_sampling_blocks(
+            variances, params, skipped_steps, order);
+        EXPECT_EQ((std::vector<int>{0}), order);
+    }
+
+    // and sampled again in the next one
+    dbot::schedule_sampling_blocks(variances, params, skipped_steps, order);
+    EXPECT_EQ((std::vector<int>{0, 1}), order);
+
+    // the part moved, the noise of the revisit spread its particles, such
+    // that the block stays scheduled while it is uncertain
+    variances[1] = 0.1;
+    for (int step = 0; step < 5; step++)
+    {
+        dbot::schedule_sampling_blocks(
+            variances, params, skipped_steps, order);
+        EXPECT_EQ((std::vector<int>{0, 1}), order);
+    }
+
+    // until it collapses again
+    variances[1] = 1e-6;
+    dbot::schedule_sampling_blocks(variances, params, skipped_steps, order);
+    EXPECT_EQ((std::vector<int>{0}), order);
+}
+
+TEST(SamplingScheduleTests, zero_revisit_interval_skips_collapsed_blocks)
+{
+    const std::vector<double> variances = {1., 1e-6};
+    std::vector<int> skipped_steps;
+    std::vector<int> order;
+
+    dbot::SamplingScheduleParameters params;
+    params.collapsed_variance = 1e-3;
+    params.revisit_interval = 0;
+    for (int step = 0; step < 100; step++)
+    {
+        dbot::schedule_sampling_blocks(
+            variances, params, skipped_steps, order);
+        EXPECT_EQ((std::vector<int>{0}), order);
+    }
+}
+
+TEST(SamplingScheduleTests, restarts_the_counts_on_a_new_block_count)
+{
+    std::vector<int> skipped_steps = {7};
+    std::vector<int> order;
+
+    dbot::SamplingScheduleParameters params;
+    params.collapsed_variance = 1e-3;
+    dbot::schedule_sampling_blocks(
+        std::vector<double>{1., 1e-6, 1e-6}, params, skipped_steps, order);
+    EXPECT_EQ((std::vector<int>{0, 1, 1}), skipped_steps);
+}
@@ -0,0 +1,155 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_change_detector.cpp
+ * \date October 2026
+ */
+
+#include <dbot/frame_change_detector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dbot
+{
+namespace
+{
+inline bool is_valid(float depth)
+{
+    return depth > 0.f && depth <= std::numeric_limits<float>::max();
+}
+}
+
+FrameChangeDetector::FrameChangeDetector(
+    const Eigen::Matrix3d& camera_matrix,
+    int rows,
+    int cols,
+    const std::vector<Eigen::AlignedBox3d>& part_boxes,
+    const FrameSkippingParameters& params)
+    : camera_matrix_(camera_matrix),
+      rows_(rows),
+      cols_(cols),
+      part_boxes_(part_boxes),
+      params_(params),
+      image_(rows, cols, rows, cols, 0)
+{
+    params_.margin = std::max(params_.margin, 0);
+}
+
+bool FrameChangeDetector::skip(const DepthFrame& frame, const Poses& poses)
+{
+    if (!params_.enabled || !reference_ ||
+        consecutive_skips_ >= params_.max_consecutive_skips ||
+        reference_->rows() != frame.rows() ||
+        reference_->cols() != frame.cols())
+    {
+        return false;
+    }
+
+    const PixelRegion pixels = region(frame, poses);
+    if (pixels.empty()) return false;
+
+    double mean_change;
+    double invalid_fraction;
+    if (!compare(frame, *reference_, pixels, mean_change, invalid_fraction) ||
+        mean_change >= params_.max_mean_change ||
+        invalid_fraction > params_.max_invalid_fraction)
+    {
+        return false;
+    }
+
+    consecutive_skips_++;
+    skip_count_++;
+    return true;
+}
+
+void FrameChangeDetector::processed(const DepthFrame::ConstPtr& frame)
+{
+    reference_ = frame;
+    consecutive_skips_ = 0;
+}
+
+void FrameChangeDetector::reset()
+{
+    reference_.reset();
+    consecutive_skips_ = 0;
+}
+
+bool FrameChangeDetector::compare(const DepthFrame& frame,
+                                  const DepthFrame& reference,
+                                  const PixelRegion& region,
+                                  double& mean_change,
+                                  double& invalid_fraction)
+{
+    double change = 0;
+    int valid_count = 0;
+    int invalid_count = 0;
+    for (int row = region.row; row < region.row + region.rows; row++)
+    {
+        const float* depth = frame.data() + row * frame.cols();
+        const float* reference_depth = reference.data() + row * frame.cols();
+        for (int col = region.col; col < region.col + region.cols; col++)
+        {
+            const bool valid = is_valid(depth[col]);
+            if (valid != is_valid(reference_depth[col]))
+            {
+                invalid_count++;
+            }
+            else if (valid)
+            {
+                change += std::fabs(depth[col] - reference_depth[col]);
+                valid_count++;
+            }
+        }
+    }
+
+    const int pixel_count = region.rows * region.cols;
+    mean_change = valid_count > 0 ? change / valid_count : 0;
+    invalid_fraction =
+        pixel_count > 0 ? double(invalid_count) / pixel_count : 0;
+    return valid_count > 0;
+}
+
+PixelRegion FrameChangeDetector::region(const DepthFrame& frame,
+                                        const Poses& poses) const
+{
+    const int scale = frame.cols() / cols_;
+    if (scale < 1 || frame.cols() != scale * cols_ ||
+        frame.rows() != scale * rows_)
+    {
+        return PixelRegion();
+    }
+
+    const PixelRegion footprint =
+        image_.footprint(part_boxes_, poses, camera_matrix_);
+    if (footprint.empty()) return footprint;
+
+    PixelRegion region;
+    region.row = std::max(footprint.row - params_.margin, 0);
+    region.col = std::max(footprint.col - params_.margin, 0);
+    region.rows =
+        std::min(footprint.row + footprint.rows + params_.margin, rows_) -
+        region.row;
+    region.cols =
+        std::min(footprint.col + footprint.cols + params_.margin, cols_) -
+        region.col;
+
+    region.row *= scale;
+    region.col *= scale;
+    region.rows *= scale;
+    region.cols *= scale;
+    return region;
+}
+}
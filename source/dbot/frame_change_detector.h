@@ -0,0 +1,135 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_change_detector.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/depth_frame.h>
+#include <dbot/region_of_interest.h>
+
+namespace dbot
+{
+/**
+ * \brief Parameters of FrameChangeDetector
+ */
+struct FrameSkippingParameters
+{
+    bool enabled = false;
+    /// mean absolute depth change in meters below which a frame is skipped
+    double max_mean_change = 0.002;
+    /// fraction of the pixels which may gain or lose their depth
+    double max_invalid_fraction = 0.05;
+    /// frames skipped in a row before one is processed again, 0 never skips
+    int max_consecutive_skips = 5;
+    /// pixels around the footprint of the object, at the sensor resolution
+    int margin = 8;
+};
+
+/**
+ * \brief Detects depth frames in which nothing moved around the object
+ *
+ * A frame is compared to the last processed frame within the footprint of
+ * the object at the given poses plus the margin. It is unchanged if the
+ * mean absolute depth difference of the pixels with a depth in both frames
+ * is below max_mean_change, and if few pixels gained or lost their depth.
+ * The comparison reads both frames in place and costs a pass over the
+ * footprint, a fraction of rendering and weighting a single particle.
+ *
+ * The reference is only replaced by processed frames, such that a slow
+ * drift adds up until a frame is processed. After max_consecutive_skips
+ * skipped frames one is processed in any case, which bounds the staleness
+ * of the estimate.
+ */
+class FrameChangeDetector
+{
+public:
+    typedef RegionOfInterest::Poses Poses;
+
+public:
+    /**
+     * \param camera_matrix  of the sensor images
+     * \param rows, cols     resolution of the sensor images. Frames at an
+     *                       integer multiple of it are compared at their own
+     *                       resolution.
+     * \param part_boxes     see RegionOfInterest::part_boxes()
+     */
+    FrameChangeDetector(const Eigen::Matrix3d& camera_matrix,
+                        int rows,
+                        int cols,
+                        const std::vector<Eigen::AlignedBox3d>& part_boxes,
+                        const FrameSkippingParameters& params);
+
+    /**
+     * \brief Whether the frame may be skipped, which counts the skip
+     *
+     * Frames are processed if skipping is disabled, no frame was processed
+     * yet, the resolution changed, the object is outside of the image or
+     * too many frames were skipped in a row.
+     */
+    bool skip(const DepthFrame& frame, const Poses& poses);
+
+    /**
+     * \brief Keeps a reference to the processed frame to compare the
+     *        following ones to
+     */
+    void processed(const DepthFrame::ConstPtr& frame);
+
+    /**
+     * \brief Drops the reference, the next frame is processed
+     */
+    void reset();
+
+    /**
+     * \brief Mean absolute depth difference of the frames within the
+     *        region and the fraction of its pixels which have a depth in
+     *        only one of them. The region is at the resolution of the frames.
+     *
+     * \return false if no pixel has a depth in both frames
+     */
+    static bool compare(const DepthFrame& frame,
+                        const DepthFrame& reference,
+                        const PixelRegion& region,
+                        double& mean_change,
+                        double& invalid_fraction);
+
+    const FrameSkippingParameters& parameters() const { return params_; }
+    int consecutive_skips() const { return consecutive_skips_; }
+    uint64_t skip_count() const { return skip_count_; }
+
+private:
+    /**
+     * \brief Footprint of the object plus the margin at the resolution of
+     *        the frame, empty if the object is outside of the image
+     */
+    PixelRegion region(const DepthFrame& frame, const Poses& poses) const;
+
+    Eigen::Matrix3d camera_matrix_;
+    int rows_;
+    int cols_;
+    std::vector<Eigen::AlignedBox3d> part_boxes_;
+    FrameSkippingParameters params_;
+    RegionOfInterest image_;
+    DepthFrame::ConstPtr reference_;
+    int consecutive_skips_ = 0;
+    uint64_t skip_count_ = 0;
+};
+}
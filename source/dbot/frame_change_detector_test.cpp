@@ -0,0 +1,163 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_change_detector_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/frame_change_detector.h>
+
+namespace
+{
+const int rows = 120;
+const int cols = 160;
+
+/// a box whose footprint spans rows 55 to 65 and cols 70 to 90
+dbot::FrameChangeDetector make_detector(
+    const dbot::FrameSkippingParameters& params)
+{
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << 100, 0, 80, 0, 100, 60, 0, 0, 1;
+
+    std::vector<Eigen::AlignedBox3d> boxes(1);
+    boxes[0].extend(Eigen::Vector3d(-0.1, -0.05, -0.1));
+    boxes[0].extend(Eigen::Vector3d(0.1, 0.05, 0.1));
+
+    return dbot::FrameChangeDetector(camera_matrix, rows, cols, boxes, params);
+}
+
+dbot::FrameChangeDetector::Poses make_poses()
+{
+    dbot::FrameChangeDetector::Poses poses(
+        1, dbot::RegionOfInterest::Affine::Identity());
+    poses[0].translation() = Eigen::Vector3d(0, 0, 1.1);
+    return poses;
+}
+
+dbot::FrameSkippingParameters make_parameters()
+{
+    dbot::FrameSkippingParameters params;
+    params.enabled = true;
+    params.max_mean_change = 0.01;
+    params.max_invalid_fraction = 0.05;
+    params.max_consecutive_skips = 3;
+    params.margin = 2;
+    return params;
+}
+
+std::shared_ptr<dbot::DepthFrame> make_frame(int scale = 1)
+{
+    auto frame =
+        std::make_shared<dbot::DepthFrame>(rows * scale, cols * scale);
+    frame->image().setConstant(1.0f);
+    return frame;
+}
+}
+
+TEST(FrameChangeDetectorTests, skips_unchanged_frames_up_to_the_limit)
+{
+    dbot::FrameChangeDetector detector = make_detector(make_parameters());
+    const auto poses = make_poses();
+    auto frame = make_frame();
+
+    // nothing to compare to
+    EXPECT_FALSE(detector.skip(*frame, poses));
+    detector.processed(frame);
+
+    auto unchanged = make_frame();
+    unchanged->image().array() += 0.005f;
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(detector.skip(*unchanged, poses));
+    }
+    EXPECT_EQ(3, detector.consecutive_skips());
+    EXPECT_FALSE(detector.skip(*unchanged, poses));
+
+    detector.processed(unchanged);
+    EXPECT_EQ(0, detector.consecutive_skips());
+    EXPECT_TRUE(detector.skip(*unchanged, poses));
+    EXPECT_EQ(4u, detector.skip_count());
+
+    detector.reset();
+    EXPECT_FALSE(detector.skip(*unchanged, poses));
+}
+
+TEST(FrameChangeDetectorTests, only_compares_around_the_object)
+{
+    dbot::FrameChangeDetector detector = make_detector(make_parameters());
+    const auto poses = make_poses();
+    detector.processed(make_frame());
+
+    // beyond the margin of the footprint
+    auto outside = make_frame();
+    outside->image().block(0, 0, 50, cols).setConstant(2.0f);
+    outside->image().col(93).setConstant(2.0f);
+    EXPECT_TRUE(detector.skip(*outside, poses));
+
+    auto inside = make_frame();
+    inside->image().block(54, 68, 13, 25).setConstant(1.05f);
+    EXPECT_FALSE(detector.skip(*inside, poses));
+
+    // the object left the image
+    auto left_poses = poses;
+    left_poses[0].translation() = Eigen::Vector3d(0, 0, 0.05);
+    EXPECT_FALSE(detector.skip(*make_frame(), left_poses));
+}
+
+TEST(FrameChangeDetectorTests, counts_pixels_which_lost_their_depth)
+{
+    dbot::FrameChangeDetector detector = make_detector(make_parameters());
+    const auto poses = make_poses();
+    detector.processed(make_frame());
+
+    // 15 x 25 pixels are compared, 18.75 are 5 percent
+    auto few_lost = make_frame();
+    few_lost->image().block(60, 70, 1, 18).setZero();
+    EXPECT_TRUE(detector.skip(*few_lost, poses));
+
+    auto many_lost = make_frame();
+    many_lost->image().block(60, 70, 1, 20).setZero();
+    EXPECT_FALSE(detector.skip(*many_lost, poses));
+}
+
+TEST(FrameChangeDetectorTests, compares_frames_at_a_multiple_resolution)
+{
+    dbot::FrameChangeDetector detector = make_detector(make_parameters());
+    const auto poses = make_poses();
+    detector.processed(make_frame(2));
+
+    auto outside = make_frame(2);
+    outside->image().col(2 * 93).setConstant(2.0f);
+    EXPECT_TRUE(detector.skip(*outside, poses));
+
+    auto inside = make_frame(2);
+    inside->image().col(2 * 92).setConstant(2.0f);
+    EXPECT_FALSE(detector.skip(*inside, poses));
+
+    // the reference has another resolution
+    EXPECT_FALSE(detector.skip(*make_frame(), poses));
+}
+
+TEST(FrameChangeDetectorTests, never_skips_if_disabled)
+{
+    dbot::FrameSkippingParameters params = make_parameters();
+    params.enabled = false;
+    dbot::FrameChangeDetector detector = make_detector(params);
+    auto frame = make_frame();
+
+    detector.processed(frame);
+    EXPECT_FALSE(detector.skip(*frame, make_poses()));
+}
@@ -0,0 +1,453 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batched_kinect_image_model_gpu.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <dbot/depth_frame.h>
+#include <dbot/gpu/kinect_image_model_gpu.h>
+#include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/model/sensor_batch.h>
+#include <dbot/worker_thread.h>
+
+namespace dbot
+{
+/**
+ * \brief Evaluates the particles of several trackers with one
+ *        KinectImageModelGPU, i.e. one GL context, one set of CUDA buffers
+ *        and one upload of each depth frame
+ *
+ * The mesh of the model holds the parts of all trackers one after the
+ * other. Each tracker evaluates through its own slot(), whose
+ * integrated_poses() are the default poses of its parts. The particles of
+ * the trackers are packed into one loglikes() call of the model, in which
+ * every part is only rendered in the states of its own tracker.
+ *
+ * Within run(), the filter steps of the trackers run on worker threads and
+ * block in loglikes() until all trackers still running have requested an
+ * evaluation. The requests are then served together on the thread which
+ * called run(), which has to be the thread the model was created on. The
+ * occlusion images of all trackers live in the one model, hence the trackers
+ * have to update their occlusions together, i.e. they need the same number
+ * of sampling blocks.
+ *
+ * Outside of run(), the slots can be evaluated one after the other on the
+ * thread of the model, but only a batch with a single slot may update its
+ * occlusions there.
+ */
+template <typename State>
+class BatchedKinectImageModelGPU : public SensorBatch
+{
+public:
+    typedef KinectImageModelGPU<State> Model;
+    typedef RbSensor<State> Sensor;
+    typedef typename Sensor::Observation Observation;
+    typedef typename Sensor::StateArray StateArray;
+    typedef typename Sensor::RealArray RealArray;
+    typedef typename Sensor::IntArray IntArray;
+
+    /**
+     * \brief Sensor of one tracker of the batch
+     */
+    class Slot : public Sensor
+    {
+    public:
+        Slot(BatchedKinectImageModelGPU* batch,
+             int index,
+             int part_count,
+             const fl::Real& delta_time)
+            : Sensor(delta_time), batch_(batch), index_(index)
+        {
+            this->default_poses_.recount(part_count);
+            this->default_poses_.setZero();
+        }
+
+        RealArray loglikes(const StateArray& deltas,
+                           IntArray& indices,
+                           const bool& update = false)
+        {
+            return batch_->evaluate(index_, deltas, indices, update);
+        }
+
+        /**
+         * \brief Converts the image to a depth frame, which replaces the one
+         *        of the batch
+         */
+        void set_observation(const Observation& image)
+        {
+            auto frame = std::make_shared<DepthFrame>(image.size(), 1);
+            Eigen::Map<Eigen::VectorXf>(frame->data(), image.size()) =
+                Eigen::Map<const Eigen::Matrix<fl::Real, -1, 1>>(
+                    image.data(), image.size())
+                    .template cast<float>();
+            batch_->set_depth_frame(frame);
+        }
+
+        /**
+         * \brief Sets the frame of the batch, which is uploaded once however
+         *        many trackers pass the same frame
+         */
+        void set_depth_frame(const DepthFrame::ConstPtr& frame)
+        {
+            batch_->set_depth_frame(frame);
+        }
+
+        /**
+         * \brief Resets the occlusion image of this tracker only
+         */
+        void reset() { batch_->reset_slot(index_); }
+        int max_sample_count() const { return batch_->sample_count_; }
+    private:
+        BatchedKinectImageModelGPU* batch_;
+        int index_;
+    };
+
+public:
+    /**
+     * \param model         evaluates the particles of all trackers, the
+     *                      parts of its mesh are those of the trackers in
+     *                      order
+     * \param part_counts   number of parts of each tracker
+     * \param sample_count  maximum number of particles of each tracker
+     */
+    BatchedKinectImageModelGPU(const std::shared_ptr<Model>& model,
+                               const std::vector<int>& part_counts,
+                               int sample_count,
+                               const fl::Real& delta_time)
+        : model_(model),
+          sample_count_(sample_count),
+          nr_requests_(0),
+          nr_active_jobs_(0),
+          running_(false)
+    {
+        int nr_parts = 0;
+        for (size_t i = 0; i < part_counts.size(); i++)
+        {
+            first_parts_.push_back(nr_parts);
+            nr_parts += part_counts[i];
+            slots_.push_back(std::make_shared<Slot>(
+                this, int(i), part_counts[i], delta_time));
+        }
+
+        if (part_counts.empty() ||
+            nr_parts != model_->integrated_poses().count())
+        {
+            std::cout << "ERROR (CUDA): The batched trackers have " << nr_parts
+                      << " parts, the model renders "
+                      << model_->integrated_poses().count() << "."
+                      << std::endl;
+            exit(-1);
+        }
+
+        // the buffers of the model may have been reduced to the GPU memory
+        const int nr_slots = slots_.size();
+        sample_count_ =
+            std::min(sample_count_, model_->max_sample_count() / nr_slots);
+        if (sample_count_ <= 0)
+        {
+            std::cout << "ERROR (CUDA): The model holds "
+                      << model_->max_sample_count() << " poses, which is "
+                      << "too few for " << nr_slots << " trackers."
+                      << std::endl;
+            exit(-1);
+        }
+
+        for (int i = 0; i < nr_slots; i++)
+        {
+            slot_offsets_.push_back(i * sample_count_);
+        }
+        requests_.assign(nr_slots, NULL);
+        pending_resets_.assign(nr_slots, false);
+    }
+
+    virtual ~BatchedKinectImageModelGPU() noexcept {}
+
+    /**
+     * \brief Sensor of the tracker with the given index, it must not outlive
+     *        the batch
+     */
+    std::shared_ptr<Sensor> slot(int index) const { return slots_[index]; }
+    int slot_count() const { return slots_.size(); }
+
+    void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        // uploaded with the next evaluation on the thread of the model
+        std::lock_guard<std::mutex> lock(mutex_);
+        frame_ = frame;
+    }
+
+    void run(const std::vector<std::function<void()>>& jobs)
+    {
+        while (workers_.size() < jobs.size())
+        {
+            workers_.emplace_back(new WorkerThread());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = true;
+            nr_active_jobs_ = jobs.size();
+        }
+        for (size_t i = 0; i < jobs.size(); i++)
+        {
+            const std::function<void()>& job = jobs[i];
+            workers_[i]->post([this, &job]() {
+                job();
+                std::lock_guard<std::mutex> lock(mutex_);
+                nr_active_jobs_--;
+                condition_.notify_all();
+            });
+        }
+
+        // the jobs which are still running wait in loglikes() once all of
+        // them have requested an evaluation
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            condition_.wait(
+                lock, [this]() { return nr_requests_ == nr_active_jobs_; });
+            if (nr_active_jobs_ == 0) break;
+
+            serve();
+            condition_.notify_all();
+        }
+        running_ = false;
+        lock.unlock();
+
+        for (auto& worker : workers_) worker->wait();
+    }
+
+private:
+    /**
+     * \brief Evaluation requested by the filter of a tracker
+     */
+    struct Request
+    {
+        const StateArray* deltas;
+        IntArray* indices;
+        bool update;
+        RealArray loglikes;
+        bool done;
+    };
+
+    RealArray evaluate(int slot,
+                       const StateArray& deltas,
+                       IntArray& indices,
+                       bool update)
+    {
+        Request request;
+        request.deltas = &deltas;
+        request.indices = &indices;
+        request.update = update;
+        request.done = false;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        requests_[slot] = &request;
+        nr_requests_++;
+
+        if (!running_)
+        {
+            if (update && slots_.size() > 1)
+            {
+                std::cout << "ERROR (CUDA): The occlusions of a batch of "
+                          << "trackers can only be updated within run()."
+                          << std::endl;
+                exit(-1);
+            }
+            serve();
+            return request.loglikes;
+        }
+
+        condition_.notify_all();
+        condition_.wait(lock, [&request]() { return request.done; });
+        return request.loglikes;
+    }
+
+    void reset_slot(int slot)
+    {
+        // applied with the next evaluation on the thread of the model
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_resets_[slot] = true;
+    }
+
+    /**
+     * \brief Serves all pending requests, called with the mutex held
+     */
+    void serve()
+    {
+        if (frame_ && frame_ != uploaded_frame_)
+        {
+            model_->set_depth_frame(frame_);
+            uploaded_frame_ = frame_;
+        }
+
+        // the filter of a reset tracker refers to its first occlusion image
+        for (size_t s = 0; s < slots_.size(); s++)
+        {
+            if (!pending_resets_[s]) continue;
+            model_->reset_slots(slot_offsets_[s], 1);
+            pending_resets_[s] = false;
+        }
+
+        // the evaluations without update read the occlusions before they
+        // are updated
+        evaluate_requests(false);
+        evaluate_requests(true);
+
+        requests_.assign(slots_.size(), NULL);
+        nr_requests_ = 0;
+    }
+
+    /**
+     * \brief Packs the requests with the given update flag into one
+     * evaluation of the model
+     */
+    void evaluate_requests(bool update)
+    {
+        const int nr_slots = slots_.size();
+        const int body_size = State::BODY_SIZE;
+
+        int nr_requests = 0;
+        int nr_states = 0;
+        for (int s = 0; s < nr_slots; s++)
+        {
+            if (!requests_[s] || requests_[s]->update != update) continue;
+            nr_requests++;
+            nr_states += requests_[s]->deltas->size();
+        }
+        if (nr_requests == 0) return;
+
+        // an update moves the occlusion images of all states into the
+        // slots of the evaluated states
+        if (update && nr_requests != nr_slots)
+        {
+            std::cout << "ERROR (CUDA): All trackers of a batch have to "
+                      << "update their occlusions together, only "
+                      << nr_requests << " of " << nr_slots << " did. "
+                      << "They need the same number of sampling blocks."
+                      << std::endl;
+            exit(-1);
+        }
+        if (nr_states > model_->max_sample_count())
+        {
+            std::cout << "ERROR (CUDA): The batched trackers evaluate "
+                      << nr_states << " states, the model holds "
+                      << model_->max_sample_count() << "." << std::endl;
+            exit(-1);
+        }
+
+        // every part is rendered in the states of its own tracker, its
+        // components of all other states are not used
+        typename Sensor::PoseArray& poses = model_->integrated_poses();
+        const int nr_parts = poses.count();
+        states_.resize(nr_states);
+        indices_.resize(nr_states);
+        pose_ranges_.assign(nr_parts, std::make_pair(0, 0));
+
+        int first_state = 0;
+        for (int s = 0; s < nr_slots; s++)
+        {
+            const Request* request = requests_[s];
+            if (!request || request->update != update) continue;
+
+            const int nr_slot_states = request->deltas->size();
+            const int first_part = first_parts_[s];
+            const auto& slot_poses = slots_[s]->integrated_poses();
+            const int nr_slot_parts = slot_poses.count();
+
+            poses.segment(body_size * first_part, body_size * nr_slot_parts) =
+                slot_poses;
+            for (int i = 0; i < nr_slot_states; i++)
+            {
+                State& state = states_(first_state + i);
+                if (state.count() != nr_parts)
+                {
+                    state.recount(nr_parts);
+                    state.setZero();
+                }
+                state.segment(body_size * first_part,
+                              body_size * nr_slot_parts) =
+                    (*request->deltas)(i);
+                indices_(first_state + i) =
+                    slot_offsets_[s] + (*request->indices)(i);
+            }
+            for (int k = 0; k < nr_slot_parts; k++)
+            {
+                pose_ranges_[first_part + k] =
+                    std::make_pair(first_state, first_state + nr_slot_states);
+            }
+            first_state += nr_slot_states;
+        }
+
+        model_->set_pose_ranges(pose_ranges_);
+        const RealArray loglikes = model_->loglikes(states_, indices_, update);
+
+        first_state = 0;
+        for (int s = 0; s < nr_slots; s++)
+        {
+            Request* request = requests_[s];
+            if (!request || request->update != update) continue;
+
+            const int nr_slot_states = request->deltas->size();
+            request->loglikes = loglikes.segment(first_state, nr_slot_states);
+            if (update)
+            {
+                for (int i = 0; i < nr_slot_states; i++)
+                {
+                    (*request->indices)(i) = i;
+                }
+                slot_offsets_[s] = first_state;
+            }
+            request->done = true;
+            first_state += nr_slot_states;
+        }
+    }
+
+    std::shared_ptr<Model> model_;
+    std::vector<std::shared_ptr<Slot>> slots_;
+    // first part of each tracker in the mesh of the model
+    std::vector<int> first_parts_;
+    int sample_count_;
+    // first occlusion slot of the particles of each tracker
+    std::vector<int> slot_offsets_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<Request*> requests_;
+    int nr_requests_;
+    int nr_active_jobs_;
+    bool running_;
+    std::vector<bool> pending_resets_;
+    DepthFrame::ConstPtr frame_;
+    DepthFrame::ConstPtr uploaded_frame_;
+
+    // reused input of the model
+    StateArray states_;
+    IntArray indices_;
+    std::vector<std::pair<int, int>> pose_ranges_;
+
+    std::vector<std::unique_ptr<WorkerThread>> workers_;
+};
+}
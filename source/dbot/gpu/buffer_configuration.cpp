@@ -34,11 +34,22 @@ BufferConfiguration::BufferConfiguration(
       evaluator_(evaluator),
       max_nr_poses_(max_nr_poses),
       nr_cols_(nr_cols),
-      nr_rows_(nr_rows)
+      nr_rows_(nr_rows),
+      preferred_nr_poses_per_row_(0)
 {
     max_texture_size_opengl_ = rasterizer_->get_max_texture_size();
     cuda_device_properties_ = evaluator_->get_device_properties();
     adapt_to_constraints_ = false;
+
+    max_nr_layers_ = 1;
+    evaluator_->set_layered_textures(rasterizer_->uses_layered_rendering());
+    if (rasterizer_->uses_layered_rendering())
+    {
+        max_nr_layers_ =
+            std::min(std::min(rasterizer_->get_max_texture_layers(),
+                              cuda_device_properties_.maxTexture2DLayered[2]),
+                     cuda_device_properties_.maxGridSize[2]);
+    }
 }
 
 bool BufferConfiguration::allocate_memory(const int max_nr_poses,
@@ -123,6 +134,47 @@ bool BufferConfiguration::allocate_memory(const int max_nr_poses,
     return true;
 }
 
+bool BufferConfiguration::grow_memory(const int max_nr_poses,
+                                      int& new_max_nr_poses)
+{
+    new_max_nr_poses = max_nr_poses_;
+
+    int max_nr_poses_per_row, max_nr_poses_per_col;
+    compute_grid_layout(
+        max_nr_poses, max_nr_poses_per_row, max_nr_poses_per_col);
+
+    int nr_poses;
+    check_against_texture_size_constraint(
+        max_nr_poses, max_nr_poses_per_row, max_nr_poses_per_col, nr_poses);
+
+    int new_max_nr_poses_per_row, new_max_nr_poses_per_col;
+    int tmp_nr_poses;
+    if (check_against_global_memory_constraint(nr_poses,
+                                               tmp_nr_poses,
+                                               new_max_nr_poses_per_row,
+                                               new_max_nr_poses_per_col))
+    {
+        nr_poses = tmp_nr_poses;
+    }
+    if (nr_poses <= max_nr_poses_) return false;
+    compute_grid_layout(nr_poses, max_nr_poses_per_row, max_nr_poses_per_col);
+
+    // the evaluator checks the free memory, the textures are small in
+    // comparison to the occlusions
+    if (!evaluator_->grow_memory_for_max_poses(
+            nr_poses, max_nr_poses_per_row, max_nr_poses_per_col))
+    {
+        return false;
+    }
+
+    rasterizer_->allocate_textures_for_max_poses(
+        nr_poses, max_nr_poses_per_row, max_nr_poses_per_col);
+
+    max_nr_poses_ = nr_poses;
+    new_max_nr_poses = max_nr_poses_;
+    return true;
+}
+
 bool BufferConfiguration::set_resolution(const int nr_rows,
                                          const int nr_cols,
                                          int& new_max_nr_poses)
@@ -204,6 +256,32 @@ bool BufferConfiguration::set_number_of_threads(const int nr_threads,
     return true;
 }
 
+bool BufferConfiguration::set_nr_poses_per_row(const int nr_poses_per_row,
+                                               int& new_max_nr_poses)
+{
+    preferred_nr_poses_per_row_ = nr_poses_per_row;
+    return allocate_memory(max_nr_poses_, new_max_nr_poses);
+}
+
+int BufferConfiguration::get_max_nr_poses_per_row() const
+{
+    int max_texture_size_x, max_texture_size_y;
+    get_max_texture_size(max_texture_size_x, max_texture_size_y);
+    return max_texture_size_x / nr_cols_;
+}
+
+int BufferConfiguration::get_max_nr_poses_per_col() const
+{
+    int max_texture_size_x, max_texture_size_y;
+    get_max_texture_size(max_texture_size_x, max_texture_size_y);
+    return max_texture_size_y / nr_rows_;
+}
+
+int BufferConfiguration::get_max_nr_layers() const
+{
+    return max_nr_layers_;
+}
+
 void BufferConfiguration::set_adapt_to_constraints(bool should_adapt)
 {
     adapt_to_constraints_ = should_adapt;
@@ -219,25 +297,42 @@ bool BufferConfiguration::check_against_texture_size_constraint(
     const int nr_poses_per_col,
     int& new_nr_poses)
 {
-    new_nr_poses = std::min(nr_poses_per_row * nr_poses_per_col, nr_poses);
+    new_nr_poses = int(std::min<long long>(
+        (long long)nr_poses_per_row * nr_poses_per_col * max_nr_layers_,
+        nr_poses));
 
     return new_nr_poses < nr_poses;
 }
 
+void BufferConfiguration::get_max_texture_size(int& max_texture_size_x,
+                                               int& max_texture_size_y) const
+{
+    // layered textures have their own, usually smaller, limits
+    const int* max_texture_2d =
+        rasterizer_->uses_layered_rendering()
+            ? cuda_device_properties_.maxTexture2DLayered
+            : cuda_device_properties_.maxTexture2D;
+    max_texture_size_x = std::min(
+        std::min(max_texture_size_opengl_, max_texture_2d[0]),
+        cuda_device_properties_.maxGridSize[0]);
+    max_texture_size_y = std::min(
+        std::min(max_texture_size_opengl_, max_texture_2d[1]),
+        cuda_device_properties_.maxGridSize[1]);
+}
+
 void BufferConfiguration::compute_grid_layout(const int nr_poses,
                                               int& nr_poses_per_row,
                                               int& nr_poses_per_col)
 {
-    int max_texture_size_x =
-        std::min(std::min(max_texture_size_opengl_,
-                          cuda_device_properties_.maxTexture2D[0]),
-                 cuda_device_properties_.maxGridSize[0]);
-    int max_texture_size_y =
-        std::min(std::min(max_texture_size_opengl_,
-                          cuda_device_properties_.maxTexture2D[1]),
-                 cuda_device_properties_.maxGridSize[1]);
+    int max_texture_size_x, max_texture_size_y;
+    get_max_texture_size(max_texture_size_x, max_texture_size_y);
 
     nr_poses_per_row = floor(max_texture_size_x / nr_cols_);
+    if (preferred_nr_poses_per_row_ > 0)
+    {
+        nr_poses_per_row =
+            std::min(nr_poses_per_row, preferred_nr_poses_per_row_);
+    }
     nr_poses_per_col = std::min(floor(max_texture_size_y / nr_rows_),
                                 ceil(nr_poses / (float)nr_poses_per_row));
 }
@@ -259,12 +354,13 @@ bool BufferConfiguration::check_against_global_memory_constraint(
     int constant_needs = constant_need_rasterizer + constant_need_evaluator;
     int per_pose_needs = per_pose_need_rasterizer + per_pose_need_evaluator;
 
-    int memory_needs = constant_needs + per_pose_needs * nr_poses;
+    // in 64 bits, the memory of many poses exceeds the range of an int
+    size_t memory_needs = constant_needs + size_t(per_pose_needs) * nr_poses;
 
-    new_nr_poses = std::min(
+    new_nr_poses = int(std::min<size_t>(
         nr_poses,
-        (int)(cuda_device_properties_.totalGlobalMem - constant_needs) /
-            per_pose_needs);
+        (cuda_device_properties_.totalGlobalMem - constant_needs) /
+            per_pose_needs));
 
     compute_grid_layout(
         new_nr_poses, new_nr_poses_per_row, new_nr_poses_per_col);
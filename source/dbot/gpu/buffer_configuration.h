@@ -30,6 +30,10 @@
  * You can enable automatic adaptation to GPU constraints by calling
  * set_adapt_to_constraints(true). This will then automatically downscale
  * the number of poses to fit within the constraints the GPU has.
+ *
+ * If the rasterizer renders into layered textures, the poses which do not
+ * fit into the texture size are placed in further layers, such that their
+ * number is only bounded by the texture layers and the GPU memory.
  */
 class BufferConfiguration
 {
@@ -63,6 +67,19 @@ public:
      * \return whether memory allocation was successful or not
      */
     bool allocate_memory(int max_nr_poses, int& new_max_nr_poses);
+
+    /**
+     * \brief Enlarges the memory allocated by allocate_memory() to a higher
+     * maximum number of poses, keeping the occlusions of the current poses.
+     * Unlike allocate_memory(), the number of poses is always reduced to what
+     * the texture size and the free GPU memory allow.
+     * \param [in] max_nr_poses the desired maximum number of poses
+     * \param [out] new_max_nr_poses the maximum number of poses after the
+     * growth, which remains the current one if the memory could not be
+     * enlarged
+     * \return whether the maximum number of poses was increased
+     */
+    bool grow_memory(int max_nr_poses, int& new_max_nr_poses);
     /**
      * \brief Set the resolution to a new value.
      * \param [in] nr_rows the new vertical resolution
@@ -104,6 +121,26 @@ public:
      */
     bool set_number_of_threads(const int nr_threads, int& new_nr_threads);
 
+    /**
+     * \brief Limits the number of poses per row of the render texture and
+     * reallocates the buffers. Narrower textures may rasterize faster, the
+     * autotuner of KinectImageModelGPU chooses the width per setup.
+     * \param [in] nr_poses_per_row the maximum number of poses per row, 0 for
+     * the widest layout the texture size allows
+     * \param [out] new_max_nr_poses the maximum number of poses that fit into
+     * the new layout, see allocate_memory()
+     * \return whether the reallocation was successful or not
+     */
+    bool set_nr_poses_per_row(const int nr_poses_per_row,
+                              int& new_max_nr_poses);
+
+    /** \brief Most poses per row and per column the texture size allows */
+    int get_max_nr_poses_per_row() const;
+    int get_max_nr_poses_per_col() const;
+    /** \brief Most texture layers the poses may be spread over, 1 if the
+     *  textures are not layered */
+    int get_max_nr_layers() const;
+
     /** \brief Enable automatic adaptation to constraints. This includes GPU
      *  constraints, but also self-made constraints like the maximum number of
      * poses.
@@ -123,6 +160,8 @@ private:
                                                const int nr_poses_per_row,
                                                const int nr_poses_per_col,
                                                int& new_nr_poses);
+    void get_max_texture_size(int& max_texture_size_x,
+                              int& max_texture_size_y) const;
     void compute_grid_layout(const int nr_poses,
                              int& nr_poses_per_row,
                              int& nr_poses_per_col);
@@ -147,6 +186,8 @@ private:
     int nr_cols_;
     int nr_rows_;
     int nr_threads_;
+    int preferred_nr_poses_per_row_;
+    int max_nr_layers_;
 
     bool adapt_to_constraints_;
 
@@ -32,52 +32,33 @@
 #define VECTOR_DIM 3
 #define MATRIX_DIM 9
 
+// the values of dbot::DepthDownsampler::Pooling
+#define MIN_POOLING 0
+#define MEDIAN_POOLING 1
+#define MEAN_POOLING 2
+#define MAX_MEDIAN_FACTOR 8
+
 #include <GL/glut.h>
 #include <fl/util/profiling.hpp>
 #include <dbot/gpu/cuda_likelihood_evaluator.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <iostream>
 
 
 #include <cuda.h>
+#include <cuda_fp16.h>
 #include <cuda_gl_interop.h>
+#include <float.h>
 #include <math.h>
 #include <math_constants.h>
 
 
 using namespace std;
 
-// ====================== CUDA CONSTANT VALUES ======================= //
-
-
-// used in propagateOcclusion
-__constant__ float g_p_occluded_occluded;
-__constant__ float g_one_div_c_minus_one;
-__constant__ float g_log_c;
-
-
-// used in prob
-__constant__ float g_one_minus_tail_weight;
-__constant__ float g_model_sigma;
-__constant__ float g_sigma_factor;
-__constant__ float g_tail_weight_div_max_depth;
-__constant__ float g_exponential_rate;
-__constant__ float g_one_div_sqrt_of_two;
-__constant__ float g_one_div_sqrt_of_two_pi;
-
-
-// used in compare
-__constant__ float g_initial_occlusion_prob;
-
-// texture for OpenGL interop
-texture<float, cudaTextureType2D, cudaReadModeElementType> texture_reference;
-
-
-
-
-
 // ************************************************************************************** //
 // ************************************************************************************** //
 // ================================== CUDA KERNELS ====================================== //
@@ -92,150 +73,621 @@ texture<float, cudaTextureType2D, cudaReadModeElementType> texture_reference;
 // ======================= helper functions for compare (observation model)  ======================= //
 
 
-__device__ float propagate_occlusion(float initial_p_source, float time) {
+__device__ float propagate_occlusion(const CudaModelParameters& params, float initial_p_source, float time) {
     if (isnan(time)) {
         return initial_p_source;
     }
-    float pow_c_time = __expf(time * g_log_c);
-    return 1 - (pow_c_time * (1 - initial_p_source) + (1. - g_p_occluded_occluded) * (pow_c_time - 1.) * g_one_div_c_minus_one);
+    float pow_c_time = __expf(time * params.log_c);
+    return 1 - (pow_c_time * (1 - initial_p_source) + (1. - params.p_occluded_occluded) * (pow_c_time - 1.) * params.one_div_c_minus_one);
 }
 
 
 
-__device__ float prob(float observation, float prediction, bool occluded)
+__device__ float prob(const CudaModelParameters& params, float observation, float prediction, bool occluded)
 {
     // todo: if the prediction is infinite, the prob should not depend on occlusion. it does not matter
     // for the algorithm right now, but it should be changed
 
-    float sigma = g_model_sigma + g_sigma_factor * observation * observation;
+    float sigma = params.model_sigma + params.sigma_factor * observation * observation;
     float sigma_sq = sigma * sigma;
 
     if(!occluded)
     {
         if(isinf(prediction)) // if the prediction is infinite we return the limit
-            return g_tail_weight_div_max_depth;
+            return params.tail_weight_div_max_depth;
         else {
             float pred_minus_obs = prediction - observation;
-            return g_tail_weight_div_max_depth
-                    + __fdividef(g_one_minus_tail_weight * __expf(- __fdividef(pred_minus_obs * pred_minus_obs, (2 * sigma_sq)))
-                    * g_one_div_sqrt_of_two_pi, sigma);
+            return params.tail_weight_div_max_depth
+                    + __fdividef(params.one_minus_tail_weight * __expf(- __fdividef(pred_minus_obs * pred_minus_obs, (2 * sigma_sq)))
+                    * params.one_div_sqrt_of_two_pi, sigma);
         }
     }
     else
     {
         if(isinf(prediction)) // if the prediction is infinite we return the limit
-            return g_tail_weight_div_max_depth +
-                    g_one_minus_tail_weight * g_exponential_rate *
-                    __expf(0.5 * g_exponential_rate * (-2 * observation + g_exponential_rate * sigma_sq));
+            return params.tail_weight_div_max_depth +
+                    params.one_minus_tail_weight * params.exponential_rate *
+                    __expf(0.5 * params.exponential_rate * (-2 * observation + params.exponential_rate * sigma_sq));
 
         else
-            return g_tail_weight_div_max_depth +
-                    g_one_minus_tail_weight * g_exponential_rate *
-                    __expf(0.5 * g_exponential_rate * (2 * (prediction - observation) + g_exponential_rate * sigma_sq))
-                    * __fdividef((1 + erff(__fdividef((prediction - observation + g_exponential_rate * sigma_sq) * g_one_div_sqrt_of_two, sigma))),
-                    (2 * (__expf(prediction * g_exponential_rate) - 1)));
+            return params.tail_weight_div_max_depth +
+                    params.one_minus_tail_weight * params.exponential_rate *
+                    __expf(0.5 * params.exponential_rate * (2 * (prediction - observation) + params.exponential_rate * sigma_sq))
+                    * __fdividef((1 + erff(__fdividef((prediction - observation + params.exponential_rate * sigma_sq) * params.one_div_sqrt_of_two, sigma))),
+                    (2 * (__expf(prediction * params.exponential_rate) - 1)));
     }
 }
 
 
 
 
+// ======================= occlusion storage, converted in registers  ======================= //
+
+
+__device__ float load_occlusion(const float* occlusion) {
+    return *occlusion;
+}
+
+__device__ float load_occlusion(const __half* occlusion) {
+    return __half2float(*occlusion);
+}
+
+__device__ void store_occlusion(float* occlusion, float value) {
+    *occlusion = value;
+}
+
+__device__ void store_occlusion(__half* occlusion, float value) {
+    *occlusion = __float2half(value);
+}
+
+
+
 // ============================================================================================= //
 // ========================= GLOBAL kernels - to be called by CPU code ========================= //
 // ============================================================================================= //
 
 
+template <typename Source, typename Target>
+__global__ void convert_occlusions_kernel(const Source* source, Target* target, int count) {
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < count; i += blockDim.x * gridDim.x) {
+        store_occlusion(target + i, load_occlusion(source + i));
+    }
+}
 
-__global__ void evaluate_kernel(float *observations, float* old_occlusion_probs, float* new_occlusion_probs, int* occlusion_image_indices, int nr_pixels,
-                                 float *d_log_likelihoods, float delta_time, int n_poses, int n_rows, int n_cols, bool update_occlusions) {
-    int block_id = blockIdx.x + blockIdx.y * gridDim.x;
-    if (block_id < n_poses) {
 
-        int pixel_nr = threadIdx.x;
 
-        // OpenGL contructs the texture so that the left lower edge is (0,0), but our observations texture
-        // has its (0,0) in the upper left corner, so we need to reverse the reads from the OpenGL texture.
-        float texture_array_index_x = blockIdx.x * n_cols + pixel_nr % n_cols;
+template <typename Occlusion>
+__global__ void fill_occlusions_kernel(Occlusion* occlusions, float value, size_t count) {
+    for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < count; i += blockDim.x * gridDim.x) {
+        store_occlusion(occlusions + i, value);
+    }
+}
 
-        float texture_array_index_y = gridDim.y * n_rows - 1 - (blockIdx.y * n_rows + __fdividef(pixel_nr, n_cols));
 
-        float depth;
-        float observed_depth;
-        float occlusion_prob = g_initial_occlusion_prob;
-        float local_sum_of_likelihoods = 0;
-        float p_obsIpred_vis, p_obsIpred_occl, p_obsIinf;
 
-        __shared__ float log_likelihoods;
-        __shared__ int occlusion_image_index;
+// copies the occlusion image copy_jobs[2 * i] to the image copy_jobs[2 * i + 1] in block i. If
+// nr_copies is not NULL, the blocks beyond the number of copies it points to return.
+template <typename Occlusion>
+__global__ void copy_occlusions_kernel(Occlusion* occlusion_probs, int* copy_jobs, int nr_pixels,
+                                       const int* nr_copies) {
+    if (nr_copies != NULL && int(blockIdx.x) >= *nr_copies) return;
+
+    Occlusion* source = occlusion_probs + copy_jobs[2 * blockIdx.x] * nr_pixels;
+    Occlusion* target = occlusion_probs + copy_jobs[2 * blockIdx.x + 1] * nr_pixels;
+
+    for (int pixel_nr = threadIdx.x; pixel_nr < nr_pixels; pixel_nr += blockDim.x) {
+        target[pixel_nr] = source[pixel_nr];
+    }
+}
+
+
+
+// shifts the occlusion image of block i by the offset of a moved region of interest: pixel
+// (row, col) takes the value of pixel (row + row_offset, col + col_offset), pixels without one get
+// the initial occlusion probability. Every row is read into shared memory before it is written,
+// in the order in which no row is overwritten before it was read.
+template <typename Occlusion>
+__global__ void shift_occlusions_kernel(Occlusion* occlusion_probs, int nr_rows, int nr_cols,
+                                        int row_offset, int col_offset,
+                                        float initial_occlusion_prob) {
+    extern __shared__ float row_values[];
+    Occlusion* image = occlusion_probs + size_t(blockIdx.x) * nr_rows * nr_cols;
+
+    for (int i = 0; i < nr_rows; i++) {
+        const int row = row_offset >= 0 ? i : nr_rows - 1 - i;
+        const int source_row = row + row_offset;
+        const bool has_source_row = source_row >= 0 && source_row < nr_rows;
+
+        for (int col = threadIdx.x; col < nr_cols; col += blockDim.x) {
+            row_values[col] = has_source_row ? load_occlusion(image + source_row * nr_cols + col)
+                                             : initial_occlusion_prob;
+        }
+        __syncthreads();
+
+        for (int col = threadIdx.x; col < nr_cols; col += blockDim.x) {
+            const int source_col = col + col_offset;
+            const bool has_source = source_col >= 0 && source_col < nr_cols;
+            store_occlusion(image + row * nr_cols + col,
+                            has_source ? row_values[source_col] : initial_occlusion_prob);
+        }
+        __syncthreads();
+    }
+}
+
+
+
+// pose of the block, the blocks of a grid are laid out like the tiles of the texture, with one grid
+// layer per texture layer
+__device__ int tile_of_block() {
+    return blockIdx.x + gridDim.x * (blockIdx.y + gridDim.y * blockIdx.z);
+}
+
+
+
+// rendered depth of a pixel in the tile of the block
+__device__ float read_depth(cudaTextureObject_t depth_texture, bool layered, int row, int col, int n_rows,
+                            int n_cols) {
+    // OpenGL contructs the texture so that the left lower edge is (0,0), but our observations texture
+    // has its (0,0) in the upper left corner, so we need to reverse the reads from the OpenGL texture.
+    float texture_array_index_x = blockIdx.x * n_cols + col;
+    float texture_array_index_y = gridDim.y * n_rows - (blockIdx.y * n_rows + row + 1);
+    if (layered) {
+        return tex2DLayered<float>(depth_texture, texture_array_index_x, texture_array_index_y, blockIdx.z);
+    }
+    return tex2D<float>(depth_texture, texture_array_index_x, texture_array_index_y);
+}
+
+
+
+// copies the depth of every tile of the texture, read like in evaluate_kernel, to the depth
+// layer of its pose, one block per tile
+__global__ void store_depth_layer_kernel(cudaTextureObject_t depth_texture, bool layered, float* layer,
+                                         int n_poses, int n_rows, int n_cols) {
+    int tile_id = tile_of_block();
+    if (tile_id >= n_poses) return;
+
+    float* tile_layer = layer + size_t(tile_id) * n_rows * n_cols;
+    for (int pixel_nr = threadIdx.x; pixel_nr < n_rows * n_cols; pixel_nr += blockDim.x) {
+        int row = pixel_nr / n_cols;
+        int col = pixel_nr % n_cols;
+        tile_layer[pixel_nr] = read_depth(depth_texture, layered, row, col, n_rows, n_cols);
+    }
+}
+
+
+
+// copies the previous layer sources[object * n_poses + pose] of each object to the current layer
+// of the pose in block (pose, object), negative sources are skipped
+__global__ void gather_depth_layers_kernel(const float* previous_layers, float* current_layers,
+                                           const int* sources, int n_poses, int nr_pixels,
+                                           size_t layer_size) {
+    int source = sources[blockIdx.y * n_poses + blockIdx.x];
+    if (source < 0) return;
+
+    const float* from = previous_layers + blockIdx.y * layer_size + size_t(source) * nr_pixels;
+    float* to = current_layers + blockIdx.y * layer_size + size_t(blockIdx.x) * nr_pixels;
+    for (int pixel_nr = threadIdx.x; pixel_nr < nr_pixels; pixel_nr += blockDim.x) {
+        to[pixel_nr] = from[pixel_nr];
+    }
+}
+
+
+
+// downsamples the native depth image by factor with one thread per downsampled pixel. Depths
+// which are NaN, infinite or not positive are ignored and pixels without a valid depth become
+// NaN. pooling is a dbot::DepthDownsampler::Pooling, the median is taken of at most
+// MAX_MEDIAN_FACTOR x MAX_MEDIAN_FACTOR values.
+__global__ void downsample_depth_kernel(const float* native, int native_cols, float* downsampled,
+                                        int n_rows, int n_cols, int factor, int pooling) {
+    const int pixel_nr = blockIdx.x * blockDim.x + threadIdx.x;
+    if (pixel_nr >= n_rows * n_cols) return;
+
+    const float* block = native + (pixel_nr / n_cols) * factor * native_cols + (pixel_nr % n_cols) * factor;
+
+    float values[MAX_MEDIAN_FACTOR * MAX_MEDIAN_FACTOR];
+    float depth_min = CUDART_INF_F;
+    float depth_sum = 0;
+    int count = 0;
+    for (int i = 0; i < factor; i++) {
+        for (int j = 0; j < factor; j++) {
+            const float depth = block[i * native_cols + j];
+            if (depth > 0 && depth <= FLT_MAX) {
+                depth_min = fminf(depth_min, depth);
+                depth_sum += depth;
+                if (pooling == MEDIAN_POOLING && count < MAX_MEDIAN_FACTOR * MAX_MEDIAN_FACTOR) {
+                    values[count] = depth;
+                }
+                count++;
+            }
+        }
+    }
+
+    if (count == 0) {
+        downsampled[pixel_nr] = CUDART_NAN_F;
+    } else if (pooling == MIN_POOLING) {
+        downsampled[pixel_nr] = depth_min;
+    } else if (pooling == MEAN_POOLING) {
+        downsampled[pixel_nr] = depth_sum / count;
+    } else {
+        count = min(count, MAX_MEDIAN_FACTOR * MAX_MEDIAN_FACTOR);
+        for (int i = 1; i < count; i++) {
+            const float value = values[i];
+            int j = i;
+            for (; j > 0 && values[j - 1] > value; j--) values[j] = values[j - 1];
+            values[j] = value;
+        }
+        downsampled[pixel_nr] = values[count / 2];
+    }
+}
+
+
+
+// sums value over all threads of the warp, the result is valid in the first lane
+__device__ float warp_sum(float value) {
+    for (int offset = warpSize / 2; offset > 0; offset /= 2) {
+#if CUDART_VERSION >= 9000
+        value += __shfl_down_sync(0xffffffff, value, offset);
+#else
+        value += __shfl_down(value, offset);
+#endif
+    }
+    return value;
+}
+
+
+
+// compacts the columns of the valid, i.e. not NaN, observations of each row into
+// valid_cols[row * n_cols + i], i < valid_counts[row], in increasing order, such that the
+// evaluation only visits pixels which can be compared. One block per row, the block size has
+// to be a multiple of the warp size.
+__global__ void compact_valid_pixels_kernel(const float* observations, int n_cols, int* valid_cols,
+                                            int* valid_counts) {
+    __shared__ int warp_counts[32];
+    __shared__ int row_count;
+
+    const int row = blockIdx.x;
+    const int lane = threadIdx.x % warpSize;
+    const int warp = threadIdx.x / warpSize;
+    const int nr_warps = blockDim.x / warpSize;
+    const unsigned int lower_lanes = (1u << lane) - 1;
+
+    if (threadIdx.x == 0) row_count = 0;
+    __syncthreads();
+
+    for (int first_col = 0; first_col < n_cols; first_col += blockDim.x) {
+        const int col = first_col + threadIdx.x;
+        const bool valid = col < n_cols && !isnan(observations[row * n_cols + col]);
+#if CUDART_VERSION >= 9000
+        const unsigned int votes = __ballot_sync(0xffffffff, valid);
+#else
+        const unsigned int votes = __ballot(valid);
+#endif
+        if (lane == 0) warp_counts[warp] = __popc(votes);
+        __syncthreads();
+
+        // the valid pixels of the lower warps and lanes come first
+        int index = row_count + __popc(votes & lower_lanes);
+        for (int i = 0; i < warp; i++) index += warp_counts[i];
+        if (valid) valid_cols[row * n_cols + index] = col;
+        __syncthreads();
 
         if (threadIdx.x == 0) {
-            log_likelihoods = 0;
-            occlusion_image_index = occlusion_image_indices[block_id];
+            for (int i = 0; i < nr_warps; i++) row_count += warp_counts[i];
         }
+        __syncthreads();
+    }
+
+    if (threadIdx.x == 0) valid_counts[row] = row_count;
+}
+
+
+
+// index of the first of the count ascending values which is not less than value
+__device__ int first_not_less(const int* values, int count, int value) {
+    int begin = 0;
+    while (count > 0) {
+        int half = count / 2;
+        if (values[begin + half] < value) {
+            begin += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    return begin;
+}
+
 
+
+// ======================= kernels of the resampling on the device  ======================= //
+
+
+// reduces the value of each thread of the block with the sum or the maximum, the result is
+// returned to all threads. The block size may be any number of threads.
+__device__ float reduce_block(float* shared, float value, bool maximum) {
+    shared[threadIdx.x] = value;
+    __syncthreads();
+    for (int stride = 1; stride < blockDim.x; stride *= 2) {
+        if (threadIdx.x % (2 * stride) == 0 && threadIdx.x + stride < blockDim.x) {
+            const float other = shared[threadIdx.x + stride];
+            shared[threadIdx.x] = maximum ? fmaxf(shared[threadIdx.x], other)
+                                          : shared[threadIdx.x] + other;
+        }
         __syncthreads();
+    }
+    const float result = shared[0];
+    __syncthreads();
+    return result;
+}
 
-        float* occlusion_probs = old_occlusion_probs;
-        int occlusion_pixel_index= occlusion_image_index * nr_pixels + pixel_nr;
 
-        if (update_occlusions) {
-            // copy occlusion probabilities from the old particles
-            int index_from_occlusion = occlusion_image_indices[block_id] * nr_pixels;
-            int index_to_occlusion = block_id * nr_pixels;
 
-            while (pixel_nr < nr_pixels) {
-                new_occlusion_probs[index_to_occlusion + pixel_nr] = old_occlusion_probs[index_from_occlusion + pixel_nr];
-                pixel_nr += blockDim.x;
+// adds the log likelihoods of the n poses to their log weights and normalizes them. If the KL
+// divergence of the weights from the uniform distribution exceeds max_kl_divergence, the poses
+// are resampled systematically with the offset uniform in [0, 1) and get uniform weights,
+// otherwise every pose is its own ancestor. The occlusion index of each pose for the next
+// weighting is the one its ancestor was weighted with. Runs in a single block, the block size
+// may be any number of threads, with a float of shared memory per thread.
+__global__ void resample_kernel(float* log_weights, const float* log_likelihoods, float* cdf, int n,
+                                float max_kl_divergence, float uniform, int* ancestors,
+                                const int* occlusion_indices, int* next_occlusion_indices) {
+    extern __shared__ float reduction[];
+
+    float max_weight = -CUDART_INF_F;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+        log_weights[i] += log_likelihoods[i];
+        max_weight = fmaxf(max_weight, log_weights[i]);
+    }
+    max_weight = reduce_block(reduction, max_weight, true);
+
+    float sum = 0;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+        cdf[i] = __expf(log_weights[i] - max_weight);
+        sum += cdf[i];
+    }
+    sum = reduce_block(reduction, sum, false);
+
+    // KL(p || uniform) = log(n) + sum_i p_i log(p_i)
+    const float log_sum = __logf(sum);
+    float negative_entropy = 0;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+        log_weights[i] -= max_weight + log_sum;
+        if (cdf[i] > 0) negative_entropy += cdf[i] / sum * log_weights[i];
+    }
+    negative_entropy = reduce_block(reduction, negative_entropy, false);
+
+    if (__logf(float(n)) + negative_entropy <= max_kl_divergence) {
+        for (int i = threadIdx.x; i < n; i += blockDim.x) {
+            ancestors[i] = i;
+            next_occlusion_indices[i] = occlusion_indices[i];
+        }
+        return;
+    }
+
+    // the cumulative weights, a few thousand poses at most, are summed up by one thread
+    __syncthreads();
+    if (threadIdx.x == 0) {
+        float total = 0;
+        for (int i = 0; i < n; i++) {
+            total += cdf[i];
+            cdf[i] = total;
+        }
+    }
+    __syncthreads();
+
+    const float total = cdf[n - 1];
+    const float log_uniform_weight = -__logf(float(n));
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+        const float position = (i + uniform) / n * total;
+        int begin = 0;
+        int count = n - 1;
+        while (count > 0) {
+            int half = count / 2;
+            if (cdf[begin + half] <= position) {
+                begin += half + 1;
+                count -= half + 1;
+            } else {
+                count = half;
             }
+        }
+        ancestors[i] = begin;
+        next_occlusion_indices[i] = occlusion_indices[begin];
+        log_weights[i] = log_uniform_weight;
+    }
+}
+
+
+
+// mean of the states of dimension state_dimension over the n poses, after their resampling
+// with ancestors of resample_kernel(). Block d computes coordinate d of the mean, with a float
+// of shared memory per thread.
+__global__ void resampled_mean_kernel(const float* states, int state_dimension, const float* log_weights,
+                                      const int* ancestors, int n, float* mean) {
+    extern __shared__ float reduction[];
+
+    float sum = 0;
+    for (int i = threadIdx.x; i < n; i += blockDim.x) {
+        sum += __expf(log_weights[i]) * states[ancestors[i] * state_dimension + blockIdx.x];
+    }
+    sum = reduce_block(reduction, sum, false);
+    if (threadIdx.x == 0) mean[blockIdx.x] = sum;
+}
+
 
-            // change occlusion prob array to the new one and change the global index
-            occlusion_probs = new_occlusion_probs;
-            // reset pixel_nr for following loop
-            pixel_nr = threadIdx.x;
 
-            occlusion_pixel_index= block_id * nr_pixels + pixel_nr;
+// resolves the occlusion indices of the n poses to occlusion images like
+// CudaEvaluator::assign_occlusion_images(), but with the indices and the images of the slots in
+// device memory, such that they need not go through the host. The copies are counted in
+// nr_copies. is_parent and free_images are scratch buffers of max_nr_poses values. The
+// assignment is sequential and runs in a single thread.
+__global__ void assign_occlusion_images_kernel(int* occlusion_indices, int n, int max_nr_poses,
+                                               bool update_occlusions, int* slot_images, int* is_parent,
+                                               int* free_images, int* pose_images, int* copy_jobs,
+                                               int* nr_copies) {
+    int copies = 0;
+
+    if (!update_occlusions) {
+        for (int i = 0; i < n; i++) {
+            pose_images[i] = slot_images[occlusion_indices[i]];
+        }
+    } else {
+        for (int slot = 0; slot < max_nr_poses; slot++) is_parent[slot] = 0;
+        for (int i = 0; i < n; i++) is_parent[occlusion_indices[i]] = 1;
+        int nr_free = 0;
+        for (int slot = 0; slot < max_nr_poses; slot++) {
+            if (!is_parent[slot]) free_images[nr_free++] = slot_images[slot];
         }
 
+        for (int i = 0; i < n; i++) {
+            int parent = occlusion_indices[i];
+            if (is_parent[parent]) {
+                pose_images[i] = slot_images[parent];
+                is_parent[parent] = 0;
+            } else {
+                pose_images[i] = free_images[--nr_free];
+                copy_jobs[2 * copies] = slot_images[parent];
+                copy_jobs[2 * copies + 1] = pose_images[i];
+                copies++;
+            }
+        }
 
-        while (pixel_nr < nr_pixels ) {
+        // after the update, pose i is stored in slot i
+        for (int i = 0; i < n; i++) {
+            slot_images[i] = pose_images[i];
+            occlusion_indices[i] = i;
+        }
+        for (int slot = n; slot < max_nr_poses; slot++) {
+            slot_images[slot] = free_images[--nr_free];
+        }
+    }
 
-            depth = tex2D(texture_reference, texture_array_index_x, texture_array_index_y);
-            observed_depth = observations[pixel_nr];
+    *nr_copies = copies;
+}
 
-            occlusion_prob = propagate_occlusion(occlusion_probs[occlusion_pixel_index], delta_time);
-            if (update_occlusions) occlusion_probs[occlusion_pixel_index] = occlusion_prob;
 
 
-            if (depth != 0 && !isnan(observed_depth)) {
+// evaluates the poses first_pose, ..., first_pose + n_poses - 1, whose renderings are tiled in
+// depth_texture starting with the first tile. The occlusions of each pose are read
+// from the image pose_images[pose], which is exclusive to the pose if update_occlusions is
+// set, such that it is updated in place.
+// Only the pixels inside the bounding box {col_min, row_min, col_max, row_max} of each pose
+// are compared, the object is not rendered outside of it. If bounding_boxes is NULL, the
+// whole image is compared. The block size has to be a multiple of the warp size.
+// Only the valid observations of compact_valid_pixels_kernel() are visited, each warp takes whole
+// rows of the box and finds the valid columns within it by bisection.
+// If depth_layers is not NULL, the depth of a pixel is the closest one of the nr_layers layers of
+// the pose, which are layer_size values apart, instead of the one in the texture.
+template <typename Occlusion>
+__global__ void evaluate_kernel(const CudaModelParameters params, cudaTextureObject_t depth_texture, bool layered,
+                                 float *observations,
+                                 const int* valid_cols, const int* valid_counts, Occlusion* occlusion_probs, int* pose_images, int* bounding_boxes, int nr_pixels,
+                                 float *d_log_likelihoods, float delta_time, int first_pose, int n_poses, int n_rows, int n_cols, bool update_occlusions,
+                                 const float* depth_layers, int nr_layers, size_t layer_size) {
+    int tile_id = tile_of_block();
+    if (tile_id < n_poses) {
+
+        int block_id = first_pose + tile_id;
 
-                // prob of observation given prediction, knowing that the object is not occluded
-                p_obsIpred_vis = prob(observed_depth, depth, false) * (1 - occlusion_prob);
-                // prob of observation given prediction, knowing that the object is occluded
-                p_obsIpred_occl = prob(observed_depth, depth, true) * occlusion_prob;
-                // prob of observation given no intersection
-                p_obsIinf = prob(observed_depth, CUDART_INF_F, true);
+        float depth;
+        float observed_depth;
+        float occlusion_prob = params.initial_occlusion_prob;
+        float local_sum_of_likelihoods = 0;
+        float p_obsIpred_vis, p_obsIpred_occl, p_obsIinf;
 
-                local_sum_of_likelihoods += __logf(__fdividef((p_obsIpred_vis + p_obsIpred_occl), p_obsIinf));
+        __shared__ float warp_sums[32];
+        __shared__ int occlusion_image_index;
+        __shared__ int box[4];
 
+        if (threadIdx.x == 0) {
+            occlusion_image_index = pose_images[block_id];
+            if (bounding_boxes != NULL) {
+                for (int i = 0; i < 4; i++) box[i] = bounding_boxes[4 * block_id + i];
+            } else {
+                box[0] = 0;
+                box[1] = 0;
+                box[2] = n_cols - 1;
+                box[3] = n_rows - 1;
+            }
+        }
+
+        __syncthreads();
 
-                if(update_occlusions) {
-                    // we update the occlusion probability with the observations
-                    occlusion_probs[occlusion_pixel_index] = 1 - __fdividef(p_obsIpred_vis, (p_obsIpred_vis + p_obsIpred_occl));
+        Occlusion* occlusions = occlusion_probs + occlusion_image_index * nr_pixels;
+        int lane = threadIdx.x % warpSize;
+        int warp = threadIdx.x / warpSize;
+        int nr_warps = blockDim.x / warpSize;
+
+        for (int row = box[1] + warp; row <= box[3]; row += nr_warps) {
+            const int* row_cols = valid_cols + row * n_cols;
+            int begin = first_not_less(row_cols, valid_counts[row], box[0]);
+            int end = first_not_less(row_cols, valid_counts[row], box[2] + 1);
+
+            for (int i = begin + lane; i < end; i += warpSize) {
+                int col = row_cols[i];
+                int pixel_nr = row * n_cols + col;
+
+                if (depth_layers != NULL) {
+                    // a depth of 0 is no intersection
+                    const float* layer_depth = depth_layers + size_t(block_id) * nr_pixels + pixel_nr;
+                    depth = 0;
+                    for (int layer = 0; layer < nr_layers; layer++) {
+                        float layer_value = layer_depth[layer * layer_size];
+                        if (layer_value != 0 && (depth == 0 || layer_value < depth)) depth = layer_value;
+                    }
+                } else {
+                    depth = read_depth(depth_texture, layered, row, col, n_rows, n_cols);
+                }
+                observed_depth = observations[pixel_nr];
+
+                occlusion_prob = propagate_occlusion(params, load_occlusion(occlusions + pixel_nr), delta_time);
+
+                if (depth != 0) {
+
+                    // prob of observation given prediction, knowing that the object is not occluded
+                    p_obsIpred_vis = prob(params, observed_depth, depth, false) * (1 - occlusion_prob);
+                    // prob of observation given prediction, knowing that the object is occluded
+                    p_obsIpred_occl = prob(params, observed_depth, depth, true) * occlusion_prob;
+                    // prob of observation given no intersection
+                    p_obsIinf = prob(params, observed_depth, CUDART_INF_F, true);
+
+                    local_sum_of_likelihoods += __logf(__fdividef((p_obsIpred_vis + p_obsIpred_occl), p_obsIinf));
+
+
+                    if(update_occlusions) {
+                        // we update the occlusion probability with the observations
+                        store_occlusion(occlusions + pixel_nr, 1 - __fdividef(p_obsIpred_vis, (p_obsIpred_vis + p_obsIpred_occl)));
+                    }
+                } else if (update_occlusions) {
+                    store_occlusion(occlusions + pixel_nr, occlusion_prob);
                 }
             }
+        }
 
-            pixel_nr += blockDim.x;
-            occlusion_pixel_index += blockDim.x;
-            texture_array_index_x = blockIdx.x * n_cols + pixel_nr % n_cols;
-            texture_array_index_y = gridDim.y * n_rows - (blockIdx.y * n_rows + (pixel_nr / n_cols) + 1);
+        if (update_occlusions) {
+            // outside of the box the object is not rendered and invalid observations
+            // carry no information, such that the occlusion probabilities are only
+            // propagated in time
+            for (int pixel_nr = threadIdx.x; pixel_nr < nr_pixels; pixel_nr += blockDim.x) {
+                int row = pixel_nr / n_cols;
+                int col = pixel_nr % n_cols;
+                if (row < box[1] || row > box[3] || col < box[0] || col > box[2]
+                        || isnan(observations[pixel_nr])) {
+                    store_occlusion(occlusions + pixel_nr,
+                                    propagate_occlusion(params, load_occlusion(occlusions + pixel_nr), delta_time));
+                }
+            }
         }
 
-        atomicAdd(&log_likelihoods, local_sum_of_likelihoods);
+        // reduce within each warp, then over the sums of the warps
+        local_sum_of_likelihoods = warp_sum(local_sum_of_likelihoods);
+        if (lane == 0) warp_sums[warp] = local_sum_of_likelihoods;
 
         __syncthreads();
 
-        if (threadIdx.x == 0) {
-            d_log_likelihoods[block_id] = log_likelihoods;
+        if (warp == 0) {
+            float sum = lane < nr_warps ? warp_sums[lane] : 0;
+            sum = warp_sum(sum);
+            if (lane == 0) d_log_likelihoods[block_id] = sum;
         }
     } else {
         __syncthreads();
@@ -256,10 +708,14 @@ __global__ void evaluate_kernel(float *observations, float* old_occlusion_probs,
 
 
 CudaEvaluator::CudaEvaluator(const int nr_rows,
-                       const int nr_cols) :
+                       const int nr_cols,
+                       const bool half_precision_occlusions,
+                       const int device) :
 
     nr_rows_(nr_rows),
-    nr_cols_(nr_cols)
+    nr_cols_(nr_cols),
+    half_precision_occlusions_(half_precision_occlusions),
+    layered_textures_(false)
 {
 
     cudaDeviceProp  props;
@@ -268,9 +724,19 @@ CudaEvaluator::CudaEvaluator(const int nr_rows,
     memset( &props, 0, sizeof( cudaDeviceProp ) );
     props.major = 2;
     props.minor = 0;
-    cudaChooseDevice( &device_number, &props );
+    if (device >= 0) {
+        device_number = device;
+    } else {
+        cudaChooseDevice( &device_number, &props );
+        #ifdef DEBUG
+            check_cuda_error("No device with compute capability > 2.0 found");
+        #endif
+    }
+
+    // all further runtime calls of this thread go to this device
+    cudaSetDevice(device_number);
     #ifdef DEBUG
-        check_cuda_error("No device with compute capability > 2.0 found");
+        check_cuda_error("cudaSetDevice");
     #endif
 
     /* tell CUDA which device we will be using for graphic interop.
@@ -297,11 +763,77 @@ CudaEvaluator::CudaEvaluator(const int nr_rows,
     cudaDeviceSetCacheConfig(cudaFuncCachePreferL1);
 
 
+    for (int i = 0; i < NR_TEXTURES; i++) {
+        texture_objects_[i] = 0;
+    }
+
     d_occlusion_probs_ = NULL;
-    d_occlusion_probs_copy_ = NULL;
+    d_half_occlusion_probs_ = NULL;
+    d_occlusion_image_ = NULL;
     d_observations_ = NULL;
+    d_next_observations_ = NULL;
+    d_native_observations_ = NULL;
+    d_valid_cols_ = NULL;
+    d_next_valid_cols_ = NULL;
+    d_valid_counts_ = NULL;
+    d_next_valid_counts_ = NULL;
     d_log_likelihoods_ = NULL;
+    d_pose_images_ = NULL;
+    d_copy_jobs_ = NULL;
+    d_bounding_boxes_ = NULL;
+    d_log_weights_ = NULL;
+    d_cdf_ = NULL;
+    d_ancestors_ = NULL;
     d_occlusion_indices_ = NULL;
+    d_next_occlusion_indices_ = NULL;
+    d_slot_images_ = NULL;
+    d_is_parent_ = NULL;
+    d_free_images_ = NULL;
+    d_nr_copies_ = NULL;
+    d_states_ = NULL;
+    d_mean_ = NULL;
+    d_depth_layers_[0] = NULL;
+    d_depth_layers_[1] = NULL;
+    d_depth_layer_sources_ = NULL;
+    h_depth_layer_sources_ = NULL;
+    nr_depth_layers_ = 0;
+    depth_layer_poses_ = 0;
+    current_depth_layers_ = 0;
+
+    h_observations_ = NULL;
+    h_native_observations_ = NULL;
+    native_observations_size_ = 0;
+    h_log_likelihoods_ = NULL;
+    h_pose_images_ = NULL;
+    h_copy_jobs_ = NULL;
+    h_bounding_boxes_ = NULL;
+    h_states_ = NULL;
+    h_mean_ = NULL;
+    states_size_ = 0;
+
+    device_resampling_ = false;
+    slot_images_on_device_ = false;
+    ancestors_on_device_ = false;
+    upload_occlusion_indices_ = false;
+    nr_resampled_poses_ = 0;
+
+    update_occlusions_ = false;
+    delta_time_ = 0;
+    nr_copies_ = 0;
+    segment_nr_ = 0;
+    occlusion_images_pending_ = false;
+    read_back_pending_ = false;
+    use_graphs_ = false;
+
+    cudaStreamCreate(&stream_);
+    cudaStreamCreate(&upload_stream_);
+    cudaEventCreateWithFlags(&observations_uploaded_, cudaEventDisableTiming);
+    cudaEventCreateWithFlags(&observations_released_, cudaEventDisableTiming);
+    cudaEventCreateWithFlags(&pose_images_uploaded_, cudaEventDisableTiming);
+    cudaEventCreateWithFlags(&depth_layer_sources_uploaded_, cudaEventDisableTiming);
+    #ifdef DEBUG
+        check_cuda_error("creating streams and events");
+    #endif
 
     set_nr_threads(DEFAULT_NR_THREADS);
 }
@@ -325,113 +857,489 @@ void CudaEvaluator::init(const float initial_occlusion_prob, const float p_occlu
 
 
 
-    // copy constants to GPU memory
-    cudaMemcpyToSymbol(g_initial_occlusion_prob, &initial_occlusion_prob, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol initial_occlusion_prob -> g_initial_occlusion_prob");
-    #endif
+    // the constants are passed to the kernels by value, such that several
+    // evaluators with different parameters can share a device
+    parameters_.initial_occlusion_prob = initial_occlusion_prob;
+    parameters_.one_div_c_minus_one = one_div_c_minus_one;
+    parameters_.one_div_sqrt_of_two = one_div_sqrt_of_two;
+    parameters_.one_div_sqrt_of_two_pi = one_div_sqrt_of_two_pi;
+    parameters_.log_c = log_c;
+    parameters_.p_occluded_occluded = p_occluded_occluded;
+    parameters_.one_minus_tail_weight = one_minus_tail_weight;
+    parameters_.model_sigma = model_sigma;
+    parameters_.sigma_factor = sigma_factor;
+    parameters_.tail_weight_div_max_depth = tail_weight_div_max_depth;
+    parameters_.exponential_rate = exponential_rate;
+
+    constants_initialized_ = true;
+}
+
+
+
+
+
+void CudaEvaluator::weigh_poses(const bool update_occlusions, vector<float> &log_likelihoods) {
+    if (begin_weighting(update_occlusions)) {
+        weigh_batch(0, 0, nr_poses_);
+        end_weighting(log_likelihoods);
+    }
+}
+
+
+
+bool CudaEvaluator::begin_weighting(const bool update_occlusions, const bool from_textures) {
+    if (observations_set_ && occlusion_indices_set_
+            && memory_allocated_ && number_of_poses_set_ && constants_initialized_
+            && (texture_array_mapped_ || !from_textures)) {
+
+        delta_time_ = observation_time_ - occlusion_time_;
+        if(update_occlusions) occlusion_time_ = observation_time_;
+        update_occlusions_ = update_occlusions;
+
+        assign_occlusion_images(update_occlusions);
+
+        // the kernels must not start before the current observations have
+        // arrived
+        cudaStreamWaitEvent(stream_, observations_uploaded_, 0);
+
+        // the uploads are enqueued with the first segment, such that they
+        // are part of its graph
+        occlusion_images_pending_ = true;
+        // with the resampling on the device, the likelihoods stay there
+        read_back_pending_ = !device_resampling_;
+        segment_nr_ = 0;
+
+        return true;
+    } else {
+        std::cout << "WARNING (CUDA): It seems you forgot to do one of the following: set observation image, set occlusion"
+                  << " indices, set number of poses, allocate memory, map texture to texture array or inisitialize constants." << std::endl;
+        return false;
+    }
+}
+
+
+
+void CudaEvaluator::weigh_batch(const int texture_nr, const int first_pose, const int nr_poses,
+                                const int* bounding_boxes) {
+    if (first_pose + nr_poses > nr_poses_) {
+        std::cout << "ERROR (CUDA): The batch of poses " << first_pose << " - "
+                  << first_pose + nr_poses - 1 << " exceeds the number of poses ("
+                  << nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    Segment segment;
+    segment.texture_nr = texture_nr;
+    segment.first_pose = first_pose;
+    segment.nr_poses = nr_poses;
+    segment.bounding_boxes = bounding_boxes;
+    segment.depth_layers = NULL;
+    segment.nr_layers = 0;
+    segment.layer_size = 0;
+    segment.read_back = first_pose + nr_poses == nr_poses_ && !device_resampling_;
+    run_segment(segment);
+}
+
+
+
+void CudaEvaluator::weigh_depth_layers(const int first_pose, const int nr_poses,
+                                       const int* bounding_boxes) {
+    if (first_pose + nr_poses > nr_poses_ || nr_poses_ > depth_layer_poses_) {
+        std::cout << "ERROR (CUDA): The depth layers of the poses " << first_pose << " - "
+                  << first_pose + nr_poses - 1 << " exceed the number of poses ("
+                  << nr_poses_ << ") or of allocated layers (" << depth_layer_poses_
+                  << ")." << std::endl;
+        exit(-1);
+    }
+
+    // the tiles only index the poses, there is no texture
+    Segment segment;
+    segment.texture_nr = 0;
+    segment.first_pose = first_pose;
+    segment.nr_poses = nr_poses;
+    segment.bounding_boxes = bounding_boxes;
+    segment.depth_layers = d_depth_layers_[current_depth_layers_];
+    segment.nr_layers = nr_depth_layers_;
+    segment.layer_size = size_t(depth_layer_poses_) * nr_rows_ * nr_cols_;
+    segment.read_back = first_pose + nr_poses == nr_poses_ && !device_resampling_;
+    run_segment(segment);
+}
+
+
+
+void CudaEvaluator::weigh_depth_images(const float* depth_images, const int first_pose, const int nr_poses,
+                                       const int* bounding_boxes) {
+    if (first_pose + nr_poses > nr_poses_) {
+        std::cout << "ERROR (CUDA): The depth images of the poses " << first_pose << " - "
+                  << first_pose + nr_poses - 1 << " exceed the number of poses ("
+                  << nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    // a single layer
+    Segment segment;
+    segment.texture_nr = 0;
+    segment.first_pose = first_pose;
+    segment.nr_poses = nr_poses;
+    segment.bounding_boxes = bounding_boxes;
+    segment.depth_layers = depth_images;
+    segment.nr_layers = 1;
+    segment.layer_size = 0;
+    segment.read_back = first_pose + nr_poses == nr_poses_ && !device_resampling_;
+    run_segment(segment);
+}
+
+
+
+bool CudaEvaluator::allocate_depth_layers(const int nr_objects) {
+    free_depth_layers();
+    clear_graphs();
+    if (!memory_allocated_ || nr_objects <= 0) return false;
+
+    const size_t layer_size = size_t(max_nr_poses_) * nr_rows_ * nr_cols_;
+    const size_t need = 2 * nr_objects * layer_size * sizeof(float);
+    size_t free_memory, total_memory;
+    cudaMemGetInfo(&free_memory, &total_memory);
+    if (need > free_memory) return false;
+
+    if (cudaMalloc((void **) &d_depth_layers_[0], nr_objects * layer_size * sizeof(float)) != cudaSuccess ||
+        cudaMalloc((void **) &d_depth_layers_[1], nr_objects * layer_size * sizeof(float)) != cudaSuccess) {
+        cudaGetLastError();
+        free_depth_layers();
+        return false;
+    }
+    allocate(d_depth_layer_sources_, nr_objects * max_nr_poses_ * sizeof(int));
+    allocate_host(h_depth_layer_sources_, nr_objects * max_nr_poses_ * sizeof(int));
+
+    nr_depth_layers_ = nr_objects;
+    depth_layer_poses_ = max_nr_poses_;
+    current_depth_layers_ = 0;
+    return true;
+}
+
+
+
+int CudaEvaluator::get_depth_layer_poses() const {
+    return depth_layer_poses_;
+}
+
+
+
+void CudaEvaluator::swap_depth_layers() {
+    current_depth_layers_ = 1 - current_depth_layers_;
+}
+
+
+
+void CudaEvaluator::store_depth_layer(const int texture_nr, const int object_nr, const int nr_poses) {
+    if (object_nr >= nr_depth_layers_ || nr_poses > depth_layer_poses_) {
+        std::cout << "ERROR (CUDA): No depth layer of object " << object_nr << " for "
+                  << nr_poses << " poses was allocated." << std::endl;
+        exit(-1);
+    }
+
+    float* layer = d_depth_layers_[current_depth_layers_]
+                   + object_nr * size_t(depth_layer_poses_) * nr_rows_ * nr_cols_;
+    store_depth_layer_kernel <<< batch_grid_dimension(nr_poses), nr_threads_, 0, stream_ >>> (
+        texture_objects_[texture_nr], layered_textures_, layer, nr_poses, nr_rows_, nr_cols_);
+    #ifdef DEBUG
+        check_cuda_error("store_depth_layer_kernel call");
+    #endif
+}
+
+
+
+void CudaEvaluator::gather_depth_layers(const int* sources, const int nr_poses) {
+    if (nr_poses > depth_layer_poses_) {
+        std::cout << "ERROR (CUDA): The depth layers were allocated for "
+                  << depth_layer_poses_ << " instead of " << nr_poses << " poses." << std::endl;
+        exit(-1);
+    }
+    if (nr_poses == 0) return;
+
+    // the pinned buffer may still be read by the previous upload
+    cudaEventSynchronize(depth_layer_sources_uploaded_);
+    memcpy(h_depth_layer_sources_, sources, nr_depth_layers_ * nr_poses * sizeof(int));
+    cudaMemcpyAsync(d_depth_layer_sources_, h_depth_layer_sources_, nr_depth_layers_ * nr_poses * sizeof(int),
+                    cudaMemcpyHostToDevice, stream_);
+    cudaEventRecord(depth_layer_sources_uploaded_, stream_);
+
+    gather_depth_layers_kernel <<< dim3(nr_poses, nr_depth_layers_), nr_threads_, 0, stream_ >>> (
+        d_depth_layers_[1 - current_depth_layers_], d_depth_layers_[current_depth_layers_],
+        d_depth_layer_sources_, nr_poses, nr_rows_ * nr_cols_,
+        size_t(depth_layer_poses_) * nr_rows_ * nr_cols_);
+    #ifdef DEBUG
+        check_cuda_error("gather_depth_layers_kernel call");
+    #endif
+}
+
+
+
+void CudaEvaluator::end_weighting(vector<float> &log_likelihoods) {
+    // the batches did not reach the last pose
+    if (occlusion_images_pending_) {
+        enqueue_occlusion_images();
+        cudaEventRecord(pose_images_uploaded_, stream_);
+        occlusion_images_pending_ = false;
+    }
+    if (read_back_pending_) {
+        enqueue_read_back();
+        read_back_pending_ = false;
+    }
+
+    // the likelihoods are resampled on the device without waiting for them
+    if (device_resampling_) {
+        log_likelihoods.assign(nr_poses_, 0);
+        return;
+    }
+
+    cudaStreamSynchronize(stream_);
+    #ifdef DEBUG
+        check_cuda_error("cudaStreamSynchronize weighting");
+    #endif
+
+    log_likelihoods.assign(h_log_likelihoods_, h_log_likelihoods_ + nr_poses_);
+}
+
+
+
+template <typename Occlusion>
+void CudaEvaluator::launch_evaluation(const int texture_nr, Occlusion* occlusion_probs, const dim3 grid_dimension,
+                                      const int first_pose, const int nr_poses, int* bounding_boxes,
+                                      const float* depth_layers, const int nr_layers, const size_t layer_size) {
+    evaluate_kernel <<< grid_dimension, nr_threads_, 0, stream_ >>> (parameters_, texture_objects_[texture_nr],
+                                               layered_textures_, d_observations_,
+                                               d_valid_cols_, d_valid_counts_, occlusion_probs,
+                                               d_pose_images_, bounding_boxes, nr_cols_ * nr_rows_, d_log_likelihoods_, delta_time_,
+                                               first_pose, nr_poses, nr_rows_, nr_cols_, update_occlusions_,
+                                               depth_layers, nr_layers, layer_size);
+}
+
+
+
+void CudaEvaluator::enqueue_read_back() {
+    cudaMemcpyAsync(h_log_likelihoods_, d_log_likelihoods_, nr_poses_ * sizeof(float),
+                    cudaMemcpyDeviceToHost, stream_);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpyAsync d_log_likelihoods -> h_log_likelihoods");
+    #endif
+}
+
+
+
+void CudaEvaluator::enqueue_segment(const Segment& segment) {
+    if (occlusion_images_pending_) enqueue_occlusion_images();
+
+    // the batch is tiled like a render call with nr_poses poses
+    dim3 grid_dimension = batch_grid_dimension(segment.nr_poses);
+    int* d_bounding_boxes = upload_bounding_boxes(segment.bounding_boxes, segment.first_pose, segment.nr_poses);
+
+    if (half_precision_occlusions_) {
+        launch_evaluation(segment.texture_nr, d_half_occlusion_probs_, grid_dimension, segment.first_pose,
+                          segment.nr_poses, d_bounding_boxes, segment.depth_layers, segment.nr_layers,
+                          segment.layer_size);
+    } else {
+        launch_evaluation(segment.texture_nr, d_occlusion_probs_, grid_dimension, segment.first_pose,
+                          segment.nr_poses, d_bounding_boxes, segment.depth_layers, segment.nr_layers,
+                          segment.layer_size);
+    }
+    #ifdef DEBUG
+        check_cuda_error("compare kernel call");
+    #endif
+
+    if (segment.read_back) enqueue_read_back();
+}
+
+
+
+void CudaEvaluator::run_segment(const Segment& segment) {
+#if CUDART_VERSION >= 11040
+    // the segment only enqueues work on the stream and reads pinned buffers
+    // and device memory, so it can be captured. The capture is local to this
+    // thread, other evaluators keep enqueueing meanwhile.
+    bool launched = !use_graphs_;
+    if (use_graphs_) {
+        cudaGraph_t graph = NULL;
+        if (cudaStreamBeginCapture(stream_, cudaStreamCaptureModeThreadLocal) == cudaSuccess) {
+            enqueue_segment(segment);
+            if (cudaStreamEndCapture(stream_, &graph) == cudaSuccess) {
+                launched = launch_graph(segment_key(segment), graph);
+                cudaGraphDestroy(graph);
+            }
+        }
+        if (!launched) {
+            cudaGetLastError();
+            std::cout << "WARNING (CUDA): The weighting could not be launched as a CUDA graph, "
+                      << "it is enqueued directly from now on." << std::endl;
+            clear_graphs();
+            use_graphs_ = false;
+        }
+    }
+    if (!use_graphs_) enqueue_segment(segment);
+#else
+    enqueue_segment(segment);
+#endif
+
+    // events are recorded outside of the graphs, since they are waited for
+    // by the host and the upload stream
+    if (occlusion_images_pending_) {
+        cudaEventRecord(pose_images_uploaded_, stream_);
+        occlusion_images_pending_ = false;
+    }
+    if (segment.read_back) read_back_pending_ = false;
+    segment_nr_++;
+
+    // the next upload may overwrite the observations once this batch is done
+    cudaEventRecord(observations_released_, stream_);
+}
+
+
+
+int CudaEvaluator::segment_key(const Segment& segment) const {
+    // the nodes of a segment are determined by its position and by what it
+    // enqueues, all other values are parameters of the nodes
+    int key = segment_nr_;
+    key = 2 * key + (occlusion_images_pending_ ? 1 : 0);
+    key = 2 * key + (occlusion_images_pending_ && nr_copies_ > 0 ? 1 : 0);
+    key = 2 * key + (occlusion_images_pending_ && upload_occlusion_indices_ ? 1 : 0);
+    key = 2 * key + (segment.bounding_boxes != NULL ? 1 : 0);
+    key = 2 * key + (segment.read_back ? 1 : 0);
+    return key;
+}
+
+
+
+#if CUDART_VERSION >= 11040
+bool CudaEvaluator::launch_graph(const int key, cudaGraph_t graph) {
+    map<int, cudaGraphExec_t>::iterator exec = graph_execs_.find(key);
+    if (exec != graph_execs_.end()) {
+#if CUDART_VERSION >= 12000
+        cudaGraphExecUpdateResultInfo result;
+        const bool updated = cudaGraphExecUpdate(exec->second, graph, &result) == cudaSuccess;
+#else
+        cudaGraphNode_t error_node;
+        cudaGraphExecUpdateResult result;
+        const bool updated = cudaGraphExecUpdate(exec->second, graph, &error_node, &result) == cudaSuccess;
+#endif
+        // nodes which cannot be updated after all are instantiated anew
+        if (!updated) {
+            cudaGetLastError();
+            cudaGraphExecDestroy(exec->second);
+            graph_execs_.erase(exec);
+            exec = graph_execs_.end();
+        }
+    }
+    if (exec == graph_execs_.end()) {
+        cudaGraphExec_t instance;
+        if (cudaGraphInstantiateWithFlags(&instance, graph, 0) != cudaSuccess) return false;
+        exec = graph_execs_.insert(make_pair(key, instance)).first;
+    }
+    return cudaGraphLaunch(exec->second, stream_) == cudaSuccess;
+}
+#endif
 
-    cudaMemcpyToSymbol(g_one_div_c_minus_one, &one_div_c_minus_one, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol one_div_c_minus_one -> g_one_div_c_minus_one");
-    #endif
 
-    cudaMemcpyToSymbol(g_one_div_sqrt_of_two, &one_div_sqrt_of_two, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol one_div_sqrt_of_two -> g_one_div_sqrt_of_two");
-    #endif
 
-    cudaMemcpyToSymbol(g_one_div_sqrt_of_two_pi, &one_div_sqrt_of_two_pi, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol one_div_sqrt_of_two_pi -> g_one_div_sqrt_of_two_pi");
-    #endif
+void CudaEvaluator::clear_graphs() {
+#if CUDART_VERSION >= 11040
+    for (map<int, cudaGraphExec_t>::iterator exec = graph_execs_.begin(); exec != graph_execs_.end(); ++exec) {
+        cudaGraphExecDestroy(exec->second);
+    }
+    graph_execs_.clear();
+#endif
+}
 
-    cudaMemcpyToSymbol(g_log_c, &log_c, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol log_c -> g_log_c");
-    #endif
 
-    cudaMemcpyToSymbol(g_p_occluded_occluded, &p_occluded_occluded, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol p_occluded_occluded -> g_p_occluded_occluded");
-    #endif
 
-    cudaMemcpyToSymbol(g_one_minus_tail_weight, &one_minus_tail_weight, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol one_minus_tail_weight -> g_one_minus_tail_weight");
-    #endif
+int* CudaEvaluator::upload_bounding_boxes(const int* bounding_boxes, const int first_pose, const int nr_poses) {
+    if (bounding_boxes == NULL) return NULL;
 
-    cudaMemcpyToSymbol(g_model_sigma, &model_sigma, sizeof(float), 0, cudaMemcpyHostToDevice);
+    // the pinned buffer of a previous weighting has been read completely
+    // in its end_weighting()
+    memcpy(h_bounding_boxes_ + 4 * first_pose, bounding_boxes, 4 * nr_poses * sizeof(int));
+    cudaMemcpyAsync(d_bounding_boxes_ + 4 * first_pose, h_bounding_boxes_ + 4 * first_pose,
+                    4 * nr_poses * sizeof(int), cudaMemcpyHostToDevice, stream_);
     #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol model_sigma -> g_model_sigma");
+        check_cuda_error("cudaMemcpyAsync h_bounding_boxes -> d_bounding_boxes");
     #endif
+    return d_bounding_boxes_;
+}
 
-    cudaMemcpyToSymbol(g_sigma_factor, &sigma_factor, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol sigma_factor -> g_sigma_factor");
-    #endif
 
-    cudaMemcpyToSymbol(g_tail_weight_div_max_depth, &tail_weight_div_max_depth, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol tail_weight_div_max_depth -> g_tail_weight_div_max_depth");
-    #endif
 
-    cudaMemcpyToSymbol(g_exponential_rate, &exponential_rate, sizeof(float), 0, cudaMemcpyHostToDevice);
-    #ifdef DEBUG
-        check_cuda_error("cudaMemcpyToSymbol exponential_rate -> g_exponential_rate");
-    #endif
+dim3 CudaEvaluator::batch_grid_dimension(const int nr_poses) const {
+    int nr_poses_per_row = min(max_nr_poses_per_row_, nr_poses);
+    int nr_poses_per_column = min(max_nr_poses_per_column_,
+                                  (int) ceil(nr_poses / (float) nr_poses_per_row));
+    // only layered textures hold more poses than one layer
+    int poses_per_layer = max_nr_poses_per_row_ * max_nr_poses_per_column_;
+    int nr_layers = max((nr_poses + poses_per_layer - 1) / poses_per_layer, 1);
+    return dim3(nr_poses_per_row, nr_poses_per_column, nr_layers);
+}
 
 
-    constants_initialized_ = true;
+
+bool CudaEvaluator::fits_texture_and_grid(const int nr_poses, const int nr_poses_per_row,
+                                          const int nr_poses_per_col) const {
+    const int poses_per_layer = nr_poses_per_row * nr_poses_per_col;
+    if (poses_per_layer <= 0) return false;
+    const int nr_layers = (nr_poses + poses_per_layer - 1) / poses_per_layer;
+    if (!layered_textures_) {
+        return nr_poses_per_row * nr_cols_ <= cuda_device_properties_.maxTexture2D[0] &&
+               nr_poses_per_col * nr_rows_ <= cuda_device_properties_.maxTexture2D[1] &&
+               nr_poses_per_row <= cuda_device_properties_.maxGridSize[0] &&
+               nr_poses_per_col <= cuda_device_properties_.maxGridSize[1] &&
+               nr_layers <= 1;
+    }
+    return nr_poses_per_row * nr_cols_ <= cuda_device_properties_.maxTexture2DLayered[0] &&
+           nr_poses_per_col * nr_rows_ <= cuda_device_properties_.maxTexture2DLayered[1] &&
+           nr_layers <= cuda_device_properties_.maxTexture2DLayered[2] &&
+           nr_poses_per_row <= cuda_device_properties_.maxGridSize[0] &&
+           nr_poses_per_col <= cuda_device_properties_.maxGridSize[1] &&
+           nr_layers <= cuda_device_properties_.maxGridSize[2];
 }
 
 
 
+void CudaEvaluator::set_layered_textures(const bool layered) {
+    layered_textures_ = layered;
+}
 
 
-void CudaEvaluator::weigh_poses(const bool update_occlusions, vector<float> &log_likelihoods) {
-    if (observations_set_ && occlusion_indices_set_
-            && memory_allocated_ && number_of_poses_set_ && constants_initialized_
-            && texture_array_mapped_) {
 
-        double delta_time = observation_time_ - occlusion_time_;
-        if(update_occlusions) occlusion_time_ = observation_time_;
+void CudaEvaluator::free_depth_layers() {
+    cudaFree(d_depth_layers_[0]);
+    cudaFree(d_depth_layers_[1]);
+    d_depth_layers_[0] = NULL;
+    d_depth_layers_[1] = NULL;
+    nr_depth_layers_ = 0;
+    depth_layer_poses_ = 0;
+}
 
 
-        evaluate_kernel <<< grid_dimension_, nr_threads_ >>> (d_observations_, d_occlusion_probs_, d_occlusion_probs_copy_, d_occlusion_indices_, nr_cols_ * nr_rows_,
-                                               d_log_likelihoods_, delta_time, nr_poses_, nr_rows_, nr_cols_, update_occlusions);
-        #ifdef DEBUG
-            check_cuda_error("compare kernel call");
-        #endif
 
-        cudaDeviceSynchronize();
-        #ifdef DEBUG
-            check_cuda_error("cudaDeviceSynchronize compare_multiple");
-        #endif
+void CudaEvaluator::set_graph_capture(const bool enabled) {
+#if CUDART_VERSION >= 11040
+    // pending launches of the instances complete regardless
+    if (!enabled) clear_graphs();
+    use_graphs_ = enabled;
+#else
+    if (enabled) {
+        std::cout << "WARNING (CUDA): CUDA graphs require CUDA 11.4, the weighting is enqueued directly." << std::endl;
+    }
+#endif
+}
 
-        // switch to new / copied occlusion probabilities
-        if (update_occlusions) {
-            float *tmp_pointer;
-            tmp_pointer = d_occlusion_probs_;
-            d_occlusion_probs_ = d_occlusion_probs_copy_;
-            d_occlusion_probs_copy_ = tmp_pointer;
-        }
 
 
-        cudaMemcpy(&log_likelihoods[0], d_log_likelihoods_, nr_poses_ * sizeof(float), cudaMemcpyDeviceToHost);
-        #ifdef DEBUG
-            check_cuda_error("cudaMemcpy d_log_likelihoods -> log_likelihoods");
-        #endif
+bool CudaEvaluator::get_graph_capture() const {
+    return use_graphs_;
+}
+
 
-        cudaDeviceSynchronize();
-        #ifdef DEBUG
-            check_cuda_error("cudaDeviceSynchronize compare");
-        #endif
-    } else {
-        std::cout << "WARNING (CUDA): It seems you forgot to do one of the following: set observation image, set occlusion"
-                  << " indices, set number of poses, allocate memory, map texture to texture array or inisitialize constants." << std::endl;
-    }
 
+cudaStream_t CudaEvaluator::get_stream() {
+    return stream_;
 }
 
 
@@ -452,12 +1360,22 @@ void CudaEvaluator::set_nr_threads(const int nr_threads) {
         exit(-1);
     }
 
+    // the likelihoods are reduced over complete warps
+    if (nr_threads % cuda_device_properties_.warpSize != 0) {
+        std::cout << "ERROR (CUDA): The number of threads you requested ("
+                  << nr_threads << ") is not a multiple of the warp size ("
+                  << cuda_device_properties_.warpSize << ")." << std::endl;
+        exit(-1);
+    }
+
     nr_threads_ = nr_threads;
+    clear_graphs();
 }
 
 
 
-void CudaEvaluator::set_observations(const float* observations, const float observation_time) {
+void CudaEvaluator::set_observations(const float* observations, const float observation_time,
+                                     const bool page_locked) {
 
     if (nr_rows_ * nr_cols_ > observations_size_) {
         std::cout << "ERROR (CUDA) in set_observations: You exceeded "
@@ -469,20 +1387,110 @@ void CudaEvaluator::set_observations(const float* observations, const float obse
 
     observation_time_ = observation_time;
 
-    cudaMemcpy(d_observations_, observations, nr_cols_ * nr_rows_ * sizeof(float), cudaMemcpyHostToDevice);
+    // the pinned buffer is reused once the previous upload has finished,
+    // which was usually long before. Page locked observations of the caller
+    // are uploaded from where they are.
+    cudaEventSynchronize(observations_uploaded_);
+    const float* source = observations;
+    if (!page_locked) {
+        memcpy(h_observations_, observations, nr_cols_ * nr_rows_ * sizeof(float));
+        source = h_observations_;
+    }
+
+    // upload into the buffer which is not read by the enqueued evaluations
+    // of the previous observations
+    cudaStreamWaitEvent(upload_stream_, observations_released_, 0);
+    cudaMemcpyAsync(d_next_observations_, source, nr_cols_ * nr_rows_ * sizeof(float),
+                    cudaMemcpyHostToDevice, upload_stream_);
     #ifdef DEBUG
-        check_cuda_error("cudaMemcpy observations -> d_observations_");
+        check_cuda_error("cudaMemcpyAsync observations -> d_next_observations_");
     #endif
-    cudaDeviceSynchronize();
+    compact_valid_pixels();
+    cudaEventRecord(observations_uploaded_, upload_stream_);
+
+    std::swap(d_observations_, d_next_observations_);
+    std::swap(d_valid_cols_, d_next_valid_cols_);
+    std::swap(d_valid_counts_, d_next_valid_counts_);
+
+    observations_set_ = true;
+}
+
+
+
+void CudaEvaluator::set_native_observations(const float* observations, const int native_rows,
+                                            const int native_cols, const int pooling,
+                                            const float observation_time,
+                                            const bool page_locked) {
+
+    const int factor = native_rows / nr_rows_;
+    if (factor < 1 || native_rows != factor * nr_rows_ || native_cols != factor * nr_cols_) {
+        std::cout << "ERROR (CUDA) in set_native_observations: the image of " << native_rows
+                  << " x " << native_cols << " pixels is no multiple of the resolution "
+                  << nr_rows_ << " x " << nr_cols_ << "." << std::endl;
+        exit(-1);
+    }
+    if (pooling == MEDIAN_POOLING && factor > MAX_MEDIAN_FACTOR) {
+        std::cout << "ERROR (CUDA) in set_native_observations: median pooling supports factors "
+                  << "up to " << MAX_MEDIAN_FACTOR << ", not " << factor << "." << std::endl;
+        exit(-1);
+    }
+    if (!memory_allocated_) {
+        std::cout << "ERROR (CUDA): You need to call allocate_memory_for_max_poses before "
+                  << "calling set_native_observations." << std::endl;
+        exit(-1);
+    }
+
+    observation_time_ = observation_time;
+
+    const int native_size = native_rows * native_cols;
+    if (native_size > native_observations_size_) {
+        allocate(d_native_observations_, native_size * sizeof(float));
+        allocate_host(h_native_observations_, native_size * sizeof(float));
+        native_observations_size_ = native_size;
+    }
+
+    // as in set_observations(), but the native image is uploaded and
+    // downsampled into the next observation buffer on the upload stream
+    cudaEventSynchronize(observations_uploaded_);
+    const float* source = observations;
+    if (!page_locked) {
+        memcpy(h_native_observations_, observations, native_size * sizeof(float));
+        source = h_native_observations_;
+    }
+
+    cudaStreamWaitEvent(upload_stream_, observations_released_, 0);
+    cudaMemcpyAsync(d_native_observations_, source, native_size * sizeof(float),
+                    cudaMemcpyHostToDevice, upload_stream_);
+    const int nr_pixels = nr_rows_ * nr_cols_;
+    const int nr_threads = 256;
+    downsample_depth_kernel <<< (nr_pixels + nr_threads - 1) / nr_threads, nr_threads, 0, upload_stream_ >>>
+        (d_native_observations_, native_cols, d_next_observations_, nr_rows_, nr_cols_, factor, pooling);
     #ifdef DEBUG
-        check_cuda_error("cudaDeviceSynchronize set_observations");
+        check_cuda_error("downsample_depth_kernel");
     #endif
+    compact_valid_pixels();
+    cudaEventRecord(observations_uploaded_, upload_stream_);
+
+    std::swap(d_observations_, d_next_observations_);
+    std::swap(d_valid_cols_, d_next_valid_cols_);
+    std::swap(d_valid_counts_, d_next_valid_counts_);
 
     observations_set_ = true;
 }
 
 
 
+void CudaEvaluator::compact_valid_pixels() {
+    const int nr_threads = 128;
+    compact_valid_pixels_kernel <<< nr_rows_, nr_threads, 0, upload_stream_ >>>
+        (d_next_observations_, nr_cols_, d_next_valid_cols_, d_next_valid_counts_);
+    #ifdef DEBUG
+        check_cuda_error("compact_valid_pixels_kernel");
+    #endif
+}
+
+
+
 void CudaEvaluator::set_occlusion_indices(const int* occlusion_indices,
                                           const int array_size) {
 
@@ -493,18 +1501,91 @@ void CudaEvaluator::set_occlusion_indices(const int* occlusion_indices,
         exit(-1);
     }
 
-    cudaMemcpy(d_occlusion_indices_, occlusion_indices,
-               array_size * sizeof(int), cudaMemcpyHostToDevice);
+    // the indices are resolved to occlusion images in begin_weighting()
+    occlusion_indices_.assign(occlusion_indices, occlusion_indices + array_size);
+
+    occlusion_indices_set_ = true;
+}
+
+
+
+void CudaEvaluator::set_device_resampling(const bool enabled) {
+    if (enabled == device_resampling_) return;
+
+    // the host takes the slot images over again
+    if (!enabled) pull_slot_images();
+    clear_graphs();
+    device_resampling_ = enabled;
+    ancestors_on_device_ = false;
+}
+
+
+
+bool CudaEvaluator::get_device_resampling() const {
+    return device_resampling_;
+}
+
+
+
+void CudaEvaluator::resample_poses(const float* states, const int state_dimension, const float max_kl_divergence,
+                                   const float uniform, float* mean) {
+    if (!device_resampling_ || !memory_allocated_ || nr_poses_ <= 0) {
+        std::cout << "ERROR (CUDA): The poses can only be resampled on the device after a weighting with "
+                  << "set_device_resampling() enabled." << std::endl;
+        exit(-1);
+    }
+
+    // the weights of a different number of poses start uniform
+    if (nr_resampled_poses_ != nr_poses_) {
+        cudaMemsetAsync(d_log_weights_, 0, nr_poses_ * sizeof(float), stream_);
+    }
 
+    const int states_size = nr_poses_ * state_dimension;
+    if (states_size > states_size_) {
+        allocate(d_states_, states_size * sizeof(float));
+        allocate_host(h_states_, states_size * sizeof(float));
+        allocate(d_mean_, states_size * sizeof(float));
+        allocate_host(h_mean_, states_size * sizeof(float));
+        states_size_ = states_size;
+    }
+    memcpy(h_states_, states, states_size * sizeof(float));
+    cudaMemcpyAsync(d_states_, h_states_, states_size * sizeof(float), cudaMemcpyHostToDevice, stream_);
+
+    const size_t shared_size = nr_threads_ * sizeof(float);
+    resample_kernel <<< 1, nr_threads_, shared_size, stream_ >>> (d_log_weights_, d_log_likelihoods_, d_cdf_,
+                                                                  nr_poses_, max_kl_divergence, uniform,
+                                                                  d_ancestors_, d_occlusion_indices_,
+                                                                  d_next_occlusion_indices_);
+    resampled_mean_kernel <<< state_dimension, nr_threads_, shared_size, stream_ >>> (
+        d_states_, state_dimension, d_log_weights_, d_ancestors_, nr_poses_, d_mean_);
     #ifdef DEBUG
-        check_cuda_error("cudaMemcpy occlusion_indices -> d_occlusion_indices");
+        check_cuda_error("resample_kernel call");
     #endif
-    cudaDeviceSynchronize();
+
+    // the next weighting reads the occlusion indices of the ancestors
+    std::swap(d_occlusion_indices_, d_next_occlusion_indices_);
+    ancestors_on_device_ = true;
+    nr_resampled_poses_ = nr_poses_;
+
+    cudaMemcpyAsync(h_mean_, d_mean_, state_dimension * sizeof(float), cudaMemcpyDeviceToHost, stream_);
+    cudaStreamSynchronize(stream_);
     #ifdef DEBUG
-        check_cuda_error("cudaDeviceSynchronize set_occlusion_indices");
+        check_cuda_error("cudaMemcpyAsync d_mean -> h_mean");
     #endif
+    memcpy(mean, h_mean_, state_dimension * sizeof(float));
+}
 
-    occlusion_indices_set_ = true;
+
+
+void CudaEvaluator::get_ancestors(vector<int>& ancestors) {
+    ancestors.resize(nr_resampled_poses_);
+    if (nr_resampled_poses_ == 0) return;
+
+    cudaStreamSynchronize(stream_);
+    cudaMemcpy(ancestors.data(), d_ancestors_, nr_resampled_poses_ * sizeof(int), cudaMemcpyDeviceToHost);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy d_ancestors -> ancestors");
+    #endif
 }
 
 
@@ -527,8 +1608,21 @@ void CudaEvaluator::set_occlusion_probabilities(const float* occlusion_probabili
         exit(-1);
     }
 
-    cudaMemcpy(d_occlusion_probs_, occlusion_probabilities,
-               array_size * sizeof(float), cudaMemcpyHostToDevice);
+    if (half_precision_occlusions_) {
+        // convert image by image to keep the staging buffer small
+        int nr_pixels = nr_rows_ * nr_cols_;
+        for (int offset = 0; offset < array_size; offset += nr_pixels) {
+            int count = min(nr_pixels, array_size - offset);
+            cudaMemcpy(d_occlusion_image_, occlusion_probabilities + offset,
+                       count * sizeof(float), cudaMemcpyHostToDevice);
+            convert_occlusions_kernel <<< cuda_device_properties_.multiProcessorCount, nr_threads_ >>> (
+                d_occlusion_image_, d_half_occlusion_probs_ + offset, count);
+        }
+    } else {
+        cudaMemcpy(d_occlusion_probs_, occlusion_probabilities,
+                   array_size * sizeof(float), cudaMemcpyHostToDevice);
+    }
+    reset_occlusion_images();
 
     #ifdef DEBUG
         check_cuda_error("cudaMemcpy occlusion_probabilities -> d_occlusion_probs_");
@@ -540,13 +1634,97 @@ void CudaEvaluator::set_occlusion_probabilities(const float* occlusion_probabili
 }
 
 
-void CudaEvaluator::map_texture_to_texture_array(const cudaArray_t texture_array) {
+void CudaEvaluator::set_occlusion_probabilities(const int state_id,
+                                                const float* occlusion_probabilities) {
+    if (!memory_allocated_ || state_id < 0 || state_id >= max_nr_poses_) {
+        std::cout << "ERROR (CUDA) in set_occlusion_probabilities: There is no "
+                  << "state " << state_id << "." << std::endl;
+        exit(-1);
+    }
+
+    pull_slot_images();
+    int nr_pixels = nr_rows_ * nr_cols_;
+    int offset = slot_images_[state_id] * nr_pixels;
+    if (half_precision_occlusions_) {
+        cudaMemcpy(d_occlusion_image_, occlusion_probabilities, nr_pixels * sizeof(float), cudaMemcpyHostToDevice);
+        convert_occlusions_kernel <<< cuda_device_properties_.multiProcessorCount, nr_threads_ >>> (
+            d_occlusion_image_, d_half_occlusion_probs_ + offset, nr_pixels);
+    } else {
+        cudaMemcpy(d_occlusion_probs_ + offset, occlusion_probabilities, nr_pixels * sizeof(float), cudaMemcpyHostToDevice);
+    }
+
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy occlusion_probabilities -> d_occlusion_probs_");
+    #endif
+    cudaDeviceSynchronize();
+}
+
+
+void CudaEvaluator::shift_occlusions(const int row_offset, const int col_offset) {
+    if (!memory_allocated_) {
+        std::cout << "ERROR (CUDA): You need to call allocate_memory_for_max_poses before "
+                  << "calling shift_occlusions." << std::endl;
+        exit(-1);
+    }
+    if (row_offset == 0 && col_offset == 0) return;
+
+    // all images are shifted, including those of unused slots
+    const size_t row_size = nr_cols_ * sizeof(float);
+    if (half_precision_occlusions_) {
+        shift_occlusions_kernel <<< max_nr_poses_, nr_threads_, row_size, stream_ >>> (
+            d_half_occlusion_probs_, nr_rows_, nr_cols_, row_offset, col_offset,
+            parameters_.initial_occlusion_prob);
+    } else {
+        shift_occlusions_kernel <<< max_nr_poses_, nr_threads_, row_size, stream_ >>> (
+            d_occlusion_probs_, nr_rows_, nr_cols_, row_offset, col_offset,
+            parameters_.initial_occlusion_prob);
+    }
+    #ifdef DEBUG
+        check_cuda_error("shift_occlusions_kernel call");
+    #endif
+}
+
+
+void CudaEvaluator::map_texture_to_texture_array(const cudaArray_t texture_array,
+                                                 const int texture_nr) {
+
+    // the mapped array may change between frames, so the texture object is
+    // recreated for every mapping
+    if (texture_objects_[texture_nr] != 0) {
+        cudaDestroyTextureObject(texture_objects_[texture_nr]);
+        texture_objects_[texture_nr] = 0;
+    }
+
+    // the kernels read layered textures with tex2DLayered, which needs the
+    // whole array texture instead of one of its layers
+    if (layered_textures_) {
+        cudaChannelFormatDesc format;
+        cudaExtent extent;
+        unsigned int flags = 0;
+        cudaArrayGetInfo(&format, &extent, &flags, texture_array);
+        if (!(flags & cudaArrayLayered)) {
+            std::cout << "ERROR (CUDA): The mapped texture is not layered." << std::endl;
+            exit(-1);
+        }
+    }
+
+    cudaResourceDesc resource_description;
+    memset(&resource_description, 0, sizeof(resource_description));
+    resource_description.resType = cudaResourceTypeArray;
+    resource_description.res.array.array = texture_array;
+
+    cudaTextureDesc texture_description;
+    memset(&texture_description, 0, sizeof(texture_description));
+    texture_description.addressMode[0] = cudaAddressModeClamp;
+    texture_description.addressMode[1] = cudaAddressModeClamp;
+    texture_description.filterMode = cudaFilterModePoint;
+    texture_description.readMode = cudaReadModeElementType;
+    texture_description.normalizedCoords = 0;
 
-    d_texture_array_ = texture_array;
-    cudaBindTextureToArray(texture_reference, d_texture_array_);
+    cudaCreateTextureObject(&texture_objects_[texture_nr], &resource_description, &texture_description, NULL);
 
     #ifdef DEBUG
-        check_cuda_error("cudaBindTextureToArray");
+        check_cuda_error("cudaCreateTextureObject");
     #endif
 
     texture_array_mapped_ = true;
@@ -557,12 +1735,13 @@ void CudaEvaluator::allocate_memory_for_max_poses(int nr_poses,
                                                   int nr_poses_per_row,
                                                   int nr_poses_per_col) {
     if (constants_initialized_) {
+        clear_graphs();
 
         // check limitation by global memory size
         int constant_need, per_pose_need;
         get_memory_need_parameters(nr_rows_, nr_cols_,
                                    constant_need, per_pose_need);
-        int memory_needs = constant_need + nr_poses * per_pose_need;
+        size_t memory_needs = constant_need + size_t(nr_poses) * per_pose_need;
 
         if (memory_needs > cuda_device_properties_.totalGlobalMem) {
             std::cout << "ERROR (CUDA): Not enough memory to allocate " << nr_poses
@@ -571,10 +1750,7 @@ void CudaEvaluator::allocate_memory_for_max_poses(int nr_poses,
         }
 
         // check limitation by texture and grid size
-        if (nr_poses_per_row * nr_cols_ > cuda_device_properties_.maxTexture2D[0] ||
-            nr_poses_per_col * nr_rows_ > cuda_device_properties_.maxTexture2D[1] ||
-            nr_poses_per_row > cuda_device_properties_.maxGridSize[0] ||
-            nr_poses_per_col > cuda_device_properties_.maxGridSize[1]) {
+        if (!fits_texture_and_grid(nr_poses, nr_poses_per_row, nr_poses_per_col)) {
             std::cout << "ERROR (CUDA): Exceeding maximum texture or grid size with"
                       << nr_poses_per_row << " x " << nr_poses_per_col << " poses"
                       << " at resolution " << nr_rows_ << " x " << nr_cols_ << std::endl;
@@ -585,24 +1761,45 @@ void CudaEvaluator::allocate_memory_for_max_poses(int nr_poses,
         max_nr_poses_per_row_ = nr_poses_per_row;
         max_nr_poses_per_column_ = nr_poses_per_col;
 
-        grid_dimension_ = dim3(nr_poses_per_row, nr_poses_per_col);
+        grid_dimension_ = batch_grid_dimension(nr_poses);
 
 
         // reallocate arrays
         allocate(d_log_likelihoods_, sizeof(float) * max_nr_poses_);
-        allocate(d_occlusion_indices_, sizeof(int) * max_nr_poses_);
+        allocate(d_pose_images_, sizeof(int) * max_nr_poses_);
+        allocate(d_copy_jobs_, 2 * sizeof(int) * max_nr_poses_);
+        allocate(d_bounding_boxes_, 4 * sizeof(int) * max_nr_poses_);
         occlusion_probs_size_ = nr_rows_ * nr_cols_ * max_nr_poses_;
-        allocate(d_occlusion_probs_, occlusion_probs_size_ * sizeof(float));
-        allocate(d_occlusion_probs_copy_, occlusion_probs_size_ * sizeof(float));
+        if (half_precision_occlusions_) {
+            allocate(d_half_occlusion_probs_, occlusion_probs_size_ * sizeof(__half));
+            allocate(d_occlusion_image_, nr_rows_ * nr_cols_ * sizeof(float));
+        } else {
+            allocate(d_occlusion_probs_, occlusion_probs_size_ * sizeof(float));
+        }
+        reset_occlusion_images();
+        allocate_resampling_buffers();
         observations_size_ = nr_rows_ * nr_cols_;
         allocate(d_observations_, observations_size_ * sizeof(float));
-
-        vector<float> initial_occlusion_probs (nr_rows_ * nr_cols_ * max_nr_poses_,
-                                               occlusion_prob_default_);
-
-        cudaMemcpy(d_occlusion_probs_, &initial_occlusion_probs[0], occlusion_probs_size_ * sizeof(float), cudaMemcpyHostToDevice);
+        allocate(d_next_observations_, observations_size_ * sizeof(float));
+        allocate(d_valid_cols_, observations_size_ * sizeof(int));
+        allocate(d_next_valid_cols_, observations_size_ * sizeof(int));
+        allocate(d_valid_counts_, nr_rows_ * sizeof(int));
+        allocate(d_next_valid_counts_, nr_rows_ * sizeof(int));
+
+        allocate_host(h_observations_, observations_size_ * sizeof(float));
+        allocate_host(h_log_likelihoods_, sizeof(float) * max_nr_poses_);
+        allocate_host(h_pose_images_, sizeof(int) * max_nr_poses_);
+        allocate_host(h_copy_jobs_, 2 * sizeof(int) * max_nr_poses_);
+        allocate_host(h_bounding_boxes_, 4 * sizeof(int) * max_nr_poses_);
+
+        int nr_blocks = cuda_device_properties_.multiProcessorCount;
+        if (half_precision_occlusions_) {
+            fill_occlusions_kernel <<< nr_blocks, nr_threads_ >>> (d_half_occlusion_probs_, occlusion_prob_default_, occlusion_probs_size_);
+        } else {
+            fill_occlusions_kernel <<< nr_blocks, nr_threads_ >>> (d_occlusion_probs_, occlusion_prob_default_, occlusion_probs_size_);
+        }
         #ifdef DEBUG
-            check_cuda_error("cudaMemcpy occlusion_prob_default_ -> d_occlusion_probs_");
+            check_cuda_error("fill_occlusions_kernel occlusion_prob_default_ -> d_occlusion_probs_");
         #endif
 
         // initialize log likelihoods with 0
@@ -625,6 +1822,96 @@ void CudaEvaluator::allocate_memory_for_max_poses(int nr_poses,
 }
 
 
+bool CudaEvaluator::grow_memory_for_max_poses(int nr_poses,
+                                              int nr_poses_per_row,
+                                              int nr_poses_per_col) {
+    if (!memory_allocated_) {
+        allocate_memory_for_max_poses(nr_poses, nr_poses_per_row, nr_poses_per_col);
+        return true;
+    }
+    if (nr_poses <= max_nr_poses_) return true;
+
+    if (!fits_texture_and_grid(nr_poses, nr_poses_per_row, nr_poses_per_col)) {
+        return false;
+    }
+
+    // the pending evaluations still read the current buffers
+    cudaStreamSynchronize(stream_);
+    cudaStreamSynchronize(upload_stream_);
+
+    // the depth layers are rendered again for the new number of poses
+    free_depth_layers();
+    clear_graphs();
+
+    int constant_need, per_pose_need;
+    get_memory_need_parameters(nr_rows_, nr_cols_, constant_need, per_pose_need);
+    size_t free_memory, total_memory;
+    cudaMemGetInfo(&free_memory, &total_memory);
+    if (size_t(nr_poses - max_nr_poses_) * per_pose_need > free_memory) return false;
+
+    // the occlusion images are allocated first, since they are by far the
+    // largest buffer. Images keep their index, the new ones come after them.
+    const size_t nr_pixels = size_t(nr_rows_) * nr_cols_;
+    const size_t old_size = occlusion_probs_size_;
+    const size_t new_size = nr_pixels * nr_poses;
+    const int nr_blocks = cuda_device_properties_.multiProcessorCount;
+    if (half_precision_occlusions_) {
+        __half* occlusions = NULL;
+        if (cudaMalloc((void **) &occlusions, new_size * sizeof(__half)) != cudaSuccess) {
+            cudaGetLastError();
+            return false;
+        }
+        cudaMemcpyAsync(occlusions, d_half_occlusion_probs_, old_size * sizeof(__half),
+                        cudaMemcpyDeviceToDevice, stream_);
+        fill_occlusions_kernel <<< nr_blocks, nr_threads_, 0, stream_ >>> (occlusions + old_size, occlusion_prob_default_, new_size - old_size);
+        cudaStreamSynchronize(stream_);
+        cudaFree(d_half_occlusion_probs_);
+        d_half_occlusion_probs_ = occlusions;
+    } else {
+        float* occlusions = NULL;
+        if (cudaMalloc((void **) &occlusions, new_size * sizeof(float)) != cudaSuccess) {
+            cudaGetLastError();
+            return false;
+        }
+        cudaMemcpyAsync(occlusions, d_occlusion_probs_, old_size * sizeof(float),
+                        cudaMemcpyDeviceToDevice, stream_);
+        fill_occlusions_kernel <<< nr_blocks, nr_threads_, 0, stream_ >>> (occlusions + old_size, occlusion_prob_default_, new_size - old_size);
+        cudaStreamSynchronize(stream_);
+        cudaFree(d_occlusion_probs_);
+        d_occlusion_probs_ = occlusions;
+    }
+    #ifdef DEBUG
+        check_cuda_error("grow_memory_for_max_poses occlusions");
+    #endif
+    occlusion_probs_size_ = new_size;
+
+    pull_slot_images();
+    for (int slot = max_nr_poses_; slot < nr_poses; slot++) {
+        slot_images_.push_back(slot);
+    }
+
+    max_nr_poses_ = nr_poses;
+    max_nr_poses_per_row_ = nr_poses_per_row;
+    max_nr_poses_per_column_ = nr_poses_per_col;
+    grid_dimension_ = batch_grid_dimension(nr_poses);
+
+    // the buffers per pose only hold the data of a single call
+    allocate(d_log_likelihoods_, sizeof(float) * max_nr_poses_);
+    allocate(d_pose_images_, sizeof(int) * max_nr_poses_);
+    allocate(d_copy_jobs_, 2 * sizeof(int) * max_nr_poses_);
+    allocate(d_bounding_boxes_, 4 * sizeof(int) * max_nr_poses_);
+    allocate_host(h_log_likelihoods_, sizeof(float) * max_nr_poses_);
+    allocate_host(h_pose_images_, sizeof(int) * max_nr_poses_);
+    allocate_host(h_copy_jobs_, 2 * sizeof(int) * max_nr_poses_);
+    allocate_host(h_bounding_boxes_, 4 * sizeof(int) * max_nr_poses_);
+    cudaMemset(d_log_likelihoods_, 0, sizeof(float) * max_nr_poses_);
+    allocate_resampling_buffers();
+
+    return cudaGetLastError() == cudaSuccess;
+}
+
+
+
 void CudaEvaluator::set_number_of_poses(int nr_poses) {
     if (memory_allocated_) {
         if (nr_poses > max_nr_poses_) {
@@ -635,11 +1922,7 @@ void CudaEvaluator::set_number_of_poses(int nr_poses) {
         }
 
         nr_poses_ = nr_poses;
-        int nr_poses_per_row = min(max_nr_poses_per_row_, nr_poses);
-        int nr_poses_per_column = min(max_nr_poses_per_column_,
-                                   (int) ceil(nr_poses / (float) nr_poses_per_row));
-
-        grid_dimension_ = dim3(nr_poses_per_row, nr_poses_per_column);
+        grid_dimension_ = batch_grid_dimension(nr_poses);
 
         number_of_poses_set_ = true;
     } else {
@@ -678,15 +1961,26 @@ cudaDeviceProp CudaEvaluator::get_device_properties() {
 
 void CudaEvaluator::get_memory_need_parameters(int nr_rows, int nr_cols,
                                 int& constant_need, int& per_pose_need) {
-    constant_need = nr_rows * nr_cols * sizeof(float);
-    per_pose_need = (3 + 2 * nr_rows * nr_cols) * sizeof(float);
+    // two observation buffers and a conversion image, and per pose one
+    // occlusion image, the likelihood, the image index, a copy job and the
+    // bounding box
+    size_t occlusion_size = half_precision_occlusions_ ? sizeof(__half) : sizeof(float);
+    constant_need = 3 * nr_rows * nr_cols * sizeof(float);
+    per_pose_need = nr_rows * nr_cols * occlusion_size + sizeof(float) + 7 * sizeof(int);
 }
 
 vector<float> CudaEvaluator::get_occlusion_probabilities(int state_id) {
     if (memory_allocated_) {
+        pull_slot_images();
         float* occlusion_probabilities = (float*) malloc(nr_rows_ * nr_cols_ * sizeof(float));
-        int offset = state_id * nr_rows_ * nr_cols_;
-        cudaMemcpy(occlusion_probabilities, d_occlusion_probs_ + offset, nr_rows_ * nr_cols_ * sizeof(float), cudaMemcpyDeviceToHost);
+        int offset = slot_images_[state_id] * nr_rows_ * nr_cols_;
+        if (half_precision_occlusions_) {
+            convert_occlusions_kernel <<< cuda_device_properties_.multiProcessorCount, nr_threads_ >>> (
+                d_half_occlusion_probs_ + offset, d_occlusion_image_, nr_rows_ * nr_cols_);
+            cudaMemcpy(occlusion_probabilities, d_occlusion_image_, nr_rows_ * nr_cols_ * sizeof(float), cudaMemcpyDeviceToHost);
+        } else {
+            cudaMemcpy(occlusion_probabilities, d_occlusion_probs_ + offset, nr_rows_ * nr_cols_ * sizeof(float), cudaMemcpyDeviceToHost);
+        }
 
         #ifdef DEBUG
             check_cuda_error("cudaMemcpy d_occlusion_probabilities -> occlusion_probabilities");
@@ -717,6 +2011,191 @@ vector<float> CudaEvaluator::get_occlusion_probabilities(int state_id) {
 
 
 
+void CudaEvaluator::reset_occlusion_images() {
+    slot_images_.resize(max_nr_poses_);
+    for (int i = 0; i < max_nr_poses_; i++) {
+        slot_images_[i] = i;
+    }
+    slot_images_on_device_ = false;
+    ancestors_on_device_ = false;
+}
+
+
+
+void CudaEvaluator::allocate_resampling_buffers() {
+    allocate(d_log_weights_, sizeof(float) * max_nr_poses_);
+    allocate(d_cdf_, sizeof(float) * max_nr_poses_);
+    allocate(d_ancestors_, sizeof(int) * max_nr_poses_);
+    allocate(d_occlusion_indices_, sizeof(int) * max_nr_poses_);
+    allocate(d_next_occlusion_indices_, sizeof(int) * max_nr_poses_);
+    allocate(d_slot_images_, sizeof(int) * max_nr_poses_);
+    allocate(d_is_parent_, sizeof(int) * max_nr_poses_);
+    allocate(d_free_images_, sizeof(int) * max_nr_poses_);
+    allocate(d_nr_copies_, sizeof(int));
+    cudaMemset(d_log_weights_, 0, sizeof(float) * max_nr_poses_);
+    #ifdef DEBUG
+        check_cuda_error("allocate_resampling_buffers");
+    #endif
+
+    // the slot images are uploaded again with the next weighting
+    slot_images_on_device_ = false;
+    ancestors_on_device_ = false;
+    nr_resampled_poses_ = 0;
+}
+
+
+
+void CudaEvaluator::pull_slot_images() {
+    if (!slot_images_on_device_) return;
+
+    cudaStreamSynchronize(stream_);
+    cudaMemcpy(slot_images_.data(), d_slot_images_, max_nr_poses_ * sizeof(int), cudaMemcpyDeviceToHost);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpy d_slot_images -> slot_images");
+    #endif
+    slot_images_on_device_ = false;
+}
+
+
+
+void CudaEvaluator::assign_occlusion_images(const bool update_occlusions) {
+    if (device_resampling_) {
+        // the pinned buffers may still be read by the previous upload
+        cudaEventSynchronize(pose_images_uploaded_);
+
+        // the indices of set_occlusion_indices() are uploaded unless the
+        // ancestors of the last resampling provide them
+        upload_occlusion_indices_ = !ancestors_on_device_ || nr_resampled_poses_ != nr_poses_;
+        ancestors_on_device_ = false;
+        if (upload_occlusion_indices_) {
+            if (int(occlusion_indices_.size()) < nr_poses_) {
+                std::cout << "ERROR (CUDA): There are fewer occlusion indices ("
+                          << occlusion_indices_.size() << ") than poses ("
+                          << nr_poses_ << ")." << std::endl;
+                exit(-1);
+            }
+            std::copy(occlusion_indices_.begin(), occlusion_indices_.begin() + nr_poses_, h_pose_images_);
+        }
+        if (!slot_images_on_device_) {
+            cudaMemcpy(d_slot_images_, slot_images_.data(), max_nr_poses_ * sizeof(int), cudaMemcpyHostToDevice);
+            #ifdef DEBUG
+                check_cuda_error("cudaMemcpy slot_images -> d_slot_images");
+            #endif
+            slot_images_on_device_ = true;
+        }
+
+        // the number of copies is only known on the device, the copy kernel
+        // is launched with a block per pose
+        nr_copies_ = update_occlusions ? nr_poses_ : 0;
+        return;
+    }
+
+    if (int(occlusion_indices_.size()) < nr_poses_) {
+        std::cout << "ERROR (CUDA): There are fewer occlusion indices ("
+                  << occlusion_indices_.size() << ") than poses ("
+                  << nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    // the pinned buffers may still be read by the previous upload
+    cudaEventSynchronize(pose_images_uploaded_);
+
+    int nr_copies = 0;
+
+    if (!update_occlusions) {
+        for (int i = 0; i < nr_poses_; i++) {
+            h_pose_images_[i] = slot_images_[occlusion_indices_[i]];
+        }
+    } else {
+        // the images of slots which are no parent are free for copies
+        is_parent_.assign(max_nr_poses_, false);
+        for (int i = 0; i < nr_poses_; i++) {
+            is_parent_[occlusion_indices_[i]] = true;
+        }
+        free_images_.clear();
+        for (int slot = 0; slot < max_nr_poses_; slot++) {
+            if (!is_parent_[slot]) free_images_.push_back(slot_images_[slot]);
+        }
+
+        // the first child of a parent takes over its image and updates it in
+        // place, only further children get a copy
+        for (int i = 0; i < nr_poses_; i++) {
+            int parent = occlusion_indices_[i];
+            if (is_parent_[parent]) {
+                h_pose_images_[i] = slot_images_[parent];
+                is_parent_[parent] = false;
+            } else {
+                h_pose_images_[i] = free_images_.back();
+                free_images_.pop_back();
+                h_copy_jobs_[2 * nr_copies] = slot_images_[parent];
+                h_copy_jobs_[2 * nr_copies + 1] = h_pose_images_[i];
+                nr_copies++;
+            }
+        }
+
+        // after the update, pose i is stored in slot i
+        for (int i = 0; i < nr_poses_; i++) {
+            slot_images_[i] = h_pose_images_[i];
+        }
+        for (int slot = nr_poses_; slot < max_nr_poses_; slot++) {
+            slot_images_[slot] = free_images_.back();
+            free_images_.pop_back();
+        }
+    }
+
+    nr_copies_ = nr_copies;
+}
+
+
+
+void CudaEvaluator::enqueue_occlusion_images() {
+    const int nr_copies = nr_copies_;
+
+    if (device_resampling_) {
+        if (upload_occlusion_indices_) {
+            cudaMemcpyAsync(d_occlusion_indices_, h_pose_images_, nr_poses_ * sizeof(int),
+                            cudaMemcpyHostToDevice, stream_);
+        }
+        assign_occlusion_images_kernel <<< 1, 1, 0, stream_ >>> (d_occlusion_indices_, nr_poses_, max_nr_poses_,
+                                                               update_occlusions_, d_slot_images_, d_is_parent_,
+                                                               d_free_images_, d_pose_images_, d_copy_jobs_,
+                                                               d_nr_copies_);
+        if (nr_copies > 0) {
+            if (half_precision_occlusions_) {
+                copy_occlusions_kernel <<< nr_copies, nr_threads_, 0, stream_ >>> (d_half_occlusion_probs_, d_copy_jobs_, nr_rows_ * nr_cols_, d_nr_copies_);
+            } else {
+                copy_occlusions_kernel <<< nr_copies, nr_threads_, 0, stream_ >>> (d_occlusion_probs_, d_copy_jobs_, nr_rows_ * nr_cols_, d_nr_copies_);
+            }
+        }
+        #ifdef DEBUG
+            check_cuda_error("assign_occlusion_images_kernel call");
+        #endif
+        return;
+    }
+
+    cudaMemcpyAsync(d_pose_images_, h_pose_images_, nr_poses_ * sizeof(int),
+                    cudaMemcpyHostToDevice, stream_);
+    #ifdef DEBUG
+        check_cuda_error("cudaMemcpyAsync h_pose_images -> d_pose_images");
+    #endif
+
+    // the copies read the parent images before they are updated in place
+    if (nr_copies > 0) {
+        cudaMemcpyAsync(d_copy_jobs_, h_copy_jobs_, 2 * nr_copies * sizeof(int),
+                        cudaMemcpyHostToDevice, stream_);
+        if (half_precision_occlusions_) {
+            copy_occlusions_kernel <<< nr_copies, nr_threads_, 0, stream_ >>> (d_half_occlusion_probs_, d_copy_jobs_, nr_rows_ * nr_cols_, NULL);
+        } else {
+            copy_occlusions_kernel <<< nr_copies, nr_threads_, 0, stream_ >>> (d_occlusion_probs_, d_copy_jobs_, nr_rows_ * nr_cols_, NULL);
+        }
+        #ifdef DEBUG
+            check_cuda_error("copy_occlusions_kernel call");
+        #endif
+    }
+}
+
+
+
 template <typename T> void CudaEvaluator::allocate(T * &pointer, size_t size) {
     cudaFree(pointer);
     cudaMalloc((void **) &pointer, size);
@@ -727,6 +2206,19 @@ template <typename T> void CudaEvaluator::allocate(T * &pointer, size_t size) {
 
 
 
+template <typename T> void CudaEvaluator::allocate_host(T * &pointer, size_t size) {
+    // pending transfers of this evaluator may still read from the old buffer
+    cudaStreamSynchronize(stream_);
+    cudaStreamSynchronize(upload_stream_);
+    cudaFreeHost(pointer);
+    cudaMallocHost((void **) &pointer, size);
+#ifdef DEBUG
+    check_cuda_error("cudaMallocHost failed");
+#endif
+}
+
+
+
 void CudaEvaluator::check_cuda_error(const char *msg)
 {
     cudaError_t err = cudaGetLastError();
@@ -745,11 +2237,52 @@ void CudaEvaluator::check_cuda_error(const char *msg)
 
 
 CudaEvaluator::~CudaEvaluator() {
+    clear_graphs();
+    for (int i = 0; i < NR_TEXTURES; i++) {
+        if (texture_objects_[i] != 0) cudaDestroyTextureObject(texture_objects_[i]);
+    }
     cudaFree(d_occlusion_probs_);
-    cudaFree(d_occlusion_probs_copy_);
+    cudaFree(d_half_occlusion_probs_);
+    cudaFree(d_occlusion_image_);
     cudaFree(d_observations_);
+    cudaFree(d_next_observations_);
+    cudaFree(d_native_observations_);
+    cudaFree(d_valid_cols_);
+    cudaFree(d_next_valid_cols_);
+    cudaFree(d_valid_counts_);
+    cudaFree(d_next_valid_counts_);
     cudaFree(d_log_likelihoods_);
+    cudaFree(d_pose_images_);
+    cudaFree(d_copy_jobs_);
+    cudaFree(d_bounding_boxes_);
+    cudaFree(d_log_weights_);
+    cudaFree(d_cdf_);
+    cudaFree(d_ancestors_);
     cudaFree(d_occlusion_indices_);
-    cudaDeviceReset();
+    cudaFree(d_next_occlusion_indices_);
+    cudaFree(d_slot_images_);
+    cudaFree(d_is_parent_);
+    cudaFree(d_free_images_);
+    cudaFree(d_nr_copies_);
+    cudaFree(d_states_);
+    cudaFree(d_mean_);
+    free_depth_layers();
+    cudaFree(d_depth_layer_sources_);
+    cudaFreeHost(h_depth_layer_sources_);
+    cudaFreeHost(h_observations_);
+    cudaFreeHost(h_native_observations_);
+    cudaFreeHost(h_log_likelihoods_);
+    cudaFreeHost(h_pose_images_);
+    cudaFreeHost(h_copy_jobs_);
+    cudaFreeHost(h_bounding_boxes_);
+    cudaFreeHost(h_states_);
+    cudaFreeHost(h_mean_);
+    cudaEventDestroy(observations_uploaded_);
+    cudaEventDestroy(observations_released_);
+    cudaEventDestroy(pose_images_uploaded_);
+    cudaEventDestroy(depth_layer_sources_uploaded_);
+    cudaStreamDestroy(stream_);
+    cudaStreamDestroy(upload_stream_);
+    // no cudaDeviceReset(), other evaluators may still be using the device
 }
 
@@ -29,9 +29,36 @@
 
 #pragma once
 
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
 #include <curand_kernel.h>
+#include <map>
 #include <vector>
 
+/**
+ * \brief Constants of the observation model, precomputed by
+ *        CudaEvaluator::init() and passed to the kernels by value
+ */
+struct CudaModelParameters
+{
+    // used in propagate_occlusion
+    float p_occluded_occluded;
+    float one_div_c_minus_one;
+    float log_c;
+
+    // used in prob
+    float one_minus_tail_weight;
+    float model_sigma;
+    float sigma_factor;
+    float tail_weight_div_max_depth;
+    float exponential_rate;
+    float one_div_sqrt_of_two;
+    float one_div_sqrt_of_two_pi;
+
+    // used in compare
+    float initial_occlusion_prob;
+};
+
 /**
  * \brief This class provides a parallel implementation of the weighting step on
  *        the GPU.
@@ -51,6 +78,9 @@
  *  update the observation image with set_observations() and update the
  * occlusion indices (after resampling)
  *  before you call the weigh_poses() function.
+ *
+ * All state lives in the instance, such that several evaluators with
+ * different parameters and resolutions can share one device.
  */
 class CudaEvaluator
 {
@@ -62,8 +92,19 @@ public:
      *     The number of rows in each camera image
      * \param [in] nr_cols
      *     The number of columns in each camera image
+     * \param [in] half_precision_occlusions
+     *     Store the occlusion probabilities as 16 bit floats, which halves
+     *     their memory and allows about twice as many poses. The kernels
+     *     compute in single precision.
+     * \param [in] device
+     *     The CUDA device to run on, which has to be the device of the OpenGL
+     *     context rendering the poses. If negative, a device with compute
+     *     capability 2.0 is chosen.
      */
-    CudaEvaluator(const int nr_rows, const int nr_cols);
+    CudaEvaluator(const int nr_rows,
+                  const int nr_cols,
+                  const bool half_precision_occlusions = false,
+                  const int device = -1);
 
     /**
      * \brief Destructor which frees the memory used on the GPU
@@ -120,6 +161,149 @@ public:
     void weigh_poses(const bool update_occlusions,
                      std::vector<float>& log_likelihoods);
 
+    /**
+     * \brief Starts the weighting of poses which are rendered in one or more
+     *        batches, see weigh_batch() and end_weighting()
+     *
+     * \param [in] update_occlusions
+     *     Whether or not to update the occlusion probabilities during this
+     *     weighting
+     * \param [in] from_textures
+     *     false if the depths are passed to weigh_depth_images() instead of
+     *     being read from mapped textures
+     * \return false if one of the preconditions of weigh_poses() is not met
+     */
+    bool begin_weighting(const bool update_occlusions,
+                         const bool from_textures = true);
+
+    /**
+     * \brief Enqueues the weighting of a batch of poses on the evaluation
+     *        stream and returns without waiting for it
+     *
+     * The batch has to be rendered into the texture previously mapped with
+     * map_texture_to_texture_array() under the given texture number. Its poses
+     * are tiled in the texture starting with the first tile.
+     *
+     * \param [in] texture_nr the texture the batch was rendered into
+     * \param [in] first_pose the index of the first pose of the batch
+     * \param [in] nr_poses the number of poses in the batch
+     * \param [in] bounding_boxes [pose_nr][0 - 3] = {col_min, row_min,
+     * col_max, row_max} for each pose of the batch, see
+     * ObjectRasterizer::get_bounding_boxes(). Only the pixels inside the box
+     * are compared, the occlusions outside of it are propagated in time. If
+     * NULL, all pixels are compared.
+     */
+    void weigh_batch(const int texture_nr,
+                     const int first_pose,
+                     const int nr_poses,
+                     const int* bounding_boxes = NULL);
+
+    /**
+     * \brief Allocates two generations of depth layers, i.e. one image per
+     *        object and pose holding the depth of the object alone, for the
+     *        maximum number of poses
+     *
+     * The layers of the previous allocation are freed.
+     *
+     * \param [in] nr_objects the number of objects
+     * \return false if there is not enough memory, no layers are allocated
+     * then
+     */
+    bool allocate_depth_layers(const int nr_objects);
+
+    /**
+     * \brief The number of poses the depth layers were allocated for, 0 if
+     *        there are none
+     */
+    int get_depth_layer_poses() const;
+
+    /**
+     * \brief Makes the current generation of depth layers the previous one.
+     *        The layers of the new current generation are undefined until
+     *        they are stored or gathered.
+     */
+    void swap_depth_layers();
+
+    /**
+     * \brief Enqueues copying the depths of the first nr_poses poses of the
+     *        texture mapped under texture_nr, into which the object was
+     *        rendered alone, to its layers of the current generation
+     */
+    void store_depth_layer(const int texture_nr,
+                           const int object_nr,
+                           const int nr_poses);
+
+    /**
+     * \brief Enqueues copying depth layers of the previous generation to the
+     *        current one
+     *
+     * \param [in] sources [object_nr * nr_poses + pose_nr] = {the pose of the
+     * previous generation whose layer of the object is copied to pose_nr},
+     * negative for layers which are stored instead
+     * \param [in] nr_poses the number of poses of the current generation
+     */
+    void gather_depth_layers(const int* sources, const int nr_poses);
+
+    /**
+     * \brief Like weigh_batch(), but the depth of each pose is the closest
+     *        depth of its layers of the current generation instead of a
+     *        texture
+     */
+    void weigh_depth_layers(const int first_pose,
+                            const int nr_poses,
+                            const int* bounding_boxes = NULL);
+
+    /**
+     * \brief Like weigh_batch(), but the depths are read from device memory,
+     *        e.g. as rendered by CudaRasterizer on the evaluation stream
+     *
+     * \param [in] depth_images [pose_nr * nr_rows * nr_cols + pixel_nr] =
+     * {depth} of all poses of the weighting, not only of the batch. A depth
+     * of 0 is no intersection.
+     */
+    void weigh_depth_images(const float* depth_images,
+                            const int first_pose,
+                            const int nr_poses,
+                            const int* bounding_boxes = NULL);
+
+    /**
+     * \brief Waits for all enqueued batches and reads back their likelihoods
+     *
+     * \param [out] log_likelihoods
+     *     The computed likelihoods for each pose
+     */
+    void end_weighting(std::vector<float>& log_likelihoods);
+
+    /**
+     * \brief Launches the CUDA work of the weighting as CUDA graphs
+     *
+     * The work between two texture mappings, i.e. the upload of the
+     * occlusion images with the first batch, the evaluation of a batch and
+     * the read back of the likelihoods after the last batch, is captured
+     * from the stream into a graph. The graph of each position in the
+     * weighting is instantiated once per configuration and afterwards only
+     * updated with the pointers and parameters of the current weighting,
+     * which saves the launch overhead of the single calls. Reallocations
+     * and changes of the number of threads discard the instances. Other
+     * threads must not use the legacy default stream meanwhile, which
+     * would invalidate the capture. Requires CUDA 11.4, otherwise or if a
+     * capture fails the work is enqueued directly.
+     */
+    void set_graph_capture(const bool enabled);
+
+    /**
+     * \brief Whether the weighting is launched as CUDA graphs, see
+     *        set_graph_capture()
+     */
+    bool get_graph_capture() const;
+
+    /**
+     * \brief The stream all weighting work is enqueued on. Mapping and
+     * unmapping the rendered textures on this stream keeps them ordered with
+     * the weighting without blocking the CPU.
+     */
+    cudaStream_t get_stream();
+
     // setters
 
     /**
@@ -136,12 +320,45 @@ public:
      * \brief Copies the observation image from the camera to the GPU for
      * comparison
      *
+     * The image is uploaded asynchronously into the second of two observation
+     * buffers, such that the upload overlaps with the evaluation of the
+     * previous image. The valid, i.e. not NaN, pixels are listed once per
+     * image, such that the weighting only visits them.
+     *
      * \param [in] observations a pointer to the observation values
      * \param [in] observation_time the time at which this observation was
      * captured
+     * \param [in] page_locked whether the observations are in page locked
+     * memory, see allocate_page_locked_depth_frame(). They are then uploaded
+     * from there without a copy into the staging buffer and must not change
+     * until the next observations are set.
      */
     void set_observations(const float* observations,
-                          const float observation_time);
+                          const float observation_time,
+                          const bool page_locked = false);
+
+    /**
+     * \brief Uploads an observation image at an integer multiple of the
+     * resolution and downsamples it on the GPU
+     *
+     * Invalid depths, i.e. NaN, infinite or not positive ones, are ignored
+     * by the pooling, pixels without any valid depth become NaN.
+     *
+     * \param [in] observations the native image, row by row
+     * \param [in] native_rows the number of rows of the native image
+     * \param [in] native_cols the number of columns of the native image
+     * \param [in] pooling a dbot::DepthDownsampler::Pooling value. The
+     * median supports factors of up to 8.
+     * \param [in] observation_time the time at which this observation was
+     * captured
+     * \param [in] page_locked as for set_observations()
+     */
+    void set_native_observations(const float* observations,
+                                 const int native_rows,
+                                 const int native_cols,
+                                 const int pooling,
+                                 const float observation_time,
+                                 const bool page_locked = false);
 
     /**
      * \brief Sets the indices to the occlusion array for every state
@@ -154,6 +371,60 @@ public:
     void set_occlusion_indices(const int* occlusion_indices,
                                const int array_size);
 
+    /**
+     * \brief Enables the resampling of the poses on the device, see
+     * resample_poses()
+     *
+     * The likelihoods of a weighting then stay in device memory and
+     * end_weighting() returns them as zeros. The occlusion indices are
+     * resolved to occlusion images on the device. After resample_poses(),
+     * the next weighting takes the occlusion indices of the ancestors from
+     * device memory instead of those of set_occlusion_indices(), which are
+     * only used before the first resampling or if the number of poses
+     * changed.
+     */
+    void set_device_resampling(const bool enabled);
+
+    /// whether the poses are resampled on the device
+    bool get_device_resampling() const;
+
+    /**
+     * \brief Resamples the poses of the last weighting on the device, which
+     * requires set_device_resampling()
+     *
+     * The likelihoods of the weighting are added to the log weights of the
+     * poses, which are normalized. If the KL divergence of the weights from
+     * the uniform distribution exceeds max_kl_divergence, the poses are
+     * resampled systematically and weighted uniformly, otherwise they keep
+     * their weights. The ancestors stay in device memory and provide the
+     * occlusion indices of the next weighting, only the mean of the states
+     * is read back.
+     *
+     * \param [in] states [pose_nr * state_dimension] the states of the
+     * weighted poses
+     * \param [in] state_dimension the number of values of a state
+     * \param [in] max_kl_divergence the KL divergence above which the poses
+     * are resampled
+     * \param [in] uniform a uniform random number in [0, 1), the offset of
+     * the systematic resampling
+     * \param [out] mean state_dimension values, the weighted mean of the
+     * states after the resampling
+     */
+    void resample_poses(const float* states,
+                        const int state_dimension,
+                        const float max_kl_divergence,
+                        const float uniform,
+                        float* mean);
+
+    /**
+     * \brief Reads the ancestors of the last resample_poses() back, for
+     * callers which keep the states on the host
+     *
+     * \param [out] ancestors [pose_nr] = {index}, the weighted pose each
+     * pose was resampled from
+     */
+    void get_ancestors(std::vector<int>& ancestors);
+
     /**
      * \brief Sets the resolution for the images to be compared
      * Be sure to call allocate_memory_for_max_poses afterwards to reallocate
@@ -174,11 +445,50 @@ public:
                                      const int array_size);
 
     /**
-     * \brief Maps the texture array to an actual texture reference
+     * \brief Overwrites the occlusion probabilities of a single state, e.g.
+     * to move a state from another evaluator to this one
+     *
+     * \param [in] state_id the index of the state, as used by
+     * set_occlusion_indices() and get_occlusion_probabilities()
+     * \param [in] occlusion_probabilities nr_rows * nr_cols values
+     */
+    void set_occlusion_probabilities(const int state_id,
+                                     const float* occlusion_probabilities);
+
+    /**
+     * \brief Moves the occlusion probabilities of all states with the
+     * region of interest they belong to, enqueued on the evaluation stream
+     *
+     * Pixel (row, col) takes the probability of pixel (row + row_offset,
+     * col + col_offset), the pixels which enter the region get the initial
+     * occlusion probability.
+     *
+     * \param [in] row_offset the rows the region moved down
+     * \param [in] col_offset the columns the region moved right
+     */
+    void shift_occlusions(const int row_offset, const int col_offset);
+
+    /**
+     * \brief Creates a texture object reading from the texture array
      *
      * \param [in] texture_array the cudaArray retrieved from OpenGL
+     * \param [in] texture_nr which of the NR_TEXTURES texture objects to
+     * create, used to evaluate one texture while the other one is rendered
+     */
+    void map_texture_to_texture_array(const cudaArray_t texture_array,
+                                      const int texture_nr = 0);
+
+    /**
+     * \brief Sets whether the mapped textures are layered, see
+     * ObjectRasterizer::uses_layered_rendering(). Their layers then hold
+     * nr_poses_per_row x nr_poses_per_col poses each, and the number of poses
+     * given to allocate_memory_for_max_poses() may exceed that of one layer.
+     * Has to be set before the memory is allocated.
      */
-    void map_texture_to_texture_array(const cudaArray_t texture_array);
+    void set_layered_textures(const bool layered);
+
+    /// number of textures which can be mapped at the same time
+    static const int NR_TEXTURES = 2;
 
     /**
      * \brief Allocates the maximum amount of memory that will ever be needed by
@@ -197,6 +507,18 @@ public:
                                        int nr_poses_per_row,
                                        int nr_poses_per_col);
 
+    /**
+     * \brief Enlarges the memory to a higher maximum number of poses,
+     * keeping the occlusion probabilities of the current occlusion indices.
+     * The occlusions of the new poses are initialized to the default.
+     *
+     * \return false if the memory could not be allocated, the previous
+     * allocation is kept in that case
+     */
+    bool grow_memory_for_max_poses(int nr_poses,
+                                   int nr_poses_per_row,
+                                   int nr_poses_per_col);
+
     /**
      * \brief Sets the number of poses to be weighted in the next weighting step
      *
@@ -265,24 +587,107 @@ private:
     static const int DEFAULT_NR_THREADS = 128;
 
     // device pointers to arrays stored in global memory on the GPU
+    // pool of max_nr_poses_ occlusion images, only one of them is allocated
+    // depending on the storage precision
     float* d_occlusion_probs_;
-    float* d_occlusion_probs_copy_;
+    __half* d_half_occlusion_probs_;
+    float* d_occlusion_image_;  // single precision staging image for __half
     float* d_observations_;
+    float* d_next_observations_;
+    float* d_native_observations_;  // native image of set_native_observations
+    // columns of the valid observations, row by row at a stride of nr_cols_,
+    // and their number per row, with each of the two observation buffers
+    int* d_valid_cols_;
+    int* d_next_valid_cols_;
+    int* d_valid_counts_;
+    int* d_next_valid_counts_;
     float* d_log_likelihoods_;
-    int* d_occlusion_indices_;  // this contains, for each pose, the index into
-                                // the occlusion probabilities array, which
-                                // contains the occlusion probabilities for that
-                                // particular pose.
+    int* d_pose_images_;  // this contains, for each pose, the index of the
+                          // image in the occlusion probabilities array, which
+                          // contains the occlusion probabilities for that
+                          // particular pose.
+    int* d_copy_jobs_;    // {source, target} image pairs to be copied before
+                          // an update
+    int* d_bounding_boxes_;  // compared pixels of each pose
+    // resampling on the device, see resample_poses(). The occlusion indices
+    // of the current weighting and those of the next one, as well as the
+    // slot images and the scratch buffers of
+    // assign_occlusion_images_kernel.
+    float* d_log_weights_;
+    float* d_cdf_;
+    int* d_ancestors_;
+    int* d_occlusion_indices_;
+    int* d_next_occlusion_indices_;
+    int* d_slot_images_;
+    int* d_is_parent_;
+    int* d_free_images_;
+    int* d_nr_copies_;
+    float* d_states_;
+    float* d_mean_;
+    // two generations of nr_depth_layers_ * depth_layer_poses_ depth
+    // images, object by object, and the sources of gather_depth_layers()
+    float* d_depth_layers_[2];
+    int* d_depth_layer_sources_;
+    int* h_depth_layer_sources_;
+    int nr_depth_layers_;
+    int depth_layer_poses_;
+    int current_depth_layers_;
 
     int occlusion_probs_size_;
     int observations_size_;
-
-    // for OpenGL interop
-    cudaArray_t d_texture_array_;
+    int native_observations_size_;
+
+    // pinned host buffers for asynchronous transfers
+    float* h_observations_;
+    float* h_native_observations_;
+    float* h_log_likelihoods_;
+    int* h_pose_images_;
+    int* h_copy_jobs_;
+    int* h_bounding_boxes_;
+    float* h_states_;
+    float* h_mean_;
+    int states_size_;
+
+    // the weighting runs on stream_, observations are uploaded on
+    // upload_stream_ concurrently
+    cudaStream_t stream_;
+    cudaStream_t upload_stream_;
+    cudaEvent_t observations_uploaded_;
+    cudaEvent_t observations_released_;
+    cudaEvent_t pose_images_uploaded_;
+    cudaEvent_t depth_layer_sources_uploaded_;
+
+    // copy-on-write occlusion images: slot_images_[slot] is the image which
+    // stores the occlusions of the occlusion index slot. An update hands the
+    // image of a parent slot to its first child, such that only the images of
+    // further children are copied.
+    std::vector<int> occlusion_indices_;
+    std::vector<int> slot_images_;
+    std::vector<bool> is_parent_;
+    std::vector<int> free_images_;
+
+    // with the resampling on the device, the slot images are kept in
+    // d_slot_images_ while slot_images_on_device_ is set. The occlusion
+    // indices are uploaded from occlusion_indices_ unless the ancestors of
+    // resample_poses() provide them.
+    bool device_resampling_;
+    bool slot_images_on_device_;
+    bool ancestors_on_device_;
+    bool upload_occlusion_indices_;
+    int nr_resampled_poses_;
+
+    // for OpenGL interop, one texture object per mapped texture
+    cudaTextureObject_t texture_objects_[NR_TEXTURES];
+
+    CudaModelParameters parameters_;
 
     // resolution
     int nr_cols_;
     int nr_rows_;
+    bool half_precision_occlusions_;
+    // whether the textures are 2D arrays with one grid layer per texture
+    // layer
+    bool layered_textures_;
 
     // maximum number of poses and their arrangement in the OpenGL texture
     int max_nr_poses_;
@@ -296,6 +701,35 @@ private:
     int nr_threads_;
     dim3 grid_dimension_;
 
+    // state of the current weighting, see begin_weighting(). The
+    // occlusion images are uploaded with the first segment and the
+    // likelihoods read back with the last one.
+    bool update_occlusions_;
+    float delta_time_;
+    int nr_copies_;
+    int segment_nr_;
+    bool occlusion_images_pending_;
+    bool read_back_pending_;
+
+    // work enqueued between two texture mappings, see run_segment()
+    struct Segment
+    {
+        int texture_nr;
+        int first_pose;
+        int nr_poses;
+        const int* bounding_boxes;
+        const float* depth_layers;  // NULL to read the texture
+        int nr_layers;
+        size_t layer_size;
+        bool read_back;
+    };
+
+    // instantiated graph of each segment key, see set_graph_capture()
+    bool use_graphs_;
+#if CUDART_VERSION >= 11040
+    std::map<int, cudaGraphExec_t> graph_execs_;
+#endif
+
     // occlusion probability default value
     float occlusion_prob_default_;
 
@@ -312,7 +746,44 @@ private:
     bool number_of_poses_set_, constants_initialized_, texture_array_mapped_;
 
     // helper functions
+    template <typename Occlusion>
+    void launch_evaluation(const int texture_nr,
+                           Occlusion* occlusion_probs,
+                           const dim3 grid_dimension,
+                           const int first_pose,
+                           const int nr_poses,
+                           int* bounding_boxes,
+                           const float* depth_layers,
+                           const int nr_layers,
+                           const size_t layer_size);
+    int* upload_bounding_boxes(const int* bounding_boxes,
+                               const int first_pose,
+                               const int nr_poses);
+    dim3 batch_grid_dimension(const int nr_poses) const;
+    // whether the layout is within the texture and grid size of the device
+    bool fits_texture_and_grid(const int nr_poses,
+                               const int nr_poses_per_row,
+                               const int nr_poses_per_col) const;
+    void free_depth_layers();
+    // lists the valid pixels of the next observations on the upload stream
+    void compact_valid_pixels();
+    void reset_occlusion_images();
+    void assign_occlusion_images(const bool update_occlusions);
+    void enqueue_occlusion_images();
+    void allocate_resampling_buffers();
+    // copies the slot images kept on the device back to slot_images_
+    void pull_slot_images();
+    void enqueue_read_back();
+    void enqueue_segment(const Segment& segment);
+    void run_segment(const Segment& segment);
+    int segment_key(const Segment& segment) const;
+#if CUDART_VERSION >= 11040
+    bool launch_graph(const int key, cudaGraph_t graph);
+#endif
+    void clear_graphs();
     template <typename T>
     void allocate(T*& pointer, size_t size);
+    template <typename T>
+    void allocate_host(T*& pointer, size_t size);
     void check_cuda_error(const char* msg);
 };
@@ -0,0 +1,307 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cuda_rasterizer.cu
+ * \date October 2026
+ */
+
+#include <dbot/gpu/cuda_rasterizer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+#include <cuda.h>
+
+using namespace std;
+
+// the rasterize kernel runs one thread per triangle
+static const int NR_THREADS = 128;
+// maximum number of poses rendered by the blocks of one grid row
+static const int MAX_GRID_POSES = 65535;
+
+
+// ************************************************************************************** //
+// ************************************************************************************** //
+// ================================== CUDA KERNELS ====================================== //
+// ************************************************************************************** //
+// ************************************************************************************** //
+
+
+// transforms the vertex by the 3 x 4 pose and projects it, the result is (col, row, depth)
+__device__ float3 project_vertex(const float* pose, const float* vertex,
+                                 float fx, float fy, float cx, float cy) {
+    float x = pose[0] * vertex[0] + pose[1] * vertex[1] + pose[2] * vertex[2] + pose[3];
+    float y = pose[4] * vertex[0] + pose[5] * vertex[1] + pose[6] * vertex[2] + pose[7];
+    float z = pose[8] * vertex[0] + pose[9] * vertex[1] + pose[10] * vertex[2] + pose[11];
+    return make_float3(fx * __fdividef(x, z) + cx, fy * __fdividef(y, z) + cy, z);
+}
+
+
+
+// twice the signed area of the triangle (a, b, (x, y))
+__device__ float edge_function(const float3& a, const float3& b, float x, float y) {
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+
+
+// keeps the closer depth, 0 is no depth yet. Positive floats are ordered like their bits.
+__device__ void depth_test(float* pixel, float depth) {
+    unsigned int* address = (unsigned int*) pixel;
+    const unsigned int value = __float_as_uint(depth);
+    unsigned int old = *address;
+    while (old == 0 || value < old) {
+        const unsigned int assumed = old;
+        old = atomicCAS(address, assumed, value);
+        if (old == assumed) break;
+    }
+}
+
+
+
+// rasterizes triangle blockIdx.x * blockDim.x + threadIdx.x of the poses blockIdx.y,
+// blockIdx.y + gridDim.y, ... The poses of the objects of the current pose are loaded into
+// shared memory, 12 values per object.
+__global__ void rasterize_kernel(const float* vertices, const int* triangles, const int* triangle_objects,
+                                 int nr_triangles, int nr_objects, const float* poses, float* depth_images,
+                                 int n_poses, int n_rows, int n_cols, float fx, float fy, float cx, float cy,
+                                 float near_plane, float far_plane, bool cull_back_faces) {
+    extern __shared__ float object_poses[];
+    const int triangle = blockIdx.x * blockDim.x + threadIdx.x;
+
+    for (int pose_nr = blockIdx.y; pose_nr < n_poses; pose_nr += gridDim.y) {
+        __syncthreads();
+        const float* pose = poses + size_t(pose_nr) * 12 * nr_objects;
+        for (int i = threadIdx.x; i < 12 * nr_objects; i += blockDim.x) {
+            object_poses[i] = pose[i];
+        }
+        __syncthreads();
+
+        if (triangle >= nr_triangles) continue;
+
+        const float* object_pose = object_poses + 12 * triangle_objects[triangle];
+        float3 corners[3];
+        bool in_front = true;
+        for (int k = 0; k < 3; k++) {
+            corners[k] = project_vertex(object_pose, vertices + 3 * triangles[3 * triangle + k], fx, fy, cx, cy);
+            in_front = in_front && corners[k].z >= near_plane;
+        }
+        if (!in_front) continue;
+
+        // degenerate triangles cover no pixel. Back faces, whose outward normals point away from
+        // the camera, are wound clockwise in the image whose rows go down, i.e. have a positive area.
+        const float area = edge_function(corners[0], corners[1], corners[2].x, corners[2].y);
+        if (area == 0 || (cull_back_faces && area > 0)) continue;
+
+        const int col_begin = max(0, (int) ceilf(fminf(fminf(corners[0].x, corners[1].x), corners[2].x)));
+        const int col_end = min(n_cols - 1, (int) floorf(fmaxf(fmaxf(corners[0].x, corners[1].x), corners[2].x)));
+        const int row_begin = max(0, (int) ceilf(fminf(fminf(corners[0].y, corners[1].y), corners[2].y)));
+        const int row_end = min(n_rows - 1, (int) floorf(fmaxf(fmaxf(corners[0].y, corners[1].y), corners[2].y)));
+
+        // the inverse depth is linear in the image
+        const float inverse_area = 1.0f / area;
+        const float inverse_depth[3] = {1.0f / corners[0].z, 1.0f / corners[1].z, 1.0f / corners[2].z};
+
+        float* image = depth_images + size_t(pose_nr) * n_rows * n_cols;
+        for (int row = row_begin; row <= row_end; row++) {
+            for (int col = col_begin; col <= col_end; col++) {
+                const float w0 = edge_function(corners[1], corners[2], col, row) * inverse_area;
+                const float w1 = edge_function(corners[2], corners[0], col, row) * inverse_area;
+                const float w2 = 1.0f - w0 - w1;
+                if (w0 < 0 || w1 < 0 || w2 < 0) continue;
+
+                const float depth = 1.0f / (w0 * inverse_depth[0] + w1 * inverse_depth[1] + w2 * inverse_depth[2]);
+                if (depth <= far_plane) depth_test(image + row * n_cols + col, depth);
+            }
+        }
+    }
+}
+
+
+
+
+// ************************************************************************************** //
+// ************************************************************************************** //
+// =========================== CudaRasterizer MEMBER FUNCTIONS ========================== //
+// ************************************************************************************** //
+// ************************************************************************************** //
+
+
+CudaRasterizer::CudaRasterizer(const std::vector<float>& vertices,
+                               const std::vector<uint32_t>& triangles,
+                               const std::vector<int>& triangle_objects,
+                               const int nr_objects,
+                               const float camera_matrix[9],
+                               const int nr_rows,
+                               const int nr_cols,
+                               const float near_plane,
+                               const float far_plane,
+                               cudaStream_t stream) :
+    nr_triangles_(triangles.size() / 3),
+    nr_objects_(nr_objects),
+    d_depth_images_(NULL),
+    d_poses_(NULL),
+    h_poses_(NULL),
+    max_nr_poses_(0),
+    stream_(stream),
+    fx_(camera_matrix[0]),
+    fy_(camera_matrix[4]),
+    cx_(camera_matrix[2]),
+    cy_(camera_matrix[5]),
+    nr_rows_(nr_rows),
+    nr_cols_(nr_cols),
+    near_plane_(near_plane),
+    far_plane_(far_plane),
+    back_face_culling_(false)
+{
+    if (int(triangle_objects.size()) != nr_triangles_) {
+        std::cout << "ERROR (CUDA): " << triangle_objects.size() << " object indices for "
+                  << nr_triangles_ << " triangles." << std::endl;
+        exit(-1);
+    }
+
+    // the poses of all objects of a pose are kept in shared memory
+    if (12 * nr_objects_ * sizeof(float) > 48 * 1024) {
+        std::cout << "ERROR (CUDA): The rasterizer supports up to "
+                  << 48 * 1024 / (12 * sizeof(float)) << " objects." << std::endl;
+        exit(-1);
+    }
+
+    std::vector<int> indices(triangles.begin(), triangles.end());
+    cudaMalloc((void **) &d_vertices_, vertices.size() * sizeof(float));
+    cudaMalloc((void **) &d_triangles_, indices.size() * sizeof(int));
+    cudaMalloc((void **) &d_triangle_objects_, triangle_objects.size() * sizeof(int));
+    cudaMemcpy(d_vertices_, vertices.data(), vertices.size() * sizeof(float), cudaMemcpyHostToDevice);
+    cudaMemcpy(d_triangles_, indices.data(), indices.size() * sizeof(int), cudaMemcpyHostToDevice);
+    cudaMemcpy(d_triangle_objects_, triangle_objects.data(), triangle_objects.size() * sizeof(int),
+               cudaMemcpyHostToDevice);
+
+    cudaEventCreateWithFlags(&poses_uploaded_, cudaEventDisableTiming);
+
+    cudaError_t error = cudaGetLastError();
+    if (error != cudaSuccess) {
+        std::cout << "ERROR (CUDA): Uploading the mesh failed: " << cudaGetErrorString(error) << std::endl;
+        exit(-1);
+    }
+}
+
+
+
+CudaRasterizer::~CudaRasterizer() {
+    free_memory();
+    cudaFree(d_vertices_);
+    cudaFree(d_triangles_);
+    cudaFree(d_triangle_objects_);
+    cudaEventDestroy(poses_uploaded_);
+}
+
+
+
+bool CudaRasterizer::allocate_memory_for_max_poses(const int nr_poses) {
+    free_memory();
+
+    const size_t images_size = size_t(nr_poses) * nr_rows_ * nr_cols_ * sizeof(float);
+    const size_t poses_size = size_t(nr_poses) * 12 * nr_objects_ * sizeof(float);
+    size_t free_device_memory, total_memory;
+    cudaMemGetInfo(&free_device_memory, &total_memory);
+    if (images_size + poses_size > free_device_memory) return false;
+
+    if (cudaMalloc((void **) &d_depth_images_, images_size) != cudaSuccess ||
+        cudaMalloc((void **) &d_poses_, poses_size) != cudaSuccess ||
+        cudaMallocHost((void **) &h_poses_, poses_size) != cudaSuccess) {
+        cudaGetLastError();
+        free_memory();
+        return false;
+    }
+
+    max_nr_poses_ = nr_poses;
+    return true;
+}
+
+
+
+void CudaRasterizer::render(const float* poses, const int nr_poses) {
+    if (nr_poses > max_nr_poses_) {
+        std::cout << "ERROR (CUDA): The rasterizer was allocated for " << max_nr_poses_
+                  << " instead of " << nr_poses << " poses." << std::endl;
+        exit(-1);
+    }
+    if (nr_poses == 0) return;
+
+    // the pinned buffer may still be read by the previous upload
+    const size_t poses_size = size_t(nr_poses) * 12 * nr_objects_ * sizeof(float);
+    cudaEventSynchronize(poses_uploaded_);
+    memcpy(h_poses_, poses, poses_size);
+    cudaMemcpyAsync(d_poses_, h_poses_, poses_size, cudaMemcpyHostToDevice, stream_);
+    cudaEventRecord(poses_uploaded_, stream_);
+
+    cudaMemsetAsync(d_depth_images_, 0, size_t(nr_poses) * nr_rows_ * nr_cols_ * sizeof(float), stream_);
+
+    const dim3 grid_dimension((nr_triangles_ + NR_THREADS - 1) / NR_THREADS, min(nr_poses, MAX_GRID_POSES));
+    rasterize_kernel <<< grid_dimension, NR_THREADS, 12 * nr_objects_ * sizeof(float), stream_ >>> (
+        d_vertices_, d_triangles_, d_triangle_objects_, nr_triangles_, nr_objects_, d_poses_,
+        d_depth_images_, nr_poses, nr_rows_, nr_cols_, fx_, fy_, cx_, cy_, near_plane_, far_plane_,
+        back_face_culling_);
+    #ifdef DEBUG
+        cudaError_t error = cudaGetLastError();
+        if (error != cudaSuccess) {
+            fprintf(stderr, "Cuda error: rasterize_kernel call: %s.\n", cudaGetErrorString(error));
+            exit(EXIT_FAILURE);
+        }
+    #endif
+}
+
+
+
+const float* CudaRasterizer::get_depth_images() const {
+    return d_depth_images_;
+}
+
+
+
+std::vector<float> CudaRasterizer::get_depth_values(const int nr_poses) {
+    std::vector<float> depth_values(size_t(min(nr_poses, max_nr_poses_)) * nr_rows_ * nr_cols_);
+    cudaStreamSynchronize(stream_);
+    cudaMemcpy(depth_values.data(), d_depth_images_, depth_values.size() * sizeof(float), cudaMemcpyDeviceToHost);
+    return depth_values;
+}
+
+
+
+int CudaRasterizer::get_max_nr_poses() const {
+    return max_nr_poses_;
+}
+
+
+
+void CudaRasterizer::set_back_face_culling(const bool enabled) {
+    back_face_culling_ = enabled;
+}
+
+
+
+void CudaRasterizer::free_memory() {
+    // pending renderings may still read the buffers
+    cudaStreamSynchronize(stream_);
+    cudaFree(d_depth_images_);
+    cudaFree(d_poses_);
+    cudaFreeHost(h_poses_);
+    d_depth_images_ = NULL;
+    d_poses_ = NULL;
+    h_poses_ = NULL;
+    max_nr_poses_ = 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cuda_rasterizer.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cuda_runtime.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \brief Renders the depth of the objects in many poses with CUDA, without
+ *        OpenGL
+ *
+ * Each thread rasterizes one triangle of one pose: it transforms the
+ * vertices by the pose of their object, projects them with the camera
+ * matrix and tests the pixels of the projected bounding box. The depth is
+ * interpolated perspective correctly and the closest depth of each pixel
+ * is kept with atomic operations. The depth images are written to device
+ * memory, pose by pose and row by row, where
+ * CudaEvaluator::weigh_depth_images() reads them on the same stream. No
+ * context, display or interop mapping is needed.
+ *
+ * Pixel (row, col) is sampled at the image coordinates (col, row) like in
+ * RigidBodyRenderer. Triangles with a vertex in front of the near plane are
+ * dropped instead of clipped, depths beyond the far plane are discarded. A
+ * depth of 0 means that no object was hit.
+ */
+class CudaRasterizer
+{
+public:
+    /**
+     * \param [in] vertices x, y, z of all vertices of all objects, e.g.
+     * TriangleMesh::vertex_data()
+     * \param [in] triangles vertex index triples of all triangles, counting
+     * from the first vertex of all objects
+     * \param [in] triangle_objects [triangle_nr] = {the object it belongs to}
+     * \param [in] nr_objects the number of objects, i.e. of poses per state
+     * \param [in] camera_matrix the 3 x 3 intrinsic matrix, row by row
+     * \param [in] nr_rows, nr_cols the resolution of the depth images
+     * \param [in] near_plane, far_plane the range of depths which are rendered
+     * \param [in] stream the stream all work is enqueued on, usually
+     * CudaEvaluator::get_stream()
+     */
+    CudaRasterizer(const std::vector<float>& vertices,
+                   const std::vector<uint32_t>& triangles,
+                   const std::vector<int>& triangle_objects,
+                   const int nr_objects,
+                   const float camera_matrix[9],
+                   const int nr_rows,
+                   const int nr_cols,
+                   const float near_plane,
+                   const float far_plane,
+                   cudaStream_t stream);
+
+    /**
+     * \brief Frees the buffers on the GPU and in page locked memory
+     */
+    ~CudaRasterizer();
+
+    /**
+     * \brief Allocates the depth images and pose buffers for the maximum
+     * number of poses rendered in one call. The previous allocation is
+     * freed.
+     *
+     * \return false if there is not enough memory, nothing is allocated then
+     */
+    bool allocate_memory_for_max_poses(const int nr_poses);
+
+    /**
+     * \brief Enqueues rendering the poses and returns without waiting
+     *
+     * \param [in] poses [pose_nr][object_nr][row][col] the upper three rows
+     * of the homogeneous transform of each object, 12 values per object
+     * \param [in] nr_poses the number of poses, at most the allocated number
+     */
+    void render(const float* poses, const int nr_poses);
+
+    /**
+     * \brief Device pointer to the depth images of the last render() call,
+     * nr_rows * nr_cols values per pose. They are valid once the stream has
+     * reached them, i.e. for all further work on the stream.
+     */
+    const float* get_depth_images() const;
+
+    /**
+     * \brief Copies the depth images of the first nr_poses poses to the host,
+     * waiting for the stream
+     */
+    std::vector<float> get_depth_values(const int nr_poses);
+
+    int get_max_nr_poses() const;
+
+    /**
+     * \brief Skips the triangles facing away from the camera, which requires
+     * closed meshes whose triangles are wound counter clockwise seen from
+     * outside
+     */
+    void set_back_face_culling(const bool enabled);
+
+private:
+    void free_memory();
+
+    // mesh, the vertices of each triangle and its object
+    float* d_vertices_;
+    int* d_triangles_;
+    int* d_triangle_objects_;
+    int nr_triangles_;
+    int nr_objects_;
+
+    // per pose buffers, see allocate_memory_for_max_poses()
+    float* d_depth_images_;
+    float* d_poses_;
+    float* h_poses_;
+    int max_nr_poses_;
+
+    // the pinned poses may be overwritten once their upload has finished
+    cudaEvent_t poses_uploaded_;
+    cudaStream_t stream_;
+
+    float fx_, fy_, cx_, cy_;
+    int nr_rows_;
+    int nr_cols_;
+    float near_plane_;
+    float far_plane_;
+    bool back_face_culling_;
+};
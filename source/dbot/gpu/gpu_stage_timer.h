@@ -0,0 +1,349 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gpu_stage_timer.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include <cuda_runtime.h>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <dbot/timeline_trace.h>
+
+namespace dbot
+{
+/**
+ * \brief Accumulated per stage GPU durations
+ */
+struct GpuStageTimes
+{
+    std::vector<double> total_seconds;
+    /// number of frames whose markers have been read back
+    int frame_count = 0;
+    /// number of frames overwritten before their markers were available
+    int dropped_frame_count = 0;
+
+    double average_seconds(int stage) const
+    {
+        return frame_count > 0 ? total_seconds[stage] / frame_count : 0.;
+    }
+};
+
+/**
+ * \brief Non-blocking timer of consecutive GPU stages
+ *
+ * Every frame records stage_count + 1 markers into the GPU command stream,
+ * begin_frame() before the first stage and one mark() after each stage. The
+ * markers of the last depth frames are kept in a ring buffer and read back
+ * once the GPU has passed them, usually a few frames later, such that timing
+ * never waits for the GPU. A frame which is still pending when its slot is
+ * reused is dropped.
+ *
+ * The Markers policy provides the marker type and the operations create(),
+ * destroy(), record(), ready(), seconds(begin, end), time(marker) and
+ * release(). A copy of the given policy object records the markers, such
+ * that it may carry state like the stream to record on. time() converts a
+ * marker to TimelineTrace::clock_seconds(), it is only called for frames
+ * read back while a timeline callback is set, and release() frees what the
+ * conversion allocated.
+ */
+template <typename Markers>
+class GpuStageTimer
+{
+public:
+    typedef typename Markers::Marker Marker;
+
+    /// receives the seconds of each stage of every frame which is read back
+    typedef std::function<void(const std::vector<double>&)> FrameCallback;
+
+    /// receives the start of each stage in TimelineTrace::clock_seconds()
+    /// and the seconds of each stage of every frame which is read back
+    typedef std::function<void(const std::vector<double>&,
+                               const std::vector<double>&)> TimelineCallback;
+
+    GpuStageTimer(int stage_count,
+                  int depth = 4,
+                  const Markers& markers = Markers())
+        : markers_(markers),
+          stage_count_(stage_count),
+          depth_(depth),
+          head_(0),
+          next_marker_(0)
+    {
+        frames_.resize(depth_);
+        for (auto& frame : frames_)
+        {
+            frame.markers.resize(stage_count_ + 1);
+            for (auto& marker : frame.markers) Markers::create(marker);
+            frame.pending = false;
+        }
+        times_.total_seconds.assign(stage_count_, 0.);
+    }
+
+    ~GpuStageTimer()
+    {
+        for (auto& frame : frames_)
+        {
+            for (auto& marker : frame.markers) Markers::destroy(marker);
+        }
+        markers_.release();
+    }
+
+    GpuStageTimer(const GpuStageTimer&) = delete;
+    GpuStageTimer& operator=(const GpuStageTimer&) = delete;
+
+    void begin_frame()
+    {
+        collect();
+
+        Frame& frame = frames_[head_];
+        if (frame.pending)
+        {
+            frame.pending = false;
+            times_.dropped_frame_count++;
+        }
+
+        next_marker_ = 0;
+        mark();
+    }
+
+    /**
+     * \brief Marks the end of the next stage of the current frame
+     */
+    void mark()
+    {
+        markers_.record(frames_[head_].markers[next_marker_++]);
+    }
+
+    void end_frame()
+    {
+        frames_[head_].pending = next_marker_ == stage_count_ + 1;
+        head_ = (head_ + 1) % depth_;
+    }
+
+    /**
+     * \brief Reads back all frames the GPU has finished without blocking
+     */
+    void collect()
+    {
+        for (int i = 1; i <= depth_; i++)
+        {
+            Frame& frame = frames_[(head_ + i) % depth_];
+            if (!frame.pending || !Markers::ready(frame.markers.back()))
+            {
+                continue;
+            }
+
+            frame_seconds_.resize(stage_count_);
+            for (int stage = 0; stage < stage_count_; stage++)
+            {
+                frame_seconds_[stage] = Markers::seconds(
+                    frame.markers[stage], frame.markers[stage + 1]);
+                times_.total_seconds[stage] += frame_seconds_[stage];
+            }
+            times_.frame_count++;
+            frame.pending = false;
+
+            if (frame_callback_) frame_callback_(frame_seconds_);
+            if (timeline_callback_)
+            {
+                frame_begin_times_.resize(stage_count_);
+                for (int stage = 0; stage < stage_count_; stage++)
+                {
+                    frame_begin_times_[stage] =
+                        markers_.time(frame.markers[stage]);
+                }
+                timeline_callback_(frame_begin_times_, frame_seconds_);
+            }
+        }
+    }
+
+    const GpuStageTimes& times() const { return times_; }
+    void frame_callback(const FrameCallback& callback)
+    {
+        frame_callback_ = callback;
+    }
+    void timeline_callback(const TimelineCallback& callback)
+    {
+        timeline_callback_ = callback;
+    }
+
+private:
+    struct Frame
+    {
+        std::vector<Marker> markers;
+        bool pending;
+    };
+
+    Markers markers_;
+    int stage_count_;
+    int depth_;
+    int head_;
+    int next_marker_;
+    std::vector<Frame> frames_;
+    GpuStageTimes times_;
+    std::vector<double> frame_seconds_;
+    std::vector<double> frame_begin_times_;
+    FrameCallback frame_callback_;
+    TimelineCallback timeline_callback_;
+};
+
+/**
+ * \brief GL_TIMESTAMP query markers
+ *
+ * The GL clock is related to the host clock by reading the current GL
+ * timestamp once, when the first marker is converted.
+ */
+struct GLTimestampMarkers
+{
+    typedef GLuint Marker;
+
+    GLTimestampMarkers() : calibrated(false), offset(0) {}
+
+    static void create(Marker& marker) { glGenQueries(1, &marker); }
+    static void destroy(Marker& marker) { glDeleteQueries(1, &marker); }
+    static void record(Marker& marker)
+    {
+        glQueryCounter(marker, GL_TIMESTAMP);
+    }
+
+    static bool ready(Marker& marker)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(marker, GL_QUERY_RESULT_AVAILABLE, &available);
+        return available != 0;
+    }
+
+    static double seconds(Marker& begin, Marker& end)
+    {
+        GLuint64 begin_ns;
+        GLuint64 end_ns;
+        glGetQueryObjectui64v(begin, GL_QUERY_RESULT, &begin_ns);
+        glGetQueryObjectui64v(end, GL_QUERY_RESULT, &end_ns);
+        return double(end_ns - begin_ns) * 1e-9;
+    }
+
+    double time(Marker& marker)
+    {
+        if (!calibrated)
+        {
+            GLint64 now_ns = 0;
+            glGetInteger64v(GL_TIMESTAMP, &now_ns);
+            offset = TimelineTrace::clock_seconds(TimelineTrace::Clock::now()) -
+                     double(now_ns) * 1e-9;
+            calibrated = true;
+        }
+
+        GLuint64 marker_ns;
+        glGetQueryObjectui64v(marker, GL_QUERY_RESULT, &marker_ns);
+        return offset + double(marker_ns) * 1e-9;
+    }
+
+    void release() {}
+
+    bool calibrated;
+    double offset;
+};
+
+/**
+ * \brief CUDA event markers on a given stream, the default stream if none is
+ *        given
+ *
+ * Events carry no absolute time. They are converted relative to a reference
+ * event whose host time is taken by waiting for it once, when the first
+ * marker is converted. Since event times are single precision milliseconds,
+ * a new reference is recorded every few seconds and its time derived from
+ * the previous one once it completed, without waiting.
+ */
+struct CudaEventMarkers
+{
+    typedef cudaEvent_t Marker;
+
+    explicit CudaEventMarkers(cudaStream_t stream = 0)
+        : stream(stream),
+          calibrated(false),
+          next_reference_recorded(false),
+          reference_time(0)
+    {
+    }
+    static void create(Marker& marker) { cudaEventCreate(&marker); }
+    static void destroy(Marker& marker) { cudaEventDestroy(marker); }
+    void record(Marker& marker) const { cudaEventRecord(marker, stream); }
+    static bool ready(Marker& marker)
+    {
+        return cudaEventQuery(marker) == cudaSuccess;
+    }
+
+    static double seconds(Marker& begin, Marker& end)
+    {
+        float milliseconds = 0;
+        cudaEventElapsedTime(&milliseconds, begin, end);
+        return double(milliseconds) * 1e-3;
+    }
+
+    double time(Marker& marker)
+    {
+        if (!calibrated)
+        {
+            create(reference);
+            create(next_reference);
+            cudaEventRecord(reference, stream);
+            cudaEventSynchronize(reference);
+            reference_time =
+                TimelineTrace::clock_seconds(TimelineTrace::Clock::now());
+            calibrated = true;
+        }
+
+        if (next_reference_recorded && ready(next_reference))
+        {
+            reference_time += seconds(reference, next_reference);
+            std::swap(reference, next_reference);
+            next_reference_recorded = false;
+        }
+
+        const double offset = seconds(reference, marker);
+        if (offset > max_reference_age && !next_reference_recorded)
+        {
+            cudaEventRecord(next_reference, stream);
+            next_reference_recorded = true;
+        }
+        return reference_time + offset;
+    }
+
+    void release()
+    {
+        if (!calibrated) return;
+        destroy(reference);
+        destroy(next_reference);
+        calibrated = false;
+    }
+
+    static constexpr double max_reference_age = 10.;
+
+    cudaStream_t stream;
+    bool calibrated;
+    bool next_reference_recorded;
+    Marker reference;
+    Marker next_reference;
+    double reference_time;
+};
+
+typedef GpuStageTimer<GLTimestampMarkers> GLStageTimer;
+typedef GpuStageTimer<CudaEventMarkers> CudaStageTimer;
+}
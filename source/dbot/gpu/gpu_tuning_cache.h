@@ -0,0 +1,153 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gpu_tuning_cache.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace dbot
+{
+/**
+ * \brief Kernel and buffer configuration found by the GPU autotuner
+ */
+struct GpuTuning
+{
+    int nr_threads = 0;
+    /// poses per row of the render texture, the rows follow from the count
+    int nr_poses_per_row = 0;
+};
+
+/**
+ * \brief On-disk cache of tuned GPU configurations
+ *
+ * The file holds one line "key nr_threads nr_poses_per_row" per setup. A
+ * key describes everything the best configuration depends on, e.g. device,
+ * resolution and mesh, see make_key(). Entries of other setups are kept when
+ * the file is rewritten.
+ */
+class GpuTuningCache
+{
+public:
+    explicit GpuTuningCache(const std::string& path) : path_(path) { load(); }
+    /**
+     * \brief Default cache file, $DBOT_GPU_TUNING_CACHE if set, otherwise
+     *        $HOME/.dbot_gpu_tuning
+     */
+    static std::string default_path()
+    {
+        const char* path = std::getenv("DBOT_GPU_TUNING_CACHE");
+        if (path && *path) return path;
+
+        const char* home = std::getenv("HOME");
+        return std::string(home ? home : ".") + "/.dbot_gpu_tuning";
+    }
+
+    /**
+     * \brief Joins the given values to a key, replacing white space such that
+     *        the key stays a single token
+     */
+    template <typename... Values>
+    static std::string make_key(const Values&... values)
+    {
+        std::ostringstream stream;
+        append(stream, values...);
+
+        std::string key = stream.str();
+        for (auto& c : key)
+        {
+            if (c == ' ' || c == '\t' || c == '\n') c = '_';
+        }
+        return key;
+    }
+
+    bool find(const std::string& key, GpuTuning& tuning) const
+    {
+        auto entry = entries_.find(key);
+        if (entry == entries_.end()) return false;
+
+        tuning = entry->second;
+        return true;
+    }
+
+    /**
+     * \brief Stores the tuning and rewrites the file
+     *
+     * \return false if the file could not be written
+     */
+    bool store(const std::string& key, const GpuTuning& tuning)
+    {
+        // merge with entries written by other processes in the meantime
+        load();
+        entries_[key] = tuning;
+
+        // written to a temporary file first, such that readers never see a
+        // partially written cache
+        const std::string temporary_path = path_ + ".tmp";
+        {
+            std::ofstream file(temporary_path.c_str());
+            if (!file) return false;
+
+            for (auto& entry : entries_)
+            {
+                file << entry.first << " " << entry.second.nr_threads << " "
+                     << entry.second.nr_poses_per_row << "\n";
+            }
+            if (!file) return false;
+        }
+        return std::rename(temporary_path.c_str(), path_.c_str()) == 0;
+    }
+
+    const std::string& path() const { return path_; }
+private:
+    static void append(std::ostringstream& stream) {}
+    template <typename Value, typename... Values>
+    static void append(std::ostringstream& stream,
+                       const Value& value,
+                       const Values&... values)
+    {
+        stream << value;
+        if (sizeof...(values) > 0) stream << "/";
+        append(stream, values...);
+    }
+
+    void load()
+    {
+        std::ifstream file(path_.c_str());
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream stream(line);
+            std::string key;
+            GpuTuning tuning;
+            if (stream >> key >> tuning.nr_threads >> tuning.nr_poses_per_row &&
+                tuning.nr_threads > 0 && tuning.nr_poses_per_row > 0)
+            {
+                entries_[key] = tuning;
+            }
+        }
+    }
+
+    std::string path_;
+    std::map<std::string, GpuTuning> entries_;
+};
+}
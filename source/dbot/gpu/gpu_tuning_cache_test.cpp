@@ -0,0 +1,107 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gpu_tuning_cache_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <dbot/gpu/gpu_tuning_cache.h>
+
+namespace
+{
+std::string temporary_cache_path()
+{
+    return testing::TempDir() + "dbot_gpu_tuning_cache_test";
+}
+}
+
+TEST(GpuTuningCacheTests, make_key_is_single_token)
+{
+    std::string key =
+        dbot::GpuTuningCache::make_key("GeForce GTX 1080", 6, 1, 480, 640);
+
+    EXPECT_EQ(key, "GeForce_GTX_1080/6/1/480/640");
+}
+
+TEST(GpuTuningCacheTests, missing_file_is_empty)
+{
+    std::remove(temporary_cache_path().c_str());
+    dbot::GpuTuningCache cache(temporary_cache_path());
+
+    dbot::GpuTuning tuning;
+    EXPECT_FALSE(cache.find("a", tuning));
+}
+
+TEST(GpuTuningCacheTests, stored_tuning_persists)
+{
+    std::remove(temporary_cache_path().c_str());
+    {
+        dbot::GpuTuningCache cache(temporary_cache_path());
+        dbot::GpuTuning tuning;
+        tuning.nr_threads = 128;
+        tuning.nr_poses_per_row = 12;
+        ASSERT_TRUE(cache.store("a", tuning));
+        tuning.nr_threads = 256;
+        ASSERT_TRUE(cache.store("b", tuning));
+    }
+
+    dbot::GpuTuningCache cache(temporary_cache_path());
+    dbot::GpuTuning tuning;
+    ASSERT_TRUE(cache.find("a", tuning));
+    EXPECT_EQ(tuning.nr_threads, 128);
+    EXPECT_EQ(tuning.nr_poses_per_row, 12);
+    ASSERT_TRUE(cache.find("b", tuning));
+    EXPECT_EQ(tuning.nr_threads, 256);
+}
+
+TEST(GpuTuningCacheTests, store_keeps_entries_of_other_writers)
+{
+    std::remove(temporary_cache_path().c_str());
+    dbot::GpuTuningCache first(temporary_cache_path());
+    dbot::GpuTuningCache second(temporary_cache_path());
+
+    dbot::GpuTuning tuning;
+    tuning.nr_threads = 64;
+    tuning.nr_poses_per_row = 4;
+    ASSERT_TRUE(first.store("a", tuning));
+    ASSERT_TRUE(second.store("b", tuning));
+
+    dbot::GpuTuningCache cache(temporary_cache_path());
+    EXPECT_TRUE(cache.find("a", tuning));
+    EXPECT_TRUE(cache.find("b", tuning));
+}
+
+TEST(GpuTuningCacheTests, malformed_lines_are_ignored)
+{
+    {
+        std::ofstream file(temporary_cache_path().c_str());
+        file << "a 128\n"
+             << "b x 3\n"
+             << "c 0 3\n"
+             << "d 32 2\n";
+    }
+
+    dbot::GpuTuningCache cache(temporary_cache_path());
+    dbot::GpuTuning tuning;
+    EXPECT_FALSE(cache.find("a", tuning));
+    EXPECT_FALSE(cache.find("b", tuning));
+    EXPECT_FALSE(cache.find("c", tuning));
+    ASSERT_TRUE(cache.find("d", tuning));
+    EXPECT_EQ(tuning.nr_threads, 32);
+}
@@ -0,0 +1,364 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_cuda.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/depth_downsampling.h>
+#include <dbot/gpu/cuda_likelihood_evaluator.h>
+#include <dbot/gpu/cuda_rasterizer.h>
+#include <dbot/gpu/page_locked_depth_frame.h>
+#include <dbot/latency_metrics.h>
+#include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/pose/rigid_bodies_state_array.h>
+#include <dbot/triangle_mesh.h>
+
+namespace dbot
+{
+/**
+ * \brief GPU sensor which renders with CudaRasterizer instead of OpenGL
+ *
+ * The poses are rasterized into device memory and evaluated by the
+ * CudaEvaluator on the same stream, such that no GL context, X display or
+ * interop mapping is involved and the sensor runs on headless machines.
+ * The likelihoods and occlusions are those of KinectImageModelGPU, which
+ * remains the sensor for levels of detail, pipelined batches and regions
+ * of interest.
+ */
+template <typename State>
+class KinectImageModelCuda : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+    typedef Eigen::Matrix3d CameraMatrix;
+
+public:
+    /**
+     * The parameters are those of KinectImageModelGPU.
+     *
+     * \param [in] device the CUDA device to run on, a device with compute
+     * capability 2.0 if negative
+     * \param [in] near_plane, far_plane the range of rendered depths
+     */
+    KinectImageModelCuda(const CameraMatrix& camera_matrix,
+                         const int nr_rows,
+                         const int nr_cols,
+                         const int max_sample_count,
+                         const TriangleMesh::ConstPtr& mesh,
+                         const double initial_occlusion_prob = 0.1,
+                         const double delta_time = 0.033,
+                         const float p_occluded_visible = 0.1f,
+                         const float p_occluded_occluded = 0.7f,
+                         const float tail_weight = 0.01f,
+                         const float model_sigma = 0.003f,
+                         const float sigma_factor = 0.0014247f,
+                         const float max_depth = 6.0f,
+                         const float exponential_rate = -log(0.5f),
+                         const bool half_precision_occlusions = false,
+                         const int device = -1,
+                         const float near_plane = 0.4f,
+                         const float far_plane = 4.0f)
+        : Base(delta_time),
+          nr_rows_(nr_rows),
+          nr_cols_(nr_cols),
+          nr_objects_(mesh->count_parts()),
+          initial_occlusion_prob_(initial_occlusion_prob),
+          observation_time_(0),
+          observations_set_(false)
+    {
+        this->default_poses_.recount(nr_objects_);
+        this->default_poses_.setZero();
+
+        cuda_.reset(new CudaEvaluator(
+            nr_rows_, nr_cols_, half_precision_occlusions, device));
+        cuda_->init(initial_occlusion_prob,
+                    p_occluded_occluded,
+                    p_occluded_visible,
+                    tail_weight,
+                    model_sigma,
+                    sigma_factor,
+                    max_depth,
+                    exponential_rate);
+
+        // the triangles index the vertices of all objects
+        std::vector<uint32_t> triangles(mesh->index_data());
+        std::vector<int> triangle_objects(mesh->count_triangles());
+        for (int i_obj = 0; i_obj < nr_objects_; i_obj++)
+        {
+            for (int i = mesh->first_triangle(i_obj);
+                 i < mesh->first_triangle(i_obj) + mesh->count_triangles(i_obj);
+                 i++)
+            {
+                triangle_objects[i] = i_obj;
+                for (int k = 0; k < 3; k++)
+                {
+                    triangles[3 * i + k] += mesh->first_vertex(i_obj);
+                }
+            }
+        }
+        Eigen::Matrix<float, 3, 3, Eigen::RowMajor> camera =
+            camera_matrix.cast<float>();
+        rasterizer_.reset(new CudaRasterizer(mesh->vertex_data(),
+                                             triangles,
+                                             triangle_objects,
+                                             nr_objects_,
+                                             camera.data(),
+                                             nr_rows_,
+                                             nr_cols_,
+                                             near_plane,
+                                             far_plane,
+                                             cuda_->get_stream()));
+
+        allocate_memory(max_sample_count);
+        reset();
+    }
+
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& occlusion_indices,
+                       const bool& update_occlusions = false)
+    {
+        if (!observations_set_)
+        {
+            std::cout << "GPU: observations not set" << std::endl;
+            exit(-1);
+        }
+
+        int nr_poses = deltas.size();
+        if (nr_poses > nr_max_poses_)
+        {
+            std::cout << "ERROR (CUDA): Only " << nr_max_poses_ << " of "
+                      << nr_poses << " poses fit into the GPU memory, "
+                      << "the others are not evaluated." << std::endl;
+            nr_poses = nr_max_poses_;
+        }
+
+        LatencyMetrics::Clock::time_point start = LatencyMetrics::Clock::now();
+
+        // compose the deltas with the default poses of all states at once
+        delta_columns_.gather(deltas, 0, nr_poses);
+        delta_columns_.expand(this->default_poses_);
+        poses_.resize(size_t(nr_poses) * nr_objects_ * 12);
+        float* pose_data = poses_.data();
+        for (int i_state = 0; i_state < nr_poses; i_state++)
+        {
+            for (int i_obj = 0; i_obj < nr_objects_; i_obj++)
+            {
+                Eigen::Map<Eigen::Matrix<float, 3, 4, Eigen::RowMajor>> pose(
+                    pose_data);
+                pose = delta_columns_
+                           .template homogeneous<float>(i_state, i_obj)
+                           .template topRows<3>();
+                pose_data += 12;
+            }
+        }
+
+        std::vector<float>& flog_likelihoods = log_likelihood_buffer_;
+        flog_likelihoods.clear();
+        if (nr_poses > 0)
+        {
+            cuda_->set_number_of_poses(nr_poses);
+            cuda_->set_occlusion_indices(
+                occlusion_indices.data(),
+                std::min(int(occlusion_indices.size()), nr_poses));
+
+            // the evaluation follows the rendering on the stream without
+            // waiting for it
+            rasterizer_->render(poses_.data(), nr_poses);
+            if (cuda_->begin_weighting(update_occlusions, false))
+            {
+                cuda_->weigh_depth_images(
+                    rasterizer_->get_depth_images(), 0, nr_poses);
+                cuda_->end_weighting(flog_likelihoods);
+            }
+        }
+
+        if (this->latency_metrics_)
+        {
+            this->latency_metrics_->add(LatencyMetrics::WEIGHTING,
+                                        LatencyMetrics::elapsed(start));
+        }
+
+        if (update_occlusions)
+        {
+            for (size_t i_state = 0; i_state < occlusion_indices.size();
+                 i_state++)
+                occlusion_indices[i_state] =
+                    int(i_state) < nr_poses ? i_state : 0;
+        }
+
+        // the states which were not evaluated are as unlikely as the
+        // particles the filter prunes
+        RealArray log_likelihoods = RealArray::Constant(deltas.size(), -1e10);
+        for (size_t i = 0; i < flog_likelihoods.size(); i++)
+            log_likelihoods[i] = flog_likelihoods[i];
+
+        return log_likelihoods;
+    }
+
+    void set_observation(const Observation& image)
+    {
+        std::vector<float> std_measurement(image.size());
+        for (int i = 0; i < image.size(); ++i)
+        {
+            std_measurement[i] = image(i);
+        }
+
+        observation_time_ += this->delta_time_;
+        cuda_->set_observations(std_measurement.data(), observation_time_);
+        observations_set_ = true;
+    }
+
+    /**
+     * \brief Uploads the depth frame like KinectImageModelGPU, frames at an
+     * integer multiple of the resolution are downsampled on the GPU
+     */
+    void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        observation_time_ += this->frame_delta_time(*frame);
+
+        const bool page_locked = is_page_locked(frame->data());
+        if (frame->size() == nr_rows_ * nr_cols_)
+        {
+            cuda_->set_observations(
+                frame->data(), observation_time_, page_locked);
+        }
+        else
+        {
+            cuda_->set_native_observations(frame->data(),
+                                           frame->rows(),
+                                           frame->cols(),
+                                           depth_pooling_,
+                                           observation_time_,
+                                           page_locked);
+        }
+
+        // the previous upload has finished when the evaluator returns
+        uploading_frame_ = page_locked ? frame : DepthFrame::ConstPtr();
+        observations_set_ = true;
+    }
+
+    DepthDownsampler::Pooling depth_pooling() const { return depth_pooling_; }
+    void depth_pooling(DepthDownsampler::Pooling pooling)
+    {
+        depth_pooling_ = pooling;
+    }
+
+    /** \brief Resets the occlusion probabilities and observation time */
+    virtual void reset()
+    {
+        std::vector<float> occlusion_probabilities(
+            size_t(nr_rows_) * nr_cols_ * nr_max_poses_,
+            initial_occlusion_prob_);
+        cuda_->set_occlusion_probabilities(occlusion_probabilities.data(),
+                                           occlusion_probabilities.size());
+        observation_time_ = 0;
+    }
+
+    int max_sample_count() const { return nr_max_poses_; }
+
+    /**
+     * \brief Occlusion probabilities of the state with the given index
+     */
+    std::vector<float> get_occlusion_image(int index) const
+    {
+        return cuda_->get_occlusion_probabilities(index);
+    }
+
+    /**
+     * \brief Depth images of the states of the last loglikes() call, nr_rows
+     * * nr_cols values per state and 0 where no object is hit
+     */
+    std::vector<float> get_depth_values(int nr_poses)
+    {
+        return rasterizer_->get_depth_values(nr_poses);
+    }
+
+    /// \copydoc CudaRasterizer::set_back_face_culling()
+    void set_back_face_culling(bool enabled)
+    {
+        rasterizer_->set_back_face_culling(enabled);
+    }
+
+    /// \copydoc CudaEvaluator::set_graph_capture()
+    void set_graph_capture(bool enabled) { cuda_->set_graph_capture(enabled); }
+
+private:
+    /**
+     * \brief Allocates the evaluator and rasterizer for up to nr_poses
+     * poses, fewer if they do not fit into the texture limits or the memory
+     * of the device
+     */
+    void allocate_memory(int nr_poses)
+    {
+        // the evaluator arranges the poses like tiles of a texture
+        const cudaDeviceProp properties = cuda_->get_device_properties();
+        const int per_row = std::max(
+            1,
+            std::min(std::min(nr_poses, properties.maxTexture2D[0] / nr_cols_),
+                     properties.maxGridSize[0]));
+        const int max_per_col =
+            std::min(properties.maxTexture2D[1] / nr_rows_,
+                     properties.maxGridSize[1]);
+        nr_poses = std::min(nr_poses, per_row * max_per_col);
+
+        while (nr_poses > 0 &&
+               !rasterizer_->allocate_memory_for_max_poses(nr_poses))
+        {
+            nr_poses /= 2;
+        }
+        if (nr_poses == 0)
+        {
+            std::cout << "ERROR (CUDA): Not enough memory to render any pose."
+                      << std::endl;
+            exit(-1);
+        }
+
+        cuda_->allocate_memory_for_max_poses(
+            nr_poses, per_row, (nr_poses + per_row - 1) / per_row);
+        nr_max_poses_ = nr_poses;
+    }
+
+    int nr_rows_;
+    int nr_cols_;
+    int nr_objects_;
+    int nr_max_poses_;
+    float initial_occlusion_prob_;
+    float observation_time_;
+    bool observations_set_;
+    DepthDownsampler::Pooling depth_pooling_ = DepthDownsampler::MEAN_POOLING;
+    DepthFrame::ConstPtr uploading_frame_;
+
+    std::shared_ptr<CudaEvaluator> cuda_;
+    std::shared_ptr<CudaRasterizer> rasterizer_;
+
+    RigidBodiesStateArray<State> delta_columns_;
+    std::vector<float> poses_;
+    std::vector<float> log_likelihood_buffer_;
+};
+}
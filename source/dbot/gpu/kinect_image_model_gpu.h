@@ -29,25 +29,42 @@
 
 #pragma once
 
-#define PROFILING_ACTIVE
+// Blocking wall time measurements of every evaluation step for debugging.
+// Without it, the GPU stages are timed with non-blocking GPU markers, see
+// render_stage_times() and cuda_stage_times().
+//#define PROFILING_ACTIVE
 //#define OPTIMIZE_NR_THREADS
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/shared_ptr.hpp>
+#include <cstring>
+#include <dbot/depth_downsampling.h>
 #include <dbot/gpu/buffer_configuration.h>
 #include <dbot/gpu/cuda_likelihood_evaluator.h>
+#include <dbot/gpu/gpu_stage_timer.h>
+#include <dbot/latency_metrics.h>
+#include <dbot/gpu/gpu_tuning_cache.h>
 #include <dbot/gpu/object_rasterizer.h>
+#include <dbot/gpu/page_locked_depth_frame.h>
 #include <dbot/helper_functions.h>
 #include <dbot/model/rao_blackwell_sensor.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
+#include <dbot/pose/pose_hashing.h>
 #include <dbot/pose/pose_vector.h>
+#include <dbot/pose/rigid_bodies_state_array.h>
+#include <dbot/region_of_interest.h>
 #include <dbot/traits.h>
+#include <dbot/triangle_mesh.h>
 #include <fl/util/profiling.hpp>
 #include <iostream>
 #include <limits>
+#include <random>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <cuda_gl_interop.h>
@@ -115,19 +132,9 @@ public:
      * 		the maximum number of poses that will be rendered per object
      *      in one frame.
      * This is needed to allocate the necessary memory on the GPU.
-     * \param [in] vertices
-     * 		[object_nr][vertex_nr] = {x, y, z}. This list should
-     * 		contain, for each object, a list of 3-dimensional vectors
-     * 		that specify the corners of the triangles of the object mesh
-     * \param [in] indices [object_nr][index_nr][0 - 2] = {index}. This list
-     * 		should contain the indices
-     * 		that index the vertices list and tell us which vertices to connect
-     * to
-     * a
-     * 		triangle (every group of 3).
-     * 		For each object, the indices should be in the range of [0,
-     * nr_vertices
-     * - 1].
+     * \param [in] mesh
+     * 		with one part per object, shared with the object model and
+     * 		uploaded to the GPU without conversion
      * \param [in] vertex_shader_path path to the vertex shader
      * \param [in] fragment_shader_path path to the fragment shader
      * \param [in] initial_occlusion_prob the initial probability for each pixel
@@ -151,14 +158,41 @@ public:
      * \param [in] exponential_rate the rate of the exponential distribution
      * that
      * models the probability of a measurement coming from an unknown object
+     * \param [in] use_instanced_rendering render all poses of an object with
+     * one instanced draw call
+     * \param [in] nr_pipeline_batches number of batches the poses of one
+     * evaluation are split into. Batches are rendered into alternating
+     * textures, such that rendering a batch overlaps with the evaluation of
+     * the previous one.
+     * \param [in] half_precision_occlusions store the occlusion probabilities
+     * as 16 bit floats on the GPU, which roughly doubles the number of poses
+     * that fit into its memory
+     * \param [in] display_name the X display to render on. Evaluation runs
+     * on the CUDA device of this display. If empty, the default display and
+     * device are used.
+     * \param [in] tuning_cache_path if not empty, the number of threads and
+     * the layout of the render texture are tuned for this setup on a
+     * synthetic frame, or loaded from this cache file if they were tuned
+     * before, see GpuTuningCache
+     * \param [in] region_of_interest_rows, region_of_interest_cols if both
+     * are positive, the poses are rendered and evaluated only within a
+     * window of this size which follows the object, see RegionOfInterest.
+     * The occlusion and range images are then of the size of the window.
+     * \param [in] region_of_interest_margin pixels around the projection of
+     * the object at the integrated poses which have to lie in the window
+     * \param [in] initial_sample_count if positive, the GPU memory is
+     * allocated for this many poses only and grown geometrically up to
+     * max_sample_count once more poses are evaluated
+     * \param [in] use_layered_render_target render into 2D array textures,
+     * such that the number of poses is bounded by the GPU memory instead of
+     * the texture size, see ObjectRasterizer
      */
     KinectImageModelGPU(
         const CameraMatrix& camera_matrix,
         const size_t& nr_rows,
         const size_t& nr_cols,
         const size_t& max_sample_count,
-        const std::vector<std::vector<Eigen::Vector3d>> vertices_double,
-        const std::vector<std::vector<std::vector<int>>> indices,
+        const TriangleMesh::ConstPtr& mesh,
         const std::shared_ptr<ShaderProvider>& shader_provider,
         const bool adapt_to_constraints = false,
         const bool optimize_nr_threads = false,
@@ -170,12 +204,25 @@ public:
         const float model_sigma = 0.003f,
         const float sigma_factor = 0.0014247f,
         const float max_depth = 6.0f,
-        const float exponential_rate = -log(0.5f))
+        const float exponential_rate = -log(0.5f),
+        const bool use_instanced_rendering = false,
+        const int nr_pipeline_batches = 2,
+        const bool half_precision_occlusions = false,
+        const std::string& display_name = "",
+        const std::string& tuning_cache_path = "",
+        const int region_of_interest_rows = 0,
+        const int region_of_interest_cols = 0,
+        const int region_of_interest_margin = 8,
+        const int initial_sample_count = 0,
+        const bool use_layered_render_target = false)
         : camera_matrix_(camera_matrix),
           nr_rows_(nr_rows),
           nr_cols_(nr_cols),
+          frame_rows_(nr_rows),
+          frame_cols_(nr_cols),
           nr_max_poses_(max_sample_count),
-          indices_(indices),
+          pose_limit_(max_sample_count),
+          mesh_(mesh),
           optimize_nr_threads_(optimize_nr_threads),
           initial_occlusion_prob_(initial_occlusion_prob),
           tail_weight_(tail_weight),
@@ -184,42 +231,64 @@ public:
           max_depth_(max_depth),
           exponential_rate_(exponential_rate),
           nr_poses_(max_sample_count),
+          nr_pipeline_batches_(std::max(nr_pipeline_batches, 1)),
+          nr_poses_last_batch_(0),
           observations_set_(false),
           resource_registered_(false),
           observation_time_(0),
           Traits::Base(delta_time)
     {
         // set constants
-        this->default_poses_.recount(vertices_double.size());
+        this->default_poses_.recount(mesh_->count_parts());
         this->default_poses_.setZero();
 
-        // convert doubles to floats
-        vertices_.resize(vertices_double.size());
-        for (size_t object_index = 0; object_index < vertices_.size();
-             object_index++)
+        // everything below works at the size of the region of interest
+        Eigen::Matrix3d render_camera_matrix = camera_matrix_;
+        if (region_of_interest_rows > 0 && region_of_interest_cols > 0)
         {
-            vertices_[object_index].resize(
-                vertices_double[object_index].size());
-            for (size_t vertex_index = 0;
-                 vertex_index < vertices_[object_index].size();
-                 vertex_index++)
-                vertices_[object_index][vertex_index] =
-                    vertices_double[object_index][vertex_index].cast<float>();
+            region_of_interest_.reset(
+                new RegionOfInterest(frame_rows_,
+                                     frame_cols_,
+                                     region_of_interest_rows,
+                                     region_of_interest_cols,
+                                     region_of_interest_margin));
+            nr_rows_ = region_of_interest_->region().rows;
+            nr_cols_ = region_of_interest_->region().cols;
+            render_camera_matrix =
+                region_of_interest_->camera_matrix(camera_matrix_);
+            part_boxes_ = RegionOfInterest::part_boxes(*mesh_);
         }
 
         // initialize opengl and cuda
         opengl_ = boost::shared_ptr<ObjectRasterizer>(
-            new ObjectRasterizer(vertices_,
-                                 indices_,
+            new ObjectRasterizer(mesh_,
                                  shader_provider,
-                                 camera_matrix_.cast<float>(),
+                                 render_camera_matrix.cast<float>(),
                                  nr_rows_,
                                  nr_cols_,
                                  0.4,
-                                 4));
+                                 4,
+                                 use_instanced_rendering,
+                                 display_name,
+                                 use_layered_render_target));
+
+        // the interop requires CUDA to run on the device of the GL context
+        int device = -1;
+        if (!display_name.empty())
+        {
+            unsigned int nr_gl_devices = 0;
+            cudaGLGetDevices(
+                &nr_gl_devices, &device, 1, cudaGLDeviceListAll);
+            if (nr_gl_devices == 0)
+            {
+                std::cout << "ERROR (CUDA): The display " << display_name
+                          << " does not render on a CUDA device." << std::endl;
+                exit(-1);
+            }
+        }
 
-        cuda_ = boost::shared_ptr<CudaEvaluator>(
-            new CudaEvaluator(nr_rows_, nr_cols_));
+        cuda_ = boost::shared_ptr<CudaEvaluator>(new CudaEvaluator(
+            nr_rows_, nr_cols_, half_precision_occlusions, device));
 
         cuda_->init(initial_occlusion_prob_,
                     p_occluded_occluded,
@@ -236,6 +305,11 @@ public:
 
         bufferConfig_->set_adapt_to_constraints(adapt_to_constraints);
 
+        if (initial_sample_count > 0)
+        {
+            nr_max_poses_ = std::min(nr_max_poses_, initial_sample_count);
+        }
+
         // allocates memory and sets the dimensions of how many poses will be
         // rendered per row and per column in the texture
         int tmp_max_nr_poses;
@@ -259,6 +333,10 @@ public:
         }
 
         register_resource();
+        if (nr_max_poses_ < initial_sample_count || initial_sample_count <= 0)
+        {
+            pose_limit_ = nr_max_poses_;
+        }
 
         reset();
 
@@ -266,6 +344,9 @@ public:
 
         occlusion_probs_.resize(nr_rows_ * nr_cols_);
 
+        cuda_stage_timer_.reset(new CudaStageTimer(
+            NR_CUDA_STAGES, 4, CudaEventMarkers(cuda_->get_stream())));
+
 #ifdef PROFILING_ACTIVE
         for (int i = 0; i < NR_SUBTASKS_TO_MEASURE; i++)
         {
@@ -283,8 +364,6 @@ public:
             "Unmapping the texture and reconverting the likelihoods";
 #endif
 
-        optimize_nr_threads_ = false;
-
 #ifdef OPTIMIZE_NR_THREADS
         set_optimization_of_thread_nr(true);
 #endif
@@ -299,6 +378,11 @@ public:
         }
 
         optimization_runs_ = 0;
+
+        if (!tuning_cache_path.empty())
+        {
+            autotune(tuning_cache_path, half_precision_occlusions);
+        }
     }
 
     /**
@@ -330,8 +414,28 @@ public:
             exit(-1);
         }
 
+        if (this->latency_metrics_ &&
+            this->latency_metrics_->trace() != trace_)
+        {
+            trace(this->latency_metrics_->trace());
+        }
+
         nr_poses_ = deltas.size();
-        std::vector<float> flog_likelihoods(nr_poses_, 0);
+        std::vector<float>& flog_likelihoods = log_likelihood_buffer_;
+        flog_likelihoods.assign(nr_poses_, 0);
+
+        // states beyond the memory which can be allocated are not evaluated
+        if (nr_poses_ > nr_max_poses_ && nr_max_poses_ < pose_limit_)
+        {
+            grow_memory(nr_poses_);
+        }
+        if (nr_poses_ > nr_max_poses_)
+        {
+            std::cout << "ERROR (CUDA): Only " << nr_max_poses_ << " of "
+                      << nr_poses_ << " poses fit into the GPU memory, "
+                      << "the others are not evaluated." << std::endl;
+            nr_poses_ = nr_max_poses_;
+        }
 
         int tmp_nr_poses;
         if (bufferConfig_->set_nr_of_poses(nr_poses_, tmp_nr_poses))
@@ -343,66 +447,16 @@ public:
             exit(-1);
         }
 
-        // transform occlusion indices from size_t to int
-        std::vector<int> occlusion_indices_transformed(occlusion_indices.size(),
-                                                       0);
-        for (size_t i = 0; i < occlusion_indices.size(); i++)
-        {
-            occlusion_indices_transformed[i] = (int)occlusion_indices[i];
-        }
-
-        // copy occlusion indices to GPU
-        cuda_->set_occlusion_indices(occlusion_indices_transformed.data(),
-                                     occlusion_indices.size());
+        // the evaluator resolves the indices to occlusion images, which are
+        // uploaded asynchronously with the poses
+        cuda_->set_occlusion_indices(
+            occlusion_indices.data(),
+            std::min(int(occlusion_indices.size()), nr_poses_));
 
 #ifdef PROFILING_ACTIVE
         store_time(SET_OCCLUSION_INDICES);
 #endif
 
-        int nr_objects = vertices_.size();
-
-        std::vector<std::vector<Eigen::Matrix4f>> poses(
-            nr_poses_, std::vector<Eigen::Matrix4f>(nr_objects));
-
-        for (size_t i_state = 0; i_state < size_t(nr_poses_); i_state++)
-        {
-            for (size_t i_obj = 0; i_obj < nr_objects; i_obj++)
-            {
-                auto pose_0 = this->default_poses_.component(i_obj);
-                auto delta = deltas[i_state].component(i_obj);
-
-                dbot::PoseVector pose;
-
-                /// \todo: this should be done through the the apply_delta
-                /// function
-                pose.position() =
-                    pose_0.orientation().rotation_matrix() * delta.position() +
-                    pose_0.position();
-                pose.orientation() = pose_0.orientation() * delta.orientation();
-
-                poses[i_state][i_obj] = pose.homogeneous().cast<float>();
-            }
-        }
-
-#ifdef PROFILING_ACTIVE
-        store_time(CONVERTING_STATE_FORMAT);
-#endif
-
-        opengl_->render(poses);
-
-#ifdef PROFILING_ACTIVE
-        store_time(RENDERING);
-#endif
-
-        cudaGraphicsMapResources(1, &texture_resource_, 0);
-        cudaGraphicsSubResourceGetMappedArray(
-            &texture_array_, texture_resource_, 0, 0);
-        cuda_->map_texture_to_texture_array(texture_array_);
-
-#ifdef PROFILING_ACTIVE
-        store_time(MAPPING);
-#endif
-
         if (optimize_nr_threads_)
         {
             if (nr_threads_ <= max_nr_threads_)
@@ -432,7 +486,103 @@ public:
             }
         }
 
-        cuda_->weigh_poses(update_occlusions, flog_likelihoods);
+        // the poses are rendered and evaluated in batches which alternate
+        // between the framebuffer textures. All CUDA work is enqueued on the
+        // evaluation stream, such that the next batch is rasterized while
+        // the previous one is still evaluated, and only the read back of the
+        // likelihoods waits for the GPU.
+        const int nr_batches = std::min(nr_pipeline_batches_, nr_poses_);
+        cudaStream_t stream = cuda_->get_stream();
+        bool weighting = nr_batches > 0;
+
+        cuda_stage_timer_->begin_frame();
+
+        // host time of handing the rendered textures between GL and CUDA
+        double mapping_seconds = 0;
+        LatencyMetrics::Clock::time_point mapping_start;
+
+        const bool incremental = weighting && use_depth_layers();
+        if (incremental)
+        {
+            weighting = weigh_depth_layers(
+                deltas, update_occlusions, mapping_seconds);
+        }
+
+        for (int i_batch = 0; i_batch < nr_batches && weighting && !incremental;
+             i_batch++)
+        {
+            const int first_pose = nr_poses_ * i_batch / nr_batches;
+            const int batch_size =
+                nr_poses_ * (i_batch + 1) / nr_batches - first_pose;
+            const int texture_nr =
+                i_batch % ObjectRasterizer::NR_FRAMEBUFFER_TEXTURES;
+
+            opengl_->set_render_target(texture_nr);
+            LatencyMetrics::Clock::time_point render_start =
+                LatencyMetrics::Clock::now();
+            render_batch(deltas, first_pose, batch_size);
+            if (trace_) this->latency_metrics_->span("render", render_start);
+            nr_poses_last_batch_ = batch_size;
+
+#ifdef PROFILING_ACTIVE
+            store_time(RENDERING);
+#endif
+
+            mapping_start = LatencyMetrics::Clock::now();
+            cudaGraphicsMapResources(
+                1, &texture_resources_[texture_nr], stream);
+            cudaGraphicsSubResourceGetMappedArray(
+                &texture_array_, texture_resources_[texture_nr], 0, 0);
+            cuda_->map_texture_to_texture_array(texture_array_, texture_nr);
+            mapping_seconds += LatencyMetrics::elapsed(mapping_start);
+
+#ifdef PROFILING_ACTIVE
+            store_time(MAPPING);
+#endif
+
+            if (i_batch == 0)
+            {
+                weighting = cuda_->begin_weighting(update_occlusions);
+            }
+            if (weighting)
+            {
+                cuda_->weigh_batch(texture_nr,
+                                   first_pose,
+                                   batch_size,
+                                   opengl_->get_bounding_boxes().data());
+            }
+
+            // ordered after the weighting on the stream, OpenGL waits for it
+            // only once it renders into this texture again
+            mapping_start = LatencyMetrics::Clock::now();
+            cudaGraphicsUnmapResources(
+                1, &texture_resources_[texture_nr], stream);
+            mapping_seconds += LatencyMetrics::elapsed(mapping_start);
+
+#ifdef PROFILING_ACTIVE
+            store_time(WEIGHTING);
+#endif
+        }
+        cuda_stage_timer_->mark();
+
+        if (weighting)
+        {
+            LatencyMetrics::Clock::time_point read_back_start =
+                LatencyMetrics::Clock::now();
+            cuda_->end_weighting(flog_likelihoods);
+            if (trace_)
+            {
+                this->latency_metrics_->span("read_back", read_back_start);
+            }
+        }
+        cuda_stage_timer_->mark();
+        cuda_stage_timer_->end_frame();
+
+        if (this->latency_metrics_)
+        {
+            this->latency_metrics_->add(LatencyMetrics::MAPPING,
+                                        mapping_seconds);
+        }
 
         if (optimize_nr_threads_)
         {
@@ -458,21 +608,18 @@ public:
             }
         }
 
-#ifdef PROFILING_ACTIVE
-        store_time(WEIGHTING);
-#endif
-
-        cudaGraphicsUnmapResources(1, &texture_resource_, 0);
-
         if (update_occlusions)
         {
             for (size_t i_state = 0; i_state < occlusion_indices.size();
                  i_state++)
-                occlusion_indices[i_state] = i_state;
+                occlusion_indices[i_state] =
+                    int(i_state) < nr_poses_ ? i_state : 0;
         }
 
-        // convert
-        RealArray log_likelihoods(flog_likelihoods.size());
+        // convert, the states which were not evaluated are as unlikely as
+        // the particles the filter prunes
+        RealArray log_likelihoods =
+            RealArray::Constant(deltas.size(), -1e10);
         for (size_t i = 0; i < flog_likelihoods.size(); i++)
             log_likelihoods[i] = flog_likelihoods[i];
 
@@ -502,10 +649,72 @@ public:
 
         observation_time_ += this->delta_time_;
 
-        cuda_->set_observations(std_measurement.data(), observation_time_);
+        // images of the size of the region of interest are taken as they are
+        if (region_of_interest_ && image.size() == frame_rows_ * frame_cols_)
+        {
+            update_region_of_interest();
+            region_observations_.resize(nr_rows_ * nr_cols_);
+            region_of_interest_->crop(
+                std_measurement.data(), 1, region_observations_.data());
+            cuda_->set_observations(region_observations_.data(),
+                                    observation_time_);
+        }
+        else
+        {
+            cuda_->set_observations(std_measurement.data(), observation_time_);
+        }
         observations_set_ = true;
     }
 
+    /**
+     * \brief Uploads the depth frame straight from its buffer. Frames at an
+     * integer multiple of the resolution, e.g. native camera frames, are
+     * downsampled on the GPU. The time step is taken from the frame
+     * timestamps if they are known.
+     *
+     * Frames in page locked memory, see allocate_page_locked_depth_frame(),
+     * are uploaded asynchronously without a copy and kept until the next
+     * frame is set.
+     */
+    void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        observation_time_ += this->frame_delta_time(*frame);
+
+        const bool page_locked =
+            !region_of_interest_ && is_page_locked(frame->data());
+        if (region_of_interest_)
+        {
+            set_region_of_interest_frame(*frame);
+        }
+        else if (frame->size() == int(nr_rows_ * nr_cols_))
+        {
+            cuda_->set_observations(
+                frame->data(), observation_time_, page_locked);
+        }
+        else
+        {
+            cuda_->set_native_observations(frame->data(),
+                                           frame->rows(),
+                                           frame->cols(),
+                                           depth_pooling_,
+                                           observation_time_,
+                                           page_locked);
+        }
+
+        // the previous upload has finished when the evaluator returns
+        uploading_frame_ = page_locked ? frame : DepthFrame::ConstPtr();
+        observations_set_ = true;
+    }
+
+    /**
+     * \brief Pooling of the frames which are downsampled on the GPU
+     */
+    DepthDownsampler::Pooling depth_pooling() const { return depth_pooling_; }
+    void depth_pooling(DepthDownsampler::Pooling pooling)
+    {
+        depth_pooling_ = pooling;
+    }
+
     /** \brief Resets the occlusion probabilities and observation time */
     virtual void reset()
     {
@@ -522,6 +731,83 @@ public:
         observation_time_ = 0;
     }
 
+    /**
+     * \brief Resets the occlusion probabilities of the given slots only,
+     * leaving the other slots and the observation time as they are
+     */
+    void reset_slots(int first_slot, int nr_slots)
+    {
+        std::vector<float> occlusion_probabilities(nr_rows_ * nr_cols_,
+                                                   initial_occlusion_prob_);
+        for (int slot = first_slot; slot < first_slot + nr_slots; slot++)
+        {
+            cuda_->set_occlusion_probabilities(slot,
+                                               occlusion_probabilities.data());
+        }
+    }
+
+    /**
+     * \brief Restricts each object to a range of the states of the next
+     * loglikes() calls, see ObjectRasterizer::set_pose_ranges()
+     *
+     * \param [in] pose_ranges [object_nr] = {first_state, end_state}, all
+     * objects are rendered in all states if it is empty
+     */
+    void set_pose_ranges(const std::vector<std::pair<int, int>>& pose_ranges)
+    {
+        pose_ranges_ = pose_ranges;
+    }
+
+    /**
+     * \brief GPU time of the stages of ObjectRasterizer::render(), read back
+     * without blocking
+     */
+    const GpuStageTimes& render_stage_times() const
+    {
+        return opengl_->stage_times();
+    }
+
+    /**
+     * \brief GPU time of evaluating all batches, including mapping and
+     * unmapping the rendered textures, and of reading back the likelihoods,
+     * in this order, read back without blocking
+     */
+    const GpuStageTimes& cuda_stage_times() const
+    {
+        cuda_stage_timer_->collect();
+        return cuda_stage_timer_->times();
+    }
+
+    /**
+     * \brief Adds the GPU time of rendering and weighting to the metrics
+     * once it is read back without blocking, usually a few filter steps
+     * after it was spent, and the host time of mapping right away
+     */
+    virtual void latency_metrics(const std::shared_ptr<LatencyMetrics>& metrics)
+    {
+        RbSensor<State>::latency_metrics(metrics);
+        if (!metrics)
+        {
+            opengl_->stage_callback(nullptr);
+            cuda_stage_timer_->frame_callback(nullptr);
+            return;
+        }
+
+        opengl_->stage_callback([metrics](const std::vector<double>& seconds) {
+            double sum = 0;
+            for (double stage_seconds : seconds) sum += stage_seconds;
+            metrics->add(LatencyMetrics::RENDERING, sum);
+        });
+        cuda_stage_timer_->frame_callback(
+            [metrics](const std::vector<double>& seconds) {
+                double sum = 0;
+                for (double stage_seconds : seconds) sum += stage_seconds;
+                metrics->add(LatencyMetrics::WEIGHTING, sum);
+            });
+    }
+
+    /** \brief Number of poses the GPU buffers were allocated for */
+    virtual int max_sample_count() const { return pose_limit_; }
     /** activates automatic optimization of the number of threads */
     void set_optimization_of_thread_nr(bool shouldOptimize)
     {
@@ -551,16 +837,141 @@ public:
         return occlusion_probs_matrix;
     }
 
+    /**
+     * \brief Returns the occlusion probabilities of the state with the given
+     * index as float image
+     */
+    std::vector<float> get_occlusion_image(int index) const
+    {
+        return cuda_->get_occlusion_probabilities(index);
+    }
+
+    /**
+     * \brief Overwrites the occlusion probabilities of the state with the
+     * given index with nr_rows * nr_cols values
+     */
+    void set_occlusion_image(int index, const std::vector<float>& image)
+    {
+        cuda_->set_occlusion_probabilities(index, image.data());
+    }
+
+    /**
+     * \brief Adds a coarser mesh of every object, see
+     * ObjectRasterizer::add_level_of_detail()
+     */
+    void add_level_of_detail(const TriangleMesh::ConstPtr& mesh)
+    {
+        opengl_->add_level_of_detail(mesh);
+    }
+
+    void set_level_of_detail_budget(float pixels_per_triangle)
+    {
+        opengl_->set_level_of_detail_budget(pixels_per_triangle);
+    }
+
+    /// \copydoc ObjectRasterizer::set_back_face_culling()
+    void set_back_face_culling(bool enabled)
+    {
+        opengl_->set_back_face_culling(enabled);
+    }
+
+    /**
+     * \brief Renders only the objects whose pose changed since the last
+     * loglikes() call, e.g. the object of the current sampling block of the
+     * coordinate particle filter. The depth of every object is kept per
+     * pose on the GPU and the kernel composes the depth of a pose from
+     * them. This applies to meshes of several objects which are rendered in
+     * all poses, and is turned off if the GPU lacks the memory.
+     */
+    void set_incremental_rendering(bool enabled)
+    {
+        incremental_rendering_ = enabled;
+        invalidate_depth_layers();
+    }
+
+    /**
+     * \brief Launches the CUDA part of every evaluation as CUDA graphs, see
+     *        CudaEvaluator::set_graph_capture()
+     *
+     * The graphs are instantiated after the buffer configuration settles,
+     * i.e. on the first evaluation after the memory was allocated or grown
+     * and the thread count was chosen.
+     */
+    void set_graph_capture(bool enabled) { cuda_->set_graph_capture(enabled); }
+
+    /**
+     * \brief Keeps the likelihoods on the GPU and resamples the states
+     *        there, see resample_on_device() and
+     *        CudaEvaluator::set_device_resampling()
+     *
+     * loglikes() then returns zeros instead of the likelihoods.
+     */
+    void set_device_resampling(bool enabled)
+    {
+        cuda_->set_device_resampling(enabled);
+    }
+
+    /**
+     * \brief Resamples the states of the last loglikes() call on the GPU
+     *        and returns their mean, the only value which is read back
+     *
+     * The weights of the states accumulate the likelihoods of every call
+     * until the states are resampled, which happens once their KL
+     * divergence from the uniform distribution exceeds max_kl_divergence.
+     * The ancestors of the states stay on the GPU and select the occlusions
+     * of the next loglikes() call, whose occlusion indices are ignored then.
+     * Callers which keep the states on the host fetch the ancestors with
+     * resampled_ancestors().
+     */
+    State resample_on_device(const StateArray& deltas,
+                             fl::Real max_kl_divergence)
+    {
+        const int dimension = deltas[0].size();
+        resampling_states_.resize(nr_poses_ * dimension);
+        for (int i = 0; i < nr_poses_; i++)
+        {
+            for (int k = 0; k < dimension; k++)
+            {
+                resampling_states_[i * dimension + k] = deltas[i](k);
+            }
+        }
+
+        resampling_mean_.resize(dimension);
+        cuda_->resample_poses(resampling_states_.data(),
+                              dimension,
+                              max_kl_divergence,
+                              resampling_offset_(resampling_generator_),
+                              resampling_mean_.data());
+
+        State mean = deltas[0];
+        for (int k = 0; k < dimension; k++) mean(k) = resampling_mean_[k];
+        return mean;
+    }
+
+    /**
+     * \brief The state of the last loglikes() call each state was resampled
+     *        from by resample_on_device()
+     */
+    std::vector<int> resampled_ancestors()
+    {
+        std::vector<int> ancestors;
+        cuda_->get_ancestors(ancestors);
+        return ancestors;
+    }
+
     /**
      * \brief Returns the depth values of the rendered states
      *
+     * With more than one pipeline batch, only the states of the last batch
+     * are still in the framebuffer.
+     *
      * \return an Eigen Matrix containing the depth values per pixel, stored in
      * a 1D array denoting the respective pose
       */
     std::vector<Eigen::Map<Observation>> get_range_image()
     {
         std::vector<std::vector<float>> depth_values_raw =
-            opengl_->get_depth_values(nr_poses_);
+            opengl_->get_depth_values(nr_poses_last_batch_);
 
         // convert depth values to doubles
         std::vector<std::vector<double>> depth_values_raw_double;
@@ -651,9 +1062,641 @@ public:
 
 private:
     const Eigen::Matrix3d camera_matrix_;
+    // resolution of the rendered and evaluated images, i.e. of the region
+    // of interest if there is one
     int nr_rows_;
     int nr_cols_;
+    // resolution of the sensor images
+    int frame_rows_;
+    int frame_cols_;
+
+    // window the poses are evaluated in, none evaluates the whole image
+    std::shared_ptr<RegionOfInterest> region_of_interest_;
+    std::vector<Eigen::AlignedBox3d> part_boxes_;
+    RegionOfInterest::Poses region_poses_;
+    std::vector<float> region_observations_;
+    // poses the memory is allocated for, and the number it may grow to
     int nr_max_poses_;
+    int pose_limit_;
+
+    /**
+     * \brief Moves the region of interest onto the object at the integrated
+     * poses if it left the region, together with the occlusions and the
+     * projection of the renderer
+     */
+    void update_region_of_interest()
+    {
+        region_poses_.resize(this->default_poses_.count());
+        for (size_t i_obj = 0; i_obj < region_poses_.size(); i_obj++)
+        {
+            region_poses_[i_obj] =
+                this->default_poses_.component(i_obj).affine();
+        }
+
+        const PixelRegion previous = region_of_interest_->region();
+        if (!region_of_interest_->follow(region_of_interest_->footprint(
+                part_boxes_, region_poses_, camera_matrix_)))
+        {
+            return;
+        }
+
+        const PixelRegion& region = region_of_interest_->region();
+        cuda_->shift_occlusions(region.row - previous.row,
+                                region.col - previous.col);
+        opengl_->set_camera_matrix(
+            region_of_interest_->camera_matrix(camera_matrix_).cast<float>());
+        invalidate_depth_layers();
+    }
+
+    /**
+     * \brief Whether the poses are weighted with weigh_depth_layers(),
+     * allocates the layers first if needed
+     */
+    bool use_depth_layers()
+    {
+        const int nr_objects = mesh_->count_parts();
+        if (!incremental_rendering_ || nr_objects < 2 || !pose_ranges_.empty())
+        {
+            return false;
+        }
+
+        if (cuda_->get_depth_layer_poses() != nr_max_poses_)
+        {
+            invalidate_depth_layers();
+            if (!cuda_->allocate_depth_layers(nr_objects))
+            {
+                std::cout << "WARNING: not enough GPU memory for the depth "
+                          << "layers of " << nr_objects << " objects, all "
+                          << "objects are rendered in every pose" << std::endl;
+                incremental_rendering_ = false;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * \brief Forgets the depth layers of the last call, e.g. after the
+     * projection changed
+     */
+    void invalidate_depth_layers()
+    {
+        layer_pose_count_ = 0;
+        layer_poses_.clear();
+    }
+
+    /**
+     * \brief Hash of the bits of the rotation and translation of the pose,
+     * the layers are reused for exactly equal poses only
+     */
+    static size_t hash_pose(const Eigen::Matrix4f& pose)
+    {
+        uint64_t hash = 0;
+        for (int i = 0; i < 12; ++i)
+        {
+            uint32_t bits;
+            const float value = pose(i);
+            std::memcpy(&bits, &value, sizeof(bits));
+            hash = combine_hash(hash, bits);
+        }
+        return size_t(hash);
+    }
+
+    /**
+     * \return The pose of the last call whose layer of the object was drawn
+     * at the given pose, or -1
+     */
+    int find_previous_layer(int i_obj, int i_state, const Eigen::Matrix4f& pose)
+    {
+        const int count = previous_layer_pose_count_;
+        if (i_state < count &&
+            previous_layer_poses_[i_obj * count + i_state] == pose)
+        {
+            return i_state;
+        }
+
+        const auto& lookup = previous_layer_lookup_[i_obj];
+        auto it = lookup.find(hash_pose(pose));
+        if (it != lookup.end() &&
+            previous_layer_poses_[i_obj * count + it->second] == pose)
+        {
+            return it->second;
+        }
+        return -1;
+    }
+
+    /**
+     * \brief Renders the objects whose pose changed since the last call
+     * into their depth layers, one object per render call, copies the
+     * layers of the other objects from the last call and weighs the poses
+     * on the layers
+     *
+     * The coordinate particle filter changes one object per sampling block,
+     * such that a block renders one object instead of all of them. The
+     * layers of the last call are found by pose, since resampling moves the
+     * particles to other states.
+     *
+     * \return false if the weighting could not be started
+     */
+    bool weigh_depth_layers(const StateArray& deltas,
+                            bool update_occlusions,
+                            double& mapping_seconds)
+    {
+        const int nr_objects = mesh_->count_parts();
+        const int nr_poses = nr_poses_;
+        cudaStream_t stream = cuda_->get_stream();
+
+        // index the layers of the last call by pose
+        cuda_->swap_depth_layers();
+        layer_poses_.swap(previous_layer_poses_);
+        layer_boxes_.swap(previous_layer_boxes_);
+        previous_layer_pose_count_ = layer_pose_count_;
+        previous_layer_lookup_.resize(nr_objects);
+        for (int i_obj = 0; i_obj < nr_objects; i_obj++)
+        {
+            auto& lookup = previous_layer_lookup_[i_obj];
+            lookup.clear();
+            for (int i = 0; i < previous_layer_pose_count_; i++)
+            {
+                lookup.insert(std::make_pair(
+                    hash_pose(previous_layer_poses_
+                                  [i_obj * previous_layer_pose_count_ + i]),
+                    i));
+            }
+        }
+
+        // compose the poses like render_batch() and find the unchanged ones
+        delta_columns_.gather(deltas, 0, nr_poses);
+        delta_columns_.expand(this->default_poses_);
+        layer_pose_count_ = nr_poses;
+        layer_poses_.resize(nr_objects * nr_poses);
+        layer_boxes_.resize(4 * nr_objects * nr_poses);
+        layer_sources_.resize(nr_objects * nr_poses);
+        changed_objects_.clear();
+        for (int i_obj = 0; i_obj < nr_objects; i_obj++)
+        {
+            bool changed = false;
+            for (int i_state = 0; i_state < nr_poses; i_state++)
+            {
+                const int layer = i_obj * nr_poses + i_state;
+                layer_poses_[layer] =
+                    delta_columns_.template homogeneous<float>(i_state, i_obj);
+                layer_sources_[layer] =
+                    find_previous_layer(i_obj, i_state, layer_poses_[layer]);
+                changed = changed || layer_sources_[layer] < 0;
+            }
+
+            if (changed)
+            {
+                changed_objects_.push_back(i_obj);
+                std::fill(layer_sources_.begin() + i_obj * nr_poses,
+                          layer_sources_.begin() + (i_obj + 1) * nr_poses,
+                          -1);
+                continue;
+            }
+            for (int i_state = 0; i_state < nr_poses; i_state++)
+            {
+                const int layer = i_obj * nr_poses + i_state;
+                const int source = i_obj * previous_layer_pose_count_ +
+                                   layer_sources_[layer];
+                std::copy(previous_layer_boxes_.begin() + 4 * source,
+                          previous_layer_boxes_.begin() + 4 * source + 4,
+                          layer_boxes_.begin() + 4 * layer);
+            }
+        }
+
+        // render the changed objects alone, alternating between the textures
+        for (size_t k = 0; k < changed_objects_.size(); k++)
+        {
+            const int i_obj = changed_objects_[k];
+            const int texture_nr =
+                k % ObjectRasterizer::NR_FRAMEBUFFER_TEXTURES;
+
+            opengl_->set_objects(std::vector<int>(1, i_obj));
+            opengl_->set_render_target(texture_nr);
+            render_batch(deltas, 0, nr_poses);
+            const std::vector<int>& boxes = opengl_->get_bounding_boxes();
+            std::copy(boxes.begin(),
+                      boxes.begin() + 4 * nr_poses,
+                      layer_boxes_.begin() + 4 * i_obj * nr_poses);
+
+#ifdef PROFILING_ACTIVE
+            store_time(RENDERING);
+#endif
+
+            LatencyMetrics::Clock::time_point mapping_start =
+                LatencyMetrics::Clock::now();
+            cudaGraphicsMapResources(
+                1, &texture_resources_[texture_nr], stream);
+            cudaGraphicsSubResourceGetMappedArray(
+                &texture_array_, texture_resources_[texture_nr], 0, 0);
+            cuda_->map_texture_to_texture_array(texture_array_, texture_nr);
+            cuda_->store_depth_layer(texture_nr, i_obj, nr_poses);
+            cudaGraphicsUnmapResources(
+                1, &texture_resources_[texture_nr], stream);
+            mapping_seconds += LatencyMetrics::elapsed(mapping_start);
+
+#ifdef PROFILING_ACTIVE
+            store_time(MAPPING);
+#endif
+        }
+        if (!changed_objects_.empty())
+        {
+            all_objects_.resize(nr_objects);
+            for (int i_obj = 0; i_obj < nr_objects; i_obj++)
+            {
+                all_objects_[i_obj] = i_obj;
+            }
+            opengl_->set_objects(all_objects_);
+            nr_poses_last_batch_ = nr_poses;
+        }
+        if (int(changed_objects_.size()) < nr_objects)
+        {
+            cuda_->gather_depth_layers(layer_sources_.data(), nr_poses);
+        }
+
+        // the compared pixels of a pose are those of any of its objects
+        pose_boxes_.resize(4 * nr_poses);
+        for (int i_state = 0; i_state < nr_poses; i_state++)
+        {
+            int* box = &pose_boxes_[4 * i_state];
+            box[0] = box[1] = 0;
+            box[2] = box[3] = -1;
+            for (int i_obj = 0; i_obj < nr_objects; i_obj++)
+            {
+                const int* object_box =
+                    &layer_boxes_[4 * (i_obj * nr_poses + i_state)];
+                if (object_box[0] > object_box[2] ||
+                    object_box[1] > object_box[3])
+                {
+                    continue;
+                }
+                if (box[0] > box[2])
+                {
+                    std::copy(object_box, object_box + 4, box);
+                    continue;
+                }
+                box[0] = std::min(box[0], object_box[0]);
+                box[1] = std::min(box[1], object_box[1]);
+                box[2] = std::max(box[2], object_box[2]);
+                box[3] = std::max(box[3], object_box[3]);
+            }
+        }
+
+        if (!cuda_->begin_weighting(update_occlusions)) return false;
+        cuda_->weigh_depth_layers(0, nr_poses, pose_boxes_.data());
+
+#ifdef PROFILING_ACTIVE
+        store_time(WEIGHTING);
+#endif
+        return true;
+    }
+
+    /**
+     * \brief Uploads the region of interest of a frame at the resolution of
+     * the sensor or at an integer multiple of it
+     */
+    void set_region_of_interest_frame(const DepthFrame& frame)
+    {
+        const int scale = frame.rows() / frame_rows_;
+        if (scale < 1 || frame.rows() != scale * frame_rows_ ||
+            frame.cols() != scale * frame_cols_)
+        {
+            std::cout << "ERROR: the frame of " << frame.rows() << " x "
+                      << frame.cols() << " pixels is no multiple of the "
+                      << "resolution " << frame_rows_ << " x " << frame_cols_
+                      << std::endl;
+            exit(-1);
+        }
+
+        update_region_of_interest();
+        region_observations_.resize(nr_rows_ * nr_cols_ * scale * scale);
+        region_of_interest_->crop(
+            frame.data(), scale, region_observations_.data());
+
+        if (scale == 1)
+        {
+            cuda_->set_observations(region_observations_.data(),
+                                    observation_time_);
+        }
+        else
+        {
+            cuda_->set_native_observations(region_observations_.data(),
+                                           nr_rows_ * scale,
+                                           nr_cols_ * scale,
+                                           depth_pooling_,
+                                           observation_time_);
+        }
+    }
+
+    /**
+     * \brief Renders the poses first_pose, ..., first_pose + nr_poses - 1
+     * into the current render target
+     */
+    void render_batch(const StateArray& deltas, int first_pose, int nr_poses)
+    {
+        int nr_objects = mesh_->count_parts();
+
+        // the pose ranges count from the first pose of the batch
+        if (!pose_ranges_.empty())
+        {
+            batch_pose_ranges_.resize(pose_ranges_.size());
+            for (size_t i_obj = 0; i_obj < pose_ranges_.size(); i_obj++)
+            {
+                batch_pose_ranges_[i_obj].first =
+                    pose_ranges_[i_obj].first - first_pose;
+                batch_pose_ranges_[i_obj].second =
+                    pose_ranges_[i_obj].second - first_pose;
+            }
+        }
+        else
+        {
+            batch_pose_ranges_.clear();
+        }
+        opengl_->set_pose_ranges(batch_pose_ranges_);
+
+        if (opengl_->uses_instancing())
+        {
+            // the vertex shader composes the poses with the default poses,
+            // such that only the deltas are converted and uploaded
+            default_model_poses_.resize(nr_objects);
+            for (size_t i_obj = 0; i_obj < nr_objects; i_obj++)
+            {
+                default_model_poses_[i_obj] = this->default_poses_
+                                                  .component(i_obj)
+                                                  .homogeneous()
+                                                  .template cast<float>();
+            }
+
+            pose_deltas_.resize(nr_poses * nr_objects * 6);
+            float* delta_data = pose_deltas_.data();
+            for (int i_state = 0; i_state < nr_poses; i_state++)
+            {
+                for (size_t i_obj = 0; i_obj < nr_objects; i_obj++)
+                {
+                    auto delta = deltas[first_pose + i_state].component(i_obj);
+                    Eigen::Map<Eigen::Vector3f> position(delta_data);
+                    Eigen::Map<Eigen::Vector3f> orientation(delta_data + 3);
+                    position = delta.position().template cast<float>();
+                    orientation = delta.orientation().template cast<float>();
+                    delta_data += 6;
+                }
+            }
+
+#ifdef PROFILING_ACTIVE
+            store_time(CONVERTING_STATE_FORMAT);
+#endif
+
+            opengl_->render(default_model_poses_, pose_deltas_, nr_poses);
+        }
+        else
+        {
+            std::vector<std::vector<Eigen::Matrix4f>> poses(
+                nr_poses, std::vector<Eigen::Matrix4f>(nr_objects));
+
+            // compose the deltas with the default poses of all states at once
+            delta_columns_.gather(deltas, first_pose, nr_poses);
+            delta_columns_.expand(this->default_poses_);
+            for (int i_state = 0; i_state < nr_poses; i_state++)
+            {
+                for (size_t i_obj = 0; i_obj < nr_objects; i_obj++)
+                {
+                    poses[i_state][i_obj] =
+                        delta_columns_.template homogeneous<float>(i_state,
+                                                                   i_obj);
+                }
+            }
+
+#ifdef PROFILING_ACTIVE
+            store_time(CONVERTING_STATE_FORMAT);
+#endif
+
+            opengl_->render(poses);
+        }
+    }
+
+    /**
+     * \brief Loads the tuned configuration of this setup from the cache, or
+     * benchmarks and stores it if there is none
+     *
+     * \param [in] half_precision_occlusions whether the occlusions are
+     * stored in half precision, which changes the cost of the evaluation
+     */
+    void autotune(const std::string& cache_path,
+                  const bool half_precision_occlusions)
+    {
+        const size_t nr_triangles = mesh_->count_triangles();
+
+        const cudaDeviceProp properties = cuda_->get_device_properties();
+        const std::string key =
+            GpuTuningCache::make_key(properties.name,
+                                     properties.major,
+                                     properties.minor,
+                                     nr_rows_,
+                                     nr_cols_,
+                                     nr_max_poses_,
+                                     mesh_->count_parts(),
+                                     nr_triangles,
+                                     opengl_->uses_instancing(),
+                                     nr_pipeline_batches_,
+                                     half_precision_occlusions);
+
+        GpuTuningCache cache(cache_path);
+        GpuTuning tuning;
+        if (!cache.find(key, tuning))
+        {
+            tuning = benchmark_configurations();
+            if (!cache.store(key, tuning))
+            {
+                std::cout << "WARNING: Could not write the GPU tuning cache "
+                          << cache.path() << "." << std::endl;
+            }
+        }
+
+        apply_configuration(tuning);
+        reset();
+    }
+
+    /**
+     * \brief Times all thread counts and render texture widths on a synthetic
+     * frame with the objects in front of the camera
+     */
+    GpuTuning benchmark_configurations()
+    {
+        const int nr_objects = mesh_->count_parts();
+
+        StateArray deltas(nr_max_poses_);
+        for (int i = 0; i < nr_max_poses_; i++)
+        {
+            deltas(i) = State(nr_objects);
+            deltas(i).setZero();
+            for (int i_obj = 0; i_obj < nr_objects; i_obj++)
+            {
+                // spread the poses a little, such that their bounding boxes
+                // differ as in a tracked frame
+                const double offset = 0.02 * ((i % 11) - 5);
+                deltas(i).component(i_obj).position() =
+                    Eigen::Vector3d(offset, -offset, 1.0);
+            }
+        }
+        set_observation(Observation::Constant(nr_rows_, nr_cols_, 1.0));
+
+        // the online thread optimization would change the configuration
+        // while it is timed
+        const bool optimize_nr_threads = optimize_nr_threads_;
+        optimize_nr_threads_ = false;
+
+        std::vector<int> nr_poses_per_row_candidates;
+        // rows of poses beyond the texture height go to further layers
+        const int max_nr_poses_per_col =
+            bufferConfig_->get_max_nr_poses_per_col() *
+            bufferConfig_->get_max_nr_layers();
+        for (int nr_poses_per_row = std::min(
+                 bufferConfig_->get_max_nr_poses_per_row(), nr_max_poses_);
+             nr_poses_per_row > 0 &&
+             (nr_max_poses_ + nr_poses_per_row - 1) / nr_poses_per_row <=
+                 max_nr_poses_per_col;
+             nr_poses_per_row /= 2)
+        {
+            nr_poses_per_row_candidates.push_back(nr_poses_per_row);
+        }
+
+        const int max_nr_threads = cuda_->get_max_nr_threads();
+        const int warp_size = cuda_->get_warp_size();
+
+        GpuTuning best;
+        double best_time = std::numeric_limits<double>::infinity();
+        for (int nr_poses_per_row : nr_poses_per_row_candidates)
+        {
+            for (int nr_threads = warp_size; nr_threads <= max_nr_threads;
+                 nr_threads *= 2)
+            {
+                GpuTuning tuning;
+                tuning.nr_threads = nr_threads;
+                tuning.nr_poses_per_row = nr_poses_per_row;
+                apply_configuration(tuning);
+
+                std::vector<double> times;
+                for (int round = 0; round < NR_TUNING_ROUNDS + 2; round++)
+                {
+                    IntArray indices = IntArray::Zero(nr_max_poses_);
+                    const double before = dbot::hf::get_wall_time();
+                    loglikes(deltas, indices, false);
+                    // the first rounds warm up caches and the driver
+                    if (round >= 2)
+                    {
+                        times.push_back(dbot::hf::get_wall_time() - before);
+                    }
+                }
+
+                std::nth_element(times.begin(),
+                                 times.begin() + times.size() / 2,
+                                 times.end());
+                const double time = times[times.size() / 2];
+                if (time < best_time)
+                {
+                    best_time = time;
+                    best = tuning;
+                }
+            }
+        }
+
+        optimize_nr_threads_ = optimize_nr_threads;
+        observations_set_ = false;
+        observation_time_ = 0;
+
+        std::cout << "Tuned GPU configuration: " << best.nr_threads
+                  << " threads, " << best.nr_poses_per_row
+                  << " poses per row (" << best_time << " s per evaluation)"
+                  << std::endl;
+        return best;
+    }
+
+    /**
+     * \brief Enlarges the GPU memory at least to the given number of poses,
+     * or geometrically, up to the limit. If it cannot be allocated the limit
+     * is reduced to the current number of poses.
+     */
+    void grow_memory(const int nr_poses)
+    {
+        const int nr_requested =
+            std::min(pose_limit_, std::max(nr_poses, 2 * nr_max_poses_));
+
+        // the render textures are reallocated and have to be registered anew
+        unregister_resource();
+        int tmp_max_nr_poses;
+        bufferConfig_->grow_memory(nr_requested, tmp_max_nr_poses);
+        register_resource();
+        invalidate_depth_layers();
+
+        if (tmp_max_nr_poses < nr_requested)
+        {
+            std::cout << "WARNING (CUDA): Could not allocate the GPU memory "
+                      << "for " << nr_requested << " poses, the maximum "
+                      << "number of poses is " << tmp_max_nr_poses << "."
+                      << std::endl;
+            pose_limit_ = tmp_max_nr_poses;
+        }
+        nr_max_poses_ = tmp_max_nr_poses;
+    }
+
+    /**
+     * \brief Records the spans of the GL and CUDA stages in the trace once
+     * they are read back, or stops recording them if the trace is null
+     */
+    void trace(const std::shared_ptr<TimelineTrace>& trace)
+    {
+        trace_ = trace;
+        if (!trace)
+        {
+            opengl_->timeline_callback(nullptr);
+            cuda_stage_timer_->timeline_callback(nullptr);
+            return;
+        }
+
+        opengl_->timeline_callback([trace](const std::vector<double>& begins,
+                                           const std::vector<double>& seconds) {
+            static const char* names[] = {
+                "attach_texture", "clear_screen", "render", "detach_texture"};
+            for (size_t stage = 0; stage < seconds.size() && stage < 4; stage++)
+            {
+                trace->device_span(
+                    names[stage], "opengl", begins[stage], seconds[stage]);
+            }
+        });
+        cuda_stage_timer_->timeline_callback(
+            [trace](const std::vector<double>& begins,
+                    const std::vector<double>& seconds) {
+                static const char* names[] = {"weighting", "read_back"};
+                for (size_t stage = 0; stage < seconds.size() && stage < 2;
+                     stage++)
+                {
+                    trace->device_span(
+                        names[stage], "cuda", begins[stage], seconds[stage]);
+                }
+            });
+    }
+
+    void apply_configuration(const GpuTuning& tuning)
+    {
+        // the render textures are reallocated and have to be registered anew
+        unregister_resource();
+        int tmp_max_nr_poses;
+        if (!bufferConfig_->set_nr_poses_per_row(tuning.nr_poses_per_row,
+                                                 tmp_max_nr_poses))
+        {
+            exit(-1);
+        }
+        nr_max_poses_ = tmp_max_nr_poses;
+        register_resource();
+
+        int tmp_nr_threads;
+        if (!bufferConfig_->set_number_of_threads(tuning.nr_threads,
+                                                  tmp_nr_threads))
+        {
+            exit(-1);
+        }
+    }
 
     void store_time(int task)
     {
@@ -680,12 +1723,16 @@ private:
     {
         if (!resource_registered_)
         {
-            opengl_texture_ = opengl_->get_framebuffer_texture();
-            cudaGraphicsGLRegisterImage(&texture_resource_,
-                                        opengl_texture_,
-                                        GL_TEXTURE_2D,
-                                        cudaGraphicsRegisterFlagsReadOnly);
-            check_cuda_error("cudaGraphicsGLRegisterImage)");
+            for (int i = 0; i < ObjectRasterizer::NR_FRAMEBUFFER_TEXTURES; i++)
+            {
+                opengl_textures_[i] = opengl_->get_framebuffer_texture(i);
+                cudaGraphicsGLRegisterImage(
+                    &texture_resources_[i],
+                    opengl_textures_[i],
+                    opengl_->get_framebuffer_texture_target(),
+                    cudaGraphicsRegisterFlagsReadOnly);
+                check_cuda_error("cudaGraphicsGLRegisterImage)");
+            }
             resource_registered_ = true;
         }
     }
@@ -694,16 +1741,19 @@ private:
     {
         if (resource_registered_)
         {
-            cudaGraphicsUnregisterResource(texture_resource_);
-            check_cuda_error("cudaGraphicsUnregisterResource");
+            for (int i = 0; i < ObjectRasterizer::NR_FRAMEBUFFER_TEXTURES; i++)
+            {
+                cudaGraphicsUnregisterResource(texture_resources_[i]);
+                check_cuda_error("cudaGraphicsUnregisterResource");
+            }
             resource_registered_ = false;
         }
     }
 
     // OpenGL handle and input
     boost::shared_ptr<ObjectRasterizer> opengl_;
-    std::vector<std::vector<Eigen::Vector3f>> vertices_;
-    std::vector<std::vector<std::vector<int>>> indices_;
+    TriangleMesh::ConstPtr mesh_;
+    DepthDownsampler::Pooling depth_pooling_ = DepthDownsampler::MEAN_POOLING;
     std::string vertex_shader_path_;
     std::string fragment_shader_path_;
 
@@ -723,14 +1773,58 @@ private:
     float exponential_rate_;
     std::vector<float> occlusion_probs_;
 
+    // page locked frame whose upload may still be in flight
+    DepthFrame::ConstPtr uploading_frame_;
+
+    // log likelihoods read back from the evaluator, reused across calls
+    std::vector<float> log_likelihood_buffer_;
+
+    // states uploaded and mean read back by resample_on_device(), and the
+    // offsets of the systematic resampling
+    std::vector<float> resampling_states_;
+    std::vector<float> resampling_mean_;
+    std::mt19937 resampling_generator_;
+    std::uniform_real_distribution<float> resampling_offset_{0.f, 1.f};
+
+    // reused input of the instanced renderer
+    std::vector<Eigen::Matrix4f> default_model_poses_;
+    std::vector<float> pose_deltas_;
+
+    // deltas composed with the default poses for the plain renderer
+    RigidBodiesStateArray<State> delta_columns_;
+
+    // depth layers of the objects of the last two calls in incremental
+    // rendering, {object_nr * layer_pose_count_ + pose_nr} like on the GPU
+    typedef std::vector<Eigen::Matrix4f,
+                        Eigen::aligned_allocator<Eigen::Matrix4f>> LayerPoses;
+    bool incremental_rendering_ = false;
+    int layer_pose_count_ = 0;
+    int previous_layer_pose_count_ = 0;
+    LayerPoses layer_poses_;
+    LayerPoses previous_layer_poses_;
+    std::vector<int> layer_boxes_;
+    std::vector<int> previous_layer_boxes_;
+    std::vector<std::unordered_map<size_t, int>> previous_layer_lookup_;
+    std::vector<int> layer_sources_;
+    std::vector<int> changed_objects_;
+    std::vector<int> all_objects_;
+    std::vector<int> pose_boxes_;
+
+    // states each object is rendered in, absolute and relative to a batch
+    std::vector<std::pair<int, int>> pose_ranges_;
+    std::vector<std::pair<int, int>> batch_pose_ranges_;
+
     // amount of poses and pose distribution in the OpenGL texture
     int nr_poses_;
     int nr_poses_per_row_;
     int nr_poses_per_column_;
+    int nr_pipeline_batches_;
+    int nr_poses_last_batch_;
 
-    // Shared resource between OpenGL and CUDA
-    GLuint opengl_texture_;
-    cudaGraphicsResource* texture_resource_;
+    // Shared resources between OpenGL and CUDA, one per framebuffer texture
+    GLuint opengl_textures_[ObjectRasterizer::NR_FRAMEBUFFER_TEXTURES];
+    cudaGraphicsResource*
+        texture_resources_[ObjectRasterizer::NR_FRAMEBUFFER_TEXTURES];
     cudaArray_t texture_array_;
 
     // booleans to ensure correct usage of function calls
@@ -748,6 +1842,10 @@ private:
         UNMAPPING
     };
     double time_[NR_SUBTASKS_TO_MEASURE];
+    static const int NR_CUDA_STAGES = 2;
+    std::unique_ptr<CudaStageTimer> cuda_stage_timer_;
+    // trace of the latency metrics the stage timers record spans in
+    std::shared_ptr<TimelineTrace> trace_;
     std::string strings_for_subtasks_[NR_SUBTASKS_TO_MEASURE];
     double time_before_, time_after_;
     int count_;
@@ -763,6 +1861,8 @@ private:
     double average_time_;
     bool stop_optimizing_;
     static const int NR_ROUNDS_PER_SETTING_ = 30;
+    // timed evaluations of each configuration tried by the autotuner
+    static const int NR_TUNING_ROUNDS = 5;
     int optimization_runs_;
 
     // optional flag for optimizing the #threads
@@ -0,0 +1,139 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_gpu_test.cpp
+ * \date October 2026
+ *
+ * Requires a CUDA device and an OpenGL context, it is only built with
+ * DBOT_BUILD_GPU.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+
+#include <dbot/benchmark/synthetic_scene.h>
+#include <dbot/default_shader_provider.h>
+#include <dbot/gpu/kinect_image_model_gpu.h>
+
+namespace
+{
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModelGPU<State> Model;
+
+const int rows = 240;
+const int cols = 320;
+
+/**
+ * \brief Model of an ellipsoid which renders into a single texture or into
+ *        layered textures, like the GPU benchmark of dbot_micro_benchmark
+ */
+std::shared_ptr<Model> make_model(int nr_poses, bool layered)
+{
+    Eigen::Matrix3d camera_matrix = Eigen::Matrix3d::Identity();
+    camera_matrix(0, 0) = camera_matrix(1, 1) = 525. * cols / 640.;
+    camera_matrix(0, 2) = 0.5 * cols;
+    camera_matrix(1, 2) = 0.5 * rows;
+
+    auto object = std::make_shared<dbot::ObjectModel>(
+        std::make_shared<dbot::SyntheticObjectLoader>(1, 16), false);
+    auto model = std::shared_ptr<Model>(new Model(
+        camera_matrix,
+        rows,
+        cols,
+        nr_poses,
+        object->mesh(),
+        std::make_shared<dbot::DefaultShaderProvider>(),
+        false,
+        false,
+        0.1,
+        0.033,
+        0.1f,
+        0.7f,
+        0.01f,
+        0.003f,
+        0.0014247f,
+        6.0f,
+        -std::log(0.5f),
+        true,
+        2,
+        false,
+        "",
+        "",
+        0,
+        0,
+        8,
+        0,
+        layered));
+    model->set_observation(Model::Observation::Constant(rows, cols, 1.));
+    return model;
+}
+
+/**
+ * \brief Weighs nr_poses identical poses of the object in front of the
+ *        camera
+ */
+Model::RealArray weigh_identical_poses(Model& model, int nr_poses)
+{
+    Model::StateArray deltas(nr_poses);
+    for (int i = 0; i < nr_poses; i++)
+    {
+        deltas(i) = State(1);
+        deltas(i).setZero();
+        deltas(i).component(0).position() = Eigen::Vector3d(0, 0, 0.3);
+    }
+    Model::IntArray indices = Model::IntArray::Zero(nr_poses);
+    return model.loglikes(deltas, indices, false);
+}
+}
+
+TEST(KinectImageModelGpuTests, layered_target_weighs_like_the_single_texture)
+{
+    const int nr_poses = 1000;
+    auto single = make_model(nr_poses, false);
+    auto layered = make_model(nr_poses, true);
+    ASSERT_GE(single->max_sample_count(), nr_poses);
+    ASSERT_GE(layered->max_sample_count(), nr_poses);
+
+    const Model::RealArray expected = weigh_identical_poses(*single, nr_poses);
+    const Model::RealArray actual = weigh_identical_poses(*layered, nr_poses);
+    ASSERT_TRUE(std::isfinite(expected(0)));
+    for (int i = 0; i < nr_poses; i++)
+    {
+        EXPECT_NEAR(expected(0), expected(i), 1e-6 * std::fabs(expected(0)));
+        EXPECT_NEAR(expected(0), actual(i), 1e-6 * std::fabs(expected(0)));
+    }
+}
+
+TEST(KinectImageModelGpuTests, layered_target_weighs_every_layer)
+{
+    // beyond the grid of poses of a single texture at this resolution on
+    // most devices, such that the poses spread over several layers
+    const int nr_poses = 10000;
+    auto layered = make_model(nr_poses, true);
+    ASSERT_GE(layered->max_sample_count(), nr_poses);
+
+    const Model::RealArray log_likelihoods =
+        weigh_identical_poses(*layered, nr_poses);
+    ASSERT_TRUE(std::isfinite(log_likelihoods(0)));
+    for (int i = 1; i < nr_poses; i++)
+    {
+        // a layer which is not rendered or read back differs
+        ASSERT_NEAR(log_likelihoods(0),
+                    log_likelihoods(i),
+                    1e-6 * std::fabs(log_likelihoods(0)))
+            << "pose " << i;
+    }
+}
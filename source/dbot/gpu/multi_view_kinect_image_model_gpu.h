@@ -0,0 +1,278 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file multi_view_kinect_image_model_gpu.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include <dbot/gpu/kinect_image_model_gpu.h>
+#include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/pose/pose_vector.h>
+#include <dbot/worker_thread.h>
+
+namespace dbot
+{
+/**
+ * \brief Evaluates the particles in several calibrated depth cameras at once
+ *        and fuses their log likelihoods
+ *
+ * Each view is a KinectImageModelGPU with the camera matrix and resolution
+ * of its camera, its own occlusion images and its own GL context. A view is
+ * owned by a worker thread which creates it and issues all of its calls, such
+ * that all views render and evaluate the same particles concurrently within
+ * one filter step. The poses are given in the frame of the reference camera
+ * and moved into the frame of each view by its extrinsic calibration. The
+ * model of a view can be created by RbSensorBuilder::create_gpu_model() of a
+ * builder with the camera data of that view.
+ *
+ * Since the views are independent given the object pose, the log likelihood
+ * of a particle is the sum of its log likelihoods in all views. The sums are
+ * formed on the host, which reads one value per particle and view. A view
+ * keeps the occlusion images of the particles as seen from its camera, all
+ * views follow the same resampling.
+ */
+template <typename State>
+class MultiViewKinectImageModelGPU : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef KinectImageModelGPU<State> View;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+    typedef typename Base::PoseArray PoseArray;
+
+    typedef PoseVector::HomogeneousMatrix HomogeneousMatrix;
+    typedef std::vector<HomogeneousMatrix,
+                        Eigen::aligned_allocator<HomogeneousMatrix>>
+        ViewPoses;
+
+    /// creates the model of the view with the given index
+    typedef std::function<std::shared_ptr<View>(int)> ViewFactory;
+
+    /**
+     * \param view_poses   Pose of the reference camera in the frame of each
+     *                     camera, the identity for the reference camera
+     * \param create_view  Called once per view on the worker thread of the
+     *                     view
+     */
+    MultiViewKinectImageModelGPU(const ViewPoses& view_poses,
+                                 const ViewFactory& create_view,
+                                 const fl::Real& delta_time)
+        : Base(delta_time), view_poses_(view_poses)
+    {
+        if (view_poses_.empty())
+        {
+            std::cout << "ERROR (CUDA): At least one camera view is needed "
+                      << "for the multi view GPU sensor." << std::endl;
+            exit(-1);
+        }
+
+        for (size_t i = 0; i < view_poses_.size(); i++)
+        {
+            workers_.emplace_back(new WorkerThread());
+        }
+        views_.resize(view_poses_.size());
+        for (size_t i = 0; i < views_.size(); i++)
+        {
+            std::shared_ptr<View>& view = views_[i];
+            const int index = i;
+            workers_[i]->post([&view, &create_view, index]() {
+                view = create_view(index);
+            });
+        }
+        wait_all();
+
+        this->default_poses_ = views_[0]->integrated_poses();
+    }
+
+    virtual ~MultiViewKinectImageModelGPU() noexcept
+    {
+        // each view is destroyed on its thread, where its context is current
+        for (size_t i = 0; i < views_.size(); i++)
+        {
+            std::shared_ptr<View>& view = views_[i];
+            workers_[i]->post([&view]() { view.reset(); });
+        }
+        wait_all();
+    }
+
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        const int view_count = views_.size();
+
+        if (int(deltas.size()) > max_sample_count())
+        {
+            std::cout << "ERROR (CUDA): You tried to evaluate more poses ("
+                      << deltas.size() << ") than every view holds ("
+                      << max_sample_count() << ")." << std::endl;
+            exit(-1);
+        }
+
+        view_integrated_poses_.resize(view_count);
+        view_indices_.resize(view_count);
+        view_loglikes_.resize(view_count);
+        for (int v = 0; v < view_count; v++)
+        {
+            move_to_view(v, view_integrated_poses_[v]);
+            view_indices_[v] = indices;
+        }
+
+        for (int v = 0; v < view_count; v++)
+        {
+            View* view = views_[v].get();
+            workers_[v]->post([this, v, view, &deltas, update]() {
+                view->integrated_poses() = view_integrated_poses_[v];
+                view_loglikes_[v] =
+                    view->loglikes(deltas, view_indices_[v], update);
+            });
+        }
+        wait_all();
+
+        RealArray log_likelihoods = view_loglikes_[0];
+        for (int v = 1; v < view_count; v++)
+        {
+            log_likelihoods += view_loglikes_[v];
+        }
+
+        // the views rearrange their occlusion images alike
+        if (update) indices = view_indices_[0];
+
+        return log_likelihoods;
+    }
+
+    /**
+     * \brief Sets the observation of a sensor with a single view, several
+     *        views need one frame each through set_depth_frames()
+     */
+    void set_observation(const Observation& image)
+    {
+        check_single_view();
+        View* view = views_[0].get();
+        workers_[0]->post([view, &image]() { view->set_observation(image); });
+        wait_all();
+    }
+
+    void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        set_depth_frames(std::vector<DepthFrame::ConstPtr>(1, frame));
+    }
+
+    /**
+     * \brief Sets the frames of all views, in the order of the view poses
+     */
+    void set_depth_frames(const std::vector<DepthFrame::ConstPtr>& frames)
+    {
+        if (frames.size() != views_.size())
+        {
+            std::cout << "ERROR (CUDA): " << frames.size() << " depth frames "
+                      << "for " << views_.size() << " camera views."
+                      << std::endl;
+            exit(-1);
+        }
+
+        for (size_t i = 0; i < views_.size(); i++)
+        {
+            View* view = views_[i].get();
+            const DepthFrame::ConstPtr& frame = frames[i];
+            workers_[i]->post([view, &frame]() {
+                view->set_depth_frame(frame);
+            });
+        }
+        wait_all();
+    }
+
+    virtual void reset()
+    {
+        for (size_t i = 0; i < views_.size(); i++)
+        {
+            View* view = views_[i].get();
+            workers_[i]->post([view]() { view->reset(); });
+        }
+        wait_all();
+    }
+
+    /** \brief Number of poses every view was allocated for */
+    virtual int max_sample_count() const
+    {
+        int count = views_[0]->max_sample_count();
+        for (auto& view : views_)
+        {
+            count = std::min(count, view->max_sample_count());
+        }
+        return count;
+    }
+
+    int view_count() const { return views_.size(); }
+    const HomogeneousMatrix& view_pose(int view) const
+    {
+        return view_poses_[view];
+    }
+
+private:
+    void wait_all()
+    {
+        for (auto& worker : workers_) worker->wait();
+    }
+
+    void check_single_view() const
+    {
+        if (views_.size() != 1)
+        {
+            std::cout << "ERROR (CUDA): A sensor with " << views_.size()
+                      << " camera views needs one depth frame per view."
+                      << std::endl;
+            exit(-1);
+        }
+    }
+
+    /**
+     * \brief Integrated poses of all objects in the frame of the view
+     */
+    void move_to_view(int view, PoseArray& poses) const
+    {
+        poses = this->default_poses_;
+        for (int i = 0; i < poses.count(); i++)
+        {
+            poses.component(i).homogeneous(
+                view_poses_[view] * poses.component(i).homogeneous());
+        }
+    }
+
+    ViewPoses view_poses_;
+
+    // destroyed after the views, which are released on the workers
+    std::vector<std::unique_ptr<WorkerThread>> workers_;
+    std::vector<std::shared_ptr<View>> views_;
+
+    // per view input and output of the current evaluation
+    std::vector<PoseArray> view_integrated_poses_;
+    std::vector<IntArray> view_indices_;
+    std::vector<RealArray> view_loglikes_;
+};
+}
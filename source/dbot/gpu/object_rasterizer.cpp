@@ -27,21 +27,157 @@
 using namespace std;
 using namespace Eigen;
 
+namespace
+{
+/**
+ * Vertex shader of the instanced render path. Instance i draws pose
+ * first_instance + i into its tile of the texture: the model view matrices
+ * are read from a texture buffer, the clip coordinates are clipped against
+ * the tile and then scaled and shifted into it, which replaces the per pose
+ * glViewport call. The poses beyond the tiles of one layer go to the next
+ * layer, which is selected here if LAYER_IN_VERTEX_SHADER is defined, or by
+ * layer_geometry_shader if LAYER_IN_GEOMETRY_SHADER is. The #version and
+ * these defines are prepended when the program is built.
+ */
+const char* instanced_vertex_shader =
+    "layout(location = 0) in vec3 vertexPosition_modelspace;          \n"
+    "#ifdef LAYER_IN_GEOMETRY_SHADER                                  \n"
+    "// the geometry shader passes these on to the fragment shader    \n"
+    "#define depth vertex_depth                                       \n"
+    "out vec4 clip_distances;                                         \n"
+    "flat out int vertex_layer;                                       \n"
+    "#endif                                                           \n"
+    "out float depth;                                                 \n"
+    "// model view matrices or pose deltas of all instances           \n"
+    "uniform samplerBuffer model_views;                               \n"
+    "uniform mat4 P;                                                  \n"
+    "// the instances are given as deltas to base_model_view          \n"
+    "uniform bool from_deltas;                                        \n"
+    "uniform mat4 base_model_view;                                    \n"
+    "// number of objects per pose delta                              \n"
+    "uniform int delta_stride;                                        \n"
+    "// first matrix of the drawn object or its index in the deltas   \n"
+    "uniform int object_offset;                                       \n"
+    "// tiles per row and column of a layer, rows in use in each layer\n"
+    "uniform ivec3 tile_layout;                                       \n"
+    "// pose of the first instance of the draw call                   \n"
+    "uniform int first_instance;                                      \n"
+    "out float gl_ClipDistance[4];                                    \n"
+    "                                                                 \n"
+    "// rigid transform of a position and an angle axis vector        \n"
+    "mat4 delta_matrix(vec3 position, vec3 rotation) {                \n"
+    "    mat3 R = mat3(1.0);                                          \n"
+    "    float angle = length(rotation);                              \n"
+    "    if (angle > 0.0) {                                           \n"
+    "        vec3 a = rotation / angle;                               \n"
+    "        mat3 K = mat3(0.0, a.z, -a.y,                            \n"
+    "                      -a.z, 0.0, a.x,                            \n"
+    "                      a.y, -a.x, 0.0);                           \n"
+    "        R += sin(angle) * K + (1.0 - cos(angle)) * (K * K);      \n"
+    "    }                                                            \n"
+    "    return mat4(vec4(R[0], 0.0), vec4(R[1], 0.0),                \n"
+    "                vec4(R[2], 0.0), vec4(position, 1.0));           \n"
+    "}                                                                \n"
+    "                                                                 \n"
+    "void main() {                                                    \n"
+    "    int instance = first_instance + gl_InstanceID;               \n"
+    "    mat4 MV;                                                     \n"
+    "    if (from_deltas) {                                           \n"
+    "        int base =                                               \n"
+    "            6 * (instance * delta_stride + object_offset);       \n"
+    "        vec3 position = vec3(texelFetch(model_views, base).r,    \n"
+    "                             texelFetch(model_views, base + 1).r,\n"
+    "                             texelFetch(model_views, base + 2).r);\n"
+    "        vec3 rotation = vec3(texelFetch(model_views, base + 3).r,\n"
+    "                             texelFetch(model_views, base + 4).r,\n"
+    "                             texelFetch(model_views, base + 5).r);\n"
+    "        MV = base_model_view * delta_matrix(position, rotation);  \n"
+    "    } else {                                                     \n"
+    "        int base = 4 * (object_offset + instance);               \n"
+    "        MV = mat4(texelFetch(model_views, base),                 \n"
+    "                  texelFetch(model_views, base + 1),             \n"
+    "                  texelFetch(model_views, base + 2),             \n"
+    "                  texelFetch(model_views, base + 3));            \n"
+    "    }                                                            \n"
+    "                                                                 \n"
+    "    vec4 tmp_position = MV * vec4(vertexPosition_modelspace, 1); \n"
+    "    depth = tmp_position.z;                                      \n"
+    "    vec4 clip = P * tmp_position;                                \n"
+    "                                                                 \n"
+    "    gl_ClipDistance[0] = clip.w + clip.x;                        \n"
+    "    gl_ClipDistance[1] = clip.w - clip.x;                        \n"
+    "    gl_ClipDistance[2] = clip.w + clip.y;                        \n"
+    "    gl_ClipDistance[3] = clip.w - clip.y;                        \n"
+    "                                                                 \n"
+    "    int tiles_per_layer = tile_layout.x * tile_layout.y;         \n"
+    "    int tile = instance % tiles_per_layer;                       \n"
+    "    int column = tile % tile_layout.x;                           \n"
+    "    int row = tile_layout.z - 1 - tile / tile_layout.x;          \n"
+    "    clip.x = (clip.x + clip.w * (1 + 2 * column)) / tile_layout.x\n"
+    "             - clip.w;                                           \n"
+    "    clip.y = (clip.y + clip.w * (1 + 2 * row)) / tile_layout.y   \n"
+    "             - clip.w;                                           \n"
+    "    gl_Position = clip;                                          \n"
+    "                                                                 \n"
+    "#ifdef LAYER_IN_GEOMETRY_SHADER                                  \n"
+    "    clip_distances = vec4(gl_ClipDistance[0], gl_ClipDistance[1],\n"
+    "                          gl_ClipDistance[2], gl_ClipDistance[3]);\n"
+    "    vertex_layer = instance / tiles_per_layer;                   \n"
+    "#elif defined(LAYER_IN_VERTEX_SHADER)                            \n"
+    "    gl_Layer = instance / tiles_per_layer;                       \n"
+    "#endif                                                           \n"
+    "}                                                                \n";
+
+/**
+ * Geometry shader of the layered instanced render path for drivers which
+ * cannot write gl_Layer in the vertex shader. It passes the triangles on to
+ * the layer of their pose.
+ */
+const char* layer_geometry_shader =
+    "#version 330                                                     \n"
+    "                                                                 \n"
+    "layout(triangles) in;                                            \n"
+    "layout(triangle_strip, max_vertices = 3) out;                    \n"
+    "in float vertex_depth[];                                         \n"
+    "in vec4 clip_distances[];                                        \n"
+    "flat in int vertex_layer[];                                      \n"
+    "out float depth;                                                 \n"
+    "out float gl_ClipDistance[4];                                    \n"
+    "                                                                 \n"
+    "void main() {                                                    \n"
+    "    for (int i = 0; i < 3; i++) {                                \n"
+    "        gl_Layer = vertex_layer[0];                              \n"
+    "        gl_Position = gl_in[i].gl_Position;                      \n"
+    "        depth = vertex_depth[i];                                 \n"
+    "        for (int plane = 0; plane < 4; plane++) {                \n"
+    "            gl_ClipDistance[plane] = clip_distances[i][plane];   \n"
+    "        }                                                        \n"
+    "        EmitVertex();                                            \n"
+    "    }                                                            \n"
+    "    EndPrimitive();                                              \n"
+    "}                                                                \n";
+}
+
 ObjectRasterizer::ObjectRasterizer(
-    const std::vector<std::vector<Eigen::Vector3f>> vertices,
-    const std::vector<std::vector<std::vector<int>>> indices,
+    const dbot::TriangleMesh::ConstPtr& mesh,
     const std::shared_ptr<dbot::ShaderProvider>& shader_provider,
     const Eigen::Matrix3f camera_matrix,
     const int nr_rows,
     const int nr_cols,
     const float near_plane,
-    const float far_plane)
+    const float far_plane,
+    const bool use_instancing,
+    const std::string& display_name,
+    const bool use_layered_rendering)
     :
 
       nr_rows_(nr_rows),
       nr_cols_(nr_cols),
       near_plane_(near_plane),
-      far_plane_(far_plane)
+      far_plane_(far_plane),
+      use_instancing_(use_instancing),
+      use_layered_rendering_(use_layered_rendering),
+      max_nr_layers_(1)
 {
     // ========== CREATE WINDOWLESS OPENGL CONTEXT =========== //
 
@@ -64,7 +200,8 @@ ObjectRasterizer::ObjectRasterizer(
     GLXPbuffer pbuf;
 
     /* open display */
-    if (!(dpy_ = XOpenDisplay(0)))
+    if (!(dpy_ = XOpenDisplay(display_name.empty() ? NULL
+                                                   : display_name.c_str())))
     {
         fprintf(stderr, "Failed to open display\n");
         exit(1);
@@ -111,14 +248,15 @@ ObjectRasterizer::ObjectRasterizer(
     XSync(dpy_, False);
 
     /* try to make it the current context */
+    drawable_ = pbuf;
     if (!glXMakeContextCurrent(dpy_, pbuf, pbuf, ctx_))
     {
         /* some drivers do not support context without default framebuffer, so
          * fallback on
          * using the default window.
          */
-        if (!glXMakeContextCurrent(
-                dpy_, DefaultRootWindow(dpy_), DefaultRootWindow(dpy_), ctx_))
+        drawable_ = DefaultRootWindow(dpy_);
+        if (!glXMakeContextCurrent(dpy_, drawable_, drawable_, ctx_))
         {
             fprintf(stderr, "failed to make current\n");
             exit(1);
@@ -163,40 +301,34 @@ ObjectRasterizer::ObjectRasterizer(
     glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_renderbuffer_size);
 
     max_texture_size_ = min(max_texture_size, max_renderbuffer_size);
+    max_texture_layers_ = 1;
+    if (use_layered_rendering_)
+    {
+        // the depth is tested against an array texture instead of a
+        // renderbuffer in this mode
+        max_texture_size_ = max_texture_size;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_texture_layers_);
+    }
 
-    // ========== CHANGE VERTICES AND INDICES FORMATS SO THAT OPENGL CAN READ
-    // THEM =========== //
-
-    std::vector<int> vertices_per_object;
+    // ========== BOUNDING BOXES OF THE OBJECTS =========== //
 
-    for (size_t i = 0; i < vertices.size(); i++)
+    for (int i = 0; i < mesh->count_parts(); i++)
     {  // each i equals one object
         object_numbers_.push_back(i);
-        vertices_per_object.push_back(vertices[i].size());
-        for (size_t j = 0; j < vertices[i].size(); j++)
-        {  // each j equals one vertex in that object
-            for (int k = 0; k < vertices[i][j].size(); k++)
-            {  // each k equals one dimension of that vertex
-                vertices_list_.push_back(vertices[i][j][k]);
-            }
-        }
-    }
 
-    start_position_.push_back(0);
-    int vertex_count = 0;
-    for (size_t i = 0; i < indices.size(); i++)
-    {  // each i equals one object
-        indices_per_object_.push_back(indices[i].size() * 3);
-        start_position_.push_back(start_position_[i] + indices_per_object_[i]);
-        for (size_t j = 0; j < indices[i].size(); j++)
-        {  // each j equals one triangle in that object
-            for (size_t k = 0; k < indices[i][j].size(); k++)
-            {  // each k equals one index for a vertex in that triangle
-                indices_list_.push_back(indices[i][j][k] + vertex_count);
-            }
+        // model space bounding box for the projected bounding boxes
+        Vector3f bound_min = Vector3f::Constant(numeric_limits<float>::max());
+        Vector3f bound_max = -bound_min;
+        if (mesh->count_vertices(i) > 0)
+        {
+            bound_min = mesh->vertices(i).rowwise().minCoeff();
+            bound_max = mesh->vertices(i).rowwise().maxCoeff();
         }
-        vertex_count += vertices_per_object[i];
+        bounds_min_.push_back(bound_min);
+        bounds_max_.push_back(bound_max);
     }
+    meshes_.push_back(mesh);
+    pixels_per_triangle_ = 4;
 
     // ==================== CREATE AND FILL VAO, VBO & element array
     // ==================== //
@@ -205,21 +337,11 @@ ObjectRasterizer::ObjectRasterizer(
     glGenVertexArrays(1, &vertex_array_);
     glBindVertexArray(vertex_array_);
 
-    // creating a vertex buffer object (VBO) and filling it with vertices
+    // the vertex buffer object (VBO) and the index buffer are filled
+    // straight from the arrays of the mesh
     glGenBuffers(1, &vertex_buffer_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 vertices_list_.size() * sizeof(float),
-                 &vertices_list_[0],
-                 GL_STATIC_DRAW);
-
-    // create and fill index buffer with indices_
     glGenBuffers(1, &index_buffer_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 indices_list_.size() * sizeof(uint),
-                 &indices_list_[0],
-                 GL_STATIC_DRAW);
+    upload_meshes();
 
     // ============== TELL OPENGL WHERE TO LOOK FOR VERTICES ============== //
 
@@ -248,18 +370,33 @@ ObjectRasterizer::ObjectRasterizer(
     glGenFramebuffers(1, &framebuffer_);
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
 
-    // create color texture that will contain the depth values after the
-    // rendering
-    glGenTextures(1, &framebuffer_texture_for_all_poses_);
-    glBindTexture(GL_TEXTURE_2D, framebuffer_texture_for_all_poses_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // create a renderbuffer to store depth info for z-testing
+    // create the color textures that will contain the depth values after the
+    // rendering. While one of them is evaluated, the next poses can be
+    // rendered into the other one.
+    const GLenum target = get_framebuffer_texture_target();
+    glGenTextures(NR_FRAMEBUFFER_TEXTURES, framebuffer_textures_);
+    for (int i = 0; i < NR_FRAMEBUFFER_TEXTURES; i++)
+    {
+        glBindTexture(target, framebuffer_textures_[i]);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    render_target_ = 0;
+
+    // create a renderbuffer to store depth info for z-testing, or a depth
+    // array texture with the layers of the framebuffer textures
     glGenRenderbuffers(1, &texture_for_z_testing);
+    layered_texture_for_z_testing_ = 0;
+    if (use_layered_rendering_)
+    {
+        glGenTextures(1, &layered_texture_for_z_testing_);
+        glBindTexture(target, layered_texture_for_z_testing_);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(target, 0);
 
     // ================= COMPILE SHADERS AND GET HANDLES ================= //
 
@@ -270,6 +407,70 @@ ObjectRasterizer::ObjectRasterizer(
     model_view_matrix_ID_ = glGetUniformLocation(shader_ID_, "MV");
     projection_matrix_ID_ = glGetUniformLocation(shader_ID_, "P");
 
+    if (use_instancing_)
+    {
+        // the instanced path keeps the fragment shader of the provider. The
+        // layer is written in the vertex shader where the driver allows it,
+        // otherwise a geometry shader is added for it.
+        std::string header = "#version 330\n";
+        bool layer_in_geometry_shader = false;
+        if (use_layered_rendering_)
+        {
+            const char* extensions[] = {"GL_ARB_shader_viewport_layer_array",
+                                        "GL_AMD_vertex_shader_layer"};
+            layer_in_geometry_shader = true;
+            for (const char* extension : extensions)
+            {
+                if (glewIsSupported(extension))
+                {
+                    header += std::string("#extension ") + extension +
+                              " : require\n#define LAYER_IN_VERTEX_SHADER\n";
+                    layer_in_geometry_shader = false;
+                    break;
+                }
+            }
+            if (layer_in_geometry_shader)
+            {
+                header += "#define LAYER_IN_GEOMETRY_SHADER\n";
+            }
+        }
+
+        ShaderSources shader_sources;
+        shader_sources.push_back(std::make_pair(
+            GL_VERTEX_SHADER, header + instanced_vertex_shader));
+        if (layer_in_geometry_shader)
+        {
+            shader_sources.push_back(
+                std::make_pair(GL_GEOMETRY_SHADER, layer_geometry_shader));
+        }
+        shader_sources.push_back(std::make_pair(
+            GL_FRAGMENT_SHADER, shader_provider->fragment_shader()));
+        instanced_shader_ID_ = LoadProgram(shader_sources);
+
+        instanced_projection_matrix_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "P");
+        model_views_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "model_views");
+        object_offset_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "object_offset");
+        tile_layout_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "tile_layout");
+        first_instance_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "first_instance");
+        from_deltas_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "from_deltas");
+        base_model_view_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "base_model_view");
+        delta_stride_ID_ =
+            glGetUniformLocation(instanced_shader_ID_, "delta_stride");
+
+        glGenBuffers(1, &model_view_buffer_);
+        glGenTextures(1, &model_view_texture_);
+        glGenTextures(1, &delta_texture_);
+
+        check_GL_errors("instanced shader setup");
+    }
+
     /* The view matrix is constant throughout this class since we are not
        changing the camera position.
        If you are looking to pass a different camera matrix for each render
@@ -290,6 +491,11 @@ ObjectRasterizer::ObjectRasterizer(
 // ========== INITIALIZE & SET DEFAULTS FOR MEASURING EXECUTION TIMES
 // =========== //
 
+    strings_for_subroutines.push_back("ATTACH_TEXTURE");
+    strings_for_subroutines.push_back("CLEAR_SCREEN");
+    strings_for_subroutines.push_back("RENDER");
+    strings_for_subroutines.push_back("DETACH_TEXTURE");
+
 #ifdef PROFILING_ACTIVE
     // generate query objects needed for timing OpenGL commands
     glGenQueries(NR_SUBROUTINES_TO_MEASURE, time_query_);
@@ -298,12 +504,10 @@ ObjectRasterizer::ObjectRasterizer(
     time_measurement_ = vector<double>(NR_SUBROUTINES_TO_MEASURE, 0);
     initial_run_ = true;
 
-    strings_for_subroutines.push_back("ATTACH_TEXTURE");
-    strings_for_subroutines.push_back("CLEAR_SCREEN");
-    strings_for_subroutines.push_back("RENDER");
-    strings_for_subroutines.push_back("DETACH_TEXTURE");
-
     check_GL_errors("Generating time queries");
+#else
+    // timestamps which are read back a few frames late, never stalling
+    stage_timer_.reset(new dbot::GLStageTimer(NR_SUBROUTINES_TO_MEASURE));
 #endif
 }
 
@@ -318,108 +522,80 @@ void ObjectRasterizer::render(
 void ObjectRasterizer::render(
     const std::vector<std::vector<Eigen::Matrix4f>> states)
 {
-    nr_poses_ = states.size();
-    if (nr_poses_ > max_nr_poses_)
+    const int nr_poses_per_col = begin_render(states.size());
+
+    if (use_instancing_)
     {
-        std::cout << "ERROR (OPENGL): You tried to evaluate more poses ("
-                  << nr_poses_ << ") than specified by max_poses ("
-                  << max_nr_poses_ << ")." << std::endl;
-        exit(-1);
+        draw_instanced(states, nr_poses_per_col);
+    }
+    else
+    {
+        draw_per_pose(states, nr_poses_per_col);
     }
 
-    int nr_poses_per_col = ceil(nr_poses_ / (float)max_nr_poses_per_row_);
-
-#ifdef PROFILING_ACTIVE
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[ATTACH_TEXTURE]);
-    nr_calls_++;
-#endif
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target: GL_FRAMEBUFFER
-                           GL_COLOR_ATTACHMENT0,  // 2. attachment point
-                           GL_TEXTURE_2D,  // 3. tex target: GL_TEXTURE_2D
-                           framebuffer_texture_for_all_poses_,  // 4. tex ID
-                           0);
-#ifdef DEBUG
-    check_GL_errors("attaching texture to framebuffer");
-#endif
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[CLEAR_SCREEN]);
-#endif
-
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    end_render();
 
-#ifdef DEBUG
-    check_GL_errors("clearing framebuffer");
-#endif
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[RENDER]);
-#endif
+    bounding_boxes_.resize(4 * states.size());
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        compute_bounding_box(i, states[i]);
+    }
+}
 
-    glUniformMatrix4fv(
-        projection_matrix_ID_, 1, GL_FALSE, projection_matrix_.data());
+void ObjectRasterizer::render(const std::vector<Eigen::Matrix4f>& default_poses,
+                              const std::vector<float>& deltas,
+                              int nr_poses)
+{
+    if (!use_instancing_)
+    {
+        std::cout << "ERROR (OPENGL): Rendering from pose deltas requires "
+                  << "instanced rendering." << std::endl;
+        exit(-1);
+    }
 
-    Matrix4f model_view_matrix;
+    const int nr_poses_per_col = begin_render(nr_poses);
+    draw_deltas(default_poses, deltas, nr_poses_per_col);
+    end_render();
 
-    for (int i = 0; i < nr_poses_per_col; i++)
+    // the bounding boxes need the composed poses on the CPU
+    const int nr_objects = default_poses.size();
+    std::vector<Matrix4f> model_poses(nr_objects);
+    bounding_boxes_.resize(4 * nr_poses);
+    for (int i = 0; i < nr_poses; i++)
     {
-        for (int j = 0; j < max_nr_poses_per_row_ &&
-                        i * max_nr_poses_per_row_ + j < nr_poses_;
-             j++)
+        for (int k = 0; k < nr_objects; k++)
         {
-            glViewport(j * nr_cols_,
-                       (nr_poses_per_col - 1 - i) * nr_rows_,
-                       nr_cols_,
-                       nr_rows_);
-#ifdef DEBUG
-            check_GL_errors("setting the viewport");
-#endif
-            for (size_t k = 0; k < object_numbers_.size(); k++)
+            const float* delta = &deltas[6 * (i * nr_objects + k)];
+            const Vector3f rotation(delta[3], delta[4], delta[5]);
+            const float angle = rotation.norm();
+
+            Matrix4f delta_pose = Matrix4f::Identity();
+            if (angle > 0)
             {
-                int index = object_numbers_[k];
-
-                model_view_matrix =
-                    view_matrix_ * states[max_nr_poses_per_row_ * i + j][index];
-                glUniformMatrix4fv(model_view_matrix_ID_,
-                                   1,
-                                   GL_FALSE,
-                                   model_view_matrix.data());
-
-                glDrawElements(GL_TRIANGLES,
-                               indices_per_object_[index],
-                               GL_UNSIGNED_INT,
-                               (void*)(start_position_[index] * sizeof(uint)));
-#ifdef DEBUG
-                check_GL_errors("render call");
-#endif
+                delta_pose.topLeftCorner<3, 3>() =
+                    AngleAxisf(angle, rotation / angle).toRotationMatrix();
             }
+            delta_pose.topRightCorner<3, 1>() = Vector3f(delta);
+            model_poses[k] = default_poses[k] * delta_pose;
         }
+        compute_bounding_box(i, model_poses);
     }
+}
 
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    glBeginQuery(GL_TIME_ELAPSED, time_query_[DETACH_TEXTURE]);
-#endif
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target: GL_FRAMEBUFFER
-                           GL_COLOR_ATTACHMENT0,  // 2. attachment point
-                           GL_TEXTURE_2D,  // 3. tex target: GL_TEXTURE_2D
-                           0,              // 4. tex ID
-                           0);
-
-#ifdef DEBUG
-    check_GL_errors("detaching texture from framebuffer");
-#endif
+const std::vector<int>& ObjectRasterizer::get_bounding_boxes() const
+{
+    return bounding_boxes_;
+}
 
-#ifdef PROFILING_ACTIVE
-    glFinish();
-    glEndQuery(GL_TIME_ELAPSED);
-    store_time_measurements();
-#endif
+void ObjectRasterizer::make_current()
+{
+    // several rasterizers may live in one thread, each with its own context
+    if (glXGetCurrentContext() != ctx_ &&
+        !glXMakeContextCurrent(dpy_, drawable_, drawable_, ctx_))
+    {
+        fprintf(stderr, "failed to make current\n");
+        exit(1);
+    }
 }
 
 void ObjectRasterizer::set_objects(vector<int> object_numbers)
@@ -427,6 +603,134 @@ void ObjectRasterizer::set_objects(vector<int> object_numbers)
     object_numbers_ = object_numbers;
 }
 
+void ObjectRasterizer::set_pose_ranges(
+    const std::vector<std::pair<int, int>>& pose_ranges)
+{
+    if (!pose_ranges.empty() &&
+        int(pose_ranges.size()) != meshes_[0]->count_parts())
+    {
+        std::cout << "ERROR (OPENGL): " << pose_ranges.size()
+                  << " pose ranges for " << meshes_[0]->count_parts()
+                  << " objects" << std::endl;
+        exit(-1);
+    }
+    pose_ranges_ = pose_ranges;
+}
+
+void ObjectRasterizer::get_pose_range(int object_nr,
+                                      int& first_pose,
+                                      int& end_pose) const
+{
+    first_pose = 0;
+    end_pose = nr_poses_;
+    if (!pose_ranges_.empty())
+    {
+        first_pose = std::max(pose_ranges_[object_nr].first, 0);
+        end_pose = std::min(pose_ranges_[object_nr].second, nr_poses_);
+    }
+}
+
+void ObjectRasterizer::add_level_of_detail(
+    const dbot::TriangleMesh::ConstPtr& mesh)
+{
+    if (mesh->count_parts() != meshes_[0]->count_parts())
+    {
+        std::cout << "ERROR (OPENGL): level of detail with "
+                  << mesh->count_parts() << " objects for "
+                  << meshes_[0]->count_parts() << " objects" << std::endl;
+        exit(-1);
+    }
+
+    make_current();
+    meshes_.push_back(mesh);
+    upload_meshes();
+
+    // the bounding boxes contain all levels, whose simplified vertices may
+    // move slightly out of the full mesh
+    for (int i = 0; i < mesh->count_parts(); i++)
+    {
+        if (mesh->count_vertices(i) == 0) continue;
+        bounds_min_[i] =
+            bounds_min_[i].cwiseMin(mesh->vertices(i).rowwise().minCoeff());
+        bounds_max_[i] =
+            bounds_max_[i].cwiseMax(mesh->vertices(i).rowwise().maxCoeff());
+    }
+}
+
+void ObjectRasterizer::upload_meshes()
+{
+    // the levels are stored one after the other, such that drawing a level
+    // only changes the index range and the base vertex
+    level_first_vertex_.clear();
+    level_first_index_.clear();
+    size_t nr_vertices = 0;
+    size_t nr_indices = 0;
+    for (auto& mesh : meshes_)
+    {
+        level_first_vertex_.push_back(nr_vertices);
+        level_first_index_.push_back(nr_indices);
+        nr_vertices += mesh->count_vertices();
+        nr_indices += 3 * mesh->count_triangles();
+    }
+
+    // the vertex array keeps referring to the same buffers, only their data
+    // is replaced
+    glBindVertexArray(vertex_array_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+    glBufferData(GL_ARRAY_BUFFER,
+                 nr_vertices * 3 * sizeof(float),
+                 NULL,
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 nr_indices * sizeof(uint),
+                 NULL,
+                 GL_STATIC_DRAW);
+
+    for (size_t level = 0; level < meshes_.size(); level++)
+    {
+        const dbot::TriangleMesh& mesh = *meshes_[level];
+        if (mesh.count_triangles() == 0) continue;
+
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        level_first_vertex_[level] * 3 * sizeof(float),
+                        mesh.vertex_data().size() * sizeof(float),
+                        mesh.vertex_data().data());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                        level_first_index_[level] * sizeof(uint),
+                        mesh.index_data().size() * sizeof(uint),
+                        mesh.index_data().data());
+    }
+    check_GL_errors("mesh upload");
+}
+
+void ObjectRasterizer::set_level_of_detail_budget(float pixels_per_triangle)
+{
+    pixels_per_triangle_ = pixels_per_triangle;
+}
+
+void ObjectRasterizer::set_back_face_culling(bool enabled)
+{
+    make_current();
+    if (enabled)
+    {
+        // the view matrix is a rotation, hence triangles wound counter
+        // clockwise seen from outside stay counter clockwise on the screen
+        glFrontFace(GL_CCW);
+        glCullFace(GL_BACK);
+        glEnable(GL_CULL_FACE);
+    }
+    else
+    {
+        glDisable(GL_CULL_FACE);
+    }
+}
+
+void ObjectRasterizer::set_camera_matrix(const Eigen::Matrix3f& camera_matrix)
+{
+    setup_projection_matrix(camera_matrix);
+}
+
 void ObjectRasterizer::set_resolution(const int nr_rows, const int nr_cols)
 {
     if (nr_rows > max_texture_size_ || nr_cols > max_texture_size_)
@@ -454,16 +758,48 @@ void ObjectRasterizer::allocate_textures_for_max_poses(int nr_poses,
         exit(-1);
     }
 
+    const int poses_per_layer = nr_poses_per_row * nr_poses_per_col;
+    const int nr_layers =
+        std::max((nr_poses + poses_per_layer - 1) / poses_per_layer, 1);
+    if (nr_layers > max_texture_layers_)
+    {
+        std::cout << "ERROR (OPENGL): Exceeding maximum number of texture "
+                  << "layers with " << nr_poses << " poses in layers of "
+                  << nr_poses_per_row << " x " << nr_poses_per_col << " poses"
+                  << std::endl;
+        exit(-1);
+    }
+
     max_nr_poses_ = nr_poses;
     max_nr_poses_per_row_ = nr_poses_per_row;
     max_nr_poses_per_column_ = nr_poses_per_col;
+    max_nr_layers_ = nr_layers;
 
+    make_current();
     reallocate_buffers();
 }
 
-GLuint ObjectRasterizer::get_framebuffer_texture()
+GLuint ObjectRasterizer::get_framebuffer_texture(int texture_nr)
+{
+    return framebuffer_textures_[texture_nr];
+}
+
+GLenum ObjectRasterizer::get_framebuffer_texture_target() const
 {
-    return framebuffer_texture_for_all_poses_;
+    return use_layered_rendering_ ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+}
+
+void ObjectRasterizer::set_render_target(int texture_nr)
+{
+    if (texture_nr < 0 || texture_nr >= NR_FRAMEBUFFER_TEXTURES)
+    {
+        std::cout << "ERROR (OPENGL): There is no framebuffer texture "
+                  << texture_nr << ", only " << NR_FRAMEBUFFER_TEXTURES
+                  << " exist." << std::endl;
+        exit(-1);
+    }
+
+    render_target_ = texture_nr;
 }
 
 vector<vector<float>> ObjectRasterizer::get_depth_values(int nr_poses)
@@ -475,90 +811,59 @@ vector<vector<float>> ObjectRasterizer::get_depth_values(int nr_poses)
         exit(-1);
     }
 
-    // ===================== ATTACH TEXTURE TO FRAMEBUFFER ================ //
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target: GL_FRAMEBUFFER
-                           GL_COLOR_ATTACHMENT0,  // 2. attachment point
-                           GL_TEXTURE_2D,  // 3. tex target: GL_TEXTURE_2D
-                           framebuffer_texture_for_all_poses_,  // 4. tex ID
-                           0);
+    make_current();
 
     // ===================== TRANSFER DEPTH VALUES FROM GPU TO CPU == SLOW!!!
     // ================ //
 
+    // all layers of an array texture are read at once
+    const GLenum target = get_framebuffer_texture_target();
     glBindBuffer(GL_PIXEL_PACK_BUFFER, result_buffer_);
-    glBindTexture(GL_TEXTURE_2D, framebuffer_texture_for_all_poses_);
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, 0);
+    glBindTexture(target, framebuffer_textures_[render_target_]);
+    glGetTexImage(target, 0, GL_RED, GL_FLOAT, 0);
+    glBindTexture(target, 0);
 
     GLfloat* pixel_depth =
         (GLfloat*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
 
+    vector<vector<float>> depth_image_per_pose;
     if (pixel_depth != (GLfloat*)NULL)
     {
-        int current_nr_poses_per_col = (nr_poses / max_nr_poses_per_row_) + 1;
-        int total_nr_pixels = nr_rows_ * nr_cols_ * max_nr_poses_per_row_ *
-                              current_nr_poses_per_col;
-        vector<float> depth_image(total_nr_pixels,
-                                  numeric_limits<float>::max());
-
-        int pixels_per_row = max_nr_poses_per_row_ * nr_cols_;
-        int pixels_per_col = current_nr_poses_per_col * nr_rows_;
-        int highest_pixel_per_col = pixels_per_col - 1;
-
-        // reading OpenGL texture into an array on the CPU (inverted rows)
-        for (int row = 0; row < pixels_per_col; row++)
-        {
-            int inverted_row = highest_pixel_per_col - row;
-
-            for (int col = 0; (col < pixels_per_row) &&
-                              (row * pixels_per_row + col < total_nr_pixels);
-                 col++)
-            {
-                int pixel_index = row * pixels_per_row + col;
-
-                depth_image[pixel_index] =
-                    pixel_depth[inverted_row * pixels_per_row + col];
-            }
-        }
-
-        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-
-        // subdividing this array into an array per pose
-        vector<vector<float>> depth_image_per_pose(
-            nr_poses, vector<float>(nr_rows_ * nr_cols_, 0));
-
-        for (int pose_y = 0; pose_y < max_nr_poses_per_column_; pose_y++)
+        // the tiles are laid out like in the last render call
+        const int pixels_per_row = max_nr_poses_per_row_ * nr_cols_;
+        const size_t pixels_per_layer =
+            size_t(pixels_per_row) * max_nr_poses_per_column_ * nr_rows_;
+        const int poses_per_layer =
+            max_nr_poses_per_row_ * max_nr_poses_per_column_;
+        const int nr_poses_per_col =
+            min(max_nr_poses_per_column_,
+                int(ceil(nr_poses_ / (float)max_nr_poses_per_row_)));
+
+        depth_image_per_pose.assign(nr_poses,
+                                    vector<float>(nr_rows_ * nr_cols_, 0));
+        for (int pose_nr = 0; pose_nr < nr_poses; pose_nr++)
         {
-            for (int pose_x = 0;
-                 pose_x < max_nr_poses_per_row_ &&
-                 pose_y * max_nr_poses_per_row_ + pose_x < nr_poses;
-                 pose_x++)
+            const int tile = pose_nr % poses_per_layer;
+            const GLfloat* layer =
+                pixel_depth + (pose_nr / poses_per_layer) * pixels_per_layer;
+            const int first_col = (tile % max_nr_poses_per_row_) * nr_cols_;
+            // OpenGL stores the rows from the bottom up
+            const int top_row =
+                (nr_poses_per_col - tile / max_nr_poses_per_row_) * nr_rows_ -
+                1;
+
+            for (int row = 0; row < nr_rows_; row++)
             {
-                for (int local_pixel_row = 0; local_pixel_row < nr_rows_;
-                     local_pixel_row++)
+                for (int col = 0; col < nr_cols_; col++)
                 {
-                    for (int local_pixel_col = 0; local_pixel_col < nr_cols_;
-                         local_pixel_col++)
-                    {
-                        int local_pixel_nr =
-                            local_pixel_row * nr_cols_ + local_pixel_col;
-                        int global_pixel_row =
-                            pose_y * nr_rows_ + local_pixel_row;
-                        int global_pixel_col =
-                            pose_x * nr_cols_ + local_pixel_col;
-                        int global_pixel_nr =
-                            global_pixel_row * pixels_per_row +
-                            global_pixel_col;
-                        int pose_nr = pose_y * max_nr_poses_per_row_ + pose_x;
-
-                        depth_image_per_pose[pose_nr][local_pixel_nr] =
-                            depth_image[global_pixel_nr];
-                    }
+                    depth_image_per_pose[pose_nr][row * nr_cols_ + col] =
+                        layer[(top_row - row) * pixels_per_row + first_col +
+                              col];
                 }
             }
         }
 
-        return depth_image_per_pose;
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
     }
     else
     {
@@ -567,17 +872,11 @@ vector<vector<float>> ObjectRasterizer::get_depth_values(int nr_poses)
 
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-    // ===================== DETACH TEXTURE FROM FRAMEBUFFER ================ //
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target: GL_FRAMEBUFFER
-                           GL_COLOR_ATTACHMENT0,  // 2. attachment point
-                           GL_TEXTURE_2D,  // 3. tex target: GL_TEXTURE_2D
-                           0,              // 4. tex ID
-                           0);
-
 #ifdef DEBUG
     check_GL_errors("copying depth values to CPU");
 #endif
+
+    return depth_image_per_pose;
 }
 
 int ObjectRasterizer::get_max_texture_size()
@@ -585,14 +884,24 @@ int ObjectRasterizer::get_max_texture_size()
     return max_texture_size_;
 }
 
+int ObjectRasterizer::get_max_texture_layers()
+{
+    return max_texture_layers_;
+}
+
 void ObjectRasterizer::get_memory_need_parameters(int nr_rows,
                                                   int nr_cols,
                                                   int& constant_need,
                                                   int& per_pose_need)
 {
-    constant_need = vertices_list_.size() * sizeof(float) +
-                    indices_list_.size() * sizeof(uint);
-    per_pose_need = nr_rows * nr_cols * (8 + sizeof(float));
+    constant_need = 0;
+    for (auto& mesh : meshes_)
+    {
+        constant_need += mesh->vertex_data().size() * sizeof(float) +
+                         mesh->index_data().size() * sizeof(uint);
+    }
+    per_pose_need =
+        nr_rows * nr_cols * (8 + NR_FRAMEBUFFER_TEXTURES * sizeof(float));
 }
 
 // ================================================================= //
@@ -609,8 +918,9 @@ void ObjectRasterizer::reallocate_buffers()
     // the NULL means this buffer is uninitialized, since I only want to copy
     // values back to the CPU that will be written by the GPU
     glBufferData(GL_PIXEL_PACK_BUFFER,
-                 max_nr_poses_per_row_ * nr_cols_ * max_nr_poses_per_column_ *
-                     nr_rows_ * sizeof(GLfloat),
+                 size_t(max_nr_poses_per_row_) * nr_cols_ *
+                     max_nr_poses_per_column_ * nr_rows_ * max_nr_layers_ *
+                     sizeof(GLfloat),
                  NULL,
                  GL_STREAM_READ);
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
@@ -618,56 +928,580 @@ void ObjectRasterizer::reallocate_buffers()
     // ======================= DETACH TEXTURES FROM FRAMEBUFFER
     // ======================= //
 
-    glFramebufferRenderbuffer(
-        GL_FRAMEBUFFER,                     // 1. fbo target: GL_FRAMEBUFFER
-        GL_DEPTH_ATTACHMENT,                // 2. attachment point
-        GL_RENDERBUFFER,                    // 3. rbo target: GL_RENDERBUFFER
-        0);                                 // 4. rbo ID
-    glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target: GL_FRAMEBUFFER
-                           GL_COLOR_ATTACHMENT0,  // 2. attachment point
-                           GL_TEXTURE_2D,  // 3. tex target: GL_TEXTURE_2D
-                           0,              // 4. tex ID
-                           0);
+    detach_render_target();
+    if (!use_layered_rendering_)
+    {
+        glFramebufferRenderbuffer(
+            GL_FRAMEBUFFER,       // 1. fbo target: GL_FRAMEBUFFER
+            GL_DEPTH_ATTACHMENT,  // 2. attachment point
+            GL_RENDERBUFFER,      // 3. rbo target: GL_RENDERBUFFER
+            0);                   // 4. rbo ID
+    }
 
     // ======================= REALLOCATE FRAMEBUFFER TEXTURES
     // ======================= //
 
-    glBindTexture(GL_TEXTURE_2D, framebuffer_texture_for_all_poses_);
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,
-                 GL_R32F,
-                 max_nr_poses_per_row_ * nr_cols_,
-                 max_nr_poses_per_column_ * nr_rows_,
-                 0,
-                 GL_RED,
-                 GL_FLOAT,
-                 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, texture_for_z_testing);
-    glRenderbufferStorage(GL_RENDERBUFFER,
-                          GL_DEPTH_COMPONENT,
-                          max_nr_poses_per_row_ * nr_cols_,
-                          max_nr_poses_per_column_ * nr_rows_);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    const int width = max_nr_poses_per_row_ * nr_cols_;
+    const int height = max_nr_poses_per_column_ * nr_rows_;
+    if (use_layered_rendering_)
+    {
+        for (int i = 0; i < NR_FRAMEBUFFER_TEXTURES; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, framebuffer_textures_[i]);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY,
+                         0,
+                         GL_R32F,
+                         width,
+                         height,
+                         max_nr_layers_,
+                         0,
+                         GL_RED,
+                         GL_FLOAT,
+                         0);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, layered_texture_for_z_testing_);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY,
+                     0,
+                     GL_DEPTH_COMPONENT24,
+                     width,
+                     height,
+                     max_nr_layers_,
+                     0,
+                     GL_DEPTH_COMPONENT,
+                     GL_FLOAT,
+                     0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+    else
+    {
+        for (int i = 0; i < NR_FRAMEBUFFER_TEXTURES; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D, framebuffer_textures_[i]);
+            glTexImage2D(GL_TEXTURE_2D,
+                         0,
+                         GL_R32F,
+                         width,
+                         height,
+                         0,
+                         GL_RED,
+                         GL_FLOAT,
+                         0);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, texture_for_z_testing);
+        glRenderbufferStorage(
+            GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
 
     // ======================= ATTACH NEW TEXTURES TO FRAMEBUFFER
     // ======================= //
 
-    glFramebufferRenderbuffer(
-        GL_FRAMEBUFFER,                     // 1. fbo target: GL_FRAMEBUFFER
-        GL_DEPTH_ATTACHMENT,                // 2. attachment point
-        GL_RENDERBUFFER,                    // 3. rbo target: GL_RENDERBUFFER
-        texture_for_z_testing);             // 4. rbo ID
+    if (!use_layered_rendering_)
+    {
+        glFramebufferRenderbuffer(
+            GL_FRAMEBUFFER,          // 1. fbo target: GL_FRAMEBUFFER
+            GL_DEPTH_ATTACHMENT,     // 2. attachment point
+            GL_RENDERBUFFER,         // 3. rbo target: GL_RENDERBUFFER
+            texture_for_z_testing);  // 4. rbo ID
+    }
+    attach_render_target(0);
+
+    check_framebuffer_status();
+    GLenum color_buffers[] = {GL_COLOR_ATTACHMENT0};
+    glDrawBuffers(1, color_buffers);
+
+    // ================ REALLOCATE MODEL VIEW MATRIX BUFFER ================ //
+
+    if (use_instancing_)
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, model_view_buffer_);
+        glBufferData(GL_TEXTURE_BUFFER,
+                     max_nr_poses_ * meshes_[0]->count_parts() * 16 *
+                         sizeof(float),
+                     NULL,
+                     GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        // matrices are read as four RGBA texels, pose deltas as six scalars
+        glBindTexture(GL_TEXTURE_BUFFER, model_view_texture_);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, model_view_buffer_);
+        glBindTexture(GL_TEXTURE_BUFFER, delta_texture_);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, model_view_buffer_);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+}
+
+int ObjectRasterizer::begin_render(int nr_poses)
+{
+    make_current();
+
+    nr_poses_ = nr_poses;
+    if (nr_poses_ > max_nr_poses_)
+    {
+        std::cout << "ERROR (OPENGL): You tried to evaluate more poses ("
+                  << nr_poses_ << ") than specified by max_poses ("
+                  << max_nr_poses_ << ")." << std::endl;
+        exit(-1);
+    }
+
+    // every layer has the same rows in use, such that the tiles are found
+    // at the same place in all of them
+    const int nr_poses_per_col =
+        min(max_nr_poses_per_column_,
+            int(ceil(nr_poses_ / (float)max_nr_poses_per_row_)));
+
+#ifdef PROFILING_ACTIVE
+    glBeginQuery(GL_TIME_ELAPSED, time_query_[ATTACH_TEXTURE]);
+    nr_calls_++;
+#else
+    stage_timer_->begin_frame();
+#endif
+
+    attach_render_target(0);
+#ifdef DEBUG
+    check_GL_errors("attaching texture to framebuffer");
+#endif
+#ifdef PROFILING_ACTIVE
+    glFinish();
+    glEndQuery(GL_TIME_ELAPSED);
+    glBeginQuery(GL_TIME_ELAPSED, time_query_[CLEAR_SCREEN]);
+#else
+    stage_timer_->mark();
+#endif
+
+    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    if (use_layered_rendering_)
+    {
+        // only the layers in use are cleared, one at a time. The instanced
+        // path then draws into all of them at once, the per pose path
+        // attaches each layer again.
+        const int poses_per_layer =
+            max_nr_poses_per_row_ * max_nr_poses_per_column_;
+        for (int layer = 1; layer * poses_per_layer < nr_poses_; layer++)
+        {
+            attach_render_target(layer);
+            glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+        }
+        attach_render_target(use_instancing_ ? ALL_LAYERS : 0);
+    }
+
+#ifdef DEBUG
+    check_GL_errors("clearing framebuffer");
+#endif
+#ifdef PROFILING_ACTIVE
+    glFinish();
+    glEndQuery(GL_TIME_ELAPSED);
+    glBeginQuery(GL_TIME_ELAPSED, time_query_[RENDER]);
+#else
+    stage_timer_->mark();
+#endif
+
+    return nr_poses_per_col;
+}
+
+void ObjectRasterizer::end_render()
+{
+#ifdef PROFILING_ACTIVE
+    glFinish();
+    glEndQuery(GL_TIME_ELAPSED);
+    glBeginQuery(GL_TIME_ELAPSED, time_query_[DETACH_TEXTURE]);
+#else
+    stage_timer_->mark();
+#endif
+
+    detach_render_target();
+
+#ifdef DEBUG
+    check_GL_errors("detaching texture from framebuffer");
+#endif
+
+#ifdef PROFILING_ACTIVE
+    glFinish();
+    glEndQuery(GL_TIME_ELAPSED);
+    store_time_measurements();
+#else
+    stage_timer_->mark();
+    stage_timer_->end_frame();
+#endif
+}
+
+void ObjectRasterizer::attach_render_target(int layer)
+{
+    const GLuint texture = framebuffer_textures_[render_target_];
+    if (!use_layered_rendering_)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target
+                               GL_COLOR_ATTACHMENT0,  // 2. attachment point
+                               GL_TEXTURE_2D,         // 3. tex target
+                               texture,               // 4. tex ID
+                               0);
+    }
+    else if (layer == ALL_LAYERS)
+    {
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0);
+        glFramebufferTexture(GL_FRAMEBUFFER,
+                             GL_DEPTH_ATTACHMENT,
+                             layered_texture_for_z_testing_,
+                             0);
+    }
+    else
+    {
+        glFramebufferTextureLayer(
+            GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, layer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER,
+                                  GL_DEPTH_ATTACHMENT,
+                                  layered_texture_for_z_testing_,
+                                  0,
+                                  layer);
+    }
+}
+
+void ObjectRasterizer::detach_render_target()
+{
     glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target: GL_FRAMEBUFFER
                            GL_COLOR_ATTACHMENT0,  // 2. attachment point
                            GL_TEXTURE_2D,  // 3. tex target: GL_TEXTURE_2D
-                           framebuffer_texture_for_all_poses_,  // 4. tex ID
+                           0,              // 4. tex ID
                            0);
+    if (use_layered_rendering_)
+    {
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, 0, 0);
+    }
+}
 
-    check_framebuffer_status();
-    GLenum color_buffers[] = {GL_COLOR_ATTACHMENT0};
-    glDrawBuffers(1, color_buffers);
+void ObjectRasterizer::draw_per_pose(
+    const std::vector<std::vector<Eigen::Matrix4f>>& states,
+    int nr_poses_per_col)
+{
+    glUseProgram(shader_ID_);
+    glUniformMatrix4fv(
+        projection_matrix_ID_, 1, GL_FALSE, projection_matrix_.data());
+
+    Matrix4f model_view_matrix;
+
+    const int poses_per_layer =
+        max_nr_poses_per_row_ * max_nr_poses_per_column_;
+    for (int pose_nr = 0; pose_nr < nr_poses_; pose_nr++)
+    {
+        // the poses fill the tiles of a layer row by row
+        const int tile = pose_nr % poses_per_layer;
+        if (use_layered_rendering_ && tile == 0 && pose_nr > 0)
+        {
+            attach_render_target(pose_nr / poses_per_layer);
+        }
+
+        const int i = tile / max_nr_poses_per_row_;
+        const int j = tile % max_nr_poses_per_row_;
+        glViewport(j * nr_cols_,
+                   (nr_poses_per_col - 1 - i) * nr_rows_,
+                   nr_cols_,
+                   nr_rows_);
+#ifdef DEBUG
+        check_GL_errors("setting the viewport");
+#endif
+        for (size_t k = 0; k < object_numbers_.size(); k++)
+        {
+            int index = object_numbers_[k];
+
+            int first_pose, end_pose;
+            get_pose_range(index, first_pose, end_pose);
+            if (pose_nr < first_pose || pose_nr >= end_pose) continue;
+
+            model_view_matrix = view_matrix_ * states[pose_nr][index];
+            if (!is_in_view(index, model_view_matrix)) continue;
+
+            glUniformMatrix4fv(
+                model_view_matrix_ID_, 1, GL_FALSE, model_view_matrix.data());
+
+            draw_mesh(index, select_level(index, model_view_matrix), 0);
+#ifdef DEBUG
+            check_GL_errors("render call");
+#endif
+        }
+    }
+}
+
+void ObjectRasterizer::draw_instanced(
+    const std::vector<std::vector<Eigen::Matrix4f>>& states,
+    int nr_poses_per_col)
+{
+    glUseProgram(instanced_shader_ID_);
+    glUniformMatrix4fv(instanced_projection_matrix_ID_,
+                       1,
+                       GL_FALSE,
+                       projection_matrix_.data());
+    glUniform3i(tile_layout_ID_,
+                max_nr_poses_per_row_,
+                max_nr_poses_per_column_,
+                nr_poses_per_col);
+
+    // upload the model view matrices of all poses, grouped by object, such
+    // that instance i of object k reads matrix k * nr_poses_ + i
+    const int nr_objects = object_numbers_.size();
+    model_view_matrices_.resize(nr_objects * nr_poses_ * 16);
+    for (int k = 0; k < nr_objects; k++)
+    {
+        const int index = object_numbers_[k];
+        for (int i = 0; i < nr_poses_; i++)
+        {
+            Map<Matrix4f> model_view_matrix(
+                &model_view_matrices_[(k * nr_poses_ + i) * 16]);
+            model_view_matrix = view_matrix_ * states[i][index];
+        }
+    }
+
+    upload_instance_data(model_view_matrices_);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, model_view_texture_);
+    glUniform1i(from_deltas_ID_, GL_FALSE);
+    draw_instances(nr_poses_per_col, NULL);
+}
+
+void ObjectRasterizer::draw_deltas(
+    const std::vector<Eigen::Matrix4f>& default_poses,
+    const std::vector<float>& deltas,
+    int nr_poses_per_col)
+{
+    glUseProgram(instanced_shader_ID_);
+    glUniformMatrix4fv(instanced_projection_matrix_ID_,
+                       1,
+                       GL_FALSE,
+                       projection_matrix_.data());
+    glUniform3i(tile_layout_ID_,
+                max_nr_poses_per_row_,
+                max_nr_poses_per_column_,
+                nr_poses_per_col);
+
+    // the deltas are uploaded as they are, the shader combines them with the
+    // default pose of the drawn object
+    upload_instance_data(deltas);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, delta_texture_);
+    glUniform1i(from_deltas_ID_, GL_TRUE);
+    glUniform1i(delta_stride_ID_, meshes_[0]->count_parts());
+    draw_instances(nr_poses_per_col, &default_poses);
+}
+
+int ObjectRasterizer::select_level(int object_nr,
+                                   const Eigen::Matrix4f& model_view) const
+{
+    const int nr_levels = meshes_.size();
+    if (nr_levels == 1) return 0;
+
+    const Vector3f center =
+        0.5f * (bounds_min_[object_nr] + bounds_max_[object_nr]);
+    const float radius =
+        0.5f * (bounds_max_[object_nr] - bounds_min_[object_nr]).norm();
+
+    // the camera looks along the negative z axis of the view space
+    const float depth = -(model_view.topLeftCorner<3, 3>() * center +
+                          model_view.topRightCorner<3, 1>())(2);
+    if (depth <= radius) return 0;
+
+    // focal length in pixels of the current resolution
+    const float focal_length =
+        0.5f * std::max(projection_matrix_(0, 0) * nr_cols_,
+                        projection_matrix_(1, 1) * nr_rows_);
+    const float projected_radius = focal_length * radius / depth;
+    const float nr_triangles = float(M_PI) * projected_radius *
+                               projected_radius / pixels_per_triangle_;
+
+    // the coarsest level which still has enough triangles
+    for (int level = nr_levels - 1; level > 0; level--)
+    {
+        if (meshes_[level]->count_triangles(object_nr) >= nr_triangles)
+        {
+            return level;
+        }
+    }
+    return 0;
+}
+
+bool ObjectRasterizer::is_in_view(int object_nr,
+                                  const Eigen::Matrix4f& model_view) const
+{
+    if (bounds_min_[object_nr](0) > bounds_max_[object_nr](0)) return false;
+
+    const Vector3f center =
+        0.5f * (bounds_min_[object_nr] + bounds_max_[object_nr]);
+    const float radius =
+        0.5f * (bounds_max_[object_nr] - bounds_min_[object_nr]).norm();
+    const Vector4f view_center(model_view * center.homogeneous());
+
+    return ((view_volume_planes_ * view_center).array() >= -radius).all();
+}
+
+void ObjectRasterizer::draw_mesh(int object_nr, int level, int nr_instances)
+{
+    const dbot::TriangleMesh& mesh = *meshes_[level];
+    const GLsizei count = 3 * mesh.count_triangles(object_nr);
+    const size_t first_index =
+        level_first_index_[level] + 3 * mesh.first_triangle(object_nr);
+    const GLint base_vertex =
+        level_first_vertex_[level] + mesh.first_vertex(object_nr);
+
+    // the indices of the mesh count from the first vertex of the object
+    if (nr_instances > 0)
+    {
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                          count,
+                                          GL_UNSIGNED_INT,
+                                          (void*)(first_index * sizeof(uint)),
+                                          nr_instances,
+                                          base_vertex);
+    }
+    else
+    {
+        glDrawElementsBaseVertex(GL_TRIANGLES,
+                                 count,
+                                 GL_UNSIGNED_INT,
+                                 (void*)(first_index * sizeof(uint)),
+                                 base_vertex);
+    }
+}
+
+void ObjectRasterizer::upload_instance_data(const std::vector<float>& data)
+{
+    glBindBuffer(GL_TEXTURE_BUFFER, model_view_buffer_);
+    glBufferSubData(
+        GL_TEXTURE_BUFFER, 0, data.size() * sizeof(float), &data[0]);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ObjectRasterizer::draw_instances(
+    int nr_poses_per_col,
+    const std::vector<Eigen::Matrix4f>* default_poses)
+{
+    glUniform1i(model_views_ID_, 0);
+
+    // one viewport for the whole texture, or each of its layers, the shader
+    // moves each instance into its tile and clips it against the tile
+    // boundaries
+    glViewport(0,
+               0,
+               max_nr_poses_per_row_ * nr_cols_,
+               max_nr_poses_per_column_ * nr_rows_);
+    for (int plane = 0; plane < 4; plane++)
+    {
+        glEnable(GL_CLIP_DISTANCE0 + plane);
+    }
+
+    for (size_t k = 0; k < object_numbers_.size(); k++)
+    {
+        const int index = object_numbers_[k];
+
+        int first_pose, end_pose;
+        get_pose_range(index, first_pose, end_pose);
+        if (first_pose >= end_pose) continue;
+        glUniform1i(first_instance_ID_, first_pose);
+
+        // all instances share one level, chosen from the default pose or
+        // the first drawn pose, since the poses of one call are usually close
+        int level;
+        if (default_poses)
+        {
+            Matrix4f base_model_view = view_matrix_ * (*default_poses)[index];
+            glUniformMatrix4fv(
+                base_model_view_ID_, 1, GL_FALSE, base_model_view.data());
+            glUniform1i(object_offset_ID_, index);
+            level = select_level(index, base_model_view);
+        }
+        else
+        {
+            glUniform1i(object_offset_ID_, k * nr_poses_);
+            level = select_level(
+                index,
+                Map<const Matrix4f>(
+                    &model_view_matrices_[(k * nr_poses_ + first_pose) * 16]));
+        }
+
+        draw_mesh(index, level, end_pose - first_pose);
+#ifdef DEBUG
+        check_GL_errors("instanced render call");
+#endif
+    }
+
+    for (int plane = 0; plane < 4; plane++)
+    {
+        glDisable(GL_CLIP_DISTANCE0 + plane);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void ObjectRasterizer::compute_bounding_box(
+    int pose_nr,
+    const std::vector<Eigen::Matrix4f>& model_poses)
+{
+    const Matrix4f view_projection = projection_matrix_ * view_matrix_;
+    Vector2f ndc_min = Vector2f::Constant(2);
+    Vector2f ndc_max = Vector2f::Constant(-2);
+    bool in_front = true;
+
+    // project the corners of the bounding boxes of all rendered objects
+    for (size_t k = 0; k < object_numbers_.size(); k++)
+    {
+        const int index = object_numbers_[k];
+        if (bounds_min_[index](0) > bounds_max_[index](0)) continue;
+
+        int first_pose, end_pose;
+        get_pose_range(index, first_pose, end_pose);
+        if (pose_nr < first_pose || pose_nr >= end_pose) continue;
+
+        // objects outside of the view volume, also those behind the camera,
+        // cover no pixel
+        if (!is_in_view(index, view_matrix_ * model_poses[index])) continue;
+
+        const Matrix4f model_view_projection =
+            view_projection * model_poses[index];
+
+        for (int corner = 0; corner < 8; corner++)
+        {
+            Vector4f point(corner & 1 ? bounds_max_[index](0)
+                                      : bounds_min_[index](0),
+                           corner & 2 ? bounds_max_[index](1)
+                                      : bounds_min_[index](1),
+                           corner & 4 ? bounds_max_[index](2)
+                                      : bounds_min_[index](2),
+                           1);
+            const Vector4f clip = model_view_projection * point;
+
+            if (clip(3) < 1e-6)
+            {
+                in_front = false;
+                break;
+            }
+
+            const Vector2f ndc = clip.head<2>() / clip(3);
+            ndc_min = ndc_min.cwiseMin(ndc);
+            ndc_max = ndc_max.cwiseMax(ndc);
+        }
+    }
+
+    int* box = &bounding_boxes_[4 * pose_nr];
+    if (!in_front)
+    {
+        // the projection of a box reaching behind the camera is unbounded
+        box[0] = 0;
+        box[1] = 0;
+        box[2] = nr_cols_ - 1;
+        box[3] = nr_rows_ - 1;
+        return;
+    }
+
+    // the first image row is at the top, one pixel margin is added against
+    // rounding in the rasterization
+    ndc_min = ndc_min.cwiseMax(Vector2f::Constant(-2));
+    ndc_max = ndc_max.cwiseMin(Vector2f::Constant(2));
+    box[0] = std::max(0, int(floor((ndc_min(0) + 1) * 0.5f * nr_cols_)) - 1);
+    box[1] = std::max(0, int(floor((1 - ndc_max(1)) * 0.5f * nr_rows_)) - 1);
+    box[2] = std::min(nr_cols_ - 1,
+                      int(floor((ndc_max(0) + 1) * 0.5f * nr_cols_)) + 1);
+    box[3] = std::min(nr_rows_ - 1,
+                      int(floor((1 - ndc_min(1)) * 0.5f * nr_rows_)) + 1);
 }
 
 void ObjectRasterizer::setup_view_matrix()
@@ -707,6 +1541,20 @@ void ObjectRasterizer::setup_projection_matrix(
     // (3D)-scene onto a 2D image
     projection_matrix_ =
         get_projection_matrix(near, far, left, right, top, bottom);
+
+    // the view volume is -w <= x, y, z <= w in clip space
+    for (int i = 0; i < 3; i++)
+    {
+        view_volume_planes_.row(2 * i) =
+            projection_matrix_.row(3) + projection_matrix_.row(i);
+        view_volume_planes_.row(2 * i + 1) =
+            projection_matrix_.row(3) - projection_matrix_.row(i);
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        view_volume_planes_.row(i) /=
+            view_volume_planes_.row(i).head<3>().norm();
+    }
 }
 
 Matrix4f ObjectRasterizer::get_projection_matrix(float n,
@@ -763,6 +1611,34 @@ void ObjectRasterizer::store_time_measurements()
 #endif
 }
 
+const dbot::GpuStageTimes& ObjectRasterizer::stage_times()
+{
+#ifndef PROFILING_ACTIVE
+    make_current();
+    stage_timer_->collect();
+    return stage_timer_->times();
+#else
+    static const dbot::GpuStageTimes no_times;
+    return no_times;
+#endif
+}
+
+void ObjectRasterizer::stage_callback(
+    const dbot::GLStageTimer::FrameCallback& callback)
+{
+#ifndef PROFILING_ACTIVE
+    stage_timer_->frame_callback(callback);
+#endif
+}
+
+void ObjectRasterizer::timeline_callback(
+    const dbot::GLStageTimer::TimelineCallback& callback)
+{
+#ifndef PROFILING_ACTIVE
+    stage_timer_->timeline_callback(callback);
+#endif
+}
+
 string ObjectRasterizer::get_text_for_enum(int enumVal)
 {
     return strings_for_subroutines[enumVal];
@@ -822,6 +1698,8 @@ bool ObjectRasterizer::check_framebuffer_status()
 
 ObjectRasterizer::~ObjectRasterizer()
 {
+    make_current();
+
 #ifdef PROFILING_ACTIVE
 
     if (nr_calls_ != 0)
@@ -871,9 +1749,21 @@ ObjectRasterizer::~ObjectRasterizer()
     glDeleteBuffers(1, &result_buffer_);
 
     glDeleteFramebuffers(1, &framebuffer_);
-    glDeleteTextures(1, &framebuffer_texture_for_all_poses_);
+    glDeleteTextures(NR_FRAMEBUFFER_TEXTURES, framebuffer_textures_);
     glDeleteRenderbuffers(1, &texture_for_z_testing);
+    glDeleteTextures(1, &layered_texture_for_z_testing_);
+
+    // the timer queries have to be deleted while the context is alive
+    stage_timer_.reset();
 
     glDeleteProgram(shader_ID_);
+
+    if (use_instancing_)
+    {
+        glDeleteTextures(1, &model_view_texture_);
+        glDeleteTextures(1, &delta_texture_);
+        glDeleteBuffers(1, &model_view_buffer_);
+        glDeleteProgram(instanced_shader_ID_);
+    }
     glXDestroyContext(dpy_, ctx_);
 }
@@ -22,8 +22,12 @@
 #include <Eigen/Dense>
 #include <GL/glew.h>
 #include <GL/glx.h>
+#include <dbot/gpu/gpu_stage_timer.h>
 #include <dbot/gpu/shader_provider.h>
+#include <dbot/triangle_mesh.h>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -34,26 +38,26 @@
 * stored in a texture
 * whose values can be obtained with get_depth_values(). Alternatively,
 * get_framebuffer_texture() returns
-* the ID of the texture for mapping it into CUDA.
+* the ID of the texture for mapping it into CUDA. There are two such textures,
+* see set_render_target().
+*
+* The poses are laid out in tiles of the resolution, nr_poses_per_row per row
+* of the texture. With layered rendering each texture is a
+* GL_TEXTURE_2D_ARRAY of nr_poses_per_row x nr_poses_per_col tiles per layer,
+* pose i being drawn into layer i / (nr_poses_per_row * nr_poses_per_col),
+* such that the number of poses is no longer bounded by the texture size.
 */
 class ObjectRasterizer
 {
 public:
     /**
-     * \brief constructor which takes the vertices and indices that describe the
-     * objects as input. The paths to the
+     * \brief constructor which takes the mesh that describes the objects as
+     * input. The paths to the
      * shader files and the instrinsic camera matrix also have to be passed
      * here.
-     * \param [in]  vertices [object_nr][vertex_nr] = {x, y, z}. This list
-     * should contain, for each object,
-     * a list of 3-dimensional vectors that specify the corners of the triangles
-     * of the object mesh.
-     * \param [in]  indices [object_nr][index_nr][0 - 2] = {index}. This list
-     * should contain the indices
-     * that index the vertices list and tell us which vertices to connect to a
-     * triangle (every group of 3).
-     * For each object, the indices should be in the range of [0, nr_vertices -
-     * 1].
+     * \param [in]  mesh with one part per object. Its vertex and index
+     * arrays are uploaded to the GPU as they are, the indices of each part
+     * count from the first vertex of that part.
      * \param [in]  vertex_shader_path path to the vertex shader
      * \param [in]  fragment_shader_path path to the fragment shader
      * \param [in]  camera_matrix matrix of the intrinsic parameters of the
@@ -70,16 +74,28 @@ public:
      * not be rendered. This should
      * be similar to the maximum distance up to which the sensor can see
      * objects.
+     * \param [in]  use_instancing draw all poses of an object with a single
+     * instanced draw call instead of one draw call per pose and object. The
+     * vertex shader of the shader provider is replaced by a built-in one in
+     * this mode, the fragment shader is kept.
+     * \param [in]  display_name the X display whose GPU renders, e.g. ":0.1"
+     * for the second screen of a multi-GPU server. The default display is
+     * used if it is empty.
+     * \param [in]  use_layered_rendering render into 2D array textures of as
+     * many layers as the poses need instead of a single 2D texture. The
+     * instanced path selects the layer in the shader.
      */
     ObjectRasterizer(
-        const std::vector<std::vector<Eigen::Vector3f>> vertices,
-        const std::vector<std::vector<std::vector<int>>> indices,
+        const dbot::TriangleMesh::ConstPtr& mesh,
         const std::shared_ptr<dbot::ShaderProvider>& shader_provider,
         const Eigen::Matrix3f camera_matrix,
         const int nr_rows,
         const int nr_cols,
         const float near_plane = 0.4,
-        const float far_plane = 4);
+        const float far_plane = 4,
+        const bool use_instancing = false,
+        const std::string& display_name = "",
+        const bool use_layered_rendering = false);
 
     /** destructor which deletes the buffers and programs used by openGL */
     ~ObjectRasterizer();
@@ -114,6 +130,53 @@ public:
      */
     void render(const std::vector<std::vector<Eigen::Matrix4f>> states);
 
+    /**
+     * \brief render the objects in the given poses, which are passed as
+     * deltas to a default pose of each object, into a texture that can then
+     * be accessed by CUDA.
+     * The model view matrices are computed in the vertex shader, which
+     * requires instanced rendering to be enabled.
+     * \param [in]  default_poses [object_nr] = {homogeneous pose}
+     * \param [in]  deltas [pose_nr][object_nr][0 - 5] = {x, y, z, rx, ry,
+     * rz}. The position of each object is default_position + default_rotation
+     * * delta_position, its rotation default_rotation * delta_rotation where
+     * the delta rotation is given as an angle axis vector.
+     * \param [in]  nr_poses the number of poses in deltas
+     */
+    void render(const std::vector<Eigen::Matrix4f>& default_poses,
+                const std::vector<float>& deltas,
+                int nr_poses);
+
+    /**
+     * \brief returns for each pose of the last render call the bounding box
+     * of its projection, which contains all pixels the objects may cover.
+     * \return [pose_nr][0 - 3] = {col_min, row_min, col_max, row_max}, where
+     * the bounds are inclusive and the first row is at the top of the image.
+     * The box is empty, i.e. col_min > col_max or row_min > row_max, if the
+     * bounding spheres of all objects lie outside of the view volume, such
+     * that the pose is evaluated without comparing any pixel.
+     */
+    const std::vector<int>& get_bounding_boxes() const;
+
+    /**
+     * \brief returns whether the objects are rendered with instanced draw
+     * calls
+     */
+    bool uses_instancing() const { return use_instancing_; }
+
+    /**
+     * \brief returns whether the framebuffer textures are layered, see
+     * get_framebuffer_texture_target()
+     */
+    bool uses_layered_rendering() const { return use_layered_rendering_; }
+
+    /**
+     * \brief makes the context of this rasterizer current. Called by all
+     * functions issuing GL commands, such that several rasterizers can be
+     * used alternately in one thread.
+     */
+    void make_current();
+
     /**
      * \brief sets the objects that should be rendered.
      * This function only needs to be called if any objects initially passed in
@@ -126,6 +189,43 @@ public:
      */
     void set_objects(std::vector<int> object_numbers);
 
+    /**
+     * \brief restricts each object to a range of the poses of a render call.
+     * Poses outside the range of an object are rendered without it, which
+     * lets several trackers with disjoint objects share one render call.
+     * \param [in]  pose_ranges [object_nr] = {first_pose, end_pose}, the
+     * pose numbers count from the first pose of the render call and end_pose
+     * is exclusive. Every object is rendered in all poses if it is empty.
+     */
+    void set_pose_ranges(const std::vector<std::pair<int, int>>& pose_ranges);
+
+    /**
+     * \brief adds a coarser mesh of every object to the vertex and index
+     * buffers. Levels have to be added from fine to coarse.
+     * Each object is then drawn at the coarsest level which still has a
+     * triangle per set_level_of_detail_budget() pixels of its projected
+     * bounding sphere. The level is chosen per pose, or per object from its
+     * first pose when instancing is used.
+     * \param [in]  mesh with one part per object, in the frame of the mesh
+     * passed in the constructor
+     */
+    void add_level_of_detail(const dbot::TriangleMesh::ConstPtr& mesh);
+
+    /**
+     * \brief sets the number of projected pixels per triangle below which a
+     * finer level of detail is drawn
+     */
+    void set_level_of_detail_budget(float pixels_per_triangle);
+
+    /**
+     * \brief turns culling of the triangles facing away from the camera on
+     * or off. This requires closed meshes whose triangles are wound counter
+     * clockwise seen from outside. Objects whose bounding sphere lies
+     * outside of the view volume are not drawn either way when rendering
+     * without instancing.
+     */
+    void set_back_face_culling(bool enabled);
+
     /**
      * \brief set a new resolution.
      * \param [in]  nr_rows the height of the image
@@ -133,6 +233,13 @@ public:
      */
     void set_resolution(const int nr_rows, const int nr_cols);
 
+    /**
+     * \brief Sets the intrinsic parameters the poses are projected with,
+     * e.g. those of a region of interest of the camera image whose size is
+     * the resolution
+     */
+    void set_camera_matrix(const Eigen::Matrix3f& camera_matrix);
+
     /**
      * \brief allocates memory on the GPU.
      * Use this function to allocate memory for the maximum number of poses that
@@ -141,7 +248,9 @@ public:
      * \param [in] nr_poses_per_row the number of poses that will be rendered
      * per row of the texture
      * \param [in] nr_poses_per_col the number of poses that will be rendered
-     * per column of the texture
+     * per column of the texture, or of each layer with layered rendering.
+     * The layers are allocated for the poses which do not fit into a single
+     * one.
      */
     void allocate_textures_for_max_poses(int nr_poses,
                                          int nr_poses_per_row,
@@ -152,9 +261,30 @@ public:
      * CUDA interoperation.
      * Use this function to retrieve the texture ID and pass it to the
      * cudaGraphicsGLRegisterImage call.
+     * \param [in] texture_nr which of the NR_FRAMEBUFFER_TEXTURES textures
      * \return The texture ID
      */
-    GLuint get_framebuffer_texture();
+    GLuint get_framebuffer_texture(int texture_nr = 0);
+
+    /**
+     * \brief returns the target of the framebuffer textures, GL_TEXTURE_2D or
+     * GL_TEXTURE_2D_ARRAY with layered rendering, as needed for
+     * cudaGraphicsGLRegisterImage
+     */
+    GLenum get_framebuffer_texture_target() const;
+
+    /**
+     * \brief selects the framebuffer texture the next render() calls draw
+     * into and get_depth_values() reads from. Alternating between the
+     * textures allows rendering the next poses while the previous ones are
+     * still evaluated.
+     * \param [in] texture_nr the index of the texture, smaller than
+     * NR_FRAMEBUFFER_TEXTURES
+     */
+    void set_render_target(int texture_nr);
+
+    /// number of framebuffer textures which can be rendered into
+    static const int NR_FRAMEBUFFER_TEXTURES = 2;
 
     /**
      * \brief returns the rendered depth values of all poses.
@@ -186,13 +316,50 @@ public:
      */
     int get_max_texture_size();
 
+    /**
+     * \brief returns the maximum number of layers of the framebuffer
+     * textures, 1 without layered rendering
+     */
+    int get_max_texture_layers();
+
+    /**
+     * \brief returns the GPU time spent in each stage of render() so far,
+     * in the order ATTACH_TEXTURE, CLEAR_SCREEN, RENDER, DETACH_TEXTURE.
+     * The stages are timed with GL_TIMESTAMP queries which are read back
+     * without blocking, so the most recent frames may not be included yet.
+     * Empty if the blocking PROFILING_ACTIVE mode is compiled in instead.
+     */
+    const dbot::GpuStageTimes& stage_times();
+
+    /**
+     * \brief Sets the callback which receives the stage times of every
+     * render() call once they are read back. Never called in the
+     * PROFILING_ACTIVE mode.
+     */
+    void stage_callback(const dbot::GLStageTimer::FrameCallback& callback);
+
+    /**
+     * \brief Sets the callback which receives the start and duration of the
+     * stages of every render() call on the host clock once they are read
+     * back, for a TimelineTrace. Never called in the PROFILING_ACTIVE mode.
+     */
+    void timeline_callback(
+        const dbot::GLStageTimer::TimelineCallback& callback);
+
+    /**
+     * \brief returns the name of the given render() stage
+     */
+    std::string get_text_for_enum(int enumVal);
+
 private:
     // OpenGL context variables
     Display* dpy_;
     GLXContext ctx_;
+    GLXDrawable drawable_;
 
     // GPU constraints
     GLint max_texture_size_;
+    GLint max_texture_layers_;
 
     // values initialized in constructor. May be changed by user with
     // set_resolution().
@@ -202,6 +369,8 @@ private:
     // values initialized in constructor. Cannot be changed afterwards.
     float near_plane_;
     float far_plane_;
+    bool use_instancing_;
+    bool use_layered_rendering_;
 
     // number of poses in the current render call
     int nr_poses_;
@@ -210,6 +379,7 @@ private:
     int max_nr_poses_;
     int max_nr_poses_per_row_;
     int max_nr_poses_per_column_;
+    int max_nr_layers_;
 
     // needed for OpenGL time measurement
     static const int NR_SUBROUTINES_TO_MEASURE = 4;
@@ -222,28 +392,56 @@ private:
         DETACH_TEXTURE
     };
     std::vector<std::string> strings_for_subroutines;
+    std::unique_ptr<dbot::GLStageTimer> stage_timer_;
     std::vector<double> time_measurement_;
     int nr_calls_;
     bool initial_run_;  // the first run should not count
 
-    // lists of all vertices and indices of all objects
-    std::vector<float> vertices_list_;
-    std::vector<uint> indices_list_;
-    std::vector<int> indices_per_object_;
-    std::vector<int> start_position_;
+    // meshes of the levels of detail with one part per object, level 0 is
+    // the mesh passed in the constructor, and the offsets of each level in
+    // the vertex and index buffers
+    std::vector<dbot::TriangleMesh::ConstPtr> meshes_;
+    std::vector<int> level_first_vertex_;
+    std::vector<int> level_first_index_;
+    // model space bounding box of each object
+    std::vector<Eigen::Vector3f> bounds_min_;
+    std::vector<Eigen::Vector3f> bounds_max_;
+    std::vector<int> bounding_boxes_;
+    float pixels_per_triangle_;
 
     // contains a list of object indices which should be rendered
     std::vector<int> object_numbers_;
+    // poses each object is rendered in, all if empty
+    std::vector<std::pair<int, int>> pose_ranges_;
 
     // matrices to transform vertices into image space
     Eigen::Matrix4f projection_matrix_;
     Eigen::Matrix4f view_matrix_;
+    // planes of the view volume in view space, the rows (n, d) with unit
+    // normals n pointing inside such that n * x + d >= 0 within the volume
+    Eigen::Matrix<float, 6, 4> view_volume_planes_;
 
     // shader program ID and matrix uniform IDs to pass variables to them
     GLuint shader_ID_;
     GLuint model_view_matrix_ID_;  // ID to which we pass the modelview matrix
     GLuint projection_matrix_ID_;  // ID to which we pass the projection matrix
 
+    // instanced shader program, its uniform IDs and the texture buffer which
+    // holds the model view matrices of all poses of one render call
+    GLuint instanced_shader_ID_;
+    GLuint instanced_projection_matrix_ID_;
+    GLuint model_views_ID_;
+    GLuint object_offset_ID_;
+    GLuint tile_layout_ID_;
+    GLuint first_instance_ID_;
+    GLuint from_deltas_ID_;
+    GLuint base_model_view_ID_;
+    GLuint delta_stride_ID_;
+    GLuint model_view_buffer_;
+    GLuint model_view_texture_;
+    GLuint delta_texture_;
+    std::vector<float> model_view_matrices_;
+
     // VAO, VBO and element arrays are needed to store the object meshes
     GLuint vertex_array_;   // The vertex array contains the vertex and index
                             // buffers
@@ -258,13 +456,54 @@ private:
     // custom framebuffer and its textures for depth (for z-testing) and color
     // (which also represents depth in our case)
     GLuint framebuffer_;
-    GLuint framebuffer_texture_for_all_poses_;
+    GLuint framebuffer_textures_[NR_FRAMEBUFFER_TEXTURES];
+    int render_target_;
     GLuint texture_for_z_testing;
+    // depth array for z-testing with layered rendering, layered framebuffers
+    // cannot mix layered and non-layered attachments
+    GLuint layered_texture_for_z_testing_;
 
     // ====================== PRIVATE FUNCTIONS ====================== //
 
     void reallocate_buffers();
 
+    // projects the model space bounding boxes of the objects in the given
+    // poses into bounding_boxes_
+    void compute_bounding_box(int pose_nr,
+                              const std::vector<Eigen::Matrix4f>& model_poses);
+
+    // set up the framebuffer for a render call of nr_poses poses and return
+    // the number of pose rows in use, end_render() detaches it again
+    int begin_render(int nr_poses);
+    void end_render();
+    // attach the current render target, only the given layer of it or all
+    // of its layers for a layer of ALL_LAYERS, and detach it again
+    static const int ALL_LAYERS = -1;
+    void attach_render_target(int layer);
+    void detach_render_target();
+
+    // issue the draw calls of one render call
+    void draw_per_pose(const std::vector<std::vector<Eigen::Matrix4f>>& states,
+                       int nr_poses_per_col);
+    void draw_instanced(const std::vector<std::vector<Eigen::Matrix4f>>& states,
+                        int nr_poses_per_col);
+    void draw_deltas(const std::vector<Eigen::Matrix4f>& default_poses,
+                     const std::vector<float>& deltas,
+                     int nr_poses_per_col);
+    void upload_instance_data(const std::vector<float>& data);
+    // poses of the current render call the object is drawn in
+    void get_pose_range(int object_nr, int& first_pose, int& end_pose) const;
+    // level of detail of the object for the given model view matrix
+    int select_level(int object_nr, const Eigen::Matrix4f& model_view) const;
+    // whether the bounding sphere of the object intersects the view volume
+    bool is_in_view(int object_nr, const Eigen::Matrix4f& model_view) const;
+    // draws the object at the level, instanced if nr_instances > 0
+    void draw_mesh(int object_nr, int level, int nr_instances);
+    // fills the vertex and index buffers with all levels of detail
+    void upload_meshes();
+    void draw_instances(int nr_poses_per_col,
+                        const std::vector<Eigen::Matrix4f>* default_poses);
+
     // set up view- and projection-matrix
     void setup_view_matrix();
     void setup_projection_matrix(const Eigen::Matrix3f camera_matrix);
@@ -277,7 +516,6 @@ private:
 
     // functions for time measurement
     void store_time_measurements();
-    std::string get_text_for_enum(int enumVal);
 
     // functions for error checking
     void check_GL_errors(const char* label);
@@ -0,0 +1,72 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file page_locked_depth_frame.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include <cuda_runtime.h>
+
+#include <dbot/depth_frame.h>
+
+namespace dbot
+{
+/**
+ * \brief Allocates a depth frame in page locked host memory
+ *
+ * Used as DepthFramePool::Allocator, e.g. through
+ * CameraData::frame_allocator(), the providers fill frames which the GPU
+ * sensors upload asynchronously straight from their buffer.
+ */
+inline std::unique_ptr<DepthFrame> allocate_page_locked_depth_frame(int rows,
+                                                                    int cols)
+{
+    float* data = NULL;
+    if (cudaMallocHost((void**)&data, size_t(rows) * cols * sizeof(float)) !=
+        cudaSuccess)
+    {
+        std::cout << "ERROR (CUDA): could not allocate a page locked depth "
+                  << "frame of " << rows << " x " << cols << " pixels"
+                  << std::endl;
+        exit(-1);
+    }
+
+    std::shared_ptr<void> owner(data, [](void* pointer) {
+        cudaFreeHost(pointer);
+    });
+    return std::unique_ptr<DepthFrame>(new DepthFrame(rows, cols, data, owner));
+}
+
+/**
+ * \brief Whether the host memory is page locked, such that the GPU can copy
+ *        from it asynchronously
+ */
+inline bool is_page_locked(const void* data)
+{
+    cudaPointerAttributes attributes;
+    if (cudaPointerGetAttributes(&attributes, data) != cudaSuccess)
+    {
+        // before CUDA 11 pageable memory is reported as an error
+        cudaGetLastError();
+        return false;
+    }
+    return attributes.type == cudaMemoryTypeHost;
+}
+}
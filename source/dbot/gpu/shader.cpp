@@ -19,6 +19,8 @@
 
 #include <GL/glew.h>
 #include <algorithm>
+#include <boost/filesystem.hpp>
+#include <cstdint>
 #include <dbot/gpu/shader.h>
 #include <fstream>
 #include <iostream>
@@ -26,30 +28,214 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <unistd.h>
 #include <vector>
 
+namespace
+{
+// program binary cache file layout: magic, key length, key, binary format,
+// binary length, binary
+const char program_cache_magic[8] = {'D', 'B', 'O', 'T', 'P', 'R', 'G', '1'};
+
+bool ProgramBinarySupported()
+{
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary) return false;
+
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    return format_count > 0;
+}
+
+std::string GLString(GLenum name)
+{
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+/**
+ * \brief Everything the binary depends on, the sources and the driver
+ */
+std::string ProgramCacheKey(const ShaderSources& shaderSources)
+{
+    std::string key = GLString(GL_VENDOR) + "\n" + GLString(GL_RENDERER) +
+                      "\n" + GLString(GL_VERSION) + "\n";
+    for (auto& shader : shaderSources)
+    {
+        key += std::to_string(shader.first) + "\n" +
+               std::to_string(shader.second.size()) + "\n" + shader.second;
+    }
+    return key;
+}
+
+std::string ProgramCachePath(const std::string& key)
+{
+    // FNV-1a of the key
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : key)
+    {
+        hash = (hash ^ uint8_t(c)) * 1099511628211ull;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return ShaderCacheDirectory() + "/" + name;
+}
+
+template <typename Value>
+bool ReadValue(std::ifstream& file, Value& value)
+{
+    return bool(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template <typename Value>
+void WriteValue(std::ofstream& file, const Value& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * \brief Returns the cached program or 0 if there is no valid entry
+ */
+GLuint LoadProgramBinary(const std::string& path, const std::string& key)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) return 0;
+
+    char magic[sizeof(program_cache_magic)];
+    uint32_t key_length;
+    if (!file.read(magic, sizeof(magic)) ||
+        memcmp(magic, program_cache_magic, sizeof(magic)) != 0 ||
+        !ReadValue(file, key_length) || key_length != key.size())
+    {
+        return 0;
+    }
+
+    // the whole key is compared, a hash collision is a cache miss
+    std::string stored_key(key_length, '\0');
+    uint32_t format;
+    uint32_t length;
+    if (!file.read(&stored_key[0], key_length) || stored_key != key ||
+        !ReadValue(file, format) || !ReadValue(file, length))
+    {
+        return 0;
+    }
+
+    std::vector<char> binary(length);
+    if (!file.read(binary.data(), length)) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), length);
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void StoreProgramBinary(GLuint program,
+                        const std::string& path,
+                        const std::string& key)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    boost::system::error_code error;
+    boost::filesystem::create_directories(ShaderCacheDirectory(), error);
+
+    // written to a temporary file first, such that concurrently starting
+    // trackers never read a partial entry
+    const std::string temporary_path =
+        path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(temporary_path.c_str(), std::ios::binary);
+        file.write(program_cache_magic, sizeof(program_cache_magic));
+        WriteValue(file, uint32_t(key.size()));
+        file.write(key.data(), key.size());
+        WriteValue(file, uint32_t(format));
+        WriteValue(file, uint32_t(length));
+        file.write(binary.data(), length);
+        if (!file)
+        {
+            file.close();
+            remove(temporary_path.c_str());
+            return;
+        }
+    }
+    if (rename(temporary_path.c_str(), path.c_str()) != 0)
+    {
+        remove(temporary_path.c_str());
+    }
+}
+}
+
 GLuint LoadShaders(const std::shared_ptr<dbot::ShaderProvider>& shaderProvider)
 {
-    std::vector<GLuint> shaderList;
-    shaderList.push_back(
-        CreateShader(GL_VERTEX_SHADER, shaderProvider->vertex_shader()));
+    ShaderSources shaderSources;
+    shaderSources.push_back(
+        std::make_pair(GL_VERTEX_SHADER, shaderProvider->vertex_shader()));
 
     if (shaderProvider->has_geometry_shader())
     {
-        shaderList.push_back(CreateShader(GL_GEOMETRY_SHADER,
-                                          shaderProvider->geometry_shader()));
+        shaderSources.push_back(std::make_pair(
+            GL_GEOMETRY_SHADER, shaderProvider->geometry_shader()));
     }
 
-    shaderList.push_back(
-        CreateShader(GL_FRAGMENT_SHADER, shaderProvider->fragment_shader()));
+    shaderSources.push_back(
+        std::make_pair(GL_FRAGMENT_SHADER, shaderProvider->fragment_shader()));
 
-    GLuint theProgram = CreateProgram(shaderList);
+    return LoadProgram(shaderSources);
+}
+
+GLuint LoadProgram(const ShaderSources& shaderSources)
+{
+    const bool cached = ProgramBinarySupported();
+
+    std::string key;
+    std::string path;
+    if (cached)
+    {
+        key = ProgramCacheKey(shaderSources);
+        path = ProgramCachePath(key);
+
+        GLuint program = LoadProgramBinary(path, key);
+        if (program != 0) return program;
+    }
+
+    std::vector<GLuint> shaderList;
+    for (auto& shader : shaderSources)
+    {
+        shaderList.push_back(CreateShader(shader.first, shader.second));
+    }
+
+    GLuint theProgram = CreateProgram(shaderList, cached);
 
     std::for_each(shaderList.begin(), shaderList.end(), glDeleteShader);
 
+    GLint status;
+    glGetProgramiv(theProgram, GL_LINK_STATUS, &status);
+    if (cached && status == GL_TRUE) StoreProgramBinary(theProgram, path, key);
+
     return theProgram;
 }
 
+std::string ShaderCacheDirectory()
+{
+    const char* directory = getenv("DBOT_SHADER_CACHE");
+    if (directory && *directory) return directory;
+
+    const char* home = getenv("HOME");
+    return std::string(home ? home : ".") + "/.cache/dbot/shaders";
+}
+
 // source:
 // http://www.arcsynthesis.org/gltut/Basics/Tut01%20Making%20Shaders.html, Jason
 // L. McKesson, 2012
@@ -99,10 +285,17 @@ GLuint CreateShader(GLenum eShaderType, const std::string& shaderCode)
 // source:
 // http://www.arcsynthesis.org/gltut/Basics/Tut01%20Making%20Shaders.html, Jason
 // L. McKesson, 2012
-GLuint CreateProgram(const std::vector<GLuint>& shaderList)
+GLuint CreateProgram(const std::vector<GLuint>& shaderList, bool retrievable)
 {
     GLuint program = glCreateProgram();
 
+    // has to be set before linking for glGetProgramBinary
+    if (retrievable)
+    {
+        glProgramParameteri(
+            program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     for (size_t iLoop = 0; iLoop < shaderList.size(); iLoop++)
         glAttachShader(program, shaderList[iLoop]);
 
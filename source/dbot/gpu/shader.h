@@ -23,8 +23,33 @@
 #include <dbot/gpu/shader_provider.h>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+/**
+ * \brief Type and source code of the shaders of a program
+ */
+typedef std::vector<std::pair<GLenum, std::string>> ShaderSources;
+
 GLuint LoadShaders(const std::shared_ptr<dbot::ShaderProvider>& shaderProvider);
+
+/**
+ * \brief Returns the linked program of the given shaders
+ *
+ * If the driver supports program binaries, linked programs are kept in
+ * ShaderCacheDirectory() under a hash of the sources and the driver vendor,
+ * renderer and version, such that later runs skip the compilation. Entries
+ * which the driver rejects, e.g. after an update, are compiled again and
+ * replaced.
+ */
+GLuint LoadProgram(const ShaderSources& shaderSources);
+
+/**
+ * \brief Directory of the program binaries, $DBOT_SHADER_CACHE if set,
+ *        otherwise $HOME/.cache/dbot/shaders
+ */
+std::string ShaderCacheDirectory();
+
 GLuint CreateShader(GLenum eShaderType, const std::string& shaderCode);
-GLuint CreateProgram(const std::vector<GLuint>& shaderList);
+GLuint CreateProgram(const std::vector<GLuint>& shaderList,
+                     bool retrievable = false);
@@ -0,0 +1,432 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sharded_kinect_image_model_gpu.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dbot/gpu/kinect_image_model_gpu.h>
+#include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/worker_thread.h>
+
+namespace dbot
+{
+/**
+ * \brief Splits the particles across several GPUs, each evaluating its share
+ *        with its own KinectImageModelGPU
+ *
+ * Every shard renders on its own X display and evaluates on the CUDA device
+ * of that display. A shard is owned by a worker thread which creates it and
+ * issues all of its calls, such that its GL context stays current and the
+ * shards run concurrently. The log likelihoods are merged on the host.
+ *
+ * The occlusion images stay on the shard which computed them. A child is
+ * evaluated on the shard of its parent as long as that shard has room. When
+ * occlusions are updated, the children are balanced across the shards in
+ * proportion to their capacity; a child moved to another shard takes the
+ * occlusion image of its parent along through the host.
+ */
+template <typename State>
+class ShardedKinectImageModelGPU : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef KinectImageModelGPU<State> Shard;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+
+    /// creates the shard rendering on the given display
+    typedef std::function<std::shared_ptr<Shard>(const std::string&)>
+        ShardFactory;
+
+    /**
+     * \param display_names  One X display per shard, e.g. {":0.0", ":0.1"}
+     * \param create_shard   Called once per display on the worker thread of
+     *                       the shard
+     */
+    ShardedKinectImageModelGPU(const std::vector<std::string>& display_names,
+                               const ShardFactory& create_shard,
+                               const fl::Real& delta_time)
+        : Base(delta_time)
+    {
+        if (display_names.empty())
+        {
+            std::cout << "ERROR (CUDA): At least one display is needed to "
+                      << "shard the GPU sensor." << std::endl;
+            exit(-1);
+        }
+
+        for (size_t i = 0; i < display_names.size(); i++)
+        {
+            workers_.emplace_back(new WorkerThread());
+        }
+        shards_.resize(display_names.size());
+        for (size_t i = 0; i < shards_.size(); i++)
+        {
+            const std::string display_name = display_names[i];
+            std::shared_ptr<Shard>& shard = shards_[i];
+            workers_[i]->post([&shard, &create_shard, display_name]() {
+                shard = create_shard(display_name);
+            });
+        }
+        wait_all();
+
+        this->default_poses_ = shards_[0]->integrated_poses();
+        reset_owners();
+    }
+
+    virtual ~ShardedKinectImageModelGPU() noexcept
+    {
+        // each shard is destroyed on its thread, where its context is current
+        for (size_t i = 0; i < shards_.size(); i++)
+        {
+            std::shared_ptr<Shard>& shard = shards_[i];
+            workers_[i]->post([&shard]() { shard.reset(); });
+        }
+        wait_all();
+    }
+
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        const int shard_count = shards_.size();
+        const int nr_poses = deltas.size();
+
+        if (nr_poses > max_sample_count())
+        {
+            std::cout << "ERROR (CUDA): You tried to evaluate more poses ("
+                      << nr_poses << ") than all shards hold ("
+                      << max_sample_count() << ")." << std::endl;
+            exit(-1);
+        }
+
+        assign_children(indices, update);
+
+        // build the per shard input
+        std::vector<StateArray> shard_deltas(shard_count);
+        std::vector<IntArray> shard_indices(shard_count);
+        for (int s = 0; s < shard_count; s++)
+        {
+            shard_deltas[s].resize(shard_children_[s].size());
+            shard_indices[s].resize(shard_children_[s].size());
+            for (size_t j = 0; j < shard_children_[s].size(); j++)
+            {
+                shard_deltas[s](j) = deltas(shard_children_[s][j]);
+                shard_indices[s](j) = local_parents_[s][j];
+            }
+        }
+
+        // all images are read before any shard writes, since a migrated
+        // parent may be updated in place on its own shard
+        std::vector<std::vector<float>> images(migrations_.size());
+        for (size_t i = 0; i < migrations_.size(); i++)
+        {
+            const Migration& migration = migrations_[i];
+            std::vector<float>& image = images[i];
+            Shard* source = shards_[migration.source_shard].get();
+            const int slot = migration.source_slot;
+            workers_[migration.source_shard]->post([&image, source, slot]() {
+                image = source->get_occlusion_image(slot);
+            });
+        }
+        wait_all();
+
+        std::vector<RealArray> shard_loglikes(shard_count);
+        for (int s = 0; s < shard_count; s++)
+        {
+            Shard* shard = shards_[s].get();
+            const typename Base::PoseArray& poses = this->default_poses_;
+            workers_[s]->post([&, s, shard]() {
+                for (size_t i = 0; i < migrations_.size(); i++)
+                {
+                    if (migrations_[i].target_shard != s) continue;
+                    shard->set_occlusion_image(migrations_[i].target_slot,
+                                               images[i]);
+                }
+
+                // a shard without children keeps its occlusion time, images
+                // moved to it later are propagated from there
+                if (shard_deltas[s].size() == 0) return;
+                shard->integrated_poses() = poses;
+                shard_loglikes[s] =
+                    shard->loglikes(shard_deltas[s], shard_indices[s], update);
+            });
+        }
+        wait_all();
+
+        // merge in the original order
+        RealArray log_likelihoods(nr_poses);
+        for (int s = 0; s < shard_count; s++)
+        {
+            for (size_t j = 0; j < shard_children_[s].size(); j++)
+            {
+                log_likelihoods(shard_children_[s][j]) = shard_loglikes[s](j);
+            }
+        }
+
+        if (update)
+        {
+            owner_shards_.resize(nr_poses);
+            owner_slots_.resize(nr_poses);
+            for (int s = 0; s < shard_count; s++)
+            {
+                for (size_t j = 0; j < shard_children_[s].size(); j++)
+                {
+                    owner_shards_[shard_children_[s][j]] = s;
+                    owner_slots_[shard_children_[s][j]] = j;
+                }
+            }
+            for (int i = 0; i < nr_poses; i++) indices(i) = i;
+        }
+
+        return log_likelihoods;
+    }
+
+    void set_observation(const Observation& image)
+    {
+        for (size_t i = 0; i < shards_.size(); i++)
+        {
+            Shard* shard = shards_[i].get();
+            workers_[i]->post([shard, &image]() {
+                shard->set_observation(image);
+            });
+        }
+        wait_all();
+    }
+
+    void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        // all shards read the same frame, native frames are downsampled by
+        // each shard on its own GPU
+        for (size_t i = 0; i < shards_.size(); i++)
+        {
+            Shard* shard = shards_[i].get();
+            workers_[i]->post([shard, &frame]() {
+                shard->set_depth_frame(frame);
+            });
+        }
+        wait_all();
+    }
+
+    virtual void reset()
+    {
+        for (size_t i = 0; i < shards_.size(); i++)
+        {
+            Shard* shard = shards_[i].get();
+            workers_[i]->post([shard]() { shard->reset(); });
+        }
+        wait_all();
+        reset_owners();
+    }
+
+    /** \brief Number of poses all shards together were allocated for */
+    virtual int max_sample_count() const
+    {
+        int count = 0;
+        for (auto& shard : shards_) count += shard->max_sample_count();
+        return count;
+    }
+
+    int shard_count() const { return shards_.size(); }
+private:
+    /**
+     * \brief Occlusion image of a parent copied to the shard of its child
+     */
+    struct Migration
+    {
+        int source_shard;
+        int source_slot;
+        int target_shard;
+        int target_slot;
+    };
+
+    void wait_all()
+    {
+        for (auto& worker : workers_) worker->wait();
+    }
+
+    /**
+     * \brief After a reset all occlusion images are equal, so any parent can
+     * be found in slot 0 of any shard
+     */
+    void reset_owners()
+    {
+        owner_shards_.clear();
+        owner_slots_.clear();
+    }
+
+    bool owned(int parent) const
+    {
+        return parent >= 0 && parent < int(owner_shards_.size());
+    }
+
+    /**
+     * \brief Distributes the children to the shards and plans the migration
+     * of the parent images which are not on the shard of their child
+     */
+    void assign_children(const IntArray& parents, bool update)
+    {
+        const int shard_count = shards_.size();
+        const int nr_poses = parents.size();
+
+        // without an update the parents have to stay intact, so the shards
+        // are filled up to capacity before any image is moved, otherwise the
+        // children are balanced
+        std::vector<int> quotas(shard_count);
+        int total_capacity = max_sample_count();
+        int assigned_quota = 0;
+        int cumulative_capacity = 0;
+        for (int s = 0; s < shard_count; s++)
+        {
+            const int capacity = shards_[s]->max_sample_count();
+            cumulative_capacity += capacity;
+            if (update)
+            {
+                const int quota = int(int64_t(nr_poses) * cumulative_capacity /
+                                      total_capacity);
+                quotas[s] = quota - assigned_quota;
+                assigned_quota = quota;
+            }
+            else
+            {
+                quotas[s] = capacity;
+            }
+        }
+
+        shard_children_.assign(shard_count, std::vector<int>());
+        local_parents_.assign(shard_count, std::vector<int>());
+        migrations_.clear();
+
+        // children stay with their parent while it has room
+        std::vector<bool> assigned(nr_poses, false);
+        for (int i = 0; i < nr_poses; i++)
+        {
+            const int parent = parents(i);
+            if (!owned(parent)) continue;
+
+            const int s = owner_shards_[parent];
+            if (int(shard_children_[s].size()) < quotas[s])
+            {
+                shard_children_[s].push_back(i);
+                local_parents_[s].push_back(owner_slots_[parent]);
+                assigned[i] = true;
+            }
+        }
+
+        // slots a migrated image may overwrite, see free_slots()
+        std::vector<std::vector<int>> free_slots(shard_count);
+        std::vector<size_t> next_free_slot(shard_count, 0);
+        for (int s = 0; s < shard_count; s++)
+        {
+            free_slots[s] = find_free_slots(s, update);
+        }
+
+        // the remaining children fill up the other shards
+        int s = 0;
+        std::vector<std::vector<int>> imported(shard_count);
+        for (int i = 0; i < nr_poses; i++)
+        {
+            if (assigned[i]) continue;
+            while (int(shard_children_[s].size()) >= quotas[s]) s++;
+
+            const int parent = parents(i);
+            int slot = 0;
+            if (owned(parent))
+            {
+                // a parent is moved at most once to each shard
+                std::vector<int>& parent_slots = imported[s];
+                parent_slots.resize(nr_poses, -1);
+                if (parent_slots[parent] < 0)
+                {
+                    if (next_free_slot[s] == free_slots[s].size())
+                    {
+                        std::cout << "ERROR (CUDA): No free occlusion image "
+                                  << "left on shard " << s << "." << std::endl;
+                        exit(-1);
+                    }
+                    Migration migration;
+                    migration.source_shard = owner_shards_[parent];
+                    migration.source_slot = owner_slots_[parent];
+                    migration.target_shard = s;
+                    migration.target_slot = free_slots[s][next_free_slot[s]++];
+                    migrations_.push_back(migration);
+                    parent_slots[parent] = migration.target_slot;
+                }
+                slot = parent_slots[parent];
+            }
+
+            shard_children_[s].push_back(i);
+            local_parents_[s].push_back(slot);
+        }
+    }
+
+    /**
+     * \brief Slots of the shard whose images can be overwritten
+     *
+     * With an update, the previous generation dies, so every slot which is no
+     * parent of a child on the shard is free. Without, the slots of all
+     * particles of the previous generation are kept.
+     */
+    std::vector<int> find_free_slots(int shard, bool update) const
+    {
+        std::vector<bool> used(shards_[shard]->max_sample_count(), false);
+
+        // children of parents without owner read slot 0
+        used[0] = true;
+        if (update)
+        {
+            for (int slot : local_parents_[shard]) used[slot] = true;
+        }
+        else
+        {
+            for (size_t i = 0; i < owner_shards_.size(); i++)
+            {
+                if (owner_shards_[i] == shard) used[owner_slots_[i]] = true;
+            }
+        }
+
+        std::vector<int> free_slots;
+        for (size_t slot = 0; slot < used.size(); slot++)
+        {
+            if (!used[slot]) free_slots.push_back(slot);
+        }
+        return free_slots;
+    }
+
+    // destroyed after the shards, which are released on the workers
+    std::vector<std::unique_ptr<WorkerThread>> workers_;
+    std::vector<std::shared_ptr<Shard>> shards_;
+
+    // shard and slot of each particle of the previous generation
+    std::vector<int> owner_shards_;
+    std::vector<int> owner_slots_;
+
+    // assignment of the current evaluation
+    std::vector<std::vector<int>> shard_children_;
+    std::vector<std::vector<int>> local_parents_;
+    std::vector<Migration> migrations_;
+};
+}
@@ -0,0 +1,167 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file latency_metrics.cpp
+ * \date October 2026
+ */
+
+#include <dbot/latency_metrics.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace dbot
+{
+namespace
+{
+/**
+ * \brief Nearest rank percentile of non-empty sorted samples
+ */
+double nearest_rank(const std::vector<double>& samples, double fraction)
+{
+    fraction = std::min(std::max(fraction, 0.), 1.);
+    const size_t rank = size_t(std::ceil(fraction * samples.size()));
+    return samples[rank > 0 ? rank - 1 : 0];
+}
+}
+
+LatencyMetrics::LatencyMetrics(size_t window_size)
+    : window_size_(std::max(window_size, size_t(1)))
+{
+    step_.fill(0);
+    for (auto& window : windows_)
+    {
+        window.samples.reserve(window_size_);
+        window.next = 0;
+        window.total_count = 0;
+    }
+}
+
+void LatencyMetrics::commit()
+{
+    StepTimes step;
+    Sink sink;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            // a stage which did not run has not added anything
+            step[stage] = step_[stage] > 0 ? step_[stage] : -1;
+            if (step[stage] < 0) continue;
+
+            Window& window = windows_[stage];
+            if (window.samples.size() < window_size_)
+            {
+                window.samples.push_back(step[stage]);
+            }
+            else
+            {
+                window.samples[window.next] = step[stage];
+            }
+            window.next = (window.next + 1) % window_size_;
+            window.total_count++;
+        }
+        sink = sink_;
+    }
+    step_.fill(0);
+
+    if (sink) sink(step);
+}
+
+double LatencyMetrics::percentile(Stage stage, double fraction) const
+{
+    const std::vector<double> samples = sorted_samples(stage);
+    return samples.empty() ? 0 : nearest_rank(samples, fraction);
+}
+
+auto LatencyMetrics::summary(Stage stage) const -> Summary
+{
+    const std::vector<double> samples = sorted_samples(stage);
+
+    Summary summary;
+    summary.count = samples.size();
+    summary.mean = 0;
+    summary.p50 = 0;
+    summary.p90 = 0;
+    summary.p99 = 0;
+    summary.max = 0;
+    if (samples.empty()) return summary;
+
+    for (double sample : samples) summary.mean += sample;
+    summary.mean /= samples.size();
+
+    summary.p50 = nearest_rank(samples, 0.5);
+    summary.p90 = nearest_rank(samples, 0.9);
+    summary.p99 = nearest_rank(samples, 0.99);
+    summary.max = samples.back();
+    return summary;
+}
+
+size_t LatencyMetrics::total_count(Stage stage) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return windows_[stage].total_count;
+}
+
+void LatencyMetrics::sink(const Sink& sink)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink_ = sink;
+}
+
+void LatencyMetrics::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& window : windows_)
+    {
+        window.samples.clear();
+        window.next = 0;
+        window.total_count = 0;
+    }
+}
+
+const char* LatencyMetrics::stage_name(Stage stage)
+{
+    switch (stage)
+    {
+        case NOISE_GENERATION:
+            return "noise_generation";
+        case PROPAGATION:
+            return "propagation";
+        case RENDERING:
+            return "rendering";
+        case MAPPING:
+            return "mapping";
+        case WEIGHTING:
+            return "weighting";
+        case RESAMPLING:
+            return "resampling";
+        case MEAN_COMPUTATION:
+            return "mean_computation";
+        default:
+            return "unknown";
+    }
+}
+
+std::vector<double> LatencyMetrics::sorted_samples(Stage stage) const
+{
+    std::vector<double> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples = windows_[stage].samples;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+}
@@ -0,0 +1,185 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file latency_metrics.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <dbot/timeline_trace.h>
+
+namespace dbot
+{
+/**
+ * \brief Rolling latency percentiles of the stages of a filter step
+ *
+ * The filter, the sensor and the tracker add the time they spend in each
+ * stage while a step runs, the tracker commits the step once it is done.
+ * Every stage keeps the durations of its last window_size committed steps,
+ * from which the percentiles are computed on request. Stages which did not
+ * run during a step, e.g. resampling when the weights stayed even, are not
+ * counted for that step.
+ *
+ * Adding and committing happen on the thread of the tracker and cost a few
+ * clock reads per stage, the summaries may be queried from any thread. A
+ * sink receives every committed step, e.g. to push it to a monitoring
+ * system. Sensors which evaluate on several threads of their own, like the
+ * sharded, multi view and batched GPU sensors, do not report their stages.
+ *
+ * If a TimelineTrace is attached, every lap() and span() is also recorded as
+ * a span of the calling thread, and the GPU sensor records the spans of its
+ * device stages.
+ */
+class LatencyMetrics
+{
+public:
+    enum Stage
+    {
+        NOISE_GENERATION,
+        PROPAGATION,
+        RENDERING,
+        MAPPING,
+        WEIGHTING,
+        RESAMPLING,
+        MEAN_COMPUTATION,
+        STAGE_COUNT
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    /// seconds of each stage in one step, negative if the stage did not run
+    typedef std::array<double, STAGE_COUNT> StepTimes;
+
+    /// called with every committed step on the thread of the tracker
+    typedef std::function<void(const StepTimes&)> Sink;
+
+    /**
+     * \brief Percentiles of the durations in the window, in seconds
+     */
+    struct Summary
+    {
+        /// number of steps in the window
+        size_t count;
+        double mean;
+        double p50;
+        double p90;
+        double p99;
+        double max;
+    };
+
+public:
+    explicit LatencyMetrics(size_t window_size = 256);
+
+    /**
+     * \brief Adds time spent in the stage during the current step
+     */
+    void add(Stage stage, double seconds) { step_[stage] += seconds; }
+
+    /**
+     * \brief Adds the time since the given time point and resets it to now
+     */
+    void lap(Stage stage, Clock::time_point& since)
+    {
+        const Clock::time_point begin = since;
+        add(stage, elapsed(since));
+        if (trace_) trace_->host_span(stage_name(stage), begin, since);
+    }
+
+    /**
+     * \brief Records the time since the given time point in the trace only,
+     *        for spans which are no stage like a whole tracker step
+     */
+    void span(const char* name, Clock::time_point begin)
+    {
+        if (trace_) trace_->host_span(name, begin, Clock::now());
+    }
+
+    /**
+     * \brief Seconds since the given time point, which is reset to now
+     */
+    static double elapsed(Clock::time_point& since)
+    {
+        const Clock::time_point now = Clock::now();
+        const double seconds =
+            std::chrono::duration<double>(now - since).count();
+        since = now;
+        return seconds;
+    }
+
+    /**
+     * \brief Ends the current step and passes it to the sink
+     */
+    void commit();
+
+    /**
+     * \brief Drops the time added since the last commit, e.g. by an
+     *        initialization which is not a filter step
+     */
+    void discard() { step_.fill(0); }
+
+    /**
+     * \brief Percentile of the stage durations in the window, the fraction
+     *        is in [0, 1]. Returns 0 if the stage has not run.
+     */
+    double percentile(Stage stage, double fraction) const;
+
+    Summary summary(Stage stage) const;
+
+    /** \brief Number of steps the stage ran in since the last clear() */
+    size_t total_count(Stage stage) const;
+
+    size_t window_size() const { return window_size_; }
+    void sink(const Sink& sink);
+
+    /**
+     * \brief Trace the spans are recorded in, none by default. Should be set
+     *        while the tracker is idle.
+     */
+    const std::shared_ptr<TimelineTrace>& trace() const { return trace_; }
+    void trace(const std::shared_ptr<TimelineTrace>& trace) { trace_ = trace; }
+
+    /**
+     * \brief Discards all committed steps
+     */
+    void clear();
+
+    static const char* stage_name(Stage stage);
+
+private:
+    struct Window
+    {
+        std::vector<double> samples;
+        size_t next;
+        size_t total_count;
+    };
+
+    std::vector<double> sorted_samples(Stage stage) const;
+
+    size_t window_size_;
+    StepTimes step_;
+    Window windows_[STAGE_COUNT];
+    Sink sink_;
+    std::shared_ptr<TimelineTrace> trace_;
+    mutable std::mutex mutex_;
+};
+}
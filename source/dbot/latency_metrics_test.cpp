@@ -0,0 +1,83 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file latency_metrics_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/latency_metrics.h>
+
+TEST(LatencyMetricsTests, percentiles_of_committed_steps)
+{
+    dbot::LatencyMetrics metrics;
+
+    for (int i = 1; i <= 100; i++)
+    {
+        metrics.add(dbot::LatencyMetrics::RENDERING, 0.5 * i);
+        metrics.add(dbot::LatencyMetrics::RENDERING, 0.5 * i);
+        metrics.commit();
+    }
+
+    auto summary = metrics.summary(dbot::LatencyMetrics::RENDERING);
+    EXPECT_EQ(100u, summary.count);
+    EXPECT_DOUBLE_EQ(50.5, summary.mean);
+    EXPECT_DOUBLE_EQ(50, summary.p50);
+    EXPECT_DOUBLE_EQ(90, summary.p90);
+    EXPECT_DOUBLE_EQ(99, summary.p99);
+    EXPECT_DOUBLE_EQ(100, summary.max);
+    EXPECT_DOUBLE_EQ(25, metrics.percentile(
+                             dbot::LatencyMetrics::RENDERING, 0.25));
+}
+
+TEST(LatencyMetricsTests, skips_stages_which_did_not_run)
+{
+    dbot::LatencyMetrics metrics;
+    dbot::LatencyMetrics::StepTimes pushed;
+    metrics.sink([&pushed](const dbot::LatencyMetrics::StepTimes& step) {
+        pushed = step;
+    });
+
+    metrics.add(dbot::LatencyMetrics::WEIGHTING, 2);
+    metrics.commit();
+
+    EXPECT_EQ(1u, metrics.total_count(dbot::LatencyMetrics::WEIGHTING));
+    EXPECT_EQ(0u, metrics.total_count(dbot::LatencyMetrics::RESAMPLING));
+    EXPECT_DOUBLE_EQ(0, metrics.percentile(
+                            dbot::LatencyMetrics::RESAMPLING, 0.5));
+    EXPECT_DOUBLE_EQ(2, pushed[dbot::LatencyMetrics::WEIGHTING]);
+    EXPECT_LT(pushed[dbot::LatencyMetrics::RESAMPLING], 0);
+}
+
+TEST(LatencyMetricsTests, window_keeps_latest_steps)
+{
+    dbot::LatencyMetrics metrics(4);
+
+    for (int i = 1; i <= 10; i++)
+    {
+        metrics.add(dbot::LatencyMetrics::PROPAGATION, i);
+        metrics.commit();
+    }
+    metrics.add(dbot::LatencyMetrics::PROPAGATION, 100);
+    metrics.discard();
+    metrics.commit();
+
+    auto summary = metrics.summary(dbot::LatencyMetrics::PROPAGATION);
+    EXPECT_EQ(4u, summary.count);
+    EXPECT_DOUBLE_EQ(7, metrics.percentile(
+                            dbot::LatencyMetrics::PROPAGATION, 0));
+    EXPECT_DOUBLE_EQ(10, summary.max);
+    EXPECT_EQ(10u, metrics.total_count(dbot::LatencyMetrics::PROPAGATION));
+}
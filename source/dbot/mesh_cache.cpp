@@ -0,0 +1,243 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_cache.cpp
+ * \date October 2026
+ */
+
+#include <dbot/mesh_cache.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dbot
+{
+namespace
+{
+/// increased whenever the layout of the entries changes
+const uint32_t format_version = 1;
+const char magic[8] = {'D', 'B', 'O', 'T', 'M', 'E', 'S', 'H'};
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t options;
+    int64_t source_mtime_ns;
+    uint64_t source_size;
+    uint64_t vertex_count;
+    uint64_t triangle_count;
+    uint64_t path_length;
+};
+
+static_assert(sizeof(Eigen::Vector3d) == 3 * sizeof(double),
+              "vertices are copied as packed doubles");
+
+size_t padded(size_t size) { return (size + 7) & ~size_t(7); }
+bool source_status(const std::string& path, int64_t& mtime_ns, uint64_t& size)
+{
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) return false;
+
+    mtime_ns = int64_t(status.st_mtim.tv_sec) * 1000000000 +
+               status.st_mtim.tv_nsec;
+    size = status.st_size;
+    return true;
+}
+
+std::string absolute_path(const std::string& path)
+{
+    boost::system::error_code error;
+    auto absolute = boost::filesystem::canonical(path, error);
+    return error ? path : absolute.string();
+}
+}
+
+MeshCache::MeshCache(const std::string& directory) : directory_(directory) {}
+std::string MeshCache::default_directory()
+{
+    const char* directory = std::getenv("DBOT_MESH_CACHE");
+    if (directory && *directory) return directory;
+
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.cache/dbot/meshes";
+}
+
+std::string MeshCache::entry_path(const std::string& mesh_path,
+                                  unsigned int options) const
+{
+    // FNV-1a of the absolute path and the options
+    const std::string key = absolute_path(mesh_path);
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : key)
+    {
+        hash = (hash ^ uint8_t(c)) * 1099511628211ull;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        hash = (hash ^ uint8_t(options >> (8 * i))) * 1099511628211ull;
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mesh", (unsigned long long)hash);
+    return directory_ + "/" + name;
+}
+
+bool MeshCache::load(const std::string& mesh_path,
+                     unsigned int options,
+                     std::vector<Eigen::Vector3d>& vertices,
+                     std::vector<std::vector<int>>& triangle_indices) const
+{
+    int64_t mtime_ns;
+    uint64_t source_size;
+    if (!source_status(mesh_path, mtime_ns, source_size)) return false;
+
+    const int descriptor =
+        open(entry_path(mesh_path, options).c_str(), O_RDONLY);
+    if (descriptor < 0) return false;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 ||
+        size_t(status.st_size) < sizeof(Header))
+    {
+        close(descriptor);
+        return false;
+    }
+
+    const size_t size = status.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED) return false;
+
+    const char* data = static_cast<const char*>(mapping);
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const std::string key = absolute_path(mesh_path);
+    const size_t path_offset = sizeof(Header);
+    const size_t vertex_offset = path_offset + padded(header.path_length);
+    const size_t index_offset =
+        vertex_offset + header.vertex_count * 3 * sizeof(double);
+    const size_t expected_size =
+        index_offset + header.triangle_count * 3 * sizeof(int32_t);
+
+    // collisions of the entry names and stale entries are told apart by the
+    // recorded key
+    const bool valid =
+        std::memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+        header.version == format_version && header.options == options &&
+        header.source_mtime_ns == mtime_ns &&
+        header.source_size == source_size && header.path_length == key.size() &&
+        vertex_offset <= size && expected_size == size &&
+        std::memcmp(data + path_offset, key.data(), key.size()) == 0;
+
+    if (valid)
+    {
+        vertices.resize(header.vertex_count);
+        std::memcpy(static_cast<void*>(vertices.data()),
+                    data + vertex_offset,
+                    header.vertex_count * 3 * sizeof(double));
+
+        const int32_t* indices =
+            reinterpret_cast<const int32_t*>(data + index_offset);
+        triangle_indices.resize(header.triangle_count);
+        for (size_t i = 0; i < header.triangle_count; ++i)
+        {
+            triangle_indices[i].assign(indices + 3 * i, indices + 3 * i + 3);
+        }
+    }
+
+    munmap(mapping, size);
+    return valid;
+}
+
+bool MeshCache::store(const std::string& mesh_path,
+                      unsigned int options,
+                      const std::vector<Eigen::Vector3d>& vertices,
+                      const std::vector<std::vector<int>>& triangle_indices)
+    const
+{
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = format_version;
+    header.options = options;
+    if (!source_status(mesh_path, header.source_mtime_ns, header.source_size))
+    {
+        return false;
+    }
+
+    const std::string key = absolute_path(mesh_path);
+    header.vertex_count = vertices.size();
+    header.triangle_count = triangle_indices.size();
+    header.path_length = key.size();
+
+    boost::system::error_code error;
+    boost::filesystem::create_directories(directory_, error);
+
+    // written to a temporary file first, such that concurrently starting
+    // trackers never read a partial entry
+    const std::string path = entry_path(mesh_path, options);
+    const std::string temporary_path =
+        path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(temporary_path.c_str(), std::ios::binary);
+        if (!file) return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(key.data(), key.size());
+        const char padding[8] = {0};
+        file.write(padding, padded(key.size()) - key.size());
+
+        file.write(reinterpret_cast<const char*>(vertices.data()),
+                   vertices.size() * 3 * sizeof(double));
+
+        std::vector<int32_t> indices;
+        indices.reserve(triangle_indices.size() * 3);
+        for (auto& triangle : triangle_indices)
+        {
+            // the renderers only use the first three corners
+            for (int i = 0; i < 3; ++i)
+            {
+                indices.push_back(i < int(triangle.size()) ? triangle[i] : 0);
+            }
+        }
+        file.write(reinterpret_cast<const char*>(indices.data()),
+                   indices.size() * sizeof(int32_t));
+
+        if (!file)
+        {
+            file.close();
+            std::remove(temporary_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary_path.c_str());
+        return false;
+    }
+    return true;
+}
+}
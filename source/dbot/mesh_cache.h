@@ -0,0 +1,82 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_cache.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Directory of binary copies of parsed mesh files
+ *
+ * Each mesh is stored in its own file holding a versioned header followed by
+ * the flat vertex and triangle index arrays. An entry is keyed by the path of
+ * the mesh and the options it was processed with, and it is only used while
+ * the modification time and size of the mesh file match the ones recorded in
+ * the header. Entries are read from a memory mapping without any parsing.
+ */
+class MeshCache
+{
+public:
+    /**
+     * \param directory  Created on the first store() if missing
+     */
+    explicit MeshCache(const std::string& directory);
+
+    /**
+     * \brief $DBOT_MESH_CACHE if set, otherwise $HOME/.cache/dbot/meshes
+     */
+    static std::string default_directory();
+
+    /**
+     * \brief Loads the cached mesh of the given file
+     *
+     * \param options   Processing options of the mesh, entries stored with
+     *                  other options are ignored
+     * \return false if there is no valid entry for the current version of
+     *               the file
+     */
+    bool load(const std::string& mesh_path,
+              unsigned int options,
+              std::vector<Eigen::Vector3d>& vertices,
+              std::vector<std::vector<int>>& triangle_indices) const;
+
+    /**
+     * \brief Stores the mesh of the given file, replacing an older entry
+     *
+     * \return false if the entry could not be written
+     */
+    bool store(const std::string& mesh_path,
+               unsigned int options,
+               const std::vector<Eigen::Vector3d>& vertices,
+               const std::vector<std::vector<int>>& triangle_indices) const;
+
+    /**
+     * \brief Path of the entry of the given mesh
+     */
+    std::string entry_path(const std::string& mesh_path,
+                           unsigned int options) const;
+
+private:
+    std::string directory_;
+};
+}
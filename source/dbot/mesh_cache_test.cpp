@@ -0,0 +1,102 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_cache_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <dbot/mesh_cache.h>
+
+class MeshCacheTests : public ::testing::Test
+{
+protected:
+    MeshCacheTests()
+        : directory_(::testing::TempDir() + "mesh_cache_test"),
+          mesh_path_(::testing::TempDir() + "mesh_cache_test.obj"),
+          cache_(directory_)
+    {
+        write_mesh("v 0 0 0\n");
+
+        vertices_ = {Eigen::Vector3d(0.1, 0.2, 0.3),
+                     Eigen::Vector3d(1., 2., 3.),
+                     Eigen::Vector3d(-1., 0.5, 1e-9)};
+        triangle_indices_ = {{0, 1, 2}, {2, 1, 0}};
+    }
+
+    ~MeshCacheTests()
+    {
+        std::remove(cache_.entry_path(mesh_path_, 0).c_str());
+        std::remove(cache_.entry_path(mesh_path_, 1).c_str());
+        std::remove(mesh_path_.c_str());
+    }
+
+    void write_mesh(const std::string& content)
+    {
+        std::ofstream file(mesh_path_.c_str());
+        file << content;
+    }
+
+    std::string directory_;
+    std::string mesh_path_;
+    dbot::MeshCache cache_;
+    std::vector<Eigen::Vector3d> vertices_;
+    std::vector<std::vector<int>> triangle_indices_;
+};
+
+TEST_F(MeshCacheTests, missing_entry)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> triangle_indices;
+    EXPECT_FALSE(cache_.load(mesh_path_, 0, vertices, triangle_indices));
+}
+
+TEST_F(MeshCacheTests, stored_mesh_is_loaded)
+{
+    ASSERT_TRUE(cache_.store(mesh_path_, 0, vertices_, triangle_indices_));
+
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> triangle_indices;
+    ASSERT_TRUE(cache_.load(mesh_path_, 0, vertices, triangle_indices));
+
+    ASSERT_EQ(vertices.size(), vertices_.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        EXPECT_EQ(vertices[i], vertices_[i]);
+    }
+    EXPECT_EQ(triangle_indices, triangle_indices_);
+}
+
+TEST_F(MeshCacheTests, other_options_are_ignored)
+{
+    ASSERT_TRUE(cache_.store(mesh_path_, 0, vertices_, triangle_indices_));
+
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> triangle_indices;
+    EXPECT_FALSE(cache_.load(mesh_path_, 1, vertices, triangle_indices));
+}
+
+TEST_F(MeshCacheTests, modified_mesh_invalidates_entry)
+{
+    ASSERT_TRUE(cache_.store(mesh_path_, 0, vertices_, triangle_indices_));
+    write_mesh("v 0 0 0\nv 1 1 1\n");
+
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> triangle_indices;
+    EXPECT_FALSE(cache_.load(mesh_path_, 0, vertices, triangle_indices));
+}
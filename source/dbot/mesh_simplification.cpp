@@ -0,0 +1,437 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_simplification.cpp
+ * \date October 2026
+ */
+
+#include <dbot/mesh_simplification.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <queue>
+#include <unordered_map>
+
+namespace dbot
+{
+namespace
+{
+typedef Eigen::Matrix4d Quadric;
+
+/// boundary planes weigh this much more than the surface planes, such that
+/// open borders only move along themselves
+const double BOUNDARY_WEIGHT = 1000.;
+/// collapses must not turn a triangle normal by more than about 80 degrees
+const double MIN_NORMAL_COSINE = 0.2;
+/// smallest ratio of triangle area to squared longest edge after a collapse
+const double MIN_TRIANGLE_QUALITY = 1e-4;
+
+struct Collapse
+{
+    double cost;
+    int a;
+    int b;
+    int version_a;
+    int version_b;
+    Eigen::Vector3d position;
+
+    // ordered such that the priority queue returns the cheapest collapse,
+    // ties are broken by the vertex indices to keep the result deterministic
+    bool operator<(const Collapse& other) const
+    {
+        if (cost != other.cost) return cost > other.cost;
+        if (a != other.a) return a > other.a;
+        return b > other.b;
+    }
+};
+
+Quadric plane_quadric(const Eigen::Vector3d& normal,
+                      const Eigen::Vector3d& point,
+                      double weight)
+{
+    Eigen::Vector4d plane;
+    plane << normal, -normal.dot(point);
+    return weight * plane * plane.transpose();
+}
+
+double quadric_error(const Quadric& quadric, const Eigen::Vector3d& position)
+{
+    Eigen::Vector4d point;
+    point << position, 1.;
+    return std::max(point.dot(quadric * point), 0.);
+}
+
+class Simplifier
+{
+public:
+    Simplifier(const std::vector<Eigen::Vector3d>& vertices,
+               const std::vector<std::vector<int>>& triangle_indices)
+        : positions_(vertices),
+          quadrics_(vertices.size(), Quadric::Zero()),
+          vertex_triangles_(vertices.size()),
+          versions_(vertices.size(), 0)
+    {
+        const int vertex_count = vertices.size();
+        for (auto& indices : triangle_indices)
+        {
+            if (indices.size() != 3) continue;
+
+            std::array<int, 3> triangle = {
+                {indices[0], indices[1], indices[2]}};
+            bool valid = true;
+            for (int i = 0; i < 3; i++)
+            {
+                valid = valid && triangle[i] >= 0 &&
+                        triangle[i] < vertex_count &&
+                        triangle[i] != triangle[(i + 1) % 3];
+            }
+            if (!valid) continue;
+
+            for (int i = 0; i < 3; i++)
+            {
+                vertex_triangles_[triangle[i]].push_back(triangles_.size());
+            }
+            triangles_.push_back(triangle);
+        }
+        alive_.assign(triangles_.size(), true);
+        alive_count_ = triangles_.size();
+
+        // surface planes, weighted by the triangle area
+        std::unordered_map<uint64_t, int> edge_triangles;
+        for (size_t t = 0; t < triangles_.size(); t++)
+        {
+            const auto& triangle = triangles_[t];
+            const Eigen::Vector3d normal = triangle_normal(triangle);
+            const double area = 0.5 * normal.norm();
+            if (area > 0)
+            {
+                const Quadric quadric =
+                    plane_quadric(normal.normalized(),
+                                  positions_[triangle[0]],
+                                  area);
+                for (int i = 0; i < 3; i++) quadrics_[triangle[i]] += quadric;
+            }
+            for (int i = 0; i < 3; i++)
+            {
+                edge_triangles[edge_key(triangle[i], triangle[(i + 1) % 3])]++;
+            }
+        }
+
+        // boundary planes through each open edge, perpendicular to its
+        // triangle
+        for (size_t t = 0; t < triangles_.size(); t++)
+        {
+            const auto& triangle = triangles_[t];
+            const Eigen::Vector3d normal = triangle_normal(triangle);
+            if (normal.norm() <= 0) continue;
+
+            for (int i = 0; i < 3; i++)
+            {
+                const int a = triangle[i];
+                const int b = triangle[(i + 1) % 3];
+                if (edge_triangles[edge_key(a, b)] != 1) continue;
+
+                const Eigen::Vector3d edge = positions_[b] - positions_[a];
+                const Eigen::Vector3d boundary_normal =
+                    edge.cross(normal).normalized();
+                const Quadric quadric =
+                    plane_quadric(boundary_normal,
+                                  positions_[a],
+                                  BOUNDARY_WEIGHT * edge.squaredNorm());
+                quadrics_[a] += quadric;
+                quadrics_[b] += quadric;
+            }
+        }
+
+        for (auto& edge : edge_triangles)
+        {
+            push(int(edge.first >> 32), int(edge.first & 0xffffffffu));
+        }
+    }
+
+    void run(int target_triangle_count)
+    {
+        while (alive_count_ > target_triangle_count && !queue_.empty())
+        {
+            const Collapse collapse = queue_.top();
+            queue_.pop();
+
+            // outdated by an earlier collapse of one of its vertices
+            if (versions_[collapse.a] != collapse.version_a ||
+                versions_[collapse.b] != collapse.version_b)
+            {
+                continue;
+            }
+
+            if (!is_valid(collapse.a, collapse.b, collapse.position)) continue;
+
+            apply(collapse.a, collapse.b, collapse.position);
+        }
+    }
+
+    void result(std::vector<Eigen::Vector3d>& vertices,
+                std::vector<std::vector<int>>& triangle_indices) const
+    {
+        std::vector<int> new_index(positions_.size(), -1);
+        for (size_t t = 0; t < triangles_.size(); t++)
+        {
+            if (!alive_[t]) continue;
+            for (int vertex : triangles_[t]) new_index[vertex] = 0;
+        }
+
+        vertices.clear();
+        for (size_t v = 0; v < positions_.size(); v++)
+        {
+            if (new_index[v] < 0) continue;
+            new_index[v] = vertices.size();
+            vertices.push_back(positions_[v]);
+        }
+
+        triangle_indices.clear();
+        triangle_indices.reserve(alive_count_);
+        for (size_t t = 0; t < triangles_.size(); t++)
+        {
+            if (!alive_[t]) continue;
+            triangle_indices.push_back({new_index[triangles_[t][0]],
+                                        new_index[triangles_[t][1]],
+                                        new_index[triangles_[t][2]]});
+        }
+    }
+
+private:
+    static uint64_t edge_key(int a, int b)
+    {
+        if (a > b) std::swap(a, b);
+        return (uint64_t(a) << 32) | uint64_t(b);
+    }
+
+    Eigen::Vector3d triangle_normal(const std::array<int, 3>& triangle) const
+    {
+        return (positions_[triangle[1]] - positions_[triangle[0]])
+            .cross(positions_[triangle[2]] - positions_[triangle[0]]);
+    }
+
+    /**
+     * \brief Queues the collapse of the edge (a, b) into its cheapest position
+     */
+    void push(int a, int b)
+    {
+        const Quadric quadric = quadrics_[a] + quadrics_[b];
+        const Eigen::Vector3d& pa = positions_[a];
+        const Eigen::Vector3d& pb = positions_[b];
+        const Eigen::Vector3d midpoint = 0.5 * (pa + pb);
+
+        Collapse collapse;
+        collapse.a = a;
+        collapse.b = b;
+        collapse.version_a = versions_[a];
+        collapse.version_b = versions_[b];
+
+        // the minimum of the quadric, unless it is not unique or lies far
+        // from the edge, as it does for nearly flat neighbourhoods
+        Eigen::FullPivLU<Eigen::Matrix3d> lu(quadric.topLeftCorner<3, 3>());
+        bool optimal = false;
+        if (lu.isInvertible())
+        {
+            const Eigen::Vector3d position =
+                lu.solve(-quadric.topRightCorner<3, 1>());
+            if ((position - midpoint).squaredNorm() <=
+                4. * (pb - pa).squaredNorm())
+            {
+                collapse.position = position;
+                collapse.cost = quadric_error(quadric, position);
+                optimal = true;
+            }
+        }
+        if (!optimal)
+        {
+            collapse.position = midpoint;
+            collapse.cost = quadric_error(quadric, midpoint);
+            for (const Eigen::Vector3d* end : {&pa, &pb})
+            {
+                const double cost = quadric_error(quadric, *end);
+                if (cost < collapse.cost)
+                {
+                    collapse.position = *end;
+                    collapse.cost = cost;
+                }
+            }
+        }
+
+        queue_.push(collapse);
+    }
+
+    void neighbours(int vertex, std::vector<int>& result) const
+    {
+        result.clear();
+        for (int t : vertex_triangles_[vertex])
+        {
+            if (!alive_[t]) continue;
+            for (int other : triangles_[t])
+            {
+                if (other != vertex) result.push_back(other);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+
+    bool is_valid(int a, int b, const Eigen::Vector3d& position)
+    {
+        // the vertices shared by the neighbourhoods of a and b have to be the
+        // opposite corners of the triangles on the edge, otherwise the
+        // collapse pinches the surface
+        neighbours(a, neighbours_a_);
+        neighbours(b, neighbours_b_);
+        shared_.clear();
+        std::set_intersection(neighbours_a_.begin(),
+                              neighbours_a_.end(),
+                              neighbours_b_.begin(),
+                              neighbours_b_.end(),
+                              std::back_inserter(shared_));
+
+        int edge_triangle_count = 0;
+        for (int t : vertex_triangles_[a])
+        {
+            if (alive_[t] && contains(triangles_[t], b)) edge_triangle_count++;
+        }
+        if (edge_triangle_count == 0 ||
+            int(shared_.size()) != edge_triangle_count)
+        {
+            return false;
+        }
+
+        for (int vertex : {a, b})
+        {
+            for (int t : vertex_triangles_[vertex])
+            {
+                if (!alive_[t]) continue;
+                const auto& triangle = triangles_[t];
+                if (contains(triangle, a) && contains(triangle, b)) continue;
+
+                std::array<Eigen::Vector3d, 3> corners;
+                for (int i = 0; i < 3; i++)
+                {
+                    corners[i] = triangle[i] == vertex
+                                     ? position
+                                     : positions_[triangle[i]];
+                }
+
+                const Eigen::Vector3d old_normal = triangle_normal(triangle);
+                const Eigen::Vector3d new_normal =
+                    (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+                const double new_area = new_normal.norm();
+                if (new_area <= 0. ||
+                    old_normal.dot(new_normal) <=
+                        MIN_NORMAL_COSINE * old_normal.norm() * new_area)
+                {
+                    return false;
+                }
+
+                double longest_edge = 0;
+                for (int i = 0; i < 3; i++)
+                {
+                    longest_edge =
+                        std::max(longest_edge,
+                                 (corners[(i + 1) % 3] - corners[i])
+                                     .squaredNorm());
+                }
+                if (new_area < MIN_TRIANGLE_QUALITY * longest_edge)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    static bool contains(const std::array<int, 3>& triangle, int vertex)
+    {
+        return triangle[0] == vertex || triangle[1] == vertex ||
+               triangle[2] == vertex;
+    }
+
+    /**
+     * \brief Merges b into a, which moves to the given position
+     */
+    void apply(int a, int b, const Eigen::Vector3d& position)
+    {
+        positions_[a] = position;
+        quadrics_[a] += quadrics_[b];
+
+        for (int t : vertex_triangles_[b])
+        {
+            if (!alive_[t]) continue;
+
+            auto& triangle = triangles_[t];
+            if (contains(triangle, a))
+            {
+                alive_[t] = false;
+                alive_count_--;
+                continue;
+            }
+
+            for (auto& vertex : triangle)
+            {
+                if (vertex == b) vertex = a;
+            }
+            vertex_triangles_[a].push_back(t);
+        }
+        vertex_triangles_[b].clear();
+        versions_[b] = -1;
+        versions_[a]++;
+
+        // drop the removed triangles, the lists of the other vertices are
+        // cleaned when they are collapsed themselves
+        auto& triangles = vertex_triangles_[a];
+        triangles.erase(std::remove_if(triangles.begin(),
+                                       triangles.end(),
+                                       [this](int t) { return !alive_[t]; }),
+                        triangles.end());
+
+        // the costs of all edges of a changed
+        neighbours(a, neighbours_a_);
+        for (int neighbour : neighbours_a_) push(a, neighbour);
+    }
+
+    std::vector<Eigen::Vector3d> positions_;
+    std::vector<Quadric, Eigen::aligned_allocator<Quadric>> quadrics_;
+    std::vector<std::array<int, 3>> triangles_;
+    std::vector<bool> alive_;
+    int alive_count_;
+    std::vector<std::vector<int>> vertex_triangles_;
+    std::vector<int> versions_;
+    std::priority_queue<Collapse> queue_;
+
+    // scratch buffers of is_valid() and apply()
+    std::vector<int> neighbours_a_;
+    std::vector<int> neighbours_b_;
+    std::vector<int> shared_;
+};
+}
+
+void simplify_mesh(const std::vector<Eigen::Vector3d>& vertices,
+                   const std::vector<std::vector<int>>& triangle_indices,
+                   int target_triangle_count,
+                   std::vector<Eigen::Vector3d>& simplified_vertices,
+                   std::vector<std::vector<int>>& simplified_indices)
+{
+    Simplifier simplifier(vertices, triangle_indices);
+    simplifier.run(std::max(target_triangle_count, 0));
+    simplifier.result(simplified_vertices, simplified_indices);
+}
+}
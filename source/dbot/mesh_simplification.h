@@ -0,0 +1,45 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_simplification.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Reduces a triangle mesh by quadric error edge collapses
+ *
+ * Edges are collapsed in the order of the squared distance of the merged
+ * vertex to the planes of the triangles it replaces (Garland and Heckbert,
+ * Surface Simplification Using Quadric Error Metrics, SIGGRAPH 1997). Open
+ * boundaries are kept in place by additional planes perpendicular to them.
+ * Collapses which would flip or degenerate a triangle, or make the surface
+ * non-manifold, are skipped, such that the simplification may stop above the
+ * target if no valid collapse is left.
+ *
+ * The output only contains the vertices which are still referenced.
+ */
+void simplify_mesh(const std::vector<Eigen::Vector3d>& vertices,
+                   const std::vector<std::vector<int>>& triangle_indices,
+                   int target_triangle_count,
+                   std::vector<Eigen::Vector3d>& simplified_vertices,
+                   std::vector<std::vector<int>>& simplified_indices);
+}
@@ -0,0 +1,193 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_simplification_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <utility>
+
+#include <dbot/mesh_simplification.h>
+
+typedef std::vector<Eigen::Vector3d> Vertices;
+typedef std::vector<std::vector<int>> Triangles;
+
+/**
+ * \brief Unit sphere of latitude and longitude rings
+ */
+void make_sphere(int rings,
+                 int segments,
+                 Vertices& vertices,
+                 Triangles& triangles)
+{
+    vertices.clear();
+    triangles.clear();
+
+    vertices.push_back(Eigen::Vector3d(0, 0, 1));
+    for (int ring = 1; ring < rings; ring++)
+    {
+        const double theta = M_PI * ring / rings;
+        for (int segment = 0; segment < segments; segment++)
+        {
+            const double phi = 2 * M_PI * segment / segments;
+            vertices.push_back(Eigen::Vector3d(std::sin(theta) * std::cos(phi),
+                                               std::sin(theta) * std::sin(phi),
+                                               std::cos(theta)));
+        }
+    }
+    vertices.push_back(Eigen::Vector3d(0, 0, -1));
+
+    auto index = [segments](int ring, int segment)
+    {
+        return 1 + (ring - 1) * segments + segment % segments;
+    };
+    const int south = vertices.size() - 1;
+    for (int segment = 0; segment < segments; segment++)
+    {
+        triangles.push_back({0, index(1, segment), index(1, segment + 1)});
+        for (int ring = 1; ring < rings - 1; ring++)
+        {
+            triangles.push_back({index(ring, segment),
+                                 index(ring + 1, segment),
+                                 index(ring + 1, segment + 1)});
+            triangles.push_back({index(ring, segment),
+                                 index(ring + 1, segment + 1),
+                                 index(ring, segment + 1)});
+        }
+        triangles.push_back(
+            {south, index(rings - 1, segment + 1), index(rings - 1, segment)});
+    }
+}
+
+TEST(MeshSimplificationTests, sphere_stays_closed_and_round)
+{
+    Vertices vertices;
+    Triangles triangles;
+    make_sphere(32, 64, vertices, triangles);
+
+    Vertices simple_vertices;
+    Triangles simple_triangles;
+    dbot::simplify_mesh(
+        vertices, triangles, 400, simple_vertices, simple_triangles);
+
+    EXPECT_LE(simple_triangles.size(), 400u);
+    EXPECT_GT(simple_triangles.size(), 300u);
+
+    for (auto& vertex : simple_vertices)
+    {
+        EXPECT_NEAR(vertex.norm(), 1., 0.05);
+    }
+
+    // every edge of a closed manifold is shared by two triangles of opposite
+    // orientation
+    std::map<std::pair<int, int>, int> directed_edges;
+    for (auto& triangle : simple_triangles)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            ASSERT_GE(triangle[i], 0);
+            ASSERT_LT(triangle[i], int(simple_vertices.size()));
+            directed_edges[{triangle[i], triangle[(i + 1) % 3]}]++;
+        }
+
+        // the faces keep pointing outwards
+        const Eigen::Vector3d normal =
+            (simple_vertices[triangle[1]] - simple_vertices[triangle[0]])
+                .cross(simple_vertices[triangle[2]] -
+                       simple_vertices[triangle[0]]);
+        EXPECT_GT(normal.dot(simple_vertices[triangle[0]]), 0.);
+    }
+    for (auto& edge : directed_edges)
+    {
+        EXPECT_EQ(edge.second, 1);
+        EXPECT_EQ(directed_edges.count({edge.first.second, edge.first.first}),
+                  1u);
+    }
+}
+
+TEST(MeshSimplificationTests, plane_keeps_its_outline)
+{
+    const int size = 20;
+    Vertices vertices;
+    Triangles triangles;
+    for (int row = 0; row <= size; row++)
+    {
+        for (int col = 0; col <= size; col++)
+        {
+            vertices.push_back(
+                Eigen::Vector3d(double(col) / size, double(row) / size, 0));
+        }
+    }
+    for (int row = 0; row < size; row++)
+    {
+        for (int col = 0; col < size; col++)
+        {
+            const int corner = row * (size + 1) + col;
+            triangles.push_back({corner, corner + 1, corner + size + 2});
+            triangles.push_back({corner, corner + size + 2, corner + size + 1});
+        }
+    }
+
+    Vertices simple_vertices;
+    Triangles simple_triangles;
+    dbot::simplify_mesh(
+        vertices, triangles, 2, simple_vertices, simple_triangles);
+
+    EXPECT_LT(simple_triangles.size(), triangles.size() / 4);
+
+    double area = 0;
+    for (auto& triangle : simple_triangles)
+    {
+        area += 0.5 * (simple_vertices[triangle[1]] -
+                       simple_vertices[triangle[0]])
+                          .cross(simple_vertices[triangle[2]] -
+                                 simple_vertices[triangle[0]])
+                          .z();
+    }
+    EXPECT_NEAR(area, 1., 1e-6);
+
+    for (auto& vertex : simple_vertices)
+    {
+        EXPECT_NEAR(vertex.z(), 0., 1e-9);
+        EXPECT_GE(vertex.x(), -1e-9);
+        EXPECT_LE(vertex.x(), 1. + 1e-9);
+        EXPECT_GE(vertex.y(), -1e-9);
+        EXPECT_LE(vertex.y(), 1. + 1e-9);
+    }
+}
+
+TEST(MeshSimplificationTests, reachable_target_leaves_mesh_unchanged)
+{
+    Vertices vertices;
+    Triangles triangles;
+    make_sphere(4, 8, vertices, triangles);
+
+    Vertices simple_vertices;
+    Triangles simple_triangles;
+    dbot::simplify_mesh(vertices,
+                        triangles,
+                        triangles.size(),
+                        simple_vertices,
+                        simple_triangles);
+
+    EXPECT_EQ(simple_triangles, triangles);
+    ASSERT_EQ(simple_vertices.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        EXPECT_TRUE(simple_vertices[i].isApprox(vertices[i]));
+    }
+}
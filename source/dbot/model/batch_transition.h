@@ -0,0 +1,53 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_transition.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Transition which propagates a whole particle population at once
+ *
+ * The particle filter uses this interface if its transition implements it in
+ * addition to fl::TransitionFunction, and calls the transition per particle
+ * otherwise. The states and noises are stored as one particle per row, such
+ * that each state dimension is contiguous across the population.
+ */
+template <typename State, typename Noise, typename Input>
+class BatchTransition
+{
+public:
+    typedef Eigen::Matrix<typename State::Scalar,
+                          Eigen::Dynamic,
+                          Eigen::Dynamic>
+        Matrix;
+
+public:
+    virtual ~BatchTransition() noexcept {}
+    /**
+     * \brief Propagates row i of prev_states given row i of noises into row i
+     *        of states, which is resized if necessary
+     */
+    virtual void states(const Matrix& prev_states,
+                        const Matrix& noises,
+                        const Input& input,
+                        Matrix& states) const = 0;
+};
+}
@@ -0,0 +1,143 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file coarse_to_fine_sensor.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <dbot/depth_frame.h>
+#include <dbot/model/rao_blackwell_sensor.h>
+
+namespace dbot
+{
+/**
+ * \brief Sensor with a coarse level of the observation pyramid
+ *
+ * The fine sensor computes the likelihoods and tracks the occlusions like on
+ * its own. The coarse sensor observes the same frames at a lower resolution,
+ * both the CPU and the GPU sensor downsample frames of an integer multiple
+ * of their resolution themselves. It renders and evaluates a fraction of the
+ * pixels and lets the filter prune hopeless particles before the fine
+ * evaluation, see CoarseToFineParameters. The coarse occlusions remain at
+ * their initial probability.
+ */
+template <typename State>
+class CoarseToFineSensor : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+    typedef typename Base::PoseArray PoseArray;
+
+public:
+    /**
+     * \param rows, cols  resolution of the fine sensor, i.e. of the
+     *                    observations passed to set_observation()
+     */
+    CoarseToFineSensor(const std::shared_ptr<Base>& fine,
+                       const std::shared_ptr<Base>& coarse,
+                       int rows,
+                       int cols,
+                       fl::Real delta_time)
+        : Base(delta_time),
+          fine_(fine),
+          coarse_(coarse),
+          rows_(rows),
+          cols_(cols)
+    {
+    }
+
+    RealArray loglikes(const StateArray& deviations,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        return fine_->loglikes(deviations, indices, update);
+    }
+
+    bool coarse_loglikes(const StateArray& deviations, RealArray& loglikes)
+    {
+        coarse_->integrated_poses() = fine_->integrated_poses();
+        coarse_indices_.setZero(deviations.size());
+        loglikes = coarse_->loglikes(deviations, coarse_indices_, false);
+        return true;
+    }
+
+    void set_observation(const Observation& image)
+    {
+        if (image.size() != rows_ * cols_)
+        {
+            std::cout << "ERROR: observation of " << image.size()
+                      << " pixels for a sensor of " << rows_ << " x " << cols_
+                      << " pixels" << std::endl;
+            exit(-1);
+        }
+        fine_->set_observation(image);
+
+        auto frame = std::make_shared<DepthFrame>(rows_, cols_);
+        for (int i = 0; i < image.size(); i++) frame->data()[i] = image(i);
+        coarse_->set_depth_frame(frame);
+    }
+
+    void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        fine_->set_depth_frame(frame);
+        coarse_->set_depth_frame(frame);
+    }
+
+    void set_depth_frames(const std::vector<DepthFrame::ConstPtr>& frames)
+    {
+        fine_->set_depth_frames(frames);
+        coarse_->set_depth_frames(frames);
+    }
+
+    PoseArray& integrated_poses() { return fine_->integrated_poses(); }
+    void reset()
+    {
+        fine_->reset();
+        coarse_->reset();
+    }
+
+    void latency_metrics(const std::shared_ptr<LatencyMetrics>& metrics)
+    {
+        Base::latency_metrics(metrics);
+        fine_->latency_metrics(metrics);
+        coarse_->latency_metrics(metrics);
+    }
+
+    int max_sample_count() const
+    {
+        return std::min(fine_->max_sample_count(),
+                        coarse_->max_sample_count());
+    }
+
+    const std::shared_ptr<Base>& fine() const { return fine_; }
+    const std::shared_ptr<Base>& coarse() const { return coarse_; }
+
+private:
+    std::shared_ptr<Base> fine_;
+    std::shared_ptr<Base> coarse_;
+    int rows_;
+    int cols_;
+    IntArray coarse_indices_;
+};
+}
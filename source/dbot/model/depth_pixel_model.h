@@ -30,9 +30,13 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <dbot/model/render_cache.h>
 #include <dbot/pose/pose_hashing.h>
 #include <dbot/rigid_body_renderer.h>
+#include <dbot/worker_pool.h>
 #include <fl/distribution/cauchy_distribution.hpp>
 #include <fl/distribution/gaussian.hpp>
 #include <fl/distribution/uniform_distribution.hpp>
@@ -42,10 +46,19 @@
 #include <fl/util/scalar_matrix.hpp>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <thread>
+#include <vector>
 
 namespace fl
 {
+/**
+ * \brief Depth of a single pixel given the rendered object
+ *
+ * All copies share the render cache, the pool of renderers and the pixel
+ * table, and may be evaluated concurrently by different threads. Each copy
+ * only holds its own id, so a thread evaluating several pixels should use a
+ * copy of its own.
+ */
 template <typename State_>
 class DepthPixelModel : public SensorFunction<Vector1d, State_, Vector1d>,
                         public SensorDensity<Vector1d, State_>,
@@ -56,62 +69,74 @@ public:
     typedef Vector1d Noise;
     typedef State_ State;
 
-    typedef std::unordered_map<State, State, dbot::PoseHash<State>>
-        PoseCacheMap;
-
-    typedef std::unordered_map<State, Eigen::VectorXd, dbot::PoseHash<State>>
-        RenderCacheMap;
+    typedef dbot::RenderCache<dbot::QuantizedPoseKey,
+                              dbot::QuantizedPoseKeyHash>
+        RenderCache;
 
 public:
+    /**
+     * \param render_cache_capacity     Maximum number of rendered states kept
+     *                                  between two nominal_pose() calls
+     * \param render_cache_shard_count  Number of independently locked parts
+     *                                  of the render cache
+     * \param quantization              Resolution of the render cache keys,
+     *                                  states closer than this share an image
+     */
     DepthPixelModel(const std::shared_ptr<dbot::RigidBodyRenderer>& renderer,
                     Real bg_depth,
                     Real fg_sigma,
                     Real bg_sigma,
-                    int state_dim = DimensionOf<State>::Value)
-        : state_dim_(state_dim), renderer_(renderer), id_(0)
+                    int state_dim = DimensionOf<State>::Value,
+                    int render_cache_capacity = 1024,
+                    int render_cache_shard_count = 16,
+                    const dbot::PoseQuantization& quantization =
+                        dbot::PoseQuantization())
+        : state_dim_(state_dim),
+          bg_sigma_(bg_sigma),
+          fg_sigma_(fg_sigma),
+          renderer_(renderer),
+          id_(0),
+          quantization_(quantization)
     {
-        mutex = std::make_shared<std::mutex>();
-        render_cache_ = std::make_shared<RenderCacheMap>();
-        poses_cache_ = std::make_shared<PoseCacheMap>();
+        renderers_ = std::make_shared<RendererPool>(renderer_);
+        render_cache_ = std::make_shared<RenderCache>(
+            render_cache_capacity, render_cache_shard_count);
+        render_thread_count_ = std::make_shared<int>(1);
+        worker_pool_ = std::make_shared<std::shared_ptr<dbot::WorkerPool>>();
+        pixels_ = std::make_shared<std::vector<int>>();
 
         // setup backgroud density
-        auto bg_mean = Obsrv(1);
-
-        bg_mean(0) =
+        bg_depth_ =
             bg_depth < 0. ? std::numeric_limits<Real>::infinity() : bg_depth;
-        bg_density_.mean(bg_mean);
-        bg_density_.square_root(bg_density_.square_root() * bg_sigma);
-
-        fg_density_.square_root(fg_density_.square_root() * fg_sigma);
-    }
-
-    DepthPixelModel(const DepthPixelModel& other)
-    {
-        state_dim_ = other.state_dim_;
-        renderer_ = other.renderer_;
-        id_ = other.id_;
-        bg_density_ = other.bg_density_;
-        fg_density_ = other.fg_density_;
-        mutex = other.mutex;
-        nominal_pose_ = other.nominal_pose_;
-        render_cache_ = other.render_cache_;
-        poses_cache_ = other.poses_cache_;
     }
 
     virtual ~DepthPixelModel() noexcept {}
+    /*
+     * The densities are evaluated in closed form instead of through
+     * Gaussian<Obsrv>, whose mean would have to be set per pixel and whose
+     * lazily computed factorization is not safe to share between threads.
+     */
     Real log_probability(const Obsrv& obsrv, const State& state) const override
     {
-        return density(state).log_probability(obsrv);
+        Real mean, sigma;
+        density(state, mean, sigma);
+
+        const Real z = (obsrv(0) - mean) / sigma;
+        return -0.5 * z * z - std::log(sigma) - 0.5 * std::log(2. * M_PI);
     }
 
     Real probability(const Obsrv& obsrv, const State& state) const override
     {
-        return density(state).probability(obsrv);
+        return std::exp(log_probability(obsrv, state));
     }
 
     Obsrv observation(const State& state, const Noise& noise) const override
     {
-        Obsrv y = density(state).map_standard_normal(noise);
+        Real mean, sigma;
+        density(state, mean, sigma);
+
+        Obsrv y;
+        y(0) = mean + sigma * noise(0);
         return y;
     }
 
@@ -120,87 +145,265 @@ public:
     virtual int state_dimension() const { return state_dim_; }
     virtual int id() const { return id_; }
     virtual void id(int new_id) { id_ = new_id; }
+    /**
+     * \brief Sets the pose the evaluated states are relative to. Must not be
+     *        called while copies of the model are evaluated.
+     */
     void nominal_pose(const State& p)
     {
-        std::lock_guard<std::mutex> lock(*mutex);
-
-        render_cache_->clear();
         nominal_pose_ = p;
+        render_cache_->clear();
     }
 
-    virtual std::string name() const { return "DepthPixelModel"; }
-    virtual std::string description() const { return "DepthPixelModel"; }
-private:
-    /** \cond internal */
-    void map(const State& pose, Eigen::VectorXd& obsrv_image) const
+    /**
+     * \brief Restricts the models to a subset of the image, the model with id
+     *        i then evaluates the pixel pixels[i]. Shared by all copies, an
+     *        empty set selects the whole image.
+     */
+    void pixels(const std::vector<int>& pixels) { *pixels_ = pixels; }
+    const std::vector<int>& pixels() const { return *pixels_; }
+    /**
+     * \brief Indices of the pixels within the bounding box of the object
+     *        projected at the nominal pose, widened by margin pixels
+     */
+    std::vector<int> projected_pixels(int margin) const
     {
-        renderer_->set_poses({pose.component(0).affine()});
-        renderer_->Render(depth_rendering_);
+        int row_begin, row_end, col_begin, col_end;
+        {
+            RendererLease renderer(*renderers_);
+            renderer->set_poses({nominal_pose_.component(0).affine()});
+            if (!renderer->projected_bounds(
+                    margin, row_begin, row_end, col_begin, col_end))
+            {
+                return std::vector<int>();
+            }
+        }
 
-        convert(depth_rendering_, obsrv_image);
+        const int cols = renderer_->n_cols_;
+        std::vector<int> pixels;
+        pixels.reserve((row_end - row_begin) * (col_end - col_begin));
+        for (int row = row_begin; row < row_end; ++row)
+        {
+            for (int col = col_begin; col < col_end; ++col)
+            {
+                pixels.push_back(row * cols + col);
+            }
+        }
+        return pixels;
     }
 
-    void convert(const std::vector<float>& depth,
-                 Eigen::VectorXd& obsrv_image) const
+    /**
+     * \brief Renders all given states which are not cached yet, e.g. all
+     *        sigma points of a filter update, such that the following pixel
+     *        evaluations only read from the cache
+     *
+     * The states are distributed over render_thread_count() threads, or
+     * over the threads of the worker pool if one is set.
+     */
+    void render_batch(const std::vector<State>& states) const
     {
-        const int pixel_count = depth.size();
-        obsrv_image.resize(pixel_count, 1);
-
-        for (int i = 0; i < pixel_count; ++i)
+        std::vector<const State*> missing_states;
+        std::vector<dbot::QuantizedPoseKey> missing_keys;
+        for (auto& state : states)
         {
-            if (!std::isinf(depth[i]))
+            auto key = dbot::make_pose_key(state, quantization_);
+            if (render_cache_->contains(key) ||
+                std::find(missing_keys.begin(), missing_keys.end(), key) !=
+                    missing_keys.end())
             {
-                obsrv_image(i, 0) = depth[i];
+                continue;
             }
-            else
+            missing_states.push_back(&state);
+            missing_keys.push_back(key);
+        }
+
+        const auto& pool = *worker_pool_;
+        const int thread_count =
+            std::min<int>(pool ? pool->concurrency() : *render_thread_count_,
+                          missing_states.size());
+        if (thread_count <= 0) return;
+
+        auto render_part = [&](int part)
+        {
+            RendererLease renderer(*renderers_);
+            std::vector<float> image;
+            for (size_t i = part; i < missing_states.size(); i += thread_count)
             {
-                obsrv_image(i, 0) = std::numeric_limits<double>::infinity();
+                render(*renderer, *missing_states[i], image);
+                render_cache_->insert(missing_keys[i], image);
             }
+        };
+
+        if (pool)
+        {
+            pool->parallel_for(thread_count, render_part);
+            return;
         }
+
+        std::vector<std::thread> threads;
+        for (int part = 1; part < thread_count; ++part)
+        {
+            threads.emplace_back(render_part, part);
+        }
+        render_part(0);
+        for (auto& thread : threads) thread.join();
+    }
+
+    /**
+     * \brief Number of threads render_batch() distributes the states over,
+     *        shared by all copies of this model
+     */
+    void render_thread_count(int count)
+    {
+        *render_thread_count_ = std::max(count, 1);
     }
 
-    const Gaussian<Obsrv>& density(const State& state) const
+    int render_thread_count() const { return *render_thread_count_; }
+    /**
+     * \brief Pool render_batch() runs on instead of threads of its own,
+     *        shared by all copies of this model
+     */
+    void worker_pool(const std::shared_ptr<dbot::WorkerPool>& pool)
     {
-        Obsrv y = depth(state);
+        *worker_pool_ = pool;
+    }
+
+    const std::shared_ptr<dbot::WorkerPool>& worker_pool() const
+    {
+        return *worker_pool_;
+    }
+    /**
+     * \brief Hit, miss and contention counters of the render cache shared by
+     *        all copies of this model
+     */
+    dbot::RenderCacheStatistics render_cache_statistics() const
+    {
+        return render_cache_->statistics();
+    }
+
+    virtual std::string name() const { return "DepthPixelModel"; }
+    virtual std::string description() const { return "DepthPixelModel"; }
+private:
+    /** \cond internal */
+    /**
+     * \brief Copies of the renderer the model was created with, such that
+     *        every thread rendering at a time has its own
+     *
+     * The renderer given to the model is never rendered with, it only serves
+     * as the prototype of the copies.
+     */
+    class RendererPool
+    {
+    public:
+        explicit RendererPool(
+            const std::shared_ptr<dbot::RigidBodyRenderer>& prototype)
+            : prototype_(prototype)
+        {
+        }
+
+        std::shared_ptr<dbot::RigidBodyRenderer> acquire()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_.empty())
+            {
+                return std::make_shared<dbot::RigidBodyRenderer>(*prototype_);
+            }
+
+            auto renderer = free_.back();
+            free_.pop_back();
+            return renderer;
+        }
+
+        void release(const std::shared_ptr<dbot::RigidBodyRenderer>& renderer)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(renderer);
+        }
+
+    private:
+        std::shared_ptr<dbot::RigidBodyRenderer> prototype_;
+        std::mutex mutex_;
+        std::vector<std::shared_ptr<dbot::RigidBodyRenderer>> free_;
+    };
 
-        if (std::isinf(y(0)))
+    /**
+     * \brief Renderer taken from the pool for the lifetime of the lease
+     */
+    class RendererLease
+    {
+    public:
+        explicit RendererLease(RendererPool& pool)
+            : pool_(pool), renderer_(pool.acquire())
         {
-            return bg_density_;
         }
 
-        fg_density_.mean(y);
-        return fg_density_;
+        ~RendererLease() { pool_.release(renderer_); }
+        RendererLease(const RendererLease&) = delete;
+        RendererLease& operator=(const RendererLease&) = delete;
+
+        dbot::RigidBodyRenderer* operator->() const { return renderer_.get(); }
+        dbot::RigidBodyRenderer& operator*() const { return *renderer_; }
+    private:
+        RendererPool& pool_;
+        std::shared_ptr<dbot::RigidBodyRenderer> renderer_;
+    };
+
+    void map(const State& state, std::vector<float>& obsrv_image) const
+    {
+        RendererLease renderer(*renderers_);
+        render(*renderer, state, obsrv_image);
     }
 
-    Obsrv depth(const State& current_state) const
+    /**
+     * \brief Renders the given state into the image, with the pixels not
+     *        covered by the object set to infinity
+     */
+    void render(dbot::RigidBodyRenderer& renderer,
+                const State& state,
+                std::vector<float>& obsrv_image) const
     {
-        RenderCacheMap& render_cache_ = *this->render_cache_;
-        PoseCacheMap& poses_cache_ = *this->poses_cache_;
+        State pose = state;
 
-        if (render_cache_.find(current_state) == render_cache_.end())
-        {
-            State current_pose = current_state;
+        /// \todo: this transformation should not be done in here
 
-            /// \todo: this transformation should not be done in here
+        pose.component(0).position() =
+            nominal_pose_.component(0).orientation().rotation_matrix() *
+                state.component(0).position() +
+            nominal_pose_.component(0).position();
 
-            current_pose.component(0).position() =
-                nominal_pose_.component(0).orientation().rotation_matrix() *
-                    current_state.component(0).position() +
-                nominal_pose_.component(0).position();
+        pose.component(0).orientation() =
+            nominal_pose_.component(0).orientation() *
+            state.component(0).orientation();
 
-            current_pose.component(0).orientation() =
-                nominal_pose_.component(0).orientation() *
-                current_state.component(0).orientation();
+        renderer.set_poses({pose.component(0).affine()});
+        renderer.Render(obsrv_image);
+    }
 
-            std::lock_guard<std::mutex> lock(*mutex);
-            map(current_pose, render_cache_[current_state]);
-            poses_cache_[current_state] = current_pose;
+    /**
+     * \brief Mean and standard deviation of the depth of the pixel, the
+     *        background density if the object does not cover it
+     */
+    void density(const State& state, Real& mean, Real& sigma) const
+    {
+        mean = depth(state)(0);
+        sigma = fg_sigma_;
+
+        if (std::isinf(mean))
+        {
+            mean = bg_depth_;
+            sigma = bg_sigma_;
         }
+    }
 
-        assert(render_cache_.find(current_state) != render_cache_.end());
+    Obsrv depth(const State& current_state) const
+    {
+        const int pixel = pixels_->empty() ? id_ : (*pixels_)[id_];
 
         Obsrv depth;
-        depth(0) = render_cache_[current_state](id_);
+        depth(0) = render_cache_->pixel(
+            dbot::make_pose_key(current_state, quantization_),
+            pixel,
+            [&](std::vector<float>& image) { map(current_state, image); });
 
         return depth;
     }
@@ -209,19 +412,21 @@ private:
 private:
     int state_dim_;
 
-    mutable Gaussian<Obsrv> fg_density_;
-    mutable Gaussian<Obsrv> bg_density_;
+    Real bg_depth_;
+    Real bg_sigma_;
+    Real fg_sigma_;
 
-    mutable std::shared_ptr<std::mutex> mutex;
-    mutable std::vector<float> depth_rendering_;
     std::shared_ptr<dbot::RigidBodyRenderer> renderer_;
+    std::shared_ptr<RendererPool> renderers_;
 
 private:
     int id_;
     mutable State nominal_pose_;
+    dbot::PoseQuantization quantization_;
 
-public:
-    mutable std::shared_ptr<RenderCacheMap> render_cache_;
-    mutable std::shared_ptr<PoseCacheMap> poses_cache_;
+    std::shared_ptr<RenderCache> render_cache_;
+    std::shared_ptr<int> render_thread_count_;
+    std::shared_ptr<std::shared_ptr<dbot::WorkerPool>> worker_pool_;
+    std::shared_ptr<std::vector<int>> pixels_;
 };
 }
@@ -29,15 +29,27 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <dbot/depth_downsampling.h>
+#include <dbot/latency_metrics.h>
 #include <dbot/model/kinect_pixel_model.h>
 #include <dbot/model/occlusion_model.h>
+#include <dbot/model/occlusion_store.h>
 #include <dbot/model/rao_blackwell_sensor.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
 #include <dbot/pose/pose_vector.h>
+#include <dbot/pose/rigid_bodies_state_array.h>
 #include <dbot/rigid_body_renderer.h>
 #include <dbot/traits.h>
+#include <dbot/worker_pool.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <fl/util/assertions.hpp>
+#include <functional>
+#include <iostream>
 #include <memory>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace dbot
@@ -89,6 +101,14 @@ public:
 
     typedef typename Eigen::Transform<fl::Real, 3, Eigen::Affine> Affine;
 
+    /**
+     * \param thread_count  Number of worker threads used to evaluate the
+     *                      particles in loglikes(). Each worker renders with
+     *                      its own copy of the renderer. A value of 0 selects
+     *                      the number of hardware threads. Beyond one, the
+     *                      model keeps a private pool of thread_count - 1
+     *                      threads, see worker_pool().
+     */
     // TODO: DO WE NEED ALL OF THIS IN THE CONSTRUCTOR??
     KinectImageModel(const Eigen::Matrix3d& camera_matrix,
                      const size_t& n_rows,
@@ -97,7 +117,8 @@ public:
                      const PixelSensorPtr sensor,
                      const OcclusionModelPtr occlusion_transition,
                      const float& initial_occlusion,
-                     const double& delta_time)
+                     const double& delta_time,
+                     const int& thread_count = 1)
         : camera_matrix_(camera_matrix),
           n_rows_(n_rows),
           n_cols_(n_cols),
@@ -105,14 +126,34 @@ public:
           object_model_(object_renderer),
           sensor_(sensor),
           occlusion_transition_(occlusion_transition),
+          occlusion_store_(n_rows * n_cols, initial_occlusion),
+          valid_observation_count_(0),
           observation_time_(0),
           Base(delta_time)
     {
-        static_assert_base(State, dbot::RigidBodiesState<OBJECTS>);
-
-        this->default_poses_.recount(object_model_->vertices().size());
+        // OBJECTS is the number of bodies, -1 for any
+        static_assert_base(
+            State, dbot::RigidBodiesState<State::SizeAtCompileTime>);
+        static_assert(
+            OBJECTS == -1 ||
+                State::SizeAtCompileTime ==
+                    OBJECTS * FreeFloatingRigidBodiesState<>::BODY_SIZE,
+            "the state does not have OBJECTS bodies");
+
+        this->default_poses_.recount(object_model_->count_parts());
         this->default_poses_.setZero();
 
+        int worker_count = thread_count;
+        if (worker_count <= 0)
+        {
+            worker_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        if (worker_count > 1)
+        {
+            worker_pool_ = std::make_shared<WorkerPool>(worker_count - 1);
+        }
+        create_workers(worker_count);
+
         reset();
     }
 
@@ -121,103 +162,83 @@ public:
                        IntArray& indices,
                        const bool& update = false)
     {
-        std::vector<std::vector<float>> new_occlusions(deltas.size());
-        std::vector<std::vector<double>> new_occlusion_times(deltas.size());
+        const int particle_count = deltas.size();
 
-        RealArray log_likes = RealArray::Zero(deltas.size());
-        for (size_t i_state = 0; i_state < size_t(deltas.size()); i_state++)
+        RealArray log_likes = RealArray::Zero(particle_count);
+
+        if (update && compact_occlusion_store_)
         {
-            if (update)
-            {
-                new_occlusions[i_state] = occlusions_[indices[i_state]];
-                new_occlusion_times[i_state] =
-                    occlusion_times_[indices[i_state]];
-            }
+            compact_occlusion_store_->begin_update(particle_count);
+        }
+        else if (update)
+        {
+            occlusion_store_.begin_update(particle_count);
+        }
 
-            // render the object model -----------------------------------------
-            int body_count = deltas[i_state].count();
-            std::vector<Affine> poses(body_count);
-            for (size_t i_obj = 0; i_obj < body_count; i_obj++)
-            {
-                auto pose_0 = this->default_poses_.component(i_obj);
-                auto delta = deltas[i_state].component(i_obj);
+        if (particle_count > 0 && deltas[0].count() > 1)
+        {
+            prepare_part_layers(particle_count, deltas[0].count());
+        }
 
-                dbot::PoseVector pose;
+        // compose the deltas with the default poses of all particles at once
+        delta_columns_.gather(deltas);
+        delta_columns_.expand(this->default_poses_);
 
-                /// \todo: this should be done through the the apply_delta
-                /// function
-                pose.position() =
-                    pose_0.orientation().rotation_matrix() * delta.position() +
-                    pose_0.position();
-                pose.orientation() = pose_0.orientation() * delta.orientation();
+        // split the particles into contiguous ranges, one per worker. The
+        // calling thread evaluates the first range itself.
+        const int worker_count =
+            std::max(1, std::min(int(workers_.size()), particle_count));
+        const int range = (particle_count + worker_count - 1) / worker_count;
 
-                poses[i_obj] = pose.affine();
-            }
-            object_model_->set_poses(poses);
-            std::vector<int> intersect_indices;
-            std::vector<float> predictions;
-            object_model_->Render(camera_matrix_,
-                                  n_rows_,
-                                  n_cols_,
-                                  intersect_indices,
-                                  predictions);
-
-            // compute likelihoods ---------------------------------------------
-            for (size_t i = 0; i < size_t(predictions.size()); i++)
+        auto evaluate_range = [&](int i_worker)
+        {
+            const int begin = std::min(i_worker * range, particle_count);
+            evaluate(workers_[i_worker],
+                     deltas,
+                     indices,
+                     update,
+                     begin,
+                     std::min(begin + range, particle_count),
+                     log_likes);
+        };
+
+        if (worker_pool_)
+        {
+            worker_pool_->parallel_for(worker_count, evaluate_range);
+        }
+        else
+        {
+            evaluate_range(0);
+        }
+
+        // the workers run in parallel, the slowest one sets the latency
+        if (this->latency_metrics_)
+        {
+            double render_seconds = 0;
+            double weight_seconds = 0;
+            for (int i_worker = 0; i_worker < worker_count; ++i_worker)
             {
-                if (std::isnan(observations_[intersect_indices[i]]))
-                {
-                    log_likes[i_state] += log(1.);
-                }
-                else
-                {
-                    double delta_time = observation_time_ -
-                                        occlusion_times_[indices[i_state]]
-                                                        [intersect_indices[i]];
-
-                    occlusion_transition_->Condition(
-                        delta_time,
-                        occlusions_[indices[i_state]][intersect_indices[i]]);
-
-                    float occlusion =
-                        occlusion_transition_->MapStandardGaussian();
-
-                    sensor_->Condition(predictions[i], false);
-                    float p_obsIpred_vis =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        (1.0 - occlusion);
-
-                    sensor_->Condition(predictions[i], true);
-                    float p_obsIpred_occl =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        occlusion;
-
-                    sensor_->Condition(std::numeric_limits<float>::infinity(),
-                                       true);
-                    float p_obsIinf = sensor_->Probability(
-                        observations_[intersect_indices[i]]);
-
-                    log_likes[i_state] +=
-                        log((p_obsIpred_vis + p_obsIpred_occl) / p_obsIinf);
-
-                    // we update the occlusion with the observations
-                    if (update)
-                    {
-                        new_occlusions[i_state][intersect_indices[i]] =
-                            p_obsIpred_occl /
-                            (p_obsIpred_vis + p_obsIpred_occl);
-                        new_occlusion_times[i_state][intersect_indices[i]] =
-                            observation_time_;
-                    }
-                }
+                render_seconds =
+                    std::max(render_seconds, workers_[i_worker].render_seconds);
+                weight_seconds =
+                    std::max(weight_seconds, workers_[i_worker].weight_seconds);
             }
+            this->latency_metrics_->add(LatencyMetrics::RENDERING,
+                                        render_seconds);
+            this->latency_metrics_->add(LatencyMetrics::WEIGHTING,
+                                        weight_seconds);
         }
+
         if (update)
         {
-            occlusions_ = new_occlusions;
-            occlusion_times_ = new_occlusion_times;
+            if (compact_occlusion_store_)
+            {
+                compact_occlusion_store_->end_update();
+            }
+            else
+            {
+                occlusion_store_.end_update();
+            }
             for (size_t i_state = 0; i_state < indices.size(); i_state++)
                 indices[i_state] = i_state;
         }
@@ -229,38 +250,456 @@ public:
         assert(image.rows() == image.size());
         assert(image.cols() == 1);
 
-        std::vector<float> std_measurement(image.size());
+        DepthFrame::Ptr frame = frame_pool_.acquire(image.size(), 1);
+        Eigen::Map<Eigen::VectorXf>(frame->data(), image.size()) =
+            image.col(0).template cast<float>();
+
+        set_depth_frame(frame);
+    }
 
-        for (int i = 0; i < image.size(); ++i)
+    /**
+     * \brief Reads the observations from the frame for as long as it is the
+     *        current observation, without copying it. Frames at an integer
+     *        multiple of the resolution are downsampled first. The time step
+     *        is taken from the frame timestamps if they are known.
+     */
+    void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        observations_ = frame;
+        if (frame->size() != int(n_rows_ * n_cols_))
         {
-            std_measurement[i] = image(i, 0);
+            // frames at a multiple of the resolution, e.g. native frames
+            const int factor = frame->rows() / int(n_rows_);
+            if (factor < 1 || frame->rows() != factor * int(n_rows_) ||
+                frame->cols() != factor * int(n_cols_))
+            {
+                std::cout << "ERROR: depth frame of " << frame->rows() << " x "
+                          << frame->cols() << " pixels for an image of "
+                          << n_rows_ << " x " << n_cols_ << " pixels"
+                          << std::endl;
+                exit(-1);
+            }
+            observations_ = downsampler_.downsample(*frame, factor);
         }
+        list_valid_observations();
+
+        observation_time_ += this->frame_delta_time(*frame);
+    }
+
+    /**
+     * \brief Pooling of the frames which are downsampled to the resolution of
+     *        the sensor
+     */
+    DepthDownsampler::Pooling depth_pooling() const
+    {
+        return downsampler_.pooling();
+    }
+    void depth_pooling(DepthDownsampler::Pooling pooling)
+    {
+        downsampler_.pooling(pooling);
+    }
+
+    /**
+     * \brief Evaluates the particles on the shared pool instead of the
+     *        private one of the constructor, with one renderer copy per
+     *        thread of the pool. Without a pool, the particles are evaluated
+     *        on the calling thread only.
+     */
+    const std::shared_ptr<WorkerPool>& worker_pool() const
+    {
+        return worker_pool_;
+    }
+    void worker_pool(const std::shared_ptr<WorkerPool>& pool)
+    {
+        worker_pool_ = pool;
+        create_workers(pool ? pool->concurrency() : 1);
+    }
 
-        set_observation(std_measurement, this->delta_time_);
+    /**
+     * \brief Stores the occlusions quantized to 16 bits and their times as
+     *        update numbers, see CompactOcclusionEncoding. This takes a
+     *        third of the memory of the exact store. Resets the occlusions.
+     */
+    bool compact_occlusions() const { return bool(compact_occlusion_store_); }
+    void compact_occlusions(bool compact)
+    {
+        if (compact)
+        {
+            compact_occlusion_store_.reset(new CompactOcclusionStore(
+                occlusion_store_.pixel_count(), initial_occlusion_));
+        }
+        else
+        {
+            compact_occlusion_store_.reset();
+        }
+        reset();
     }
 
     virtual void reset()
     {
-        occlusions_.resize(1);
-        occlusions_[0] =
-            std::vector<float>(n_rows_ * n_cols_, initial_occlusion_);
-        occlusion_times_.resize(1);
-        occlusion_times_[0] = std::vector<double>(n_rows_ * n_cols_, 0);
+        occlusion_store_.reset();
+        if (compact_occlusion_store_) compact_occlusion_store_->reset();
         observation_time_ = 0;
+
+        part_layers_.clear();
+        previous_part_layers_.clear();
+        previous_part_layer_lookup_.clear();
     }
 
     // TODO: TYPES
     const std::vector<float> Occlusions(size_t index) const
     {
-        return occlusions_[index];
+        return compact_occlusion_store_
+                   ? compact_occlusion_store_->occlusions(index)
+                   : occlusion_store_.occlusions(index);
     }
 
 private:
-    void set_observation(const std::vector<float>& observations,
-                         const Scalar& delta_time)
+    /**
+     * \brief Per thread models and scratch buffers used by evaluate()
+     */
+    struct Worker
+    {
+        ObjectRendererPtr object_model;
+
+        std::vector<Affine> poses;
+        std::vector<int> intersect_indices;
+        std::vector<float> predictions;
+        std::vector<const dbot::RigidBodyRenderer::DepthLayer*> layers;
+
+        // rendered pixels with a valid observation
+        std::vector<int> pixels;
+        std::vector<float> pixel_predictions;
+        std::vector<float> pixel_observations;
+        std::vector<float> occlusions;
+        std::vector<double> occlusion_times;
+
+        // time spent in the last evaluate() call
+        double render_seconds;
+        double weight_seconds;
+    };
+
+    /**
+     * \brief The first worker uses the renderer passed in, all others get
+     *        private copies since the renderer keeps the poses as mutable
+     *        state
+     */
+    void create_workers(int count)
+    {
+        workers_.resize(count);
+        workers_[0].object_model = object_model_;
+        for (size_t i = 1; i < workers_.size(); ++i)
+        {
+            workers_[i].object_model =
+                std::make_shared<dbot::RigidBodyRenderer>(*object_model_);
+        }
+    }
+
+    /**
+     * \brief Evaluates the particles [begin, end) using the given worker.
+     *
+     * Writes only into the slots [begin, end) of log_likes and of the next
+     * occlusion store generation, such that disjoint ranges may be evaluated
+     * concurrently.
+     */
+    void evaluate(Worker& worker,
+                  const StateArray& deltas,
+                  const IntArray& indices,
+                  const bool update,
+                  const int begin,
+                  const int end,
+                  RealArray& log_likes)
+    {
+        worker.render_seconds = 0;
+        worker.weight_seconds = 0;
+        LatencyMetrics::Clock::time_point stage_start;
+        const LatencyMetrics::Clock::time_point start =
+            LatencyMetrics::Clock::now();
+
+        for (int i_state = begin; i_state < end; i_state++)
+        {
+            // render the object model -----------------------------------------
+            stage_start = LatencyMetrics::Clock::now();
+            int body_count = deltas[i_state].count();
+            worker.poses.resize(body_count);
+            for (size_t i_obj = 0; i_obj < body_count; i_obj++)
+            {
+                worker.poses[i_obj] = delta_columns_.affine(i_state, i_obj);
+            }
+            worker.object_model->set_poses(worker.poses);
+
+            // particles outside of the view are not rendered, they intersect
+            // no pixel and their likelihood ratio is 0
+            if (!worker.object_model->in_view(camera_matrix_, n_rows_, n_cols_))
+            {
+                worker.intersect_indices.clear();
+                worker.predictions.clear();
+                if (body_count > 1)
+                {
+                    for (auto& part_layer : part_layers_[i_state])
+                    {
+                        part_layer.layer.reset();
+                    }
+                }
+            }
+            else if (body_count > 1)
+            {
+                render_part_layers(worker, i_state);
+            }
+            else
+            {
+                worker.object_model->Render(camera_matrix_,
+                                            n_rows_,
+                                            n_cols_,
+                                            worker.intersect_indices,
+                                            worker.predictions);
+            }
+
+            worker.render_seconds += LatencyMetrics::elapsed(stage_start);
+            // the weighting is timed from the end of the rendering on
+            stage_start = LatencyMetrics::Clock::now();
+
+            // select the rendered pixels with a valid observation -------------
+            select_valid_pixels(worker);
+
+            // propagate the occlusions of the parent to the current time ------
+            if (compact_occlusion_store_)
+            {
+                compact_occlusion_store_->gather(indices[i_state],
+                                                 worker.pixels,
+                                                 worker.occlusions,
+                                                 worker.occlusion_times);
+            }
+            else
+            {
+                occlusion_store_.gather(indices[i_state],
+                                        worker.pixels,
+                                        worker.occlusions,
+                                        worker.occlusion_times);
+            }
+            occlusion_transition_->Propagate(worker.occlusions.data(),
+                                             worker.occlusion_times.data(),
+                                             int(worker.pixels.size()),
+                                             observation_time_);
+
+            // compute likelihoods, the occlusions are updated in place --------
+            log_likes[i_state] =
+                sensor_->LogLikelihoodRatio(worker.pixel_predictions.data(),
+                                            worker.pixel_observations.data(),
+                                            worker.occlusions.data(),
+                                            int(worker.pixels.size()));
+
+            // we update the occlusion with the observations
+            if (update && compact_occlusion_store_)
+            {
+                compact_occlusion_store_->write(i_state,
+                                                indices[i_state],
+                                                worker.pixels,
+                                                worker.occlusions,
+                                                observation_time_);
+            }
+            else if (update)
+            {
+                occlusion_store_.write(i_state,
+                                       indices[i_state],
+                                       worker.pixels,
+                                       worker.occlusions,
+                                       observation_time_);
+            }
+            worker.weight_seconds += LatencyMetrics::elapsed(stage_start);
+        }
+
+        if (this->latency_metrics_)
+        {
+            this->latency_metrics_->span("evaluate", start);
+        }
+    }
+
+    /**
+     * \brief Depth layer of one part of a particle and the pose it was
+     *        rendered at
+     */
+    struct PartLayer
+    {
+        Affine pose;
+        std::shared_ptr<const dbot::RigidBodyRenderer::DepthLayer> layer;
+    };
+
+    static size_t hash_pose(const Affine& pose)
+    {
+        size_t seed = 0;
+        for (int i = 0; i < 12; ++i)
+        {
+            seed ^= std::hash<double>()(pose.matrix()(i)) + 0x9e3779b9 +
+                    (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+
+    /**
+     * \brief Moves the part layers of the last loglikes() call to the
+     *        previous generation and indexes them by pose
+     *
+     * The coordinate particle filter perturbs one part per sampling block,
+     * so most part poses of a particle are unchanged since the last call.
+     * Resampling moves particles to other slots, hence the layers are also
+     * looked up by pose.
+     */
+    void prepare_part_layers(int particle_count, int body_count)
     {
-        observations_ = observations;
-        observation_time_ += delta_time;
+        previous_part_layers_.swap(part_layers_);
+        part_layers_.resize(particle_count);
+        for (auto& layers : part_layers_) layers.resize(body_count);
+
+        previous_part_layer_lookup_.resize(body_count);
+        for (int i_obj = 0; i_obj < body_count; i_obj++)
+        {
+            auto& lookup = previous_part_layer_lookup_[i_obj];
+            lookup.clear();
+            for (size_t i_state = 0; i_state < previous_part_layers_.size();
+                 i_state++)
+            {
+                const auto& layers = previous_part_layers_[i_state];
+                if (int(layers.size()) == body_count && layers[i_obj].layer)
+                {
+                    lookup.insert(std::make_pair(
+                        hash_pose(layers[i_obj].pose), int(i_state)));
+                }
+            }
+        }
+    }
+
+    /**
+     * \return Layer of a previous particle part rendered at the given pose,
+     *         or nullptr
+     */
+    const PartLayer* find_part_layer(int i_state,
+                                     int i_obj,
+                                     const Affine& pose) const
+    {
+        if (size_t(i_state) < previous_part_layers_.size() &&
+            size_t(i_obj) < previous_part_layers_[i_state].size())
+        {
+            const PartLayer& cached = previous_part_layers_[i_state][i_obj];
+            if (cached.layer && cached.pose.matrix() == pose.matrix())
+            {
+                return &cached;
+            }
+        }
+
+        if (size_t(i_obj) >= previous_part_layer_lookup_.size()) return nullptr;
+
+        const auto& lookup = previous_part_layer_lookup_[i_obj];
+        auto it = lookup.find(hash_pose(pose));
+        if (it != lookup.end())
+        {
+            const PartLayer& cached = previous_part_layers_[it->second][i_obj];
+            if (cached.pose.matrix() == pose.matrix())
+            {
+                return &cached;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * \brief Marks the pixels of the current observations which are not
+     *        NaN, once per frame, such that evaluate() selects the rendered
+     *        pixels without a branch per pixel
+     */
+    void list_valid_observations()
+    {
+        const float* observations = observations_->data();
+        const int pixel_count = observations_->size();
+
+        valid_observations_.resize(pixel_count);
+        valid_observation_count_ = 0;
+        for (int pixel = 0; pixel < pixel_count; pixel++)
+        {
+            valid_observations_[pixel] = !std::isnan(observations[pixel]);
+            valid_observation_count_ += valid_observations_[pixel];
+        }
+    }
+
+    /**
+     * \brief Copies the rendered pixels of the worker which have a valid
+     *        observation into its pixel buffers
+     */
+    void select_valid_pixels(Worker& worker) const
+    {
+        const size_t count = worker.intersect_indices.size();
+        const float* observations = observations_->data();
+        worker.pixels.resize(count);
+        worker.pixel_predictions.resize(count);
+        worker.pixel_observations.resize(count);
+
+        if (valid_observation_count_ == valid_observations_.size())
+        {
+            std::copy(worker.intersect_indices.begin(),
+                      worker.intersect_indices.end(),
+                      worker.pixels.begin());
+            std::copy(worker.predictions.begin(),
+                      worker.predictions.end(),
+                      worker.pixel_predictions.begin());
+            for (size_t i = 0; i < count; i++)
+            {
+                worker.pixel_observations[i] =
+                    observations[worker.intersect_indices[i]];
+            }
+            return;
+        }
+
+        // every pixel is written, but only valid ones advance the end
+        size_t end = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const int pixel = worker.intersect_indices[i];
+            worker.pixels[end] = pixel;
+            worker.pixel_predictions[end] = worker.predictions[i];
+            worker.pixel_observations[end] = observations[pixel];
+            end += valid_observations_[pixel];
+        }
+        worker.pixels.resize(end);
+        worker.pixel_predictions.resize(end);
+        worker.pixel_observations.resize(end);
+    }
+
+    /**
+     * \brief Renders the worker poses of a particle, which are set in the
+     *        renderer, re-rendering only the parts whose pose changed and
+     *        combining them with the cached layers of the other parts
+     */
+    void render_part_layers(Worker& worker, int i_state)
+    {
+        const int body_count = worker.poses.size();
+
+        worker.layers.resize(body_count);
+        for (int i_obj = 0; i_obj < body_count; i_obj++)
+        {
+            const Affine& pose = worker.poses[i_obj];
+            PartLayer& part_layer = part_layers_[i_state][i_obj];
+            part_layer.pose = pose;
+
+            const PartLayer* cached = find_part_layer(i_state, i_obj, pose);
+            if (cached)
+            {
+                part_layer.layer = cached->layer;
+            }
+            else
+            {
+                auto layer =
+                    std::make_shared<dbot::RigidBodyRenderer::DepthLayer>();
+                worker.object_model->Render(
+                    camera_matrix_, n_rows_, n_cols_, i_obj, *layer);
+                part_layer.layer = layer;
+            }
+
+            worker.layers[i_obj] = part_layer.layer.get();
+        }
+
+        dbot::RigidBodyRenderer::Composite(
+            worker.layers, worker.intersect_indices, worker.predictions);
     }
 
     // TODO: WE PROBABLY DONT NEED ALL OF THIS
@@ -275,12 +714,31 @@ private:
     PixelSensorPtr sensor_;
     OcclusionModelPtr occlusion_transition_;
 
-    // occlusion parameters
-    std::vector<std::vector<float>> occlusions_;
-    std::vector<std::vector<double>> occlusion_times_;
-
-    // observed data
-    std::vector<float> observations_;
+    // occlusion parameters, the compact store replaces the exact one if set
+    OcclusionStore occlusion_store_;
+    std::unique_ptr<CompactOcclusionStore> compact_occlusion_store_;
+
+    // evaluation workers
+    std::vector<Worker> workers_;
+    std::shared_ptr<WorkerPool> worker_pool_;
+
+    // deltas of the current loglikes() call composed with the default poses
+    RigidBodiesStateArray<State> delta_columns_;
+
+    // cached part layers of the current and the last loglikes() call,
+    // indexed by particle and part
+    std::vector<std::vector<PartLayer>> part_layers_;
+    std::vector<std::vector<PartLayer>> previous_part_layers_;
+    std::vector<std::unordered_map<size_t, int>> previous_part_layer_lookup_;
+
+    // observed data, shared with the tracker, and the buffers of the
+    // observations which are converted from an Observation
+    DepthFrame::ConstPtr observations_;
+    // [pixel] = {1 if the current observation of the pixel is not NaN}
+    std::vector<uint8_t> valid_observations_;
+    size_t valid_observation_count_;
+    DepthFramePool frame_pool_;
+    DepthDownsampler downsampler_;
     double observation_time_;
 };
 }
@@ -0,0 +1,114 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <dbot/latency_metrics.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+namespace
+{
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModel<double, State> Model;
+
+/**
+ * \brief Densely tessellated square at a depth of 1 which covers the view,
+ *        such that rendering dominates the evaluation
+ */
+std::shared_ptr<dbot::RigidBodyRenderer> plane_renderer(int segments)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(1);
+    std::vector<std::vector<std::vector<int>>> indices(1);
+    for (int row = 0; row <= segments; row++)
+    {
+        for (int col = 0; col <= segments; col++)
+        {
+            vertices[0].push_back(Eigen::Vector3d(
+                2. * col / segments - 1., 2. * row / segments - 1., 1.));
+        }
+    }
+    for (int row = 0; row < segments; row++)
+    {
+        for (int col = 0; col < segments; col++)
+        {
+            const int i = row * (segments + 1) + col;
+            indices[0].push_back({i, i + 1, i + segments + 2});
+            indices[0].push_back({i, i + segments + 2, i + segments + 1});
+        }
+    }
+    return std::make_shared<dbot::RigidBodyRenderer>(
+        vertices, indices, dbot::RigidBodyRenderer::TILED_RASTERIZATION);
+}
+}
+
+TEST(KinectImageModelTests, render_and_weight_times_do_not_overlap)
+{
+    const int rows = 60;
+    const int cols = 80;
+    Eigen::Matrix3d camera_matrix = Eigen::Matrix3d::Identity();
+    camera_matrix(0, 0) = camera_matrix(1, 1) = 60.;
+    camera_matrix(0, 2) = cols / 2.;
+    camera_matrix(1, 2) = rows / 2.;
+
+    Model model(camera_matrix,
+                rows,
+                cols,
+                plane_renderer(100),
+                std::make_shared<dbot::KinectPixelModel>(0.01, 0.003, 0.0014),
+                std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+                0.1,
+                0.033,
+                1);
+    auto metrics = std::make_shared<dbot::LatencyMetrics>();
+    dbot::LatencyMetrics::StepTimes times;
+    metrics->sink([&times](const dbot::LatencyMetrics::StepTimes& step)
+                  {
+                      times = step;
+                  });
+    model.latency_metrics(metrics);
+    model.set_observation(Model::Observation::Constant(rows * cols, 1, 1.));
+
+    const int particle_count = 8;
+    Model::StateArray deltas(particle_count);
+    for (int i = 0; i < particle_count; i++)
+    {
+        deltas[i] = State(1);
+        deltas[i].setZero();
+    }
+    Model::IntArray indices = Model::IntArray::Zero(particle_count);
+
+    const auto begin = std::chrono::steady_clock::now();
+    const Model::RealArray log_likes = model.loglikes(deltas, indices);
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - begin)
+                               .count();
+    metrics->commit();
+
+    EXPECT_TRUE(std::isfinite(log_likes[0]));
+    const double render = times[dbot::LatencyMetrics::RENDERING];
+    const double weight = times[dbot::LatencyMetrics::WEIGHTING];
+    EXPECT_GT(render, 0);
+    EXPECT_GT(weight, 0);
+    // the stages ran one after the other within the call
+    EXPECT_LE(render + weight, seconds);
+}
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <cmath>
 #include <dbot/traits.h>
 #include <iostream>
@@ -137,7 +138,126 @@ public:
         occlusion_ = occlusion;
     }
 
+    /**
+     * \brief Evaluates all rendered pixels of one particle at once
+     *
+     * Computes for every pixel the log of the ratio between the likelihood of
+     * the observation given the prediction and the prior occlusion
+     * probability, and the likelihood given an infinite prediction. This is
+     * the same quantity the CPU and GPU image models accumulate per pixel.
+     * The computation is carried out in single precision on packets of
+     * pixels using Eigen's vectorized exp and log. erf is replaced by a
+     * rational approximation of erfc with a relative error below 1.2e-7.
+     *
+     * \param predictions   Finite predicted depths
+     * \param observations  Finite observed depths
+     * \param occlusions    Prior occlusion probabilities. These are replaced
+     *                      by the posterior occlusion probabilities.
+     * \param count         Number of pixels
+     *
+     * \return Sum of the log ratios of all pixels
+     */
+    virtual double LogLikelihoodRatio(const float* predictions,
+                                      const float* observations,
+                                      float* occlusions,
+                                      int count) const
+    {
+        typedef Eigen::Array<float, Eigen::Dynamic, 1, 0, batch_size, 1> Batch;
+        typedef Eigen::Map<const Eigen::ArrayXf> ConstMap;
+        typedef Eigen::Map<Eigen::ArrayXf> Map;
+
+        const float tail = float(tail_weight_ / max_depth_);
+        const float one_minus_tail = float(1 - tail_weight_);
+        const float lambda = float(lambda_);
+        const float model_sigma = float(model_sigma_);
+        const float sigma_factor = float(sigma_factor_);
+        const float one_div_sqrt_of_two = float(1. / std::sqrt(2.));
+        const float one_div_sqrt_of_two_pi = float(1. / std::sqrt(2. * M_PI));
+
+        // Chebyshev fit of erfc(z) = t exp(-z^2 + P(t)), t = 1 / (1 + z / 2)
+        static const int erfc_coefficient_count = 10;
+        static const float erfc_coefficients[erfc_coefficient_count] = {
+            0.17087277f,
+            -0.82215223f,
+            1.48851587f,
+            -1.13520398f,
+            0.27886807f,
+            -0.18628806f,
+            0.09678418f,
+            0.37409196f,
+            1.00002368f,
+            -1.26551223f};
+
+        // lower bound of the exponents to avoid slow denormal arithmetic. The
+        // clamped terms are negligible compared to the tail weight.
+        const float min_exponent = -80.f;
+
+        double log_ratio = 0;
+        for (int begin = 0; begin < count; begin += batch_size)
+        {
+            const int n = std::min(int(batch_size), count - begin);
+            ConstMap prediction(predictions + begin, n);
+            ConstMap observation(observations + begin, n);
+            Map occlusion(occlusions + begin, n);
+
+            Batch sigma = model_sigma + sigma_factor * observation.square();
+            Batch inv_sigma = sigma.inverse();
+            Batch lambda_sigma_sq = lambda * sigma.square();
+            Batch pred_minus_obs = prediction - observation;
+
+            // observation given the visible prediction
+            Batch p_obsIpred_vis =
+                tail +
+                (one_minus_tail * one_div_sqrt_of_two_pi) * inv_sigma *
+                    (-0.5f * (pred_minus_obs * inv_sigma).square())
+                    .max(min_exponent)
+                    .exp();
+
+            // observation given an infinite prediction
+            Batch exp_inf =
+                (0.5f * lambda * (lambda_sigma_sq - 2.f * observation)).exp();
+            Batch p_obsIinf = tail + (one_minus_tail * lambda) * exp_inf;
+
+            // observation given the occluded prediction. We use
+            // 1 + erf(u) = erfc(-u) which is approximated for |u| and
+            // mirrored, avoiding the cancellation for negative u
+            Batch u = (pred_minus_obs + lambda_sigma_sq) *
+                      (one_div_sqrt_of_two * inv_sigma);
+            Batch z = u.abs();
+            Batch t = (1.f + 0.5f * z).inverse();
+            Batch erfc_z = Batch::Constant(n, erfc_coefficients[0]);
+            for (int i = 1; i < erfc_coefficient_count; ++i)
+            {
+                erfc_z = erfc_z * t + erfc_coefficients[i];
+            }
+            erfc_z = t * (erfc_z - z.square()).max(min_exponent).exp();
+            Batch one_plus_erf = (u < 0.f).select(erfc_z, 2.f - erfc_z);
+            Batch p_obsIpred_occl =
+                tail +
+                (0.5f * one_minus_tail * lambda) * exp_inf * one_plus_erf /
+                    (1.f - (-lambda * prediction).exp());
+
+            p_obsIpred_vis *= 1.f - occlusion;
+            p_obsIpred_occl *= occlusion;
+
+            Batch p_obsIpred = p_obsIpred_vis + p_obsIpred_occl;
+
+            log_ratio += (p_obsIpred / p_obsIinf).log().sum();
+            occlusion = p_obsIpred_occl / p_obsIpred;
+        }
+
+        return log_ratio;
+    }
+
 private:
+    /**
+     * Number of pixels processed per packet in LogLikelihoodRatio()
+     */
+    enum : int
+    {
+        batch_size = 64
+    };
+
     const Scalar lambda_, tail_weight_, model_sigma_, sigma_factor_, max_depth_;
 
     Scalar prediction_;
@@ -0,0 +1,68 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_pixel_model_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/model/kinect_pixel_model.h>
+#include <limits>
+#include <vector>
+
+TEST(KinectPixelModelTests, batch_matches_pixelwise_evaluation)
+{
+    dbot::KinectPixelModel model(0.01, 0.003, 0.00142478);
+
+    std::vector<float> predictions;
+    std::vector<float> observations;
+    std::vector<float> occlusions;
+    for (int i = 0; i < 203; ++i)
+    {
+        predictions.push_back(0.4f + 0.01f * i);
+        observations.push_back(predictions.back() + 0.002f * (i % 41 - 20));
+        occlusions.push_back(0.0049f * i);
+    }
+
+    double expected_log_ratio = 0;
+    std::vector<float> expected_occlusions(occlusions.size());
+    for (size_t i = 0; i < predictions.size(); ++i)
+    {
+        model.Condition(predictions[i], false);
+        double p_obsIpred_vis =
+            model.Probability(observations[i]) * (1.0 - occlusions[i]);
+        model.Condition(predictions[i], true);
+        double p_obsIpred_occl =
+            model.Probability(observations[i]) * occlusions[i];
+        model.Condition(std::numeric_limits<double>::infinity(), true);
+        double p_obsIinf = model.Probability(observations[i]);
+
+        expected_log_ratio +=
+            std::log((p_obsIpred_vis + p_obsIpred_occl) / p_obsIinf);
+        expected_occlusions[i] =
+            p_obsIpred_occl / (p_obsIpred_vis + p_obsIpred_occl);
+    }
+
+    double log_ratio = model.LogLikelihoodRatio(predictions.data(),
+                                                observations.data(),
+                                                occlusions.data(),
+                                                int(predictions.size()));
+
+    EXPECT_NEAR(log_ratio, expected_log_ratio, 1e-6 * predictions.size());
+    for (size_t i = 0; i < occlusions.size(); ++i)
+    {
+        EXPECT_NEAR(occlusions[i], expected_occlusions[i], 1e-5);
+    }
+}
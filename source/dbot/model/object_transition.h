@@ -0,0 +1,132 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file object_transition.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <iostream>
+
+#include <Eigen/Dense>
+
+#include <dbot/model/batch_transition.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+#include <fl/model/transition/interface/transition_function.hpp>
+
+namespace dbot
+{
+/**
+ * \brief Damped constant velocity transition of independent rigid bodies
+ *
+ * The state of each part consists of its pose and its velocity, 12 values,
+ * and each part is driven by 6 noise dimensions. The velocity is damped by
+ * the velocity factor and perturbed by the scaled noise, the pose is then
+ * moved on by the new velocity,
+ *
+ *     v' = velocity_factor v + sigma n
+ *     x' = x + v'
+ *
+ * which is the linear model ObjectTransitionBuilder::build_model() assembles
+ * as dense matrices. Here each part is updated in place at a cost linear in
+ * the part count, either per particle or for the whole population.
+ */
+template <typename State_>
+class ObjectTransition
+    : public fl::TransitionFunction<State_,
+                                    typename ObjectStateTrait<State_>::Noise,
+                                    typename ObjectStateTrait<State_>::Input>,
+      public BatchTransition<State_,
+                             typename ObjectStateTrait<State_>::Noise,
+                             typename ObjectStateTrait<State_>::Input>
+{
+public:
+    typedef State_ State;
+    typedef typename ObjectStateTrait<State>::Noise Noise;
+    typedef typename ObjectStateTrait<State>::Input Input;
+    typedef typename BatchTransition<State, Noise, Input>::Matrix Matrix;
+    typedef Eigen::Matrix<typename State::Scalar, 6, 1> Sigma;
+
+public:
+    /**
+     * \param sigma  noise scale of the linear and the angular velocity of
+     *               every part
+     */
+    ObjectTransition(int part_count, const Sigma& sigma, double velocity_factor)
+        : part_count_(part_count),
+          sigma_(sigma),
+          velocity_factor_(velocity_factor)
+    {
+        if (State::SizeAtCompileTime != Eigen::Dynamic &&
+            State::SizeAtCompileTime != 12 * part_count)
+        {
+            std::cout << "ERROR: transition of " << part_count
+                      << " parts for a state of dimension "
+                      << State::SizeAtCompileTime << std::endl;
+            exit(-1);
+        }
+    }
+
+    State state(const State& prev_state,
+                const Noise& noise,
+                const Input& input) const override
+    {
+        State next = prev_state;
+        for (int i = 0; i < part_count_; i++)
+        {
+            auto pose = next.template segment<6>(12 * i);
+            auto velocity = next.template segment<6>(12 * i + 6);
+
+            velocity = velocity_factor_ * velocity +
+                       sigma_.cwiseProduct(noise.template segment<6>(6 * i));
+            pose += velocity;
+        }
+        return next;
+    }
+
+    /**
+     * \brief Applies the transition to all particles with column operations
+     *        per part
+     */
+    void states(const Matrix& prev_states,
+                const Matrix& noises,
+                const Input& input,
+                Matrix& states) const override
+    {
+        states = prev_states;
+        for (int i = 0; i < part_count_; i++)
+        {
+            auto pose = states.middleCols(12 * i, 6);
+            auto velocity = states.middleCols(12 * i + 6, 6);
+
+            velocity = velocity_factor_ * velocity +
+                       noises.middleCols(6 * i, 6) * sigma_.asDiagonal();
+            pose += velocity;
+        }
+    }
+
+    int state_dimension() const override { return 12 * part_count_; }
+    int noise_dimension() const override { return 6 * part_count_; }
+    int input_dimension() const override { return 1; }
+    int part_count() const { return part_count_; }
+    const Sigma& sigma() const { return sigma_; }
+    double velocity_factor() const { return velocity_factor_; }
+
+private:
+    int part_count_;
+    Sigma sigma_;
+    double velocity_factor_;
+};
+}
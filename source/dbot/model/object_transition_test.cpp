@@ -0,0 +1,108 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file object_transition_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/model/object_transition.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::ObjectTransition<State> Transition;
+
+TEST(ObjectTransitionTests, matches_the_dense_linear_model)
+{
+    const int part_count = 3;
+    const double velocity_factor = 0.8;
+    Transition::Sigma sigma;
+    sigma << 0.1, 0.2, 0.3, 0.4, 0.5, 0.6;
+    Transition transition(part_count, sigma, velocity_factor);
+
+    EXPECT_EQ(36, transition.state_dimension());
+    EXPECT_EQ(18, transition.noise_dimension());
+
+    // dense matrices as assembled by ObjectTransitionBuilder::build_model()
+    Eigen::Matrix<double, 12, 12> part_A;
+    part_A.setIdentity();
+    part_A.topRightCorner(6, 6).setIdentity();
+    part_A.rightCols(6) *= velocity_factor;
+    Eigen::Matrix<double, 12, 6> part_B;
+    part_B.setZero();
+    part_B.topRows(6) = sigma.asDiagonal();
+    part_B.bottomRows(6) = part_B.topRows(6);
+
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(36, 36);
+    Eigen::MatrixXd B = Eigen::MatrixXd::Zero(36, 18);
+    for (int i = 0; i < part_count; i++)
+    {
+        A.block(i * 12, i * 12, 12, 12) = part_A;
+        B.block(i * 12, i * 6, 12, 6) = part_B;
+    }
+
+    State prev_state(part_count);
+    prev_state.setRandom();
+    Transition::Noise noise = Transition::Noise::Random(18);
+    Transition::Input input = Transition::Input::Zero(1);
+
+    const Eigen::VectorXd expected = A * prev_state + B * noise;
+    const State state = transition.state(prev_state, noise, input);
+
+    EXPECT_TRUE(state.isApprox(expected, 1e-12));
+}
+
+TEST(ObjectTransitionTests, keeps_a_resting_state_without_noise)
+{
+    Transition::Sigma sigma = Transition::Sigma::Constant(0.1);
+    Transition transition(2, sigma, 0.5);
+
+    State prev_state(2);
+    prev_state.setZero();
+    prev_state.component(1).position() = Eigen::Vector3d(1, 2, 3);
+
+    const State state = transition.state(
+        prev_state, Transition::Noise::Zero(12), Transition::Input::Zero(1));
+
+    EXPECT_TRUE(state.isApprox(prev_state));
+}
+
+TEST(ObjectTransitionTests, batch_matches_the_per_particle_transition)
+{
+    const int part_count = 2;
+    const int sample_count = 5;
+    Transition::Sigma sigma;
+    sigma << 0.1, 0.2, 0.3, 0.4, 0.5, 0.6;
+    Transition transition(part_count, sigma, 0.7);
+
+    Transition::Matrix prev_states =
+        Transition::Matrix::Random(sample_count, 24);
+    Transition::Matrix noises = Transition::Matrix::Random(sample_count, 12);
+    Transition::Input input = Transition::Input::Zero(1);
+
+    Transition::Matrix states;
+    transition.states(prev_states, noises, input, states);
+    ASSERT_EQ(sample_count, states.rows());
+    ASSERT_EQ(24, states.cols());
+
+    for (int i = 0; i < sample_count; i++)
+    {
+        State prev_state(part_count);
+        prev_state = prev_states.row(i).transpose();
+        const Transition::Noise noise = noises.row(i).transpose();
+
+        const State state = transition.state(prev_state, noise, input);
+        EXPECT_TRUE(state.isApprox(states.row(i).transpose(), 1e-12));
+    }
+}
@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+
 // TODO: THIS IS JUST A LINEAR GAUSSIAN PROCESS WITH NO NOISE, SHOULD DISAPPEAR
 namespace dbot
 {
@@ -85,6 +88,55 @@ public:
         return new_occlusion_probability;
     }
 
+    /**
+     * \brief Propagates a batch of occlusion probabilities to the time now
+     *
+     * The occlusion probability of each pixel i is propagated over the time
+     * now - times[i]. The process is affine in the probability, and the
+     * coefficients are computed once for each run of equal times, which
+     * covers most of the pixels of an image since they were updated in the
+     * same frame. Rounding errors are clamped to [0, 1].
+     *
+     * \param occlusions  Occlusion probabilities, propagated in place
+     * \param times       Times at which the probabilities are valid
+     * \param count       Number of pixels
+     * \param now         Time to propagate to
+     */
+    virtual void Propagate(float* occlusions,
+                           const double* times,
+                           int count,
+                           double now) const
+    {
+        int begin = 0;
+        while (begin < count)
+        {
+            int end = begin + 1;
+            while (end < count && times[end] == times[begin]) ++end;
+
+            // p' = 1 - (c^dt (1 - p) + (1 - p_oo) (c^dt - 1) / (c - 1))
+            //    = scale * p + offset
+            float scale = 1;
+            float offset = 0;
+            if (std::fabs(c_ - 1.0) >= 0.000000001)
+            {
+                const double pow_c_time =
+                    std::exp((now - times[begin]) * log_c_);
+                scale = pow_c_time;
+                offset = 1. - pow_c_time -
+                         (1 - p_occluded_occluded_) * (pow_c_time - 1.) /
+                             (c_ - 1.);
+            }
+
+            for (int i = begin; i < end; ++i)
+            {
+                const float occlusion = scale * occlusions[i] + offset;
+                occlusions[i] = std::min(1.f, std::max(0.f, occlusion));
+            }
+
+            begin = end;
+        }
+    }
+
 private:
     // conditionals
     double occlusion_probability_, delta_time_;
@@ -0,0 +1,455 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_store.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Occlusions and times of the OcclusionStore as they are passed in
+ */
+class ExactOcclusionEncoding
+{
+public:
+    typedef float Occlusion;
+    typedef double Time;
+
+    static Occlusion encode_occlusion(float occlusion) { return occlusion; }
+    static float decode_occlusion(Occlusion occlusion) { return occlusion; }
+    void reset() {}
+    Time encode_time(double time) const { return time; }
+    double decode_time(Time time) const { return time; }
+    bool advance(double time) { return false; }
+    Time rebase(Time time) const { return time; }
+};
+
+/**
+ * \brief Occlusions quantized to 16 bits and times stored as the number of
+ *        the update they were written in, 4 instead of 12 bytes per pixel
+ *
+ * The update numbers wrap around, the times of the last 65536 updates are
+ * kept in a table. Every 32768 updates older times are moved up to the
+ * oldest representable update. By then the occlusion process has long
+ * converged, such that the propagated occlusions are unaffected.
+ */
+class CompactOcclusionEncoding
+{
+public:
+    typedef uint16_t Occlusion;
+    typedef uint16_t Time;
+
+    static Occlusion encode_occlusion(float occlusion)
+    {
+        return Occlusion(
+            std::min(std::max(occlusion, 0.f), 1.f) * max_occlusion + 0.5f);
+    }
+    static float decode_occlusion(Occlusion occlusion)
+    {
+        return occlusion * (1.f / max_occlusion);
+    }
+
+    CompactOcclusionEncoding() : frame_times_(65536) { reset(); }
+    void reset()
+    {
+        frame_ = 0;
+        frame_times_[frame_] = 0;
+    }
+
+    /**
+     * \brief Update number of the given time, which is the current or the
+     *        next one to be registered by advance()
+     */
+    Time encode_time(double time) const
+    {
+        return time == frame_times_[frame_] ? frame_ : Time(frame_ + 1);
+    }
+    double decode_time(Time time) const { return frame_times_[time]; }
+    /**
+     * \brief Registers the time of an update
+     *
+     * \return whether the stored times have to be rebased
+     */
+    bool advance(double time)
+    {
+        if (time == frame_times_[frame_]) return false;
+        frame_++;
+        frame_times_[frame_] = time;
+        return frame_ % rebase_interval == 0;
+    }
+    Time rebase(Time time) const
+    {
+        return Time(frame_ - time) < rebase_interval
+                   ? time
+                   : Time(frame_ - rebase_interval + 1);
+    }
+
+private:
+    static constexpr float max_occlusion = 65535.f;
+    static constexpr Time rebase_interval = 32768;
+
+    Time frame_;
+    std::vector<double> frame_times_;
+};
+
+/**
+ * \brief Copy-on-write storage of the per particle occlusion images
+ *
+ * Each particle slot references a shared base image and holds a sparse layer
+ * of the pixels which have been written since the base image was created.
+ * Resampling shares the base image of the parent and copies only the written
+ * layer, such that an update costs memory proportional to the pixels the
+ * object projects onto instead of the full image. Once a layer grows beyond a
+ * fraction of the image it is folded into a new pooled base image.
+ *
+ * An update is performed in three steps: begin_update(), one write() per
+ * child slot, end_update(). Calls of write() for distinct children may run
+ * concurrently. gather() may run concurrently with everything but
+ * end_update().
+ *
+ * The Encoding determines how the occlusions and times are stored, they are
+ * converted in gather() and write().
+ */
+template <typename Encoding>
+class BasicOcclusionStore
+{
+public:
+    typedef typename Encoding::Occlusion Occlusion;
+    typedef typename Encoding::Time Time;
+
+public:
+    BasicOcclusionStore(size_t pixel_count, float initial_occlusion)
+        : pixel_count_(pixel_count), initial_occlusion_(initial_occlusion)
+    {
+        reset();
+    }
+
+    /**
+     * \brief Resets the store to a single slot with the initial occlusion
+     */
+    void reset()
+    {
+        for (size_t i = 0; i < ref_counts_.size(); ++i)
+        {
+            if (ref_counts_[i] > 0)
+            {
+                ref_counts_[i] = 0;
+                free_bases_.push_back(int(i));
+            }
+        }
+
+        encoding_.reset();
+        const int base = acquire_base();
+        std::fill(base_occlusions_[base].begin(),
+                  base_occlusions_[base].end(),
+                  Encoding::encode_occlusion(initial_occlusion_));
+        std::fill(base_times_[base].begin(),
+                  base_times_[base].end(),
+                  encoding_.encode_time(0.));
+        ref_counts_[base] = 1;
+
+        slots_.resize(1);
+        slots_[0].base = base;
+        slots_[0].clear();
+    }
+
+    size_t slot_count() const { return slots_.size(); }
+    size_t pixel_count() const { return pixel_count_; }
+    /**
+     * \brief Reads the occlusions and their times of the given pixels
+     *
+     * \param pixels  Pixel indices in ascending order
+     */
+    void gather(int slot,
+                const std::vector<int>& pixels,
+                std::vector<float>& occlusions,
+                std::vector<double>& times) const
+    {
+        const Layer& layer = slots_[slot];
+        const std::vector<Occlusion>& base_occlusions =
+            base_occlusions_[layer.base];
+        const std::vector<Time>& base_times = base_times_[layer.base];
+
+        occlusions.resize(pixels.size());
+        times.resize(pixels.size());
+
+        size_t j = 0;
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            assert(i == 0 || pixels[i - 1] < pixels[i]);
+
+            while (j < layer.pixels.size() && layer.pixels[j] < pixels[i]) ++j;
+
+            if (j < layer.pixels.size() && layer.pixels[j] == pixels[i])
+            {
+                occlusions[i] =
+                    Encoding::decode_occlusion(layer.occlusions[j]);
+                times[i] = encoding_.decode_time(layer.times[j]);
+            }
+            else
+            {
+                occlusions[i] =
+                    Encoding::decode_occlusion(base_occlusions[pixels[i]]);
+                times[i] = encoding_.decode_time(base_times[pixels[i]]);
+            }
+        }
+    }
+
+    /**
+     * \brief Starts a new generation of child_count slots
+     */
+    void begin_update(size_t child_count)
+    {
+        new_slots_.resize(child_count);
+        write_times_.resize(child_count);
+    }
+    /**
+     * \brief Sets the child slot to the parent slot with the given pixels
+     *        overwritten
+     *
+     * Must be called once for every child between begin_update() and
+     * end_update(), with the same time for all children.
+     *
+     * \param pixels      Written pixel indices in ascending order
+     * \param occlusions  New occlusion of each written pixel
+     * \param time        Time of the written occlusions
+     */
+    void write(int child,
+               int parent,
+               const std::vector<int>& pixels,
+               const std::vector<float>& occlusions,
+               double time)
+    {
+        assert(pixels.size() == occlusions.size());
+
+        const Layer& source = slots_[parent];
+        Layer& target = new_slots_[child];
+        const Time written_time = encoding_.encode_time(time);
+        write_times_[child] = time;
+
+        target.base = source.base;
+        target.clear();
+
+        // merge the parent layer with the written pixels
+        size_t i = 0;
+        size_t j = 0;
+        while (i < source.pixels.size() || j < pixels.size())
+        {
+            if (j == pixels.size() ||
+                (i < source.pixels.size() && source.pixels[i] < pixels[j]))
+            {
+                target.push_back(
+                    source.pixels[i], source.occlusions[i], source.times[i]);
+                ++i;
+            }
+            else
+            {
+                if (i < source.pixels.size() && source.pixels[i] == pixels[j])
+                {
+                    ++i;
+                }
+                target.push_back(pixels[j],
+                                 Encoding::encode_occlusion(occlusions[j]),
+                                 written_time);
+                ++j;
+            }
+        }
+    }
+
+    /**
+     * \brief Replaces the current generation of slots by the written one
+     */
+    void end_update()
+    {
+        for (size_t i = 0; i < new_slots_.size(); ++i)
+        {
+            Layer& layer = new_slots_[i];
+
+            if (layer.pixels.size() > pixel_count_ / compaction_fraction)
+            {
+                const int base = acquire_base();
+                base_occlusions_[base] = base_occlusions_[layer.base];
+                base_times_[base] = base_times_[layer.base];
+                for (size_t j = 0; j < layer.pixels.size(); ++j)
+                {
+                    base_occlusions_[base][layer.pixels[j]] =
+                        layer.occlusions[j];
+                    base_times_[base][layer.pixels[j]] = layer.times[j];
+                }
+                layer.base = base;
+                layer.clear();
+            }
+
+            ref_counts_[layer.base]++;
+        }
+
+        for (size_t i = 0; i < slots_.size(); ++i)
+        {
+            release_base(slots_[i].base);
+        }
+
+        slots_.swap(new_slots_);
+
+        if (!write_times_.empty() && encoding_.advance(write_times_[0]))
+        {
+            rebase_times();
+        }
+    }
+
+    /**
+     * \return Full occlusion image of the given slot
+     */
+    std::vector<float> occlusions(int slot) const
+    {
+        const Layer& layer = slots_[slot];
+        const std::vector<Occlusion>& base = base_occlusions_[layer.base];
+        std::vector<float> image(pixel_count_);
+        for (size_t i = 0; i < pixel_count_; ++i)
+        {
+            image[i] = Encoding::decode_occlusion(base[i]);
+        }
+        for (size_t j = 0; j < layer.pixels.size(); ++j)
+        {
+            image[layer.pixels[j]] =
+                Encoding::decode_occlusion(layer.occlusions[j]);
+        }
+        return image;
+    }
+
+    /**
+     * \return Full occlusion time image of the given slot
+     */
+    std::vector<double> times(int slot) const
+    {
+        const Layer& layer = slots_[slot];
+        const std::vector<Time>& base = base_times_[layer.base];
+        std::vector<double> image(pixel_count_);
+        for (size_t i = 0; i < pixel_count_; ++i)
+        {
+            image[i] = encoding_.decode_time(base[i]);
+        }
+        for (size_t j = 0; j < layer.pixels.size(); ++j)
+        {
+            image[layer.pixels[j]] = encoding_.decode_time(layer.times[j]);
+        }
+        return image;
+    }
+
+    /**
+     * \return Number of base images currently referenced
+     */
+    size_t base_count() const
+    {
+        return base_occlusions_.size() - free_bases_.size();
+    }
+
+private:
+    /**
+     * \brief Sparse set of written pixels on top of a base image, sorted by
+     *        pixel index
+     */
+    struct Layer
+    {
+        int base;
+        std::vector<int> pixels;
+        std::vector<Occlusion> occlusions;
+        std::vector<Time> times;
+
+        void clear()
+        {
+            pixels.clear();
+            occlusions.clear();
+            times.clear();
+        }
+
+        void push_back(int pixel, Occlusion occlusion, Time time)
+        {
+            pixels.push_back(pixel);
+            occlusions.push_back(occlusion);
+            times.push_back(time);
+        }
+    };
+
+    int acquire_base()
+    {
+        if (!free_bases_.empty())
+        {
+            const int base = free_bases_.back();
+            free_bases_.pop_back();
+            return base;
+        }
+
+        base_occlusions_.push_back(std::vector<Occlusion>(pixel_count_));
+        base_times_.push_back(std::vector<Time>(pixel_count_));
+        ref_counts_.push_back(0);
+        return int(ref_counts_.size()) - 1;
+    }
+
+    void release_base(int base)
+    {
+        assert(ref_counts_[base] > 0);
+
+        if (--ref_counts_[base] == 0)
+        {
+            free_bases_.push_back(base);
+        }
+    }
+
+    void rebase_times()
+    {
+        for (auto& times : base_times_)
+        {
+            for (auto& time : times) time = encoding_.rebase(time);
+        }
+        for (auto& layer : slots_)
+        {
+            for (auto& time : layer.times) time = encoding_.rebase(time);
+        }
+    }
+
+    /**
+     * Layers holding more than 1/compaction_fraction of the image are folded
+     * into a new base image
+     */
+    static constexpr size_t compaction_fraction = 8;
+
+    const size_t pixel_count_;
+    const float initial_occlusion_;
+    Encoding encoding_;
+
+    // pooled base images
+    std::vector<std::vector<Occlusion>> base_occlusions_;
+    std::vector<std::vector<Time>> base_times_;
+    std::vector<int> ref_counts_;
+    std::vector<int> free_bases_;
+
+    // current and next generation of particle slots, and the times the
+    // next generation was written at
+    std::vector<Layer> slots_;
+    std::vector<Layer> new_slots_;
+    std::vector<double> write_times_;
+};
+
+typedef BasicOcclusionStore<ExactOcclusionEncoding> OcclusionStore;
+typedef BasicOcclusionStore<CompactOcclusionEncoding> CompactOcclusionStore;
+}
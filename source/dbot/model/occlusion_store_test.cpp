@@ -0,0 +1,171 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_store_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/model/occlusion_store.h>
+
+TEST(OcclusionStoreTests, initial_state)
+{
+    dbot::OcclusionStore store(16, 0.1f);
+
+    EXPECT_EQ(store.slot_count(), 1);
+    EXPECT_EQ(store.base_count(), 1);
+
+    std::vector<float> occlusions;
+    std::vector<double> times;
+    store.gather(0, {0, 5, 15}, occlusions, times);
+
+    ASSERT_EQ(occlusions.size(), 3);
+    for (size_t i = 0; i < occlusions.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(occlusions[i], 0.1f);
+        EXPECT_DOUBLE_EQ(times[i], 0.);
+    }
+}
+
+TEST(OcclusionStoreTests, children_share_parent)
+{
+    dbot::OcclusionStore store(16, 0.1f);
+
+    store.begin_update(2);
+    store.write(0, 0, {2, 3}, {0.5f, 0.6f}, 1.);
+    store.write(1, 0, {3, 4}, {0.7f, 0.8f}, 1.);
+    store.end_update();
+
+    EXPECT_EQ(store.slot_count(), 2);
+    EXPECT_EQ(store.base_count(), 1);
+
+    std::vector<float> occlusions;
+    std::vector<double> times;
+
+    store.gather(0, {2, 3, 4}, occlusions, times);
+    EXPECT_FLOAT_EQ(occlusions[0], 0.5f);
+    EXPECT_FLOAT_EQ(occlusions[1], 0.6f);
+    EXPECT_FLOAT_EQ(occlusions[2], 0.1f);
+    EXPECT_DOUBLE_EQ(times[0], 1.);
+    EXPECT_DOUBLE_EQ(times[2], 0.);
+
+    store.gather(1, {2, 3, 4}, occlusions, times);
+    EXPECT_FLOAT_EQ(occlusions[0], 0.1f);
+    EXPECT_FLOAT_EQ(occlusions[1], 0.7f);
+    EXPECT_FLOAT_EQ(occlusions[2], 0.8f);
+
+    // resample both children from the second slot
+    store.begin_update(2);
+    store.write(0, 1, {}, {}, 2.);
+    store.write(1, 1, {0}, {0.9f}, 2.);
+    store.end_update();
+
+    std::vector<float> image = store.occlusions(1);
+    ASSERT_EQ(image.size(), 16);
+    EXPECT_FLOAT_EQ(image[0], 0.9f);
+    EXPECT_FLOAT_EQ(image[2], 0.1f);
+    EXPECT_FLOAT_EQ(image[3], 0.7f);
+    EXPECT_FLOAT_EQ(image[4], 0.8f);
+    EXPECT_DOUBLE_EQ(store.times(1)[0], 2.);
+    EXPECT_DOUBLE_EQ(store.times(1)[3], 1.);
+    EXPECT_FLOAT_EQ(store.occlusions(0)[0], 0.1f);
+}
+
+TEST(OcclusionStoreTests, large_layers_are_compacted)
+{
+    dbot::OcclusionStore store(16, 0.1f);
+
+    store.begin_update(2);
+    store.write(0, 0, {0, 1, 2, 3, 4, 5}, {1, 1, 1, 1, 1, 1}, 1.);
+    store.write(1, 0, {6}, {0.5f}, 1.);
+    store.end_update();
+
+    EXPECT_EQ(store.base_count(), 2);
+
+    std::vector<float> image = store.occlusions(0);
+    for (size_t i = 0; i < 6; ++i) EXPECT_FLOAT_EQ(image[i], 1.f);
+    EXPECT_FLOAT_EQ(image[6], 0.1f);
+    EXPECT_FLOAT_EQ(store.occlusions(1)[6], 0.5f);
+
+    // drop the first lineage, its base image is released
+    store.begin_update(1);
+    store.write(0, 1, {}, {}, 2.);
+    store.end_update();
+
+    EXPECT_EQ(store.base_count(), 1);
+
+    store.reset();
+    EXPECT_EQ(store.slot_count(), 1);
+    EXPECT_EQ(store.base_count(), 1);
+    EXPECT_FLOAT_EQ(store.occlusions(0)[6], 0.1f);
+}
+
+TEST(OcclusionStoreTests, compact_store_quantizes_the_occlusions)
+{
+    dbot::CompactOcclusionStore store(16, 0.1f);
+
+    store.begin_update(2);
+    store.write(0, 0, {2, 3}, {0.5f, 0.6f}, 0.5);
+    store.write(1, 0, {3}, {1.5f}, 0.5);
+    store.end_update();
+
+    std::vector<float> occlusions;
+    std::vector<double> times;
+    store.gather(0, {2, 3, 4}, occlusions, times);
+    EXPECT_NEAR(occlusions[0], 0.5f, 1e-5);
+    EXPECT_NEAR(occlusions[1], 0.6f, 1e-5);
+    EXPECT_NEAR(occlusions[2], 0.1f, 1e-5);
+    EXPECT_DOUBLE_EQ(times[0], 0.5);
+    EXPECT_DOUBLE_EQ(times[2], 0.);
+
+    // clamped to a probability
+    EXPECT_FLOAT_EQ(store.occlusions(1)[3], 1.f);
+
+    // updates at the same time are numbered alike
+    store.begin_update(1);
+    store.write(0, 1, {5}, {0.2f}, 0.5);
+    store.end_update();
+    EXPECT_DOUBLE_EQ(store.times(0)[5], 0.5);
+    EXPECT_DOUBLE_EQ(store.times(0)[3], 0.5);
+}
+
+TEST(OcclusionStoreTests, compact_store_keeps_times_across_wrap_around)
+{
+    dbot::CompactOcclusionStore store(16, 0.1f);
+
+    store.begin_update(1);
+    store.write(0, 0, {1}, {0.5f}, 1.);
+    store.end_update();
+
+    for (int update = 2; update <= 70000; ++update)
+    {
+        store.begin_update(1);
+        store.write(0, 0, {2}, {0.5f}, double(update));
+        store.end_update();
+
+        if (update == 30000)
+        {
+            EXPECT_DOUBLE_EQ(store.times(0)[1], 1.);
+        }
+    }
+
+    std::vector<double> times = store.times(0);
+    EXPECT_DOUBLE_EQ(times[2], 70000.);
+
+    // old times are moved up, but stay far in the past
+    EXPECT_LT(times[1], 70000. - 32000.);
+    EXPECT_GT(times[0], 0.);
+    EXPECT_LT(times[0], 70000. - 32000.);
+}
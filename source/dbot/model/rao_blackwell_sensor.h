@@ -28,9 +28,16 @@
 
 #pragma once
 
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include <Eigen/Core>
 
 #include <fl/util/types.hpp>
+#include <dbot/depth_frame.h>
+#include <dbot/latency_metrics.h>
 #include <dbot/pose/pose_vector.h>
 #include <dbot/pose/pose_velocity_vector.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
@@ -57,7 +64,10 @@ public:
 
 public:
     /// constructor and destructor *********************************************
-    RbSensor(const fl::Real& delta_time) : delta_time_(delta_time) {}
+    RbSensor(const fl::Real& delta_time)
+        : delta_time_(delta_time), last_frame_timestamp_(0)
+    {
+    }
     virtual ~RbSensor() noexcept {}
     /// likelihood computation *************************************************
     virtual RealArray loglikes(const StateArray& deviations,
@@ -72,13 +82,89 @@ public:
         return loglikes(deviations, zero_indices, false);
     }
 
+    /**
+     * \brief Log likelihoods of the deviations at a coarser resolution which
+     *        screen the particles before loglikes(), see CoarseToFineSensor.
+     *        The coarse level does not keep track of the occlusions.
+     *
+     * \return false if the sensor has no coarse level
+     */
+    virtual bool coarse_loglikes(const StateArray& deviations,
+                                 RealArray& loglikes)
+    {
+        return false;
+    }
+
     /// accessors **************************************************************
     virtual void set_observation(const Observation& image) = 0;
+
+    /**
+     * \brief Sets the observation to a depth frame. Sensors which read single
+     *        precision depth keep a reference to the frame instead of copying
+     *        it, by default it is converted to an Observation.
+     */
+    virtual void set_depth_frame(const DepthFrame::ConstPtr& frame)
+    {
+        Observation image = frame->vector().template cast<fl::Real>();
+        set_observation(image);
+    }
+
+    /**
+     * \brief Sets one depth frame per camera view. Sensors which observe the
+     *        object from a single camera accept exactly one frame.
+     */
+    virtual void set_depth_frames(
+        const std::vector<DepthFrame::ConstPtr>& frames)
+    {
+        if (frames.size() != 1)
+        {
+            std::cout << "ERROR: " << frames.size() << " depth frames for a "
+                      << "sensor with a single camera view" << std::endl;
+            exit(-1);
+        }
+        set_depth_frame(frames[0]);
+    }
+
     virtual PoseArray& integrated_poses() { return default_poses_; }
     virtual void reset() = 0;
 
+    /**
+     * \brief Sets the metrics the sensor adds the time of its rendering,
+     *        mapping and weighting to, none disables the measurements
+     */
+    virtual void latency_metrics(const std::shared_ptr<LatencyMetrics>& metrics)
+    {
+        latency_metrics_ = metrics;
+    }
+
+    /**
+     * \return Maximum number of states a single loglikes() call can evaluate
+     */
+    virtual int max_sample_count() const
+    {
+        return std::numeric_limits<int>::max();
+    }
+
 protected:
+    /**
+     * \brief Time since the previous depth frame from their timestamps, or
+     *        delta_time_ if either timestamp is unknown
+     */
+    fl::Real frame_delta_time(const DepthFrame& frame)
+    {
+        fl::Real delta_time = delta_time_;
+        if (frame.timestamp() > last_frame_timestamp_ &&
+            last_frame_timestamp_ > 0)
+        {
+            delta_time = frame.timestamp() - last_frame_timestamp_;
+        }
+        last_frame_timestamp_ = frame.timestamp();
+        return delta_time;
+    }
+
     fl::Real delta_time_;
+    double last_frame_timestamp_;
     PoseArray default_poses_;
+    std::shared_ptr<LatencyMetrics> latency_metrics_;
 };
 }
@@ -0,0 +1,262 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file render_cache.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Lookup counters of a RenderCache
+ */
+struct RenderCacheStatistics
+{
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    /// lookups which had to wait for another thread holding their shard
+    size_t contentions = 0;
+    /// cached entries sharing a hash bucket with an earlier entry, each of
+    /// which costs a key comparison on lookup
+    size_t bucket_collisions = 0;
+};
+
+/**
+ * \brief Bounded cache of rendered depth images keyed by state
+ *
+ * The entries are distributed over independently locked shards, such that
+ * lookups of different states rarely wait for each other. Each shard holds a
+ * fixed number of image slots in one contiguous buffer which is allocated
+ * once the image size is known. When all slots of a shard are taken, the
+ * least recently used one is overwritten.
+ *
+ * A missing image is rendered while its shard is locked, hence concurrent
+ * lookups of the same state render it only once.
+ */
+template <typename Key, typename Hash = std::hash<Key>>
+class RenderCache
+{
+public:
+    /**
+     * \param capacity      Maximum number of cached images, rounded up to a
+     *                      multiple of the shard count
+     * \param shard_count   Number of independently locked shards
+     */
+    explicit RenderCache(int capacity = 1024, int shard_count = 16)
+        : shards_(std::max(shard_count, 1))
+    {
+        const int slot_count =
+            std::max((capacity + int(shards_.size()) - 1) / int(shards_.size()),
+                     1);
+        for (auto& shard : shards_) shard.reset(new Shard(slot_count));
+    }
+
+    /**
+     * \brief Returns the given pixel of the image of the key, rendering the
+     *        image first if it is not cached
+     *
+     * \param render    Callable void(std::vector<float>& image) rendering the
+     *                  image of the key. It is called with the shard locked,
+     *                  but may run concurrently for keys of other shards.
+     */
+    template <typename Render>
+    float pixel(const Key& key, int index, Render&& render)
+    {
+        Shard& shard = *shards_[shard_index(key)];
+
+        std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            lock.lock();
+            shard.statistics.contentions++;
+        }
+
+        int slot;
+        auto entry = shard.slots.find(key);
+        if (entry != shard.slots.end())
+        {
+            slot = entry->second;
+            shard.statistics.hits++;
+        }
+        else
+        {
+            render(shard.rendering);
+            slot = shard.insert(key, shard.rendering);
+            shard.statistics.misses++;
+        }
+
+        shard.last_used[slot] = ++shard.tick;
+        return shard.images[size_t(slot) * shard.image_size + index];
+    }
+
+    bool contains(const Key& key) const
+    {
+        const Shard& shard = *shards_[shard_index(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.slots.find(key) != shard.slots.end();
+    }
+
+    /**
+     * \brief Stores an image rendered outside of the cache, unless the key
+     *        is cached already
+     */
+    void insert(const Key& key, const std::vector<float>& image)
+    {
+        Shard& shard = *shards_[shard_index(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.slots.find(key) != shard.slots.end()) return;
+
+        const int slot = shard.insert(key, image);
+        shard.last_used[slot] = ++shard.tick;
+        shard.statistics.misses++;
+    }
+
+    /**
+     * \brief Removes all entries, keeping the allocated slots
+     */
+    void clear()
+    {
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->slots.clear();
+            shard->used_slot_count = 0;
+        }
+    }
+
+    /**
+     * \brief Counters accumulated over all shards since construction
+     */
+    RenderCacheStatistics statistics() const
+    {
+        RenderCacheStatistics total;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total.hits += shard->statistics.hits;
+            total.misses += shard->statistics.misses;
+            total.evictions += shard->statistics.evictions;
+            total.contentions += shard->statistics.contentions;
+
+            auto& slots = shard->slots;
+            for (size_t bucket = 0; bucket < slots.bucket_count(); ++bucket)
+            {
+                const size_t bucket_size = slots.bucket_size(bucket);
+                if (bucket_size > 1) total.bucket_collisions += bucket_size - 1;
+            }
+        }
+        return total;
+    }
+
+    int capacity() const
+    {
+        return int(shards_.size() * shards_[0]->slot_keys.size());
+    }
+
+    int size() const
+    {
+        int count = 0;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            count += shard->slots.size();
+        }
+        return count;
+    }
+
+private:
+    struct Shard
+    {
+        explicit Shard(int slot_count)
+            : image_size(0),
+              used_slot_count(0),
+              tick(0),
+              slot_keys(slot_count),
+              last_used(slot_count, 0)
+        {
+            slots.reserve(slot_count);
+        }
+
+        /**
+         * \brief Copies the image into a free or the least recently used slot
+         */
+        int insert(const Key& key, const std::vector<float>& image)
+        {
+            const size_t new_image_size = image.size();
+            if (new_image_size != image_size)
+            {
+                // the images of another size are useless
+                image_size = new_image_size;
+                images.assign(image_size * slot_keys.size(), 0.f);
+                slots.clear();
+                used_slot_count = 0;
+            }
+
+            int slot;
+            if (used_slot_count < int(slot_keys.size()))
+            {
+                slot = used_slot_count++;
+            }
+            else
+            {
+                slot = std::min_element(last_used.begin(), last_used.end()) -
+                       last_used.begin();
+                slots.erase(slot_keys[slot]);
+                statistics.evictions++;
+            }
+
+            slot_keys[slot] = key;
+            slots[key] = slot;
+            std::copy(image.begin(),
+                      image.end(),
+                      images.begin() + size_t(slot) * image_size);
+            return slot;
+        }
+
+        mutable std::mutex mutex;
+        std::unordered_map<Key, int, Hash> slots;
+
+        size_t image_size;
+        int used_slot_count;
+        uint64_t tick;
+        std::vector<Key> slot_keys;
+        std::vector<uint64_t> last_used;
+        std::vector<float> images;
+        std::vector<float> rendering;
+
+        RenderCacheStatistics statistics;
+    };
+
+    size_t shard_index(const Key& key) const
+    {
+        // the hash is mixed since the shards would otherwise only see its
+        // lowest bits
+        const uint64_t hash = uint64_t(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+        return size_t(hash >> 32) % shards_.size();
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+}
@@ -0,0 +1,144 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file render_cache_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <dbot/model/render_cache.h>
+
+namespace
+{
+struct Renderer
+{
+    explicit Renderer(int key) : key(key) {}
+    void operator()(std::vector<float>& image)
+    {
+        image.assign(4, float(key));
+        image[3] = float(10 * key);
+        render_count++;
+    }
+
+    int key;
+    int render_count = 0;
+};
+}
+
+TEST(RenderCacheTests, renders_each_key_once)
+{
+    dbot::RenderCache<int> cache(8, 2);
+    Renderer renderer(3);
+
+    EXPECT_FLOAT_EQ(cache.pixel(3, 0, renderer), 3.f);
+    EXPECT_FLOAT_EQ(cache.pixel(3, 3, renderer), 30.f);
+    EXPECT_EQ(renderer.render_count, 1);
+
+    auto statistics = cache.statistics();
+    EXPECT_EQ(statistics.misses, 1);
+    EXPECT_EQ(statistics.hits, 1);
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(RenderCacheTests, capacity_is_bounded)
+{
+    dbot::RenderCache<int> cache(4, 1);
+
+    for (int key = 0; key < 10; ++key)
+    {
+        Renderer renderer(key);
+        EXPECT_FLOAT_EQ(cache.pixel(key, 3, renderer), 10.f * key);
+    }
+
+    EXPECT_EQ(cache.capacity(), 4);
+    EXPECT_EQ(cache.size(), 4);
+    EXPECT_EQ(cache.statistics().evictions, 6);
+}
+
+TEST(RenderCacheTests, evicts_least_recently_used)
+{
+    dbot::RenderCache<int> cache(2, 1);
+    Renderer renderer_0(0);
+    Renderer renderer_1(1);
+    Renderer renderer_2(2);
+
+    cache.pixel(0, 0, renderer_0);
+    cache.pixel(1, 0, renderer_1);
+    cache.pixel(0, 0, renderer_0);
+    cache.pixel(2, 0, renderer_2);
+
+    // 1 was evicted, 0 is still cached
+    cache.pixel(0, 0, renderer_0);
+    EXPECT_EQ(renderer_0.render_count, 1);
+    cache.pixel(1, 0, renderer_1);
+    EXPECT_EQ(renderer_1.render_count, 2);
+}
+
+TEST(RenderCacheTests, clear_removes_entries)
+{
+    dbot::RenderCache<int> cache(4, 2);
+    Renderer renderer(5);
+
+    cache.pixel(5, 1, renderer);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+
+    EXPECT_FLOAT_EQ(cache.pixel(5, 1, renderer), 5.f);
+    EXPECT_EQ(renderer.render_count, 2);
+}
+
+TEST(RenderCacheTests, concurrent_lookups)
+{
+    dbot::RenderCache<int> cache(64, 4);
+
+    std::vector<std::thread> threads;
+    std::vector<int> errors(4, 0);
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&cache, &errors, t]() {
+            for (int i = 0; i < 1000; ++i)
+            {
+                const int key = (i * 7 + t) % 32;
+                Renderer renderer(key);
+                if (cache.pixel(key, 3, renderer) != 10.f * key) errors[t]++;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 0; t < 4; ++t) EXPECT_EQ(errors[t], 0);
+    auto statistics = cache.statistics();
+    EXPECT_EQ(statistics.hits + statistics.misses, 4000);
+    EXPECT_LE(statistics.misses, 32 * 4);
+}
+
+TEST(RenderCacheTests, inserted_images_are_hits)
+{
+    dbot::RenderCache<int> cache(8, 2);
+    Renderer renderer(7);
+
+    EXPECT_FALSE(cache.contains(7));
+    cache.insert(7, std::vector<float>{1.f, 2.f, 3.f, 4.f});
+    EXPECT_TRUE(cache.contains(7));
+
+    EXPECT_FLOAT_EQ(cache.pixel(7, 2, renderer), 3.f);
+    EXPECT_EQ(renderer.render_count, 0);
+
+    // an existing entry is kept
+    cache.insert(7, std::vector<float>{0.f, 0.f, 0.f, 0.f});
+    EXPECT_FLOAT_EQ(cache.pixel(7, 2, renderer), 3.f);
+}
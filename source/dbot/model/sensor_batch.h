@@ -0,0 +1,53 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sensor_batch.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <dbot/depth_frame.h>
+
+namespace dbot
+{
+/**
+ * \brief Sensor which is shared by the filters of several trackers and
+ *        evaluates the particles of all of them at once
+ *
+ * Each tracker holds one sensor of the batch. The filter steps of all
+ * trackers are passed to run(), which calls them concurrently and combines
+ * the likelihood evaluations they request into one.
+ */
+class SensorBatch
+{
+public:
+    virtual ~SensorBatch() noexcept {}
+
+    /**
+     * \brief Sets the observation of all sensors of the batch, it is
+     *        uploaded once for all trackers
+     */
+    virtual void set_depth_frame(const DepthFrame::ConstPtr& frame) = 0;
+
+    /**
+     * \brief Runs the jobs, each of which may call the sensor of one
+     *        tracker, and returns once all of them are done
+     */
+    virtual void run(const std::vector<std::function<void()>>& jobs) = 0;
+};
+}
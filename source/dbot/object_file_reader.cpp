@@ -19,7 +19,18 @@
 
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <limits>
 #include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <dbot/object_file_reader.h>
 
@@ -41,59 +52,289 @@ ObjectFileReader::ObjectFileReader()
 void ObjectFileReader::set_filename(string filename) {filename_ = filename;}
 
 
+namespace
+{
+
+/**
+ * \brief Read-only view of a whole file, memory mapped if possible
+ */
+class MappedFile
+{
+public:
+	explicit MappedFile(const string& filename)
+		: data_(NULL), size_(0), mapped_(false)
+	{
+		const int descriptor = open(filename.c_str(), O_RDONLY);
+		if(descriptor < 0) return;
+
+		struct stat status;
+		if(fstat(descriptor, &status) == 0 && status.st_size > 0)
+		{
+			size_ = status.st_size;
+			void* data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			if(data != MAP_FAILED)
+			{
+				madvise(data, size_, MADV_SEQUENTIAL);
+				data_ = static_cast<const char*>(data);
+				mapped_ = true;
+			}
+		}
+		close(descriptor);
+
+		// e.g. pipes or file systems which do not support mapping
+		if(!mapped_)
+		{
+			ifstream file(filename.c_str(), ios::binary);
+			buffer_.assign(istreambuf_iterator<char>(file),
+						   istreambuf_iterator<char>());
+			data_ = buffer_.data();
+			size_ = buffer_.size();
+		}
+		valid_ = true;
+	}
+
+	~MappedFile()
+	{
+		if(mapped_) munmap(const_cast<char*>(data_), size_);
+	}
+
+	bool valid() const { return valid_; }
+	const char* begin() const { return data_; }
+	const char* end() const { return data_ + size_; }
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const char* data_;
+	size_t size_;
+	bool mapped_;
+	bool valid_ = false;
+	string buffer_;
+};
+
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline void skip_blanks(const char*& p, const char* end)
+{
+	while(p < end && is_blank(*p)) p++;
+}
+
+inline void skip_line(const char*& p, const char* end)
+{
+	const void* newline = memchr(p, '\n', end - p);
+	p = newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+/**
+ * \brief Parses a decimal floating point number
+ *
+ * Numbers whose decimal mantissa is below 2^53 and whose decimal exponent
+ * lies within [-22, 22] are converted by a single multiplication or
+ * division with a power of ten. Both operands are exact doubles then, so
+ * the result rounds correctly. Larger mantissas or exponents are left to
+ * strtod.
+ */
+bool parse_double(const char*& p, const char* end, double& value)
+{
+	static const double powers_of_ten[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	const char* begin = p;
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+	uint64_t mantissa = 0;
+	int digit_count = 0;
+	int exponent = 0;
+	bool any_digit = false;
+	for(; p < end && *p >= '0' && *p <= '9'; p++)
+	{
+		any_digit = true;
+		if(digit_count < 19)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			if(mantissa) digit_count++;
+		}
+		else
+		{
+			exponent++;
+		}
+	}
+	if(p < end && *p == '.')
+	{
+		for(p++; p < end && *p >= '0' && *p <= '9'; p++)
+		{
+			any_digit = true;
+			if(digit_count < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				if(mantissa) digit_count++;
+				exponent--;
+			}
+		}
+	}
+	if(!any_digit)
+	{
+		p = begin;
+		return false;
+	}
+	if(p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* exponent_begin = p++;
+		bool negative_exponent = false;
+		if(p < end && (*p == '-' || *p == '+'))
+			negative_exponent = *p++ == '-';
+
+		if(p < end && *p >= '0' && *p <= '9')
+		{
+			int explicit_exponent = 0;
+			for(; p < end && *p >= '0' && *p <= '9'; p++)
+			{
+				if(explicit_exponent < 100000)
+					explicit_exponent = explicit_exponent * 10 + (*p - '0');
+			}
+			exponent += negative_exponent ? -explicit_exponent
+										  : explicit_exponent;
+		}
+		else
+		{
+			p = exponent_begin;
+		}
+	}
+
+	if(mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+	{
+		value = double(mantissa);
+		value = exponent < 0 ? value / powers_of_ten[-exponent]
+							 : value * powers_of_ten[exponent];
+		if(negative) value = -value;
+		return true;
+	}
+
+	// strtod needs a terminated string, numbers are short
+	char number[128];
+	const size_t length = std::min<size_t>(p - begin, sizeof(number) - 1);
+	memcpy(number, begin, length);
+	number[length] = '\0';
+	value = strtod(number, NULL);
+	return true;
+}
+
+bool parse_int(const char*& p, const char* end, int& value)
+{
+	bool negative = false;
+	const char* begin = p;
+	if(p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+	if(!(p < end && *p >= '0' && *p <= '9'))
+	{
+		p = begin;
+		return false;
+	}
+
+	long long result = 0;
+	for(; p < end && *p >= '0' && *p <= '9'; p++)
+	{
+		result = result * 10 + (*p - '0');
+		if(result > std::numeric_limits<int>::max())
+			result = std::numeric_limits<int>::max();
+	}
+	value = negative ? -int(result) : int(result);
+	return true;
+}
+
+/**
+ * \brief Parses the vertex index of one corner of a face, i.e. the first
+ *        number of v, v/vt, v//vn or v/vt/vn, and skips the rest
+ *
+ * \return false if there is no further corner on the line
+ */
+bool parse_corner(const char*& p, const char* end, int& index)
+{
+	skip_blanks(p, end);
+	if(!parse_int(p, end, index)) return false;
+
+	while(p < end && !is_blank(*p) && *p != '\n') p++;
+	return true;
+}
+
+}
+
+
 void ObjectFileReader::Read()
 {
 	indices_->clear();
 	vertices_->clear();
 
-	ifstream file;
-	file.open(filename_.c_str());
-
-	if(!file.is_open())
-    {
-        throw CannotOpenWavefrontFileException(filename_);
+	MappedFile file(filename_);
+	if(!file.valid())
+	{
+		throw CannotOpenWavefrontFileException(filename_);
 	}
 
-	string line;
+	const char* p = file.begin();
+	const char* end = file.end();
+
+	// a rough upper bound of the element counts saves reallocations of
+	// large meshes
+	size_t vertex_count = 0;
+	size_t face_count = 0;
+	for(const char* line = p; line < end; skip_line(line, end))
+	{
+		if(end - line > 1 && line[1] == ' ')
+		{
+			if(line[0] == 'v') vertex_count++;
+			else if(line[0] == 'f') face_count++;
+		}
+	}
+	vertices_->reserve(vertex_count);
+	indices_->reserve(face_count);
 
 	float x_min = std::numeric_limits<float>::max();
 	float x_max = -std::numeric_limits<float>::max();
 
-	while(!file.eof())
+	vector<int> corners;
+	while(p < end)
 	{
-		string data_type;
-		getline(file, line, '\n');
-
-		stringstream line_stream(line);
-		line_stream >> data_type;
-
-		if(data_type == "v")
+		skip_blanks(p, end);
+		if(end - p > 1 && p[0] == 'v' && is_blank(p[1]))
 		{
+			p++;
 			Vector3d point;
-
-			line_stream >> point(0);
-			line_stream >> point(1);
-			line_stream >> point(2);
+			for(int i = 0; i < 3; i++)
+			{
+				skip_blanks(p, end);
+				if(!parse_double(p, end, point(i))) point(i) = 0.;
+			}
 			vertices_->push_back(point);
 		}
-		else if(data_type == "f")
+		else if(end - p > 1 && p[0] == 'f' && is_blank(p[1]))
 		{
-			vector<int> triangle(3);
-
-			char trash[100];
-
-			line_stream >> triangle[0];
-			line_stream.getline(trash, 100, ' ');
-			line_stream >> triangle[1];
-			line_stream.getline(trash, 100, ' ');
-			line_stream >> triangle[2];
+			p++;
+			corners.clear();
+			int index;
+			while(parse_corner(p, end, index))
+			{
+				// negative indices count back from the last vertex, positive
+				// ones start with 1 while we start with 0
+				corners.push_back(index < 0 ? int(vertices_->size()) + index
+											: index - 1);
+			}
 
-			// substract one because indices in object files start with 1 and we start with 0
-			triangle[0]--; triangle[1]--; triangle[2]--;
-			indices_->push_back(triangle);
+			// polygons are split into a fan of triangles
+			for(size_t i = 2; i < corners.size(); i++)
+			{
+				vector<int> triangle(3);
+				triangle[0] = corners[0];
+				triangle[1] = corners[i - 1];
+				triangle[2] = corners[i];
+				indices_->push_back(triangle);
+			}
 		}
+		skip_line(p, end);
 	}
-	file.close();
 
 	// todo this is a bit hacky: we check if extension in x is larger than 10, if it is we assume that the unit is mm
 	if(x_max - x_min > 10)
@@ -106,60 +347,94 @@ void ObjectFileReader::Read()
 }
 
 
-void ObjectFileReader::Process(float max_side_length) // todo: has to be tested since we switched from Vector3i to vector<int>
+void ObjectFileReader::Process(float max_side_length)
 {
 	// subdivide triangles until no triangle has a side longer than max_side_length ----------------------------------------
-	vector<vector<int> >::iterator triangle_indices = indices_->begin();
-
-	int index = 0;
-	while(triangle_indices != indices_->end())
+	// every triangle is split at the midpoint of its longest side. The halves
+	// are pushed onto a worklist and the finished triangles are collected in a
+	// new list, such that each triangle is visited once and the input list is
+	// never modified while it is traversed. Midpoints are shared between the
+	// two triangles of an edge, which keeps the mesh closed.
+	if(max_side_length > 0)
 	{
-		vector<Vector3d> triangle;
-		for(unsigned int corner_index = 0; corner_index < 3; corner_index++)
-			triangle.push_back((*vertices_)[(*triangle_indices)[corner_index]]);
-
-		// find longest side of triangle ----------------------------------------------------------
-		float AB = -1.;
-		int A = -1 , B = -1 , C = -1;
-		for(unsigned int i = 0; i < 3; i++)
-		{
-			float length = (triangle[i] - triangle[(i+1)%3]).norm();
+		vector<vector<int> > subdivided;
+		subdivided.reserve(indices_->size());
+		unordered_map<uint64_t, int> midpoints;
+		vector<vector<int> > worklist;
 
-			if( length > AB )
+		for(size_t i = 0; i < indices_->size(); i++)
+		{
+			worklist.push_back((*indices_)[i]);
+			while(!worklist.empty())
 			{
-				AB = length;
-				A = i;
-				B = (i+1)%3;
-				C = (i+2)%3;
+				vector<int> triangle = worklist.back();
+				worklist.pop_back();
+
+				// find longest side of triangle ----------------------------------------------------------
+				double AB = -1.;
+				int A = -1 , B = -1 , C = -1;
+				for(unsigned int j = 0; j < 3; j++)
+				{
+					double length = ((*vertices_)[triangle[j]] -
+									 (*vertices_)[triangle[(j+1)%3]]).norm();
+					if( length > AB )
+					{
+						AB = length;
+						A = j;
+						B = (j+1)%3;
+						C = (j+2)%3;
+					}
+				}
+
+				// if the longest side is short enough the triangle is done --------------------------------
+				if(!(AB > max_side_length))
+				{
+					subdivided.push_back(triangle);
+					continue;
+				}
+
+				const uint32_t low = min(triangle[A], triangle[B]);
+				const uint32_t high = max(triangle[A], triangle[B]);
+				const uint64_t edge = (uint64_t(low) << 32) | high;
+
+				int center_AB;
+				unordered_map<uint64_t, int>::const_iterator midpoint =
+					midpoints.find(edge);
+				if(midpoint != midpoints.end())
+				{
+					center_AB = midpoint->second;
+				}
+				else
+				{
+					center_AB = vertices_->size();
+					vertices_->push_back(((*vertices_)[triangle[A]] +
+										  (*vertices_)[triangle[B]]) / 2.);
+					midpoints[edge] = center_AB;
+				}
+
+				// both halves keep the orientation of the triangle
+				vector<int> triangle_A(3);
+				triangle_A[0] = triangle[A];
+				triangle_A[1] = center_AB;
+				triangle_A[2] = triangle[C];
+
+				vector<int> triangle_B(3);
+				triangle_B[0] = center_AB;
+				triangle_B[1] = triangle[B];
+				triangle_B[2] = triangle[C];
+
+				worklist.push_back(triangle_B);
+				worklist.push_back(triangle_A);
 			}
 		}
-
-		assert( A!= -1 && B!=-1 && C!=-1 && AB!=-1);
-		// if the longest side is too long we split the triangle -----------------------------------
-		if(AB > max_side_length)
-		{
-			vertices_->push_back( (triangle[A] + triangle[B]) / 2.);
-			float center_AB = vertices_->size()-1;
-
-			vector<int> triangle_indices_A(3);
-			triangle_indices_A[0] = (*triangle_indices)[A];
-			triangle_indices_A[1] = center_AB;
-			triangle_indices_A[2] = (*triangle_indices)[C];
-
-
-			vector<int> triangle_indices_B(3);
-			triangle_indices_B[0] = (*triangle_indices)[B];
-			triangle_indices_B[1] = center_AB;
-			triangle_indices_B[2] = (*triangle_indices)[C];
-
-			indices_->push_back(triangle_indices_A);
-			indices_->push_back(triangle_indices_B);
-			indices_->erase(triangle_indices++);
-		}
-		else {triangle_indices++; index++;}
+		indices_->swap(subdivided);
 	}
 
 	// now we compute the area and the center of each triangle ---------------------------------------------------------------
+	centers_->clear();
+	areas_->clear();
+	centers_->reserve(indices_->size());
+	areas_->reserve(indices_->size());
 	for(vector<vector<int> >::iterator indices = indices_->begin(); indices != indices_->end(); indices++)
 	{
 		Vector3d A,B,C;
@@ -0,0 +1,158 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file object_file_reader_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <Eigen/Geometry>
+
+#include <dbot/object_file_reader.h>
+
+namespace
+{
+std::shared_ptr<dbot::ObjectFileReader> read(const std::string& content)
+{
+    const std::string filename = ::testing::TempDir() + "reader_test.obj";
+    {
+        std::ofstream file(filename.c_str());
+        file << content;
+    }
+
+    auto reader = std::make_shared<dbot::ObjectFileReader>();
+    reader->set_filename(filename);
+    reader->Read();
+    std::remove(filename.c_str());
+    return reader;
+}
+}
+
+TEST(ObjectFileReaderTests, parses_vertices)
+{
+    auto reader = read(
+        "# comment\n"
+        "v 1 -2.5 3.25e-2\n"
+        "vn 0 0 1\n"
+        "vt 0.5 0.5\n"
+        "v\t0.1 .2 -1E+1\r\n"
+        "v 0.12345678901234567890123 1e-300 123456789012345678901234\n");
+
+    auto& vertices = *reader->get_vertices();
+    ASSERT_EQ(vertices.size(), 3);
+    EXPECT_EQ(vertices[0](0), 1.);
+    EXPECT_EQ(vertices[0](1), -2.5);
+    EXPECT_EQ(vertices[0](2), 3.25e-2);
+    EXPECT_EQ(vertices[1](0), 0.1);
+    EXPECT_EQ(vertices[1](1), 0.2);
+    EXPECT_EQ(vertices[1](2), -10.);
+    EXPECT_EQ(vertices[2](0), 0.12345678901234567890123);
+    EXPECT_EQ(vertices[2](1), 1e-300);
+    EXPECT_EQ(vertices[2](2), 123456789012345678901234.);
+}
+
+TEST(ObjectFileReaderTests, parses_face_formats)
+{
+    auto reader = read(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+        "f 1 2 3\n"
+        "f 1/1 2/2 3/3\n"
+        "f 2//1 3//1 4//1\n"
+        "f 2/1/1 3/2/1 4/3/1\n");
+
+    auto& indices = *reader->get_indices();
+    ASSERT_EQ(indices.size(), 4);
+    EXPECT_EQ(indices[0], (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(indices[1], (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(indices[2], (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(indices[3], (std::vector<int>{1, 2, 3}));
+}
+
+TEST(ObjectFileReaderTests, splits_polygons_and_resolves_negative_indices)
+{
+    auto reader = read(
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0.5 1.5 0\n"
+        "f 1 2 3 4 5\n"
+        "f -3 -2 -1");
+
+    auto& indices = *reader->get_indices();
+    ASSERT_EQ(indices.size(), 4);
+    EXPECT_EQ(indices[0], (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(indices[1], (std::vector<int>{0, 2, 3}));
+    EXPECT_EQ(indices[2], (std::vector<int>{0, 3, 4}));
+    EXPECT_EQ(indices[3], (std::vector<int>{2, 3, 4}));
+}
+
+TEST(ObjectFileReaderTests, missing_file_throws)
+{
+    dbot::ObjectFileReader reader;
+    reader.set_filename("/nonexistent/object.obj");
+    EXPECT_THROW(reader.Read(), dbot::CannotOpenWavefrontFileException);
+}
+
+TEST(ObjectFileReaderTests, process_subdivides_long_sides)
+{
+    // two triangles of a unit square sharing the diagonal
+    auto reader = read(
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "f 1 2 3\n"
+        "f 1 3 4\n");
+    reader->Process(0.3);
+
+    auto& vertices = *reader->get_vertices();
+    auto& indices = *reader->get_indices();
+    auto& areas = *reader->get_areas();
+    ASSERT_EQ(reader->get_centers()->size(), indices.size());
+    ASSERT_EQ(areas.size(), indices.size());
+
+    double area = 0;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        const Eigen::Vector3d& a = vertices[indices[i][0]];
+        const Eigen::Vector3d& b = vertices[indices[i][1]];
+        const Eigen::Vector3d& c = vertices[indices[i][2]];
+        EXPECT_LE((b - a).norm(), 0.3);
+        EXPECT_LE((c - b).norm(), 0.3);
+        EXPECT_LE((a - c).norm(), 0.3);
+
+        // the halves keep the orientation of the faces
+        EXPECT_GT((b - a).cross(c - a).z(), 0.);
+        area += areas[i];
+    }
+    EXPECT_NEAR(area, 1., 1e-4);
+
+    // midpoints are shared, such that no vertex appears twice
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        for (size_t j = i + 1; j < vertices.size(); j++)
+        {
+            EXPECT_GT((vertices[i] - vertices[j]).norm(), 1e-9);
+        }
+    }
+}
+
+TEST(ObjectFileReaderTests, process_keeps_short_triangles)
+{
+    auto reader = read("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+    reader->Process(2.);
+
+    ASSERT_EQ(reader->get_indices()->size(), 1);
+    EXPECT_EQ((*reader->get_indices())[0], (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(reader->get_vertices()->size(), 3);
+    EXPECT_NEAR((*reader->get_areas())[0], 0.5, 1e-6);
+}
@@ -17,6 +17,10 @@
  * \author Jan Issac (jan.issac@gmail.com)
  */
 
+#include <algorithm>
+#include <cmath>
+
+#include <dbot/mesh_simplification.h>
 #include <dbot/object_model.h>
 
 namespace dbot
@@ -30,20 +34,31 @@ ObjectModel::ObjectModel(const std::shared_ptr<ObjectModelLoader>& loader,
 void ObjectModel::load_from(const std::shared_ptr<ObjectModelLoader>& loader,
                             bool center)
 {
-    loader->load(vertices_, triangle_indices_);
-    compute_centers(centers_);
+    // the nested layout of the loader is only kept until it is flattened
+    Vertices vertices;
+    TriangleIndecies triangle_indices;
+    loader->load(vertices, triangle_indices);
+    compute_centers(vertices, centers_);
+
+    if (center) center_vertices(centers_, vertices);
 
-    if (center) center_vertices(centers_, vertices_);
+    meshes_.assign(
+        1, std::make_shared<TriangleMesh>(vertices, triangle_indices));
+}
+
+const TriangleMesh::ConstPtr& ObjectModel::mesh(int level) const
+{
+    return meshes_[level];
 }
 
-auto ObjectModel::vertices() const -> const Vertices &
+auto ObjectModel::vertices() const -> Vertices
 {
-    return vertices_;
+    return vertices(0);
 }
 
-auto ObjectModel::triangle_indices() const -> const TriangleIndecies &
+auto ObjectModel::triangle_indices() const -> TriangleIndecies
 {
-    return triangle_indices_;
+    return triangle_indices(0);
 }
 
 const std::vector<Eigen::Vector3d>& ObjectModel::centers() const
@@ -53,20 +68,110 @@ const std::vector<Eigen::Vector3d>& ObjectModel::centers() const
 
 int ObjectModel::count_parts() const
 {
-    return vertices_.size();
+    return meshes_[0]->count_parts();
+}
+
+void ObjectModel::build_levels_of_detail(int level_count,
+                                         double reduction,
+                                         int min_triangle_count)
+{
+    meshes_.resize(1);
+
+    for (int level = 1; level < level_count; level++)
+    {
+        // each level is simplified from the previous one, which is much
+        // cheaper than starting from the full mesh every time
+        const TriangleMesh& finer_mesh = *meshes_[level - 1];
+
+        // the parts are simplified independently, and added in order
+        const int part_count = finer_mesh.count_parts();
+        std::vector<std::vector<Eigen::Vector3d>> level_vertices(part_count);
+        std::vector<std::vector<std::vector<int>>> level_indices(part_count);
+        std::vector<char> part_reduced(part_count, false);
+        auto simplify_part = [&](int part)
+        {
+            finer_mesh.copy_part(
+                part, level_vertices[part], level_indices[part]);
+
+            const int finer_count = level_indices[part].size();
+            const double full_count = meshes_[0]->count_triangles(part);
+            const int target = std::max(
+                int(std::pow(reduction, level) * full_count),
+                min_triangle_count);
+
+            if (target >= finer_count) return;
+
+            std::vector<Eigen::Vector3d> finer_vertices;
+            std::vector<std::vector<int>> finer_indices;
+            finer_vertices.swap(level_vertices[part]);
+            finer_indices.swap(level_indices[part]);
+            simplify_mesh(finer_vertices,
+                          finer_indices,
+                          target,
+                          level_vertices[part],
+                          level_indices[part]);
+
+            // a level which barely simplifies only costs memory
+            part_reduced[part] =
+                level_indices[part].size() * 10 < size_t(finer_count) * 9;
+        };
+
+        if (worker_pool_)
+        {
+            worker_pool_->parallel_for(part_count, simplify_part);
+        }
+        else
+        {
+            for (int part = 0; part < part_count; part++) simplify_part(part);
+        }
+
+        auto level_mesh = std::make_shared<TriangleMesh>();
+        bool reduced = false;
+        for (int part = 0; part < part_count; part++)
+        {
+            level_mesh->add_part(level_vertices[part], level_indices[part]);
+            reduced = reduced || part_reduced[part];
+        }
+
+        if (!reduced) break;
+
+        meshes_.push_back(level_mesh);
+    }
+}
+
+int ObjectModel::count_levels() const
+{
+    return meshes_.size();
 }
 
-void ObjectModel::compute_centers(std::vector<Eigen::Vector3d>& centers)
+auto ObjectModel::vertices(int level) const -> Vertices
 {
-    centers.resize(vertices_.size());
-    for (size_t i = 0; i < vertices_.size(); i++)
+    Vertices vertices;
+    TriangleIndecies triangle_indices;
+    meshes_[level]->copy(vertices, triangle_indices);
+    return vertices;
+}
+
+auto ObjectModel::triangle_indices(int level) const -> TriangleIndecies
+{
+    Vertices vertices;
+    TriangleIndecies triangle_indices;
+    meshes_[level]->copy(vertices, triangle_indices);
+    return triangle_indices;
+}
+
+void ObjectModel::compute_centers(const Vertices& vertices,
+                                  std::vector<Eigen::Vector3d>& centers)
+{
+    centers.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
     {
         centers[i] = Eigen::Vector3d::Zero();
-        for (size_t j = 0; j < vertices_[i].size(); j++)
+        for (size_t j = 0; j < vertices[i].size(); j++)
         {
-            centers[i] += vertices_[i][j];
+            centers[i] += vertices[i][j];
         }
-        centers[i] /= double(vertices_[i].size());
+        centers[i] /= double(vertices[i].size());
     }
 }
 
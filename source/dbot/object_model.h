@@ -27,6 +27,8 @@
 #include <fl/util/types.hpp>
 
 #include <dbot/object_model_loader.h>
+#include <dbot/triangle_mesh.h>
+#include <dbot/worker_pool.h>
 
 namespace dbot
 {
@@ -44,16 +46,64 @@ public:
     void load_from(const std::shared_ptr<ObjectModelLoader>& loader,
                    bool center);
 
-    const Vertices& vertices() const;
+    /**
+     * \brief The loaded mesh, or the given level of detail of it
+     *
+     * Renderers should keep a reference to this mesh instead of copying
+     * its vertices and indices.
+     */
+    const TriangleMesh::ConstPtr& mesh(int level = 0) const;
 
-    const TriangleIndecies& triangle_indices() const;
+    /**
+     * \brief Copy of the vertices of the mesh
+     */
+    Vertices vertices() const;
+
+    /**
+     * \brief Copy of the triangles of the mesh
+     */
+    TriangleIndecies triangle_indices() const;
 
     const std::vector<Eigen::Vector3d>& centers() const;
 
     int count_parts() const;
 
+    /**
+     * \brief Builds simplified copies of all parts, see simplify_mesh()
+     *
+     * Level l aims at reduction^l of the triangles of the loaded mesh. Fewer
+     * levels are built if a part cannot be reduced any further or all parts
+     * are below min_triangle_count already. Loading a mesh drops the levels.
+     * The parts are simplified in parallel on the worker pool if one is set.
+     */
+    void build_levels_of_detail(int level_count,
+                                double reduction = 0.25,
+                                int min_triangle_count = 64);
+
+    /**
+     * \brief Number of levels of detail, including the loaded mesh at level 0
+     */
+    int count_levels() const;
+
+    Vertices vertices(int level) const;
+
+    TriangleIndecies triangle_indices(int level) const;
+
+    /**
+     * \brief Pool the levels of detail are built on, may be empty
+     */
+    const std::shared_ptr<WorkerPool>& worker_pool() const
+    {
+        return worker_pool_;
+    }
+    void worker_pool(const std::shared_ptr<WorkerPool>& pool)
+    {
+        worker_pool_ = pool;
+    }
+
 private:
-    void compute_centers(std::vector<Eigen::Vector3d>& centers);
+    void compute_centers(const Vertices& vertices,
+                         std::vector<Eigen::Vector3d>& centers);
 
     void center_vertices(const std::vector<Eigen::Vector3d>& centers,
                          std::vector<std::vector<Eigen::Vector3d>>& vertices);
@@ -61,7 +111,10 @@ private:
 private:
     std::vector<Eigen::Vector3d> centers_;
 
-    std::vector<std::vector<Eigen::Vector3d>> vertices_;
-    std::vector<std::vector<std::vector<int>>> triangle_indices_;
+    // the loaded mesh followed by its levels of detail
+    std::vector<TriangleMesh::ConstPtr> meshes_ = {
+        std::make_shared<TriangleMesh>()};
+
+    std::shared_ptr<WorkerPool> worker_pool_;
 };
 }
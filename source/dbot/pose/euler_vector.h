@@ -63,10 +63,25 @@ public:
         return ax;
     }
     virtual AngleAxis angle_axis() const { return AngleAxis(angle(), axis()); }
-    virtual Quaternion quaternion() const { return Quaternion(angle_axis()); }
+    /**
+     * \brief Quaternion of the rotation, computed from the vector directly
+     *        instead of going through the normalized axis
+     */
+    virtual Quaternion quaternion() const
+    {
+        const Scalar alpha = angle();
+        // sin(alpha / 2) / alpha tends to 1 / 2 for small angles
+        const Scalar scale = alpha > Scalar(1e-12)
+                                 ? std::sin(Scalar(0.5) * alpha) / alpha
+                                 : Scalar(0.5);
+        return Quaternion(std::cos(Scalar(0.5) * alpha),
+                          scale * (*this)(0),
+                          scale * (*this)(1),
+                          scale * (*this)(2));
+    }
     virtual RotationMatrix rotation_matrix() const
     {
-        return RotationMatrix(quaternion());
+        return quaternion().toRotationMatrix();
     }
     virtual EulerVector inverse() const { return EulerVector(-*this); }
     // mutators ****************************************************************
@@ -151,4 +151,22 @@ public:
         }
     }
 };
+
+/**
+ * \brief Noise and input of the transition of an object state, the noise
+ *        has one entry per pose coordinate and is fixed-size if the state is
+ */
+template <typename State>
+struct ObjectStateTrait
+{
+    enum
+    {
+        NoiseDim = State::SizeAtCompileTime != -1 ? State::SizeAtCompileTime / 2
+                                                  : Eigen::Dynamic,
+        InputDim = Eigen::Dynamic
+    };
+
+    typedef Eigen::Matrix<typename State::Scalar, NoiseDim, 1> Noise;
+    typedef Eigen::Matrix<typename State::Scalar, InputDim, 1> Input;
+};
 }
@@ -18,7 +18,10 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <vector>
 #include <Eigen/Dense>
 
 #include <dbot/pose/pose_vector.h>
@@ -28,63 +31,191 @@
 
 namespace dbot
 {
-template <typename Vector>
-class PoseHash;
-
-template <>
-class PoseHash<PoseVector>
+/**
+ * \brief Cell sizes of the grid poses are snapped to before hashing
+ *
+ * Poses in the same cell share a key, hence the resolution should be well
+ * below the differences which change the rendered image.
+ */
+struct PoseQuantization
 {
-public:
-    std::size_t operator()(const PoseVector& s) const
+    explicit PoseQuantization(double translation_resolution = 1e-6,
+                              double rotation_resolution = 1e-6)
+        : translation_resolution(translation_resolution),
+          rotation_resolution(rotation_resolution)
     {
-        /* primes */
-        static constexpr int p1 = 15487457;
-        static constexpr int p2 = 24092821;
-        static constexpr int p3 = 73856093;
-        static constexpr int p4 = 19349663;
-        static constexpr int p5 = 83492791;
-        static constexpr int p6 = 17353159;
-
-        /* map size */
-        static constexpr int n = 1200;
-
-        /* precision */
-        static constexpr int c = 1000000;
-
-        return ((int(s(0, 0) * c) * p1) ^ (int(s(1, 0) * c) * p2) ^
-                (int(s(2, 0) * c) * p3) ^ (int(s(3, 0) * c) * p4) ^
-                (int(s(4, 0) * c) * p5) ^ (int(s(5, 0) * c) * p6) % n);
     }
+
+    /// in meters
+    double translation_resolution;
+    /// in radians of the Euler vector components
+    double rotation_resolution;
 };
 
-template <>
-class PoseHash<PoseVelocityVector>
+/**
+ * \brief Finalizer of splitmix64, every input bit affects every output bit
+ */
+inline uint64_t mix_hash(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31;
+    return value;
+}
+
+inline uint64_t combine_hash(uint64_t seed, uint64_t value)
+{
+    return mix_hash(seed + 0x9e3779b97f4a7c15ull + value);
+}
+
+/**
+ * \brief Index of the cell of the given value, saturated instead of
+ *        overflowing for values far outside the grid
+ */
+inline int64_t quantize(double value, double resolution)
+{
+    static constexpr double limit = 4.0e18;
+
+    const double cell = std::floor(value / resolution + 0.5);
+    if (std::isnan(cell)) return INT64_MIN;
+    if (cell > limit) return INT64_MAX;
+    if (cell < -limit) return INT64_MIN + 1;
+    return int64_t(cell);
+}
+
+/**
+ * \brief Hashable key of one or several poses snapped to a PoseQuantization
+ *        grid
+ *
+ * Comparing two keys compares a few integers instead of the dynamic states
+ * they were made of. The cells of up to two poses are stored inline, more
+ * are kept on the heap.
+ */
+class QuantizedPoseKey
 {
 public:
-    std::size_t operator()(const PoseVelocityVector& s) const
+    QuantizedPoseKey() : size_(0), hash_(0) {}
+
+    /**
+     * \brief Appends the cells of the pose given by the 6 values
+     *        (position, Euler vector) starting at data
+     */
+    void append_pose(const Real* data, const PoseQuantization& quantization)
     {
-        auto h = PoseHash<PoseVector>();
+        for (int i = 0; i < 6; ++i)
+        {
+            const double resolution = i < 3
+                                          ? quantization.translation_resolution
+                                          : quantization.rotation_resolution;
+            append(quantize(data[i], resolution));
+        }
+    }
 
-        std::size_t hash = h(s.pose());
+    int size() const { return size_; }
+    int64_t cell(int index) const
+    {
+        return index < inline_capacity ? inline_cells_[index]
+                                       : heap_cells_[index - inline_capacity];
+    }
 
-        return hash;
+    std::size_t hash() const { return std::size_t(hash_); }
+    bool operator==(const QuantizedPoseKey& other) const
+    {
+        if (hash_ != other.hash_ || size_ != other.size_) return false;
+        for (int i = 0; i < size_; ++i)
+        {
+            if (cell(i) != other.cell(i)) return false;
+        }
+        return true;
     }
-};
-template <>
-class PoseHash<FreeFloatingRigidBodiesState<>>
-{
-public:
-    std::size_t operator()(const FreeFloatingRigidBodiesState<>& s) const
+
+    bool operator!=(const QuantizedPoseKey& other) const
     {
-        auto h = PoseHash<PoseVector>();
+        return !(*this == other);
+    }
 
-        std::size_t hash = 0;
-        for (int i = 0; i < s.count(); ++i)
+private:
+    void append(int64_t value)
+    {
+        if (size_ < inline_capacity)
         {
-            hash += h(s.component(i).pose());
+            inline_cells_[size_] = value;
         }
+        else
+        {
+            heap_cells_.push_back(value);
+        }
+        size_++;
+        hash_ = combine_hash(hash_, uint64_t(value));
+    }
+
+    static constexpr int inline_capacity = 12;
+
+    int64_t inline_cells_[inline_capacity];
+    std::vector<int64_t> heap_cells_;
+    int size_;
+    uint64_t hash_;
+};
+
+struct QuantizedPoseKeyHash
+{
+    std::size_t operator()(const QuantizedPoseKey& key) const
+    {
+        return key.hash();
+    }
+};
+
+inline QuantizedPoseKey make_pose_key(
+    const PoseVector& pose,
+    const PoseQuantization& quantization = PoseQuantization())
+{
+    QuantizedPoseKey key;
+    key.append_pose(pose.data(), quantization);
+    return key;
+}
 
-        return hash;
+inline QuantizedPoseKey make_pose_key(
+    const PoseVelocityVector& state,
+    const PoseQuantization& quantization = PoseQuantization())
+{
+    QuantizedPoseKey key;
+    key.append_pose(state.data() + PoseVelocityVector::POSE_INDEX,
+                    quantization);
+    return key;
+}
+
+/**
+ * \brief Key of the poses of all bodies, hashed in a single pass over the
+ *        state without copying the components
+ */
+template <int BodyCount>
+QuantizedPoseKey make_pose_key(
+    const FreeFloatingRigidBodiesState<BodyCount>& state,
+    const PoseQuantization& quantization = PoseQuantization())
+{
+    typedef FreeFloatingRigidBodiesState<BodyCount> State;
+
+    QuantizedPoseKey key;
+    for (int i = 0; i < state.count(); ++i)
+    {
+        key.append_pose(state.data() + i * State::BODY_SIZE, quantization);
+    }
+    return key;
+}
+
+/**
+ * \brief Hash of the state consistent with its exact comparison, i.e. equal
+ *        states have equal hashes
+ */
+template <typename Vector>
+class PoseHash
+{
+public:
+    std::size_t operator()(const Vector& s) const
+    {
+        return make_pose_key(s).hash();
     }
 };
 }
@@ -0,0 +1,101 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_hashing_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <unordered_set>
+
+#include <dbot/pose/pose_hashing.h>
+
+TEST(PoseHashingTests, equal_states_have_equal_keys)
+{
+    dbot::FreeFloatingRigidBodiesState<> a(2);
+    a.setRandom();
+    dbot::FreeFloatingRigidBodiesState<> b = a;
+
+    EXPECT_TRUE(dbot::make_pose_key(a) == dbot::make_pose_key(b));
+    EXPECT_EQ(dbot::PoseHash<dbot::FreeFloatingRigidBodiesState<>>()(a),
+              dbot::PoseHash<dbot::FreeFloatingRigidBodiesState<>>()(b));
+}
+
+TEST(PoseHashingTests, velocities_are_ignored)
+{
+    dbot::FreeFloatingRigidBodiesState<> a(1);
+    a.setRandom();
+    dbot::FreeFloatingRigidBodiesState<> b = a;
+    b.component(0).linear_velocity() *= 2.;
+
+    EXPECT_TRUE(dbot::make_pose_key(a) == dbot::make_pose_key(b));
+}
+
+TEST(PoseHashingTests, resolution_is_respected)
+{
+    dbot::PoseVector a;
+    a.setZero();
+    dbot::PoseVector b = a;
+    b(0) = 0.004;
+    dbot::PoseVector c = a;
+    c(4) = 0.004;
+
+    const dbot::PoseQuantization coarse(0.01, 0.001);
+    EXPECT_TRUE(dbot::make_pose_key(a, coarse) ==
+                dbot::make_pose_key(b, coarse));
+    EXPECT_FALSE(dbot::make_pose_key(a, coarse) ==
+                 dbot::make_pose_key(c, coarse));
+    EXPECT_FALSE(dbot::make_pose_key(a) == dbot::make_pose_key(b));
+}
+
+TEST(PoseHashingTests, large_translations_do_not_collide)
+{
+    // at micrometer resolution these overflowed a 32 bit cell index
+    dbot::PoseVector a;
+    a.setZero();
+    a(0) = 3000.;
+    dbot::PoseVector b = a;
+    b(0) = 3000. + 4294.967296;
+
+    EXPECT_NE(dbot::make_pose_key(a).hash(), dbot::make_pose_key(b).hash());
+    EXPECT_FALSE(dbot::make_pose_key(a) == dbot::make_pose_key(b));
+}
+
+TEST(PoseHashingTests, nearby_poses_spread_over_hashes)
+{
+    std::unordered_set<std::size_t> hashes;
+    dbot::PoseVector pose;
+    pose.setZero();
+    for (int i = 0; i < 1000; ++i)
+    {
+        pose(i % 6) += 1e-5;
+        hashes.insert(dbot::make_pose_key(pose).hash() % 1024);
+    }
+
+    // a uniform hash fills about 1 - 1/e of the buckets
+    EXPECT_GT(hashes.size(), 550);
+}
+
+TEST(PoseHashingTests, many_bodies_are_stored_beyond_inline_cells)
+{
+    dbot::FreeFloatingRigidBodiesState<> a(4);
+    a.setZero();
+    dbot::FreeFloatingRigidBodiesState<> b = a;
+    b.component(3).position()(2) = 1.;
+
+    const auto key_a = dbot::make_pose_key(a);
+    EXPECT_EQ(key_a.size(), 24);
+    EXPECT_FALSE(key_a == dbot::make_pose_key(b));
+}
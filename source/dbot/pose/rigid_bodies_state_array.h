@@ -0,0 +1,323 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_bodies_state_array.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/pose/pose_vector.h>
+#include <dbot/pose/pose_velocity_vector.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+namespace dbot
+{
+/**
+ * \brief Particle states of rigid bodies stored as structure of arrays
+ *
+ * Every coordinate of every body is one contiguous column over all
+ * particles, i.e. the position, Euler vector and velocity columns of body b
+ * start at column b * BODY_SIZE. The weighted mean, the centering on the mean
+ * and the composition with the reference poses are column operations which
+ * Eigen vectorizes, instead of a quaternion conversion per particle and
+ * body. The workspace is kept across calls, such that nothing is allocated
+ * while the particle and body counts stay the same.
+ */
+template <typename State = FreeFloatingRigidBodiesState<>>
+class RigidBodiesStateArray
+{
+public:
+    enum
+    {
+        BODY_SIZE = State::BODY_SIZE,
+        POSITION_INDEX = PoseVector::POSITION_INDEX,
+        ORIENTATION_INDEX = PoseVector::EULER_VECTOR_INDEX
+    };
+
+    typedef Eigen::Array<Real, Eigen::Dynamic, Eigen::Dynamic> Columns;
+    typedef Eigen::Array<State, Eigen::Dynamic, 1> StateArray;
+    typedef PoseVector::Affine Affine;
+
+public:
+    RigidBodiesStateArray() : body_count_(0) {}
+
+    /**
+     * \brief Resizes to size particles of body_count bodies, the content is
+     *        undefined afterwards if either changed
+     */
+    void resize(int size, int body_count)
+    {
+        body_count_ = body_count;
+        if (columns_.rows() == size &&
+            columns_.cols() == body_count * BODY_SIZE)
+        {
+            return;
+        }
+        columns_.resize(size, body_count * BODY_SIZE);
+    }
+
+    int size() const { return columns_.rows(); }
+    int count() const { return body_count_; }
+    /**
+     * \brief Particles in the rows, coordinates in the columns
+     */
+    Columns& columns() { return columns_; }
+    const Columns& columns() const { return columns_; }
+    /**
+     * \brief Copies the states into the columns
+     */
+    void gather(const StateArray& states) { gather(states, 0, states.size()); }
+    /**
+     * \brief Copies the count states starting at begin into the columns
+     */
+    void gather(const StateArray& states, int begin, int count)
+    {
+        resize(count, count > 0 ? states[begin].count() : 0);
+        for (int i = 0; i < count; i++)
+        {
+            columns_.row(i) = states[begin + i].transpose().array();
+        }
+    }
+
+    /**
+     * \brief Copies particle i out of the columns
+     */
+    void get(int i, State& state) const
+    {
+        state = columns_.row(i).transpose().matrix();
+    }
+
+    /**
+     * \brief Weighted mean of the particles, the Euler vectors are averaged
+     *        like all other coordinates
+     */
+    template <typename Weights>
+    State mean(const Eigen::ArrayBase<Weights>& weights) const
+    {
+        State mean(body_count_);
+        mean = columns_.matrix().transpose() * weights.matrix();
+        return mean;
+    }
+
+    /**
+     * \brief Expresses the poses of all particles relative to the given mean,
+     *        see PoseBase::subtract(). The velocities are not changed.
+     */
+    void subtract(const State& mean)
+    {
+        positions_.resize(size(), 3);
+        for (int body = 0; body < body_count_; body++)
+        {
+            const PoseVelocityVector m = mean.component(body);
+            const int column = body * BODY_SIZE;
+
+            auto positions =
+                columns_.template middleCols<3>(column + POSITION_INDEX);
+            positions_.noalias() =
+                (positions.matrix().rowwise() - m.position().transpose()) *
+                m.orientation().rotation_matrix();
+            positions = positions_.array();
+
+            to_quaternions(column + ORIENTATION_INDEX, quaternions_);
+            left_multiply(m.orientation().inverse().quaternion(),
+                          quaternions_,
+                          products_);
+            from_quaternions(products_, column + ORIENTATION_INDEX);
+        }
+    }
+
+    /**
+     * \brief Composes the particles, which are deltas, with the reference
+     *        poses of the bodies, see PoseBase::apply_delta(). The composed
+     *        poses are read with affine().
+     */
+    void expand(const State& reference)
+    {
+        expanded_positions_.resize(size(), 3 * body_count_);
+        expanded_quaternions_.resize(size(), 4 * body_count_);
+        references_.resize(body_count_);
+        for (int body = 0; body < body_count_; body++)
+        {
+            const ReferencePose& pose_0 =
+                reference_pose(body, reference.component(body).pose());
+            const int column = body * BODY_SIZE;
+
+            auto positions =
+                expanded_positions_.template middleCols<3>(3 * body);
+            positions.matrix().noalias() =
+                columns_.template middleCols<3>(column + POSITION_INDEX)
+                    .matrix() *
+                pose_0.rotation.transpose();
+            positions.matrix().rowwise() += pose_0.pose.position().transpose();
+
+            to_quaternions(column + ORIENTATION_INDEX, quaternions_);
+            left_multiply(pose_0.quaternion, quaternions_, products_);
+            expanded_quaternions_.template middleCols<4>(4 * body) = products_;
+        }
+    }
+
+    /**
+     * \brief Pose of the body of particle i composed by the last expand()
+     */
+    Affine affine(int i, int body) const
+    {
+        Affine A;
+        A.matrix() = homogeneous<Real>(i, body);
+        return A;
+    }
+
+    /**
+     * \brief Homogeneous matrix of the pose of the body of particle i
+     *        composed by the last expand(), written directly in the given
+     *        precision, e.g. float for the renderers
+     */
+    template <typename Scalar>
+    Eigen::Matrix<Scalar, 4, 4> homogeneous(int i, int body) const
+    {
+        const Real w = expanded_quaternions_(i, 4 * body);
+        const Real x = expanded_quaternions_(i, 4 * body + 1);
+        const Real y = expanded_quaternions_(i, 4 * body + 2);
+        const Real z = expanded_quaternions_(i, 4 * body + 3);
+
+        // rotation matrix of the unit quaternion, see Quaternion::
+        // toRotationMatrix()
+        const Real tx = 2 * x, ty = 2 * y, tz = 2 * z;
+        const Real twx = tx * w, twy = ty * w, twz = tz * w;
+        const Real txx = tx * x, txy = ty * x, txz = tz * x;
+        const Real tyy = ty * y, tyz = tz * y, tzz = tz * z;
+
+        Eigen::Matrix<Scalar, 4, 4> H;
+        H << Scalar(1 - (tyy + tzz)), Scalar(txy - twz), Scalar(txz + twy),
+            Scalar(expanded_positions_(i, 3 * body)),
+            Scalar(txy + twz), Scalar(1 - (txx + tzz)), Scalar(tyz - twx),
+            Scalar(expanded_positions_(i, 3 * body + 1)),
+            Scalar(txz - twy), Scalar(tyz + twx), Scalar(1 - (txx + tyy)),
+            Scalar(expanded_positions_(i, 3 * body + 2)),
+            0, 0, 0, 1;
+        return H;
+    }
+
+private:
+    typedef Eigen::Array<Real, Eigen::Dynamic, 4> Quaternions;
+
+    /**
+     * \brief Reference pose of a body with its rotation, which is only
+     *        converted again when the pose changes
+     */
+    struct ReferencePose
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        ReferencePose() : valid(false) {}
+        bool valid;
+        PoseVector pose;
+        Eigen::Matrix<Real, 3, 3> rotation;
+        Eigen::Quaternion<Real> quaternion;
+    };
+
+    template <typename Pose>
+    const ReferencePose& reference_pose(int body, const Pose& pose)
+    {
+        ReferencePose& reference = references_[body];
+        if (!reference.valid || reference.pose != pose)
+        {
+            reference.valid = true;
+            reference.pose = pose;
+            reference.quaternion = reference.pose.orientation().quaternion();
+            reference.rotation = reference.quaternion.toRotationMatrix();
+        }
+        return reference;
+    }
+
+    /**
+     * \brief Quaternions (w, x, y, z) of the Euler vectors in the three
+     *        columns starting at column
+     */
+    void to_quaternions(int column, Quaternions& q)
+    {
+        const auto x = columns_.col(column);
+        const auto y = columns_.col(column + 1);
+        const auto z = columns_.col(column + 2);
+
+        angles_ = (x.square() + y.square() + z.square()).sqrt();
+        // sin(angle / 2) / angle tends to 1 / 2 for small angles
+        scales_ =
+            (angles_ > 1e-12).select((0.5 * angles_).sin() / angles_, 0.5);
+
+        q.resize(size(), 4);
+        q.col(0) = (0.5 * angles_).cos();
+        q.col(1) = x * scales_;
+        q.col(2) = y * scales_;
+        q.col(3) = z * scales_;
+    }
+
+    /**
+     * \brief Euler vectors of the quaternions written to the three columns
+     *        starting at column, the angles are in [0, pi] like those of
+     *        EulerBase::quaternion(const Quaternion&)
+     */
+    void from_quaternions(const Quaternions& q, int column)
+    {
+        angles_ = (q.col(1).square() + q.col(2).square() + q.col(3).square())
+                      .sqrt();
+
+        // asin is accurate for small angles, acos for those close to pi
+        scales_ = (angles_ < 0.7).select(2 * angles_.asin(),
+                                         2 * q.col(0).abs().acos());
+        scales_ = (angles_ > 1e-12).select(scales_ / angles_, 2.);
+        scales_ = (q.col(0) < 0).select(-scales_, scales_);
+
+        columns_.col(column) = q.col(1) * scales_;
+        columns_.col(column + 1) = q.col(2) * scales_;
+        columns_.col(column + 2) = q.col(3) * scales_;
+    }
+
+    /**
+     * \brief Hamilton products p * q of a constant quaternion p with every
+     *        row of q, which is linear in q
+     */
+    static void left_multiply(const Eigen::Quaternion<Real>& p,
+                              const Quaternions& q,
+                              Quaternions& products)
+    {
+        Eigen::Matrix<Real, 4, 4> L;
+        L << p.w(), p.x(), p.y(), p.z(),
+             -p.x(), p.w(), p.z(), -p.y(),
+             -p.y(), -p.z(), p.w(), p.x(),
+             -p.z(), p.y(), -p.x(), p.w();
+
+        products.resize(q.rows(), 4);
+        products.matrix().noalias() = q.matrix() * L;
+    }
+
+    int body_count_;
+    Columns columns_;
+
+    // workspace
+    Eigen::Matrix<Real, Eigen::Dynamic, 3> positions_;
+    Quaternions quaternions_;
+    Quaternions products_;
+    Eigen::Array<Real, Eigen::Dynamic, 1> angles_;
+    Eigen::Array<Real, Eigen::Dynamic, 1> scales_;
+    Eigen::Array<Real, Eigen::Dynamic, Eigen::Dynamic> expanded_positions_;
+    Eigen::Array<Real, Eigen::Dynamic, Eigen::Dynamic> expanded_quaternions_;
+    std::vector<ReferencePose, Eigen::aligned_allocator<ReferencePose>>
+        references_;
+};
+}
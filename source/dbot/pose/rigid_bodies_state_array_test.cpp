@@ -0,0 +1,190 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_bodies_state_array_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/pose/rigid_bodies_state_array.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::RigidBodiesStateArray<State> StateArray;
+
+namespace
+{
+StateArray::StateArray random_states(int size, int body_count)
+{
+    StateArray::StateArray states(size);
+    for (int i = 0; i < size; i++)
+    {
+        states[i] = State(body_count);
+        states[i].setRandom();
+        // include rotations beyond pi / 2 and close to pi
+        for (int body = 0; body < body_count; body++)
+        {
+            states[i].component(body).orientation() *= 3.;
+            states[i].component(body).orientation().rescale();
+        }
+    }
+    return states;
+}
+}
+
+TEST(RigidBodiesStateArrayTests, gather_and_get_round_trip)
+{
+    const StateArray::StateArray states = random_states(5, 2);
+
+    StateArray array;
+    array.gather(states);
+    EXPECT_EQ(5, array.size());
+    EXPECT_EQ(2, array.count());
+
+    State state;
+    for (int i = 0; i < states.size(); i++)
+    {
+        array.get(i, state);
+        EXPECT_TRUE(state.isApprox(states[i]));
+    }
+}
+
+TEST(RigidBodiesStateArrayTests, mean_is_the_weighted_sum)
+{
+    const StateArray::StateArray states = random_states(7, 2);
+    Eigen::Array<dbot::Real, -1, 1> weights(states.size());
+    weights.setRandom();
+    weights = weights.abs();
+    weights /= weights.sum();
+
+    State expected(2);
+    expected.setZero();
+    for (int i = 0; i < states.size(); i++)
+    {
+        expected += weights[i] * states[i];
+    }
+
+    StateArray array;
+    array.gather(states);
+    EXPECT_TRUE(array.mean(weights).isApprox(expected));
+}
+
+TEST(RigidBodiesStateArrayTests, subtract_matches_the_states)
+{
+    StateArray::StateArray states = random_states(50, 3);
+    State mean(3);
+    mean.setRandom();
+
+    StateArray array;
+    array.gather(states);
+    array.subtract(mean);
+
+    State state;
+    for (int i = 0; i < states.size(); i++)
+    {
+        states[i].subtract(mean);
+        array.get(i, state);
+        for (int body = 0; body < 3; body++)
+        {
+            EXPECT_TRUE(state.component(body).position().isApprox(
+                states[i].component(body).position(), 1e-9));
+            // equal Euler vectors up to the representation of pi rotations
+            EXPECT_TRUE(
+                state.component(body).orientation().rotation_matrix().isApprox(
+                    states[i].component(body).orientation().rotation_matrix(),
+                    1e-9));
+            EXPECT_TRUE(state.component(body).linear_velocity().isApprox(
+                states[i].component(body).linear_velocity()));
+        }
+    }
+}
+
+TEST(RigidBodiesStateArrayTests, expand_composes_with_the_reference)
+{
+    const StateArray::StateArray deltas = random_states(50, 2);
+    State reference(2);
+    reference.setRandom();
+
+    StateArray array;
+    array.gather(deltas);
+    array.expand(reference);
+
+    for (int i = 0; i < deltas.size(); i++)
+    {
+        for (int body = 0; body < 2; body++)
+        {
+            dbot::PoseVector pose = reference.component(body).pose();
+            pose.apply_delta(deltas[i].component(body).pose());
+
+            EXPECT_TRUE(array.affine(i, body).matrix().isApprox(
+                pose.affine().matrix(), 1e-9));
+        }
+    }
+}
+
+TEST(RigidBodiesStateArrayTests, expand_follows_a_changed_reference)
+{
+    const StateArray::StateArray deltas = random_states(10, 1);
+    State reference(1);
+    reference.setRandom();
+
+    StateArray array;
+    array.gather(deltas);
+    array.expand(reference);
+
+    // the cached rotation of the reference must not be reused
+    reference.component(0).orientation() *= -0.5;
+    array.expand(reference);
+
+    dbot::PoseVector pose = reference.component(0).pose();
+    pose.apply_delta(deltas[3].component(0).pose());
+    EXPECT_TRUE(
+        array.affine(3, 0).matrix().isApprox(pose.affine().matrix(), 1e-9));
+}
+
+TEST(RigidBodiesStateArrayTests, homogeneous_matches_the_affine_pose)
+{
+    const StateArray::StateArray deltas = random_states(10, 2);
+    State reference(2);
+    reference.setRandom();
+
+    StateArray array;
+    array.gather(deltas);
+    array.expand(reference);
+
+    for (int i = 0; i < deltas.size(); i++)
+    {
+        for (int body = 0; body < 2; body++)
+        {
+            const Eigen::Matrix4f expected =
+                array.affine(i, body).matrix().cast<float>();
+            EXPECT_TRUE(array.homogeneous<float>(i, body).isApprox(expected));
+        }
+    }
+}
+
+TEST(RigidBodiesStateArrayTests, euler_quaternion_matches_the_angle_axis)
+{
+    const StateArray::StateArray states = random_states(20, 1);
+    for (int i = 0; i < states.size(); i++)
+    {
+        const dbot::EulerVector v = states[i].component(0).orientation();
+        const Eigen::Quaterniond expected(Eigen::AngleAxisd(v.angle(),
+                                                            v.axis()));
+        EXPECT_TRUE(v.quaternion().coeffs().isApprox(expected.coeffs()));
+    }
+
+    EXPECT_TRUE(dbot::EulerVector().quaternion().coeffs().isApprox(
+        Eigen::Quaterniond::Identity().coeffs()));
+}
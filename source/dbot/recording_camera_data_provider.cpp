@@ -0,0 +1,145 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file recording_camera_data_provider.cpp
+ * \date October 2026
+ */
+
+#include <dbot/recording_camera_data_provider.h>
+
+namespace dbot
+{
+namespace
+{
+DepthSequenceInfo provider_info(const CameraDataProvider& data_provider)
+{
+    DepthSequenceInfo info;
+    info.frame_id = data_provider.frame_id();
+    info.camera_matrix = data_provider.camera_matrix();
+    info.native_resolution = data_provider.native_resolution();
+    info.downsampling_factor = data_provider.downsampling_factor();
+    return info;
+}
+}
+
+RecordingCameraDataProvider::RecordingCameraDataProvider(
+    const std::shared_ptr<CameraDataProvider>& data_provider,
+    const std::string& path,
+    DepthSequenceWriter::Compression compression)
+    : data_provider_(data_provider),
+      start_(std::chrono::steady_clock::now()),
+      writer_(path, provider_info(*data_provider), compression),
+      recorded_native_(-1)
+{
+}
+
+Eigen::MatrixXd RecordingCameraDataProvider::depth_image() const
+{
+    return data_provider_->depth_image();
+}
+
+Eigen::VectorXd RecordingCameraDataProvider::depth_image_vector() const
+{
+    return data_provider_->depth_image_vector();
+}
+
+DepthFrame::ConstPtr RecordingCameraDataProvider::depth_frame() const
+{
+    DepthFrame::ConstPtr frame = data_provider_->depth_frame();
+
+    // native frames are recorded when CameraData requests them
+    if (!frame && data_provider_->native_depth_frame()) return frame;
+
+    if (!frame)
+    {
+        const Eigen::VectorXd image = data_provider_->depth_image_vector();
+        const CameraData::Resolution resolution = native_resolution();
+        int rows = resolution.height / downsampling_factor();
+        int cols = resolution.width / downsampling_factor();
+        if (rows * cols != image.size())
+        {
+            rows = image.size();
+            cols = 1;
+        }
+
+        DepthFrame::Ptr converted = frame_pool_.acquire(rows, cols);
+        Eigen::Map<Eigen::VectorXf>(converted->data(), image.size()) =
+            image.cast<float>();
+        frame = converted;
+    }
+
+    record(frame, false);
+    return frame;
+}
+
+DepthFrame::ConstPtr RecordingCameraDataProvider::native_depth_frame() const
+{
+    DepthFrame::ConstPtr frame = data_provider_->native_depth_frame();
+    if (frame) record(frame, true);
+    return frame;
+}
+
+Eigen::Matrix3d RecordingCameraDataProvider::camera_matrix() const
+{
+    return data_provider_->camera_matrix();
+}
+
+std::string RecordingCameraDataProvider::frame_id() const
+{
+    return data_provider_->frame_id();
+}
+
+int RecordingCameraDataProvider::downsampling_factor() const
+{
+    return data_provider_->downsampling_factor();
+}
+
+CameraData::Resolution RecordingCameraDataProvider::native_resolution() const
+{
+    return data_provider_->native_resolution();
+}
+
+void RecordingCameraDataProvider::frame_allocator(
+    const DepthFramePool::Allocator& allocator)
+{
+    frame_pool_.allocator(allocator);
+    data_provider_->frame_allocator(allocator);
+}
+
+size_t RecordingCameraDataProvider::frame_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writer_.frame_count();
+}
+
+void RecordingCameraDataProvider::record(const DepthFrame::ConstPtr& frame,
+                                         bool native) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (recorded_native_ < 0) recorded_native_ = native;
+    if (recorded_native_ != int(native) || frame == last_frame_) return;
+
+    double timestamp = frame->timestamp();
+    if (timestamp == 0)
+    {
+        timestamp = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start_)
+                        .count();
+    }
+
+    writer_.write(*frame, timestamp);
+    last_frame_ = frame;
+}
+}
@@ -0,0 +1,79 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file recording_camera_data_provider.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <dbot/camera_data_provider.h>
+#include <dbot/depth_sequence.h>
+
+namespace dbot
+{
+/**
+ * \brief Passes the data of another provider through and records every depth
+ *        frame it hands out into a sequence file for
+ *        ReplayCameraDataProvider
+ *
+ * A frame is recorded once however often it is requested. Only one stream is
+ * recorded: native frames if the first recorded frame came from
+ * native_depth_frame(), downsampled frames otherwise. Frames of providers
+ * without frame support are converted from depth_image_vector() by
+ * depth_frame() and recorded on every call. Frames without timestamp are
+ * stamped with the time since the provider was created.
+ */
+class RecordingCameraDataProvider : public CameraDataProvider
+{
+public:
+    RecordingCameraDataProvider(
+        const std::shared_ptr<CameraDataProvider>& data_provider,
+        const std::string& path,
+        DepthSequenceWriter::Compression compression =
+            DepthSequenceWriter::NO_COMPRESSION);
+
+    virtual Eigen::MatrixXd depth_image() const;
+    virtual Eigen::VectorXd depth_image_vector() const;
+    virtual DepthFrame::ConstPtr depth_frame() const;
+    virtual DepthFrame::ConstPtr native_depth_frame() const;
+    virtual Eigen::Matrix3d camera_matrix() const;
+    virtual std::string frame_id() const;
+    virtual int downsampling_factor() const;
+    virtual CameraData::Resolution native_resolution() const;
+    virtual void frame_allocator(const DepthFramePool::Allocator& allocator);
+
+    /**
+     * \brief Number of frames recorded so far
+     */
+    size_t frame_count() const;
+
+private:
+    void record(const DepthFrame::ConstPtr& frame, bool native) const;
+
+    std::shared_ptr<CameraDataProvider> data_provider_;
+    std::chrono::steady_clock::time_point start_;
+
+    mutable std::mutex mutex_;
+    mutable DepthSequenceWriter writer_;
+    mutable DepthFrame::ConstPtr last_frame_;
+    mutable int recorded_native_;
+    mutable DepthFramePool frame_pool_;
+};
+}
@@ -0,0 +1,164 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file region_of_interest.cpp
+ * \date October 2026
+ */
+
+#include <dbot/region_of_interest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace dbot
+{
+namespace
+{
+/// closest distance to the camera which is projected
+const double min_depth = 1e-3;
+
+int clamp(int value, int min, int max)
+{
+    return std::min(std::max(value, min), max);
+}
+}
+
+RegionOfInterest::RegionOfInterest(int image_rows,
+                                   int image_cols,
+                                   int rows,
+                                   int cols,
+                                   int margin)
+    : image_rows_(image_rows),
+      image_cols_(image_cols),
+      margin_(std::max(margin, 0))
+{
+    region_.rows = clamp(rows, 1, image_rows_);
+    region_.cols = clamp(cols, 1, image_cols_);
+    region_.row = (image_rows_ - region_.rows) / 2;
+    region_.col = (image_cols_ - region_.cols) / 2;
+}
+
+bool RegionOfInterest::follow(const PixelRegion& footprint)
+{
+    if (footprint.empty()) return false;
+
+    // the margin beyond the image is not needed
+    PixelRegion grown;
+    grown.row = std::max(footprint.row - margin_, 0);
+    grown.col = std::max(footprint.col - margin_, 0);
+    grown.rows =
+        std::min(footprint.row + footprint.rows + margin_, image_rows_) -
+        grown.row;
+    grown.cols =
+        std::min(footprint.col + footprint.cols + margin_, image_cols_) -
+        grown.col;
+    if (region_.contains(grown)) return false;
+
+    const int row = clamp(grown.row + (grown.rows - region_.rows) / 2,
+                          0,
+                          image_rows_ - region_.rows);
+    const int col = clamp(grown.col + (grown.cols - region_.cols) / 2,
+                          0,
+                          image_cols_ - region_.cols);
+    if (row == region_.row && col == region_.col) return false;
+
+    region_.row = row;
+    region_.col = col;
+    return true;
+}
+
+PixelRegion RegionOfInterest::footprint(
+    const std::vector<Eigen::AlignedBox3d>& part_boxes,
+    const Poses& poses,
+    const Eigen::Matrix3d& camera_matrix) const
+{
+    double min_u = std::numeric_limits<double>::infinity();
+    double min_v = std::numeric_limits<double>::infinity();
+    double max_u = -std::numeric_limits<double>::infinity();
+    double max_v = -std::numeric_limits<double>::infinity();
+
+    const size_t part_count = std::min(part_boxes.size(), poses.size());
+    for (size_t i = 0; i < part_count; i++)
+    {
+        if (part_boxes[i].isEmpty()) continue;
+        for (int k = 0; k < 8; k++)
+        {
+            const Eigen::Vector3d corner = poses[i] * part_boxes[i].corner(
+                Eigen::AlignedBox3d::CornerType(k));
+            if (corner.z() < min_depth) return PixelRegion();
+
+            const Eigen::Vector3d pixel = camera_matrix * corner;
+            const double u = pixel.x() / pixel.z();
+            const double v = pixel.y() / pixel.z();
+            min_u = std::min(min_u, u);
+            min_v = std::min(min_v, v);
+            max_u = std::max(max_u, u);
+            max_v = std::max(max_v, v);
+        }
+    }
+    if (!(min_u <= max_u)) return PixelRegion();
+
+    // pixel centers are at integer coordinates
+    PixelRegion footprint;
+    footprint.col = std::max(int(std::floor(min_u + 0.5)), 0);
+    footprint.row = std::max(int(std::floor(min_v + 0.5)), 0);
+    footprint.cols =
+        std::min(int(std::floor(max_u + 0.5)) + 1, image_cols_) -
+        footprint.col;
+    footprint.rows =
+        std::min(int(std::floor(max_v + 0.5)) + 1, image_rows_) -
+        footprint.row;
+    return footprint.empty() ? PixelRegion() : footprint;
+}
+
+Eigen::Matrix3d RegionOfInterest::camera_matrix(
+    const Eigen::Matrix3d& camera_matrix) const
+{
+    Eigen::Matrix3d region_camera_matrix = camera_matrix;
+    region_camera_matrix(0, 2) -= region_.col;
+    region_camera_matrix(1, 2) -= region_.row;
+    return region_camera_matrix;
+}
+
+void RegionOfInterest::crop(const float* image, int scale, float* region) const
+{
+    const int image_cols = image_cols_ * scale;
+    const int cols = region_.cols * scale;
+    const int first_row = region_.row * scale;
+    const float* source = image + first_row * image_cols + region_.col * scale;
+    for (int row = 0; row < region_.rows * scale; row++)
+    {
+        std::memcpy(region + row * cols,
+                    source + row * image_cols,
+                    cols * sizeof(float));
+    }
+}
+
+std::vector<Eigen::AlignedBox3d> RegionOfInterest::part_boxes(
+    const TriangleMesh& mesh)
+{
+    std::vector<Eigen::AlignedBox3d> boxes(mesh.count_parts());
+    for (int part = 0; part < mesh.count_parts(); part++)
+    {
+        const TriangleMesh::VertexMatrix vertices = mesh.vertices(part);
+        for (int i = 0; i < vertices.cols(); i++)
+        {
+            boxes[part].extend(vertices.col(i).cast<double>());
+        }
+    }
+    return boxes;
+}
+}
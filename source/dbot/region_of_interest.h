@@ -0,0 +1,125 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file region_of_interest.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include <dbot/triangle_mesh.h>
+
+namespace dbot
+{
+/**
+ * \brief Rectangle of pixels, row and col are its top left pixel
+ */
+struct PixelRegion
+{
+    int row = 0;
+    int col = 0;
+    int rows = 0;
+    int cols = 0;
+
+    bool empty() const { return rows <= 0 || cols <= 0; }
+    bool contains(const PixelRegion& other) const
+    {
+        return other.row >= row && other.col >= col &&
+               other.row + other.rows <= row + rows &&
+               other.col + other.cols <= col + cols;
+    }
+};
+
+/**
+ * \brief Window of fixed size which follows the object through the image
+ *
+ * The sensors evaluate the poses only within the window, such that they
+ * render rows x cols tiles instead of whole images. The window stays in
+ * place while the footprint of the object, i.e. the bounding rectangle of
+ * its projection at the integrated poses, plus the margin lies within it.
+ * Otherwise it is centered on the footprint. The margin therefore covers
+ * the motion of the object between two frames and the spread of the
+ * particles around the integrated poses. Parts of the object beyond the
+ * window are not evaluated, its size should exceed the largest footprint.
+ */
+class RegionOfInterest
+{
+public:
+    typedef Eigen::Transform<double, 3, Eigen::Affine> Affine;
+    typedef std::vector<Affine, Eigen::aligned_allocator<Affine>> Poses;
+
+public:
+    /**
+     * \param image_rows, image_cols  resolution of the sensor images
+     * \param rows, cols              size of the window, clamped to the image
+     * \param margin                  pixels around the footprint
+     */
+    RegionOfInterest(int image_rows,
+                     int image_cols,
+                     int rows,
+                     int cols,
+                     int margin);
+
+    const PixelRegion& region() const { return region_; }
+    int margin() const { return margin_; }
+    /**
+     * \brief Moves the window onto the footprint if the footprint plus the
+     *        margin left it, an empty footprint is ignored
+     *
+     * \return whether the window moved
+     */
+    bool follow(const PixelRegion& footprint);
+
+    /**
+     * \brief Bounding rectangle of the projections of the part boxes at the
+     *        poses of the parts, clamped to the image. It is empty if the
+     *        object is outside of the image or not entirely in front of the
+     *        camera.
+     */
+    PixelRegion footprint(const std::vector<Eigen::AlignedBox3d>& part_boxes,
+                          const Poses& poses,
+                          const Eigen::Matrix3d& camera_matrix) const;
+
+    /**
+     * \brief Camera matrix of the window, i.e. the principal point of the
+     *        camera matrix of the image relative to the window
+     */
+    Eigen::Matrix3d camera_matrix(const Eigen::Matrix3d& camera_matrix) const;
+
+    /**
+     * \brief Copies the window out of an image whose resolution is scale
+     *        times the one of the sensor images, row by row
+     *
+     * \param region  rows * cols * scale^2 values
+     */
+    void crop(const float* image, int scale, float* region) const;
+
+    /**
+     * \brief Bounding boxes of the vertices of every part in its own frame
+     */
+    static std::vector<Eigen::AlignedBox3d> part_boxes(
+        const TriangleMesh& mesh);
+
+private:
+    int image_rows_;
+    int image_cols_;
+    int margin_;
+    PixelRegion region_;
+};
+}
@@ -0,0 +1,119 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file region_of_interest_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/region_of_interest.h>
+
+namespace
+{
+dbot::PixelRegion make_region(int row, int col, int rows, int cols)
+{
+    dbot::PixelRegion region;
+    region.row = row;
+    region.col = col;
+    region.rows = rows;
+    region.cols = cols;
+    return region;
+}
+}
+
+TEST(RegionOfInterestTests, starts_centered_and_clamped_to_the_image)
+{
+    dbot::RegionOfInterest roi(120, 160, 40, 400, 5);
+
+    EXPECT_EQ(40, roi.region().row);
+    EXPECT_EQ(0, roi.region().col);
+    EXPECT_EQ(40, roi.region().rows);
+    EXPECT_EQ(160, roi.region().cols);
+}
+
+TEST(RegionOfInterestTests, stays_while_the_footprint_fits)
+{
+    dbot::RegionOfInterest roi(120, 160, 40, 60, 5);
+    const dbot::PixelRegion region = roi.region();
+
+    EXPECT_FALSE(roi.follow(make_region(50, 60, 20, 30)));
+    EXPECT_EQ(region.row, roi.region().row);
+    EXPECT_EQ(region.col, roi.region().col);
+
+    // empty footprints are ignored
+    EXPECT_FALSE(roi.follow(dbot::PixelRegion()));
+}
+
+TEST(RegionOfInterestTests, centers_on_a_footprint_which_left)
+{
+    dbot::RegionOfInterest roi(120, 160, 40, 60, 5);
+
+    EXPECT_TRUE(roi.follow(make_region(10, 12, 20, 30)));
+    EXPECT_EQ(0, roi.region().row);
+    EXPECT_EQ(0, roi.region().col);
+
+    EXPECT_TRUE(roi.follow(make_region(90, 120, 20, 30)));
+    EXPECT_EQ(80, roi.region().row);
+    EXPECT_EQ(100, roi.region().col);
+    EXPECT_TRUE(roi.region().contains(make_region(85, 115, 30, 40)));
+}
+
+TEST(RegionOfInterestTests, footprint_covers_the_projected_boxes)
+{
+    dbot::RegionOfInterest roi(120, 160, 40, 60, 0);
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << 100, 0, 80, 0, 100, 60, 0, 0, 1;
+
+    std::vector<Eigen::AlignedBox3d> boxes(1);
+    boxes[0].extend(Eigen::Vector3d(-0.1, -0.05, -0.1));
+    boxes[0].extend(Eigen::Vector3d(0.1, 0.05, 0.1));
+
+    dbot::RegionOfInterest::Poses poses(
+        1, dbot::RegionOfInterest::Affine::Identity());
+    poses[0].translation() = Eigen::Vector3d(0, 0, 1.1);
+
+    // the near face at 1 m spans 20 x 10 pixels around the principal point
+    const dbot::PixelRegion footprint =
+        roi.footprint(boxes, poses, camera_matrix);
+    EXPECT_EQ(55, footprint.row);
+    EXPECT_EQ(70, footprint.col);
+    EXPECT_EQ(11, footprint.rows);
+    EXPECT_EQ(21, footprint.cols);
+
+    poses[0].translation() = Eigen::Vector3d(0, 0, 0.05);
+    EXPECT_TRUE(roi.footprint(boxes, poses, camera_matrix).empty());
+}
+
+TEST(RegionOfInterestTests, crop_and_camera_matrix_share_the_offset)
+{
+    dbot::RegionOfInterest roi(4, 6, 2, 3, 0);
+    roi.follow(make_region(2, 3, 2, 3));
+    ASSERT_EQ(2, roi.region().row);
+    ASSERT_EQ(3, roi.region().col);
+
+    std::vector<float> image(4 * 6 * 4);
+    for (size_t i = 0; i < image.size(); i++) image[i] = i;
+
+    // at twice the resolution
+    std::vector<float> region(2 * 3 * 4);
+    roi.crop(image.data(), 2, region.data());
+    EXPECT_EQ(4 * 12 + 6, region[0]);
+    EXPECT_EQ(7 * 12 + 11, region.back());
+
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << 10, 0, 3, 0, 10, 2, 0, 0, 1;
+    EXPECT_EQ(0, roi.camera_matrix(camera_matrix)(0, 2));
+    EXPECT_EQ(0, roi.camera_matrix(camera_matrix)(1, 2));
+}
@@ -0,0 +1,144 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file replay_camera_data_provider.cpp
+ * \date October 2026
+ */
+
+#include <thread>
+
+#include <dbot/replay_camera_data_provider.h>
+
+namespace dbot
+{
+ReplayCameraDataProvider::ReplayCameraDataProvider(const std::string& path,
+                                                   Pacing pacing)
+    : reader_(path),
+      pacing_(pacing),
+      index_(reader_.frame_count()),
+      next_index_(0)
+{
+}
+
+bool ReplayCameraDataProvider::next()
+{
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (next_index_ >= reader_.frame_count())
+        {
+            index_ = reader_.frame_count();
+            frame_.reset();
+            return false;
+        }
+        index = next_index_++;
+        if (index == 0) start_ = std::chrono::steady_clock::now();
+    }
+
+    if (pacing_ == REAL_TIME)
+    {
+        const double offset = reader_.timestamp(index) - reader_.timestamp(0);
+        std::this_thread::sleep_until(
+            start_ + std::chrono::duration_cast<
+                         std::chrono::steady_clock::duration>(
+                         std::chrono::duration<double>(offset)));
+    }
+
+    DepthFrame::ConstPtr frame = reader_.frame(index);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_ = index;
+    frame_ = frame;
+    return true;
+}
+
+void ReplayCameraDataProvider::rewind()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_ = reader_.frame_count();
+    next_index_ = 0;
+    frame_.reset();
+}
+
+size_t ReplayCameraDataProvider::frame_index() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_;
+}
+
+DepthFrame::ConstPtr ReplayCameraDataProvider::current_frame() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frame_;
+}
+
+Eigen::MatrixXd ReplayCameraDataProvider::depth_image() const
+{
+    DepthFrame::ConstPtr frame = current_frame();
+    if (!frame) return Eigen::MatrixXd();
+    return frame->image().cast<double>();
+}
+
+Eigen::VectorXd ReplayCameraDataProvider::depth_image_vector() const
+{
+    DepthFrame::ConstPtr frame = current_frame();
+    if (!frame) return Eigen::VectorXd();
+    return frame->vector().cast<double>();
+}
+
+DepthFrame::ConstPtr ReplayCameraDataProvider::depth_frame() const
+{
+    DepthFrame::ConstPtr frame = current_frame();
+    const CameraData::Resolution resolution = native_resolution();
+    if (frame &&
+        frame->rows() == resolution.height / downsampling_factor() &&
+        frame->cols() == resolution.width / downsampling_factor())
+    {
+        return frame;
+    }
+    return DepthFrame::ConstPtr();
+}
+
+DepthFrame::ConstPtr ReplayCameraDataProvider::native_depth_frame() const
+{
+    DepthFrame::ConstPtr frame = current_frame();
+    const CameraData::Resolution resolution = native_resolution();
+    if (frame && frame->rows() == resolution.height &&
+        frame->cols() == resolution.width)
+    {
+        return frame;
+    }
+    return DepthFrame::ConstPtr();
+}
+
+Eigen::Matrix3d ReplayCameraDataProvider::camera_matrix() const
+{
+    return reader_.info().camera_matrix;
+}
+
+std::string ReplayCameraDataProvider::frame_id() const
+{
+    return reader_.info().frame_id;
+}
+
+int ReplayCameraDataProvider::downsampling_factor() const
+{
+    return reader_.info().downsampling_factor;
+}
+
+CameraData::Resolution ReplayCameraDataProvider::native_resolution() const
+{
+    return reader_.info().native_resolution;
+}
+}
@@ -0,0 +1,96 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file replay_camera_data_provider.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include <dbot/camera_data_provider.h>
+#include <dbot/depth_sequence.h>
+
+namespace dbot
+{
+/**
+ * \brief Replays a depth sequence recorded by RecordingCameraDataProvider
+ *
+ * The frames are read from a memory mapping and handed out without copying
+ * unless the sequence is compressed. Frames at the native resolution are
+ * provided by native_depth_frame(), downsampled frames by depth_frame().
+ *
+ * The replay starts before the first frame, each call of next() moves to the
+ * next one:
+ *
+ * \code
+ * while (provider->next()) tracker->track(camera_data->depth_frame());
+ * \endcode
+ */
+class ReplayCameraDataProvider : public CameraDataProvider
+{
+public:
+    enum Pacing
+    {
+        /// next() returns immediately to measure the tracker throughput
+        AS_FAST_AS_POSSIBLE,
+        /// next() waits until the frame is due according to its timestamp
+        REAL_TIME
+    };
+
+public:
+    explicit ReplayCameraDataProvider(const std::string& path,
+                                      Pacing pacing = AS_FAST_AS_POSSIBLE);
+
+    /**
+     * \brief Moves to the next frame, returns false at the end of the
+     *        sequence
+     */
+    bool next();
+
+    /**
+     * \brief Restarts the replay before the first frame
+     */
+    void rewind();
+
+    size_t frame_count() const { return reader_.frame_count(); }
+
+    /// index of the current frame, frame_count() if there is none
+    size_t frame_index() const;
+
+    virtual Eigen::MatrixXd depth_image() const;
+    virtual Eigen::VectorXd depth_image_vector() const;
+    virtual DepthFrame::ConstPtr depth_frame() const;
+    virtual DepthFrame::ConstPtr native_depth_frame() const;
+    virtual Eigen::Matrix3d camera_matrix() const;
+    virtual std::string frame_id() const;
+    virtual int downsampling_factor() const;
+    virtual CameraData::Resolution native_resolution() const;
+
+private:
+    DepthFrame::ConstPtr current_frame() const;
+
+    DepthSequenceReader reader_;
+    Pacing pacing_;
+
+    mutable std::mutex mutex_;
+    size_t index_;
+    size_t next_index_;
+    DepthFrame::ConstPtr frame_;
+    std::chrono::steady_clock::time_point start_;
+};
+}
@@ -16,6 +16,8 @@
  * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
  */
 
+#include <algorithm>
+#include <cmath>
 #include <dbot/rigid_body_renderer.h>
 #include <iostream>
 #include <limits>
@@ -25,10 +27,39 @@ using namespace Eigen;
 
 using namespace dbot;
 
+RigidBodyRenderer::RigidBodyRenderer(const TriangleMesh::ConstPtr& mesh,
+                                     RasterizationMode rasterization_mode)
+    : n_rows_(0),
+      n_cols_(0),
+      meshes_(1, mesh),
+      rasterization_mode_(rasterization_mode)
+{
+    camera_matrix_.setZero();
+    init();
+}
+
+RigidBodyRenderer::RigidBodyRenderer(const TriangleMesh::ConstPtr& mesh,
+                                     Matrix camera_matrix,
+                                     int n_rows,
+                                     int n_cols,
+                                     RasterizationMode rasterization_mode)
+    : camera_matrix_(camera_matrix),
+      n_rows_(n_rows),
+      n_cols_(n_cols),
+      meshes_(1, mesh),
+      rasterization_mode_(rasterization_mode)
+{
+    init();
+}
+
 RigidBodyRenderer::RigidBodyRenderer(
     const std::vector<std::vector<Eigen::Vector3d>>& vertices,
-    const std::vector<std::vector<std::vector<int>>>& indices)
-    : n_rows_(0), n_cols_(0), vertices_(vertices), indices_(indices)
+    const std::vector<std::vector<std::vector<int>>>& indices,
+    RasterizationMode rasterization_mode)
+    : n_rows_(0),
+      n_cols_(0),
+      meshes_(1, std::make_shared<TriangleMesh>(vertices, indices)),
+      rasterization_mode_(rasterization_mode)
 {
     camera_matrix_.setZero();
     init();
@@ -39,21 +70,25 @@ RigidBodyRenderer::RigidBodyRenderer(
     const std::vector<std::vector<std::vector<int>>>& indices,
     Matrix camera_matrix,
     int n_rows,
-    int n_cols)
+    int n_cols,
+    RasterizationMode rasterization_mode)
     : camera_matrix_(camera_matrix),
       n_rows_(n_rows),
       n_cols_(n_cols),
-      vertices_(vertices),
-      indices_(indices)
+      meshes_(1, std::make_shared<TriangleMesh>(vertices, indices)),
+      rasterization_mode_(rasterization_mode)
 {
     init();
 }
 
 void RigidBodyRenderer::init()
 {
+    const TriangleMesh& mesh = *meshes_[0];
+    const int part_count = mesh.count_parts();
+
     /// initialize poses *******************************************************
-    R_.resize(vertices_.size());
-    t_.resize(vertices_.size());
+    R_.resize(part_count);
+    t_.resize(part_count);
 
     for (size_t i = 0; i < R_.size(); i++)
     {
@@ -62,31 +97,81 @@ void RigidBodyRenderer::init()
     }
 
     /// compute normals ********************************************************
-    normals_.clear();
-    for (size_t part_index = 0; part_index < indices_.size(); part_index++)
+    normals_.resize(1);
+    compute_normals(mesh, true, normals_[0]);
+
+    /// bounding spheres for the level of detail selection *******************
+    part_centers_.resize(part_count);
+    part_radii_.resize(part_count);
+    for (int part_index = 0; part_index < part_count; part_index++)
     {
-        vector<Vector3d> part_normals(indices_[part_index].size());
-        for (int triangle_index = 0; triangle_index < int(part_normals.size());
+        const TriangleMesh::VertexMatrix vertices = mesh.vertices(part_index);
+        Vector center = Vector::Zero();
+        if (vertices.cols() > 0)
+        {
+            center = 0.5 * (vertices.rowwise().minCoeff() +
+                            vertices.rowwise().maxCoeff())
+                               .cast<double>();
+        }
+        part_centers_[part_index] = center;
+        part_radii_[part_index] = 0;
+        for (int i = 0; i < vertices.cols(); i++)
+        {
+            part_radii_[part_index] =
+                std::max(part_radii_[part_index],
+                         (vertices.col(i).cast<double>() - center).norm());
+        }
+    }
+
+    levels_.assign(part_count, 0);
+    visible_.assign(part_count, true);
+    ray_cast_.assign(part_count, false);
+    ray_cast_bounds_.resize(part_count);
+    // measured break even of the tiled fill at 640 x 480 pixels
+    triangles_per_pixel_ = 2;
+    if (rasterization_mode_ == RAY_CASTING ||
+        rasterization_mode_ == AUTOMATIC_RENDERING)
+    {
+        bvhs_.push_back(std::make_shared<TriangleBvh>(mesh));
+    }
+    pixels_per_triangle_ = 4;
+    single_precision_ = false;
+    back_face_culling_ = false;
+}
+
+void RigidBodyRenderer::compute_normals(const TriangleMesh& mesh,
+                                        bool check_degenerate,
+                                        std::vector<Vector>& normals)
+{
+    normals.resize(mesh.count_triangles());
+    for (int part_index = 0; part_index < mesh.count_parts(); part_index++)
+    {
+        const TriangleMesh::VertexMatrix vertices = mesh.vertices(part_index);
+        const TriangleMesh::TriangleMatrix triangles =
+            mesh.triangles(part_index);
+        Vector* part_normals = &normals[mesh.first_triangle(part_index)];
+        for (int triangle_index = 0; triangle_index < triangles.cols();
              triangle_index++)
         {
+            Vector3d corners[3];
+            for (int i = 0; i < 3; i++)
+            {
+                corners[i] =
+                    vertices.col(triangles(i, triangle_index)).cast<double>();
+            }
+
             // compute the three cross products and make sure that they yield
             // the same normal
-            vector<Vector3d> temp_normals(3);
+            Vector3d temp_normals[3];
             for (int vertex_index = 0; vertex_index < 3; vertex_index++)
                 temp_normals[vertex_index] =
-                    ((vertices_[part_index][indices_[part_index][triangle_index]
-                                                    [(vertex_index + 1) % 3]] -
-                      vertices_[part_index][indices_[part_index][triangle_index]
-                                                    [vertex_index]])
-                         .cross(vertices_[part_index]
-                                         [indices_[part_index][triangle_index]
-                                                  [(vertex_index + 2) % 3]] -
-                                vertices_[part_index]
-                                         [indices_[part_index][triangle_index]
-                                                  [(vertex_index + 1) % 3]]))
+                    ((corners[(vertex_index + 1) % 3] - corners[vertex_index])
+                         .cross(corners[(vertex_index + 2) % 3] -
+                                corners[(vertex_index + 1) % 3]))
                         .normalized();
 
-            for (int vertex_index = 0; vertex_index < 3; vertex_index++)
+            for (int vertex_index = 0; check_degenerate && vertex_index < 3;
+                 vertex_index++)
                 if (!temp_normals[vertex_index].isApprox(
                         temp_normals[(vertex_index + 1) % 3]))
                 {
@@ -101,7 +186,6 @@ void RigidBodyRenderer::init()
                 }
             part_normals[triangle_index] = temp_normals[0];
         }
-        normals_.push_back(part_normals);
     }
 }
 
@@ -114,46 +198,446 @@ RigidBodyRenderer::~RigidBodyRenderer()
 void RigidBodyRenderer::Render(Matrix camera_matrix,
                                int n_rows,
                                int n_cols,
-                               std::vector<float>& depth_image) const
+                               std::vector<float>& depth_image)
+{
+    const int part_count = count_parts();
+
+    cull_parts(camera_matrix, n_rows, n_cols, 0, part_count);
+    project(camera_matrix, n_rows, n_cols, 0, part_count);
+
+    // we find the intersections with the triangles and the depths
+    // ---------------------------------------------------
+    depth_image.assign(n_rows * n_cols, numeric_limits<float>::infinity());
+
+    rasterize(camera_matrix, n_rows, n_cols, 0, part_count, depth_image);
+}
+
+void RigidBodyRenderer::Render(Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               int part_index,
+                               DepthLayer& layer)
 {
-    Matrix3d inv_camera_matrix = camera_matrix.inverse();
+    cull_parts(camera_matrix, n_rows, n_cols, part_index, part_index + 1);
+    project(camera_matrix, n_rows, n_cols, part_index, part_index + 1);
+
+    // the layer buffer is kept at infinity between calls, only the region
+    // covered by the part is written and reset again
+    vector<float>& depth_image = layer_buffer_;
+    if (depth_image.size() != size_t(n_rows * n_cols))
+    {
+        depth_image.assign(n_rows * n_cols, numeric_limits<float>::infinity());
+    }
+
+    rasterize(
+        camera_matrix, n_rows, n_cols, part_index, part_index + 1, depth_image);
+
+    // bounding box of the projected part
+    double min_row, max_row, min_col, max_col;
+    image_bounds(
+        part_index, part_index + 1, min_row, max_row, min_col, max_col);
+
+    layer.indices.clear();
+    layer.depths.clear();
+    if (!(min_row <= max_row && min_col <= max_col)) return;
+
+    const int row_begin = std::max(0., std::ceil(min_row));
+    const int row_end = std::min(double(n_rows - 1), std::floor(max_row));
+    const int col_begin = std::max(0., std::ceil(min_col));
+    const int col_end = std::min(double(n_cols - 1), std::floor(max_col));
+
+    for (int row = row_begin; row <= row_end; row++)
+    {
+        for (int col = col_begin; col <= col_end; col++)
+        {
+            float& depth = depth_image[row * n_cols + col];
+            if (depth != numeric_limits<float>::infinity())
+            {
+                layer.indices.push_back(row * n_cols + col);
+                layer.depths.push_back(depth);
+                depth = numeric_limits<float>::infinity();
+            }
+        }
+    }
+}
+
+void RigidBodyRenderer::Composite(const std::vector<const DepthLayer*>& layers,
+                                  std::vector<int>& intersect_indices,
+                                  std::vector<float>& depth)
+{
+    intersect_indices.clear();
+    depth.clear();
+
+    // merge the sorted layers keeping the closest depth of each pixel
+    std::vector<size_t> positions(layers.size(), 0);
+    while (true)
+    {
+        int index = numeric_limits<int>::max();
+        for (size_t i = 0; i < layers.size(); i++)
+        {
+            if (positions[i] < layers[i]->indices.size())
+            {
+                index = std::min(index, layers[i]->indices[positions[i]]);
+            }
+        }
+        if (index == numeric_limits<int>::max()) break;
+
+        float closest = numeric_limits<float>::infinity();
+        for (size_t i = 0; i < layers.size(); i++)
+        {
+            if (positions[i] < layers[i]->indices.size() &&
+                layers[i]->indices[positions[i]] == index)
+            {
+                closest = std::min(closest, layers[i]->depths[positions[i]]);
+                positions[i]++;
+            }
+        }
+
+        intersect_indices.push_back(index);
+        depth.push_back(closest);
+    }
+}
+
+namespace dbot
+{
+template <>
+RigidBodyRenderer::Projection<double>& RigidBodyRenderer::projection()
+{
+    return projection_;
+}
+
+template <>
+RigidBodyRenderer::Projection<float>& RigidBodyRenderer::projection()
+{
+    return single_projection_;
+}
+
+template <>
+const RigidBodyRenderer::Projection<double>& RigidBodyRenderer::projection()
+    const
+{
+    return projection_;
+}
+
+template <>
+const RigidBodyRenderer::Projection<float>& RigidBodyRenderer::projection()
+    const
+{
+    return single_projection_;
+}
+}
+
+void RigidBodyRenderer::project(const Matrix& camera_matrix,
+                                int n_rows,
+                                int n_cols,
+                                int part_begin,
+                                int part_end)
+{
+    if (single_precision_)
+    {
+        project<float>(camera_matrix, n_rows, n_cols, part_begin, part_end);
+    }
+    else
+    {
+        project<double>(camera_matrix, n_rows, n_cols, part_begin, part_end);
+    }
+}
+
+template <typename Scalar>
+void RigidBodyRenderer::project(const Matrix& camera_matrix,
+                                int n_rows,
+                                int n_cols,
+                                int part_begin,
+                                int part_end)
+{
+    typedef Eigen::Matrix<Scalar, 3, 3> Rotation;
+    typedef Eigen::Matrix<Scalar, 3, 1> CameraVertex;
+    typedef Eigen::Matrix<Scalar, 2, 1> ImageVertex;
 
     // we project all the points into image space
     // --------------------------------------------------------
-    vector<vector<Vector3d>> trans_vertices(vertices_.size());
-    vector<vector<Vector2d>> image_vertices(vertices_.size());
+    vector<vector<CameraVertex>>& trans_vertices =
+        projection<Scalar>().trans_vertices;
+    vector<vector<ImageVertex>>& image_vertices =
+        projection<Scalar>().image_vertices;
+    trans_vertices.resize(count_parts());
+    image_vertices.resize(count_parts());
+
+    select_levels(camera_matrix, part_begin, part_end);
+    select_ray_casting(camera_matrix, n_rows, n_cols, part_begin, part_end);
 
-    for (int part_index = 0; part_index < int(vertices_.size()); part_index++)
+    const Rotation camera = camera_matrix.cast<Scalar>();
+    for (int part_index = part_begin; part_index < part_end; part_index++)
     {
-        image_vertices[part_index].resize(vertices_[part_index].size());
-        trans_vertices[part_index].resize(vertices_[part_index].size());
-        for (int point_index = 0;
-             point_index < int(vertices_[part_index].size());
+        if (!visible_[part_index] || ray_cast_[part_index])
+        {
+            image_vertices[part_index].clear();
+            trans_vertices[part_index].clear();
+            continue;
+        }
+
+        const TriangleMesh::VertexMatrix vertices =
+            level_mesh(part_index).vertices(part_index);
+        const Rotation R = R_[part_index].cast<Scalar>();
+        const CameraVertex t = t_[part_index].cast<Scalar>();
+        image_vertices[part_index].resize(vertices.cols());
+        trans_vertices[part_index].resize(vertices.cols());
+        for (int point_index = 0; point_index < vertices.cols();
              point_index++)
         {
             trans_vertices[part_index][point_index] =
-                R_[part_index] * vertices_[part_index][point_index] +
-                t_[part_index];
+                R * vertices.col(point_index).cast<Scalar>() + t;
             image_vertices[part_index][point_index] =
-                (camera_matrix * trans_vertices[part_index][point_index] /
+                (camera * trans_vertices[part_index][point_index] /
                  trans_vertices[part_index][point_index](2))
                     .topRows(2);
         }
     }
+}
 
-    // we find the intersections with the triangles and the depths
-    // ---------------------------------------------------
-    depth_image =
-        vector<float>(n_rows * n_cols, numeric_limits<float>::infinity());
+void RigidBodyRenderer::image_bounds(int part_begin,
+                                     int part_end,
+                                     double& min_row,
+                                     double& max_row,
+                                     double& min_col,
+                                     double& max_col) const
+{
+    min_row = numeric_limits<double>::infinity();
+    max_row = -numeric_limits<double>::infinity();
+    min_col = numeric_limits<double>::infinity();
+    max_col = -numeric_limits<double>::infinity();
+
+    auto extend = [&](double col, double row)
+    {
+        min_col = std::min(min_col, col);
+        max_col = std::max(max_col, col);
+        min_row = std::min(min_row, row);
+        max_row = std::max(max_row, row);
+    };
 
-    for (int part_index = 0; part_index < int(indices_.size()); part_index++)
+    for (int part_index = part_begin; part_index < part_end; part_index++)
     {
-        for (int triangle_index = 0;
-             triangle_index < int(indices_[part_index].size());
+        if (ray_cast_[part_index])
+        {
+            const Eigen::AlignedBox2d& bounds = ray_cast_bounds_[part_index];
+            if (!bounds.isEmpty())
+            {
+                extend(bounds.min()(0), bounds.min()(1));
+                extend(bounds.max()(0), bounds.max()(1));
+            }
+        }
+        else if (single_precision_)
+        {
+            for (const Vector2f& vertex :
+                 single_projection_.image_vertices[part_index])
+            {
+                extend(vertex(0), vertex(1));
+            }
+        }
+        else
+        {
+            for (const Vector2d& vertex :
+                 projection_.image_vertices[part_index])
+            {
+                extend(vertex(0), vertex(1));
+            }
+        }
+    }
+}
+
+void RigidBodyRenderer::rasterize(const Matrix& camera_matrix,
+                                  int n_rows,
+                                  int n_cols,
+                                  int part_begin,
+                                  int part_end,
+                                  std::vector<float>& depth_image) const
+{
+    // the parts which are not ray cast are filled by tiles automatically
+    const bool tiled = rasterization_mode_ == TILED_RASTERIZATION ||
+                       rasterization_mode_ == AUTOMATIC_RENDERING;
+    if (tiled && single_precision_)
+    {
+        rasterize_tiled<float>(
+            camera_matrix, n_rows, n_cols, part_begin, part_end, depth_image);
+    }
+    else if (tiled)
+    {
+        rasterize_tiled<double>(
+            camera_matrix, n_rows, n_cols, part_begin, part_end, depth_image);
+    }
+    else if (single_precision_)
+    {
+        rasterize_scanline<float>(
+            camera_matrix, n_rows, n_cols, part_begin, part_end, depth_image);
+    }
+    else
+    {
+        rasterize_scanline<double>(
+            camera_matrix, n_rows, n_cols, part_begin, part_end, depth_image);
+    }
+
+    cast_rays(camera_matrix, n_rows, n_cols, part_begin, part_end, depth_image);
+}
+
+void RigidBodyRenderer::cast_rays(const Matrix& camera_matrix,
+                                  int n_rows,
+                                  int n_cols,
+                                  int part_begin,
+                                  int part_end,
+                                  std::vector<float>& depth_image) const
+{
+    const int packet_size = TriangleBvh::PACKET_SIZE;
+    const Matrix inv_camera_matrix = camera_matrix.inverse();
+
+    float directions[3][packet_size];
+    float depths[packet_size];
+    for (int part_index = part_begin; part_index < part_end; part_index++)
+    {
+        if (!visible_[part_index] || !ray_cast_[part_index]) continue;
+
+        const Eigen::AlignedBox2d& bounds = ray_cast_bounds_[part_index];
+        if (bounds.isEmpty()) continue;
+        const int row_begin = std::max(0., std::ceil(bounds.min()(1)));
+        const int row_end =
+            std::min(double(n_rows - 1), std::floor(bounds.max()(1)));
+        const int col_begin = std::max(0., std::ceil(bounds.min()(0)));
+        const int col_end =
+            std::min(double(n_cols - 1), std::floor(bounds.max()(0)));
+
+        // the rays start at the camera centre in the frame of the part,
+        // the pixel rays are linear in (col, row, 1)
+        const Matrix to_part = R_[part_index].transpose();
+        const Vector3f origin = (-(to_part * t_[part_index])).cast<float>();
+        const Matrix pixel_rays = to_part * inv_camera_matrix;
+        const TriangleBvh& bvh = *bvhs_[levels_[part_index]];
+
+        for (int row = row_begin; row <= row_end; row++)
+        {
+            float* depth_row = &depth_image[row * n_cols];
+            const Vector row_ray = pixel_rays * Vector(0, row, 1);
+            const double row_z =
+                inv_camera_matrix.row(2).dot(Vector(0, row, 1));
+
+            for (int col = col_begin; col <= col_end; col += packet_size)
+            {
+                const int lanes = std::min(packet_size, col_end - col + 1);
+
+                // scaled to a unit depth in the camera frame, such that the
+                // distances along the rays are the depths. Unused lanes have
+                // no depth to improve on.
+                for (int lane = 0; lane < packet_size; lane++)
+                {
+                    const int ray_col = col + std::min(lane, lanes - 1);
+                    const double z = row_z + inv_camera_matrix(2, 0) * ray_col;
+                    const Vector ray =
+                        (row_ray + pixel_rays.col(0) * ray_col) / z;
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        directions[axis][lane] = ray(axis);
+                    }
+                    depths[lane] = lane < lanes ? depth_row[col + lane] : 0;
+                }
+
+                bvh.intersect(
+                    part_index, origin, directions, back_face_culling_, depths);
+
+                for (int lane = 0; lane < lanes; lane++)
+                {
+                    depth_row[col + lane] = depths[lane];
+                }
+            }
+        }
+    }
+}
+
+void RigidBodyRenderer::select_ray_casting(const Matrix& camera_matrix,
+                                           int n_rows,
+                                           int n_cols,
+                                           int part_begin,
+                                           int part_end)
+{
+    const Eigen::AlignedBox2d image(Eigen::Vector2d(0, 0),
+                                    Eigen::Vector2d(n_cols - 1, n_rows - 1));
+
+    for (int part_index = part_begin; part_index < part_end; part_index++)
+    {
+        ray_cast_[part_index] = false;
+        if (bvhs_.empty() || !visible_[part_index]) continue;
+
+        const Eigen::AlignedBox3f& box =
+            bvhs_[levels_[part_index]]->bounds(part_index);
+        if (box.isEmpty()) continue;
+
+        // the projected corners of the bounding box, rays through the whole
+        // image if a corner is that close to the camera
+        Eigen::AlignedBox2d bounds;
+        bool close = false;
+        for (int i = 0; i < 8 && !close; i++)
+        {
+            const Vector corner =
+                R_[part_index] *
+                    box.corner(Eigen::AlignedBox3f::CornerType(i))
+                        .cast<double>() +
+                t_[part_index];
+            const Vector pixel = camera_matrix * corner;
+            close = corner(2) < TriangleBvh::NEAR_DISTANCE;
+            bounds.extend(Eigen::Vector2d(pixel(0), pixel(1)) / pixel(2));
+        }
+        bounds = close ? image : bounds.intersection(image);
+        ray_cast_bounds_[part_index] = bounds;
+
+        if (rasterization_mode_ == RAY_CASTING)
+        {
+            ray_cast_[part_index] = true;
+            continue;
+        }
+
+        double pixels = 0;
+        if (!bounds.isEmpty())
+        {
+            const Eigen::Vector2d first = bounds.min().array().ceil();
+            const Eigen::Vector2d last = bounds.max().array().floor();
+            pixels = std::max(last(0) - first(0) + 1, 0.) *
+                     std::max(last(1) - first(1) + 1, 0.);
+        }
+        ray_cast_[part_index] =
+            level_mesh(part_index).count_triangles(part_index) >
+            triangles_per_pixel_ * pixels;
+    }
+}
+
+template <typename Scalar>
+void RigidBodyRenderer::rasterize_scanline(
+    const Matrix& camera_matrix,
+    int n_rows,
+    int n_cols,
+    int part_begin,
+    int part_end,
+    std::vector<float>& depth_image) const
+{
+    typedef Eigen::Matrix<Scalar, 3, 1> CameraVertex;
+    typedef Eigen::Matrix<Scalar, 2, 1> ImageVertex;
+
+    const Eigen::Matrix<Scalar, 3, 3> inv_camera_matrix =
+        camera_matrix.inverse().cast<Scalar>();
+    const vector<vector<CameraVertex>>& trans_vertices =
+        projection<Scalar>().trans_vertices;
+    const vector<vector<ImageVertex>>& image_vertices =
+        projection<Scalar>().image_vertices;
+
+    for (int part_index = part_begin; part_index < part_end; part_index++)
+    {
+        if (!visible_[part_index] || ray_cast_[part_index]) continue;
+
+        const TriangleMesh::TriangleMatrix triangles =
+            level_mesh(part_index).triangles(part_index);
+        const Vector* normals = level_normals(part_index);
+
+        for (int triangle_index = 0; triangle_index < triangles.cols();
              triangle_index++)
         {
-            vector<Vector2d> vertices(3);
-            Vector2d center(Vector2d::Zero());
+            ImageVertex vertices[3];
+            ImageVertex center(ImageVertex::Zero());
 
             // find the min and max indices to be checked
             // ------------------------------------------------------------
@@ -165,9 +649,8 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
             for (int i = 0; i < 3; i++)
             {
                 vertices[i] =
-                    image_vertices[part_index]
-                                  [indices_[part_index][triangle_index][i]];
-                center += vertices[i] / 3.;
+                    image_vertices[part_index][triangles(i, triangle_index)];
+                center += vertices[i] / Scalar(3);
                 min_row = ceil(float(vertices[i](1))) < min_row
                               ? ceil(float(vertices[i](1)))
                               : min_row;
@@ -184,13 +667,19 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
                 // how should this be handled properly? for now if some vertex
                 // in a triangle comes to lie behind camera
                 // we just discard that triangle.
-                if (trans_vertices[part_index]
-                                  [indices_[part_index][triangle_index][i]](2) <
-                    0.001)
+                if (trans_vertices[part_index][triangles(i, triangle_index)](
+                        2) < 0.001)
                     behind_camera = true;
             }
             if (behind_camera) continue;
 
+            // the camera is on the back side of the plane of back faces
+            const CameraVertex normal =
+                (R_[part_index] * normals[triangle_index]).cast<Scalar>();
+            float offset = normal.dot(
+                trans_vertices[part_index][triangles(0, triangle_index)]);
+            if (back_face_culling_ && offset > 0) continue;
+
             // make sure all of them are inside of image
             // -----------------------------------------------------------------
             min_row = min_row >= 0 ? min_row : 0;
@@ -213,7 +702,7 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
 
             for (int i = 0; i < 3; i++)
             {
-                Vector2d side = vertices[(i + 1) % 3] - vertices[i];
+                ImageVertex side = vertices[(i + 1) % 3] - vertices[i];
                 slopes[i] = side(1) / side(0);
 
                 // we determine whether the line limits the triangle on top or
@@ -261,11 +750,6 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
 
                 // we push back the indices of the intersections and the
                 // corresponding depths ------------------------------------
-                Vector3d normal =
-                    R_[part_index] * normals_[part_index][triangle_index];
-                float offset = normal.dot(
-                    trans_vertices[part_index]
-                                  [indices_[part_index][triangle_index][0]]);
                 for (int row = int(min_row_given_col);
                      row <= int(max_row_given_col);
                      row++)
@@ -276,9 +760,9 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
                         // col);
                         // we find the intersection between the ray and the
                         // triangle --------------------------------------------
-                        Vector3d line_vector =
+                        CameraVertex line_vector =
                             inv_camera_matrix *
-                            Vector3d(
+                            CameraVertex(
                                 col, row, 1);  // the depth is the z component
                         float depth =
                             std::fabs(offset / normal.dot(line_vector));
@@ -293,15 +777,197 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
     }
 }
 
+template <typename Scalar>
+void RigidBodyRenderer::rasterize_tiled(const Matrix& camera_matrix,
+                                        int n_rows,
+                                        int n_cols,
+                                        int part_begin,
+                                        int part_end,
+                                        std::vector<float>& depth_image) const
+{
+    typedef Eigen::Matrix<Scalar, 3, 1> CameraVertex;
+    typedef Eigen::Matrix<Scalar, 2, 1> ImageVertex;
+
+    const int tile_size = 8;
+    const Eigen::Matrix<Scalar, 3, 3> inv_camera_matrix_transpose =
+        camera_matrix.inverse().transpose().cast<Scalar>();
+
+    // relative widening of the edge functions, well above the rounding error
+    // of either precision
+    const Scalar widening = sizeof(Scalar) < sizeof(double) ? 1e-5 : 1e-12;
+
+    for (int part_index = part_begin; part_index < part_end; part_index++)
+    {
+        if (!visible_[part_index] || ray_cast_[part_index]) continue;
+
+        const vector<CameraVertex>& trans_vertices =
+            projection<Scalar>().trans_vertices[part_index];
+        const vector<ImageVertex>& image_vertices =
+            projection<Scalar>().image_vertices[part_index];
+        const TriangleMesh::TriangleMatrix triangles =
+            level_mesh(part_index).triangles(part_index);
+        const Vector* normals = level_normals(part_index);
+
+        for (int triangle_index = 0; triangle_index < triangles.cols();
+             triangle_index++)
+        {
+            const auto triangle = triangles.col(triangle_index);
+
+            // find the min and max indices to be checked, triangles with a
+            // vertex behind the camera are discarded as in the scanline fill
+            // ------------------------------------------------------------
+            const ImageVertex* vertices[3];
+            int min_row = numeric_limits<int>::max();
+            int max_row = -numeric_limits<int>::max();
+            int min_col = numeric_limits<int>::max();
+            int max_col = -numeric_limits<int>::max();
+            bool behind_camera = false;
+            for (int i = 0; i < 3; i++)
+            {
+                vertices[i] = &image_vertices[triangle[i]];
+                const float col = (*vertices[i])(0);
+                const float row = (*vertices[i])(1);
+                min_row = std::min(min_row, int(ceil(row)));
+                max_row = std::max(max_row, int(floor(row)));
+                min_col = std::min(min_col, int(ceil(col)));
+                max_col = std::max(max_col, int(floor(col)));
+
+                if (trans_vertices[triangle[i]](2) < 0.001)
+                    behind_camera = true;
+            }
+            if (behind_camera) continue;
+
+            // the camera is on the back side of the plane of back faces
+            const CameraVertex normal =
+                (R_[part_index] * normals[triangle_index]).cast<Scalar>();
+            const float offset = normal.dot(trans_vertices[triangle[0]]);
+            if (back_face_culling_ && offset > 0) continue;
+
+            min_row = std::max(min_row, 0);
+            max_row = std::min(max_row, n_rows - 1);
+            min_col = std::max(min_col, 0);
+            max_col = std::min(max_col, n_cols - 1);
+            if (max_row < min_row || max_col < min_col) continue;
+
+            // orient the triangle counter clockwise in (col, row) such that
+            // all edge functions are non-negative inside. Degenerate triangles
+            // are skipped.
+            const Scalar area =
+                ((*vertices[1])(0) - (*vertices[0])(0)) *
+                    ((*vertices[2])(1) - (*vertices[0])(1)) -
+                ((*vertices[1])(1) - (*vertices[0])(1)) *
+                    ((*vertices[2])(0) - (*vertices[0])(0));
+            if (!(area != 0.0) || !std::isfinite(area)) continue;
+            if (area < 0) std::swap(vertices[1], vertices[2]);
+
+            // edge functions e_i(col, row) = a_i col + b_i row + c_i
+            Scalar a[3];
+            Scalar b[3];
+            Scalar c[3];
+            for (int i = 0; i < 3; i++)
+            {
+                const ImageVertex& from = *vertices[i];
+                const ImageVertex& to = *vertices[(i + 1) % 3];
+                a[i] = from(1) - to(1);
+                b[i] = to(0) - from(0);
+                c[i] = -(a[i] * from(0) + b[i] * from(1));
+
+                // pixel centres on an edge shared by two triangles must not
+                // be lost to rounding in both of them, as happens easily
+                // for single precision vertices, hence the functions are
+                // widened by more than their rounding error
+                c[i] += widening * (std::fabs(c[i]) +
+                                    (std::fabs(a[i]) + std::fabs(b[i])) *
+                                        std::max(n_rows, n_cols));
+            }
+
+            // the depth along the ray through (col, row) is offset / d with d
+            // linear in the pixel coordinates
+            const CameraVertex d = inv_camera_matrix_transpose * normal;
+
+            for (int tile_row = min_row; tile_row <= max_row;
+                 tile_row += tile_size)
+            {
+                const int tile_row_end =
+                    std::min(tile_row + tile_size - 1, max_row);
+
+                for (int tile_col = min_col; tile_col <= max_col;
+                     tile_col += tile_size)
+                {
+                    const int tile_col_end =
+                        std::min(tile_col + tile_size - 1, max_col);
+
+                    // the edge functions are linear, hence their extrema over
+                    // the tile are attained at the corners
+                    bool outside = false;
+                    bool inside = true;
+                    for (int i = 0; i < 3; i++)
+                    {
+                        const Scalar e_00 =
+                            a[i] * tile_col + b[i] * tile_row + c[i];
+                        const Scalar e_10 =
+                            e_00 + a[i] * (tile_col_end - tile_col);
+                        const Scalar e_01 =
+                            e_00 + b[i] * (tile_row_end - tile_row);
+                        const Scalar e_11 = e_10 + e_01 - e_00;
+
+                        const Scalar e_min = std::min(std::min(e_00, e_10),
+                                                      std::min(e_01, e_11));
+                        const Scalar e_max = std::max(std::max(e_00, e_10),
+                                                      std::max(e_01, e_11));
+
+                        outside |= e_max < 0;
+                        inside &= e_min >= 0;
+                    }
+                    if (outside) continue;
+
+                    for (int row = tile_row; row <= tile_row_end; row++)
+                    {
+                        float* depth_row = &depth_image[row * n_cols];
+                        const Scalar d_row = d(1) * row + d(2);
+
+                        if (inside)
+                        {
+                            for (int col = tile_col; col <= tile_col_end; col++)
+                            {
+                                const float depth =
+                                    std::fabs(offset / (d(0) * col + d_row));
+                                depth_row[col] =
+                                    std::min(depth, depth_row[col]);
+                            }
+                            continue;
+                        }
+
+                        const Scalar e0_row = b[0] * row + c[0];
+                        const Scalar e1_row = b[1] * row + c[1];
+                        const Scalar e2_row = b[2] * row + c[2];
+                        for (int col = tile_col; col <= tile_col_end; col++)
+                        {
+                            const bool covered = a[0] * col + e0_row >= 0 &&
+                                                 a[1] * col + e1_row >= 0 &&
+                                                 a[2] * col + e2_row >= 0;
+                            const float depth =
+                                std::fabs(offset / (d(0) * col + d_row));
+                            depth_row[col] = covered && depth < depth_row[col]
+                                                 ? depth
+                                                 : depth_row[col];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 // todo: does not handle the case properly when the depth is around zero or
 // negative
 void RigidBodyRenderer::Render(Matrix camera_matrix,
                                int n_rows,
                                int n_cols,
                                std::vector<int>& intersect_indices,
-                               std::vector<float>& depth) const
+                               std::vector<float>& depth)
 {
-    vector<float> depth_image;
+    vector<float>& depth_image = depth_buffer_;
 
     Render(camera_matrix, n_rows, n_cols, depth_image);
 
@@ -328,7 +994,7 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
     depth.resize(count);
 }
 
-void RigidBodyRenderer::Render(std::vector<float>& depth_image) const
+void RigidBodyRenderer::Render(std::vector<float>& depth_image)
 {
     assert(!camera_matrix_.isZero());
     assert(n_rows_ > 0);
@@ -340,19 +1006,32 @@ void RigidBodyRenderer::Render(std::vector<float>& depth_image) const
 std::vector<std::vector<RigidBodyRenderer::Vector>>
 RigidBodyRenderer::vertices() const
 {
-    vector<vector<Vector3d>> trans_vertices(vertices_.size());
+    const TriangleMesh& mesh = *meshes_[0];
+    vector<vector<Vector3d>> trans_vertices(mesh.count_parts());
 
-    for (int o = 0; o < int(vertices_.size()); o++)
+    for (int o = 0; o < mesh.count_parts(); o++)
     {
-        trans_vertices[o].resize(vertices_[o].size());
-        for (int p = 0; p < int(vertices_[o].size()); p++)
+        const TriangleMesh::VertexMatrix vertices = mesh.vertices(o);
+        trans_vertices[o].resize(vertices.cols());
+        for (int p = 0; p < vertices.cols(); p++)
         {
-            trans_vertices[o][p] = R_[o] * vertices_[o][p] + t_[o];
+            trans_vertices[o][p] =
+                R_[o] * vertices.col(p).cast<double>() + t_[o];
         }
     }
     return trans_vertices;
 }
 
+int RigidBodyRenderer::count_parts() const
+{
+    return meshes_[0]->count_parts();
+}
+
+const TriangleMesh::ConstPtr& RigidBodyRenderer::mesh() const
+{
+    return meshes_[0];
+}
+
 void RigidBodyRenderer::set_poses(const std::vector<Matrix>& rotations,
                                   const std::vector<Vector>& translations)
 {
@@ -378,6 +1057,207 @@ void RigidBodyRenderer::parameters(Matrix camera_matrix, int n_rows, int n_cols)
     n_cols_ = n_cols;
 }
 
+bool RigidBodyRenderer::projected_bounds(int margin,
+                                         int& row_begin,
+                                         int& row_end,
+                                         int& col_begin,
+                                         int& col_end)
+{
+    const int part_count = count_parts();
+    visible_.assign(part_count, true);
+    project(camera_matrix_, n_rows_, n_cols_, 0, part_count);
+
+    double min_row, max_row, min_col, max_col;
+    image_bounds(0, part_count, min_row, max_row, min_col, max_col);
+
+    if (!(min_row <= max_row && min_col <= max_col)) return false;
+
+    // clamped before the conversion, such that poses far outside of the
+    // image do not overflow
+    auto clamp = [](double value, int size)
+    {
+        return int(std::min(std::max(value, 0.), double(size)));
+    };
+    row_begin = clamp(std::floor(min_row) - margin, n_rows_);
+    row_end = clamp(std::ceil(max_row) + margin + 1, n_rows_);
+    col_begin = clamp(std::floor(min_col) - margin, n_cols_);
+    col_end = clamp(std::ceil(max_col) + margin + 1, n_cols_);
+
+    return row_begin < row_end && col_begin < col_end;
+}
+
+bool RigidBodyRenderer::in_view(const Matrix& camera_matrix,
+                                int n_rows,
+                                int n_cols)
+{
+    const int part_count = count_parts();
+    cull_parts(camera_matrix, n_rows, n_cols, 0, part_count);
+    return std::find(visible_.begin(), visible_.end(), true) != visible_.end();
+}
+
+RigidBodyRenderer::RasterizationMode RigidBodyRenderer::rasterization_mode()
+    const
+{
+    return rasterization_mode_;
+}
+
+void RigidBodyRenderer::single_precision(bool enabled)
+{
+    single_precision_ = enabled;
+}
+
+bool RigidBodyRenderer::single_precision() const
+{
+    return single_precision_;
+}
+
+void RigidBodyRenderer::back_face_culling(bool enabled)
+{
+    back_face_culling_ = enabled;
+}
+
+bool RigidBodyRenderer::back_face_culling() const
+{
+    return back_face_culling_;
+}
+
+void RigidBodyRenderer::add_level_of_detail(const TriangleMesh::ConstPtr& mesh)
+{
+    if (mesh->count_parts() != count_parts())
+    {
+        cout << "ERROR: level of detail with " << mesh->count_parts()
+             << " parts for a renderer with " << count_parts() << " parts"
+             << endl;
+        exit(-1);
+    }
+
+    // the simplification does not create degenerate triangles, but slivers
+    // may not pass the exact check
+    meshes_.push_back(mesh);
+    normals_.push_back(vector<Vector>());
+    compute_normals(*mesh, false, normals_.back());
+    if (!bvhs_.empty()) bvhs_.push_back(std::make_shared<TriangleBvh>(*mesh));
+
+    // the simplified vertices may move slightly out of the bounding spheres,
+    // which have to contain all levels for the culling
+    for (int part_index = 0; part_index < count_parts(); part_index++)
+    {
+        const TriangleMesh::VertexMatrix vertices = mesh->vertices(part_index);
+        for (int i = 0; i < vertices.cols(); i++)
+        {
+            part_radii_[part_index] = std::max(
+                part_radii_[part_index],
+                (vertices.col(i).cast<double>() - part_centers_[part_index])
+                    .norm());
+        }
+    }
+}
+
+void RigidBodyRenderer::add_level_of_detail(
+    const std::vector<std::vector<Vector>>& vertices,
+    const std::vector<std::vector<std::vector<int>>>& indices)
+{
+    add_level_of_detail(std::make_shared<TriangleMesh>(vertices, indices));
+}
+
+void RigidBodyRenderer::level_of_detail_budget(double pixels_per_triangle)
+{
+    pixels_per_triangle_ = pixels_per_triangle;
+}
+
+double RigidBodyRenderer::level_of_detail_budget() const
+{
+    return pixels_per_triangle_;
+}
+
+int RigidBodyRenderer::level_of_detail(int part_index) const
+{
+    return levels_[part_index];
+}
+
+void RigidBodyRenderer::ray_casting_threshold(double triangles_per_pixel)
+{
+    triangles_per_pixel_ = triangles_per_pixel;
+}
+
+double RigidBodyRenderer::ray_casting_threshold() const
+{
+    return triangles_per_pixel_;
+}
+
+bool RigidBodyRenderer::ray_cast(int part_index) const
+{
+    return ray_cast_[part_index];
+}
+
+void RigidBodyRenderer::select_levels(const Matrix& camera_matrix,
+                                      int part_begin,
+                                      int part_end)
+{
+    for (int part_index = part_begin; part_index < part_end; part_index++)
+    {
+        levels_[part_index] = 0;
+        if (meshes_.size() == 1) continue;
+
+        // the full mesh is used as long as the camera is within the bounding
+        // sphere, where its projection is unbounded
+        const double depth =
+            (R_[part_index] * part_centers_[part_index] + t_[part_index])(2);
+        const double radius = part_radii_[part_index];
+        if (depth <= radius) continue;
+
+        const double focal_length =
+            std::max(camera_matrix(0, 0), camera_matrix(1, 1));
+        const double projected_radius = focal_length * radius / depth;
+        const double triangle_count = M_PI * projected_radius *
+                                      projected_radius / pixels_per_triangle_;
+
+        // the coarsest level which still has enough triangles
+        for (int level = meshes_.size() - 1; level > 0; level--)
+        {
+            if (meshes_[level]->count_triangles(part_index) >= triangle_count)
+            {
+                levels_[part_index] = level;
+                break;
+            }
+        }
+    }
+}
+
+void RigidBodyRenderer::cull_parts(const Matrix& camera_matrix,
+                                   int n_rows,
+                                   int n_cols,
+                                   int part_begin,
+                                   int part_end)
+{
+    // planes through the camera centre beyond which the projection lies a
+    // pixel outside of the image, with the inside in the normal direction
+    const Vector z = Vector::UnitZ();
+    Vector planes[4] = {camera_matrix.row(0).transpose() + z,
+                        double(n_cols) * z - camera_matrix.row(0).transpose(),
+                        camera_matrix.row(1).transpose() + z,
+                        double(n_rows) * z - camera_matrix.row(1).transpose()};
+    for (int i = 0; i < 4; i++)
+    {
+        planes[i].normalize();
+    }
+
+    for (int part_index = part_begin; part_index < part_end; part_index++)
+    {
+        const Vector center =
+            R_[part_index] * part_centers_[part_index] + t_[part_index];
+        const double radius = part_radii_[part_index];
+
+        // triangles with a vertex this close to the camera are discarded
+        bool visible = center(2) + radius >= 0.001;
+        for (int i = 0; visible && i < 4; i++)
+        {
+            visible = planes[i].dot(center) >= -radius;
+        }
+        visible_[part_index] = visible;
+    }
+}
+
 // test the enchilada
 
 // VectorXd initial_rigid_bodies_state = VectorXd::Zero(15);
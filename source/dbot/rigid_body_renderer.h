@@ -15,11 +15,21 @@
 
 #include <Eigen/Dense>
 #include <dbot/pose/rigid_bodies_state.h>
+#include <dbot/triangle_bvh.h>
+#include <dbot/triangle_mesh.h>
 #include <memory>
 #include <vector>
 
 namespace dbot
 {
+/**
+ * \brief CPU depth renderer of rigid bodies
+ *
+ * Rendering keeps the projected vertices and the per part selections of
+ * the last rendering in the renderer, hence Render() is not const and a
+ * renderer must only be used by one thread at a time. Threads render with
+ * copies of their own, which share the meshes and ray casting hierarchies.
+ */
 class RigidBodyRenderer
 {
 public:
@@ -29,15 +39,56 @@ public:
     typedef Eigen::Matrix3d Matrix;
     typedef typename Eigen::Transform<double, 3, Eigen::Affine> Affine;
 
+    /**
+     * \brief Triangle fill algorithms. All produce the same depth images up
+     *        to pixels on triangle edges.
+     *
+     * SCANLINE_RASTERIZATION fills the triangles column by column.
+     * TILED_RASTERIZATION evaluates incremental edge functions over small
+     * pixel tiles, skipping tiles outside of the triangle.
+     * RAY_CASTING traces the pixels within the projected bounding box of
+     * each part in packets through a TriangleBvh of the part, which is
+     * built once. Its cost grows with the covered pixels rather than the
+     * triangles. It always runs in single precision and also renders
+     * triangles which cross the near distance of the rasterizers.
+     * AUTOMATIC_RENDERING ray casts the parts with more triangles than
+     * ray_casting_threshold() times their covered pixels and fills the
+     * others by tiles.
+     */
+    enum RasterizationMode
+    {
+        SCANLINE_RASTERIZATION,
+        TILED_RASTERIZATION,
+        RAY_CASTING,
+        AUTOMATIC_RENDERING
+    };
+
+    /**
+     * \brief Renders the given mesh, which is shared rather than copied
+     */
+    RigidBodyRenderer(
+        const TriangleMesh::ConstPtr& mesh,
+        RasterizationMode rasterization_mode = SCANLINE_RASTERIZATION);
+
+    RigidBodyRenderer(
+        const TriangleMesh::ConstPtr& mesh,
+        Matrix camera_matrix,
+        int n_rows,
+        int n_cols,
+        RasterizationMode rasterization_mode = SCANLINE_RASTERIZATION);
+
     RigidBodyRenderer(
         const std::vector<std::vector<Eigen::Vector3d>>& vertices,
-        const std::vector<std::vector<std::vector<int>>>& indices);
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        RasterizationMode rasterization_mode = SCANLINE_RASTERIZATION);
 
-    RigidBodyRenderer(const std::vector<std::vector<Eigen::Vector3d>>& vertices,
-                      const std::vector<std::vector<std::vector<int>>>& indices,
-                      Matrix camera_matrix,
-                      int n_rows,
-                      int n_cols);
+    RigidBodyRenderer(
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        Matrix camera_matrix,
+        int n_rows,
+        int n_cols,
+        RasterizationMode rasterization_mode = SCANLINE_RASTERIZATION);
 
     virtual ~RigidBodyRenderer();
 
@@ -45,14 +96,43 @@ public:
                 int n_rows,
                 int n_cols,
                 std::vector<int>& intersect_indices,
-                std::vector<float>& depth) const;
+                std::vector<float>& depth);
+
+    void Render(Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                std::vector<float>& depth_image);
+
+    void Render(std::vector<float>& depth_image);
 
+    /**
+     * \brief Sparse depth image of a single part
+     */
+    struct DepthLayer
+    {
+        /// indices of the covered pixels in ascending order
+        std::vector<int> indices;
+        std::vector<float> depths;
+    };
+
+    /**
+     * \brief Renders only the part with the given index at its current pose
+     *        into a sparse layer
+     */
     void Render(Matrix camera_matrix,
                 int n_rows,
                 int n_cols,
-                std::vector<float>& depth_image) const;
+                int part_index,
+                DepthLayer& layer);
 
-    void Render(std::vector<float>& depth_image) const;
+    /**
+     * \brief Combines part layers into the sparse depth image of all parts,
+     *        as returned by Render(camera_matrix, n_rows, n_cols,
+     *        intersect_indices, depth)
+     */
+    static void Composite(const std::vector<const DepthLayer*>& layers,
+                          std::vector<int>& intersect_indices,
+                          std::vector<float>& depth);
 
     template <typename RigidbodyState>
     void Render(const RigidbodyState& state, std::vector<float>& depth_vector)
@@ -119,6 +199,13 @@ public:
 
     std::vector<std::vector<Vector>> vertices() const;
 
+    int count_parts() const;
+
+    /**
+     * \brief The full resolution mesh
+     */
+    const TriangleMesh::ConstPtr& mesh() const;
+
     virtual void set_poses(const std::vector<Matrix>& rotations,
                            const std::vector<Vector>& translations);
 
@@ -126,22 +213,235 @@ public:
 
     void parameters(Matrix camera_matrix, int n_rows, int n_cols);
 
+    /**
+     * \brief Pixel region covered by all parts at their current poses,
+     *        widened by the margin and clamped to the image
+     *
+     * \return false if the region lies outside of the image
+     */
+    bool projected_bounds(int margin,
+                          int& row_begin,
+                          int& row_end,
+                          int& col_begin,
+                          int& col_end);
+
+    /**
+     * \brief Whether the bounding sphere of any part at its current pose
+     *        lies within the view, otherwise a rendering covers no pixel
+     */
+    bool in_view(const Matrix& camera_matrix, int n_rows, int n_cols);
+
+    RasterizationMode rasterization_mode() const;
+
+    /**
+     * \brief Transforms, projects and rasterizes the triangles in single
+     *        precision like the GPU renderer instead of double precision
+     */
+    void single_precision(bool enabled);
+    bool single_precision() const;
+
+    /**
+     * \brief Skips the triangles which face away from the camera. This
+     *        requires closed meshes whose triangles are wound counter
+     *        clockwise seen from outside, as the normals are computed from
+     *        the winding.
+     *
+     * Parts whose bounding sphere lies outside of the view are skipped
+     * either way.
+     */
+    void back_face_culling(bool enabled);
+    bool back_face_culling() const;
+
+    /**
+     * \brief Adds a coarser mesh of every part, e.g. from
+     *        ObjectModel::build_levels_of_detail(), in the frame of the full
+     *        one. Levels have to be added from fine to coarse.
+     *
+     * Each rendering then uses the coarsest level of a part which still has
+     * a triangle per level_of_detail_budget() pixels of the projected part.
+     */
+    void add_level_of_detail(const TriangleMesh::ConstPtr& mesh);
+
+    void add_level_of_detail(
+        const std::vector<std::vector<Vector>>& vertices,
+        const std::vector<std::vector<std::vector<int>>>& indices);
+
+    /**
+     * \brief Sets the number of projected pixels per triangle below which a
+     *        finer level is used
+     */
+    void level_of_detail_budget(double pixels_per_triangle);
+    double level_of_detail_budget() const;
+
+    /**
+     * \brief Level the part was rendered at last, 0 for the full mesh
+     */
+    int level_of_detail(int part_index) const;
+
+    /**
+     * \brief Sets the triangles per covered pixel above which
+     *        AUTOMATIC_RENDERING ray casts a part, 2 by default
+     */
+    void ray_casting_threshold(double triangles_per_pixel);
+    double ray_casting_threshold() const;
+
+    /**
+     * \brief Whether the part was ray cast at the last rendering
+     */
+    bool ray_cast(int part_index) const;
+
 private:
     /**
      * Because c++0x on gcc.4.6 does not implement delegating constructors
      */
     void init();
 
+    /**
+     * \brief Vertices of the parts in the camera frame and in the image
+     */
+    template <typename Scalar>
+    struct Projection
+    {
+        std::vector<std::vector<Eigen::Matrix<Scalar, 3, 1>>> trans_vertices;
+        std::vector<std::vector<Eigen::Matrix<Scalar, 2, 1>>> image_vertices;
+    };
+
+    template <typename Scalar>
+    Projection<Scalar>& projection();
+    template <typename Scalar>
+    const Projection<Scalar>& projection() const;
+
+    /**
+     * \brief Transforms and projects the vertices of the parts
+     *        [part_begin, part_end) at the selected precision, except for
+     *        the parts which are ray cast
+     */
+    void project(const Matrix& camera_matrix,
+                 int n_rows,
+                 int n_cols,
+                 int part_begin,
+                 int part_end);
+
+    template <typename Scalar>
+    void project(const Matrix& camera_matrix,
+                 int n_rows,
+                 int n_cols,
+                 int part_begin,
+                 int part_end);
+
+    /**
+     * \brief Bounding box of the projected vertices of the parts
+     *        [part_begin, part_end), empty if there are none
+     */
+    void image_bounds(int part_begin,
+                      int part_end,
+                      double& min_row,
+                      double& max_row,
+                      double& min_col,
+                      double& max_col) const;
+
+    /**
+     * \brief Fills the triangles of the parts [part_begin, part_end) into the
+     *        depth image using the projected vertices
+     */
+    void rasterize(const Matrix& camera_matrix,
+                   int n_rows,
+                   int n_cols,
+                   int part_begin,
+                   int part_end,
+                   std::vector<float>& depth_image) const;
+
+    template <typename Scalar>
+    void rasterize_scanline(const Matrix& camera_matrix,
+                            int n_rows,
+                            int n_cols,
+                            int part_begin,
+                            int part_end,
+                            std::vector<float>& depth_image) const;
+
+    template <typename Scalar>
+    void rasterize_tiled(const Matrix& camera_matrix,
+                         int n_rows,
+                         int n_cols,
+                         int part_begin,
+                         int part_end,
+                         std::vector<float>& depth_image) const;
+
+    /**
+     * \brief Traces the pixels covered by the ray cast parts among
+     *        [part_begin, part_end) into the depth image
+     */
+    void cast_rays(const Matrix& camera_matrix,
+                   int n_rows,
+                   int n_cols,
+                   int part_begin,
+                   int part_end,
+                   std::vector<float>& depth_image) const;
+
+    /**
+     * \brief Chooses whether the visible parts [part_begin, part_end) are
+     *        ray cast at their selected levels, and the pixels they cover
+     */
+    void select_ray_casting(const Matrix& camera_matrix,
+                            int n_rows,
+                            int n_cols,
+                            int part_begin,
+                            int part_end);
+
+    /**
+     * \brief Chooses the level of detail of the parts [part_begin, part_end)
+     *        from the projected size of their bounding spheres
+     */
+    void select_levels(const Matrix& camera_matrix,
+                       int part_begin,
+                       int part_end);
+
+    /**
+     * \brief Marks the parts [part_begin, part_end) whose bounding spheres
+     *        lie outside of the view as invisible, such that they are
+     *        neither projected nor rasterized
+     */
+    void cull_parts(const Matrix& camera_matrix,
+                    int n_rows,
+                    int n_cols,
+                    int part_begin,
+                    int part_end);
+
+    /**
+     * \brief Computes the normals of all triangles of the mesh
+     *
+     * \param check_degenerate   exit if a triangle has no unique normal
+     */
+    static void compute_normals(const TriangleMesh& mesh,
+                                bool check_degenerate,
+                                std::vector<Vector>& normals);
+
+    // mesh and triangle normals of the selected level of detail of a part
+    const TriangleMesh& level_mesh(int part_index) const
+    {
+        return *meshes_[levels_[part_index]];
+    }
+
+    const Vector* level_normals(int part_index) const
+    {
+        const int level = levels_[part_index];
+        return normals_[level].data() +
+               meshes_[level]->first_triangle(part_index);
+    }
+
     // protected:
 public:
     Matrix camera_matrix_;
     int n_rows_;
     int n_cols_;
 
-    // triangles
-    std::vector<std::vector<Vector>> vertices_;
+    // shared meshes of the levels of detail, level 0 is the full mesh
+    std::vector<TriangleMesh::ConstPtr> meshes_;
+    // hierarchies of the levels for ray casting, shared by copies of the
+    // renderer, empty for the rasterization modes
+    std::vector<TriangleBvh::ConstPtr> bvhs_;
+    // normals of all triangles of each level, in the order of the mesh
     std::vector<std::vector<Vector>> normals_;
-    std::vector<std::vector<std::vector<int>>> indices_;
 
     // state
     std::vector<Matrix> R_;
@@ -150,5 +450,31 @@ public:
     // cached center of mass
     std::vector<Vector> coms_;
     std::vector<float> com_weights_;
+
+private:
+    RasterizationMode rasterization_mode_;
+    bool single_precision_;
+    bool back_face_culling_;
+
+    // bounding spheres of the parts, and the level selected per rendering
+    std::vector<Vector> part_centers_;
+    std::vector<double> part_radii_;
+    double pixels_per_triangle_;
+    std::vector<int> levels_;
+    // parts within the view at the last rendering
+    std::vector<bool> visible_;
+    double triangles_per_pixel_;
+    // parts ray cast at the last rendering and the pixels they may cover,
+    // in (col, row)
+    std::vector<bool> ray_cast_;
+    std::vector<Eigen::AlignedBox2d,
+                        Eigen::aligned_allocator<Eigen::AlignedBox2d>>
+        ray_cast_bounds_;
+
+    // scratch buffers reused across Render() calls of the owning thread
+    Projection<double> projection_;
+    Projection<float> single_projection_;
+    std::vector<float> depth_buffer_;
+    std::vector<float> layer_buffer_;
 };
 }
@@ -19,11 +19,19 @@
 
 #include <dbot/simple_wavefront_object_loader.h>
 
+#include <iostream>
+
+#include <dbot/mesh_cache.h>
+
 namespace dbot
 {
 SimpleWavefrontObjectModelLoader::SimpleWavefrontObjectModelLoader(
-    const ObjectResourceIdentifier& ori)
-    : ori_(ori)
+    const ObjectResourceIdentifier& ori,
+    const std::string& mesh_cache_directory,
+    const std::shared_ptr<WorkerPool>& worker_pool)
+    : ori_(ori),
+      mesh_cache_directory_(mesh_cache_directory),
+      worker_pool_(worker_pool)
 {
 }
 
@@ -34,14 +42,39 @@ void SimpleWavefrontObjectModelLoader::load(
     vertices.resize(ori_.count_meshes());
     triangle_indices.resize(ori_.count_meshes());
 
-    for (size_t i = 0; i < ori_.count_meshes(); i++)
+    const MeshCache cache(mesh_cache_directory_);
+    auto load_mesh = [&](int i)
     {
+        if (!mesh_cache_directory_.empty() &&
+            cache.load(ori_.mesh_path(i), 0, vertices[i], triangle_indices[i]))
+        {
+            return;
+        }
+
         ObjectFileReader file_reader;
         file_reader.set_filename(ori_.mesh_path(i));
         file_reader.Read();
 
         vertices[i] = *file_reader.get_vertices();
         triangle_indices[i] = *file_reader.get_indices();
+
+        if (!mesh_cache_directory_.empty() &&
+            !cache.store(
+                ori_.mesh_path(i), 0, vertices[i], triangle_indices[i]))
+        {
+            std::cout << "WARNING: Could not write the mesh cache entry "
+                      << cache.entry_path(ori_.mesh_path(i), 0) << "."
+                      << std::endl;
+        }
+    };
+
+    if (worker_pool_)
+    {
+        worker_pool_->parallel_for(ori_.count_meshes(), load_mesh);
+    }
+    else
+    {
+        for (size_t i = 0; i < ori_.count_meshes(); i++) load_mesh(i);
     }
 }
 }
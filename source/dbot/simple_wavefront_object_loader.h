@@ -13,16 +13,30 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include <dbot/object_file_reader.h>
 #include <dbot/object_model_loader.h>
 #include <dbot/object_resource_identifier.h>
+#include <dbot/worker_pool.h>
 
 namespace dbot
 {
 class SimpleWavefrontObjectModelLoader : public ObjectModelLoader
 {
 public:
-    SimpleWavefrontObjectModelLoader(const ObjectResourceIdentifier& ori);
+    /**
+     * \param mesh_cache_directory  If not empty, parsed meshes are kept in a
+     *                              binary MeshCache in this directory
+     * \param worker_pool           If set, the meshes are read in parallel
+     *                              on the pool
+     */
+    SimpleWavefrontObjectModelLoader(
+        const ObjectResourceIdentifier& ori,
+        const std::string& mesh_cache_directory = "",
+        const std::shared_ptr<WorkerPool>& worker_pool =
+            std::shared_ptr<WorkerPool>());
 
     void load(
         std::vector<std::vector<Eigen::Vector3d>>& vertices,
@@ -30,5 +44,7 @@ public:
 
 private:
     ObjectResourceIdentifier ori_;
+    std::string mesh_cache_directory_;
+    std::shared_ptr<WorkerPool> worker_pool_;
 };
 }
@@ -0,0 +1,194 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+
+/**
+ * \file timeline_trace.cpp
+ * \date October 2026
+ */
+
+#include <dbot/timeline_trace.h>
+
+#include <fstream>
+
+namespace dbot
+{
+namespace
+{
+void write_json_string(std::ostream& stream, const std::string& value)
+{
+    stream << '"';
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\') stream << '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) stream << c;
+    }
+    stream << '"';
+}
+
+void write_name_event(std::ostream& stream,
+                      const char* type,
+                      int process,
+                      int thread,
+                      const std::string& name)
+{
+    stream << "{\"name\":\"" << type << "\",\"ph\":\"M\",\"pid\":" << process
+           << ",\"tid\":" << thread << ",\"args\":{\"name\":";
+    write_json_string(stream, name);
+    stream << "}}";
+}
+}
+
+TimelineTrace::TimelineTrace(size_t max_event_count)
+    : max_event_count_(max_event_count),
+      origin_(Clock::now()),
+      dropped_event_count_(0)
+{
+}
+
+void TimelineTrace::host_span(const std::string& name,
+                              Clock::time_point begin,
+                              Clock::time_point end)
+{
+    Event event;
+    event.name = name;
+    event.device = false;
+    event.begin = std::chrono::duration<double>(begin - origin_).count();
+    event.duration = std::chrono::duration<double>(end - begin).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    event.track = host_track();
+    add(event);
+}
+
+void TimelineTrace::device_span(const std::string& name,
+                                const std::string& track,
+                                double begin,
+                                double seconds)
+{
+    Event event;
+    event.name = name;
+    event.device = true;
+    event.begin = begin - clock_seconds(origin_);
+    event.duration = seconds;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    event.track = device_track(track);
+    add(event);
+}
+
+auto TimelineTrace::events() const -> std::vector<Event>
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+}
+
+size_t TimelineTrace::event_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_.size();
+}
+
+size_t TimelineTrace::dropped_event_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_event_count_;
+}
+
+void TimelineTrace::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+    dropped_event_count_ = 0;
+}
+
+void TimelineTrace::write_chrome_trace(std::ostream& stream) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const int host_process = 1;
+    const int device_process = 2;
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    write_name_event(stream, "process_name", host_process, 0, "host");
+    stream << ",\n";
+    write_name_event(stream, "process_name", device_process, 0, "device");
+    for (size_t i = 0; i < host_threads_.size(); i++)
+    {
+        stream << ",\n";
+        write_name_event(stream,
+                         "thread_name",
+                         host_process,
+                         int(i),
+                         "thread " + std::to_string(i));
+    }
+    for (size_t i = 0; i < device_tracks_.size(); i++)
+    {
+        stream << ",\n";
+        write_name_event(
+            stream, "thread_name", device_process, int(i), device_tracks_[i]);
+    }
+
+    for (const Event& event : events_)
+    {
+        stream << ",\n{\"name\":";
+        write_json_string(stream, event.name);
+        stream << ",\"cat\":\"" << (event.device ? "device" : "host")
+               << "\",\"ph\":\"X\",\"ts\":" << event.begin * 1e6
+               << ",\"dur\":" << event.duration * 1e6 << ",\"pid\":"
+               << (event.device ? device_process : host_process)
+               << ",\"tid\":" << event.track << "}";
+    }
+    stream << "\n]}\n";
+}
+
+bool TimelineTrace::write_chrome_trace(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file) return false;
+    file.precision(15);
+    write_chrome_trace(file);
+    return bool(file);
+}
+
+void TimelineTrace::add(const Event& event)
+{
+    if (events_.size() >= max_event_count_)
+    {
+        dropped_event_count_++;
+        return;
+    }
+    events_.push_back(event);
+}
+
+int TimelineTrace::host_track()
+{
+    const std::thread::id thread = std::this_thread::get_id();
+    for (size_t i = 0; i < host_threads_.size(); i++)
+    {
+        if (host_threads_[i] == thread) return int(i);
+    }
+    host_threads_.push_back(thread);
+    return int(host_threads_.size()) - 1;
+}
+
+int TimelineTrace::device_track(const std::string& name)
+{
+    for (size_t i = 0; i < device_tracks_.size(); i++)
+    {
+        if (device_tracks_[i] == name) return int(i);
+    }
+    device_tracks_.push_back(name);
+    return int(device_tracks_.size()) - 1;
+}
+}
@@ -0,0 +1,121 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+
+/**
+ * \file timeline_trace.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Timeline of host and device spans for latency investigations
+ *
+ * Host spans are recorded per thread, e.g. the stages of the filter which
+ * LatencyMetrics::lap() measures while a trace is attached to the metrics.
+ * Device spans are recorded per track, e.g. the CUDA and OpenGL stages of
+ * the GPU sensor, once their markers are read back. All spans are given on
+ * the steady clock, devices convert their timestamps to it, such that host
+ * and device spans line up on one timeline.
+ *
+ * The trace is written in the Chrome trace event format, which
+ * chrome://tracing and Perfetto display. Recording is thread-safe and stops
+ * once max_event_count spans are recorded, later spans are counted as
+ * dropped.
+ */
+class TimelineTrace
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Event
+    {
+        std::string name;
+        /// index of the host thread or the device track
+        int track;
+        bool device;
+        /// seconds since the creation of the trace
+        double begin;
+        double duration;
+    };
+
+public:
+    explicit TimelineTrace(size_t max_event_count = 1 << 20);
+
+    /**
+     * \brief Records a span of the calling thread
+     */
+    void host_span(const std::string& name,
+                   Clock::time_point begin,
+                   Clock::time_point end);
+
+    /**
+     * \brief Records a span of a device track
+     *
+     * \param begin  start of the span in clock_seconds()
+     */
+    void device_span(const std::string& name,
+                     const std::string& track,
+                     double begin,
+                     double seconds);
+
+    /**
+     * \brief Seconds of the time point since the epoch of the steady clock,
+     *        the time base of device spans
+     */
+    static double clock_seconds(Clock::time_point time)
+    {
+        return std::chrono::duration<double>(time.time_since_epoch()).count();
+    }
+
+    std::vector<Event> events() const;
+    size_t event_count() const;
+    size_t dropped_event_count() const;
+    void clear();
+
+    /**
+     * \brief Writes the spans as Chrome trace events in microseconds, one
+     *        process for the host threads and one for the device tracks
+     */
+    void write_chrome_trace(std::ostream& stream) const;
+
+    /**
+     * \return false if the file could not be written
+     */
+    bool write_chrome_trace(const std::string& path) const;
+
+private:
+    void add(const Event& event);
+    int host_track();
+    int device_track(const std::string& name);
+
+    size_t max_event_count_;
+    Clock::time_point origin_;
+    std::vector<Event> events_;
+    size_t dropped_event_count_;
+    std::vector<std::thread::id> host_threads_;
+    std::vector<std::string> device_tracks_;
+    mutable std::mutex mutex_;
+};
+}
@@ -0,0 +1,93 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+
+/**
+ * \file timeline_trace_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+#include <dbot/latency_metrics.h>
+#include <dbot/timeline_trace.h>
+
+TEST(TimelineTraceTests, laps_are_recorded_as_host_spans)
+{
+    dbot::LatencyMetrics metrics;
+    metrics.trace(std::make_shared<dbot::TimelineTrace>());
+
+    auto since = dbot::LatencyMetrics::Clock::now();
+    metrics.lap(dbot::LatencyMetrics::RESAMPLING, since);
+    std::thread other([&metrics]()
+                      {
+                          metrics.span("other",
+                                       dbot::LatencyMetrics::Clock::now());
+                      });
+    other.join();
+
+    auto events = metrics.trace()->events();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ("resampling", events[0].name);
+    EXPECT_FALSE(events[0].device);
+    EXPECT_EQ(0, events[0].track);
+    EXPECT_GE(events[0].duration, 0);
+    EXPECT_EQ("other", events[1].name);
+    EXPECT_EQ(1, events[1].track);
+}
+
+TEST(TimelineTraceTests, device_spans_share_the_host_clock)
+{
+    dbot::TimelineTrace trace;
+
+    const auto now = dbot::TimelineTrace::Clock::now();
+    trace.host_span("host", now, now + std::chrono::milliseconds(2));
+    trace.device_span("kernel",
+                      "cuda",
+                      dbot::TimelineTrace::clock_seconds(now) + 0.001,
+                      0.0005);
+
+    auto events = trace.events();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_TRUE(events[1].device);
+    EXPECT_NEAR(events[0].begin + 0.001, events[1].begin, 1e-6);
+    EXPECT_NEAR(0.002, events[0].duration, 1e-9);
+}
+
+TEST(TimelineTraceTests, writes_chrome_trace_events)
+{
+    dbot::TimelineTrace trace(2);
+
+    const auto now = dbot::TimelineTrace::Clock::now();
+    trace.host_span("step \"1\"", now, now);
+    trace.device_span("render", "opengl", 0, 0);
+    trace.device_span("dropped", "opengl", 0, 0);
+    EXPECT_EQ(2u, trace.event_count());
+    EXPECT_EQ(1u, trace.dropped_event_count());
+
+    std::ostringstream stream;
+    trace.write_chrome_trace(stream);
+    const std::string json = stream.str();
+
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"step \\\"1\\\"\""));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"name\":\"opengl\"}"));
+    EXPECT_NE(std::string::npos, json.find("\"ph\":\"X\""));
+    EXPECT_EQ(std::string::npos, json.find("dropped"));
+
+    trace.clear();
+    EXPECT_EQ(0u, trace.event_count());
+}
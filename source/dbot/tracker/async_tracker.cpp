@@ -0,0 +1,108 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file async_tracker.cpp
+ * \date October 2026
+ */
+
+#include <dbot/tracker/async_tracker.h>
+
+namespace dbot
+{
+AsyncTracker::AsyncTracker(const std::shared_ptr<Tracker>& tracker,
+                           const Callback& callback,
+                           DropPolicy drop_policy,
+                           size_t capacity)
+    : tracker_(tracker),
+      callback_(callback),
+      drop_policy_(drop_policy),
+      frames_(capacity),
+      processed_count_(0),
+      dropped_count_(0),
+      stop_(false),
+      thread_(&AsyncTracker::run, this)
+{
+}
+
+AsyncTracker::~AsyncTracker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+}
+
+bool AsyncTracker::push(const DepthFrame::ConstPtr& frame)
+{
+    if (!frames_.push(frame))
+    {
+        dropped_count_++;
+        return false;
+    }
+
+    // taking the mutex orders the push before the wake-up check of the
+    // filter thread, such that the notification cannot get lost
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    condition_.notify_one();
+    return true;
+}
+
+auto AsyncTracker::next_state() -> std::future<State>
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    promises_.push_back(std::promise<State>());
+    return promises_.back().get_future();
+}
+
+void AsyncTracker::run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock,
+                            [this]() { return stop_ || !frames_.empty(); });
+            if (stop_) return;
+        }
+
+        DepthFrame::ConstPtr frame;
+        if (drop_policy_ == PROCESS_LATEST)
+        {
+            const size_t count = frames_.pop_latest(frame);
+            if (count > 1) dropped_count_ += count - 1;
+        }
+        else
+        {
+            frames_.pop(frame);
+        }
+        if (!frame) continue;
+
+        const State state = tracker_->track(frame);
+        processed_count_++;
+
+        if (callback_) callback_(frame, state);
+
+        std::vector<std::promise<State>> promises;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            promises.swap(promises_);
+        }
+        for (auto& promise : promises) promise.set_value(state);
+    }
+}
+}
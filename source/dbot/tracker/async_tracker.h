@@ -0,0 +1,118 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file async_tracker.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dbot/depth_frame.h>
+#include <dbot/tracker/frame_ring_buffer.h>
+#include <dbot/tracker/tracker.h>
+
+namespace dbot
+{
+/**
+ * \brief Runs the filter steps of a tracker on a dedicated thread
+ *
+ * The camera thread pushes frames into a lock-free ring buffer and returns
+ * immediately, while the filter thread takes the frames out of the buffer.
+ * With PROCESS_LATEST, frames which arrived during a filter step are skipped
+ * except for the newest one, such that the latency stays at about one filter
+ * step however fast the frames arrive. The time steps of the sensor are taken
+ * from the frame timestamps where they are known.
+ *
+ * Results are published through the callback, which is called on the filter
+ * thread, and through the futures of next_state().
+ */
+class AsyncTracker
+{
+public:
+    typedef Tracker::State State;
+    typedef std::function<void(const DepthFrame::ConstPtr& frame,
+                               const State& state)> Callback;
+
+    enum DropPolicy
+    {
+        /// only the newest buffered frame is processed
+        PROCESS_LATEST,
+        /// the buffered frames are processed in order, frames are only
+        /// dropped if the buffer is full
+        PROCESS_ALL
+    };
+
+public:
+    /**
+     * \param tracker      initialized tracker which runs the filter steps
+     * \param callback     called with every frame and its state, may be empty
+     * \param drop_policy  which of the buffered frames are processed
+     * \param capacity     number of frames the ring buffer holds
+     */
+    AsyncTracker(const std::shared_ptr<Tracker>& tracker,
+                 const Callback& callback = Callback(),
+                 DropPolicy drop_policy = PROCESS_LATEST,
+                 size_t capacity = 4);
+
+    /**
+     * \brief Stops the filter thread after the current filter step. Buffered
+     *        frames are dropped and pending futures are abandoned.
+     */
+    ~AsyncTracker();
+
+    /**
+     * \brief Queues a frame, must only be called from one thread at a time
+     * \return false if the buffer was full and the frame was dropped
+     */
+    bool push(const DepthFrame::ConstPtr& frame);
+
+    /**
+     * \brief Returns a future of the state of the next processed frame
+     */
+    std::future<State> next_state();
+
+    /// number of frames which were processed
+    size_t processed_count() const { return processed_count_; }
+    /// number of frames which were dropped, either on push() or by the policy
+    size_t dropped_count() const { return dropped_count_; }
+
+private:
+    void run();
+
+    std::shared_ptr<Tracker> tracker_;
+    Callback callback_;
+    DropPolicy drop_policy_;
+    FrameRingBuffer frames_;
+
+    std::atomic<size_t> processed_count_;
+    std::atomic<size_t> dropped_count_;
+
+    // the buffer itself is lock-free, the mutex only guards the wake-up of
+    // the filter thread and the promises
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<std::promise<State>> promises_;
+    bool stop_;
+    std::thread thread_;
+};
+}
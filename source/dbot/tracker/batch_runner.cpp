@@ -0,0 +1,155 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_runner.cpp
+ * \date October 2026
+ */
+
+#include <dbot/tracker/batch_runner.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+#include <boost/filesystem.hpp>
+
+#include <dbot/depth_sequence.h>
+
+namespace dbot
+{
+BatchRunner::BatchRunner(int worker_count, const TrackerFactory& factory)
+    : trackers_(std::max(worker_count, 1))
+{
+    for (size_t i = 0; i < trackers_.size(); i++)
+    {
+        workers_.emplace_back(new WorkerThread());
+        workers_[i]->post(
+            [this, i, factory]() { trackers_[i] = factory(int(i)); });
+    }
+    for (auto& worker : workers_) worker->wait();
+
+    for (size_t i = 0; i < trackers_.size(); i++)
+    {
+        if (!trackers_[i])
+        {
+            std::cout << "ERROR: no tracker for batch worker " << i
+                      << std::endl;
+            exit(-1);
+        }
+    }
+}
+
+BatchRunner::~BatchRunner()
+{
+    for (size_t i = 0; i < workers_.size(); i++)
+    {
+        workers_[i]->post([this, i]() { trackers_[i].reset(); });
+    }
+    workers_.clear();
+}
+
+BatchStatistics BatchRunner::run(const std::vector<BatchSequence>& sequences,
+                                 const Callback& callback)
+{
+    // the longest sequences first, such that no worker starts a long one
+    // when the others are about to finish
+    std::vector<uintmax_t> sizes(sequences.size());
+    std::vector<size_t> order(sequences.size());
+    for (size_t i = 0; i < sequences.size(); i++)
+    {
+        boost::system::error_code error;
+        sizes[i] = boost::filesystem::file_size(sequences[i].path, error);
+        if (error) sizes[i] = 0;
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [&sizes](size_t a, size_t b)
+                     {
+                         return sizes[a] > sizes[b];
+                     });
+
+    BatchStatistics statistics;
+    statistics.sequence_count = sequences.size();
+    statistics.worker_frame_counts.assign(workers_.size(), 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    std::mutex failures_mutex;
+    auto track_sequences = [&](size_t i_worker)
+    {
+        Tracker& tracker = *trackers_[i_worker];
+        size_t& frame_count = statistics.worker_frame_counts[i_worker];
+        for (size_t i = next++; i < order.size(); i = next++)
+        {
+            const size_t i_sequence = order[i];
+            const BatchSequence& sequence = sequences[i_sequence];
+
+            size_t i_frame = 0;
+            try
+            {
+                DepthSequenceReader reader(sequence.path);
+
+                tracker.reset_observations();
+                tracker.initialize(sequence.initial_states);
+                for (; i_frame < reader.frame_count(); i_frame++)
+                {
+                    const DepthFrame::ConstPtr frame = reader.frame(i_frame);
+                    const State state = tracker.track(frame);
+                    if (callback)
+                    {
+                        callback(
+                            i_sequence, i_frame, frame->timestamp(), state);
+                    }
+                }
+            }
+            catch (const DepthSequenceException& exception)
+            {
+                std::cout << "WARNING: Skipping the rest of " << sequence.path
+                          << ": " << exception.what() << std::endl;
+
+                std::lock_guard<std::mutex> lock(failures_mutex);
+                statistics.failures.push_back(
+                    BatchFailure{i_sequence, i_frame, exception.what()});
+            }
+            frame_count += i_frame;
+        }
+    };
+    for (size_t i_worker = 0; i_worker < workers_.size(); i_worker++)
+    {
+        workers_[i_worker]->post(
+            [&track_sequences, i_worker]() { track_sequences(i_worker); });
+    }
+    for (auto& worker : workers_) worker->wait();
+    std::sort(statistics.failures.begin(),
+              statistics.failures.end(),
+              [](const BatchFailure& a, const BatchFailure& b)
+              {
+                  return a.sequence_index < b.sequence_index;
+              });
+
+    statistics.seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    for (const size_t count : statistics.worker_frame_counts)
+    {
+        statistics.frame_count += count;
+    }
+    return statistics;
+}
+}
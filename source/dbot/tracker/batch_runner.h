@@ -0,0 +1,130 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_runner.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dbot/tracker/tracker.h>
+#include <dbot/worker_thread.h>
+
+namespace dbot
+{
+/**
+ * \brief Recorded sequence, see DepthSequenceWriter, and the initial states
+ *        of the object in it
+ */
+struct BatchSequence
+{
+    std::string path;
+    std::vector<Tracker::State> initial_states;
+};
+
+/**
+ * \brief Sequence which could not be read to its end
+ */
+struct BatchFailure
+{
+    size_t sequence_index;
+    /// frames which were tracked before the failure
+    size_t frame_count;
+    std::string message;
+};
+
+/**
+ * \brief Totals of BatchRunner::run()
+ */
+struct BatchStatistics
+{
+    size_t sequence_count = 0;
+    size_t frame_count = 0;
+    double seconds = 0;
+    /// [worker_nr] = {frames the worker tracked}
+    std::vector<size_t> worker_frame_counts;
+    /// sequences which could not be read, in the order of their indices
+    std::vector<BatchFailure> failures;
+
+    double frames_per_second() const
+    {
+        return seconds > 0 ? frame_count / seconds : 0;
+    }
+};
+
+/**
+ * \brief Tracks many independent recorded sequences for the total frame
+ *        rate rather than the latency of each frame
+ *
+ * Each worker owns a thread and a tracker, which the factory creates on
+ * that thread once, such that GL contexts stay with their thread. The
+ * workers take the sequences one by one, the longest files first, and
+ * track all their frames back to back. Before every sequence the tracker
+ * forgets the observations of the previous one and is initialized with
+ * the states of the sequence. A sequence which cannot be read, e.g. a
+ * corrupt recording, is skipped from the failing frame on and reported in
+ * BatchStatistics::failures, the other sequences are tracked regardless.
+ *
+ * The factory places the workers: a worker per GPU spreads the sequences
+ * across the devices, e.g. through the GPU displays of the sensor, and
+ * several workers per GPU interleave their streams on one device, such that
+ * one worker renders and weights while another resamples on the CPU. CPU
+ * workers track on sensors with a single thread best.
+ */
+class BatchRunner
+{
+public:
+    typedef Tracker::State State;
+
+    /**
+     * \brief Creates the tracker of a worker, called on the worker thread
+     */
+    typedef std::function<std::shared_ptr<Tracker>(int worker_index)>
+        TrackerFactory;
+
+    /**
+     * \brief Receives the moving average of every frame, called on the
+     *        worker thread which tracked it
+     */
+    typedef std::function<void(size_t sequence_index,
+                               size_t frame_index,
+                               double timestamp,
+                               const State& state)> Callback;
+
+public:
+    BatchRunner(int worker_count, const TrackerFactory& factory);
+
+    /**
+     * \brief Destroys the trackers on their worker threads
+     */
+    ~BatchRunner();
+
+    /**
+     * \brief Tracks all sequences and returns once they are done
+     */
+    BatchStatistics run(const std::vector<BatchSequence>& sequences,
+                        const Callback& callback = Callback());
+
+    int worker_count() const { return workers_.size(); }
+
+private:
+    std::vector<std::unique_ptr<WorkerThread>> workers_;
+    std::vector<std::shared_ptr<Tracker>> trackers_;
+};
+}
@@ -0,0 +1,194 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_runner_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <unistd.h>
+
+#include <dbot/depth_sequence.h>
+#include <dbot/tracker/batch_runner.h>
+
+namespace
+{
+typedef dbot::Tracker::State State;
+
+/**
+ * \brief Tracker which checks that it tracks on the thread it was created on
+ *        and after its observations were reset
+ */
+class DepthTracker : public dbot::Tracker
+{
+public:
+    DepthTracker()
+        : dbot::Tracker(std::make_shared<dbot::ObjectModel>(), 1, false),
+          thread_(std::this_thread::get_id())
+    {
+    }
+
+    State on_track(const Obsrv& image) { return State(); }
+
+    State on_track_frame(const dbot::DepthFrame::ConstPtr& frame)
+    {
+        EXPECT_EQ(thread_, std::this_thread::get_id());
+        EXPECT_TRUE(reset_);
+        return State();
+    }
+
+    State on_initialize(const std::vector<State>& initial_states)
+    {
+        return State();
+    }
+
+    void reset_observations() { reset_ = true; }
+
+private:
+    std::thread::id thread_;
+    bool reset_ = false;
+};
+
+std::string sequence_path(int index)
+{
+    return "/tmp/dbot_batch_runner_test_" + std::to_string(getpid()) + "_" +
+           std::to_string(index) + ".dseq";
+}
+
+void write_sequence(const std::string& path, int index, int frame_count)
+{
+    dbot::DepthSequenceInfo info;
+    info.frame_id = "/camera_depth_optical_frame";
+    info.camera_matrix << 290, 0, 160, 0, 290, 120, 0, 0, 1;
+    info.native_resolution.width = 4;
+    info.native_resolution.height = 3;
+    info.downsampling_factor = 1;
+
+    dbot::DepthSequenceWriter writer(path, info);
+    for (int i = 0; i < frame_count; i++)
+    {
+        dbot::DepthFrame frame(3, 4);
+        frame.image().setConstant(index);
+        writer.write(frame, 1000 * index + i);
+    }
+}
+
+/**
+ * \brief Sets an unknown compression in the header of the first chunk
+ */
+void corrupt_sequence(const std::string& path)
+{
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    const size_t offset = content.find("FRAM");
+    ASSERT_NE(offset, std::string::npos);
+    file.seekp(offset + 4);
+    file.put(7);
+}
+}
+
+TEST(BatchRunnerTests, tracks_every_frame_of_every_sequence_once)
+{
+    const int sequence_count = 7;
+    std::vector<dbot::BatchSequence> sequences(sequence_count);
+    size_t total_frames = 0;
+    for (int i = 0; i < sequence_count; i++)
+    {
+        sequences[i].path = sequence_path(i);
+        write_sequence(sequences[i].path, i, 2 + i);
+        total_frames += 2 + i;
+    }
+
+    std::mutex mutex;
+    std::set<std::pair<size_t, size_t>> tracked;
+    bool timestamps_match = true;
+    const dbot::BatchRunner::Callback callback =
+        [&](size_t sequence, size_t frame, double timestamp, const State&)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tracked.insert(std::make_pair(sequence, frame));
+        timestamps_match =
+            timestamps_match && timestamp == 1000. * sequence + frame;
+    };
+
+    dbot::BatchStatistics statistics;
+    {
+        dbot::BatchRunner runner(
+            3, [](int) { return std::make_shared<DepthTracker>(); });
+        EXPECT_EQ(3, runner.worker_count());
+        statistics = runner.run(sequences, callback);
+    }
+
+    EXPECT_EQ(total_frames, tracked.size());
+    EXPECT_TRUE(timestamps_match);
+    EXPECT_EQ(size_t(sequence_count), statistics.sequence_count);
+    EXPECT_EQ(total_frames, statistics.frame_count);
+    ASSERT_EQ(3u, statistics.worker_frame_counts.size());
+
+    size_t worker_frames = 0;
+    for (size_t count : statistics.worker_frame_counts) worker_frames += count;
+    EXPECT_EQ(total_frames, worker_frames);
+
+    for (const auto& sequence : sequences) std::remove(sequence.path.c_str());
+}
+
+TEST(BatchRunnerTests, skips_and_reports_unreadable_sequences)
+{
+    const int sequence_count = 4;
+    std::vector<dbot::BatchSequence> sequences(sequence_count);
+    for (int i = 0; i < sequence_count; i++)
+    {
+        sequences[i].path = sequence_path(i);
+        write_sequence(sequences[i].path, i, 3);
+    }
+    corrupt_sequence(sequences[1].path);
+    sequences[3].path += ".missing";
+
+    std::mutex mutex;
+    std::set<size_t> tracked;
+    const dbot::BatchRunner::Callback callback =
+        [&](size_t sequence, size_t, double, const State&)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tracked.insert(sequence);
+    };
+
+    dbot::BatchStatistics statistics;
+    {
+        dbot::BatchRunner runner(
+            2, [](int) { return std::make_shared<DepthTracker>(); });
+        statistics = runner.run(sequences, callback);
+    }
+
+    EXPECT_EQ((std::set<size_t>{0, 2}), tracked);
+    EXPECT_EQ(6u, statistics.frame_count);
+    ASSERT_EQ(2u, statistics.failures.size());
+    EXPECT_EQ(1u, statistics.failures[0].sequence_index);
+    EXPECT_EQ(3u, statistics.failures[1].sequence_index);
+    EXPECT_EQ(0u, statistics.failures[0].frame_count);
+    EXPECT_FALSE(statistics.failures[0].message.empty());
+
+    for (int i = 0; i < sequence_count; i++)
+    {
+        std::remove(sequence_path(i).c_str());
+    }
+}
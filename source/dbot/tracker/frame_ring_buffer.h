@@ -0,0 +1,100 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_ring_buffer.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <dbot/depth_frame.h>
+
+namespace dbot
+{
+/**
+ * \brief Lock-free ring buffer of depth frames between one producer and one
+ *        consumer thread
+ *
+ * The producer only writes the tail and the consumer only writes the head,
+ * such that neither has to wait for the other. A frame stays referenced by
+ * its slot until the slot is reused.
+ */
+class FrameRingBuffer
+{
+public:
+    explicit FrameRingBuffer(size_t capacity)
+        : slots_(capacity + 1), head_(0), tail_(0)
+    {
+    }
+
+    size_t capacity() const { return slots_.size() - 1; }
+
+    /**
+     * \brief Appends the frame, called by the producer
+     * \return false if the buffer is full and the frame was not added
+     */
+    bool push(const DepthFrame::ConstPtr& frame)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) % slots_.size();
+        if (next == head_.load(std::memory_order_acquire)) return false;
+
+        slots_[tail] = frame;
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Removes the oldest frame, called by the consumer
+     * \return false if the buffer is empty
+     */
+    bool pop(DepthFrame::ConstPtr& frame)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+
+        frame.swap(slots_[head]);
+        slots_[head].reset();
+        head_.store((head + 1) % slots_.size(), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Removes all frames but the newest one, which is returned, called
+     *        by the consumer
+     * \return number of frames removed, 0 if the buffer is empty
+     */
+    size_t pop_latest(DepthFrame::ConstPtr& frame)
+    {
+        size_t count = 0;
+        while (pop(frame)) count++;
+        return count;
+    }
+
+    bool empty() const
+    {
+        return head_.load(std::memory_order_acquire) ==
+               tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<DepthFrame::ConstPtr> slots_;
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+};
+}
@@ -0,0 +1,80 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_ring_buffer_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <dbot/tracker/frame_ring_buffer.h>
+
+namespace
+{
+dbot::DepthFrame::ConstPtr make_frame(double timestamp)
+{
+    auto frame = std::make_shared<dbot::DepthFrame>(1, 1);
+    frame->timestamp(timestamp);
+    return frame;
+}
+}
+
+TEST(FrameRingBufferTests, drops_frames_when_full)
+{
+    dbot::FrameRingBuffer buffer(2);
+
+    EXPECT_TRUE(buffer.push(make_frame(1)));
+    EXPECT_TRUE(buffer.push(make_frame(2)));
+    EXPECT_FALSE(buffer.push(make_frame(3)));
+
+    dbot::DepthFrame::ConstPtr frame;
+    ASSERT_TRUE(buffer.pop(frame));
+    EXPECT_EQ(frame->timestamp(), 1);
+    EXPECT_TRUE(buffer.push(make_frame(4)));
+
+    EXPECT_EQ(buffer.pop_latest(frame), 2u);
+    EXPECT_EQ(frame->timestamp(), 4);
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(buffer.pop_latest(frame), 0u);
+}
+
+TEST(FrameRingBufferTests, hands_frames_between_threads_in_order)
+{
+    const int count = 10000;
+    dbot::FrameRingBuffer buffer(8);
+
+    std::thread producer([&buffer]() {
+        for (int i = 1; i <= count; i++)
+        {
+            auto frame = make_frame(i);
+            while (!buffer.push(frame)) std::this_thread::yield();
+        }
+    });
+
+    int expected = 1;
+    while (expected <= count)
+    {
+        dbot::DepthFrame::ConstPtr frame;
+        if (!buffer.pop(frame))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(frame->timestamp(), expected);
+        expected++;
+    }
+    producer.join();
+}
@@ -29,9 +29,11 @@ GaussianTracker::GaussianTracker(
     const std::shared_ptr<Filter>& filter,
     const std::shared_ptr<ObjectModel>& object_model,
     double update_rate,
-    bool center_object_frame)
+    bool center_object_frame,
+    int pixel_region_margin)
     : Tracker(object_model, update_rate, center_object_frame),
       filter_(filter),
+      pixel_region_margin_(pixel_region_margin),
       belief_(filter_->create_belief())
 {
 }
@@ -60,12 +62,16 @@ auto GaussianTracker::on_track(const Obsrv& obsrv) -> State
     State old_pose = belief_.mean();
     filter_->sensor().local_sensor().body_model().nominal_pose(old_pose);
 
+    const Obsrv& selected_obsrv =
+        pixel_region_margin_ >= 0 ? select_pixels(obsrv) : obsrv;
+
     State zero_pose = belief_.mean();
     zero_pose.set_zero_pose();
     belief_.mean(zero_pose);
 
     filter_->predict(belief_, zero_input(), belief_);
-    filter_->update(belief_, obsrv, belief_);
+    render_sigma_points();
+    filter_->update(belief_, selected_obsrv, belief_);
 
     State delta_mean = belief_.mean();
     State new_pose = old_pose;
@@ -75,4 +81,56 @@ auto GaussianTracker::on_track(const Obsrv& obsrv) -> State
 
     return belief_.mean();
 }
+
+Eigen::VectorXd GaussianTracker::belief_standard_deviation()
+{
+    return belief_.covariance().diagonal().cwiseMax(0.).cwiseSqrt();
+}
+
+auto GaussianTracker::select_pixels(const Obsrv& obsrv) -> const Obsrv&
+{
+    auto& local_sensor = filter_->sensor().local_sensor();
+    auto& body_model = local_sensor.body_model();
+
+    std::vector<int> pixels =
+        body_model.projected_pixels(pixel_region_margin_);
+    const int pixel_count = pixels.empty() ? obsrv.size() : pixels.size();
+
+    region_obsrv_.resize(pixels.size());
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        region_obsrv_(i) = obsrv(pixels[i]);
+    }
+    body_model.pixels(pixels);
+
+    // the joint sensor has one local sensor per selected pixel
+    if (filter_->sensor().count() != pixel_count)
+    {
+        filter_->sensor() = Sensor(local_sensor, pixel_count);
+    }
+
+    return pixels.empty() ? obsrv : region_obsrv_;
+}
+
+void GaussianTracker::render_sigma_points()
+{
+    auto& local_sensor = filter_->sensor().local_sensor();
+
+    // the update integrates every pixel over the state jointly with the
+    // local noise of the pixel, hence the state points are those of this
+    // augmented Gaussian
+    fl::Gaussian<Eigen::VectorXd> local_noise(local_sensor.noise_dimension());
+    fl::PointSet<State, Eigen::Dynamic> state_points;
+    fl::PointSet<Eigen::VectorXd, Eigen::Dynamic> noise_points;
+    filter_->quadrature().transform_to_points(
+        belief_, local_noise, state_points, noise_points);
+
+    std::vector<State> states(state_points.count());
+    for (int i = 0; i < state_points.count(); ++i)
+    {
+        states[i] = state_points.point(i);
+    }
+
+    local_sensor.body_model().render_batch(states);
+}
 }
@@ -88,11 +88,15 @@ public:
      *     Camera data container
      * \param update_rate
      *     Moving average update rate
+     * \param pixel_region_margin
+     *     If not negative, only the pixels within the projected bounding box
+     *     of the object plus this margin are evaluated in each update
      */
     GaussianTracker(const std::shared_ptr<Filter>& filter,
                     const std::shared_ptr<ObjectModel>& object_model,
                     double update_rate,
-                    bool center_object_frame);
+                    bool center_object_frame,
+                    int pixel_region_margin = -1);
 
     /**
      * \brief perform a single filter step
@@ -110,8 +114,32 @@ public:
      */
     State on_initialize(const std::vector<State>& initial_states);
 
+protected:
+    /**
+     * \brief Square root of the diagonal of the belief covariance
+     */
+    Eigen::VectorXd belief_standard_deviation();
+
 private:
+    /**
+     * \brief Renders the sigma points of the coming update in one batch,
+     *        such that the pixel models of the update only read the cached
+     *        depth images instead of rendering one point at a time
+     */
+    void render_sigma_points();
+
+    /**
+     * \brief Restricts the sensor to the pixels around the object at the
+     *        nominal pose and gathers their observations
+     *
+     * \return the observation of the selected pixels, or the given one if
+     * the object does not project into the image
+     */
+    const Obsrv& select_pixels(const Obsrv& obsrv);
+
     std::shared_ptr<Filter> filter_;
+    int pixel_region_margin_;
+    Obsrv region_obsrv_;
     Belief belief_;
 };
 }
@@ -21,55 +21,12 @@
  *
  */
 
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
 #include <dbot/tracker/particle_tracker.h>
+#include <dbot/tracker/particle_tracker.hpp>
 
 namespace dbot
 {
-ParticleTracker::ParticleTracker(
-    const std::shared_ptr<Filter>& filter,
-    const std::shared_ptr<ObjectModel>& object_model,
-    int evaluation_count,
-    double update_rate,
-    bool center_object_frame)
-    : Tracker(object_model, update_rate, center_object_frame),
-      filter_(filter),
-      evaluation_count_(evaluation_count)
-{
-}
-
-auto ParticleTracker::on_initialize(
-    const std::vector<State>& initial_states) -> State
-{
-    filter_->set_particles(initial_states);
-    filter_->resample(evaluation_count_ / filter_->sampling_blocks().size());
-
-    State delta_mean = filter_->belief().mean();
-
-    for (size_t i = 0; i < filter_->belief().size(); i++)
-    {
-        filter_->belief().location(i).subtract(delta_mean);
-    }
-
-    auto& integrated_poses = filter_->sensor()->integrated_poses();
-    integrated_poses.apply_delta(delta_mean);
-
-    return integrated_poses;
-}
-
-auto ParticleTracker::on_track(const Obsrv& image) -> State
-{
-    filter_->filter(image, zero_input());
-
-    State delta_mean = filter_->belief().mean();
-
-    for (size_t i = 0; i < filter_->belief().size(); i++)
-    {
-        filter_->belief().location(i).subtract(delta_mean);
-    }
-
-    auto& integrated_poses = filter_->sensor()->integrated_poses();
-    integrated_poses.apply_delta(delta_mean);
-
-    return integrated_poses;
-}
+template class BasicParticleTracker<FreeFloatingRigidBodiesState<>>;
+template class BasicParticleTracker<FreeFloatingRigidBodiesState<1>>;
 }
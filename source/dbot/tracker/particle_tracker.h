@@ -33,18 +33,53 @@
 #include <fl/model/transition/interface/transition_function.hpp>
 
 #include <dbot/tracker/tracker.h>
+#include <dbot/filter/normal_generator.h>
+#include <dbot/frame_change_detector.h>
 #include <dbot/filter/rao_blackwell_coordinate_particle_filter.h>
 
 namespace dbot
 {
 /**
- * \brief ParticleTracker
+ * \brief Parameters of ParticleTracker::reacquire()
+ *
+ * The particles are drawn around the seed poses with the given standard
+ * deviations and filtered on the same frame for the given number of
+ * iterations. The likelihoods are raised to an exponent which rises
+ * geometrically from initial_likelihood_exponent to 1, such that the early
+ * iterations do not collapse on the first local maximum.
+ */
+struct ReacquisitionParameters
+{
+    /// particles during the reacquisition, capped by the capacity of the
+    /// sensor. 0 for the capacity, or 10 times the evaluation count of a
+    /// sensor without a limit
+    int particle_count = 0;
+    int iterations = 3;
+    double initial_likelihood_exponent = 0.1;
+    /// in meters
+    double position_sigma = 0.05;
+    /// in radians
+    double orientation_sigma = 0.3;
+};
+
+/**
+ * \brief Particle filter based tracker
+ *
+ * The filter, its transition and its sensor run on FilterState, which may
+ * have a fixed number of bodies, e.g. FreeFloatingRigidBodiesState<1>. The
+ * particles and noises are fixed-size Eigen types then. The states are
+ * converted from and to the dynamic Tracker::State once per filter step. The
+ * tracker is instantiated for the dynamic and the single body state,
+ * particle_tracker.hpp has to be included for other body counts.
  */
-class ParticleTracker : public Tracker
+template <typename FilterState_ = Tracker::State>
+class BasicParticleTracker : public Tracker
 {
 public:
-    typedef fl::TransitionFunction<State, Noise, Input> Transition;
-    typedef RbSensor<State> Sensor;
+    typedef FilterState_ FilterState;
+    typedef typename ObjectStateTrait<FilterState>::Noise FilterNoise;
+    typedef fl::TransitionFunction<FilterState, FilterNoise, Input> Transition;
+    typedef RbSensor<FilterState> Sensor;
 
     typedef RaoBlackwellCoordinateParticleFilter<Transition, Sensor> Filter;
 
@@ -61,7 +96,7 @@ public:
      * \param update_rate
      *     Moving average update rate
      */
-    ParticleTracker(
+    BasicParticleTracker(
         const std::shared_ptr<Filter>& filter,
         const std::shared_ptr<ObjectModel>& object_model,
         int evaluation_count,
@@ -69,7 +104,7 @@ public:
         bool center_object_frame);
     
 
-    virtual ~ParticleTracker() { }
+    virtual ~BasicParticleTracker() { }
 
     /**
      * \brief perform a single filter step
@@ -79,6 +114,25 @@ public:
      */
     State on_track(const Obsrv& image);
 
+    /**
+     * \brief perform a single filter step on a depth frame which the sensor
+     *     reads in place. Frames in which the frame change detector sees no
+     *     change only advance the prediction, see frame_change_detector()
+     *
+     * \param frame
+     *     Current depth frame
+     */
+    State on_track_frame(const DepthFrame::ConstPtr& frame);
+
+    /**
+     * \brief perform a single filter step on one depth frame per camera view
+     *     of the sensor
+     *
+     * \param frames
+     *     Current depth frames
+     */
+    State on_track_frames(const std::vector<DepthFrame::ConstPtr>& frames);
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *    the number of evaluations
@@ -87,8 +141,84 @@ public:
      */
     State on_initialize(const std::vector<State>& initial_states);
 
+    /**
+     * \brief Resets the sensor and drops the reference frame of the frame
+     *     change detector
+     */
+    void reset_observations();
+
+    /**
+     * \brief Recovers a lost object by filtering the frame with a burst of
+     *     particles around the seeds, see ReacquisitionParameters. The
+     *     filter returns to the evaluation count afterwards, such that the
+     *     following steps cost as much as before.
+     *
+     * \param seeds
+     *     Poses to search around, e.g. external detections, in the model
+     *     coordinate system. The last estimate if empty
+     * \return The new moving average, which jumps to the recovered pose
+     */
+    State reacquire(const DepthFrame::ConstPtr& frame,
+                    const std::vector<State>& seeds = std::vector<State>());
+
+    const ReacquisitionParameters& reacquisition() const
+    {
+        return reacquisition_;
+    }
+    void reacquisition(const ReacquisitionParameters& params)
+    {
+        reacquisition_ = params;
+    }
+
+    /**
+     * \brief Detector of the frames on_track_frame() skips, none processes
+     *     every frame. Skipped frames advance the observation time of the
+     *     sensor and the particles by the transition without noise, nothing
+     *     is rendered or weighted.
+     */
+    const std::shared_ptr<FrameChangeDetector>& frame_change_detector() const
+    {
+        return frame_change_detector_;
+    }
+    void frame_change_detector(
+        const std::shared_ptr<FrameChangeDetector>& detector)
+    {
+        frame_change_detector_ = detector;
+    }
+
+protected:
+    /**
+     * \brief Weighted standard deviation of the particles, which are
+     *     relative to the mean after every step
+     */
+    Eigen::VectorXd belief_standard_deviation();
+
 private:
+    typedef std::vector<FilterState, Eigen::aligned_allocator<FilterState>>
+        FilterStates;
+
+    /**
+     * \brief Moves the mean of the belief into the integrated poses of the
+     *     sensor and returns them
+     */
+    State integrate_belief_mean();
+
+    /**
+     * \brief Draws the particles of the reacquisition around the seeds in
+     *     the center coordinate system, relative to the integrated poses
+     */
+    void draw_reacquisition_particles(const FilterStates& seeds);
+
     std::shared_ptr<Filter> filter_;
     int evaluation_count_;
+    ReacquisitionParameters reacquisition_;
+    NormalGenerator reacquisition_noise_;
+    uint64_t reacquisition_count_ = 0;
+    FilterStates reacquisition_particles_;
+    std::vector<fl::Real> reacquisition_samples_;
+    std::shared_ptr<FrameChangeDetector> frame_change_detector_;
+    FrameChangeDetector::Poses change_detection_poses_;
 };
+
+typedef BasicParticleTracker<> ParticleTracker;
 }
@@ -0,0 +1,262 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/*
+ * This file implements a part of the algorithm published in:
+ *
+ * M. Wuthrich, P. Pastor, M. Kalakrishnan, J. Bohg, and S. Schaal.
+ * Probabilistic Object Tracking using a Range Camera
+ * IEEE Intl Conf on Intelligent Robots and Systems, 2013
+ * http://arxiv.org/abs/1505.00241
+ *
+ */
+
+/**
+ * \file particle_tracker.hpp
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#include <dbot/tracker/particle_tracker.h>
+
+namespace dbot
+{
+template <typename FilterState_>
+BasicParticleTracker<FilterState_>::BasicParticleTracker(
+    const std::shared_ptr<Filter>& filter,
+    const std::shared_ptr<ObjectModel>& object_model,
+    int evaluation_count,
+    double update_rate,
+    bool center_object_frame)
+    : Tracker(object_model, update_rate, center_object_frame),
+      filter_(filter),
+      evaluation_count_(evaluation_count)
+{
+    const int body_count = object_model->count_parts();
+    if (FilterState::SizeAtCompileTime != Eigen::Dynamic &&
+        FilterState::SizeAtCompileTime != body_count * FilterState::BODY_SIZE)
+    {
+        std::cout << "ERROR: object model of " << body_count << " parts "
+                  << "for a tracker of "
+                  << FilterState::SizeAtCompileTime / FilterState::BODY_SIZE
+                  << " bodies" << std::endl;
+        exit(-1);
+    }
+
+    filter_->latency_metrics(latency_metrics_);
+}
+
+template <typename FilterState_>
+auto BasicParticleTracker<FilterState_>::on_initialize(
+    const std::vector<State>& initial_states) -> State
+{
+    FilterStates states;
+    for (const State& state : initial_states)
+    {
+        states.push_back(FilterState(state));
+    }
+    filter_->set_particles(states);
+    filter_->resample(evaluation_count_ / filter_->sampling_blocks().size());
+    if (frame_change_detector_) frame_change_detector_->reset();
+
+    return integrate_belief_mean();
+}
+
+template <typename FilterState_>
+void BasicParticleTracker<FilterState_>::reset_observations()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    filter_->sensor()->reset();
+    if (frame_change_detector_) frame_change_detector_->reset();
+}
+
+template <typename FilterState_>
+auto BasicParticleTracker<FilterState_>::on_track(const Obsrv& image) -> State
+{
+    filter_->filter(image, zero_input());
+
+    return integrate_belief_mean();
+}
+
+template <typename FilterState_>
+auto BasicParticleTracker<FilterState_>::on_track_frame(
+    const DepthFrame::ConstPtr& frame) -> State
+{
+    if (!frame_change_detector_)
+    {
+        filter_->filter(frame, zero_input());
+        return integrate_belief_mean();
+    }
+
+    const auto& integrated_poses = filter_->sensor()->integrated_poses();
+    change_detection_poses_.resize(integrated_poses.count());
+    for (size_t i = 0; i < change_detection_poses_.size(); i++)
+    {
+        change_detection_poses_[i] = integrated_poses.component(i).affine();
+    }
+
+    if (frame_change_detector_->skip(*frame, change_detection_poses_))
+    {
+        filter_->predict(frame, zero_input());
+    }
+    else
+    {
+        filter_->filter(frame, zero_input());
+        frame_change_detector_->processed(frame);
+    }
+
+    return integrate_belief_mean();
+}
+
+template <typename FilterState_>
+auto BasicParticleTracker<FilterState_>::on_track_frames(
+    const std::vector<DepthFrame::ConstPtr>& frames) -> State
+{
+    filter_->filter(frames, zero_input());
+
+    return integrate_belief_mean();
+}
+
+template <typename FilterState_>
+auto BasicParticleTracker<FilterState_>::reacquire(
+    const DepthFrame::ConstPtr& frame,
+    const std::vector<State>& seeds) -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    FilterStates centers;
+    for (const State& seed : seeds)
+    {
+        centers.push_back(FilterState(to_center_coordinate_system(seed)));
+    }
+    if (centers.empty())
+    {
+        centers.push_back(FilterState(filter_->sensor()->integrated_poses()));
+    }
+    draw_reacquisition_particles(centers);
+    filter_->set_particles(reacquisition_particles_);
+
+    // the expanded particle count must survive the filter steps
+    const AdaptiveSamplingParameters adaptive_sampling =
+        filter_->adaptive_sampling();
+    AdaptiveSamplingParameters fixed_sampling = adaptive_sampling;
+    fixed_sampling.enabled = false;
+    filter_->adaptive_sampling(fixed_sampling);
+
+    const int iterations = std::max(reacquisition_.iterations, 1);
+    State mean = filter_->sensor()->integrated_poses();
+    for (int i = 0; i < iterations; i++)
+    {
+        const double progress =
+            iterations > 1 ? double(i) / double(iterations - 1) : 1.;
+        filter_->likelihood_exponent(
+            std::pow(reacquisition_.initial_likelihood_exponent,
+                     1. - progress));
+        filter_->filter(frame, zero_input());
+        mean = integrate_belief_mean();
+    }
+    filter_->likelihood_exponent(1);
+    filter_->adaptive_sampling(adaptive_sampling);
+    filter_->resample(evaluation_count_ / filter_->sampling_blocks().size());
+
+    moving_average_ = to_model_coordinate_system(mean);
+    latency_metrics_->discard();
+    if (frame_change_detector_) frame_change_detector_->processed(frame);
+
+    // no velocity is known across the reacquisition
+    published_.publish_time = 0;
+    publish(moving_average_, frame->timestamp());
+
+    return moving_average_;
+}
+
+template <typename FilterState_>
+void BasicParticleTracker<FilterState_>::draw_reacquisition_particles(
+    const FilterStates& seeds)
+{
+    const ReacquisitionParameters& params = reacquisition_;
+    const int capacity = filter_->sensor()->max_sample_count();
+
+    int count = params.particle_count;
+    if (count <= 0)
+    {
+        count = capacity < std::numeric_limits<int>::max()
+                    ? capacity
+                    : 10 * evaluation_count_;
+    }
+    count = std::max(std::min(count, capacity), 1);
+
+    const auto& integrated_poses = filter_->sensor()->integrated_poses();
+    const int body_count = integrated_poses.count();
+    reacquisition_samples_.resize(size_t(count) * body_count * 6);
+    reacquisition_noise_.normal(reacquisition_count_++,
+                                0,
+                                reacquisition_samples_.size(),
+                                reacquisition_samples_.data());
+
+    reacquisition_particles_.resize(count);
+    const fl::Real* sample = reacquisition_samples_.data();
+    for (int i = 0; i < count; i++)
+    {
+        FilterState& particle = reacquisition_particles_[i];
+        particle = seeds[i % seeds.size()];
+        for (int j = 0; j < body_count; j++)
+        {
+            auto body = particle.component(j);
+            body.subtract(integrated_poses.component(j));
+            body.set_zero_velocity();
+            for (int k = 0; k < 3; k++)
+            {
+                body.position()(k) += params.position_sigma * sample[k];
+                body.orientation()(k) +=
+                    params.orientation_sigma * sample[3 + k];
+            }
+            sample += 6;
+        }
+    }
+}
+
+template <typename FilterState_>
+auto BasicParticleTracker<FilterState_>::integrate_belief_mean() -> State
+{
+    LatencyMetrics::Clock::time_point start = LatencyMetrics::Clock::now();
+    const FilterState delta_mean = filter_->center_belief();
+
+    auto& integrated_poses = filter_->sensor()->integrated_poses();
+    integrated_poses.apply_delta(delta_mean);
+    latency_metrics_->lap(LatencyMetrics::MEAN_COMPUTATION, start);
+
+    return integrated_poses;
+}
+
+template <typename FilterState_>
+Eigen::VectorXd BasicParticleTracker<FilterState_>::belief_standard_deviation()
+{
+    auto& belief = filter_->belief();
+
+    Eigen::VectorXd variance = Eigen::VectorXd::Zero(moving_average_.size());
+    for (int i = 0; i < belief.size(); i++)
+    {
+        variance += belief.prob_mass(i) * belief.location(i).cwiseAbs2();
+    }
+    return variance.cwiseSqrt();
+}
+}
@@ -0,0 +1,226 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file published_estimate.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <Eigen/Dense>
+
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+#include <dbot/pose/pose_vector.h>
+
+namespace dbot
+{
+/**
+ * \brief Result of a filter step as published by the tracker
+ */
+struct TrackerEstimate
+{
+    typedef FreeFloatingRigidBodiesState<> State;
+
+    explicit TrackerEstimate(int body_count = 1)
+        : moving_average(body_count),
+          mean(body_count),
+          standard_deviation(Eigen::VectorXd::Zero(mean.size())),
+          frame_timestamp(0),
+          publish_time(0),
+          step_duration(0),
+          step(0)
+    {
+    }
+
+    /// moving average which track() returned
+    State moving_average;
+    /// mean of the belief in the model coordinate system, with the velocities
+    State mean;
+    /// standard deviation of the belief per state dimension, relative to the
+    /// mean
+    Eigen::VectorXd standard_deviation;
+    /// timestamp of the tracked frame, 0 if unknown
+    double frame_timestamp;
+    /// seconds of clock_seconds() at which the step was published
+    double publish_time;
+    /// seconds since the previous step, from the frame timestamps where they
+    /// are known. 0 after the initialization
+    double step_duration;
+    /// number of the filter step since the construction of the tracker, 0 if
+    /// nothing was published yet
+    uint64_t step;
+
+    /**
+     * \brief Seconds of the steady clock publish_time is measured on
+     */
+    static double clock_seconds()
+    {
+        return std::chrono::duration<double>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+};
+
+/**
+ * \brief Moves the poses of the state on by the given number of filter steps
+ *        at their velocities
+ *
+ * The transition adds the velocities to the poses relative to the current
+ * poses once per filter step, which is applied here for a fraction of the
+ * step.
+ */
+inline FreeFloatingRigidBodiesState<> extrapolate(
+    const FreeFloatingRigidBodiesState<>& state,
+    double steps)
+{
+    FreeFloatingRigidBodiesState<> extrapolated = state;
+    for (int i = 0; i < state.count(); i++)
+    {
+        PoseVector delta;
+        delta.position() = steps * state.component(i).linear_velocity();
+        delta.orientation() = steps * state.component(i).angular_velocity();
+        extrapolated.component(i).pose().apply_delta(delta);
+    }
+    return extrapolated;
+}
+
+/**
+ * \brief Publishes tracker estimates from the filter thread to readers on
+ *        other threads without locks
+ *
+ * The estimate is stored as atomic values guarded by a sequence counter, a
+ * seqlock. The writer makes the counter odd while it stores the values, and
+ * readers copy the values and retry if the counter was odd or changed
+ * meanwhile. Neither ever waits for a lock, and readers do not slow down the
+ * writer however often they poll. There must be a single writer.
+ */
+class EstimatePublisher
+{
+public:
+    explicit EstimatePublisher(int body_count)
+        : body_count_(body_count),
+          state_size_(TrackerEstimate(body_count).mean.size()),
+          size_(3 * state_size_ + 3),
+          values_(new std::atomic<double>[size_]),
+          sequence_(0)
+    {
+        for (size_t i = 0; i < size_; i++)
+        {
+            values_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    int body_count() const { return body_count_; }
+
+    /**
+     * \brief Stores the estimate, whose step is taken from the number of
+     *        calls. Called by the writer only.
+     */
+    void publish(const TrackerEstimate& estimate)
+    {
+        const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        size_t k = 0;
+        for (int i = 0; i < state_size_; i++)
+        {
+            store(k++, estimate.moving_average(i));
+        }
+        for (int i = 0; i < state_size_; i++) store(k++, estimate.mean(i));
+        for (int i = 0; i < state_size_; i++)
+        {
+            store(k++, estimate.standard_deviation(i));
+        }
+        store(k++, estimate.frame_timestamp);
+        store(k++, estimate.publish_time);
+        store(k++, estimate.step_duration);
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * \brief Copies the latest estimate, which is only resized if it does not
+     *        match the body count
+     *
+     * \return false if nothing was published yet
+     */
+    bool read(TrackerEstimate& estimate) const
+    {
+        if (estimate.mean.size() != state_size_)
+        {
+            estimate = TrackerEstimate(body_count_);
+        }
+
+        while (true)
+        {
+            const uint64_t sequence = sequence_.load(std::memory_order_acquire);
+            if (sequence == 0) return false;
+            if (sequence % 2 == 1) continue;
+
+            size_t k = 0;
+            for (int i = 0; i < state_size_; i++)
+            {
+                estimate.moving_average(i) = load(k++);
+            }
+            for (int i = 0; i < state_size_; i++) estimate.mean(i) = load(k++);
+            for (int i = 0; i < state_size_; i++)
+            {
+                estimate.standard_deviation(i) = load(k++);
+            }
+            estimate.frame_timestamp = load(k++);
+            estimate.publish_time = load(k++);
+            estimate.step_duration = load(k++);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == sequence)
+            {
+                estimate.step = sequence / 2;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * \brief Number of published steps
+     */
+    uint64_t step() const
+    {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    void store(size_t k, double value)
+    {
+        values_[k].store(value, std::memory_order_relaxed);
+    }
+
+    double load(size_t k) const
+    {
+        return values_[k].load(std::memory_order_relaxed);
+    }
+
+    int body_count_;
+    int state_size_;
+    size_t size_;
+    std::unique_ptr<std::atomic<double>[]> values_;
+    std::atomic<uint64_t> sequence_;
+};
+}
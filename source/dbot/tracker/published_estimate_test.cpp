@@ -0,0 +1,108 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file published_estimate_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include <dbot/tracker/published_estimate.h>
+
+TEST(PublishedEstimateTests, reads_nothing_before_the_first_publication)
+{
+    dbot::EstimatePublisher publisher(2);
+    dbot::TrackerEstimate estimate;
+
+    EXPECT_FALSE(publisher.read(estimate));
+    EXPECT_EQ(0u, publisher.step());
+}
+
+TEST(PublishedEstimateTests, reads_the_latest_publication)
+{
+    dbot::EstimatePublisher publisher(2);
+    dbot::TrackerEstimate published(2);
+    published.mean.component(1).position() = Eigen::Vector3d(1, 2, 3);
+    published.standard_deviation(4) = 0.5;
+    published.frame_timestamp = 7;
+    publisher.publish(published);
+    published.frame_timestamp = 8;
+    publisher.publish(published);
+
+    // resized to the body count of the publisher
+    dbot::TrackerEstimate estimate;
+    ASSERT_TRUE(publisher.read(estimate));
+    EXPECT_EQ(2, estimate.mean.count());
+    EXPECT_EQ(2u, estimate.step);
+    EXPECT_EQ(8, estimate.frame_timestamp);
+    EXPECT_EQ(0.5, estimate.standard_deviation(4));
+    EXPECT_TRUE(estimate.mean.component(1).position().isApprox(
+        Eigen::Vector3d(1, 2, 3)));
+}
+
+TEST(PublishedEstimateTests, readers_never_see_a_partial_publication)
+{
+    dbot::EstimatePublisher publisher(3);
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]()
+                       {
+                           dbot::TrackerEstimate estimate(3);
+                           for (int step = 1; step <= 20000; step++)
+                           {
+                               estimate.mean.setConstant(step);
+                               estimate.moving_average.setConstant(step);
+                               estimate.frame_timestamp = step;
+                               publisher.publish(estimate);
+                           }
+                           done = true;
+                       });
+
+    dbot::TrackerEstimate estimate;
+    int reads = 0;
+    while (!done || reads == 0)
+    {
+        if (!publisher.read(estimate)) continue;
+        const double step = estimate.frame_timestamp;
+        ASSERT_EQ(uint64_t(step), estimate.step);
+        ASSERT_TRUE((estimate.mean.array() == step).all());
+        ASSERT_TRUE((estimate.moving_average.array() == step).all());
+        reads++;
+    }
+    writer.join();
+}
+
+TEST(PublishedEstimateTests, extrapolates_at_the_velocity_per_step)
+{
+    dbot::FreeFloatingRigidBodiesState<> state(1);
+    state.component(0).position() = Eigen::Vector3d(1, 0, 0);
+    state.component(0).linear_velocity() = Eigen::Vector3d(0, 0.1, 0);
+
+    auto extrapolated = dbot::extrapolate(state, 0.5);
+    EXPECT_TRUE(extrapolated.component(0).position().isApprox(
+        Eigen::Vector3d(1, 0.05, 0)));
+
+    // the velocity is relative to the current orientation
+    state.component(0).orientation() = Eigen::Vector3d(0, 0, M_PI / 2);
+    state.component(0).angular_velocity() = Eigen::Vector3d(0, 0, 0.2);
+    extrapolated = dbot::extrapolate(state, 2);
+    EXPECT_TRUE(extrapolated.component(0).position().isApprox(
+        Eigen::Vector3d(0.8, 0, 0)));
+    EXPECT_NEAR(M_PI / 2 + 0.4,
+                extrapolated.component(0).orientation().angle(),
+                1e-9);
+}
@@ -11,6 +11,9 @@
  * file distributed with this source code.
  */
 
+#include <cstdlib>
+#include <iostream>
+
 #include <fl/util/profiling.hpp>
 #include <dbot/tracker/tracker.h>
 
@@ -22,7 +25,10 @@ Tracker::Tracker(const std::shared_ptr<ObjectModel> &object_model,
     : object_model_(object_model),
       update_rate_(update_rate),
       center_object_frame_(center_object_frame),
-      moving_average_(object_model_->count_parts())
+      moving_average_(object_model_->count_parts()),
+      latency_metrics_(std::make_shared<LatencyMetrics>()),
+      estimate_publisher_(object_model_->count_parts()),
+      published_(object_model_->count_parts())
 {
 }
 
@@ -36,7 +42,75 @@ void Tracker::initialize(const std::vector<State>& initial_states)
         states.push_back(to_center_coordinate_system(state));
     }
 
-    moving_average_ = to_model_coordinate_system(on_initialize(states));
+    const State mean = to_model_coordinate_system(on_initialize(states));
+    moving_average_ = mean;
+    latency_metrics_->discard();
+
+    // no velocity is known across the initialization
+    published_.publish_time = 0;
+    publish(mean, 0);
+}
+
+void Tracker::publish(const State& mean, double frame_timestamp)
+{
+    const double now = TrackerEstimate::clock_seconds();
+    if (published_.publish_time == 0)
+    {
+        published_.step_duration = 0;
+    }
+    else if (frame_timestamp > 0 && published_.frame_timestamp > 0)
+    {
+        published_.step_duration = frame_timestamp - published_.frame_timestamp;
+    }
+    else
+    {
+        published_.step_duration = now - published_.publish_time;
+    }
+
+    published_.moving_average = moving_average_;
+    published_.mean = mean;
+    published_.standard_deviation = belief_standard_deviation();
+    published_.frame_timestamp = frame_timestamp;
+    published_.publish_time = now;
+    estimate_publisher_.publish(published_);
+}
+
+auto Tracker::extrapolate(const TrackerEstimate& estimate, double time)
+    -> State
+{
+    if (estimate.step_duration <= 0) return estimate.mean;
+
+    const double steps =
+        (time - estimate.publish_time) / estimate.step_duration;
+    return to_model_coordinate_system(dbot::extrapolate(
+        to_center_coordinate_system(estimate.mean), steps));
+}
+
+void Tracker::filter_thread_affinity(const CpuAffinity& affinity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    filter_thread_affinity_ = affinity;
+    pinned_thread_ = std::thread::id();
+}
+
+void Tracker::pin_filter_thread()
+{
+    if (filter_thread_affinity_.empty() ||
+        pinned_thread_ == std::this_thread::get_id())
+    {
+        return;
+    }
+
+    if (!WorkerPool::pin_current_thread(filter_thread_affinity_))
+    {
+        std::cout << "WARNING: Could not pin the filter thread." << std::endl;
+    }
+    pinned_thread_ = std::this_thread::get_id();
+}
+
+Eigen::VectorXd Tracker::belief_standard_deviation()
+{
+    return Eigen::VectorXd::Zero(moving_average_.size());
 }
 
 void Tracker::move_average(const Tracker::State& new_state,
@@ -71,14 +145,69 @@ void Tracker::move_average(const Tracker::State& new_state,
 auto Tracker::track(const Obsrv& image) -> State
 {
     std::lock_guard<std::mutex> lock(mutex_);
+    pin_filter_thread();
+    const LatencyMetrics::Clock::time_point start =
+        LatencyMetrics::Clock::now();
+
+    const State mean = to_model_coordinate_system(on_track(image));
+    move_average(mean, moving_average_, update_rate_);
+    publish(mean, 0);
+    latency_metrics_->span("track", start);
+    latency_metrics_->commit();
+
+    return moving_average_;
+}
+
+auto Tracker::track(const DepthFrame::ConstPtr& frame) -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pin_filter_thread();
+    const LatencyMetrics::Clock::time_point start =
+        LatencyMetrics::Clock::now();
+
+    const State mean = to_model_coordinate_system(on_track_frame(frame));
+    move_average(mean, moving_average_, update_rate_);
+    publish(mean, frame->timestamp());
+    latency_metrics_->span("track", start);
+    latency_metrics_->commit();
+
+    return moving_average_;
+}
+
+auto Tracker::track(const std::vector<DepthFrame::ConstPtr>& frames) -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pin_filter_thread();
+    const LatencyMetrics::Clock::time_point start =
+        LatencyMetrics::Clock::now();
 
-    move_average(to_model_coordinate_system(on_track(image)),
-                 moving_average_,
-                 update_rate_);
+    const State mean = to_model_coordinate_system(on_track_frames(frames));
+    move_average(mean, moving_average_, update_rate_);
+    publish(mean, frames.empty() ? 0 : frames[0]->timestamp());
+    latency_metrics_->span("track", start);
+    latency_metrics_->commit();
 
     return moving_average_;
 }
 
+auto Tracker::on_track_frame(const DepthFrame::ConstPtr& frame) -> State
+{
+    Obsrv image = frame->vector().cast<fl::Real>();
+    return on_track(image);
+}
+
+auto Tracker::on_track_frames(const std::vector<DepthFrame::ConstPtr>& frames)
+    -> State
+{
+    if (frames.size() != 1)
+    {
+        std::cout << "ERROR: " << frames.size() << " depth frames for a "
+                  << "tracker with a single camera view" << std::endl;
+        exit(-1);
+    }
+    return on_track_frame(frames[0]);
+}
+
 auto Tracker::to_center_coordinate_system(
     const Tracker::State& state) -> State
 {
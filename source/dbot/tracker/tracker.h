@@ -20,12 +20,17 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <dbot/depth_frame.h>
+#include <dbot/latency_metrics.h>
 #include <dbot/object_model.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
 #include <dbot/pose/pose_vector.h>
+#include <dbot/tracker/published_estimate.h>
+#include <dbot/worker_pool.h>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace dbot
@@ -63,6 +68,22 @@ public:
      */
     virtual State on_track(const Obsrv& image) = 0;
 
+    /**
+     * \brief Hook function which is called when tracking on a depth frame.
+     *        By default the frame is converted to an Obsrv for on_track().
+     * \return Current belief state
+     */
+    virtual State on_track_frame(const DepthFrame::ConstPtr& frame);
+
+    /**
+     * \brief Hook function which is called when tracking on one depth frame
+     *        per camera view. By default a single frame is passed on to
+     *        on_track_frame().
+     * \return Current belief state
+     */
+    virtual State on_track_frames(
+        const std::vector<DepthFrame::ConstPtr>& frames);
+
     /**
      * \brief Hook function which is called during initialization
      * \return Initial belief state
@@ -77,6 +98,24 @@ public:
      */
     virtual State track(const Obsrv& image);
 
+    /**
+     * \brief perform a single filter step on a depth frame, which is passed
+     *     on to the sensor without being copied if the tracker supports it
+     *
+     * \param frame
+     *     Current depth frame, e.g. from CameraData::depth_frame()
+     */
+    virtual State track(const DepthFrame::ConstPtr& frame);
+
+    /**
+     * \brief perform a single filter step on the synchronized depth frames of
+     *     all camera views of the sensor
+     *
+     * \param frames
+     *     One depth frame per view, in the order of the views of the sensor
+     */
+    virtual State track(const std::vector<DepthFrame::ConstPtr>& frames);
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *     the number of evaluations
@@ -85,6 +124,13 @@ public:
      */
     virtual void initialize(const std::vector<State>& initial_states);
 
+    /**
+     * \brief Forgets what was observed so far, e.g. the occlusions the
+     *     sensor keeps, before the tracker is initialized on an independent
+     *     sequence
+     */
+    virtual void reset_observations() {}
+
     /**
      * \brief Transforms the given state or pose in the model coordinate system
      *        to the center coordinate system
@@ -123,11 +169,81 @@ public:
      */
     Input zero_input() const;
 
+    /**
+     * \brief Rolling latencies of the stages of the filter steps, one step
+     *        is committed by every track() call
+     */
+    const std::shared_ptr<LatencyMetrics>& latency_metrics() const
+    {
+        return latency_metrics_;
+    }
+
+    /**
+     * \brief Copies the estimate of the latest filter step without waiting
+     *        for the current one, such that it can be polled at any rate
+     *        from other threads, see EstimatePublisher
+     *
+     * \return false if the tracker was not initialized yet
+     */
+    bool latest_estimate(TrackerEstimate& estimate) const
+    {
+        return estimate_publisher_.read(estimate);
+    }
+
+    /**
+     * \brief Mean of the estimate moved on to the given time at the
+     *        velocities of the belief
+     *
+     * \param time
+     *     Seconds of TrackerEstimate::clock_seconds()
+     */
+    State extrapolate(const TrackerEstimate& estimate, double time);
+
+    /**
+     * \brief Pins the threads which run the filter steps to the given cores,
+     *        e.g. the thread of an AsyncTracker. A thread is pinned by its
+     *        first track() call.
+     */
+    void filter_thread_affinity(const CpuAffinity& affinity);
+
+    /**
+     * \brief Pool the sensor and the filter of the tracker run on, kept
+     *        alive by the tracker. May be shared with other trackers.
+     */
+    const std::shared_ptr<WorkerPool>& worker_pool() const
+    {
+        return worker_pool_;
+    }
+    void worker_pool(const std::shared_ptr<WorkerPool>& pool)
+    {
+        worker_pool_ = pool;
+    }
+
 protected:
+    /**
+     * \brief Standard deviation of the belief per state dimension, reported
+     *        in the published estimates. Zero unless a tracker provides it.
+     */
+    virtual Eigen::VectorXd belief_standard_deviation();
+
+    /**
+     * \brief Publishes the moving average and the given belief mean in the
+     *        model coordinate system
+     */
+    void publish(const State& mean, double frame_timestamp);
+
+    void pin_filter_thread();
+
     std::shared_ptr<ObjectModel> object_model_;
     State moving_average_;
     double update_rate_;
     bool center_object_frame_;
     std::mutex mutex_;
+    std::shared_ptr<LatencyMetrics> latency_metrics_;
+    EstimatePublisher estimate_publisher_;
+    TrackerEstimate published_;
+    std::shared_ptr<WorkerPool> worker_pool_;
+    CpuAffinity filter_thread_affinity_;
+    std::thread::id pinned_thread_;
 };
 }
@@ -0,0 +1,73 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_manager.cpp
+ * \date October 2026
+ */
+
+#include <dbot/tracker/tracker_manager.h>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace dbot
+{
+TrackerManager::TrackerManager(
+    const std::vector<std::shared_ptr<Tracker>>& trackers,
+    const std::shared_ptr<SensorBatch>& sensor_batch)
+    : sensor_batch_(sensor_batch), trackers_(trackers), states_(trackers.size())
+{
+    for (size_t i = 0; i < trackers_.size(); i++)
+    {
+        jobs_.push_back(
+            [this, i]() { states_[i] = trackers_[i]->track(frame_); });
+    }
+}
+
+void TrackerManager::initialize(
+    const std::vector<std::vector<State>>& initial_states)
+{
+    if (initial_states.size() != trackers_.size())
+    {
+        std::cout << "ERROR: " << initial_states.size()
+                  << " initial states for " << trackers_.size()
+                  << " trackers" << std::endl;
+        exit(-1);
+    }
+
+    for (size_t i = 0; i < trackers_.size(); i++)
+    {
+        trackers_[i]->initialize(initial_states[i]);
+    }
+}
+
+auto TrackerManager::track(const DepthFrame::ConstPtr& frame)
+    -> std::vector<State>
+{
+    frame_ = frame;
+
+    if (sensor_batch_)
+    {
+        sensor_batch_->set_depth_frame(frame);
+        sensor_batch_->run(jobs_);
+    }
+    else
+    {
+        for (auto& job : jobs_) job();
+    }
+
+    frame_.reset();
+    return states_;
+}
+}
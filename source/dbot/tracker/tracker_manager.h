@@ -0,0 +1,82 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_manager.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <dbot/depth_frame.h>
+#include <dbot/model/sensor_batch.h>
+#include <dbot/tracker/tracker.h>
+
+namespace dbot
+{
+/**
+ * \brief Tracks several objects in one camera stream
+ *
+ * If the trackers share a SensorBatch, e.g. one built by
+ * TrackerManagerBuilder, their filter steps run concurrently and the particles
+ * of all trackers are evaluated together. Otherwise the trackers run one
+ * after the other.
+ */
+class TrackerManager
+{
+public:
+    typedef Tracker::State State;
+
+public:
+    /**
+     * \param trackers      one tracker per object
+     * \param sensor_batch  sensor the trackers evaluate through, may be empty
+     */
+    TrackerManager(const std::vector<std::shared_ptr<Tracker>>& trackers,
+                   const std::shared_ptr<SensorBatch>& sensor_batch =
+                       std::shared_ptr<SensorBatch>());
+
+    /**
+     * \brief Initializes every tracker with its initial states
+     *
+     * \param initial_states [tracker_nr] = {initial states of the tracker}
+     */
+    void initialize(const std::vector<std::vector<State>>& initial_states);
+
+    /**
+     * \brief Performs a filter step of all trackers on the frame, which is
+     *        uploaded once if the trackers share a sensor batch
+     *
+     * \return [tracker_nr] = {current belief state of the tracker}
+     */
+    std::vector<State> track(const DepthFrame::ConstPtr& frame);
+
+    int count() const { return trackers_.size(); }
+    const std::shared_ptr<Tracker>& tracker(int index) const
+    {
+        return trackers_[index];
+    }
+
+private:
+    // outlives the trackers, whose sensors belong to it
+    std::shared_ptr<SensorBatch> sensor_batch_;
+    std::vector<std::shared_ptr<Tracker>> trackers_;
+    std::vector<std::function<void()>> jobs_;
+    std::vector<State> states_;
+    DepthFrame::ConstPtr frame_;
+};
+}
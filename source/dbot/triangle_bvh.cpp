@@ -0,0 +1,424 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file triangle_bvh.cpp
+ * \date October 2026
+ */
+
+#include <dbot/triangle_bvh.h>
+
+#include <algorithm>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace dbot
+{
+constexpr float TriangleBvh::NEAR_DISTANCE;
+
+namespace
+{
+const int BIN_COUNT = 16;
+const int MAX_LEAF_SIZE = 16;
+// deeper subtrees become leaves, which bounds the traversal stack
+const int MAX_DEPTH = 64;
+
+float surface_area(const Eigen::AlignedBox3f& box)
+{
+    if (box.isEmpty()) return 0;
+    const Eigen::Vector3f size = box.sizes();
+    return 2 * (size(0) * size(1) + size(1) * size(2) + size(2) * size(0));
+}
+
+// the lanes of a ray packet, a mask has all bits of the selected lanes set
+#ifdef __SSE2__
+typedef __m128 Lanes;
+typedef __m128 Mask;
+
+inline Lanes broadcast(float value) { return _mm_set1_ps(value); }
+inline Lanes load(const float* values) { return _mm_loadu_ps(values); }
+inline void store(float* values, Lanes lanes) { _mm_storeu_ps(values, lanes); }
+inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+inline Lanes div(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+inline Lanes lane_min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+inline Lanes lane_max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+inline Mask less(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+inline Mask less_equal(Lanes a, Lanes b) { return _mm_cmple_ps(a, b); }
+inline Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+inline bool any(Mask mask) { return _mm_movemask_ps(mask) != 0; }
+inline Lanes select(Mask mask, Lanes a, Lanes b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#else
+struct Lanes
+{
+    float v[TriangleBvh::PACKET_SIZE];
+};
+struct Mask
+{
+    bool v[TriangleBvh::PACKET_SIZE];
+};
+
+#define DBOT_LANEWISE(Result, expression)                   \
+    Result result;                                          \
+    for (int i = 0; i < TriangleBvh::PACKET_SIZE; i++)      \
+    {                                                       \
+        result.v[i] = expression;                           \
+    }                                                       \
+    return result;
+
+inline Lanes broadcast(float value) { DBOT_LANEWISE(Lanes, value) }
+inline Lanes load(const float* values) { DBOT_LANEWISE(Lanes, values[i]) }
+inline void store(float* values, Lanes lanes)
+{
+    std::copy(lanes.v, lanes.v + TriangleBvh::PACKET_SIZE, values);
+}
+inline Lanes add(Lanes a, Lanes b) { DBOT_LANEWISE(Lanes, a.v[i] + b.v[i]) }
+inline Lanes sub(Lanes a, Lanes b) { DBOT_LANEWISE(Lanes, a.v[i] - b.v[i]) }
+inline Lanes mul(Lanes a, Lanes b) { DBOT_LANEWISE(Lanes, a.v[i] * b.v[i]) }
+inline Lanes div(Lanes a, Lanes b) { DBOT_LANEWISE(Lanes, a.v[i] / b.v[i]) }
+inline Lanes lane_min(Lanes a, Lanes b)
+{
+    DBOT_LANEWISE(Lanes, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+}
+inline Lanes lane_max(Lanes a, Lanes b)
+{
+    DBOT_LANEWISE(Lanes, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+}
+inline Mask less(Lanes a, Lanes b) { DBOT_LANEWISE(Mask, a.v[i] < b.v[i]) }
+inline Mask less_equal(Lanes a, Lanes b)
+{
+    DBOT_LANEWISE(Mask, a.v[i] <= b.v[i])
+}
+inline Mask both(Mask a, Mask b) { DBOT_LANEWISE(Mask, a.v[i] && b.v[i]) }
+inline bool any(Mask mask)
+{
+    return std::find(mask.v, mask.v + TriangleBvh::PACKET_SIZE, true) !=
+           mask.v + TriangleBvh::PACKET_SIZE;
+}
+inline Lanes select(Mask mask, Lanes a, Lanes b)
+{
+    DBOT_LANEWISE(Lanes, mask.v[i] ? a.v[i] : b.v[i])
+}
+
+#undef DBOT_LANEWISE
+#endif
+
+inline float smallest(Lanes lanes)
+{
+    float values[TriangleBvh::PACKET_SIZE];
+    store(values, lanes);
+    return *std::min_element(values, values + TriangleBvh::PACKET_SIZE);
+}
+
+inline Lanes dot(const Lanes (&a)[3], const float* b)
+{
+    return add(add(mul(a[0], broadcast(b[0])), mul(a[1], broadcast(b[1]))),
+               mul(a[2], broadcast(b[2])));
+}
+}
+
+TriangleBvh::TriangleBvh(const TriangleMesh& mesh)
+{
+    roots_.resize(mesh.count_parts());
+    part_bounds_.resize(mesh.count_parts());
+    triangles_.reserve(mesh.count_triangles());
+
+    for (int part = 0; part < mesh.count_parts(); part++)
+    {
+        const TriangleMesh::VertexMatrix vertices = mesh.vertices(part);
+        const TriangleMesh::TriangleMatrix triangles = mesh.triangles(part);
+        const int triangle_count = triangles.cols();
+
+        std::vector<Eigen::AlignedBox3f> boxes(triangle_count);
+        std::vector<Eigen::Vector3f> centroids(triangle_count);
+        std::vector<int> order(triangle_count);
+        for (int i = 0; i < triangle_count; i++)
+        {
+            for (int corner = 0; corner < 3; corner++)
+            {
+                boxes[i].extend(vertices.col(triangles(corner, i)));
+            }
+            centroids[i] = boxes[i].center();
+            part_bounds_[part].extend(boxes[i]);
+            order[i] = i;
+        }
+
+        const int first_node = nodes_.size();
+        roots_[part] = first_node;
+        nodes_.push_back(Node());
+        build(first_node, 0, triangle_count, 0, order, boxes, centroids);
+
+        // the leaves count from the first triangle of the part
+        const int first_triangle = triangles_.size();
+        for (size_t i = first_node; i < nodes_.size(); i++)
+        {
+            if (nodes_[i].count > 0) nodes_[i].first += first_triangle;
+        }
+
+        for (const int i : order)
+        {
+            Triangle triangle;
+            const Eigen::Vector3f v0 = vertices.col(triangles(0, i));
+            const Eigen::Vector3f e1 = vertices.col(triangles(1, i)) - v0;
+            const Eigen::Vector3f e2 = vertices.col(triangles(2, i)) - v0;
+            const Eigen::Vector3f normal = e1.cross(e2);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                triangle.v0[axis] = v0(axis);
+                triangle.e1[axis] = e1(axis);
+                triangle.e2[axis] = e2(axis);
+                triangle.normal[axis] = normal(axis);
+            }
+            triangles_.push_back(triangle);
+        }
+    }
+}
+
+void TriangleBvh::build(int node_index,
+                        int begin,
+                        int end,
+                        int depth,
+                        std::vector<int>& order,
+                        const std::vector<Eigen::AlignedBox3f>& boxes,
+                        const std::vector<Eigen::Vector3f>& centroids)
+{
+    Eigen::AlignedBox3f box;
+    Eigen::AlignedBox3f centroid_box;
+    for (int i = begin; i < end; i++)
+    {
+        box.extend(boxes[order[i]]);
+        centroid_box.extend(centroids[order[i]]);
+    }
+
+    // only the root of a part without triangles is empty, it is not traced
+    for (int axis = 0; axis < 3; axis++)
+    {
+        nodes_[node_index].lower[axis] = box.isEmpty() ? 0 : box.min()(axis);
+        nodes_[node_index].upper[axis] = box.isEmpty() ? 0 : box.max()(axis);
+    }
+    nodes_[node_index].first = begin;
+    nodes_[node_index].count = end - begin;
+
+    const int count = end - begin;
+    if (count <= 4 || depth >= MAX_DEPTH) return;
+
+    // bin the centroids along the longest axis and split where the surface
+    // area heuristic is lowest
+    int axis;
+    centroid_box.sizes().maxCoeff(&axis);
+    const float lower = centroid_box.min()(axis);
+    const float extent = centroid_box.sizes()(axis);
+
+    int mid = begin + count / 2;
+    if (extent > 0)
+    {
+        auto bin_of = [&](int triangle)
+        {
+            const int bin =
+                int(BIN_COUNT * (centroids[triangle](axis) - lower) / extent);
+            return std::min(bin, BIN_COUNT - 1);
+        };
+
+        Eigen::AlignedBox3f bin_boxes[BIN_COUNT];
+        int bin_counts[BIN_COUNT] = {0};
+        for (int i = begin; i < end; i++)
+        {
+            const int bin = bin_of(order[i]);
+            bin_boxes[bin].extend(boxes[order[i]]);
+            bin_counts[bin]++;
+        }
+
+        // right_areas[split] and right_counts[split] cover the bins from
+        // split on
+        float right_areas[BIN_COUNT];
+        int right_counts[BIN_COUNT];
+        Eigen::AlignedBox3f right_box;
+        int right_count = 0;
+        for (int bin = BIN_COUNT - 1; bin > 0; bin--)
+        {
+            right_box.extend(bin_boxes[bin]);
+            right_count += bin_counts[bin];
+            right_areas[bin] = surface_area(right_box);
+            right_counts[bin] = right_count;
+        }
+
+        float best_cost = std::numeric_limits<float>::max();
+        int best_split = 0;
+        Eigen::AlignedBox3f left_box;
+        int left_count = 0;
+        for (int split = 1; split < BIN_COUNT; split++)
+        {
+            left_box.extend(bin_boxes[split - 1]);
+            left_count += bin_counts[split - 1];
+            if (left_count == 0 || right_counts[split] == 0) continue;
+
+            const float cost = left_count * surface_area(left_box) +
+                               right_counts[split] * right_areas[split];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_split = split;
+            }
+        }
+
+        // a split has to pay for the traversal of another level
+        const float leaf_cost = count * surface_area(box);
+        if (count <= MAX_LEAF_SIZE && best_cost >= leaf_cost) return;
+
+        if (best_split > 0)
+        {
+            mid = std::partition(order.begin() + begin,
+                                 order.begin() + end,
+                                 [&](int triangle)
+                                 {
+                                     return bin_of(triangle) < best_split;
+                                 }) -
+                  order.begin();
+        }
+    }
+
+    // the children are stored next to each other
+    const int left = nodes_.size();
+    nodes_.resize(nodes_.size() + 2);
+    nodes_[node_index].first = left;
+    nodes_[node_index].count = 0;
+
+    build(left, begin, mid, depth + 1, order, boxes, centroids);
+    build(left + 1, mid, end, depth + 1, order, boxes, centroids);
+}
+
+void TriangleBvh::intersect(int part,
+                            const Eigen::Vector3f& origin,
+                            const float (&directions)[3][PACKET_SIZE],
+                            bool cull_back_faces,
+                            float (&depths)[PACKET_SIZE]) const
+{
+    if (part_bounds_[part].isEmpty()) return;
+
+    const float o[3] = {origin(0), origin(1), origin(2)};
+
+    Lanes d[3];
+    Lanes inverse[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        d[axis] = load(directions[axis]);
+        inverse[axis] = div(broadcast(1), d[axis]);
+    }
+    const Lanes near = broadcast(NEAR_DISTANCE);
+    const Lanes zero = broadcast(0);
+    const Lanes one = broadcast(1);
+    Lanes closest = load(depths);
+
+    // distances at which the rays enter the box of the node, the mask marks
+    // the rays which hit it before their closest hit
+    auto enter = [&](const Node& node, Lanes& entry)
+    {
+        Lanes t_near = near;
+        Lanes t_far = closest;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const Lanes t0 =
+                mul(broadcast(node.lower[axis] - o[axis]), inverse[axis]);
+            const Lanes t1 =
+                mul(broadcast(node.upper[axis] - o[axis]), inverse[axis]);
+            t_near = lane_max(t_near, lane_min(t0, t1));
+            t_far = lane_min(t_far, lane_max(t0, t1));
+        }
+        entry = select(less_equal(t_near, t_far),
+                       t_near,
+                       broadcast(std::numeric_limits<float>::infinity()));
+        return less_equal(t_near, t_far);
+    };
+
+    // the triangle terms which only depend on the common origin are
+    // computed once for the packet, see Moeller and Trumbore
+    auto intersect_leaf = [&](const Node& node)
+    {
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const Triangle& triangle = triangles_[i];
+            const float s[3] = {o[0] - triangle.v0[0],
+                                o[1] - triangle.v0[1],
+                                o[2] - triangle.v0[2]};
+            const float* e1 = triangle.e1;
+            const float* e2 = triangle.e2;
+            const float q[3] = {s[1] * e1[2] - s[2] * e1[1],
+                                s[2] * e1[0] - s[0] * e1[2],
+                                s[0] * e1[1] - s[1] * e1[0]};
+            const float a[3] = {e2[1] * s[2] - e2[2] * s[1],
+                                e2[2] * s[0] - e2[0] * s[2],
+                                e2[0] * s[1] - e2[1] * s[0]};
+            const float t_numerator =
+                e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2];
+
+            // the determinant is positive for triangles wound counter
+            // clockwise seen from the origin
+            const Lanes determinant = sub(zero, dot(d, triangle.normal));
+            const Lanes inverse_determinant = div(one, determinant);
+            const Lanes u = mul(dot(d, a), inverse_determinant);
+            const Lanes v = mul(dot(d, q), inverse_determinant);
+            const Lanes t = mul(broadcast(t_numerator), inverse_determinant);
+
+            Mask hit = both(both(less_equal(zero, u), less_equal(zero, v)),
+                            less_equal(add(u, v), one));
+            hit = both(hit, both(less(near, t), less(t, closest)));
+            if (cull_back_faces) hit = both(hit, less(zero, determinant));
+            closest = select(hit, t, closest);
+        }
+    };
+
+    int stack[MAX_DEPTH + 1];
+    int stack_size = 0;
+
+    Lanes entry;
+    if (!any(enter(nodes_[roots_[part]], entry))) return;
+    stack[stack_size++] = roots_[part];
+
+    while (stack_size > 0)
+    {
+        const Node& node = nodes_[stack[--stack_size]];
+        if (node.count > 0)
+        {
+            intersect_leaf(node);
+            continue;
+        }
+
+        // the children are tested against the closest hits found so far,
+        // the one entered first is visited first
+        Lanes left_entry;
+        Lanes right_entry;
+        const bool left = any(enter(nodes_[node.first], left_entry));
+        const bool right = any(enter(nodes_[node.first + 1], right_entry));
+        if (left && right)
+        {
+            const bool left_first =
+                smallest(left_entry) <= smallest(right_entry);
+            stack[stack_size++] = node.first + (left_first ? 1 : 0);
+            stack[stack_size++] = node.first + (left_first ? 0 : 1);
+        }
+        else if (left || right)
+        {
+            stack[stack_size++] = node.first + (left ? 0 : 1);
+        }
+    }
+
+    store(depths, closest);
+}
+}
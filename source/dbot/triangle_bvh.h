@@ -0,0 +1,125 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file triangle_bvh.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/triangle_mesh.h>
+
+namespace dbot
+{
+/**
+ * \brief Bounding volume hierarchy over the triangles of each part of a
+ *        mesh, in the frame of the part
+ *
+ * The hierarchy is built once per mesh and stays valid for every pose, the
+ * rays are transformed into the part frame instead. Rays are traced in
+ * packets of PACKET_SIZE which start at a common origin, the camera centre,
+ * such that the per triangle terms of the intersection are shared by the
+ * packet and only three dot products remain per ray.
+ */
+class TriangleBvh
+{
+public:
+    typedef std::shared_ptr<const TriangleBvh> ConstPtr;
+
+    enum
+    {
+        PACKET_SIZE = 4
+    };
+
+    /// hits closer than this are ignored, as are triangles with a vertex
+    /// this close by the rasterizer
+    static constexpr float NEAR_DISTANCE = 0.001f;
+
+public:
+    explicit TriangleBvh(const TriangleMesh& mesh);
+
+    int count_parts() const { return int(roots_.size()); }
+
+    /**
+     * \brief Bounding box of the part in its frame, empty for parts without
+     *        triangles
+     */
+    const Eigen::AlignedBox3f& bounds(int part) const
+    {
+        return part_bounds_[part];
+    }
+
+    /**
+     * \brief Intersects a packet of rays from the origin with the part
+     *
+     * The ray i runs along directions[.][i], and depths[i] holds the
+     * closest distance accepted so far in units of the direction. It is
+     * lowered to the closest hit of the part before it. Lanes whose depth
+     * is not above NEAR_DISTANCE are ignored.
+     *
+     * \param cull_back_faces   skip triangles wound clockwise seen from the
+     *                          origin, see RigidBodyRenderer
+     */
+    void intersect(int part,
+                   const Eigen::Vector3f& origin,
+                   const float (&directions)[3][PACKET_SIZE],
+                   bool cull_back_faces,
+                   float (&depths)[PACKET_SIZE]) const;
+
+private:
+    struct Node
+    {
+        float lower[3];
+        float upper[3];
+        /// first triangle of a leaf, or the first of the two children
+        int first;
+        /// triangles of a leaf, 0 for inner nodes
+        int count;
+    };
+
+    /**
+     * \brief Triangle v0, v0 + e1, v0 + e2 with the normal e1 x e2
+     */
+    struct Triangle
+    {
+        float v0[3];
+        float e1[3];
+        float e2[3];
+        float normal[3];
+    };
+
+    /**
+     * \brief Splits the triangles [begin, end) of the build order by the
+     *        surface area heuristic until leaves are small
+     */
+    void build(int node_index,
+               int begin,
+               int end,
+               int depth,
+               std::vector<int>& order,
+               const std::vector<Eigen::AlignedBox3f>& boxes,
+               const std::vector<Eigen::Vector3f>& centroids);
+
+    std::vector<Node> nodes_;
+    std::vector<Triangle> triangles_;
+    /// root node of each part
+    std::vector<int> roots_;
+    std::vector<Eigen::AlignedBox3f> part_bounds_;
+};
+}
@@ -0,0 +1,193 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file triangle_bvh_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include <dbot/rigid_body_renderer.h>
+#include <dbot/triangle_bvh.h>
+
+namespace
+{
+typedef dbot::RigidBodyRenderer Renderer;
+
+/**
+ * \brief Sphere of latitude and longitude rings with the given radius
+ */
+void add_sphere(int rings,
+                int segments,
+                double radius,
+                dbot::TriangleMesh& mesh)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> triangles;
+
+    vertices.push_back(Eigen::Vector3d(0, 0, radius));
+    for (int ring = 1; ring < rings; ring++)
+    {
+        const double theta = M_PI * ring / rings;
+        for (int segment = 0; segment < segments; segment++)
+        {
+            const double phi = 2 * M_PI * segment / segments;
+            vertices.push_back(radius *
+                               Eigen::Vector3d(std::sin(theta) * std::cos(phi),
+                                               std::sin(theta) * std::sin(phi),
+                                               std::cos(theta)));
+        }
+    }
+    vertices.push_back(Eigen::Vector3d(0, 0, -radius));
+
+    auto index = [segments](int ring, int segment)
+    {
+        return 1 + (ring - 1) * segments + segment % segments;
+    };
+    const int south = vertices.size() - 1;
+    for (int segment = 0; segment < segments; segment++)
+    {
+        triangles.push_back({0, index(1, segment), index(1, segment + 1)});
+        for (int ring = 1; ring < rings - 1; ring++)
+        {
+            triangles.push_back({index(ring, segment),
+                                 index(ring + 1, segment),
+                                 index(ring + 1, segment + 1)});
+            triangles.push_back({index(ring, segment),
+                                 index(ring + 1, segment + 1),
+                                 index(ring, segment + 1)});
+        }
+        triangles.push_back(
+            {south, index(rings - 1, segment + 1), index(rings - 1, segment)});
+    }
+
+    mesh.add_part(vertices, triangles);
+}
+
+Eigen::Matrix3d camera_matrix()
+{
+    Eigen::Matrix3d matrix;
+    matrix << 150, 0, 80, 0, 150, 60, 0, 0, 1;
+    return matrix;
+}
+
+/// two overlapping spheres of 2000 triangles in front of the camera
+std::vector<float> render(Renderer::RasterizationMode mode)
+{
+    auto mesh = std::make_shared<dbot::TriangleMesh>();
+    add_sphere(20, 50, 0.1, *mesh);
+    add_sphere(20, 50, 0.05, *mesh);
+
+    Renderer renderer(mesh, mode);
+    std::vector<Renderer::Affine> poses(2, Renderer::Affine::Identity());
+    poses[0].translation() = Eigen::Vector3d(0.02, -0.01, 0.8);
+    poses[1].translation() = Eigen::Vector3d(-0.08, 0.03, 0.72);
+    poses[1].rotate(
+        Eigen::AngleAxisd(0.7, Eigen::Vector3d(1, 2, 3).normalized()));
+    renderer.set_poses(poses);
+
+    std::vector<float> depth_image;
+    renderer.Render(camera_matrix(), 120, 160, depth_image);
+    return depth_image;
+}
+}
+
+TEST(TriangleBvhTests, ray_casting_renders_the_depths_of_the_rasterizer)
+{
+    const std::vector<float> rasterized =
+        render(Renderer::TILED_RASTERIZATION);
+    const std::vector<float> ray_cast = render(Renderer::RAY_CASTING);
+    ASSERT_EQ(rasterized.size(), ray_cast.size());
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    int covered = 0;
+    int differing = 0;
+    for (size_t i = 0; i < rasterized.size(); i++)
+    {
+        if (rasterized[i] == infinity && ray_cast[i] == infinity) continue;
+        covered++;
+        // pixels on triangle edges may fall to either side
+        if (std::fabs(rasterized[i] - ray_cast[i]) > 1e-4) differing++;
+    }
+
+    EXPECT_GT(covered, 1000);
+    EXPECT_LT(differing, covered / 100);
+}
+
+TEST(TriangleBvhTests, keeps_closer_depths_and_culls_back_faces)
+{
+    // a triangle at a depth of 1 wound counter clockwise seen from the origin
+    dbot::TriangleMesh mesh;
+    mesh.add_part({Eigen::Vector3d(-1, -1, 1),
+                   Eigen::Vector3d(-1, 1, 1),
+                   Eigen::Vector3d(1, -1, 1)},
+                  {{0, 1, 2}});
+    mesh.add_part({Eigen::Vector3d(-1, -1, 1),
+                   Eigen::Vector3d(1, -1, 1),
+                   Eigen::Vector3d(-1, 1, 1)},
+                  {{0, 1, 2}});
+    const dbot::TriangleBvh bvh(mesh);
+
+    // towards the triangle, beside it, and two ignored lanes
+    const float directions[3][dbot::TriangleBvh::PACKET_SIZE] = {
+        {-0.5f, 0.9f, -0.5f, -0.5f},
+        {-0.5f, 0.9f, -0.5f, -0.5f},
+        {1, 1, 1, 1}};
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    for (int part = 0; part < 2; part++)
+    {
+        float depths[dbot::TriangleBvh::PACKET_SIZE] = {
+            infinity, infinity, 0, 0.5f};
+        bvh.intersect(
+            part, Eigen::Vector3f::Zero(), directions, false, depths);
+        EXPECT_FLOAT_EQ(1, depths[0]);
+        EXPECT_EQ(infinity, depths[1]);
+        EXPECT_EQ(0, depths[2]);
+        EXPECT_EQ(0.5f, depths[3]);
+    }
+
+    float front[dbot::TriangleBvh::PACKET_SIZE] = {infinity};
+    bvh.intersect(0, Eigen::Vector3f::Zero(), directions, true, front);
+    EXPECT_FLOAT_EQ(1, front[0]);
+
+    float back[dbot::TriangleBvh::PACKET_SIZE] = {infinity};
+    bvh.intersect(1, Eigen::Vector3f::Zero(), directions, true, back);
+    EXPECT_EQ(infinity, back[0]);
+}
+
+TEST(TriangleBvhTests, automatic_rendering_ray_casts_dense_parts)
+{
+    auto mesh = std::make_shared<dbot::TriangleMesh>();
+    add_sphere(40, 80, 0.1, *mesh);
+
+    Renderer renderer(mesh, Renderer::AUTOMATIC_RENDERING);
+    std::vector<Renderer::Affine> poses(1, Renderer::Affine::Identity());
+    std::vector<float> depth_image;
+
+    // about 30 x 30 pixels for 6240 triangles
+    poses[0].translation() = Eigen::Vector3d(0, 0, 1);
+    renderer.set_poses(poses);
+    renderer.Render(camera_matrix(), 120, 160, depth_image);
+    EXPECT_TRUE(renderer.ray_cast(0));
+
+    renderer.ray_casting_threshold(8);
+    renderer.Render(camera_matrix(), 120, 160, depth_image);
+    EXPECT_FALSE(renderer.ray_cast(0));
+    EXPECT_NE(std::numeric_limits<float>::infinity(),
+              depth_image[60 * 160 + 80]);
+}
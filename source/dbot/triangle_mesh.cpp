@@ -0,0 +1,141 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file triangle_mesh.cpp
+ * \date October 2026
+ */
+
+#include <dbot/triangle_mesh.h>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace dbot
+{
+TriangleMesh::TriangleMesh() : vertex_offsets_(1, 0), triangle_offsets_(1, 0)
+{
+}
+
+TriangleMesh::TriangleMesh(const Vertices& vertices,
+                           const TriangleIndices& indices)
+    : vertex_offsets_(1, 0), triangle_offsets_(1, 0)
+{
+    if (vertices.size() != indices.size())
+    {
+        std::cout << "ERROR: mesh with " << vertices.size()
+                  << " vertex parts and " << indices.size()
+                  << " triangle parts" << std::endl;
+        exit(-1);
+    }
+
+    size_t vertex_count = 0;
+    size_t triangle_count = 0;
+    for (size_t part = 0; part < vertices.size(); part++)
+    {
+        vertex_count += vertices[part].size();
+        triangle_count += indices[part].size();
+    }
+    vertices_.reserve(3 * vertex_count);
+    indices_.reserve(3 * triangle_count);
+    vertex_offsets_.reserve(vertices.size() + 1);
+    triangle_offsets_.reserve(vertices.size() + 1);
+
+    for (size_t part = 0; part < vertices.size(); part++)
+    {
+        add_part(vertices[part], indices[part]);
+    }
+}
+
+void TriangleMesh::add_part(const std::vector<Eigen::Vector3d>& vertices,
+                            const std::vector<std::vector<int>>& indices)
+{
+    for (auto& vertex : vertices)
+    {
+        vertices_.push_back(float(vertex(0)));
+        vertices_.push_back(float(vertex(1)));
+        vertices_.push_back(float(vertex(2)));
+    }
+
+    for (auto& triangle : indices)
+    {
+        if (triangle.size() != 3)
+        {
+            std::cout << "ERROR: mesh face with " << triangle.size()
+                      << " vertices, only triangles are supported"
+                      << std::endl;
+            exit(-1);
+        }
+        for (int index : triangle)
+        {
+            if (index < 0 || index >= int(vertices.size()))
+            {
+                std::cout << "ERROR: mesh vertex index " << index
+                          << " out of range" << std::endl;
+                exit(-1);
+            }
+            indices_.push_back(uint32_t(index));
+        }
+    }
+
+    vertex_offsets_.push_back(vertex_offsets_.back() + vertices.size());
+    triangle_offsets_.push_back(triangle_offsets_.back() + indices.size());
+}
+
+void TriangleMesh::append(const TriangleMesh& mesh)
+{
+    vertices_.insert(
+        vertices_.end(), mesh.vertices_.begin(), mesh.vertices_.end());
+    indices_.insert(indices_.end(), mesh.indices_.begin(), mesh.indices_.end());
+
+    // the indices count from the first vertex of their part and stay valid
+    for (int part = 0; part < mesh.count_parts(); part++)
+    {
+        vertex_offsets_.push_back(vertex_offsets_.back() +
+                                  mesh.count_vertices(part));
+        triangle_offsets_.push_back(triangle_offsets_.back() +
+                                    mesh.count_triangles(part));
+    }
+}
+
+void TriangleMesh::copy_part(int part,
+                             std::vector<Eigen::Vector3d>& vertices,
+                             std::vector<std::vector<int>>& indices) const
+{
+    const VertexMatrix part_vertices = this->vertices(part);
+    vertices.resize(part_vertices.cols());
+    for (int i = 0; i < part_vertices.cols(); i++)
+    {
+        vertices[i] = part_vertices.col(i).cast<double>();
+    }
+
+    const TriangleMatrix part_triangles = triangles(part);
+    indices.resize(part_triangles.cols());
+    for (int i = 0; i < part_triangles.cols(); i++)
+    {
+        indices[i] = {int(part_triangles(0, i)),
+                      int(part_triangles(1, i)),
+                      int(part_triangles(2, i))};
+    }
+}
+
+void TriangleMesh::copy(Vertices& vertices, TriangleIndices& indices) const
+{
+    vertices.resize(count_parts());
+    indices.resize(count_parts());
+    for (int part = 0; part < count_parts(); part++)
+    {
+        copy_part(part, vertices[part], indices[part]);
+    }
+}
+}
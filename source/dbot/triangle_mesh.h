@@ -0,0 +1,132 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file triangle_mesh.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Triangle mesh of several parts in two contiguous arrays
+ *
+ * The vertices of all parts are stored as consecutive single precision
+ * x, y, z triples and the triangles as consecutive vertex index triples,
+ * where the indices count from the first vertex of their part. Offset tables
+ * give the first vertex and the first triangle of each part. The arrays can
+ * be uploaded to the GPU as they are.
+ *
+ * Meshes are immutable once built and shared by the object model and all
+ * renderers through a ConstPtr instead of being copied.
+ */
+class TriangleMesh
+{
+public:
+    typedef std::shared_ptr<const TriangleMesh> ConstPtr;
+
+    typedef Eigen::Map<const Eigen::Matrix<float, 3, Eigen::Dynamic>>
+        VertexMatrix;
+    typedef Eigen::Map<const Eigen::Matrix<uint32_t, 3, Eigen::Dynamic>>
+        TriangleMatrix;
+
+    typedef std::vector<std::vector<Eigen::Vector3d>> Vertices;
+    typedef std::vector<std::vector<std::vector<int>>> TriangleIndices;
+
+public:
+    TriangleMesh();
+
+    /**
+     * \brief Converts meshes in the layout of ObjectModelLoader
+     */
+    TriangleMesh(const Vertices& vertices, const TriangleIndices& indices);
+
+    /**
+     * \brief Appends a part, its indices count from its first vertex
+     */
+    void add_part(const std::vector<Eigen::Vector3d>& vertices,
+                  const std::vector<std::vector<int>>& indices);
+
+    /**
+     * \brief Appends all parts of another mesh after the parts of this one
+     */
+    void append(const TriangleMesh& mesh);
+
+    int count_parts() const { return int(vertex_offsets_.size()) - 1; }
+    int count_vertices() const { return vertex_offsets_.back(); }
+    int count_triangles() const { return triangle_offsets_.back(); }
+    int count_vertices(int part) const
+    {
+        return vertex_offsets_[part + 1] - vertex_offsets_[part];
+    }
+
+    int count_triangles(int part) const
+    {
+        return triangle_offsets_[part + 1] - triangle_offsets_[part];
+    }
+
+    int first_vertex(int part) const { return vertex_offsets_[part]; }
+    int first_triangle(int part) const { return triangle_offsets_[part]; }
+
+    /**
+     * \brief Vertices of the part, one per column
+     */
+    VertexMatrix vertices(int part) const
+    {
+        return VertexMatrix(vertices_.data() + 3 * vertex_offsets_[part],
+                            3,
+                            count_vertices(part));
+    }
+
+    /**
+     * \brief Triangles of the part, one per column
+     */
+    TriangleMatrix triangles(int part) const
+    {
+        return TriangleMatrix(indices_.data() + 3 * triangle_offsets_[part],
+                              3,
+                              count_triangles(part));
+    }
+
+    /// x, y, z of all vertices of all parts
+    const std::vector<float>& vertex_data() const { return vertices_; }
+    /// part relative vertex indices of all triangles of all parts
+    const std::vector<uint32_t>& index_data() const { return indices_; }
+
+    /**
+     * \brief Copies a part into the layout of ObjectModelLoader
+     */
+    void copy_part(int part,
+                   std::vector<Eigen::Vector3d>& vertices,
+                   std::vector<std::vector<int>>& indices) const;
+
+    /**
+     * \brief Copies all parts into the layout of ObjectModelLoader
+     */
+    void copy(Vertices& vertices, TriangleIndices& indices) const;
+
+private:
+    std::vector<float> vertices_;
+    std::vector<uint32_t> indices_;
+    std::vector<int> vertex_offsets_;
+    std::vector<int> triangle_offsets_;
+};
+}
@@ -0,0 +1,88 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file triangle_mesh_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/triangle_mesh.h>
+
+TEST(TriangleMeshTests, parts_are_stored_contiguously)
+{
+    dbot::TriangleMesh::Vertices vertices(2);
+    dbot::TriangleMesh::TriangleIndices indices(2);
+    vertices[0] = {Eigen::Vector3d(0, 0, 0),
+                   Eigen::Vector3d(1, 0, 0),
+                   Eigen::Vector3d(0, 1, 0)};
+    indices[0] = {{0, 1, 2}};
+    vertices[1] = {Eigen::Vector3d(0, 0, 1),
+                   Eigen::Vector3d(1, 0, 1),
+                   Eigen::Vector3d(1, 1, 1),
+                   Eigen::Vector3d(0, 1, 1)};
+    indices[1] = {{0, 1, 2}, {0, 2, 3}};
+
+    dbot::TriangleMesh mesh(vertices, indices);
+
+    ASSERT_EQ(mesh.count_parts(), 2);
+    EXPECT_EQ(mesh.count_vertices(), 7);
+    EXPECT_EQ(mesh.count_triangles(), 3);
+    EXPECT_EQ(mesh.first_vertex(1), 3);
+    EXPECT_EQ(mesh.first_triangle(1), 1);
+    EXPECT_EQ(mesh.vertex_data().size(), 21u);
+    EXPECT_EQ(mesh.index_data().size(), 9u);
+
+    // the indices stay relative to the first vertex of their part
+    EXPECT_EQ(mesh.triangles(1)(2, 1), 3u);
+    EXPECT_EQ(mesh.vertices(1).col(2), Eigen::Vector3f(1, 1, 1));
+    EXPECT_EQ(mesh.vertex_data().data() + 9, mesh.vertices(1).data());
+
+    dbot::TriangleMesh::Vertices copied_vertices;
+    dbot::TriangleMesh::TriangleIndices copied_indices;
+    mesh.copy(copied_vertices, copied_indices);
+    EXPECT_EQ(copied_vertices, vertices);
+    EXPECT_EQ(copied_indices, indices);
+}
+
+TEST(TriangleMeshTests, empty_mesh_has_no_parts)
+{
+    dbot::TriangleMesh mesh;
+
+    EXPECT_EQ(mesh.count_parts(), 0);
+    EXPECT_EQ(mesh.count_vertices(), 0);
+    EXPECT_EQ(mesh.count_triangles(), 0);
+}
+
+TEST(TriangleMeshTests, appended_parts_follow_the_existing_ones)
+{
+    dbot::TriangleMesh::Vertices vertices(1);
+    dbot::TriangleMesh::TriangleIndices indices(1);
+    vertices[0] = {Eigen::Vector3d(0, 0, 0),
+                   Eigen::Vector3d(1, 0, 0),
+                   Eigen::Vector3d(0, 1, 0)};
+    indices[0] = {{0, 1, 2}};
+
+    dbot::TriangleMesh mesh(vertices, indices);
+    mesh.append(dbot::TriangleMesh(vertices, indices));
+    mesh.append(dbot::TriangleMesh());
+
+    ASSERT_EQ(mesh.count_parts(), 2);
+    EXPECT_EQ(mesh.count_vertices(), 6);
+    EXPECT_EQ(mesh.count_triangles(), 2);
+    EXPECT_EQ(mesh.first_vertex(1), 3);
+    EXPECT_EQ(mesh.first_triangle(1), 1);
+    EXPECT_EQ(mesh.triangles(1)(2, 0), 2u);
+    EXPECT_EQ(mesh.vertices(1).col(1), Eigen::Vector3f(1, 0, 0));
+}
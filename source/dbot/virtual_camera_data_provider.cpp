@@ -48,17 +48,30 @@ Eigen::VectorXd VirtualCameraDataProvider::depth_image_vector() const
 {
     Eigen::VectorXd image(depth_image_.size());
 
-    for (int i = 0, k = 0; i < depth_image_.rows(); ++i)
-    {
-        for (int j = 0; j < depth_image_.cols(); ++j)
-        {
-            image[k++] = depth_image_(i, j);
-        }
-    }
+    // row by row
+    Eigen::Map<Eigen::Matrix<double,
+                             Eigen::Dynamic,
+                             Eigen::Dynamic,
+                             Eigen::RowMajor>>(
+        image.data(), depth_image_.rows(), depth_image_.cols()) = depth_image_;
 
     return image;
 }
 
+DepthFrame::ConstPtr VirtualCameraDataProvider::depth_frame() const
+{
+    DepthFrame::Ptr frame =
+        frame_pool_.acquire(depth_image_.rows(), depth_image_.cols());
+    frame->image() = depth_image_.cast<float>();
+    return frame;
+}
+
+void VirtualCameraDataProvider::frame_allocator(
+    const DepthFramePool::Allocator& allocator)
+{
+    frame_pool_.allocator(allocator);
+}
+
 Eigen::Matrix3d VirtualCameraDataProvider::camera_matrix() const
 {
     return camera_matrix_;
@@ -50,6 +50,16 @@ public:
      */
     virtual Eigen::VectorXd depth_image_vector() const;
 
+    /**
+     * \brief returns the depth image as a pooled single precision frame
+     */
+    virtual DepthFrame::ConstPtr depth_frame() const;
+
+    /**
+     * \brief Sets the allocator of the pooled frames
+     */
+    virtual void frame_allocator(const DepthFramePool::Allocator& allocator);
+
     /**
      * \brief Obtains the camera matrix
      */
@@ -77,5 +87,6 @@ protected:
     Eigen::Matrix3d camera_matrix_;
     CameraData::Resolution native_resolution_;
     Eigen::MatrixXd depth_image_;
+    mutable DepthFramePool frame_pool_;
 };
 }
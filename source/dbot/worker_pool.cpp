@@ -0,0 +1,261 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file worker_pool.cpp
+ * \date October 2026
+ */
+
+#include <dbot/worker_pool.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dbot
+{
+namespace
+{
+bool pin_to_cores(const std::vector<int>& cores)
+{
+    if (cores.empty()) return true;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores)
+    {
+        if (core < 0 || core >= CPU_SETSIZE) return false;
+        CPU_SET(core, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+}
+
+std::vector<int> CpuAffinity::resolve() const
+{
+    if (!cores.empty() || numa_node < 0) return cores;
+
+    std::ifstream file("/sys/devices/system/node/node" +
+                       std::to_string(numa_node) + "/cpulist");
+    std::string list;
+    std::getline(file, list);
+    return parse_cpu_list(list);
+}
+
+std::vector<int> CpuAffinity::parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cores;
+    std::istringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.find_first_of("0123456789") == std::string::npos) continue;
+
+        const size_t dash = range.find('-');
+        const int first = std::atoi(range.substr(0, dash).c_str());
+        const int last = dash == std::string::npos
+                             ? first
+                             : std::atoi(range.substr(dash + 1).c_str());
+
+        for (int core = first; core <= last; core++) cores.push_back(core);
+    }
+    return cores;
+}
+
+WorkerPool::WorkerPool(int thread_count, const CpuAffinity& affinity)
+    : cores_(affinity.resolve()), queued_(0), next_queue_(0), stop_(false)
+{
+    if (thread_count <= 0)
+    {
+        const int cores =
+            cores_.empty() ? int(std::thread::hardware_concurrency())
+                           : int(cores_.size());
+        thread_count = std::max(cores - 1, 0);
+    }
+
+    queues_.resize(thread_count);
+    for (auto& queue : queues_) queue.reset(new Queue());
+
+    threads_.reserve(thread_count);
+    for (int i = 0; i < thread_count; i++)
+    {
+        const int core =
+            cores_.empty() ? -1 : cores_[(i + 1) % cores_.size()];
+        threads_.emplace_back(&WorkerPool::run, this, i, core);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    for (auto& thread : threads_) thread.join();
+}
+
+void WorkerPool::parallel_for(int count,
+                              const std::function<void(int)>& task)
+{
+    if (count <= 0) return;
+    if (count == 1 || queues_.empty())
+    {
+        for (int i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    Batch batch;
+    batch.task = &task;
+    batch.remaining = count - 1;
+
+    // spread the tasks over the queues, starting at another one for every
+    // batch such that concurrent callers do not pile onto the first worker
+    const unsigned first = next_queue_++;
+    for (int i = 1; i < count; i++)
+    {
+        Queue& queue = *queues_[(first + i) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{&batch, i});
+    }
+    queued_ += count - 1;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    condition_.notify_all();
+
+    run_task(batch, 0);
+
+    // help with the queued tasks, of this or of other batches, until the
+    // batch is done
+    while (batch.remaining > 0)
+    {
+        Task queued;
+        if (take(-1, queued))
+        {
+            execute(queued);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(
+            lock, [&]() { return batch.remaining == 0 || queued_ > 0; });
+    }
+
+    if (batch.exception) std::rethrow_exception(batch.exception);
+}
+
+CpuAffinity WorkerPool::caller_affinity() const
+{
+    CpuAffinity affinity;
+    if (!cores_.empty()) affinity.cores.push_back(cores_[0]);
+    return affinity;
+}
+
+bool WorkerPool::pin_current_thread(const CpuAffinity& affinity)
+{
+    if (affinity.empty()) return true;
+
+    const std::vector<int> cores = affinity.resolve();
+    return !cores.empty() && pin_to_cores(cores);
+}
+
+void WorkerPool::run(int index, int core)
+{
+    if (core >= 0) pin_to_cores(std::vector<int>(1, core));
+
+    while (true)
+    {
+        Task task;
+        if (take(index, task))
+        {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+        if (stop_ && queued_ == 0) return;
+    }
+}
+
+bool WorkerPool::take(int worker, Task& task)
+{
+    if (worker >= 0)
+    {
+        Queue& queue = *queues_[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            queued_--;
+            return true;
+        }
+    }
+
+    const int count = queues_.size();
+    for (int i = 1; i <= count; i++)
+    {
+        const int victim = (std::max(worker, 0) + i) % count;
+        if (victim == worker) continue;
+
+        Queue& queue = *queues_[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerPool::run_task(Batch& batch, int index)
+{
+    try
+    {
+        (*batch.task)(index);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        if (!batch.exception) batch.exception = std::current_exception();
+    }
+}
+
+void WorkerPool::execute(const Task& task)
+{
+    // the caller of parallel_for() may return as soon as the count drops to
+    // zero, the batch must not be touched afterwards
+    Batch* batch = task.batch;
+    run_task(*batch, task.index);
+    if (--batch->remaining == 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_all();
+    }
+}
+}
@@ -0,0 +1,163 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file worker_pool.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Cores a thread may run on
+ */
+struct CpuAffinity
+{
+    /// cores by their index in the system, all cores if empty
+    std::vector<int> cores;
+    /// NUMA node whose cores are used if no cores are given, -1 for any
+    int numa_node = -1;
+
+    bool empty() const { return cores.empty() && numa_node < 0; }
+    /**
+     * \brief The cores, or those of the NUMA node. Empty if the thread may
+     *        run anywhere or the node is unknown.
+     */
+    std::vector<int> resolve() const;
+
+    /**
+     * \brief Parses a list of cores in the format of the kernel, e.g.
+     *        "0-3,8,10-11"
+     */
+    static std::vector<int> parse_cpu_list(const std::string& list);
+};
+
+/**
+ * \brief Work-stealing pool of threads shared by the components of one or
+ *        more trackers, such that they do not spawn threads of their own
+ *
+ * Every worker takes the tasks of its own queue in last-in first-out order
+ * and steals from the front of the others once it runs dry. The thread
+ * calling parallel_for() works on the tasks as well until its batch is done,
+ * which also makes nested parallel_for() calls safe.
+ *
+ * With an affinity, each worker is pinned to one of its cores, round robin
+ * starting at the second one. The first core is left to the calling thread,
+ * see caller_affinity(), such that a pool of the default size never has more
+ * threads than cores. Since the workers allocate their scratch buffers
+ * themselves, a pool pinned to a NUMA node keeps them in the memory of that
+ * node.
+ */
+class WorkerPool
+{
+public:
+    /**
+     * \param thread_count  Number of worker threads besides the calling
+     *                      thread. A value of 0 selects one less than the
+     *                      cores of the affinity.
+     */
+    explicit WorkerPool(int thread_count = 0,
+                        const CpuAffinity& affinity = CpuAffinity());
+
+    /**
+     * \brief Joins the workers, no parallel_for() may be running
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * \brief Calls task(i) for every i in [0, count) and blocks until all
+     *        calls returned. Task 0 runs on the calling thread.
+     *
+     * If tasks throw, the remaining ones still run and the first exception
+     * is rethrown once all of them returned.
+     */
+    void parallel_for(int count, const std::function<void(int)>& task);
+
+    int thread_count() const { return int(threads_.size()); }
+    /// threads working on a parallel_for(), including the calling one
+    int concurrency() const { return thread_count() + 1; }
+    /**
+     * \brief Core the thread calling parallel_for() should be pinned to,
+     *        empty if the pool has no affinity
+     */
+    CpuAffinity caller_affinity() const;
+
+    /**
+     * \brief Pins the calling thread to the cores of the affinity
+     *
+     * \return false if pinning is not supported or the cores are invalid.
+     *         An empty affinity leaves the thread as it is.
+     */
+    static bool pin_current_thread(const CpuAffinity& affinity);
+
+private:
+    struct Batch
+    {
+        const std::function<void(int)>* task;
+        std::atomic<int> remaining;
+        // first exception thrown by a task, guarded by the mutex
+        std::mutex mutex;
+        std::exception_ptr exception;
+    };
+
+    struct Task
+    {
+        Batch* batch;
+        int index;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(int index, int core);
+
+    /**
+     * \brief Takes a task from the back of the own queue, or from the front
+     *        of any other one. A worker index of -1 only steals.
+     */
+    bool take(int worker, Task& task);
+
+    void execute(const Task& task);
+    // runs task(index) of the batch, keeping the first exception it throws
+    static void run_task(Batch& batch, int index);
+
+    std::vector<int> cores_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    // counts the queued tasks, the mutex only guards sleeping on it
+    std::atomic<int> queued_;
+    std::atomic<unsigned> next_queue_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stop_;
+    std::vector<std::thread> threads_;
+};
+}
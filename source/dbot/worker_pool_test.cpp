@@ -0,0 +1,204 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file worker_pool_test.cpp
+ * \date October 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <dbot/filter/resampler.h>
+#include <dbot/object_model.h>
+#include <dbot/worker_pool.h>
+
+namespace
+{
+/**
+ * \brief Loads parts of bumpy grids of 2 n^2 triangles
+ */
+class GridLoader : public dbot::ObjectModelLoader
+{
+public:
+    void load(std::vector<std::vector<Eigen::Vector3d>>& vertices,
+              std::vector<std::vector<std::vector<int>>>& triangles) const
+    {
+        const int n = 40;
+        vertices.assign(3, std::vector<Eigen::Vector3d>());
+        triangles.assign(3, std::vector<std::vector<int>>());
+        for (int part = 0; part < 3; part++)
+        {
+            for (int i = 0; i <= n; i++)
+            {
+                for (int j = 0; j <= n; j++)
+                {
+                    vertices[part].push_back(Eigen::Vector3d(
+                        i, j, part * std::sin(0.3 * i) * std::cos(0.2 * j)));
+                }
+            }
+            for (int i = 0; i < n; i++)
+            {
+                for (int j = 0; j < n; j++)
+                {
+                    const int v = i * (n + 1) + j;
+                    triangles[part].push_back({v, v + n + 1, v + n + 2});
+                    triangles[part].push_back({v, v + n + 2, v + 1});
+                }
+            }
+        }
+    }
+};
+}
+
+TEST(WorkerPoolTests, runs_every_task_once)
+{
+    dbot::WorkerPool pool(3);
+    EXPECT_EQ(3, pool.thread_count());
+    EXPECT_EQ(4, pool.concurrency());
+
+    for (int count : {0, 1, 2, 4, 100})
+    {
+        std::vector<std::atomic<int>> calls(count);
+        for (auto& call : calls) call = 0;
+
+        pool.parallel_for(count, [&](int i) { calls[i]++; });
+        for (int i = 0; i < count; i++) EXPECT_EQ(1, calls[i]);
+    }
+}
+
+TEST(WorkerPoolTests, runs_the_first_task_on_the_caller)
+{
+    dbot::WorkerPool pool(2);
+    std::thread::id first;
+    pool.parallel_for(8,
+                      [&](int i)
+                      {
+                          if (i == 0) first = std::this_thread::get_id();
+                      });
+    EXPECT_EQ(std::this_thread::get_id(), first);
+}
+
+TEST(WorkerPoolTests, supports_nested_and_concurrent_calls)
+{
+    dbot::WorkerPool pool(2);
+    std::atomic<int> calls(0);
+
+    auto nested = [&]()
+    {
+        pool.parallel_for(
+            6,
+            [&](int)
+            {
+                pool.parallel_for(5, [&](int) { calls++; });
+            });
+    };
+    std::thread other(nested);
+    nested();
+    other.join();
+
+    EXPECT_EQ(2 * 6 * 5, calls);
+}
+
+TEST(WorkerPoolTests, rethrows_the_exceptions_of_tasks)
+{
+    dbot::WorkerPool pool(3);
+
+    for (int thrower : {0, 5})
+    {
+        std::vector<std::atomic<int>> calls(50);
+        for (auto& call : calls) call = 0;
+
+        EXPECT_THROW(pool.parallel_for(50,
+                                       [&](int i)
+                                       {
+                                           calls[i]++;
+                                           if (i == thrower || i == 7)
+                                           {
+                                               throw std::runtime_error("");
+                                           }
+                                       }),
+                     std::runtime_error);
+        // the other tasks still ran and the pool stays usable
+        for (int i = 0; i < 50; i++) EXPECT_EQ(1, calls[i]);
+    }
+
+    std::atomic<int> calls(0);
+    pool.parallel_for(10, [&](int) { calls++; });
+    EXPECT_EQ(10, calls);
+}
+
+TEST(WorkerPoolTests, parses_kernel_cpu_lists)
+{
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}),
+              dbot::CpuAffinity::parse_cpu_list("0-3,8,10-11\n"));
+    EXPECT_TRUE(dbot::CpuAffinity::parse_cpu_list("").empty());
+
+    dbot::CpuAffinity affinity;
+    EXPECT_TRUE(affinity.empty());
+    affinity.cores = {5, 6};
+    EXPECT_EQ(affinity.cores, affinity.resolve());
+}
+
+TEST(WorkerPoolTests, leaves_the_first_core_to_the_caller)
+{
+    dbot::CpuAffinity affinity;
+    affinity.cores = {0};
+
+    dbot::WorkerPool pool(0, affinity);
+    EXPECT_EQ(0, pool.thread_count());
+    ASSERT_EQ(1u, pool.caller_affinity().cores.size());
+    EXPECT_EQ(0, pool.caller_affinity().cores[0]);
+
+    EXPECT_TRUE(dbot::WorkerPool::pin_current_thread(dbot::CpuAffinity()));
+}
+
+TEST(WorkerPoolTests, resampler_prefix_sum_matches_on_the_pool)
+{
+    std::vector<double> weights(1 << 17);
+    for (size_t i = 0; i < weights.size(); i++) weights[i] = i % 7;
+
+    dbot::Resampler sequential;
+    dbot::Resampler pooled;
+    pooled.worker_pool(std::make_shared<dbot::WorkerPool>(3));
+
+    std::vector<double> expected, sums;
+    sequential.prefix_sum(weights.data(), weights.size(), expected);
+    pooled.prefix_sum(weights.data(), weights.size(), sums);
+    EXPECT_EQ(expected, sums);
+}
+
+TEST(WorkerPoolTests, object_model_builds_the_same_levels_on_the_pool)
+{
+    auto loader = std::make_shared<GridLoader>();
+    dbot::ObjectModel sequential(loader, false);
+    dbot::ObjectModel pooled(loader, false);
+    pooled.worker_pool(std::make_shared<dbot::WorkerPool>(2));
+
+    sequential.build_levels_of_detail(3);
+    pooled.build_levels_of_detail(3);
+
+    ASSERT_EQ(sequential.count_levels(), pooled.count_levels());
+    EXPECT_GT(sequential.count_levels(), 1);
+    for (int level = 0; level < sequential.count_levels(); level++)
+    {
+        EXPECT_EQ(sequential.triangle_indices(level),
+                  pooled.triangle_indices(level));
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file worker_thread.h
+ * \date October 2026
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace dbot
+{
+/**
+ * \brief Runs tasks in order on a dedicated thread
+ *
+ * Objects which have to be used from one thread, e.g. because they own a GL
+ * context, are created and used by posted tasks only.
+ */
+class WorkerThread
+{
+public:
+    WorkerThread()
+        : pending_(0), stop_(false), thread_(&WorkerThread::run, this)
+    {
+    }
+
+    /**
+     * \brief Runs the remaining tasks and joins the thread
+     */
+    ~WorkerThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        thread_.join();
+    }
+
+    WorkerThread(const WorkerThread&) = delete;
+    WorkerThread& operator=(const WorkerThread&) = delete;
+
+    void post(const std::function<void()>& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(task);
+            pending_++;
+        }
+        condition_.notify_all();
+    }
+
+    /**
+     * \brief Blocks until all posted tasks are done
+     */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            condition_.wait(lock,
+                            [this]() { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+
+            std::function<void()> task = tasks_.front();
+            tasks_.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+            pending_--;
+            condition_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<std::function<void()>> tasks_;
+    int pending_;
+    bool stop_;
+    std::thread thread_;
+};
+}
@@ -4,6 +4,86 @@ dbot_add_test(
     SOURCES source/dbot/object_resource_identifier_test.cpp
     LIBS    ${dbot_LIBRARIES})
 
+dbot_add_test(
+    NAME    object_file_reader_test
+    SOURCES source/dbot/object_file_reader_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    mesh_cache_test
+    SOURCES source/dbot/mesh_cache_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    mesh_simplification_test
+    SOURCES source/dbot/mesh_simplification_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_frame_test
+    SOURCES source/dbot/depth_frame_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_sequence_test
+    SOURCES source/dbot/depth_sequence_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_downsampling_test
+    SOURCES source/dbot/depth_downsampling_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    region_of_interest_test
+    SOURCES source/dbot/region_of_interest_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    frame_change_detector_test
+    SOURCES source/dbot/frame_change_detector_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    latency_metrics_test
+    SOURCES source/dbot/latency_metrics_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    timeline_trace_test
+    SOURCES source/dbot/timeline_trace_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    frame_ring_buffer_test
+    SOURCES source/dbot/tracker/frame_ring_buffer_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    batch_runner_test
+    SOURCES source/dbot/tracker/batch_runner_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    published_estimate_test
+    SOURCES source/dbot/tracker/published_estimate_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    triangle_mesh_test
+    SOURCES source/dbot/triangle_mesh_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    worker_pool_test
+    SOURCES source/dbot/worker_pool_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    triangle_bvh_test
+    SOURCES source/dbot/triangle_bvh_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
 dbot_add_test(
     NAME 	  simple_shader_provider_test
     SOURCES source/dbot/simple_shader_provider_test.cpp
@@ -13,3 +93,76 @@ dbot_add_test(
     NAME    file_shader_provider_test
     SOURCES source/dbot/file_shader_provider_test.cpp
     LIBS	  ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    pose_hashing_test
+    SOURCES source/dbot/pose/pose_hashing_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    rigid_bodies_state_array_test
+    SOURCES source/dbot/pose/rigid_bodies_state_array_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    occlusion_store_test
+    SOURCES source/dbot/model/occlusion_store_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    render_cache_test
+    SOURCES source/dbot/model/render_cache_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kinect_pixel_model_test
+    SOURCES source/dbot/model/kinect_pixel_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kinect_image_model_test
+    SOURCES source/dbot/model/kinect_image_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    object_transition_test
+    SOURCES source/dbot/model/object_transition_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    resampler_test
+    SOURCES source/dbot/filter/resampler_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    normal_generator_test
+    SOURCES source/dbot/filter/normal_generator_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    particle_pruning_test
+    SOURCES source/dbot/filter/particle_pruning_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    sampling_schedule_test
+    SOURCES source/dbot/filter/sampling_schedule_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    latency_configuration_test
+    SOURCES source/dbot/builder/latency_configuration_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    gpu_tuning_cache_test
+    SOURCES source/dbot/gpu/gpu_tuning_cache_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+if(DBOT_BUILD_GPU)
+    dbot_add_test(
+        NAME    kinect_image_model_gpu_test
+        SOURCES source/dbot/gpu/kinect_image_model_gpu_test.cpp
+                source/dbot/benchmark/synthetic_scene.cpp
+        LIBS    ${dbot_LIBRARIES})
+endif(DBOT_BUILD_GPU)